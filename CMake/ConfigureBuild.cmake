@@ -191,6 +191,8 @@ elseif (OGRE_PROFILING_PROVIDER STREQUAL "remotery")
   set(OGRE_SET_PROFILING 2)
 elseif (OGRE_PROFILING_PROVIDER STREQUAL "offline")
   set(OGRE_SET_PROFILING 3)
+elseif (OGRE_PROFILING_PROVIDER STREQUAL "trace")
+  set(OGRE_SET_PROFILING 4)
 endif()
 if( OGRE_PROFILING_EXHAUSTIVE )
   set( OGRE_SET_PROFILING_EXHAUSTIVE 1 )
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreRawPtr.h"
 #include "OgreVector2.h"
 #include "Math/Array/OgreArrayRay.h"
+#include "Threading/OgreUniformScalableTask.h"
 #include "OgreHeaderPrefix.h"
 
 namespace Ogre
@@ -51,6 +52,26 @@ namespace Ogre
 
     class _OgreHlmsPbsExport InstantRadiosity
     {
+        /// Node of a 4-wide BVH. The 4 children are tested against a ray at once using SIMD.
+        struct BvhNode
+        {
+            /// Bounds of each child, in mesh (local) space.
+            ArrayAabb   aabb[4u / ARRAY_PACKED_REALS];
+            /// When childCount[i] == 0, childIdx[i] is the index of another BvhNode.
+            /// Otherwise child i is a leaf: childIdx[i] is the first entry in
+            /// MeshData::bvhTriangles and childCount[i] the number of triangles.
+            uint32      childIdx[4];
+            uint32      childCount[4];
+            uint32      numChildren;
+        };
+
+        /// Pending BvhNode during traversal, and the distance at which the ray enters it.
+        struct BvhStackEntry
+        {
+            uint32  nodeIdx;
+            Real    distance;
+        };
+
         struct MeshData
         {
             float * RESTRICT_ALIAS vertexData;
@@ -65,7 +86,19 @@ namespace Ogre
             size_t  numIndices;
             bool    useIndices16bit;
 
+            /// BVH over all triangles in mesh space. Built once when the mesh is downloaded
+            /// and kept until freeMemory is called. Node 0 is the root.
+            BvhNode * RESTRICT_ALIAS bvhNodes;
+            uint32  * RESTRICT_ALIAS bvhTriangles;
+            size_t  numBvhNodes;
+
             float* getUvStart( uint8_t uvSet ) const;
+            size_t getNumTriangles(void) const;
+            void getTriangle( size_t triIdx, uint32 outVertexIdx[3] ) const;
+            Vector3 getVertex( uint32 vertexIdx ) const;
+
+            void buildBvh(void);
+            void destroyBvh(void);
         };
 
         struct MaterialData
@@ -116,6 +149,18 @@ namespace Ogre
             bool operator () ( const SparseCluster &_l, const SparseCluster &_r ) const;
         };
 
+        /// A mesh (from one Renderable) that must be tested against a list of rays.
+        struct RaycastJob
+        {
+            MeshData const  *meshData;
+            Matrix4         worldMatrix;
+            Matrix4         invWorldMatrix;
+            MaterialData    material;
+            /// Range in mRaycastJobRays. Ray indices are sorted in ascending order.
+            size_t          rayListStart;
+            size_t          numRays;
+        };
+
         typedef vector<RayHit>::type RayHitVec;
         typedef vector<Vpl>::type VplVec;
         typedef set<SparseCluster, SparseCluster>::type SparseClusterSet;
@@ -125,6 +170,12 @@ namespace Ogre
             bool operator () ( const v1::RenderOperation &_l, const v1::RenderOperation &_r ) const;
         };
 
+        /// Orders VPLs by their contents (the Light pointer is ignored).
+        struct OrderVplByValue
+        {
+            bool operator () ( const Vpl &_l, const Vpl &_r ) const;
+        };
+
         SceneManager    *mSceneManager;
         HlmsManager     *mHlmsManager;
     public:
@@ -221,11 +272,47 @@ namespace Ogre
         size_t          mTotalNumRays; /// Includes bounces. Autogenerated.
         VplVec          mVpls;
         RayHitVec       mRayHits;
+
+        /// Clustered VPLs generated by each light, before clustering them against
+        /// VPLs from other lights. Allows rebuilding one light without touching the rest.
+        typedef map<Light*, VplVec>::type VplsPerLightMap;
+        VplsPerLightMap mVplsPerLight;
+        /// Copy of the VPLs each IrradianceVolume currently holds, sorted by OrderVplByValue.
+        typedef map<IrradianceVolume*, VplVec>::type VplsPerVolumeMap;
+        VplsPerVolumeMap mVplsInIrradianceVolume;
+
+        struct VplSplat
+        {
+            Vpl const   *vpl;
+            Real        weight;
+        };
+        typedef vector<VplSplat>::type VplSplatVec;
+        /// VPLs to add to (or remove from) mSplatVolume. mSplatVolume is only
+        /// set while the worker threads execute; see executeTask()
+        VplSplatVec         mVplSplats;
+        IrradianceVolume    *mSplatVolume;
         RawSimdUniquePtr<ArrayRay, MEMCATEGORY_GENERAL> mArrayRays;
 
         FastArray<size_t> mTmpRaysThatHitObject[ARRAY_PACKED_REALS];
+        typedef vector<RaycastJob>::type RaycastJobVec;
+        RaycastJobVec     mRaycastJobs;
+        FastArray<size_t> mRaycastJobRays;
+        Real              mRaycastLightRange;
+        size_t            mRaycastRayStart;
+        size_t            mRaycastNumRays;
         SparseClusterSet  mTmpSparseClusters[3];
 
+        /// Runs executeTask in the SceneManager's worker threads.
+        class WorkerTask : public UniformScalableTask
+        {
+            InstantRadiosity *mOwner;
+        public:
+            WorkerTask( InstantRadiosity *owner ) : mOwner( owner ) {}
+            virtual void execute( size_t threadId, size_t numThreads );
+        };
+        friend class WorkerTask;
+        WorkerTask        mWorkerTask;
+
         typedef map<VertexArrayObject*, MeshData>::type MeshDataMapV2;
         typedef map<v1::RenderOperation, MeshData, OrderRenderOperation>::type MeshDataMapV1;
         MeshDataMapV2   mMeshDataMapV2;
@@ -259,6 +346,27 @@ namespace Ogre
                            Real attenConst, Real attenLinear, Real attenQuad,
                            const AreaOfInterest &areaOfInterest );
 
+        /// Lights that pass mLightMask, in the order they're processed by build.
+        void getLightsToProcess( vector<Light*>::type &outLights ) const;
+        /// Prepares the data shared by all lights (ray buffer, scene graph, AoIs).
+        /// Returns true if the AoI was autogenerated and must be removed afterwards.
+        bool beginProcessingLights(void);
+        void endProcessingLights( bool aoiAutogenerated );
+        /// Generates the VPLs from the given light and stores them in mVplsPerLight.
+        void processLight( Light *light );
+        /// Clusters mVplsPerLight into mVpls. VPL lights from oldVpls are reused
+        /// when possible, and the rest destroyed.
+        void mergeVplsFromAllLights( VplVec &oldVpls );
+        void destroyVplLight( Light *vplLight );
+
+        /// Adds (or subtracts when weight = -1) the contribution of mVplSplats to the volume,
+        /// using the SceneManager's worker threads, then clears them.
+        void splatVplsToIrradianceVolume( IrradianceVolume *volume );
+        /// Adds (or subtracts when weight = -1) the contribution of the VPL to the volume.
+        /// Only the slices in range [zStart; zEnd) are touched.
+        void addVplToIrradianceVolume( IrradianceVolume *volume, const Vpl &vpl, Real weight,
+                                       int32 zStart, int32 zEnd );
+
         /// Generates the ray bounces based on mRayHits[raySrcStart] through
         /// mRayHits[raySrcStart+raySrcCount-1]; generating up to 'raysToGenerate' rays
         /// Returns the number of actually generated rays (which is <= raysToGenerate)
@@ -271,13 +379,23 @@ namespace Ogre
         const MeshData* downloadRenderOp( const v1::RenderOperation &renderOp );
         const Image& downloadTexture( const TexturePtr &texture );
 
+        /// Finds which objects may be hit by the rays, downloading their meshes
+        /// & textures if needed, and adds them to mRaycastJobs.
         void testLightVsAllObjects( uint8 lightType, Real lightRange,
                                     ObjectData objData, size_t numNodes,
                                     const AreaOfInterest &areaOfInterest,
                                     size_t rayStart, size_t numRays );
-        void raycastLightRayVsMesh( Real lightRange, const MeshData meshData,
-                                    Matrix4 worldMatrix, const MaterialData &material,
-                                    const FastArray<size_t> &raysThatHitObj );
+        /// Executes all of mRaycastJobs using the SceneManager's worker threads, then clears them.
+        /// Each thread owns a contiguous range of rays, and processes the jobs in order;
+        /// thus the results are the same as raycasting serially.
+        void raycastAllJobs( Real lightRange, size_t rayStart, size_t numRays );
+        /// Traverses the BVH nearest child first, skipping nodes that are farther than
+        /// the closest hit found so far.
+        void raycastLightRayVsMesh( Real lightRange, const RaycastJob &job, size_t rayIdx,
+                                    FastArray<BvhStackEntry> &nodeStack );
+        /// Splats mVplSplats if mSplatVolume is set, otherwise raycasts mRaycastJobs.
+        /// Called from the worker threads.
+        void executeTask( size_t threadId, size_t numThreads );
 
         Vpl convertToVpl( Vector3 lightColour, Vector3 pointOnTri, const RayHit &hit );
         /// Generates the VPLs from a particular lights, and clusters them.
@@ -313,6 +431,24 @@ namespace Ogre
 
         void build(void);
 
+        /** Regenerates the VPLs of a single light (e.g. because it moved or changed colour),
+            reusing the VPLs from every other light instead of rebuilding from scratch.
+        @remarks
+            build() must have been called first. Geometry is assumed to not have changed
+            since then; if it did, call build() instead.
+            If the light no longer passes mLightMask, its VPLs are removed.
+        @par
+            When using an IrradianceVolume, call updateIrradianceVolume afterwards.
+        @param light
+            Light that changed. Doesn't need to have been present during build.
+        */
+        void updateLight( Light *light );
+
+        /** Removes the VPLs generated by the given light. Must be called before
+            destroying a Light that was used in build() or updateLight().
+        */
+        void removeLight( Light *light );
+
         /// "build" will download meshes for raycasting. We will not free
         /// them after build (in case you want to build again).
         /// If you wish to free that memory, call this function.
@@ -384,6 +520,25 @@ namespace Ogre
         void fillIrradianceVolume( IrradianceVolume *volume,
                                    Vector3 cellSize, Vector3 volumeOrigin, Real lightMaxPower,
                                    bool fadeAttenuationOverDistance );
+
+        /** Updates a volume previously filled with fillIrradianceVolume to match the
+            current VPLs, only subtracting the VPLs that disappeared and adding the new
+            ones. Much faster than fillIrradianceVolume after updateLight.
+        @remarks
+            If the mVpl* attenuation settings or the volume parameters changed,
+            fillIrradianceVolume must be called instead.
+            After many updates floating point error may accumulate; calling
+            fillIrradianceVolume again resets it.
+        @par
+            Each volume remembers the VPLs it was last filled or updated with, so several
+            volumes can be kept in sync independently.
+        */
+        void updateIrradianceVolume( IrradianceVolume *volume );
+
+        /** Frees the copy of the VPLs kept for updateIrradianceVolume.
+            Call it before destroying a volume that was passed to fillIrradianceVolume.
+        */
+        void removeIrradianceVolume( IrradianceVolume *volume );
     };
 
     /** @} */
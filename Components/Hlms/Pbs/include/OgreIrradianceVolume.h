@@ -79,23 +79,19 @@ namespace Ogre
         void destroyIrradianceVolumeTexture();
 
         void clearVolumeData();
-        void updateIrradianceVolumeTexture();
+        /** Blurs the volume data and uploads it to the texture.
+        @remarks
+            The unfiltered data is preserved, thus it's possible to keep calling
+            changeVolumeData afterwards to apply incremental changes.
+        @param numThreads
+            Number of threads to split the work in. 0 to use one per logical core.
+            The result does not depend on the number of threads.
+        */
+        void updateIrradianceVolumeTexture( size_t numThreads = 1u );
         void freeMemory();
 
         void changeVolumeData(uint32 x, uint32 y, uint32 z, uint32 direction_id, const Vector3& delta);
 
-        static void gaussFilter( float * RESTRICT_ALIAS dstData, float * RESTRICT_ALIAS srcData,
-                                 size_t texWidth, size_t texHeight, size_t texDepth );
-        static void gaussFilterX( float * RESTRICT_ALIAS dstData, float * RESTRICT_ALIAS srcData,
-                                  size_t texWidth, size_t texHeight, size_t texDepth,
-                                  const float * RESTRICT_ALIAS kernel, int kernelStart, int kernelEnd );
-        static void gaussFilterY( float * RESTRICT_ALIAS dstData, float * RESTRICT_ALIAS srcData,
-                                  size_t texWidth, size_t texHeight, size_t texDepth,
-                                  const float * RESTRICT_ALIAS kernel, int kernelStart, int kernelEnd );
-        static void gaussFilterZ( float * RESTRICT_ALIAS dstData, float * RESTRICT_ALIAS srcData,
-                                  size_t texWidth, size_t texHeight, size_t texDepth,
-                                  const float * RESTRICT_ALIAS kernel, int kernelStart, int kernelEnd );
-
     public:
         IrradianceVolume( HlmsManager *hlmsManager );
         ~IrradianceVolume();
@@ -124,6 +120,13 @@ namespace Ogre
         const TexturePtr& getIrradianceVolumeTexture(void) const    { return mIrradianceVolume; }
         const HlmsSamplerblock* getIrradSamplerblock(void) const    { return mIrradianceSamplerblock; }
 
+        /** The blurred volume data, as uploaded by updateIrradianceVolumeTexture.
+            Each texel has 3 floats (RGB). Rows are getNumBlocksX() texels wide; each block
+            has 6 rows (one per direction), and each slice getNumBlocksY() blocks.
+            Null if clearVolumeData hasn't been called.
+        */
+        const float* getBlurredVolumeData(void) const               { return mBlurredVolumeData; }
+
 
     };
 
@@ -146,6 +146,419 @@ namespace Ogre
             return retVal;
         }
     };
+
+    /// Builds a 4-wide BVH using binned SAH. Each node is split in two, and
+    /// then each half is split again to get up to 4 children.
+    class MeshBvhBuilder
+    {
+    public:
+        struct Node
+        {
+            Aabb    aabb[4];
+            uint32  childIdx[4];
+            uint32  childCount[4];
+            uint32  numChildren;
+        };
+
+        typedef vector<Node>::type NodeVec;
+
+    private:
+        static const uint32 c_maxTrianglesPerLeaf = 4u;
+        static const uint32 c_numSahBins = 16u;
+
+        struct Range
+        {
+            uint32 first;
+            uint32 count;
+            Range() : first( 0 ), count( 0 ) {}
+            Range( uint32 _first, uint32 _count ) : first( _first ), count( _count ) {}
+        };
+
+        struct Bin
+        {
+            Vector3 vMin;
+            Vector3 vMax;
+            uint32  count;
+        };
+
+        /// Indexed by triangle index
+        vector<Vector3>::type   mTriMin;
+        vector<Vector3>::type   mTriMax;
+        vector<Vector3>::type   mTriCentroid;
+
+        vector<uint32>::type    mTriangles;
+        NodeVec                 mNodes;
+
+        static Real halfSurfaceArea( const Vector3 &vMin, const Vector3 &vMax )
+        {
+            const Vector3 size = vMax - vMin;
+            return size.x * size.y + size.y * size.z + size.z * size.x;
+        }
+
+        Aabb getBounds( const Range &range ) const
+        {
+            Vector3 vMin( mTriMin[mTriangles[range.first]] );
+            Vector3 vMax( mTriMax[mTriangles[range.first]] );
+            for( uint32 i=range.first + 1u; i<range.first + range.count; ++i )
+            {
+                vMin.makeFloor( mTriMin[mTriangles[i]] );
+                vMax.makeCeil( mTriMax[mTriangles[i]] );
+            }
+
+            //Pad the box, so that rays transformed to mesh space
+            //don't miss triangles due to precision errors.
+            Aabb retVal = Aabb::newFromExtents( vMin, vMax );
+            const Real maxCenter = std::max( std::max( Math::Abs( retVal.mCenter.x ),
+                                                       Math::Abs( retVal.mCenter.y ) ),
+                                             Math::Abs( retVal.mCenter.z ) );
+            const Real maxHalfSize = std::max( std::max( retVal.mHalfSize.x, retVal.mHalfSize.y ),
+                                               retVal.mHalfSize.z );
+            const Real padding = (maxCenter + maxHalfSize) * Real( 1e-4f ) + Real( 1e-6f );
+            retVal.mHalfSize += padding;
+            return retVal;
+        }
+
+        /// Partitions the triangles in range. Returns false if the range can't be split.
+        bool split( Range range, Range &outLeft, Range &outRight )
+        {
+            if( range.count <= c_maxTrianglesPerLeaf )
+                return false;
+
+            const uint32 first  = range.first;
+            const uint32 last   = range.first + range.count;
+
+            Vector3 centroidMin( mTriCentroid[mTriangles[first]] );
+            Vector3 centroidMax( centroidMin );
+            for( uint32 i=first + 1u; i<last; ++i )
+            {
+                centroidMin.makeFloor( mTriCentroid[mTriangles[i]] );
+                centroidMax.makeCeil( mTriCentroid[mTriangles[i]] );
+            }
+
+            const Vector3 extent = centroidMax - centroidMin;
+            int axis = 0;
+            if( extent.y > extent[axis] )
+                axis = 1;
+            if( extent.z > extent[axis] )
+                axis = 2;
+
+            uint32 splitPoint = range.count;
+
+            if( extent[axis] > Real( 0 ) )
+            {
+                Bin bins[c_numSahBins];
+                for( uint32 i=0; i<c_numSahBins; ++i )
+                {
+                    bins[i].vMin = Vector3( std::numeric_limits<Real>::max() );
+                    bins[i].vMax = Vector3( -std::numeric_limits<Real>::max() );
+                    bins[i].count = 0;
+                }
+
+                const Real binScale = c_numSahBins * Real( 0.9999f ) / extent[axis];
+
+                for( uint32 i=first; i<last; ++i )
+                {
+                    const uint32 triIdx = mTriangles[i];
+                    const uint32 binIdx = static_cast<uint32>(
+                                (mTriCentroid[triIdx][axis] - centroidMin[axis]) * binScale );
+                    Bin &bin = bins[std::min( binIdx, c_numSahBins - 1u )];
+                    bin.vMin.makeFloor( mTriMin[triIdx] );
+                    bin.vMax.makeCeil( mTriMax[triIdx] );
+                    ++bin.count;
+                }
+
+                //Sweep from the right to get the cost of each right half.
+                Real rightArea[c_numSahBins];
+                uint32 rightCount[c_numSahBins];
+                {
+                    Vector3 vMin( std::numeric_limits<Real>::max() );
+                    Vector3 vMax( -std::numeric_limits<Real>::max() );
+                    uint32 count = 0;
+                    for( uint32 i=c_numSahBins; --i; )
+                    {
+                        vMin.makeFloor( bins[i].vMin );
+                        vMax.makeCeil( bins[i].vMax );
+                        count += bins[i].count;
+                        rightArea[i]    = count ? halfSurfaceArea( vMin, vMax ) : 0;
+                        rightCount[i]   = count;
+                    }
+                }
+
+                Real bestCost = std::numeric_limits<Real>::max();
+                uint32 bestBin = 0;
+                {
+                    Vector3 vMin( std::numeric_limits<Real>::max() );
+                    Vector3 vMax( -std::numeric_limits<Real>::max() );
+                    uint32 count = 0;
+                    for( uint32 i=0; i<c_numSahBins - 1u; ++i )
+                    {
+                        vMin.makeFloor( bins[i].vMin );
+                        vMax.makeCeil( bins[i].vMax );
+                        count += bins[i].count;
+                        if( count > 0 && rightCount[i+1u] > 0 )
+                        {
+                            const Real cost = count * halfSurfaceArea( vMin, vMax ) +
+                                              rightCount[i+1u] * rightArea[i+1u];
+                            if( cost < bestCost )
+                            {
+                                bestCost = cost;
+                                bestBin = i + 1u;
+                            }
+                        }
+                    }
+                }
+
+                if( bestBin > 0 )
+                {
+                    uint32 *midPoint = std::partition(
+                                &mTriangles[first], &mTriangles[first] + range.count,
+                                BinPredicate( *this, axis, centroidMin[axis], binScale, bestBin ) );
+                    splitPoint = static_cast<uint32>( midPoint - &mTriangles[first] );
+                }
+            }
+
+            if( splitPoint == 0 || splitPoint == range.count )
+            {
+                //All centroids fall in the same bin. Split in the middle.
+                splitPoint = range.count >> 1u;
+                std::nth_element( &mTriangles[first], &mTriangles[first] + splitPoint,
+                                  &mTriangles[first] + range.count,
+                                  CentroidOrder( *this, axis ) );
+            }
+
+            outLeft     = Range( first, splitPoint );
+            outRight    = Range( first + splitPoint, range.count - splitPoint );
+
+            return true;
+        }
+
+        struct BinPredicate
+        {
+            const MeshBvhBuilder &builder;
+            int     axis;
+            Real    centroidMin;
+            Real    binScale;
+            uint32  splitBin;
+
+            BinPredicate( const MeshBvhBuilder &_builder, int _axis, Real _centroidMin,
+                          Real _binScale, uint32 _splitBin ) :
+                builder( _builder ), axis( _axis ), centroidMin( _centroidMin ),
+                binScale( _binScale ), splitBin( _splitBin ) {}
+
+            bool operator () ( uint32 triIdx ) const
+            {
+                const uint32 binIdx = static_cast<uint32>(
+                            (builder.mTriCentroid[triIdx][axis] - centroidMin) * binScale );
+                return std::min( binIdx, c_numSahBins - 1u ) < splitBin;
+            }
+        };
+
+        struct CentroidOrder
+        {
+            const MeshBvhBuilder &builder;
+            int axis;
+
+            CentroidOrder( const MeshBvhBuilder &_builder, int _axis ) :
+                builder( _builder ), axis( _axis ) {}
+
+            bool operator () ( uint32 _l, uint32 _r ) const
+            {
+                return builder.mTriCentroid[_l][axis] < builder.mTriCentroid[_r][axis];
+            }
+        };
+
+        uint32 buildNode( const Range &range )
+        {
+            const uint32 nodeIdx = static_cast<uint32>( mNodes.size() );
+            mNodes.push_back( Node() );
+
+            Range children[4];
+            uint32 numChildren = 1u;
+            children[0] = range;
+
+            //Keep splitting the biggest child until we have 4, or nothing can be split.
+            bool canSplit = true;
+            while( numChildren < 4u && canSplit )
+            {
+                uint32 biggest = 0;
+                for( uint32 i=1u; i<numChildren; ++i )
+                {
+                    if( children[i].count > children[biggest].count )
+                        biggest = i;
+                }
+
+                canSplit = split( children[biggest], children[biggest], children[numChildren] );
+                if( canSplit )
+                    ++numChildren;
+            }
+
+            Node node;
+            node.numChildren = numChildren;
+            for( uint32 i=0; i<4u; ++i )
+            {
+                node.aabb[i] = Aabb::BOX_ZERO;
+                node.childIdx[i] = 0;
+                node.childCount[i] = 0;
+            }
+
+            for( uint32 i=0; i<numChildren; ++i )
+            {
+                node.aabb[i] = getBounds( children[i] );
+                if( children[i].count <= c_maxTrianglesPerLeaf )
+                {
+                    node.childIdx[i]    = children[i].first;
+                    node.childCount[i]  = children[i].count;
+                }
+                else
+                {
+                    node.childIdx[i]    = buildNode( children[i] );
+                    node.childCount[i]  = 0;
+                }
+            }
+
+            mNodes[nodeIdx] = node;
+
+            return nodeIdx;
+        }
+
+    public:
+        MeshBvhBuilder( size_t numTriangles )
+        {
+            mTriMin.reserve( numTriangles );
+            mTriMax.reserve( numTriangles );
+            mTriCentroid.reserve( numTriangles );
+        }
+
+        void addTriangle( const Vector3 &v0, const Vector3 &v1, const Vector3 &v2 )
+        {
+            Vector3 vMin( v0 ), vMax( v0 );
+            vMin.makeFloor( v1 );
+            vMin.makeFloor( v2 );
+            vMax.makeCeil( v1 );
+            vMax.makeCeil( v2 );
+            mTriMin.push_back( vMin );
+            mTriMax.push_back( vMax );
+            mTriCentroid.push_back( (vMin + vMax) * 0.5f );
+        }
+
+        void build(void)
+        {
+            mNodes.clear();
+            mTriangles.resize( mTriMin.size() );
+            for( size_t i=0; i<mTriangles.size(); ++i )
+                mTriangles[i] = static_cast<uint32>( i );
+
+            if( !mTriangles.empty() )
+                buildNode( Range( 0, static_cast<uint32>( mTriangles.size() ) ) );
+        }
+
+        const NodeVec& getNodes(void) const                     { return mNodes; }
+        const vector<uint32>::type& getTriangles(void) const    { return mTriangles; }
+    };
+
+    /// Mirrors the position of the elements of a container whose elements get removed with
+    /// efficientVectorRemove, grouped by the cluster block they belong to. This allows
+    /// visiting the elements of a block in exactly the same order a linear scan would,
+    /// but in O(log N) per element instead of O(N).
+    class ClusterPositionTracker
+    {
+    public:
+        struct BlockHash
+        {
+            int32 v[3];
+
+            BlockHash( int32 x, int32 y, int32 z )
+            {
+                v[0] = x;
+                v[1] = y;
+                v[2] = z;
+            }
+
+            bool operator < ( const BlockHash &other ) const
+            {
+                if( v[0] != other.v[0] )
+                    return v[0] < other.v[0];
+                if( v[1] != other.v[1] )
+                    return v[1] < other.v[1];
+                return v[2] < other.v[2];
+            }
+        };
+
+    private:
+        typedef set<size_t>::type PositionSet;
+        typedef map<BlockHash, PositionSet>::type PositionSetMap;
+
+        PositionSetMap              mBlocks;
+        /// Elements that don't belong to any block (i.e. rays that didn't hit anything)
+        PositionSet                 mInvalid;
+        vector<PositionSet*>::type  mSetOfElement;
+
+    public:
+        void reserve( size_t numElements )
+        {
+            mSetOfElement.reserve( numElements );
+        }
+
+        void addElement( const BlockHash &blockHash )
+        {
+            PositionSet *positionSet = &mBlocks[blockHash];
+            positionSet->insert( positionSet->end(), mSetOfElement.size() );
+            mSetOfElement.push_back( positionSet );
+        }
+
+        void addInvalidElement(void)
+        {
+            mInvalid.insert( mInvalid.end(), mSetOfElement.size() );
+            mSetOfElement.push_back( &mInvalid );
+        }
+
+        /// Stops tracking the element (but it still occupies its position),
+        /// i.e. because it's the one we're looking alike elements for.
+        void ignore( size_t idx )
+        {
+            mSetOfElement[idx]->erase( idx );
+        }
+
+        /** Finds the next element at or after 'startIdx' that belongs to the same block
+            as the element at 'pivotIdx', or that is invalid.
+        @return
+            The position of the element, or the number of elements if there are none.
+        */
+        size_t findNext( size_t pivotIdx, size_t startIdx, bool &outIsInvalid ) const
+        {
+            size_t retVal = mSetOfElement.size();
+            outIsInvalid = false;
+
+            const PositionSet *blockSet = mSetOfElement[pivotIdx];
+            PositionSet::const_iterator itor = blockSet->lower_bound( startIdx );
+            if( itor != blockSet->end() )
+                retVal = *itor;
+
+            itor = mInvalid.lower_bound( startIdx );
+            if( itor != mInvalid.end() && *itor < retVal )
+            {
+                retVal = *itor;
+                outIsInvalid = true;
+            }
+
+            return retVal;
+        }
+
+        /// Must be called every time efficientVectorRemove is called on the tracked container.
+        void remove( size_t idx )
+        {
+            const size_t lastIdx = mSetOfElement.size() - 1u;
+            mSetOfElement[idx]->erase( idx );
+            if( idx != lastIdx )
+            {
+                PositionSet *lastSet = mSetOfElement[lastIdx];
+                lastSet->erase( lastIdx );
+                lastSet->insert( idx );
+                mSetOfElement[idx] = lastSet;
+            }
+            mSetOfElement.pop_back();
+        }
+    };
     //-----------------------------------------------------------------------------------
     //-----------------------------------------------------------------------------------
     //-----------------------------------------------------------------------------------
@@ -174,6 +587,11 @@ namespace Ogre
         mVplIntensityRangeMultiplier( 100.0 ),
         mMipmapBias( 0 ),
         mTotalNumRays( 0 ),
+        mSplatVolume( 0 ),
+        mRaycastLightRange( 0 ),
+        mRaycastRayStart( 0 ),
+        mRaycastNumRays( 0 ),
+        mWorkerTask( this ),
         mEnableDebugMarkers( false ),
         mUseTextures( true ),
         mUseIrradianceVolume( false )
@@ -195,6 +613,35 @@ namespace Ogre
                 _l.indexData < _r.indexData;
     }
     //-----------------------------------------------------------------------------------
+    /// Returns -1 if _l goes before _r, 1 if it goes after, 0 if they're equal.
+    static inline int compareVector3( const Vector3 &_l, const Vector3 &_r )
+    {
+        if( _l.x != _r.x )
+            return _l.x < _r.x ? -1 : 1;
+        if( _l.y != _r.y )
+            return _l.y < _r.y ? -1 : 1;
+        if( _l.z != _r.z )
+            return _l.z < _r.z ? -1 : 1;
+        return 0;
+    }
+    //-----------------------------------------------------------------------------------
+    bool InstantRadiosity::OrderVplByValue::operator () ( const Vpl &_l, const Vpl &_r ) const
+    {
+        //Compare everything but the Light pointer
+        int result = compareVector3( _l.diffuse, _r.diffuse );
+        if( !result )
+            result = compareVector3( _l.position, _r.position );
+        if( !result )
+            result = compareVector3( _l.normal, _r.normal );
+        for( size_t i=0; i<6u && !result; ++i )
+            result = compareVector3( _l.dirDiffuse[i], _r.dirDiffuse[i] );
+
+        if( result )
+            return result < 0;
+
+        return _l.numMergedVpls < _r.numMergedVpls;
+    }
+    //-----------------------------------------------------------------------------------
     InstantRadiosity::Vpl InstantRadiosity::convertToVpl( Vector3 lightColour,
                                                           Vector3 pointOnTri,
                                                           const RayHit &hit )
@@ -278,6 +725,32 @@ namespace Ogre
         mTmpSparseClusters[1].clear();
         mTmpSparseClusters[2].clear();
 
+        ClusterPositionTracker tracker;
+        tracker.reserve( mRayHits.size() );
+
+        {
+            RayHitVec::const_iterator itor = mRayHits.begin();
+            RayHitVec::const_iterator end  = mRayHits.end();
+
+            while( itor != end )
+            {
+                if( itor->distance >= std::numeric_limits<Real>::max() )
+                {
+                    tracker.addInvalidElement();
+                }
+                else
+                {
+                    const Vector3 pointOnTri = itor->ray.getPoint( itor->distance * bias );
+                    tracker.addElement( ClusterPositionTracker::BlockHash(
+                                            static_cast<int32>( Math::Floor( pointOnTri.x * cellSize ) ),
+                                            static_cast<int32>( Math::Floor( pointOnTri.y * cellSize ) ),
+                                            static_cast<int32>( Math::Floor( pointOnTri.z * cellSize ) ) ) );
+                }
+
+                ++itor;
+            }
+        }
+
         while( !mRayHits.empty() )
         {
             const RayHit &hit = mRayHits.front();
@@ -286,6 +759,7 @@ namespace Ogre
             {
                 RayHitVec::iterator itRay = mRayHits.begin();
                 efficientVectorRemove( mRayHits, itRay );
+                tracker.remove( 0 );
                 continue;
             }
 
@@ -308,35 +782,30 @@ namespace Ogre
 
             Real numCollectedVpls = 1.0f;
 
-            //Merge the lights (simple average) that lie in the same cluster.
-            RayHitVec::iterator itor = mRayHits.begin() + 1u;
-            RayHitVec::iterator end  = mRayHits.end();
+            //Merge the lights (simple average) that lie in the same cluster, and remove
+            //the rays that didn't hit anything. The tracker only visits those hits, in
+            //the same order as scanning mRayHits from begin() + 1 would.
+            tracker.ignore( 0 );
 
-            while( itor != end )
+            bool isInvalid;
+            size_t alikeIdx = tracker.findNext( 0, 1u, isInvalid );
+
+            while( alikeIdx < mRayHits.size() )
             {
-                const RayHit &alikeHit = *itor;
+                RayHitVec::iterator itor = mRayHits.begin() + alikeIdx;
 
-                if( alikeHit.distance >= std::numeric_limits<Real>::max() )
+                if( !isInvalid )
                 {
-                    itor = efficientVectorRemove( mRayHits, itor );
-                    end  = mRayHits.end();
-                    continue;
-                }
+                    const RayHit &alikeHit = *itor;
 
-                const Real alikeAccumDistance = alikeHit.accumDistance + alikeHit.distance;
-                Real alikeAtten = Real(1.0f) /
-                        (attenConst + (attenLinear +
-                                       attenQuad * alikeAccumDistance) * alikeAccumDistance);
-                alikeAtten = Ogre::min( Real(1.0f), alikeAtten );
+                    const Real alikeAccumDistance = alikeHit.accumDistance + alikeHit.distance;
+                    Real alikeAtten = Real(1.0f) /
+                            (attenConst + (attenLinear +
+                                           attenQuad * alikeAccumDistance) * alikeAccumDistance);
+                    alikeAtten = Ogre::min( Real(1.0f), alikeAtten );
 
-                const Vector3 pointOnTri02 = alikeHit.ray.getPoint( alikeHit.distance * bias );
+                    const Vector3 pointOnTri02 = alikeHit.ray.getPoint( alikeHit.distance * bias );
 
-                const int32 alikeBlockX = static_cast<int32>( Math::Floor( pointOnTri02.x * cellSize ) );
-                const int32 alikeBlockY = static_cast<int32>( Math::Floor( pointOnTri02.y * cellSize ) );
-                const int32 alikeBlockZ = static_cast<int32>( Math::Floor( pointOnTri02.z * cellSize ) );
-
-                if( blockX == alikeBlockX && blockY == alikeBlockY && blockZ == alikeBlockZ )
-                {
                     Vpl alikeVpl = convertToVpl( lightColour, pointOnTri02, alikeHit );
                     vpl.diffuse += alikeVpl.diffuse * alikeAtten;
                     vpl.normal  += alikeVpl.normal;
@@ -346,14 +815,11 @@ namespace Ogre
                         vpl.dirDiffuse[i] += alikeVpl.dirDiffuse[i] * alikeAtten;
 
                     ++numCollectedVpls;
-
-                    itor = efficientVectorRemove( mRayHits, itor );
-                    end  = mRayHits.end();
-                }
-                else
-                {
-                    ++itor;
                 }
+
+                efficientVectorRemove( mRayHits, itor );
+                tracker.remove( alikeIdx );
+                alikeIdx = tracker.findNext( 0, alikeIdx, isInvalid );
             }
 
             //vpl.diffuse /= numCollectedVpls;
@@ -372,6 +838,7 @@ namespace Ogre
 
             RayHitVec::iterator itRay = mRayHits.begin();
             efficientVectorRemove( mRayHits, itRay );
+            tracker.remove( 0 );
         }
 
         if( mNumSpreadIterations > 0 )
@@ -510,18 +977,26 @@ namespace Ogre
 
         const Real cellSize = Real(1.0) / mCellSize;
 
-        VplVec::iterator itor = mVpls.begin();
-        VplVec::iterator end  = mVpls.end();
+        ClusterPositionTracker tracker;
+        tracker.reserve( mVpls.size() );
 
-        while( itor != end )
         {
-            Vpl vpl = *itor; //Hard copy!
+            VplVec::const_iterator itor = mVpls.begin();
+            VplVec::const_iterator end  = mVpls.end();
 
-            const size_t idx = itor - mVpls.begin();
+            while( itor != end )
+            {
+                tracker.addElement( ClusterPositionTracker::BlockHash(
+                                        static_cast<int32>( Math::Floor( itor->position.x * cellSize ) ),
+                                        static_cast<int32>( Math::Floor( itor->position.y * cellSize ) ),
+                                        static_cast<int32>( Math::Floor( itor->position.z * cellSize ) ) ) );
+                ++itor;
+            }
+        }
 
-            const int32 blockX = static_cast<int32>( Math::Floor( vpl.position.x * cellSize ) );
-            const int32 blockY = static_cast<int32>( Math::Floor( vpl.position.y * cellSize ) );
-            const int32 blockZ = static_cast<int32>( Math::Floor( vpl.position.z * cellSize ) );
+        for( size_t idx=0; idx<mVpls.size(); ++idx )
+        {
+            Vpl vpl = mVpls[idx]; //Hard copy!
 
             vpl.normal  *= vpl.numMergedVpls;
             vpl.position*= vpl.numMergedVpls;
@@ -529,38 +1004,29 @@ namespace Ogre
             Real numCollectedVpls = vpl.numMergedVpls;
 
             //Merge the lights (simple average) that lie in the same cluster.
-            VplVec::iterator itAlike = itor + 1;
+            //The tracker visits them in the same order as scanning from idx + 1 would.
+            tracker.ignore( idx );
 
-            while( itAlike != end )
+            bool isInvalid;
+            size_t alikeIdx = tracker.findNext( idx, idx + 1u, isInvalid );
+
+            while( alikeIdx < mVpls.size() )
             {
+                VplVec::iterator itAlike = mVpls.begin() + alikeIdx;
                 const Vpl &alikeVpl = *itAlike;
 
-                const Vector3 pointOnTri02 = itAlike->position;
-
-                const int32 alikeBlockX = static_cast<int32>( Math::Floor( pointOnTri02.x * cellSize ) );
-                const int32 alikeBlockY = static_cast<int32>( Math::Floor( pointOnTri02.y * cellSize ) );
-                const int32 alikeBlockZ = static_cast<int32>( Math::Floor( pointOnTri02.z * cellSize ) );
-
-                if( blockX == alikeBlockX && blockY == alikeBlockY && blockZ == alikeBlockZ )
-                {
-                    vpl.diffuse += alikeVpl.diffuse;
-                    vpl.normal  += alikeVpl.normal * alikeVpl.numMergedVpls;
-                    vpl.position+= alikeVpl.position * alikeVpl.numMergedVpls;
+                vpl.diffuse += alikeVpl.diffuse;
+                vpl.normal  += alikeVpl.normal * alikeVpl.numMergedVpls;
+                vpl.position+= alikeVpl.position * alikeVpl.numMergedVpls;
 
-                    for( int i=0; i<6; ++i )
-                        vpl.dirDiffuse[i] += alikeVpl.dirDiffuse[i];
+                for( int i=0; i<6; ++i )
+                    vpl.dirDiffuse[i] += alikeVpl.dirDiffuse[i];
 
-                    numCollectedVpls += alikeVpl.numMergedVpls;
+                numCollectedVpls += alikeVpl.numMergedVpls;
 
-                    //Iterators get invalidated!
-                    itAlike = efficientVectorRemove( mVpls, itAlike );
-                    itor    = mVpls.begin() + idx;
-                    end     = mVpls.end();
-                }
-                else
-                {
-                    ++itAlike;
-                }
+                efficientVectorRemove( mVpls, itAlike );
+                tracker.remove( alikeIdx );
+                alikeIdx = tracker.findNext( idx, alikeIdx, isInvalid );
             }
 
             if( numCollectedVpls > vpl.numMergedVpls )
@@ -568,10 +1034,8 @@ namespace Ogre
                 vpl.position/= numCollectedVpls;
                 vpl.normal.normalise();
                 vpl.numMergedVpls = numCollectedVpls;
-                *itor = vpl;
+                mVpls[idx] = vpl;
             }
-
-            ++itor;
         }
     }
     //-----------------------------------------------------------------------------------
@@ -690,6 +1154,8 @@ namespace Ogre
                 }
             }
 
+            raycastAllJobs( lightRange, rayStart, numRays );
+
             const size_t oldRayStart    = rayStart;
             const size_t oldNumRays     = numRays;
 
@@ -896,6 +1362,8 @@ namespace Ogre
             }
         }
 
+        meshData.buildBvh();
+
         mMeshDataMapV2[vao] = meshData;
 
         return &mMeshDataMapV2[vao];
@@ -1026,6 +1494,8 @@ namespace Ogre
             renderOp.indexData->indexBuffer->unlock();
         }
 
+        meshData.buildBvh();
+
         mMeshDataMapV1[renderOp] = meshData;
 
         return &mMeshDataMapV1[renderOp];
@@ -1112,6 +1582,12 @@ namespace Ogre
                     MovableObject *movableObject = objData.mOwner[j];
 
                     const Matrix4 &worldMatrix = movableObject->_getParentNodeFullTransform();
+                    const Matrix4 invWorldMatrix = worldMatrix.inverseAffine();
+
+                    //All Renderables from this object share the same list of rays
+                    const size_t rayListStart = mRaycastJobRays.size();
+                    mRaycastJobRays.appendPOD( mTmpRaysThatHitObject[j].begin(),
+                                               mTmpRaysThatHitObject[j].end() );
                     RenderableArray::const_iterator itor = movableObject->mRenderables.begin();
                     RenderableArray::const_iterator end  = movableObject->mRenderables.end();
 
@@ -1181,9 +1657,14 @@ namespace Ogre
                                 }
                             }
 
-                            raycastLightRayVsMesh( lightRange, *meshData,
-                                                   worldMatrix, material,
-                                                   mTmpRaysThatHitObject[j] );
+                            RaycastJob job;
+                            job.meshData        = meshData;
+                            job.worldMatrix     = worldMatrix;
+                            job.invWorldMatrix  = invWorldMatrix;
+                            job.material        = material;
+                            job.rayListStart    = rayListStart;
+                            job.numRays         = mTmpRaysThatHitObject[j].size();
+                            mRaycastJobs.push_back( job );
                         }
 
                         ++itor;
@@ -1195,120 +1676,267 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
-    void InstantRadiosity::raycastLightRayVsMesh( Real lightRange, const MeshData meshData,
-                                                  Matrix4 worldMatrix, const MaterialData &material,
-                                                  const FastArray<size_t> &raysThatHitObj )
+    void InstantRadiosity::raycastAllJobs( Real lightRange, size_t rayStart, size_t numRays )
     {
-        const size_t numElements = meshData.indexData ? meshData.numIndices : meshData.numVertices;
+        if( !mRaycastJobs.empty() )
+        {
+            mRaycastLightRange  = lightRange;
+            mRaycastRayStart    = rayStart;
+            mRaycastNumRays     = numRays;
 
-        const uint16 * RESTRICT_ALIAS indexData16 = reinterpret_cast<const uint16 * RESTRICT_ALIAS>(
-                    meshData.indexData );
-        const uint32 * RESTRICT_ALIAS indexData32 = reinterpret_cast<const uint32 * RESTRICT_ALIAS>(
-                    meshData.indexData );
+            mSceneManager->executeUserScalableTask( &mWorkerTask, true );
+        }
 
-        for( size_t i=0; i<numElements; i += 3 )
+        mRaycastJobs.clear();
+        mRaycastJobRays.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::WorkerTask::execute( size_t threadId, size_t numThreads )
+    {
+        mOwner->executeTask( threadId, numThreads );
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::executeTask( size_t threadId, size_t numThreads )
+    {
+        if( mSplatVolume )
         {
-            Vector3 triVerts[3];
+            //Each thread owns a range of slices. Every cell receives the contributions of
+            //the VPLs in the same order as if it were done serially, thus the results match.
+            const int32 numBlocksZ = static_cast<int32>( mSplatVolume->getNumBlocksZ() );
+            const int32 zStart = static_cast<int32>( (numBlocksZ * threadId) / numThreads );
+            const int32 zEnd   = static_cast<int32>( (numBlocksZ * (threadId + 1u)) / numThreads );
 
-            uint32 vertexIdx[3];
+            if( zStart == zEnd )
+                return;
 
-            if( meshData.indexData )
-            {
-                if( meshData.useIndices16bit )
-                {
-                    vertexIdx[0] = indexData16[i+0];
-                    vertexIdx[1] = indexData16[i+1];
-                    vertexIdx[2] = indexData16[i+2];
-                }
-                else
-                {
-                    vertexIdx[0] = indexData32[i+0];
-                    vertexIdx[1] = indexData32[i+1];
-                    vertexIdx[2] = indexData32[i+2];
-                }
-            }
-            else
+            VplSplatVec::const_iterator itor = mVplSplats.begin();
+            VplSplatVec::const_iterator end  = mVplSplats.end();
+
+            while( itor != end )
             {
-                vertexIdx[0] = i+0;
-                vertexIdx[1] = i+1;
-                vertexIdx[2] = i+2;
+                addVplToIrradianceVolume( mSplatVolume, *itor->vpl, itor->weight, zStart, zEnd );
+                ++itor;
             }
 
-            triVerts[0].x = meshData.vertexData[vertexIdx[0] * 3u + 0];
-            triVerts[0].y = meshData.vertexData[vertexIdx[0] * 3u + 1];
-            triVerts[0].z = meshData.vertexData[vertexIdx[0] * 3u + 2];
-            triVerts[1].x = meshData.vertexData[vertexIdx[1] * 3u + 0];
-            triVerts[1].y = meshData.vertexData[vertexIdx[1] * 3u + 1];
-            triVerts[1].z = meshData.vertexData[vertexIdx[1] * 3u + 2];
-            triVerts[2].x = meshData.vertexData[vertexIdx[2] * 3u + 0];
-            triVerts[2].y = meshData.vertexData[vertexIdx[2] * 3u + 1];
-            triVerts[2].z = meshData.vertexData[vertexIdx[2] * 3u + 2];
-
-            triVerts[0] = worldMatrix * triVerts[0];
-            triVerts[1] = worldMatrix * triVerts[1];
-            triVerts[2] = worldMatrix * triVerts[2];
+            return;
+        }
 
-            Vector3 triNormal = Math::calculateBasicFaceNormalWithoutNormalize(
-                        triVerts[0], triVerts[1], triVerts[2] );
-            triNormal.normalise();
+        //Each thread owns a range of rays. Since every ray is only written to by a single
+        //thread, and each thread goes through the jobs in the same order, the result is
+        //exactly the same as if it were done serially.
+        const size_t numRaysPerThread = (mRaycastNumRays + numThreads - 1u) / numThreads;
+        const size_t threadRayStart = mRaycastRayStart +
+                                      std::min( mRaycastNumRays, numRaysPerThread * threadId );
+        const size_t threadRayEnd   = mRaycastRayStart +
+                                      std::min( mRaycastNumRays, numRaysPerThread * (threadId + 1u) );
 
-            FastArray<size_t>::const_iterator itRayIdx = raysThatHitObj.begin();
-            FastArray<size_t>::const_iterator enRayIdx = raysThatHitObj.end();
-            while( itRayIdx != enRayIdx )
-            {
-                Ray ray = mRayHits[*itRayIdx].ray;
+        if( threadRayStart == threadRayEnd )
+            return;
 
-                const std::pair<bool, Real> inters = Math::intersects(
-                            ray, triVerts[0], triVerts[1], triVerts[2], triNormal, true, false );
+        FastArray<BvhStackEntry> nodeStack;
+        nodeStack.reserve( 64u );
 
-                if( inters.first )
-                {
-                    RayHit &rayHit = mRayHits[*itRayIdx];
-                    if( inters.second < rayHit.distance &&
-                        inters.second <= lightRange )
-                    {
-                        rayHit.distance = inters.second;
-                        rayHit.material = material;
-                        rayHit.triVerts[0] = triVerts[0];
-                        rayHit.triVerts[1] = triVerts[1];
-                        rayHit.triVerts[2] = triVerts[2];
-                        rayHit.triNormal = triNormal;
-
-                        for( int j=0; j<5 && material.image[j]; ++j )
-                        {
-                            const uint8 uvSet = material.uvSet[j];
-                            const float * RESTRICT_ALIAS uvPtr = meshData.getUvStart( uvSet );
-                            rayHit.triUVs[j][0].x = uvPtr[vertexIdx[0] * 2u + 0];
-                            rayHit.triUVs[j][0].y = uvPtr[vertexIdx[0] * 2u + 1];
+        RaycastJobVec::const_iterator itor = mRaycastJobs.begin();
+        RaycastJobVec::const_iterator end  = mRaycastJobs.end();
 
-                            rayHit.triUVs[j][1].x = uvPtr[vertexIdx[1] * 2u + 0];
-                            rayHit.triUVs[j][1].y = uvPtr[vertexIdx[1] * 2u + 1];
+        while( itor != end )
+        {
+            const RaycastJob &job = *itor;
 
-                            rayHit.triUVs[j][2].x = uvPtr[vertexIdx[2] * 2u + 0];
-                            rayHit.triUVs[j][2].y = uvPtr[vertexIdx[2] * 2u + 1];
-                        }
-                    }
-                }
+            const size_t *jobRays = mRaycastJobRays.begin() + job.rayListStart;
+            const size_t *itRay = std::lower_bound( jobRays, jobRays + job.numRays, threadRayStart );
+            const size_t *enRay = jobRays + job.numRays;
 
-                ++itRayIdx;
+            while( itRay != enRay && *itRay < threadRayEnd )
+            {
+                raycastLightRayVsMesh( mRaycastLightRange, job, *itRay, nodeStack );
+                ++itRay;
             }
+
+            ++itor;
         }
     }
     //-----------------------------------------------------------------------------------
-    void InstantRadiosity::updateExistingVpls(void)
+    void InstantRadiosity::raycastLightRayVsMesh( Real lightRange, const RaycastJob &job,
+                                                  size_t rayIdx,
+                                                  FastArray<BvhStackEntry> &nodeStack )
     {
-        SceneNode *rootNode = mSceneManager->getRootSceneNode( SCENE_DYNAMIC );
+        const MeshData &meshData = *job.meshData;
 
-        VplVec::iterator itor = mVpls.begin();
-        VplVec::iterator end  = mVpls.end();
+        if( !meshData.numBvhNodes )
+            return;
 
-        while( itor != end )
+        RayHit &rayHit = mRayHits[rayIdx];
+        const Ray ray = rayHit.ray;
+
+        //Traverse the BVH in mesh space. Don't normalize the direction,
+        //so that the distances are the same as in world space.
+        ArrayRay localRay;
         {
-            Vpl &vpl = *itor;
-            Vector3 diffuseCol = vpl.diffuse * mVplPowerBoost;
-            if( (diffuseCol.x > mVplThreshold ||
-                 diffuseCol.y > mVplThreshold ||
-                 diffuseCol.z > mVplThreshold) &&
+            Matrix3 invWorld3x3;
+            job.invWorldMatrix.extract3x3Matrix( invWorld3x3 );
+            localRay.mOrigin.setAll( job.invWorldMatrix.transformAffine( ray.getOrigin() ) );
+            localRay.mDirection.setAll( invWorld3x3 * ray.getDirection() );
+        }
+
+        //The BVH only discards triangles. The intersection test is done in world space
+        //exactly like before, and ties are broken by picking the lowest triangle index;
+        //thus we get the same result as testing every triangle in order.
+        Real closestDistance = rayHit.distance;
+        uint32 closestTriIdx = std::numeric_limits<uint32>::max();
+
+        //Nodes entered beyond this distance can't contain a closer hit. The boxes are tested
+        //in mesh space while the triangles are in world space, so leave some slack for
+        //precision; otherwise a hit that ties with closestDistance could be skipped.
+        Real cullDistance = std::min( closestDistance, lightRange );
+        cullDistance += Math::Abs( cullDistance ) * 1e-4f + 1e-4f;
+
+        BvhStackEntry rootEntry;
+        rootEntry.nodeIdx   = 0;
+        rootEntry.distance  = 0;
+        nodeStack.clear();
+        nodeStack.push_back( rootEntry );
+
+        while( !nodeStack.empty() )
+        {
+            const BvhStackEntry entry = nodeStack.back();
+            nodeStack.pop_back();
+
+            //A closer hit may have been found since this node was pushed
+            if( entry.distance > cullDistance )
+                continue;
+
+            const BvhNode &node = meshData.bvhNodes[entry.nodeIdx];
+
+            OGRE_ALIGNED_DECL( Real, childDistance[4], OGRE_SIMD_ALIGNMENT );
+            uint32 hitMask = 0;
+            for( size_t i=0; i<4u / ARRAY_PACKED_REALS; ++i )
+            {
+                ArrayReal distance;
+                hitMask |= BooleanMask4::getScalarMask( localRay.intersects( node.aabb[i],
+                                                                             distance ) ) <<
+                           (i * ARRAY_PACKED_REALS);
+                *reinterpret_cast<ArrayReal*>( childDistance + i * ARRAY_PACKED_REALS ) =
+                        distance;
+            }
+
+            //Sort the children that were hit from nearest to farthest (insertion sort;
+            //there are at most 4)
+            uint32 sortedChildren[4];
+            uint32 numSortedChildren = 0;
+            for( uint32 i=0; i<node.numChildren; ++i )
+            {
+                if( !IS_BIT_SET( i, hitMask ) || childDistance[i] > cullDistance )
+                    continue;
+
+                uint32 j = numSortedChildren++;
+                while( j > 0 && childDistance[sortedChildren[j-1u]] > childDistance[i] )
+                {
+                    sortedChildren[j] = sortedChildren[j-1u];
+                    --j;
+                }
+                sortedChildren[j] = i;
+            }
+
+            //Test the leaves nearest first, so that cullDistance shrinks as soon as possible
+            for( uint32 k=0; k<numSortedChildren; ++k )
+            {
+                const uint32 i = sortedChildren[k];
+
+                if( !node.childCount[i] || childDistance[i] > cullDistance )
+                    continue;
+
+                const uint32 *triangles = meshData.bvhTriangles + node.childIdx[i];
+                for( uint32 j=0; j<node.childCount[i]; ++j )
+                {
+                    const uint32 triIdx = triangles[j];
+
+                    uint32 vertexIdx[3];
+                    meshData.getTriangle( triIdx, vertexIdx );
+
+                    Vector3 triVerts[3];
+                    triVerts[0] = job.worldMatrix * meshData.getVertex( vertexIdx[0] );
+                    triVerts[1] = job.worldMatrix * meshData.getVertex( vertexIdx[1] );
+                    triVerts[2] = job.worldMatrix * meshData.getVertex( vertexIdx[2] );
+
+                    Vector3 triNormal = Math::calculateBasicFaceNormalWithoutNormalize(
+                                triVerts[0], triVerts[1], triVerts[2] );
+                    triNormal.normalise();
+
+                    const std::pair<bool, Real> inters = Math::intersects(
+                                ray, triVerts[0], triVerts[1], triVerts[2], triNormal, true, false );
+
+                    if( inters.first && inters.second <= lightRange &&
+                        (inters.second < closestDistance ||
+                         (inters.second == closestDistance && triIdx < closestTriIdx)) )
+                    {
+                        closestDistance = inters.second;
+                        closestTriIdx   = triIdx;
+                        cullDistance = closestDistance + Math::Abs( closestDistance ) * 1e-4f +
+                                       1e-4f;
+                    }
+                }
+            }
+
+            //Push the inner nodes farthest first, so that the nearest one is popped next
+            for( uint32 k=numSortedChildren; k--; )
+            {
+                const uint32 i = sortedChildren[k];
+
+                if( node.childCount[i] || childDistance[i] > cullDistance )
+                    continue;
+
+                BvhStackEntry childEntry;
+                childEntry.nodeIdx  = node.childIdx[i];
+                childEntry.distance = childDistance[i];
+                nodeStack.push_back( childEntry );
+            }
+        }
+
+        if( closestTriIdx == std::numeric_limits<uint32>::max() )
+            return;
+
+        uint32 vertexIdx[3];
+        meshData.getTriangle( closestTriIdx, vertexIdx );
+
+        rayHit.distance = closestDistance;
+        rayHit.material = job.material;
+        rayHit.triVerts[0] = job.worldMatrix * meshData.getVertex( vertexIdx[0] );
+        rayHit.triVerts[1] = job.worldMatrix * meshData.getVertex( vertexIdx[1] );
+        rayHit.triVerts[2] = job.worldMatrix * meshData.getVertex( vertexIdx[2] );
+        rayHit.triNormal = Math::calculateBasicFaceNormalWithoutNormalize(
+                    rayHit.triVerts[0], rayHit.triVerts[1], rayHit.triVerts[2] );
+        rayHit.triNormal.normalise();
+
+        for( int j=0; j<5 && job.material.image[j]; ++j )
+        {
+            const uint8 uvSet = job.material.uvSet[j];
+            const float * RESTRICT_ALIAS uvPtr = meshData.getUvStart( uvSet );
+            rayHit.triUVs[j][0].x = uvPtr[vertexIdx[0] * 2u + 0];
+            rayHit.triUVs[j][0].y = uvPtr[vertexIdx[0] * 2u + 1];
+
+            rayHit.triUVs[j][1].x = uvPtr[vertexIdx[1] * 2u + 0];
+            rayHit.triUVs[j][1].y = uvPtr[vertexIdx[1] * 2u + 1];
+
+            rayHit.triUVs[j][2].x = uvPtr[vertexIdx[2] * 2u + 0];
+            rayHit.triUVs[j][2].y = uvPtr[vertexIdx[2] * 2u + 1];
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::updateExistingVpls(void)
+    {
+        SceneNode *rootNode = mSceneManager->getRootSceneNode( SCENE_DYNAMIC );
+
+        VplVec::iterator itor = mVpls.begin();
+        VplVec::iterator end  = mVpls.end();
+
+        while( itor != end )
+        {
+            Vpl &vpl = *itor;
+            Vector3 diffuseCol = vpl.diffuse * mVplPowerBoost;
+            if( (diffuseCol.x > mVplThreshold ||
+                 diffuseCol.y > mVplThreshold ||
+                 diffuseCol.z > mVplThreshold) &&
                  !mUseIrradianceVolume)
             {
                 if( !vpl.light )
@@ -1367,24 +1995,51 @@ namespace Ogre
         {
             const Vpl &vpl = *itor;
             if( vpl.light )
-            {
-                SceneNode *lightNode = vpl.light->getParentSceneNode();
-                lightNode->getParentSceneNode()->removeAndDestroyChild( lightNode );
-                mSceneManager->destroyLight( vpl.light );
-            }
+                destroyVplLight( vpl.light );
 
             ++itor;
         }
 
         mVpls.clear();
+        mVplsPerLight.clear();
 
         destroyDebugMarkers();
     }
     //-----------------------------------------------------------------------------------
-    void InstantRadiosity::build(void)
+    void InstantRadiosity::getLightsToProcess( vector<Light*>::type &outLights ) const
     {
-        clear();
+        const uint32 lightMask = mLightMask & VisibilityFlags::RESERVED_VISIBILITY_FLAGS;
+
+        ObjectMemoryManager &memoryManager = mSceneManager->_getLightMemoryManager();
+        const size_t numRenderQueues = memoryManager.getNumRenderQueues();
+
+        for( size_t i=0; i<numRenderQueues; ++i )
+        {
+            ObjectData objData;
+            const size_t totalObjs = memoryManager.getFirstObjectData( objData, i );
+
+            for( size_t j=0; j<totalObjs; j += ARRAY_PACKED_REALS )
+            {
+                for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+                {
+                    uint32 * RESTRICT_ALIAS visibilityFlags = objData.mVisibilityFlags;
 
+                    if( visibilityFlags[k] & VisibilityFlags::LAYER_VISIBILITY &&
+                        visibilityFlags[k] & lightMask )
+                    {
+                        Light *light = static_cast<Light*>( objData.mOwner[k] );
+                        if( light->getType() != Light::LT_VPL )
+                            outLights.push_back( light );
+                    }
+                }
+
+                objData.advancePack();
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool InstantRadiosity::beginProcessingLights(void)
+    {
         if( mNumRayBounces > 0 && (mSurvivingRayFraction <= 0 || mSurvivingRayFraction > 1.0f) )
         {
             OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
@@ -1421,11 +2076,6 @@ namespace Ogre
 
         mArrayRays = RawSimdUniquePtr<ArrayRay, MEMCATEGORY_GENERAL>( mTotalNumRays );
 
-        const uint32 lightMask = mLightMask & VisibilityFlags::RESERVED_VISIBILITY_FLAGS;
-
-        ObjectMemoryManager &memoryManager = mSceneManager->_getLightMemoryManager();
-        const size_t numRenderQueues = memoryManager.getNumRenderQueues();
-
         bool aoiAutogenerated = false;
         if( mAoI.empty() )
         {
@@ -1433,73 +2083,183 @@ namespace Ogre
             aoiAutogenerated = true;
         }
 
-        for( size_t i=0; i<numRenderQueues; ++i )
+        return aoiAutogenerated;
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::endProcessingLights( bool aoiAutogenerated )
+    {
+        //Free memory
+        mArrayRays = RawSimdUniquePtr<ArrayRay, MEMCATEGORY_GENERAL>();
+
+        if( aoiAutogenerated )
+            mAoI.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::processLight( Light *light )
+    {
+        assert( mVpls.empty() );
+
+        Node *lightNode = light->getParentNode();
+        Vector3 diffuseCol;
+        ColourValue lightColour = light->getDiffuseColour() * light->getPowerScale();
+        diffuseCol.x = lightColour.r;
+        diffuseCol.y = lightColour.g;
+        diffuseCol.z = lightColour.b;
+
+        Real lightRange = light->getAttenuationRange();
+        if( light->getType() == Light::LT_DIRECTIONAL )
+            lightRange = std::numeric_limits<Real>::max();
+
+        size_t numAoI = mAoI.size();
+
+        if( light->getType() != Light::LT_DIRECTIONAL )
+            numAoI = 1;
+
+        for( size_t l=0; l<numAoI; ++l )
         {
-            ObjectData objData;
-            const size_t totalObjs = memoryManager.getFirstObjectData( objData, i );
+            const AreaOfInterest &areaOfInterest = mAoI[l];
+            processLight( lightNode->_getDerivedPosition(),
+                          lightNode->_getDerivedOrientation(),
+                          light->getType(),
+                          light->getSpotlightOuterAngle(),
+                          diffuseCol,
+                          lightRange,
+                          light->getAttenuationConstant(),
+                          light->getAttenuationLinear(),
+                          light->getAttenuationQuadric(),
+                          areaOfInterest );
+        }
 
-            for( size_t j=0; j<totalObjs; j += ARRAY_PACKED_REALS )
-            {
-                for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
-                {
-                    uint32 * RESTRICT_ALIAS visibilityFlags = objData.mVisibilityFlags;
+        //light->setPowerScale( Math::PI * 4 );
+        //light->setPowerScale( 0 );
 
-                    if( visibilityFlags[k] & VisibilityFlags::LAYER_VISIBILITY &&
-                        visibilityFlags[k] & lightMask )
-                    {
-                        Light *light = static_cast<Light*>( objData.mOwner[k] );
-                        if( light->getType() != Light::LT_VPL )
-                        {
-                            Node *lightNode = light->getParentNode();
-                            Vector3 diffuseCol;
-                            ColourValue lightColour = light->getDiffuseColour() * light->getPowerScale();
-                            diffuseCol.x = lightColour.r;
-                            diffuseCol.y = lightColour.g;
-                            diffuseCol.z = lightColour.b;
+        //Keep them separate from the other lights, so we can update them individually.
+        VplVec &lightVpls = mVplsPerLight[light];
+        lightVpls.swap( mVpls );
+        mVpls.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::mergeVplsFromAllLights( VplVec &oldVpls )
+    {
+        mVpls.clear();
 
-                            Real lightRange = light->getAttenuationRange();
-                            if( light->getType() == Light::LT_DIRECTIONAL )
-                                lightRange = std::numeric_limits<Real>::max();
+        //Concatenate in the same order build() processes the lights.
+        vector<Light*>::type lights;
+        getLightsToProcess( lights );
 
-                            size_t numAoI = mAoI.size();
+        vector<Light*>::type::const_iterator itLight = lights.begin();
+        vector<Light*>::type::const_iterator enLight = lights.end();
 
-                            if( light->getType() != Light::LT_DIRECTIONAL )
-                                numAoI = 1;
+        while( itLight != enLight )
+        {
+            VplsPerLightMap::const_iterator itVpls = mVplsPerLight.find( *itLight );
+            if( itVpls != mVplsPerLight.end() )
+                mVpls.insert( mVpls.end(), itVpls->second.begin(), itVpls->second.end() );
+            ++itLight;
+        }
 
-                            for( size_t l=0; l<numAoI; ++l )
-                            {
-                                const AreaOfInterest &areaOfInterest = mAoI[l];
-                                processLight( lightNode->_getDerivedPosition(),
-                                              lightNode->_getDerivedOrientation(),
-                                              light->getType(),
-                                              light->getSpotlightOuterAngle(),
-                                              diffuseCol,
-                                              lightRange,
-                                              light->getAttenuationConstant(),
-                                              light->getAttenuationLinear(),
-                                              light->getAttenuationQuadric(),
-                                              areaOfInterest );
-                            }
+        clusterAllVpls();
 
-                            //light->setPowerScale( Math::PI * 4 );
-                            //light->setPowerScale( 0 );
-                        }
-                    }
-                }
+        //Reuse the Light objects from the old VPLs instead of destroying them
+        //and creating new ones. updateExistingVpls will take care of the rest.
+        VplVec::iterator itNew = mVpls.begin();
+        VplVec::iterator enNew = mVpls.end();
+        VplVec::const_iterator itOld = oldVpls.begin();
+        VplVec::const_iterator enOld = oldVpls.end();
 
-                objData.advancePack();
+        while( itOld != enOld )
+        {
+            if( itOld->light )
+            {
+                if( itNew != enNew )
+                {
+                    itNew->light = itOld->light;
+                    itNew->light->getParentSceneNode()->setPosition( itNew->position );
+                    ++itNew;
+                }
+                else
+                {
+                    destroyVplLight( itOld->light );
+                }
             }
+
+            ++itOld;
         }
 
-        clusterAllVpls();
+        oldVpls.clear();
 
         updateExistingVpls();
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::destroyVplLight( Light *vplLight )
+    {
+        SceneNode *lightNode = vplLight->getParentSceneNode();
+        lightNode->getParentSceneNode()->removeAndDestroyChild( lightNode );
+        mSceneManager->destroyLight( vplLight );
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::build(void)
+    {
+        clear();
 
-        //Free memory
-        mArrayRays = RawSimdUniquePtr<ArrayRay, MEMCATEGORY_GENERAL>();
+        const bool aoiAutogenerated = beginProcessingLights();
 
-        if( aoiAutogenerated )
-            mAoI.clear();
+        vector<Light*>::type lights;
+        getLightsToProcess( lights );
+
+        vector<Light*>::type::const_iterator itor = lights.begin();
+        vector<Light*>::type::const_iterator end  = lights.end();
+
+        while( itor != end )
+        {
+            processLight( *itor );
+            ++itor;
+        }
+
+        endProcessingLights( aoiAutogenerated );
+
+        VplVec oldVpls;
+        mergeVplsFromAllLights( oldVpls );
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::updateLight( Light *light )
+    {
+        if( !mTotalNumRays )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "build must be called before updateLight",
+                         "InstantRadiosity::updateLight" );
+        }
+
+        VplVec oldVpls;
+        oldVpls.swap( mVpls );
+
+        mVplsPerLight.erase( light );
+
+        const bool aoiAutogenerated = beginProcessingLights();
+
+        vector<Light*>::type lights;
+        getLightsToProcess( lights );
+
+        if( std::find( lights.begin(), lights.end(), light ) != lights.end() )
+            processLight( light );
+
+        endProcessingLights( aoiAutogenerated );
+
+        mergeVplsFromAllLights( oldVpls );
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::removeLight( Light *light )
+    {
+        VplsPerLightMap::iterator itor = mVplsPerLight.find( light );
+        if( itor != mVplsPerLight.end() )
+        {
+            mVplsPerLight.erase( itor );
+
+            VplVec oldVpls;
+            oldVpls.swap( mVpls );
+            mergeVplsFromAllLights( oldVpls );
+        }
     }
     //-----------------------------------------------------------------------------------
     void InstantRadiosity::freeMemory(void)
@@ -1511,6 +2271,7 @@ namespace Ogre
             while( itor != end )
             {
                 MeshData &meshData = itor->second;
+                meshData.destroyBvh();
                 OGRE_FREE_SIMD( meshData.vertexData, MEMCATEGORY_GEOMETRY );
                 meshData.vertexData = 0;
                 if( meshData.indexData && !itor->first->getIndexBuffer()->getShadowCopy() )
@@ -1530,6 +2291,7 @@ namespace Ogre
             while( itor != end )
             {
                 MeshData &meshData = itor->second;
+                meshData.destroyBvh();
                 OGRE_FREE_SIMD( meshData.vertexData, MEMCATEGORY_GEOMETRY );
                 meshData.vertexData = 0;
                 if( meshData.indexData )
@@ -1759,20 +2521,117 @@ namespace Ogre
         volume->setPowerScale( mVplPowerBoost );
         volume->setFadeAttenuationOverDistace( fadeAttenuationOverDistance );
 
-        const int32 volumeOriginX = static_cast<int32>( volumeOrigin.x );
-        const int32 volumeOriginY = static_cast<int32>( volumeOrigin.y );
-        const int32 volumeOriginZ = static_cast<int32>( volumeOrigin.z );
+        volume->clearVolumeData();
 
-        const Real invMaxPower = 1.0f / lightMaxPower;
+        VplVec &vplsInVolume = mVplsInIrradianceVolume[volume];
+        vplsInVolume = mVpls;
+        std::sort( vplsInVolume.begin(), vplsInVolume.end(), OrderVplByValue() );
 
-        const int32 numBlocksX = volume->getNumBlocksX();
-        const int32 numBlocksY = volume->getNumBlocksY();
-        const int32 numBlocksZ = volume->getNumBlocksZ();
+        VplVec::const_iterator itor = vplsInVolume.begin();
+        VplVec::const_iterator end  = vplsInVolume.end();
 
-        VplVec::const_iterator itor = mVpls.begin();
-        VplVec::const_iterator end  = mVpls.end();
+        while( itor != end )
+        {
+            const VplSplat splat = { &(*itor), Real( 1.0f ) };
+            mVplSplats.push_back( splat );
+            ++itor;
+        }
 
-        volume->clearVolumeData();
+        splatVplsToIrradianceVolume( volume );
+
+        volume->updateIrradianceVolumeTexture();
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::updateIrradianceVolume( IrradianceVolume *volume )
+    {
+        if (!volume) return;
+
+        VplsPerVolumeMap::iterator itVolume = mVplsInIrradianceVolume.find( volume );
+        if( itVolume == mVplsInIrradianceVolume.end() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "fillIrradianceVolume must be called on this volume before "
+                         "updateIrradianceVolume",
+                         "InstantRadiosity::updateIrradianceVolume" );
+        }
+
+        VplVec &vplsInVolume = itVolume->second;
+
+        VplVec newVpls( mVpls );
+        std::sort( newVpls.begin(), newVpls.end(), OrderVplByValue() );
+
+        //Both lists are sorted. Subtract the VPLs that are gone, add the new ones,
+        //and leave alone the ones that didn't change.
+        OrderVplByValue orderVplByValue;
+
+        VplVec::const_iterator itOld = vplsInVolume.begin();
+        VplVec::const_iterator enOld = vplsInVolume.end();
+        VplVec::const_iterator itNew = newVpls.begin();
+        VplVec::const_iterator enNew = newVpls.end();
+
+        while( itOld != enOld || itNew != enNew )
+        {
+            if( itNew == enNew || (itOld != enOld && orderVplByValue( *itOld, *itNew )) )
+            {
+                const VplSplat splat = { &(*itOld), Real( -1.0f ) };
+                mVplSplats.push_back( splat );
+                ++itOld;
+            }
+            else if( itOld == enOld || orderVplByValue( *itNew, *itOld ) )
+            {
+                const VplSplat splat = { &(*itNew), Real( 1.0f ) };
+                mVplSplats.push_back( splat );
+                ++itNew;
+            }
+            else
+            {
+                ++itOld;
+                ++itNew;
+            }
+        }
+
+        splatVplsToIrradianceVolume( volume );
+
+        vplsInVolume.swap( newVpls );
+
+        volume->updateIrradianceVolumeTexture();
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::removeIrradianceVolume( IrradianceVolume *volume )
+    {
+        mVplsInIrradianceVolume.erase( volume );
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::splatVplsToIrradianceVolume( IrradianceVolume *volume )
+    {
+        if( !mVplSplats.empty() )
+        {
+            mSplatVolume = volume;
+            mSceneManager->executeUserScalableTask( &mWorkerTask, true );
+            mSplatVolume = 0;
+        }
+
+        mVplSplats.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::addVplToIrradianceVolume( IrradianceVolume *volume, const Vpl &vpl,
+                                                     Real weight, int32 zStart, int32 zEnd )
+    {
+        const Vector3 cellSize = volume->getIrradianceCellSize();
+        const Vector3 invCellSize  = Real(1.0) / cellSize;
+
+        const bool fadeAttenuationOverDistance = volume->getFadeAttenuationOverDistace();
+
+        //The origin was quantized to a multiple of cellSize by fillIrradianceVolume.
+        const Vector3 volumeOrigin = volume->getIrradianceOrigin() * invCellSize;
+        const int32 volumeOriginX = static_cast<int32>( Math::Floor( volumeOrigin.x + 0.5f ) );
+        const int32 volumeOriginY = static_cast<int32>( Math::Floor( volumeOrigin.y + 0.5f ) );
+        const int32 volumeOriginZ = static_cast<int32>( Math::Floor( volumeOrigin.z + 0.5f ) );
+
+        const Real invMaxPower = 1.0f / volume->getIrradianceMaxPower();
+
+        const int32 numBlocksX = volume->getNumBlocksX();
+        const int32 numBlocksY = volume->getNumBlocksY();
 
         const Vector3 c_directions[6] =
         {
@@ -1784,92 +2643,84 @@ namespace Ogre
             Vector3(  0,  0, -1 )
         };
 
-        while( itor != end )
+        Real range = mVplMaxRange;
+        const Vector3 diffuseColForRange = vpl.diffuse * mVplPowerBoost;
+        if( mVplUseIntensityForMaxRange )
         {
-            const Vpl &vpl = *itor;
+            double intensity;
+            intensity = Ogre::max( diffuseColForRange.x, diffuseColForRange.y );
+            intensity = Ogre::max( intensity, (double)diffuseColForRange.z );
+            /*if( mVplQuadAtten != 0 )
+                intensity *= 1e-6 / mVplQuadAtten;*/
+            double rangeInMeters = sqrt( intensity );
+            range = (float)(rangeInMeters * mVplIntensityRangeMultiplier);
+        }
 
-            Real range = mVplMaxRange;
-            const Vector3 diffuseColForRange = vpl.diffuse * mVplPowerBoost;
-            if( mVplUseIntensityForMaxRange )
-            {
-                double intensity;
-                intensity = Ogre::max( diffuseColForRange.x, diffuseColForRange.y );
-                intensity = Ogre::max( intensity, (double)diffuseColForRange.z );
-                /*if( mVplQuadAtten != 0 )
-                    intensity *= 1e-6 / mVplQuadAtten;*/
-                double rangeInMeters = sqrt( intensity );
-                range = (float)(rangeInMeters * mVplIntensityRangeMultiplier);
-            }
+        range = Ogre::min( range, mVplMaxRange );
 
-            range = Ogre::min( range, mVplMaxRange );
+        const int32 xRange = static_cast<int32>( Math::Floor( range * invCellSize.x ) );
+        const int32 yRange = static_cast<int32>( Math::Floor( range * invCellSize.y ) );
+        const int32 zRange = static_cast<int32>( Math::Floor( range * invCellSize.z ) );
 
-            const int32 xRange = static_cast<int32>( Math::Floor( range * invCellSize.x ) );
-            const int32 yRange = static_cast<int32>( Math::Floor( range * invCellSize.y ) );
-            const int32 zRange = static_cast<int32>( Math::Floor( range * invCellSize.z ) );
-
-            int32 blockX = static_cast<int32>( Math::Floor( vpl.position.x * invCellSize.x ) );
-            int32 blockY = static_cast<int32>( Math::Floor( vpl.position.y * invCellSize.y ) );
-            int32 blockZ = static_cast<int32>( Math::Floor( vpl.position.z * invCellSize.z ) );
+        int32 blockX = static_cast<int32>( Math::Floor( vpl.position.x * invCellSize.x ) );
+        int32 blockY = static_cast<int32>( Math::Floor( vpl.position.y * invCellSize.y ) );
+        int32 blockZ = static_cast<int32>( Math::Floor( vpl.position.z * invCellSize.z ) );
 
-            blockX -= volumeOriginX;
-            blockY -= volumeOriginY;
-            blockZ -= volumeOriginZ;
+        blockX -= volumeOriginX;
+        blockY -= volumeOriginY;
+        blockZ -= volumeOriginZ;
 
-            const int32 minBlockX = std::max( 0, blockX - xRange );
-            const int32 minBlockY = std::max( 0, blockY - yRange );
-            const int32 minBlockZ = std::max( 0, blockZ - zRange );
+        const int32 minBlockX = std::max( 0, blockX - xRange );
+        const int32 minBlockY = std::max( 0, blockY - yRange );
+        const int32 minBlockZ = std::max( zStart, blockZ - zRange );
 
-            const int32 maxBlockX = std::min( numBlocksX - 1, blockX + xRange );
-            const int32 maxBlockY = std::min( numBlocksY - 1, blockY + yRange);
-            const int32 maxBlockZ = std::min( numBlocksZ - 1, blockZ + zRange);
+        const int32 maxBlockX = std::min( numBlocksX - 1, blockX + xRange );
+        const int32 maxBlockY = std::min( numBlocksY - 1, blockY + yRange);
+        const int32 maxBlockZ = std::min( zEnd - 1, blockZ + zRange);
 
-            if (maxBlockX >= 0 && minBlockX < numBlocksX &&
-                maxBlockY >= 0 && minBlockY < numBlocksY &&
-                maxBlockZ >= 0 && minBlockZ < numBlocksZ)
+        if (maxBlockX >= 0 && minBlockX < numBlocksX &&
+            maxBlockY >= 0 && minBlockY < numBlocksY &&
+            maxBlockZ >= zStart && minBlockZ < zEnd)
+        {
+            for( int32 z=minBlockZ; z<=maxBlockZ; ++z )
             {
-                for( int32 z=minBlockZ; z<=maxBlockZ; ++z )
+                for( int32 y=minBlockY; y<=maxBlockY; ++y )
                 {
-                    for( int32 y=minBlockY; y<=maxBlockY; ++y )
+                    for( int32 x=minBlockX; x<=maxBlockX; ++x )
                     {
-                        for( int32 x=minBlockX; x<=maxBlockX; ++x )
+                        Vector3 vplToCell = Vector3( x - blockX, y - blockY, z - blockZ );
+                        vplToCell *= cellSize;
+                        Real distance = vplToCell.normalise();
+                        if( vplToCell.dotProduct( vpl.normal ) < 0 )
+                            continue;
+
+                        Real atten = Real(1.0f) /
+                                (mVplConstAtten + (mVplLinearAtten +
+                                                   mVplQuadAtten * distance) * distance);
+                        atten = Ogre::min( Real(1.0f), atten );
+                        if( fadeAttenuationOverDistance )
+                            atten *= Ogre::max( (range - distance) / range, Ogre::Real( 0.0f ) );
+
+                        const Vector3 diffuseCol = vpl.diffuse * invMaxPower * atten;
+                        for( int i=0; i<6; ++i )
                         {
-                            Vector3 vplToCell = Vector3( x - blockX, y - blockY, z - blockZ );
-                            vplToCell *= cellSize;
-                            Real distance = vplToCell.normalise();
-                            if( vplToCell.dotProduct( vpl.normal ) < 0 )
-                                continue;
-
-                            Real atten = Real(1.0f) /
-                                    (mVplConstAtten + (mVplLinearAtten +
-                                                       mVplQuadAtten * distance) * distance);
-                            atten = Ogre::min( Real(1.0f), atten );
-                            if( fadeAttenuationOverDistance )
-                                atten *= Ogre::max( (range - distance) / range, Ogre::Real( 0.0f ) );
-
-                            const Vector3 diffuseCol = vpl.diffuse * invMaxPower * atten;
-                            for( int i=0; i<6; ++i )
+                            if( x != blockX || y != blockY || z != blockZ )
                             {
-                                if( x != blockX || y != blockY || z != blockZ )
-                                {
-                                    Vector3 finalCol = Ogre::max(
-                                                -vplToCell.dotProduct( c_directions[i] ),
-                                                0 ) * diffuseCol;
-                                    volume->changeVolumeData( x, y, z, i, finalCol );
-                                }
-                                else
-                                {
-                                    volume->changeVolumeData( x, y, z, i, vpl.dirDiffuse[i] * invMaxPower );
-                                }
+                                Vector3 finalCol = Ogre::max(
+                                            -vplToCell.dotProduct( c_directions[i] ),
+                                            0 ) * diffuseCol;
+                                volume->changeVolumeData( x, y, z, i, finalCol * weight );
+                            }
+                            else
+                            {
+                                volume->changeVolumeData( x, y, z, i,
+                                                          vpl.dirDiffuse[i] * invMaxPower * weight );
                             }
                         }
                     }
                 }
             }
-
-            ++itor;
         }
-
-        volume->updateIrradianceVolumeTexture();
     }
     //-----------------------------------------------------------------------------------
     //-----------------------------------------------------------------------------------
@@ -1918,4 +2769,109 @@ namespace Ogre
     {
         return vertexData + numVertices * 3u + uvSet * 2u;
     }
+    //-----------------------------------------------------------------------------------
+    size_t InstantRadiosity::MeshData::getNumTriangles(void) const
+    {
+        return (indexData ? numIndices : numVertices) / 3u;
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::MeshData::getTriangle( size_t triIdx, uint32 outVertexIdx[3] ) const
+    {
+        const size_t i = triIdx * 3u;
+
+        if( indexData )
+        {
+            if( useIndices16bit )
+            {
+                const uint16 * RESTRICT_ALIAS indexData16 =
+                        reinterpret_cast<const uint16 * RESTRICT_ALIAS>( indexData );
+                outVertexIdx[0] = indexData16[i+0];
+                outVertexIdx[1] = indexData16[i+1];
+                outVertexIdx[2] = indexData16[i+2];
+            }
+            else
+            {
+                const uint32 * RESTRICT_ALIAS indexData32 =
+                        reinterpret_cast<const uint32 * RESTRICT_ALIAS>( indexData );
+                outVertexIdx[0] = indexData32[i+0];
+                outVertexIdx[1] = indexData32[i+1];
+                outVertexIdx[2] = indexData32[i+2];
+            }
+        }
+        else
+        {
+            outVertexIdx[0] = static_cast<uint32>( i+0 );
+            outVertexIdx[1] = static_cast<uint32>( i+1 );
+            outVertexIdx[2] = static_cast<uint32>( i+2 );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    Vector3 InstantRadiosity::MeshData::getVertex( uint32 vertexIdx ) const
+    {
+        return Vector3( vertexData[vertexIdx * 3u + 0],
+                        vertexData[vertexIdx * 3u + 1],
+                        vertexData[vertexIdx * 3u + 2] );
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::MeshData::buildBvh(void)
+    {
+        destroyBvh();
+
+        const size_t numTriangles = getNumTriangles();
+
+        MeshBvhBuilder builder( numTriangles );
+        for( size_t i=0; i<numTriangles; ++i )
+        {
+            uint32 vertexIdx[3];
+            getTriangle( i, vertexIdx );
+            builder.addTriangle( getVertex( vertexIdx[0] ),
+                                 getVertex( vertexIdx[1] ),
+                                 getVertex( vertexIdx[2] ) );
+        }
+
+        builder.build();
+
+        const MeshBvhBuilder::NodeVec &nodes = builder.getNodes();
+        const vector<uint32>::type &triangles = builder.getTriangles();
+
+        if( nodes.empty() )
+            return;
+
+        numBvhNodes = nodes.size();
+        bvhNodes = reinterpret_cast<BvhNode*>( OGRE_MALLOC_SIMD( numBvhNodes * sizeof(BvhNode),
+                                                                 MEMCATEGORY_GEOMETRY ) );
+        bvhTriangles = reinterpret_cast<uint32*>( OGRE_MALLOC_SIMD( triangles.size() * sizeof(uint32),
+                                                                    MEMCATEGORY_GEOMETRY ) );
+        memcpy( bvhTriangles, &triangles[0], triangles.size() * sizeof(uint32) );
+
+        for( size_t i=0; i<numBvhNodes; ++i )
+        {
+            const MeshBvhBuilder::Node &srcNode = nodes[i];
+            BvhNode &dstNode = bvhNodes[i];
+
+            for( size_t j=0; j<4u; ++j )
+            {
+                dstNode.aabb[j / ARRAY_PACKED_REALS].setFromAabb( srcNode.aabb[j],
+                                                                  j % ARRAY_PACKED_REALS );
+                dstNode.childIdx[j]     = srcNode.childIdx[j];
+                dstNode.childCount[j]   = srcNode.childCount[j];
+            }
+            dstNode.numChildren = srcNode.numChildren;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::MeshData::destroyBvh(void)
+    {
+        if( bvhNodes )
+        {
+            OGRE_FREE_SIMD( bvhNodes, MEMCATEGORY_GEOMETRY );
+            bvhNodes = 0;
+        }
+        if( bvhTriangles )
+        {
+            OGRE_FREE_SIMD( bvhTriangles, MEMCATEGORY_GEOMETRY );
+            bvhTriangles = 0;
+        }
+        numBvhNodes = 0;
+    }
 }
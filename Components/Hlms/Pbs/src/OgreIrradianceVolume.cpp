@@ -35,6 +35,13 @@ THE SOFTWARE.
 
 #include "OgreTextureManager.h"
 #include "OgreHardwarePixelBuffer.h"
+#include "OgrePlatformInformation.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreUniformScalableTask.h"
+
+#if __OGRE_HAVE_SSE
+    #include <emmintrin.h>
+#endif
 
 namespace Ogre
 {
@@ -61,191 +68,279 @@ namespace Ogre
         destroyIrradianceVolumeTexture();
         freeMemory();
     }
-    //-----------------------------------------------------------------------------------
-    void IrradianceVolume::gaussFilter( float * RESTRICT_ALIAS dstData, float * RESTRICT_ALIAS srcData,
-                                        size_t texWidth, size_t texHeight, size_t texDepth )
+    namespace
     {
-        /*const float c_kernel[17] =
-        {
-            0.000078f, 0.000489f, 0.002403f, 0.009245f, 0.027835f, 0.065592f, 0.12098f, 0.17467f,
-            0.197417f,
-            0.17467f, 0.12098f, 0.065592f, 0.027835f, 0.009245f, 0.002403f, 0.000489f, 0.000078f
-        };
-
-        const int kernelStart = -8;
-        const int kernelEnd   =  8;*/
-        const float c_kernel[9] =
+        const float c_gaussKernel[9] =
         {
             0.028532f, 0.067234f, 0.124009f, 0.179044f,
             0.20236f,
             0.179044f, 0.124009f, 0.067234f, 0.028532f
         };
 
-        const int kernelStart = -4;
-        const int kernelEnd   =  4;
+        const int c_gaussKernelStart = -4;
+        const int c_gaussKernelEnd   =  4;
+
+        /** Weighted sum of (kEnd - kStart + 1) rows of numFloats floats, each srcStride
+            floats apart:
+                dst[i] = sum( src[i + k * srcStride] * kernel[k + kernelEnd] ) / divisor
+            Works for all three axes: along X the "rows" are the neighbouring texels (3
+            floats apart), along Y and Z they're whole rows and slices.
+        @remarks
+            The SSE2 path performs the same operations in the same order as the scalar
+            one, thus the results are bit-identical.
+        */
+        void filterRows( float * RESTRICT_ALIAS dstData, const float * RESTRICT_ALIAS srcData,
+                         size_t numFloats, size_t srcStride,
+                         const float * RESTRICT_ALIAS kernel, int kStart, int kEnd, int kernelEnd )
+        {
+            float divisor = 0;
+            for( int k=kStart; k<=kEnd; ++k )
+                divisor += kernel[k+kernelEnd];
+            const float invDivisor = 1.0f / divisor;
 
-        gaussFilterX( dstData, srcData, texWidth, texHeight, texDepth,
-                      c_kernel, kernelStart, kernelEnd );
-        gaussFilterY( srcData, dstData, texWidth, texHeight, texDepth,
-                      c_kernel, kernelStart, kernelEnd );
-        gaussFilterZ( dstData, srcData, texWidth, texHeight, texDepth,
-                      c_kernel, kernelStart, kernelEnd );
-    }
-    //-----------------------------------------------------------------------------------
-    void IrradianceVolume::gaussFilterX( float * RESTRICT_ALIAS dstData, float * RESTRICT_ALIAS srcData,
-                                         size_t texWidth, size_t texHeight, size_t texDepth,
-                                         const float * RESTRICT_ALIAS kernel,
-                                         int kernelStart, int kernelEnd )
-    {
-        const size_t rowPitch = texWidth * 3u;
-        const size_t slicePitch = rowPitch * texHeight;
+            const float *srcStart = srcData + kStart * static_cast<ptrdiff_t>( srcStride );
 
-        //X filter
-        for( size_t z=0; z<texDepth; ++z )
-        {
-            for( size_t y=0; y<texHeight; y += 6u )
+            size_t i = 0;
+#if __OGRE_HAVE_SSE
+            const __m128 vInvDivisor = _mm_set1_ps( invDivisor );
+            for( ; i + 4u <= numFloats; i += 4u )
             {
-                for( size_t x=0; x<texWidth; ++x )
+                __m128 accum = _mm_setzero_ps();
+                const float *srcPtr = srcStart + i;
+
+                for( int k=kStart; k<=kEnd; ++k )
                 {
-                    const int kStart    = std::max<int>( -(int)x, kernelStart );
-                    const int kEnd      = std::min<int>( texWidth - 1 - x, kernelEnd );
+                    const __m128 kernelVal = _mm_set1_ps( kernel[k+kernelEnd] );
+                    accum = _mm_add_ps( accum, _mm_mul_ps( _mm_loadu_ps( srcPtr ), kernelVal ) );
+                    srcPtr += srcStride;
+                }
 
-                    for( int i=0; i<6; ++i )
-                    {
-                        float accumR = 0;
-                        float accumG = 0;
-                        float accumB = 0;
+                _mm_storeu_ps( dstData + i, _mm_mul_ps( accum, vInvDivisor ) );
+            }
+#endif
+            for( ; i<numFloats; ++i )
+            {
+                float accum = 0;
+                const float *srcPtr = srcStart + i;
 
-                        float divisor = 0;
+                for( int k=kStart; k<=kEnd; ++k )
+                {
+                    accum += *srcPtr * kernel[k+kernelEnd];
+                    srcPtr += srcStride;
+                }
 
-                        size_t srcIdx = z * slicePitch + (y + i) * rowPitch + (x + kStart) * 3u;
+                dstData[i] = accum * invDivisor;
+            }
+        }
 
-                        for( int k=kStart; k<=kEnd; ++k )
-                        {
-                            const float kernelVal = kernel[k+kernelEnd];
+        /// Filters the slices in range [zStart; zEnd) along the X axis.
+        void gaussFilterX( float * RESTRICT_ALIAS dstData, const float * RESTRICT_ALIAS srcData,
+                           size_t texWidth, size_t texHeight,
+                           const float * RESTRICT_ALIAS kernel, int kernelStart, int kernelEnd,
+                           size_t zStart, size_t zEnd )
+        {
+            const size_t rowPitch = texWidth * 3u;
+            const size_t slicePitch = rowPitch * texHeight;
 
-                            accumR += srcData[srcIdx+0] * kernelVal;
-                            accumG += srcData[srcIdx+1] * kernelVal;
-                            accumB += srcData[srcIdx+2] * kernelVal;
+            //Texels in [xBegin; xEnd) use the whole kernel, and are filtered all at once.
+            //The ones near the edges are filtered one by one.
+            const size_t xBegin = std::min<size_t>( texWidth, static_cast<size_t>( -kernelStart ) );
+            const size_t xEnd   = std::max<size_t>( xBegin, texWidth > static_cast<size_t>( kernelEnd ) ?
+                                                        texWidth - kernelEnd : 0u );
 
-                            divisor += kernelVal;
-                            srcIdx += 3;
-                        }
+            //X filter
+            for( size_t z=zStart; z<zEnd; ++z )
+            {
+                for( size_t y=0; y<texHeight; ++y )
+                {
+                    const size_t rowIdx = z * slicePitch + y * rowPitch;
+
+                    for( size_t x=0; x<xBegin; ++x )
+                    {
+                        const int kStart    = std::max<int>( -(int)x, kernelStart );
+                        const int kEnd      = std::min<int>( texWidth - 1 - x, kernelEnd );
+                        filterRows( dstData + rowIdx + x * 3u, srcData + rowIdx + x * 3u, 3u, 3u,
+                                    kernel, kStart, kEnd, kernelEnd );
+                    }
 
-                        float invDivisor = 1.0f / divisor;
-                        const size_t dstIdx = z * slicePitch + (y + i) * rowPitch + x * 3u;
+                    filterRows( dstData + rowIdx + xBegin * 3u, srcData + rowIdx + xBegin * 3u,
+                                (xEnd - xBegin) * 3u, 3u, kernel, kernelStart, kernelEnd, kernelEnd );
 
-                        dstData[dstIdx+0] = accumR * invDivisor;
-                        dstData[dstIdx+1] = accumG * invDivisor;
-                        dstData[dstIdx+2] = accumB * invDivisor;
+                    for( size_t x=xEnd; x<texWidth; ++x )
+                    {
+                        const int kStart    = std::max<int>( -(int)x, kernelStart );
+                        const int kEnd      = std::min<int>( texWidth - 1 - x, kernelEnd );
+                        filterRows( dstData + rowIdx + x * 3u, srcData + rowIdx + x * 3u, 3u, 3u,
+                                    kernel, kStart, kEnd, kernelEnd );
                     }
                 }
             }
         }
-    }
-    //-----------------------------------------------------------------------------------
-    void IrradianceVolume::gaussFilterY( float * RESTRICT_ALIAS dstData, float * RESTRICT_ALIAS srcData,
-                                         size_t texWidth, size_t texHeight, size_t texDepth,
-                                         const float * RESTRICT_ALIAS kernel,
-                                         int kernelStart, int kernelEnd )
-    {
-        const size_t rowPitch = texWidth * 3u;
-        const size_t slicePitch = rowPitch * texHeight;
 
-        //Y filter
-        for( size_t z=0; z<texDepth; ++z )
+        /// Filters the slices in range [zStart; zEnd) along the Y axis.
+        void gaussFilterY( float * RESTRICT_ALIAS dstData, const float * RESTRICT_ALIAS srcData,
+                           size_t texWidth, size_t texHeight,
+                           const float * RESTRICT_ALIAS kernel, int kernelStart, int kernelEnd,
+                           size_t zStart, size_t zEnd )
         {
-            for( size_t y=0; y<texHeight; y += 6u )
-            {
-                const int kStart    = std::max<int>( -(int)(y / 6u), kernelStart );
-                const int kEnd      = std::min<int>( (texHeight - 6u - y) / 6u, kernelEnd );
+            const size_t rowPitch = texWidth * 3u;
+            const size_t slicePitch = rowPitch * texHeight;
 
-                for( size_t x=0; x<texWidth; ++x )
+            //Y filter. The 6 rows (one per direction) of each block are contiguous
+            //and share the same kernel range, so they're filtered together.
+            for( size_t z=zStart; z<zEnd; ++z )
+            {
+                for( size_t y=0; y<texHeight; y += 6u )
                 {
-                    for( int i=0; i<6; ++i )
-                    {
-                        float accumR = 0;
-                        float accumG = 0;
-                        float accumB = 0;
-
-                        float divisor = 0;
+                    const int kStart    = std::max<int>( -(int)(y / 6u), kernelStart );
+                    const int kEnd      = std::min<int>( (texHeight - 6u - y) / 6u, kernelEnd );
 
-                        size_t srcIdx = z * slicePitch + (y + i + kStart * 6) * rowPitch + x * 3u;
-
-                        for( int k=kStart; k<=kEnd; ++k )
-                        {
-                            const float kernelVal = kernel[k+kernelEnd];
+                    const size_t idx = z * slicePitch + y * rowPitch;
+                    filterRows( dstData + idx, srcData + idx, rowPitch * 6u, rowPitch * 6u,
+                                kernel, kStart, kEnd, kernelEnd );
+                }
+            }
+        }
 
-                            accumR += srcData[srcIdx+0] * kernelVal;
-                            accumG += srcData[srcIdx+1] * kernelVal;
-                            accumB += srcData[srcIdx+2] * kernelVal;
+        /// Filters the rows in range [yStart; yEnd) of every slice along the Z axis, in place.
+        /// tmpData must hold texDepth rows.
+        void gaussFilterZ( float * RESTRICT_ALIAS data, float * RESTRICT_ALIAS tmpData,
+                           size_t texWidth, size_t texHeight, size_t texDepth,
+                           const float * RESTRICT_ALIAS kernel, int kernelStart, int kernelEnd,
+                           size_t yStart, size_t yEnd )
+        {
+            const size_t rowPitch = texWidth * 3u;
+            const size_t slicePitch = rowPitch * texHeight;
 
-                            divisor += kernelVal;
-                            srcIdx += rowPitch * 6u;
-                        }
+            //Z filter
+            for( size_t y=yStart; y<yEnd; ++y )
+            {
+                for( size_t z=0; z<texDepth; ++z )
+                {
+                    memcpy( tmpData + z * rowPitch, data + z * slicePitch + y * rowPitch,
+                            rowPitch * sizeof(float) );
+                }
 
-                        float invDivisor = 1.0f / divisor;
-                        const size_t dstIdx = z * slicePitch + (y + i) * rowPitch + x * 3u;
+                for( size_t z=0; z<texDepth; ++z )
+                {
+                    const int kStart    = std::max<int>( -(int)z, kernelStart );
+                    const int kEnd      = std::min<int>( texDepth - 1u - z, kernelEnd );
 
-                        dstData[dstIdx+0] = accumR * invDivisor;
-                        dstData[dstIdx+1] = accumG * invDivisor;
-                        dstData[dstIdx+2] = accumB * invDivisor;
-                    }
+                    filterRows( data + z * slicePitch + y * rowPitch, tmpData + z * rowPitch,
+                                rowPitch, rowPitch, kernel, kStart, kEnd, kernelEnd );
                 }
             }
         }
-    }
-    //-----------------------------------------------------------------------------------
-    void IrradianceVolume::gaussFilterZ( float * RESTRICT_ALIAS dstData, float * RESTRICT_ALIAS srcData,
-                                         size_t texWidth, size_t texHeight, size_t texDepth,
-                                         const float * RESTRICT_ALIAS kernel,
-                                         int kernelStart, int kernelEnd )
-    {
-        const size_t rowPitch = texWidth * 3u;
-        const size_t slicePitch = rowPitch * texHeight;
 
-        //Z filter
-        for( size_t z=0; z<texDepth; ++z )
+        /** Blurs the volume with a separable 9x9x9 gaussian filter along X, Y, then Z,
+            and optionally uploads it to the texture (if dstData isn't null).
+            The source data is preserved, see changeVolumeData.
+        @remarks
+            Runs in two phases. In the first one each thread filters a range of slices along
+            X & Y, and in the second one a range of rows along Z, since it needs the
+            neighbouring slices to be done.
+        */
+        class GaussFilterTask : public UniformScalableTask
         {
-            const int kStart    = std::max<int>( -(int)z, kernelStart );
-            const int kEnd      = std::min<int>( texDepth - 1u - z, kernelEnd );
+        public:
+            float const *volumeData;
+            float       *blurredVolumeData;
+            uint8       *dstData;
+            size_t      texWidth;
+            size_t      texHeight;
+            size_t      texDepth;
+            size_t      bytesPerPixel;
+            size_t      texRowPitch;
+            size_t      texSlicePitch;
+            bool        filterZ;
+
+            void run( size_t numThreads )
+            {
+                //Don't bother spawning threads that would have little to do
+                if( numThreads == 0u )
+                    numThreads = PlatformInformation::getNumLogicalCores();
+                const size_t numCells = texWidth * texHeight * texDepth;
+                numThreads = std::min( numThreads, std::max<size_t>( 1u, numCells >> 16u ) );
+
+                filterZ = false;
+                Threads::ExecuteUniformScalableTask( this, numThreads );
+                filterZ = true;
+                Threads::ExecuteUniformScalableTask( this, numThreads );
+            }
 
-            for( size_t y=0; y<texHeight; y += 6u )
+            virtual void execute( size_t threadId, size_t numThreads )
             {
-                for( size_t x=0; x<texWidth; ++x )
+                if( !filterZ )
+                    filterXY( threadId, numThreads );
+                else
+                    filterZAndUpload( threadId, numThreads );
+            }
+
+            void filterXY( size_t threadId, size_t numThreads )
+            {
+                const size_t zStart = (texDepth * threadId) / numThreads;
+                const size_t zEnd   = (texDepth * (threadId + 1u)) / numThreads;
+
+                if( zStart == zEnd )
+                    return;
+
+                const size_t slicePitch = texWidth * 3u * texHeight;
+
+                float *tmpSlice = reinterpret_cast<float*>(
+                            OGRE_MALLOC_SIMD( slicePitch * sizeof(float), MEMCATEGORY_GENERAL ) );
+
+                for( size_t z=zStart; z<zEnd; ++z )
                 {
-                    for( int i=0; i<6; ++i )
-                    {
-                        float accumR = 0;
-                        float accumG = 0;
-                        float accumB = 0;
+                    gaussFilterX( tmpSlice, volumeData + z * slicePitch, texWidth, texHeight,
+                                  c_gaussKernel, c_gaussKernelStart, c_gaussKernelEnd, 0, 1u );
+                    gaussFilterY( blurredVolumeData + z * slicePitch, tmpSlice, texWidth, texHeight,
+                                  c_gaussKernel, c_gaussKernelStart, c_gaussKernelEnd, 0, 1u );
+                }
 
-                        float divisor = 0;
+                OGRE_FREE_SIMD( tmpSlice, MEMCATEGORY_GENERAL );
+            }
 
-                        size_t srcIdx = (z + kStart) * slicePitch + (y + i) * rowPitch + x * 3u;
+            void filterZAndUpload( size_t threadId, size_t numThreads )
+            {
+                const size_t yStart = (texHeight * threadId) / numThreads;
+                const size_t yEnd   = (texHeight * (threadId + 1u)) / numThreads;
 
-                        for( int k=kStart; k<=kEnd; ++k )
-                        {
-                            const float kernelVal = kernel[k+kernelEnd];
+                if( yStart == yEnd )
+                    return;
 
-                            accumR += srcData[srcIdx+0] * kernelVal;
-                            accumG += srcData[srcIdx+1] * kernelVal;
-                            accumB += srcData[srcIdx+2] * kernelVal;
+                const size_t rowPitch = texWidth * 3u;
+                const size_t slicePitch = rowPitch * texHeight;
 
-                            divisor += kernelVal;
-                            srcIdx += slicePitch;
-                        }
+                float *tmpRows = reinterpret_cast<float*>(
+                            OGRE_MALLOC_SIMD( texDepth * rowPitch * sizeof(float),
+                                              MEMCATEGORY_GENERAL ) );
+
+                gaussFilterZ( blurredVolumeData, tmpRows, texWidth, texHeight, texDepth,
+                              c_gaussKernel, c_gaussKernelStart, c_gaussKernelEnd, yStart, yEnd );
 
-                        float invDivisor = 1.0f / divisor;
-                        const size_t dstIdx = z * slicePitch + (y + i) * rowPitch + x * 3u;
+                OGRE_FREE_SIMD( tmpRows, MEMCATEGORY_GENERAL );
 
-                        dstData[dstIdx+0] = accumR * invDivisor;
-                        dstData[dstIdx+1] = accumG * invDivisor;
-                        dstData[dstIdx+2] = accumB * invDivisor;
+                if( !dstData )
+                    return;
+
+                for( size_t z=0; z<texDepth; ++z )
+                {
+                    for( size_t y=yStart; y<yEnd; ++y )
+                    {
+                        for( size_t x=0; x<texWidth; ++x )
+                        {
+                            const size_t srcIdx = z * slicePitch + y * rowPitch + x * 3u;
+                            const size_t dstIdx = z * texSlicePitch + y * texRowPitch +
+                                                  x * bytesPerPixel;
+                            PixelUtil::packColour( blurredVolumeData[srcIdx+0],
+                                                   blurredVolumeData[srcIdx+1],
+                                                   blurredVolumeData[srcIdx+2], 1.0f,
+                                                   PF_A2R10G10B10, &dstData[dstIdx] );
+                        }
                     }
                 }
             }
-        }
+        };
     }
     //-----------------------------------------------------------------------------------
     void IrradianceVolume::createIrradianceVolumeTexture( uint32 numBlocksX, uint32 numBlocksY, uint32 numBlocksZ )
@@ -338,40 +433,26 @@ namespace Ogre
         }
     }
 
-    void IrradianceVolume::updateIrradianceVolumeTexture()
+    void IrradianceVolume::updateIrradianceVolumeTexture( size_t numThreads )
     {
         const int32 texWidth  = static_cast<int32>( mIrradianceVolume->getWidth() );
         const int32 texHeight = static_cast<int32>( mIrradianceVolume->getHeight() );
         const int32 texDepth  = static_cast<int32>( mIrradianceVolume->getDepth() );
 
-        gaussFilter( mBlurredVolumeData, mVolumeData, texWidth, texHeight, texDepth );
-
         const PixelBox &lockBox = mIrradianceVolume->getBuffer()->lock(
                             Box( 0, 0, 0, texWidth, texHeight, texDepth ), v1::HardwareBuffer::HBL_NORMAL );
 
-        const size_t bytesPerPixel = PixelUtil::getNumElemBytes( mIrradianceVolume->getFormat() );
-        const size_t texRowPitch = lockBox.rowPitchAlwaysBytes();
-        const size_t texSlicePitch = lockBox.slicePitchAlwaysBytes();
-
-        uint8 * RESTRICT_ALIAS dstData = reinterpret_cast<uint8 * RESTRICT_ALIAS>( lockBox.data );
-
-        const size_t rowPitch = texWidth * 3u;
-        const size_t slicePitch = rowPitch * texHeight;
-
-        for (size_t z = 0; z<(size_t)texDepth; ++z)
-        {
-            for( size_t y=0; y<(size_t)texHeight; ++y )
-            {
-                for( size_t x=0; x<(size_t)texWidth; ++x )
-                {
-                    const size_t srcIdx = z * slicePitch + y * rowPitch + x * 3u;
-                    const size_t dstIdx = z * texSlicePitch + y * texRowPitch + x * bytesPerPixel;
-                    PixelUtil::packColour( mBlurredVolumeData[srcIdx+0], mBlurredVolumeData[srcIdx+1],
-                                           mBlurredVolumeData[srcIdx+2], 1.0f,
-                                           PF_A2R10G10B10, &dstData[dstIdx] );
-                }
-            }
-        }
+        GaussFilterTask task;
+        task.volumeData         = mVolumeData;
+        task.blurredVolumeData  = mBlurredVolumeData;
+        task.dstData            = reinterpret_cast<uint8*>( lockBox.data );
+        task.texWidth           = texWidth;
+        task.texHeight          = texHeight;
+        task.texDepth           = texDepth;
+        task.bytesPerPixel      = PixelUtil::getNumElemBytes( mIrradianceVolume->getFormat() );
+        task.texRowPitch        = lockBox.rowPitchAlwaysBytes();
+        task.texSlicePitch      = lockBox.slicePitchAlwaysBytes();
+        task.run( numThreads );
 
         mIrradianceVolume->getBuffer()->unlock();
     }
@@ -109,6 +109,45 @@ namespace Ogre
         static const char* c_lightTypes[Light::NUM_LIGHT_TYPES+1u];
 
     public:
+        /// Flags of each scene node in scene.bin
+        enum BinarySceneNodeFlags
+        {
+            BinaryNodeStatic                = 1u << 0u,
+            BinaryNodeRoot                  = 1u << 1u,
+            BinaryNodeInheritOrientation    = 1u << 2u,
+            BinaryNodeInheritScale          = 1u << 3u
+        };
+
+        /// Flags of each renderable in scene.bin
+        enum BinarySceneRenderableFlags
+        {
+            BinaryRenderableV1Material              = 1u << 0u,
+            BinaryRenderablePolygonModeOverrideable = 1u << 1u,
+            BinaryRenderableUseIdentityView         = 1u << 2u,
+            BinaryRenderableUseIdentityProjection   = 1u << 3u
+        };
+
+        /** scene.bin holds the scene nodes & items of a scene exported with
+            SceneFormatExporter::setUseBinarySceneFile. Layout, in native endianness:
+                uint32 magic, version
+                uint32 numStrings; then per string: uint32 length + chars (not null terminated)
+                uint32 numNodes
+                    uint32 parentIdx[numNodes] (own index if it has no parent)
+                    uint32 nameIdx[numNodes] (c_binarySceneNoIdx if unnamed)
+                    uint8  flags[numNodes] (BinarySceneNodeFlags)
+                    Transforms in blocks of c_binarySceneBlockSize nodes, like ArrayVector3 &
+                    ArrayQuaternion store them in NodeMemoryManager:
+                        float posX[4], posY[4], posZ[4],
+                              rotW[4], rotX[4], rotY[4], rotZ[4],
+                              scaleX[4], scaleY[4], scaleZ[4]
+                uint32 numItems; then per item, see SceneFormatExporter::exportItemsBinary
+            Scene nodes are sorted so that parents always come before their children.
+        */
+        static const uint32 c_binarySceneMagic;
+        static const uint32 c_binarySceneVersion;
+        static const uint32 c_binarySceneBlockSize;
+        static const uint32 c_binarySceneNoIdx;
+
         SceneFormatBase( Root *root, SceneManager *sceneManager );
         ~SceneFormatBase();
 
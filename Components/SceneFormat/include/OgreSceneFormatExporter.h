@@ -35,6 +35,7 @@ namespace Ogre
 {
     class LwString;
     class InstantRadiosity;
+    struct SceneFormatBinaryWriter;
 
     /** \addtogroup Component
     *  @{
@@ -60,6 +61,7 @@ namespace Ogre
         MeshV1Set   mExportedMeshesV1;
 
         bool mUseBinaryFloatingPoint;
+        bool mUseBinarySceneFile;
         uint8 mCurrentBinFloat;
         uint8 mCurrentBinDouble;
         char mFloatBinTmpString[24][64];
@@ -95,10 +97,16 @@ namespace Ogre
 
         static inline void flushLwString( LwString &jsonStr, String &outJson );
 
+        typedef vector<SceneNode*>::type SceneNodeVec;
+        /// Gathers the scene nodes to export in breadth first order, and fills mNodeToIdxMap.
+        void collectSceneNodes( SceneNodeVec &outSceneNodes );
+
         void exportNode( LwString &jsonStr, String &outJson, Node *node );
         void exportSceneNode( LwString &jsonStr, String &outJson, SceneNode *sceneNode );
         void exportRenderable( LwString &jsonStr, String &outJson, Renderable *renderable );
         void exportMovableObject( LwString &jsonStr, String &outJson, MovableObject *movableObject );
+        /// Saves the mesh to the v2 folder, if not saved already and the listener allows it.
+        void exportMesh( const Mesh *mesh );
         void exportItem( LwString &jsonStr, String &outJson, Item *item, bool exportMesh );
         void exportLight( LwString &jsonStr, String &outJson, Light *light );
         void exportEntity( LwString &jsonStr, String &outJson, v1::Entity *entity, bool exportMesh );
@@ -110,6 +118,19 @@ namespace Ogre
         void exportPcc( LwString &jsonStr, String &outJson );
         void exportSceneSettings( LwString &jsonStr, String &outJson, uint32 exportFlags );
 
+        void exportSceneNodesBinary( SceneFormatBinaryWriter &writer, const SceneNodeVec &sceneNodes );
+        /** Per item, in scene.bin:
+                uint32 meshNameIdx, parentNodeIdx, nameIdx
+                uint8  renderQueue, isStatic
+                float  aabbCenter[3], aabbHalfSize[3], localRadius, renderingDistance
+                uint32 visibilityFlags, queryFlags, lightMask
+                uint32 numSubItems; then per sub item:
+                    uint32 datablockNameIdx
+                    uint8  flags (BinarySceneRenderableFlags), customParameter, renderQueueSubGroup
+                    uint32 numCustomParameters; then per parameter: uint32 idx, float value[4]
+        */
+        void exportItemsBinary( SceneFormatBinaryWriter &writer, uint32 exportFlags );
+
         /**
         @param outJson
         @param exportFlags
@@ -118,7 +139,7 @@ namespace Ogre
             Note that excluding scene nodes can cause issues later during import.
         */
         void _exportScene( String &outJson, set<String>::type &savedTextures,
-                           uint32 exportFlags=~0u );
+                           uint32 exportFlags=~0u, vector<uint8>::type *outBinary=0 );
 
     public:
         SceneFormatExporter( Root *root, SceneManager *sceneManager,
@@ -147,14 +168,32 @@ namespace Ogre
         void setUseBinaryFloatingPoint( bool useBinaryFp );
         bool getUseBinaryFloatingPoint(void);
 
+        /** When enabled, exportSceneToFile writes scene nodes and items to a compact
+            binary scene.bin file next to scene.json, instead of into scene.json.
+            Large scenes are much smaller and import much faster this way.
+            See SceneFormatBase::c_binarySceneMagic for the layout.
+            Everything else (lights, decals, settings, etc) still goes to scene.json.
+        @remarks
+            Has no effect on exportScene, which writes the binary scene only when
+            asked to via its outBinaryScene argument.
+        @param useBinarySceneFile
+            Default: false.
+        */
+        void setUseBinarySceneFile( bool useBinarySceneFile );
+        bool getUseBinarySceneFile(void) const;
+
         /**
         @param outJson
         @param exportFlags
             Combination of SceneFlags::SceneFlags, to know what to export and what to exclude.
             Defaults to exporting everything.
             Note that excluding scene nodes can cause issues later during import.
+        @param outBinaryScene
+            When not null, scene nodes and items are written here in the scene.bin
+            format instead of into outJson. See setUseBinarySceneFile.
         */
-        void exportScene( String &outJson, uint32 exportFlags=~SceneFlags::TexturesOriginal );
+        void exportScene( String &outJson, uint32 exportFlags=~SceneFlags::TexturesOriginal,
+                          vector<uint8>::type *outBinaryScene=0 );
 
         void exportSceneToFile( const String &folderPath,
                                 uint32 exportFlags=~SceneFlags::TexturesOriginal );
@@ -50,6 +50,8 @@ namespace Ogre
     class LwString;
     class InstantRadiosity;
     class IrradianceVolume;
+    struct SceneFormatBinaryReader;
+    class SceneFormatNodeTransformTask;
 
     /** \addtogroup Component
     *  @{
@@ -118,8 +120,40 @@ namespace Ogre
         void importPcc( const rapidjson::Value &pccValue );
         void importSceneSettings( const rapidjson::Value &json, uint32 importFlags );
 
+        /** Creates the scene nodes of scene.bin in one pass (parents always come first).
+            Their transforms are applied afterwards with outTransformTask, which can
+            run in the SceneManager's worker threads.
+        */
+        void importSceneNodesBinary( SceneFormatBinaryReader &reader,
+                                     vector<SceneNode*>::type &outSceneNodes,
+                                     SceneFormatNodeTransformTask &outTransformTask );
+        /// Reads past the items of scene.bin, collecting the meshes they use.
+        void gatherMeshesBinary( SceneFormatBinaryReader &reader, vector<String>::type &outMeshNames );
+        void importItemsBinary( SceneFormatBinaryReader &reader );
+        /** Imports scene.bin. See SceneFormatBase::c_binarySceneMagic
+        @remarks
+            While the scene nodes are being created, the mesh files are opened and read
+            into memory by the SceneManager's worker threads. Parsing the meshes & creating
+            their GPU buffers still happens in the calling thread.
+        @par
+            Materials aren't loaded here. Their scripts are parsed (and their textures
+            loaded) when importSceneFromFile initialises the resource group, before the
+            scene is imported; that goes through the script compilers, HlmsManager and
+            HlmsTextureManager, none of which are thread safe. By the time the items
+            are created their datablocks already exist and only need to be looked up.
+        @param data
+            Contents of scene.bin
+        */
+        void importSceneBinary( const String &filename, const vector<uint8>::type &data,
+                                uint32 importFlags );
+
+        /**
+        @param binaryScene
+            Contents of scene.bin, if the json references it. Null otherwise.
+        */
         void importScene( const String &filename, const rapidjson::Document &d,
-                          uint32 importFlags=~SceneFlags::LightsVpl );
+                          uint32 importFlags=~SceneFlags::LightsVpl,
+                          const vector<uint8>::type *binaryScene=0 );
 
     public:
         /**
@@ -200,9 +234,13 @@ namespace Ogre
             By default LightsVpl is not set so that InstantRadiosity is regenerated.
             By setting LightsVpl and unsetting SceneFlags::BuildInstantRadiosity, you can speed up
             import time because the cached results will be loaded instead.
+        @param binaryScene
+            Contents of scene.bin, if the json references one (see
+            SceneFormatExporter::setUseBinarySceneFile). Null otherwise.
         */
         void importScene( const String &filename, const char *jsonString,
-                          uint32 importFlags=~SceneFlags::LightsVpl );
+                          uint32 importFlags=~SceneFlags::LightsVpl,
+                          const vector<uint8>::type *binaryScene=0 );
 
         void importSceneFromFile( const String &filename, uint32 importFlags=~SceneFlags::LightsVpl );
 
@@ -51,6 +51,11 @@ namespace Ogre
         "NUM_LIGHT_TYPES"
     };
 
+    const uint32 SceneFormatBase::c_binarySceneMagic    = 0x4E425345; // "ESBN"
+    const uint32 SceneFormatBase::c_binarySceneVersion  = 1u;
+    const uint32 SceneFormatBase::c_binarySceneBlockSize= 4u;
+    const uint32 SceneFormatBase::c_binarySceneNoIdx    = 0xFFFFFFFF;
+
     static DefaultSceneFormatListener sDefaultSceneFormatListener;
 
     SceneFormatBase::SceneFormatBase( Root *root, SceneManager *sceneManager ) :
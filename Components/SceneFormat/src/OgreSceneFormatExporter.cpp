@@ -76,11 +76,68 @@ THE SOFTWARE.
 
 namespace Ogre
 {
+    /// Accumulates the contents of scene.bin
+    struct SceneFormatBinaryWriter
+    {
+        typedef map<String, uint32>::type StringIndexMap;
+
+        StringIndexMap          stringIndices;
+        vector<String>::type    strings;
+        /// Everything after the string table
+        vector<uint8>::type     data;
+
+        template <typename T>
+        void write( const T &value )
+        {
+            const size_t offset = data.size();
+            data.resize( offset + sizeof(T) );
+            memcpy( &data[offset], &value, sizeof(T) );
+        }
+
+        /// Returns the index of the string in the string table, adding it if needed.
+        uint32 getStringIdx( const String &value )
+        {
+            if( value.empty() )
+                return SceneFormatBase::c_binarySceneNoIdx;
+
+            StringIndexMap::const_iterator itor = stringIndices.find( value );
+            if( itor != stringIndices.end() )
+                return itor->second;
+
+            const uint32 idx = static_cast<uint32>( strings.size() );
+            stringIndices[value] = idx;
+            strings.push_back( value );
+            return idx;
+        }
+
+        /// Writes the header, the string table and the data.
+        void flush( vector<uint8>::type &outBinary ) const
+        {
+            SceneFormatBinaryWriter header;
+            header.write( SceneFormatBase::c_binarySceneMagic );
+            header.write( SceneFormatBase::c_binarySceneVersion );
+            header.write( static_cast<uint32>( strings.size() ) );
+            vector<String>::type::const_iterator itor = strings.begin();
+            vector<String>::type::const_iterator end  = strings.end();
+            while( itor != end )
+            {
+                const uint32 length = static_cast<uint32>( itor->size() );
+                header.write( length );
+                header.data.insert( header.data.end(), itor->begin(), itor->end() );
+                ++itor;
+            }
+
+            outBinary.swap( header.data );
+            outBinary.insert( outBinary.end(), data.begin(), data.end() );
+        }
+    };
+    //-----------------------------------------------------------------------------------
     SceneFormatExporter::SceneFormatExporter( Root *root, SceneManager *sceneManager,
                                               InstantRadiosity *instantRadiosity ) :
         SceneFormatBase( root, sceneManager ),
         mInstantRadiosity( instantRadiosity ),
         mUseBinaryFloatingPoint( true ),
+        mUseBinarySceneFile( false ),
         mCurrentBinFloat( 0 ),
         mCurrentBinDouble( 0 )
     {
@@ -109,6 +166,16 @@ namespace Ogre
         return mUseBinaryFloatingPoint;
     }
     //-----------------------------------------------------------------------------------
+    void SceneFormatExporter::setUseBinarySceneFile( bool useBinarySceneFile )
+    {
+        mUseBinarySceneFile = useBinarySceneFile;
+    }
+    //-----------------------------------------------------------------------------------
+    bool SceneFormatExporter::getUseBinarySceneFile(void) const
+    {
+        return mUseBinarySceneFile;
+    }
+    //-----------------------------------------------------------------------------------
     const char* SceneFormatExporter::toQuotedStr( bool value )
     {
         return value ? "true" : "false";
@@ -434,6 +501,21 @@ namespace Ogre
         outJson += "\n\t\t\t}";
     }
     //-----------------------------------------------------------------------------------
+    void SceneFormatExporter::exportMesh( const Mesh *mesh )
+    {
+        //Export the mesh, if we haven't done that already
+        if( mExportedMeshes.find( mesh ) == mExportedMeshes.end() &&
+            mListener->exportMesh( mesh ) )
+        {
+            FileSystemLayer::createDirectory( mCurrentExportFolder + "/v2/" );
+
+            Ogre::MeshSerializer meshSerializer( mRoot->getRenderSystem()->getVaoManager() );
+            meshSerializer.exportMesh( mesh, mCurrentExportFolder + "/v2/" + mesh->getName(),
+                                       MESH_VERSION_LATEST );
+            mExportedMeshes.insert( mesh );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void SceneFormatExporter::exportItem( LwString &jsonStr, String &outJson, Item *item, bool exportMesh )
     {
         const Mesh *mesh = item->getMesh().get();
@@ -463,18 +545,8 @@ namespace Ogre
         }
         outJson += "\n\t\t\t]";
 
-        //Export the mesh, if we haven't done that already
-        if( exportMesh &&
-            mExportedMeshes.find( mesh ) == mExportedMeshes.end() &&
-            mListener->exportMesh( mesh ) )
-        {
-            FileSystemLayer::createDirectory( mCurrentExportFolder + "/v2/" );
-
-            Ogre::MeshSerializer meshSerializer( mRoot->getRenderSystem()->getVaoManager() );
-            meshSerializer.exportMesh( mesh, mCurrentExportFolder + "/v2/" + mesh->getName(),
-                                       MESH_VERSION_LATEST );
-            mExportedMeshes.insert( mesh );
-        }
+        if( exportMesh )
+            this->exportMesh( mesh );
     }
     //-----------------------------------------------------------------------------------
     void SceneFormatExporter::exportLight( LwString &jsonStr, String &outJson, Light *light )
@@ -939,8 +1011,227 @@ namespace Ogre
         flushLwString( jsonStr, outJson );
     }
     //-----------------------------------------------------------------------------------
+    void SceneFormatExporter::collectSceneNodes( SceneNodeVec &outSceneNodes )
+    {
+        for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+        {
+            SceneNode *rootSceneNode =
+                    mSceneManager->getRootSceneNode( static_cast<SceneMemoryMgrTypes>(i) );
+
+            mNodeToIdxMap[rootSceneNode] = static_cast<uint32>( outSceneNodes.size() );
+            outSceneNodes.push_back( rootSceneNode );
+
+            std::queue<SceneNode*> nodeQueue;
+            nodeQueue.push(rootSceneNode);
+
+            while( !nodeQueue.empty() )
+            {
+                SceneNode* frontNode = nodeQueue.front();
+                nodeQueue.pop();
+                Node::NodeVecIterator nodeItor = frontNode->getChildIterator();
+                while( nodeItor.hasMoreElements() )
+                {
+                    Node *node = nodeItor.getNext();
+                    SceneNode *sceneNode = dynamic_cast<SceneNode*>( node );
+
+                    if( sceneNode && mListener->exportSceneNode( sceneNode ) )
+                    {
+                        mNodeToIdxMap[sceneNode] = static_cast<uint32>( outSceneNodes.size() );
+                        outSceneNodes.push_back( sceneNode );
+                        nodeQueue.push( sceneNode );
+                    }
+                }
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatExporter::exportSceneNodesBinary( SceneFormatBinaryWriter &writer,
+                                                      const SceneNodeVec &sceneNodes )
+    {
+        const uint32 numNodes = static_cast<uint32>( sceneNodes.size() );
+        writer.write( numNodes );
+
+        for( uint32 i=0; i<numNodes; ++i )
+        {
+            uint32 parentIdx = i;
+            Node *parentNode = sceneNodes[i]->getParent();
+            if( parentNode )
+            {
+                NodeToIdxMap::const_iterator itor = mNodeToIdxMap.find( parentNode );
+                if( itor != mNodeToIdxMap.end() )
+                    parentIdx = itor->second;
+            }
+            writer.write( parentIdx );
+        }
+
+        for( uint32 i=0; i<numNodes; ++i )
+            writer.write( writer.getStringIdx( sceneNodes[i]->getName() ) );
+
+        for( uint32 i=0; i<numNodes; ++i )
+        {
+            const SceneNode *sceneNode = sceneNodes[i];
+            uint8 flags = 0;
+            if( sceneNode->isStatic() )
+                flags |= BinaryNodeStatic;
+            if( sceneNode == mSceneManager->getRootSceneNode( SCENE_DYNAMIC ) ||
+                sceneNode == mSceneManager->getRootSceneNode( SCENE_STATIC ) )
+            {
+                flags |= BinaryNodeRoot;
+            }
+            if( sceneNode->getInheritOrientation() )
+                flags |= BinaryNodeInheritOrientation;
+            if( sceneNode->getInheritScale() )
+                flags |= BinaryNodeInheritScale;
+            writer.write( flags );
+        }
+
+        for( uint32 i=0; i<numNodes; i += c_binarySceneBlockSize )
+        {
+            float block[10][4];
+            for( uint32 j=0; j<c_binarySceneBlockSize; ++j )
+            {
+                Vector3 position( Vector3::ZERO );
+                Quaternion orientation( Quaternion::IDENTITY );
+                Vector3 scale( Vector3::UNIT_SCALE );
+                if( i + j < numNodes )
+                {
+                    const SceneNode *sceneNode = sceneNodes[i + j];
+                    position    = sceneNode->getPosition();
+                    orientation = sceneNode->getOrientation();
+                    scale       = sceneNode->getScale();
+                }
+                block[0][j] = static_cast<float>( position.x );
+                block[1][j] = static_cast<float>( position.y );
+                block[2][j] = static_cast<float>( position.z );
+                block[3][j] = static_cast<float>( orientation.w );
+                block[4][j] = static_cast<float>( orientation.x );
+                block[5][j] = static_cast<float>( orientation.y );
+                block[6][j] = static_cast<float>( orientation.z );
+                block[7][j] = static_cast<float>( scale.x );
+                block[8][j] = static_cast<float>( scale.y );
+                block[9][j] = static_cast<float>( scale.z );
+            }
+            writer.write( block );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatExporter::exportItemsBinary( SceneFormatBinaryWriter &writer, uint32 exportFlags )
+    {
+        vector<Item*>::type items;
+        SceneManager::MovableObjectIterator movableObjects =
+                mSceneManager->getMovableObjectIterator( ItemFactory::FACTORY_TYPE_NAME );
+        while( movableObjects.hasMoreElements() )
+        {
+            Item *item = static_cast<Item*>( movableObjects.getNext() );
+            if( mListener->exportItem( item ) )
+                items.push_back( item );
+        }
+
+        writer.write( static_cast<uint32>( items.size() ) );
+
+        vector<Item*>::type::const_iterator itor = items.begin();
+        vector<Item*>::type::const_iterator end  = items.end();
+        while( itor != end )
+        {
+            Item *item = *itor;
+            const Mesh *mesh = item->getMesh().get();
+
+            uint32 parentNodeIdx = c_binarySceneNoIdx;
+            Node *parentNode = item->getParentNode();
+            if( parentNode )
+            {
+                NodeToIdxMap::const_iterator itNode = mNodeToIdxMap.find( parentNode );
+                if( itNode != mNodeToIdxMap.end() )
+                    parentNodeIdx = itNode->second;
+            }
+
+            writer.write( writer.getStringIdx( mesh->getName() ) );
+            writer.write( parentNodeIdx );
+            writer.write( writer.getStringIdx( item->getName() ) );
+
+            writer.write( static_cast<uint8>( item->getRenderQueueGroup() ) );
+            writer.write( static_cast<uint8>( item->isStatic() ) );
+
+            const Aabb localAabb = item->getLocalAabb();
+            const float floats[8] =
+            {
+                static_cast<float>( localAabb.mCenter.x ),
+                static_cast<float>( localAabb.mCenter.y ),
+                static_cast<float>( localAabb.mCenter.z ),
+                static_cast<float>( localAabb.mHalfSize.x ),
+                static_cast<float>( localAabb.mHalfSize.y ),
+                static_cast<float>( localAabb.mHalfSize.z ),
+                static_cast<float>( item->getLocalRadius() ),
+                static_cast<float>( item->getRenderingDistance() )
+            };
+            writer.write( floats );
+
+            const ObjectData &objData = item->_getObjectData();
+            writer.write( static_cast<uint32>( objData.mVisibilityFlags[objData.mIndex] ) );
+            writer.write( static_cast<uint32>( objData.mQueryFlags[objData.mIndex] ) );
+            writer.write( static_cast<uint32>( objData.mLightMask[objData.mIndex] ) );
+
+            const uint32 numSubItems = static_cast<uint32>( item->getNumSubItems() );
+            writer.write( numSubItems );
+            for( uint32 i=0; i<numSubItems; ++i )
+            {
+                const SubItem *subItem = item->getSubItem( i );
+
+                uint8 flags = 0;
+                uint32 datablockNameIdx;
+                if( !subItem->getMaterial() )
+                {
+                    HlmsDatablock *datablock = subItem->getDatablock();
+                    const String *datablockName = datablock->getNameStr();
+                    datablockNameIdx = writer.getStringIdx(
+                                           datablockName ? *datablockName :
+                                                           datablock->getName().getFriendlyText() );
+                }
+                else
+                {
+                    datablockNameIdx = writer.getStringIdx( subItem->getMaterial()->getName() );
+                    flags |= BinaryRenderableV1Material;
+                }
+                if( subItem->getPolygonModeOverrideable() )
+                    flags |= BinaryRenderablePolygonModeOverrideable;
+                if( subItem->getUseIdentityView() )
+                    flags |= BinaryRenderableUseIdentityView;
+                if( subItem->getUseIdentityProjection() )
+                    flags |= BinaryRenderableUseIdentityProjection;
+
+                writer.write( datablockNameIdx );
+                writer.write( flags );
+                writer.write( static_cast<uint8>( subItem->mCustomParameter ) );
+                writer.write( static_cast<uint8>( subItem->getRenderQueueSubGroup() ) );
+
+                const Renderable::CustomParameterMap &customParams = subItem->getCustomParameters();
+                writer.write( static_cast<uint32>( customParams.size() ) );
+                Renderable::CustomParameterMap::const_iterator itParam = customParams.begin();
+                Renderable::CustomParameterMap::const_iterator enParam = customParams.end();
+                while( itParam != enParam )
+                {
+                    const float value[4] =
+                    {
+                        static_cast<float>( itParam->second.x ),
+                        static_cast<float>( itParam->second.y ),
+                        static_cast<float>( itParam->second.z ),
+                        static_cast<float>( itParam->second.w )
+                    };
+                    writer.write( static_cast<uint32>( itParam->first ) );
+                    writer.write( value );
+                    ++itParam;
+                }
+            }
+
+            if( exportFlags & SceneFlags::Meshes )
+                exportMesh( mesh );
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void SceneFormatExporter::_exportScene( String &outJson, set<String>::type &savedTextures,
-                                            uint32 exportFlags )
+                                            uint32 exportFlags, vector<uint8>::type *outBinary )
     {
         mNodeToIdxMap.clear();
         mExportedMeshes.clear();
@@ -980,52 +1271,42 @@ namespace Ogre
 
         flushLwString( jsonStr, outJson );
 
+        SceneNodeVec sceneNodes;
         if( exportFlags & SceneFlags::SceneNodes )
+            collectSceneNodes( sceneNodes );
+
+        if( outBinary )
         {
-            uint32 nodeCount = 0;
+            outJson += ",\n\t\"binary_scene\" : \"scene.bin\"";
+
+            SceneFormatBinaryWriter writer;
+            exportSceneNodesBinary( writer, sceneNodes );
+            if( exportFlags & SceneFlags::Items )
+                exportItemsBinary( writer, exportFlags );
+            else
+                writer.write( static_cast<uint32>( 0u ) );
+            writer.flush( *outBinary );
+        }
 
+        if( (exportFlags & SceneFlags::SceneNodes) && !outBinary )
+        {
             outJson += ",\n\t\"scene_nodes\" :\n\t[";
-            for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+            SceneNodeVec::const_iterator itor = sceneNodes.begin();
+            SceneNodeVec::const_iterator end  = sceneNodes.end();
+            while( itor != end )
             {
-                SceneNode *rootSceneNode =
-                        mSceneManager->getRootSceneNode( static_cast<SceneMemoryMgrTypes>(i) );
-
-                mNodeToIdxMap[rootSceneNode] = nodeCount++;
-                if( i == 0 )
+                if( itor == sceneNodes.begin() )
                     outJson += "\n\t\t{";
                 else
                     outJson += ",\n\t\t{";
-                exportSceneNode( jsonStr, outJson, rootSceneNode );
+                exportSceneNode( jsonStr, outJson, *itor );
                 outJson += "\n\t\t}";
-
-                std::queue<SceneNode*> nodeQueue;
-                nodeQueue.push(rootSceneNode);
-
-                while( !nodeQueue.empty() )
-                {
-                    SceneNode* frontNode = nodeQueue.front();
-                    nodeQueue.pop();
-                    Node::NodeVecIterator nodeItor = frontNode->getChildIterator();
-                    while( nodeItor.hasMoreElements() )
-                    {
-                        Node *node = nodeItor.getNext();
-                        SceneNode *sceneNode = dynamic_cast<SceneNode*>( node );
-
-                        if( sceneNode && mListener->exportSceneNode( sceneNode ) )
-                        {
-                            mNodeToIdxMap[sceneNode] = nodeCount++;
-                            outJson += ",\n\t\t{";
-                            exportSceneNode( jsonStr, outJson, sceneNode );
-                            outJson += "\n\t\t}";
-                            nodeQueue.push( sceneNode );
-                        }
-                    }
-                }
+                ++itor;
             }
             outJson += "\n\t]";
         }
 
-        if( exportFlags & SceneFlags::Items )
+        if( (exportFlags & SceneFlags::Items) && !outBinary )
         {
             SceneManager::MovableObjectIterator movableObjects =
                     mSceneManager->getMovableObjectIterator( ItemFactory::FACTORY_TYPE_NAME );
@@ -1165,12 +1446,13 @@ namespace Ogre
         mNodeToIdxMap.clear();
     }
     //-----------------------------------------------------------------------------------
-    void SceneFormatExporter::exportScene( String &outJson, uint32 exportFlags )
+    void SceneFormatExporter::exportScene( String &outJson, uint32 exportFlags,
+                                           vector<uint8>::type *outBinaryScene )
     {
         mCurrentExportFolder.clear();
         set<String>::type savedTextures;
         _exportScene( outJson, savedTextures,
-                      exportFlags & ~(SceneFlags::Meshes | SceneFlags::MeshesV1) );
+                      exportFlags & ~(SceneFlags::Meshes | SceneFlags::MeshesV1), outBinaryScene );
     }
     //-----------------------------------------------------------------------------------
     void SceneFormatExporter::exportSceneToFile( const String &folderPath, uint32 exportFlags )
@@ -1184,13 +1466,27 @@ namespace Ogre
         set<String>::type savedTextures;
         {
             String jsonString;
-            _exportScene( jsonString, savedTextures, exportFlags );
+            vector<uint8>::type binaryScene;
+            _exportScene( jsonString, savedTextures, exportFlags,
+                          mUseBinarySceneFile ? &binaryScene : 0 );
 
             const String scenePath = folderPath + "/scene.json";
             std::ofstream file( scenePath.c_str(), std::ios::binary | std::ios::out );
             if( file.is_open() )
                 file.write( jsonString.c_str(), jsonString.size() );
             file.close();
+
+            if( mUseBinarySceneFile )
+            {
+                const String binaryScenePath = folderPath + "/scene.bin";
+                std::ofstream binaryFile( binaryScenePath.c_str(), std::ios::binary | std::ios::out );
+                if( binaryFile.is_open() && !binaryScene.empty() )
+                {
+                    binaryFile.write( reinterpret_cast<const char*>( &binaryScene[0] ),
+                                      static_cast<std::streamsize>( binaryScene.size() ) );
+                }
+                binaryFile.close();
+            }
         }
 
         if( exportFlags & SceneFlags::Materials )
@@ -55,12 +55,279 @@ THE SOFTWARE.
 #include "OgreFileSystemLayer.h"
 
 #include "OgreLogManager.h"
+#include "OgreMeshManager2.h"
+#include "OgreArchive.h"
+#include "OgreHlmsManager.h"
+#include "Threading/OgreUniformScalableTask.h"
 
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
 
 namespace Ogre
 {
+    /// Reads scene.bin. See SceneFormatBase::c_binarySceneMagic
+    struct SceneFormatBinaryReader
+    {
+        uint8 const             *data;
+        size_t                  size;
+        size_t                  offset;
+        String                  filename;
+        vector<String>::type    strings;
+
+        SceneFormatBinaryReader( const String &_filename, const vector<uint8>::type &_data ) :
+            data( _data.empty() ? 0 : &_data[0] ),
+            size( _data.size() ),
+            offset( 0 ),
+            filename( _filename )
+        {
+        }
+
+        /// Throws if there aren't numBytes left to read
+        void checkBounds( size_t numBytes ) const
+        {
+            if( size - offset < numBytes )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Binary scene " + filename + " is truncated or malformed",
+                             "SceneFormatBinaryReader::checkBounds" );
+            }
+        }
+
+        template <typename T>
+        void read( T &outValue )
+        {
+            checkBounds( sizeof(T) );
+            memcpy( &outValue, data + offset, sizeof(T) );
+            offset += sizeof(T);
+        }
+
+        template <typename T>
+        T read(void)
+        {
+            T retVal;
+            read( retVal );
+            return retVal;
+        }
+
+        void skip( size_t numBytes )
+        {
+            checkBounds( numBytes );
+            offset += numBytes;
+        }
+
+        const String& getString( uint32 idx ) const
+        {
+            if( idx == SceneFormatBase::c_binarySceneNoIdx )
+                return BLANKSTRING;
+
+            if( idx >= strings.size() )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Binary scene " + filename + " references string " +
+                             StringConverter::toString( idx ) + " which does not exist",
+                             "SceneFormatBinaryReader::getString" );
+            }
+
+            return strings[idx];
+        }
+
+        /// Reads the magic, version & string table.
+        void readHeader(void)
+        {
+            const uint32 magic = read<uint32>();
+            const uint32 version = read<uint32>();
+            if( magic != SceneFormatBase::c_binarySceneMagic )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             filename + " is not a binary scene file",
+                             "SceneFormatBinaryReader::readHeader" );
+            }
+            if( version != SceneFormatBase::c_binarySceneVersion )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Binary scene " + filename + " has version " +
+                             StringConverter::toString( version ) + " but we only support " +
+                             StringConverter::toString( SceneFormatBase::c_binarySceneVersion ),
+                             "SceneFormatBinaryReader::readHeader" );
+            }
+
+            const uint32 numStrings = read<uint32>();
+            //Each string takes at least 4 bytes. Don't let a corrupt count allocate GBs.
+            checkBounds( numStrings * sizeof(uint32) );
+            strings.resize( numStrings );
+            for( uint32 i=0; i<numStrings; ++i )
+            {
+                const uint32 length = read<uint32>();
+                checkBounds( length );
+                strings[i].assign( reinterpret_cast<const char*>( data + offset ), length );
+                offset += length;
+            }
+        }
+    };
+
+    /// Reads the mesh files into memory, so that the main thread only has to parse them.
+    class SceneFormatMeshPrefetchTask : public UniformScalableTask
+    {
+    public:
+        vector<String>::type        meshNames;
+        /// Where to open each file from, in the worker threads. Null if the main
+        /// thread already opened it, in which case its stream is already set.
+        vector<Archive*>::type      archives;
+        /// File names inside archives. Not necessarily the same as meshNames
+        /// when the file lives in a subfolder of a recursive location.
+        vector<String>::type        fileNames;
+        vector<DataStreamPtr>::type streams;
+
+        void addMesh( const String &meshName, const String &groupName, bool openInWorkers )
+        {
+            ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+
+            Archive *archive = 0;
+            String fileName;
+            if( openInWorkers )
+            {
+                //Only plain folders can be opened from several threads at once
+                FileInfoListPtr fileInfo = resourceGroupManager.findResourceFileInfo( groupName,
+                                                                                      meshName );
+                if( !fileInfo->empty() && fileInfo->front().archive->getType() == "FileSystem" )
+                {
+                    archive  = fileInfo->front().archive;
+                    fileName = fileInfo->front().filename;
+                }
+            }
+
+            meshNames.push_back( meshName );
+            archives.push_back( archive );
+            fileNames.push_back( fileName );
+            if( archive )
+                streams.push_back( DataStreamPtr() );
+            else
+                streams.push_back( resourceGroupManager.openResource( meshName, groupName ) );
+        }
+
+        virtual void execute( size_t threadId, size_t numThreads )
+        {
+            //Interleaved, since mesh sizes can be wildly different
+            const size_t numStreams = streams.size();
+            for( size_t i=threadId; i<numStreams; i += numThreads )
+            {
+                try
+                {
+                    DataStreamPtr fileStream = streams[i];
+                    if( archives[i] )
+                        fileStream = archives[i]->open( fileNames[i] );
+
+                    if( !fileStream.isNull() )
+                    {
+                        streams[i] = DataStreamPtr( OGRE_NEW MemoryDataStream( fileStream->getName(),
+                                                                               fileStream ) );
+                        fileStream->close();
+                    }
+                }
+                catch( Exception& )
+                {
+                    //Leave it to MeshManager, which will report the error from the main thread
+                    streams[i].setNull();
+                }
+            }
+        }
+    };
+
+    /// Hands the prefetched mesh files to MeshManager. Any other resource
+    /// goes through the listener that was set before us (if any).
+    class SceneFormatPrefetchLoadingListener : public ResourceLoadingListener
+    {
+        SceneFormatMeshPrefetchTask &mPrefetchTask;
+        ResourceLoadingListener     *mPrevListener;
+
+    public:
+        SceneFormatPrefetchLoadingListener( SceneFormatMeshPrefetchTask &prefetchTask,
+                                            ResourceLoadingListener *prevListener ) :
+            mPrefetchTask( prefetchTask ),
+            mPrevListener( prevListener )
+        {
+        }
+
+        virtual DataStreamPtr resourceLoading( const String &name, const String &group,
+                                               Resource *resource )
+        {
+            const size_t numStreams = mPrefetchTask.streams.size();
+            for( size_t i=0; i<numStreams; ++i )
+            {
+                if( mPrefetchTask.meshNames[i] == name && !mPrefetchTask.streams[i].isNull() )
+                {
+                    DataStreamPtr retVal = mPrefetchTask.streams[i];
+                    mPrefetchTask.streams[i].setNull();
+                    return retVal;
+                }
+            }
+
+            if( mPrevListener )
+                return mPrevListener->resourceLoading( name, group, resource );
+
+            return DataStreamPtr();
+        }
+
+        virtual void resourceStreamOpened( const String &name, const String &group,
+                                           Resource *resource, DataStreamPtr &dataStream )
+        {
+            if( mPrevListener )
+                mPrevListener->resourceStreamOpened( name, group, resource, dataStream );
+        }
+
+        virtual bool resourceCollision( Resource *resource, ResourceManager *resourceManager )
+        {
+            return mPrevListener && mPrevListener->resourceCollision( resource, resourceManager );
+        }
+    };
+
+    /// Applies the transforms in scene.bin. Each thread owns a range of blocks.
+    class SceneFormatNodeTransformTask : public UniformScalableTask
+    {
+    public:
+        uint8 const     *blockData;
+        uint8 const     *nodeFlags;
+        /// Unaligned uint32
+        uint8 const     *nameIdx;
+        SceneFormatBinaryReader const *reader;
+        SceneNode * const *sceneNodes;
+        uint32          numNodes;
+
+        virtual void execute( size_t threadId, size_t numThreads )
+        {
+            const uint32 blockSize = SceneFormatBase::c_binarySceneBlockSize;
+            const size_t numBlocks = (numNodes + blockSize - 1u) / blockSize;
+            const size_t blockStart = (numBlocks * threadId) / numThreads;
+            const size_t blockEnd   = (numBlocks * (threadId + 1u)) / numThreads;
+
+            for( size_t i=blockStart; i<blockEnd; ++i )
+            {
+                float block[10][4];
+                memcpy( block, blockData + i * sizeof(block), sizeof(block) );
+
+                const size_t nodeStart = i * blockSize;
+                const size_t nodeEnd = std::min<size_t>( nodeStart + blockSize, numNodes );
+                for( size_t j=nodeStart; j<nodeEnd; ++j )
+                {
+                    const size_t k = j - nodeStart;
+                    SceneNode *sceneNode = sceneNodes[j];
+                    sceneNode->setPosition( block[0][k], block[1][k], block[2][k] );
+                    sceneNode->setOrientation( block[3][k], block[4][k], block[5][k], block[6][k] );
+                    sceneNode->setScale( block[7][k], block[8][k], block[9][k] );
+                    sceneNode->setInheritOrientation(
+                                (nodeFlags[j] & SceneFormatBase::BinaryNodeInheritOrientation) != 0 );
+                    sceneNode->setInheritScale(
+                                (nodeFlags[j] & SceneFormatBase::BinaryNodeInheritScale) != 0 );
+
+                    uint32 idx;
+                    memcpy( &idx, nameIdx + j * sizeof(uint32), sizeof(uint32) );
+                    if( idx != SceneFormatBase::c_binarySceneNoIdx )
+                        sceneNode->setName( reader->getString( idx ) );
+                }
+            }
+        }
+    };
+    //-----------------------------------------------------------------------------------
     SceneFormatImporter::SceneFormatImporter( Root *root, SceneManager *sceneManager,
                                               const String &defaultPccWorkspaceName ) :
         SceneFormatBase( root, sceneManager ),
@@ -1341,8 +1608,341 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::importSceneNodesBinary( SceneFormatBinaryReader &reader,
+                                                      vector<SceneNode*>::type &outSceneNodes,
+                                                      SceneFormatNodeTransformTask &outTransformTask )
+    {
+        const uint32 numNodes = reader.read<uint32>();
+        const size_t numBlocks = (numNodes + c_binarySceneBlockSize - 1u) / c_binarySceneBlockSize;
+
+        const uint8 *parentIdxData = reader.data + reader.offset;
+        reader.skip( numNodes * sizeof(uint32) );
+        const uint8 *nameIdxData = reader.data + reader.offset;
+        reader.skip( numNodes * sizeof(uint32) );
+        const uint8 *flagsData = reader.data + reader.offset;
+        reader.skip( numNodes * sizeof(uint8) );
+        const uint8 *blockData = reader.data + reader.offset;
+        reader.skip( numBlocks * sizeof(float) * 10u * c_binarySceneBlockSize );
+
+        bool rootNodeUsed[NUM_SCENE_MEMORY_MANAGER_TYPES];
+        memset( rootNodeUsed, 0, sizeof(rootNodeUsed) );
+
+        outSceneNodes.reserve( outSceneNodes.size() + numNodes );
+
+        for( uint32 i=0; i<numNodes; ++i )
+        {
+            uint32 parentIdx, nameIdx;
+            memcpy( &parentIdx, parentIdxData + i * sizeof(uint32), sizeof(uint32) );
+            memcpy( &nameIdx, nameIdxData + i * sizeof(uint32), sizeof(uint32) );
+            const uint8 flags = flagsData[i];
+
+            //Validate it now, the transform task can't throw from the worker threads
+            reader.getString( nameIdx );
+
+            const SceneMemoryMgrTypes sceneNodeType = (flags & BinaryNodeStatic) ? SCENE_STATIC :
+                                                                                   SCENE_DYNAMIC;
+            SceneNode *sceneNode = 0;
+
+            if( parentIdx != i )
+            {
+                if( parentIdx > i )
+                {
+                    OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                                 "Node " + StringConverter::toString( i ) + " is child of " +
+                                 StringConverter::toString( parentIdx ) +
+                                 " which comes after it. This file is malformed: " + reader.filename,
+                                 "SceneFormatImporter::importSceneNodesBinary" );
+                }
+
+                sceneNode = outSceneNodes[parentIdx]->createChildSceneNode( sceneNodeType );
+            }
+            else if( flags & BinaryNodeRoot )
+            {
+                //Two nodes mapping to the same SceneNode would race in the transform task
+                if( rootNodeUsed[sceneNodeType] )
+                {
+                    OGRE_EXCEPT( Exception::ERR_DUPLICATE_ITEM,
+                                 "Root node is present twice. This file is malformed: " +
+                                 reader.filename,
+                                 "SceneFormatImporter::importSceneNodesBinary" );
+                }
+                rootNodeUsed[sceneNodeType] = true;
+                sceneNode = mRootNodes[sceneNodeType];
+            }
+            else
+            {
+                if( mParentlessRootNodes[sceneNodeType] )
+                    sceneNode = mParentlessRootNodes[sceneNodeType]->createChildSceneNode();
+                else
+                    sceneNode = mSceneManager->createSceneNode( sceneNodeType );
+            }
+
+            outSceneNodes.push_back( sceneNode );
+
+            //Indices are sorted, always insert at the end.
+            IndexToSceneNodeMap::iterator itNode = mCreatedSceneNodes.insert(
+                        mCreatedSceneNodes.end(), IndexToSceneNodeMap::value_type( i, sceneNode ) );
+            itNode->second = sceneNode;
+        }
+
+        outTransformTask.blockData  = blockData;
+        outTransformTask.nodeFlags  = flagsData;
+        outTransformTask.nameIdx    = nameIdxData;
+        outTransformTask.reader     = &reader;
+        outTransformTask.sceneNodes = outSceneNodes.empty() ? 0 : &outSceneNodes[0];
+        outTransformTask.numNodes   = numNodes;
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::gatherMeshesBinary( SceneFormatBinaryReader &reader,
+                                                  vector<String>::type &outMeshNames )
+    {
+        set<uint32>::type meshIndices;
+
+        const uint32 numItems = reader.read<uint32>();
+        for( uint32 i=0; i<numItems; ++i )
+        {
+            const uint32 meshIdx = reader.read<uint32>();
+            if( meshIdx != c_binarySceneNoIdx && meshIndices.insert( meshIdx ).second )
+                outMeshNames.push_back( reader.getString( meshIdx ) );
+
+            //parentNodeIdx, nameIdx, renderQueue, isStatic, floats, flags
+            reader.skip( sizeof(uint32) * 2u + sizeof(uint8) * 2u +
+                         sizeof(float) * 8u + sizeof(uint32) * 3u );
+
+            const uint32 numSubItems = reader.read<uint32>();
+            for( uint32 j=0; j<numSubItems; ++j )
+            {
+                //datablockNameIdx, flags, customParameter, renderQueueSubGroup
+                reader.skip( sizeof(uint32) + sizeof(uint8) * 3u );
+                const uint32 numCustomParams = reader.read<uint32>();
+                reader.skip( numCustomParams * (sizeof(uint32) + sizeof(float) * 4u) );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::importItemsBinary( SceneFormatBinaryReader &reader )
+    {
+        HlmsManager *hlmsManager = mRoot->getHlmsManager();
+
+        //Many items share the same datablock. Only look it up once.
+        typedef map<uint32, HlmsDatablock*>::type DatablockMap;
+        DatablockMap datablocks;
+
+        const uint32 numItems = reader.read<uint32>();
+        for( uint32 i=0; i<numItems; ++i )
+        {
+            const uint32 meshIdx        = reader.read<uint32>();
+            const uint32 parentNodeIdx  = reader.read<uint32>();
+            const uint32 nameIdx        = reader.read<uint32>();
+            const uint8 renderQueue     = reader.read<uint8>();
+            const bool isStatic         = reader.read<uint8>() != 0;
+            float floats[8];
+            reader.read( floats );
+            const uint32 visibilityFlags= reader.read<uint32>();
+            const uint32 queryFlags     = reader.read<uint32>();
+            const uint32 lightMask      = reader.read<uint32>();
+
+            const SceneMemoryMgrTypes sceneNodeType = isStatic ? SCENE_STATIC : SCENE_DYNAMIC;
+
+            Item *item = mSceneManager->createItem( reader.getString( meshIdx ),
+                                                    "SceneFormatImporter", sceneNodeType );
+
+            if( nameIdx != c_binarySceneNoIdx )
+                item->setName( reader.getString( nameIdx ) );
+
+            if( parentNodeIdx != c_binarySceneNoIdx )
+            {
+                IndexToSceneNodeMap::const_iterator itNode = mCreatedSceneNodes.find( parentNodeIdx );
+                if( itNode != mCreatedSceneNodes.end() )
+                    itNode->second->attachObject( item );
+                else
+                {
+                    LogManager::getSingleton().logMessage(
+                                "WARNING: MovableObject references SceneNode " +
+                                StringConverter::toString( parentNodeIdx ) +
+                                " which does not exist or couldn't be created" );
+                }
+            }
+
+            item->setRenderQueueGroup( renderQueue );
+            item->setLocalAabb( Aabb( Vector3( floats[0], floats[1], floats[2] ),
+                                      Vector3( floats[3], floats[4], floats[5] ) ) );
+
+            ObjectData &objData = item->_getObjectData();
+            objData.mLocalRadius[objData.mIndex] = floats[6];
+            item->setRenderingDistance( floats[7] );
+            objData.mVisibilityFlags[objData.mIndex]    = visibilityFlags;
+            objData.mQueryFlags[objData.mIndex]         = queryFlags;
+            objData.mLightMask[objData.mIndex]          = lightMask;
+
+            const uint32 numSubItems = reader.read<uint32>();
+            for( uint32 j=0; j<numSubItems; ++j )
+            {
+                const uint32 datablockNameIdx   = reader.read<uint32>();
+                const uint8 flags               = reader.read<uint8>();
+                const uint8 customParameter     = reader.read<uint8>();
+                const uint8 renderQueueSubGroup = reader.read<uint8>();
+                const uint32 numCustomParams    = reader.read<uint32>();
+
+                SubItem *subItem = j < item->getNumSubItems() ? item->getSubItem( j ) : 0;
+
+                for( uint32 k=0; k<numCustomParams; ++k )
+                {
+                    const uint32 idxCustomParam = reader.read<uint32>();
+                    float value[4];
+                    reader.read( value );
+                    if( subItem )
+                    {
+                        subItem->setCustomParameter( idxCustomParam,
+                                                     Vector4( value[0], value[1],
+                                                              value[2], value[3] ) );
+                    }
+                }
+
+                if( !subItem )
+                    continue;
+
+                if( datablockNameIdx != c_binarySceneNoIdx )
+                {
+                    const String &datablockName = reader.getString( datablockNameIdx );
+                    if( flags & BinaryRenderableV1Material )
+                    {
+                        subItem->setDatablockOrMaterialName(
+                                    datablockName,
+                                    ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME );
+                    }
+                    else
+                    {
+                        DatablockMap::const_iterator itDatablock = datablocks.find( datablockNameIdx );
+                        if( itDatablock == datablocks.end() )
+                        {
+                            HlmsDatablock *datablock = hlmsManager->getDatablock( datablockName );
+                            itDatablock = datablocks.insert(
+                                              DatablockMap::value_type( datablockNameIdx,
+                                                                        datablock ) ).first;
+                        }
+                        subItem->setDatablock( itDatablock->second );
+                    }
+                }
+
+                subItem->mCustomParameter = customParameter;
+                subItem->setRenderQueueSubGroup( renderQueueSubGroup );
+                subItem->setPolygonModeOverrideable(
+                            (flags & BinaryRenderablePolygonModeOverrideable) != 0 );
+                subItem->setUseIdentityView( (flags & BinaryRenderableUseIdentityView) != 0 );
+                subItem->setUseIdentityProjection(
+                            (flags & BinaryRenderableUseIdentityProjection) != 0 );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::importSceneBinary( const String &filename,
+                                                 const vector<uint8>::type &data,
+                                                 uint32 importFlags )
+    {
+        SceneFormatBinaryReader reader( filename, data );
+        reader.readHeader();
+
+        //Locate the items, which come after the scene nodes
+        const size_t nodesOffset = reader.offset;
+        {
+            const uint32 numNodes = reader.read<uint32>();
+            const size_t numBlocks = (numNodes + c_binarySceneBlockSize - 1u) /
+                                     c_binarySceneBlockSize;
+            reader.skip( numNodes * (sizeof(uint32) * 2u + sizeof(uint8)) +
+                         numBlocks * sizeof(float) * 10u * c_binarySceneBlockSize );
+        }
+        const size_t itemsOffset = reader.offset;
+
+        const bool bImportItems = (importFlags & SceneFlags::Items) != 0;
+
+        //Start opening & reading the mesh files from disk in the worker threads
+        //while we create the scene nodes.
+        SceneFormatMeshPrefetchTask prefetchTask;
+        if( bImportItems )
+        {
+            vector<String>::type meshNames;
+            gatherMeshesBinary( reader, meshNames );
+
+            ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+            MeshManager &meshManager = MeshManager::getSingleton();
+
+            //A loading listener may want to provide the streams itself. It
+            //gets asked from this thread, so let openResource deal with it.
+            const bool openInWorkers = resourceGroupManager.getLoadingListener() == 0;
+
+            vector<String>::type::const_iterator itor = meshNames.begin();
+            vector<String>::type::const_iterator end  = meshNames.end();
+            while( itor != end )
+            {
+                MeshPtr mesh = meshManager.getByName( *itor, "SceneFormatImporter" );
+                if( (mesh.isNull() || !mesh->isLoaded()) &&
+                    resourceGroupManager.resourceExists( "SceneFormatImporter", *itor ) )
+                {
+                    prefetchTask.addMesh( *itor, "SceneFormatImporter", openInWorkers );
+                }
+                ++itor;
+            }
+        }
+
+        const bool prefetchPending = !prefetchTask.meshNames.empty();
+        if( prefetchPending )
+            mSceneManager->executeUserScalableTask( &prefetchTask, false );
+
+        vector<SceneNode*>::type sceneNodes;
+        SceneFormatNodeTransformTask transformTask;
+        if( importFlags & SceneFlags::SceneNodes )
+        {
+            reader.offset = nodesOffset;
+            try
+            {
+                importSceneNodesBinary( reader, sceneNodes, transformTask );
+            }
+            catch( Exception& )
+            {
+                //prefetchTask lives in our stack
+                if( prefetchPending )
+                    mSceneManager->waitForPendingUserScalableTask();
+                throw;
+            }
+        }
+
+        if( prefetchPending )
+            mSceneManager->waitForPendingUserScalableTask();
+
+        if( !sceneNodes.empty() )
+        {
+            //Not worth waking up the worker threads for small scenes
+            if( sceneNodes.size() >= 1024u && mSceneManager->getNumWorkerThreads() > 1u )
+                mSceneManager->executeUserScalableTask( &transformTask, true );
+            else
+                transformTask.execute( 0, 1 );
+        }
+
+        if( bImportItems )
+        {
+            reader.offset = itemsOffset;
+
+            ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+            ResourceLoadingListener *prevListener = resourceGroupManager.getLoadingListener();
+            SceneFormatPrefetchLoadingListener loadingListener( prefetchTask, prevListener );
+            resourceGroupManager.setLoadingListener( &loadingListener );
+            try
+            {
+                importItemsBinary( reader );
+            }
+            catch( Exception& )
+            {
+                resourceGroupManager.setLoadingListener( prevListener );
+                throw;
+            }
+            resourceGroupManager.setLoadingListener( prevListener );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void SceneFormatImporter::importScene( const String &filename, const rapidjson::Document &d,
-                                           uint32 importFlags )
+                                           uint32 importFlags,
+                                           const vector<uint8>::type *binaryScene )
     {
         mUseBinaryFloatingPoint = true; //The default when setting is not present
 
@@ -1391,18 +1991,40 @@ namespace Ogre
         if( itor != d.MemberEnd() && itor->value.IsBool() )
             mUseBinaryFloatingPoint = itor->value.GetBool();
 
-        if( importFlags & SceneFlags::SceneNodes )
+        bool useBinaryScene = false;
+        itor = d.FindMember( "binary_scene" );
+        if( itor != d.MemberEnd() && itor->value.IsString() )
         {
-            itor = d.FindMember( "scene_nodes" );
-            if( itor != d.MemberEnd() && itor->value.IsArray() )
-                importSceneNodes( itor->value );
+            if( binaryScene )
+                useBinaryScene = true;
+            else
+            {
+                LogManager::getSingleton().logMessage(
+                            "WARNING: SceneFormatImporter::importScene " + filename +
+                            " stores its scene nodes and items in " + itor->value.GetString() +
+                            " but it wasn't provided. Use importSceneFromFile, "
+                            "or pass it to importScene.",
+                            LML_CRITICAL );
+            }
         }
 
-        if( importFlags & SceneFlags::Items )
+        if( useBinaryScene )
+            importSceneBinary( itor->value.GetString(), *binaryScene, importFlags );
+        else
         {
-            itor = d.FindMember( "items" );
-            if( itor != d.MemberEnd() && itor->value.IsArray() )
-                importItems( itor->value );
+            if( importFlags & SceneFlags::SceneNodes )
+            {
+                itor = d.FindMember( "scene_nodes" );
+                if( itor != d.MemberEnd() && itor->value.IsArray() )
+                    importSceneNodes( itor->value );
+            }
+
+            if( importFlags & SceneFlags::Items )
+            {
+                itor = d.FindMember( "items" );
+                if( itor != d.MemberEnd() && itor->value.IsArray() )
+                    importItems( itor->value );
+            }
         }
 
         if( importFlags & SceneFlags::Entities )
@@ -1489,7 +2111,8 @@ namespace Ogre
     }
     //-----------------------------------------------------------------------------------
     void SceneFormatImporter::importScene( const String &filename, const char *jsonString,
-                                           uint32 importFlags )
+                                           uint32 importFlags,
+                                           const vector<uint8>::type *binaryScene )
     {
         rapidjson::Document d;
         d.Parse( jsonString );
@@ -1503,7 +2126,7 @@ namespace Ogre
                          rapidjson::GetParseError_En( d.GetParseError() ) );
         }
 
-        importScene( filename, d, importFlags );
+        importScene( filename, d, importFlags, binaryScene );
     }
     //-----------------------------------------------------------------------------------
     void SceneFormatImporter::importSceneFromFile( const String &folderPath, uint32 importFlags )
@@ -1570,7 +2193,19 @@ namespace Ogre
             if( mUsingOitd )
                 hlmsManager->mAdditionalTextureExtensionsPerGroup.erase( "SceneFormatImporter" );
 
-            importScene( stream->getName(), d, importFlags );
+            vector<uint8>::type binaryScene;
+            itor = d.FindMember( "binary_scene" );
+            const bool hasBinaryScene = itor != d.MemberEnd() && itor->value.IsString();
+            if( hasBinaryScene )
+            {
+                DataStreamPtr binaryStream = resourceGroupManager.openResource(
+                                                 itor->value.GetString(), "SceneFormatImporter" );
+                binaryScene.resize( binaryStream->size() );
+                if( !binaryScene.empty() )
+                    binaryStream->read( &binaryScene[0], binaryScene.size() );
+            }
+
+            importScene( stream->getName(), d, importFlags, hasBinaryScene ? &binaryScene : 0 );
 
             resourceGroupManager.removeResourceLocation( folderPath + "/textures/", "SceneFormatImporter" );
             resourceGroupManager.removeResourceLocation( folderPath + "/v2/", "SceneFormatImporter" );
@@ -1296,6 +1296,25 @@ namespace Ogre
         */
         void finaliseLightmap(const Rect& rect, PixelBox* lightmapBox);
 
+        /// Number of threads to use for derived data calculations covering numRows rows
+        static size_t getNumDerivedDataThreads(long numRows);
+
+        /** Calculates the normals of the rows [yStart; yEnd) of rect.
+        @remarks
+            Called by calculateNormals, possibly from several threads at once.
+        @param rect Rectangle being calculated (already widened)
+        @param pData RGB data covering the whole rect, inverted in Y
+        */
+        void _calculateNormalsRows(const Rect& rect, long yStart, long yEnd, uint8* pData) const;
+
+        /** Calculates the lightmap of the rows [yStart; yEnd) of rect.
+        @remarks
+            Called by calculateLightmap, possibly from several threads at once.
+        @param rect Rectangle being calculated, in lightmap space
+        @param pData L8 data covering the whole rect, inverted in Y
+        */
+        void _calculateLightmapRows(const Rect& rect, long yStart, long yEnd, uint8* pData);
+
         /** Gets the resolution of the entire terrain (down one edge) at a 
             given LOD level. 
         */
@@ -1931,6 +1950,7 @@ namespace Ogre
         Real mCompositeMapDistance;
         String mResourceGroup;
         bool mUseVertexCompressionWhenAvailable;
+        uint32 mNumDerivedDataThreads;
 
     public:
         TerrainGlobalOptions();
@@ -2111,6 +2131,18 @@ namespace Ogre
          */
         void setUseVertexCompressionWhenAvailable(bool enable) { mUseVertexCompressionWhenAvailable = enable; }
 
+        /** Get the number of threads used to calculate the normals and the lightmap.
+        */
+        uint32 getNumDerivedDataThreads() const { return mNumDerivedDataThreads; }
+
+        /** Set the number of threads used to calculate the normals and the lightmap.
+        @remarks
+            The work is split in bands of rows which are processed in parallel
+            from within the derived data request. A value of 0 uses as many
+            threads as logical cores; 1 (the default) disables threading.
+        */
+        void setNumDerivedDataThreads(uint32 numThreads) { mNumDerivedDataThreads = numThreads; }
+
         /** Override standard Singleton retrieval.
         @remarks
         Why do we do this? Well, it's because the Singleton
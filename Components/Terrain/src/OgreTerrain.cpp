@@ -49,6 +49,13 @@ THE SOFTWARE.
 #include "OgreTimer.h"
 #include "OgreTerrainMaterialGeneratorA.h"
 #include "OgreNameGenerator.h"
+#include "OgrePlatformInformation.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreUniformScalableTask.h"
+
+#if __OGRE_HAVE_SSE
+    #include <emmintrin.h>
+#endif
 
 #if OGRE_PLATFORM == OGRE_PLATFORM_APPLE_IOS
 #include "macUtils.h"
@@ -116,6 +123,7 @@ namespace Ogre
         , mCompositeMapDistance(4000)
         , mResourceGroup(ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME)
         , mUseVertexCompressionWhenAvailable(true)
+        , mNumDerivedDataThreads(1)
     {
     }
     //---------------------------------------------------------------------
@@ -1885,7 +1893,9 @@ namespace Ogre
     //---------------------------------------------------------------------
     void Terrain::dirtyLightmapRect(const Rect& rect)
     {
-        mDirtyDerivedDataRect.merge(rect);
+        // Heights didn't change, so there's no need to recalculate deltas
+        // or normals; nor to widen the rect by the light direction.
+        mDirtyLightmapFromNeighboursRect.merge(rect);
 
         mModified = true;
 
@@ -1967,6 +1977,9 @@ namespace Ogre
         req.dirtyRect = rect;
         req.lightmapExtraDirtyRect = lightmapExtraRect;
         req.typeMask = typeMask;
+        // Only the lightmap can be dirty without the heights being dirty
+        if (rect.isNull())
+            req.typeMask = req.typeMask & DERIVED_DATA_LIGHTMAP;
         if (!mNormalMapRequired)
             req.typeMask = req.typeMask & ~DERIVED_DATA_NORMALS;
         if (!mLightMapRequired)
@@ -3233,6 +3246,7 @@ namespace Ogre
         {
             finaliseLightmap(ddres.lightmapUpdateRect, ddres.lightMapBox);
             mCompositeMapDirtyRect.merge(ddreq.dirtyRect);
+            mCompositeMapDirtyRect.merge(ddreq.lightmapExtraDirtyRect);
             mCompositeMapDirtyRectLightmapUpdate = true;
         }
         
@@ -3333,6 +3347,60 @@ namespace Ogre
         return currentLod;
     }
     //---------------------------------------------------------------------
+    namespace
+    {
+        /// Rows calculated in one go by a thread. Bands are interleaved between the
+        /// threads, since the cost varies a lot across the terrain (i.e. rays cast
+        /// over mountains take longer to march).
+        const long c_derivedDataBandHeight = 16;
+
+        struct CalculateNormalsTask : public UniformScalableTask
+        {
+            const Terrain   *terrain;
+            Rect            rect;
+            uint8           *pData;
+
+            virtual void execute( size_t threadId, size_t numThreads )
+            {
+                for( long y = rect.top + (long)threadId * c_derivedDataBandHeight; y < rect.bottom;
+                     y += (long)numThreads * c_derivedDataBandHeight )
+                {
+                    terrain->_calculateNormalsRows( rect, y,
+                                                    std::min( y + c_derivedDataBandHeight, rect.bottom ),
+                                                    pData );
+                }
+            }
+        };
+
+        struct CalculateLightmapTask : public UniformScalableTask
+        {
+            Terrain         *terrain;
+            Rect            rect;
+            uint8           *pData;
+
+            virtual void execute( size_t threadId, size_t numThreads )
+            {
+                for( long y = rect.top + (long)threadId * c_derivedDataBandHeight; y < rect.bottom;
+                     y += (long)numThreads * c_derivedDataBandHeight )
+                {
+                    terrain->_calculateLightmapRows( rect, y,
+                                                     std::min( y + c_derivedDataBandHeight, rect.bottom ),
+                                                     pData );
+                }
+            }
+        };
+    }
+    //---------------------------------------------------------------------
+    size_t Terrain::getNumDerivedDataThreads(long numRows)
+    {
+        size_t numThreads = TerrainGlobalOptions::getSingleton().getNumDerivedDataThreads();
+        if (!numThreads)
+            numThreads = PlatformInformation::getNumLogicalCores();
+
+        const size_t numBands = (size_t)((numRows + c_derivedDataBandHeight - 1) / c_derivedDataBandHeight);
+        return std::max<size_t>(1u, std::min(numThreads, numBands));
+    }
+    //---------------------------------------------------------------------
     PixelBox* Terrain::calculateNormals(const Rect &rect, Rect& finalRect)
     {
         // Widen the rectangle by 1 element in all directions since height
@@ -3350,59 +3418,155 @@ namespace Ogre
         PixelBox* pixbox = OGRE_NEW PixelBox(static_cast<uint32>(widenedRect.width()),
                                              static_cast<uint32>(widenedRect.height()), 1, PF_BYTE_RGB, pData);
 
+        CalculateNormalsTask task;
+        task.terrain    = this;
+        task.rect       = widenedRect;
+        task.pData      = pData;
+        Threads::ExecuteUniformScalableTask(&task, getNumDerivedDataThreads(widenedRect.height()));
+
+        finalRect = widenedRect;
+
+        return pixbox;
+    }
+    //---------------------------------------------------------------------
+    void Terrain::_calculateNormalsRows(const Rect& rect, long yStart, long yEnd, uint8* pData) const
+    {
+        // Cache the points of these rows (plus a border of 1 point) in SoA
+        // layout, so that the normals can be evaluated 4 at a time.
+        const long width = rect.width();
+        const long cacheWidth = width + 2;
+        const size_t cacheSize = (size_t)(cacheWidth * (yEnd - yStart + 2));
+
+        float* cacheX = static_cast<float*>(
+            OGRE_MALLOC_SIMD(cacheSize * 3u * sizeof(float), MEMCATEGORY_GENERAL));
+        float* cacheY = cacheX + cacheSize;
+        float* cacheZ = cacheY + cacheSize;
+
+        size_t cacheIdx = 0;
+        for (long y = yStart - 1; y <= yEnd; ++y)
+        {
+            for (long x = rect.left - 1; x <= rect.right; ++x)
+            {
+                Vector3 point;
+                getPointFromSelfOrNeighbour(x, y, &point);
+                cacheX[cacheIdx] = (float)point.x;
+                cacheY[cacheIdx] = (float)point.y;
+                cacheZ[cacheIdx] = (float)point.z;
+                ++cacheIdx;
+            }
+        }
+
         // Evaluate normal like this
         //  3---2---1
         //  | \ | / |
         //  4---P---0
         //  | / | \ |
         //  5---6---7
-
-        Plane plane;
-        for (long y = widenedRect.top; y < widenedRect.bottom; ++y)
+        // The normal is the average of the normals of the 8 triangles P-i-(i+1)
+        const long adjacentOffsets[9] =
         {
-            for (long x = widenedRect.left; x < widenedRect.right; ++x)
+            1, cacheWidth + 1, cacheWidth, cacheWidth - 1,
+            -1, -cacheWidth - 1, -cacheWidth, -cacheWidth + 1,
+            1
+        };
+
+        for (long y = yStart; y < yEnd; ++y)
+        {
+            // invert the Y to deal with image space
+            const long storeY = rect.bottom - y - 1;
+            uint8* pStore = pData + storeY * width * 3;
+            const float* rowX = cacheX + (y - yStart + 1) * cacheWidth + 1;
+            const float* rowY = cacheY + (y - yStart + 1) * cacheWidth + 1;
+            const float* rowZ = cacheZ + (y - yStart + 1) * cacheWidth + 1;
+
+            long x = 0;
+#if __OGRE_HAVE_SSE
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one  = _mm_set_ps1(1.0f);
+            const __m128 half255 = _mm_set_ps1(0.5f * 255.0f);
+            for (; x + 4 <= width; x += 4)
             {
-                Vector3 cumulativeNormal = Vector3::ZERO;
+                const __m128 px = _mm_loadu_ps(rowX + x);
+                const __m128 py = _mm_loadu_ps(rowY + x);
+                const __m128 pz = _mm_loadu_ps(rowZ + x);
 
-                // Build points to sample
-                Vector3 centrePoint;
-                Vector3 adjacentPoints[8];
-                getPointFromSelfOrNeighbour(x  , y,   &centrePoint);
-                getPointFromSelfOrNeighbour(x+1, y,   &adjacentPoints[0]);
-                getPointFromSelfOrNeighbour(x+1, y+1, &adjacentPoints[1]);
-                getPointFromSelfOrNeighbour(x,   y+1, &adjacentPoints[2]);
-                getPointFromSelfOrNeighbour(x-1, y+1, &adjacentPoints[3]);
-                getPointFromSelfOrNeighbour(x-1, y,   &adjacentPoints[4]);
-                getPointFromSelfOrNeighbour(x-1, y-1, &adjacentPoints[5]);
-                getPointFromSelfOrNeighbour(x,   y-1, &adjacentPoints[6]);
-                getPointFromSelfOrNeighbour(x+1, y-1, &adjacentPoints[7]);
+                __m128 ax = _mm_sub_ps(_mm_loadu_ps(rowX + x + adjacentOffsets[0]), px);
+                __m128 ay = _mm_sub_ps(_mm_loadu_ps(rowY + x + adjacentOffsets[0]), py);
+                __m128 az = _mm_sub_ps(_mm_loadu_ps(rowZ + x + adjacentOffsets[0]), pz);
 
+                __m128 nx = zero, ny = zero, nz = zero;
                 for (int i = 0; i < 8; ++i)
                 {
-                    plane.redefine(centrePoint, adjacentPoints[i], adjacentPoints[(i+1)%8]);
-                    cumulativeNormal += plane.normal;
+                    const __m128 bx = _mm_sub_ps(_mm_loadu_ps(rowX + x + adjacentOffsets[i+1]), px);
+                    const __m128 by = _mm_sub_ps(_mm_loadu_ps(rowY + x + adjacentOffsets[i+1]), py);
+                    const __m128 bz = _mm_sub_ps(_mm_loadu_ps(rowZ + x + adjacentOffsets[i+1]), pz);
+
+                    // a x b
+                    const __m128 cx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+                    const __m128 cy = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+                    const __m128 cz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+
+                    // Normalise, leaving degenerate triangles (clamped at the edges) as zero
+                    const __m128 lenSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)),
+                                                    _mm_mul_ps(cz, cz));
+                    const __m128 invLen = _mm_and_ps(_mm_cmpgt_ps(lenSq, zero),
+                                                     _mm_div_ps(one, _mm_sqrt_ps(lenSq)));
+                    nx = _mm_add_ps(nx, _mm_mul_ps(cx, invLen));
+                    ny = _mm_add_ps(ny, _mm_mul_ps(cy, invLen));
+                    nz = _mm_add_ps(nz, _mm_mul_ps(cz, invLen));
+
+                    ax = bx;
+                    ay = by;
+                    az = bz;
+                }
+
+                const __m128 lenSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)),
+                                                _mm_mul_ps(nz, nz));
+                const __m128 invLen = _mm_and_ps(_mm_cmpgt_ps(lenSq, zero),
+                                                 _mm_div_ps(one, _mm_sqrt_ps(lenSq)));
+
+                // encode as RGB, object space
+                OGRE_ALIGNED_DECL(int32, encoded[3][4], OGRE_SIMD_ALIGNMENT);
+                _mm_store_si128(reinterpret_cast<__m128i*>(encoded[0]), _mm_cvttps_epi32(
+                    _mm_mul_ps(_mm_add_ps(_mm_mul_ps(nx, invLen), one), half255)));
+                _mm_store_si128(reinterpret_cast<__m128i*>(encoded[1]), _mm_cvttps_epi32(
+                    _mm_mul_ps(_mm_add_ps(_mm_mul_ps(ny, invLen), one), half255)));
+                _mm_store_si128(reinterpret_cast<__m128i*>(encoded[2]), _mm_cvttps_epi32(
+                    _mm_mul_ps(_mm_add_ps(_mm_mul_ps(nz, invLen), one), half255)));
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    *pStore++ = static_cast<uint8>(encoded[0][i]);
+                    *pStore++ = static_cast<uint8>(encoded[1][i]);
+                    *pStore++ = static_cast<uint8>(encoded[2][i]);
+                }
+            }
+#endif
+            for (; x < width; ++x)
+            {
+                const Vector3 centrePoint(rowX[x], rowY[x], rowZ[x]);
+                Vector3 cumulativeNormal = Vector3::ZERO;
+
+                for (int i = 0; i < 8; ++i)
+                {
+                    const long idxA = x + adjacentOffsets[i];
+                    const long idxB = x + adjacentOffsets[i+1];
+                    const Vector3 edgeA = Vector3(rowX[idxA], rowY[idxA], rowZ[idxA]) - centrePoint;
+                    const Vector3 edgeB = Vector3(rowX[idxB], rowY[idxB], rowZ[idxB]) - centrePoint;
+                    cumulativeNormal += edgeA.crossProduct(edgeB).normalisedCopy();
                 }
 
                 // normalise & store normal
                 cumulativeNormal.normalise();
 
                 // encode as RGB, object space
-                // invert the Y to deal with image space
-                long storeX = x - widenedRect.left;
-                long storeY = widenedRect.bottom - y - 1;
-
-                uint8* pStore = pData + ((storeY * widenedRect.width()) + storeX) * 3;
                 *pStore++ = static_cast<uint8>((cumulativeNormal.x + 1.0f) * 0.5f * 255.0f);
                 *pStore++ = static_cast<uint8>((cumulativeNormal.y + 1.0f) * 0.5f * 255.0f);
                 *pStore++ = static_cast<uint8>((cumulativeNormal.z + 1.0f) * 0.5f * 255.0f);
-
-
             }
         }
 
-        finalRect = widenedRect;
-
-        return pixbox;
+        OGRE_FREE_SIMD(cacheX, MEMCATEGORY_GENERAL);
     }
     //---------------------------------------------------------------------
     void Terrain::finaliseNormals(const Ogre::Rect &rect, Ogre::PixelBox *normalsBox)
@@ -3505,8 +3669,10 @@ namespace Ogre
 
 
         const Vector3& lightVec = TerrainGlobalOptions::getSingleton().getLightMapDirection();
-        Ogre::Rect widenedRect;
-        widenRectByVector(lightVec, rect, widenedRect);
+        Ogre::Rect widenedRect(0, 0, 0, 0);
+        // rect is null when only the lightmap is dirty (i.e. see dirtyLightmapRect)
+        if (!rect.isNull())
+            widenRectByVector(lightVec, rect, widenedRect);
 
         // merge in the extra area (e.g. from neighbours)
         widenedRect.merge(extraTargetRect);
@@ -3534,11 +3700,25 @@ namespace Ogre
         PixelBox* pixbox = OGRE_NEW PixelBox(static_cast<uint32>(widenedRect.width()),
                                              static_cast<uint32>(widenedRect.height()), 1, PF_L8, pData);
 
+        // Each ray only reads the terrain (and its neighbours), so the
+        // rows can be calculated in parallel.
+        CalculateLightmapTask task;
+        task.terrain    = this;
+        task.rect       = widenedRect;
+        task.pData      = pData;
+        Threads::ExecuteUniformScalableTask(&task, getNumDerivedDataThreads(widenedRect.height()));
+
+        return pixbox;
+    }
+    //---------------------------------------------------------------------
+    void Terrain::_calculateLightmapRows(const Rect& rect, long yStart, long yEnd, uint8* pData)
+    {
+        const Vector3& lightVec = TerrainGlobalOptions::getSingleton().getLightMapDirection();
         Real heightPad = (getMaxHeight() - getMinHeight()) * 1.0e-3f;
 
-        for (long y = widenedRect.top; y < widenedRect.bottom; ++y)
+        for (long y = yStart; y < yEnd; ++y)
         {
-            for (long x = widenedRect.left; x < widenedRect.right; ++x)
+            for (long x = rect.left; x < rect.right; ++x)
             {
                 float litVal = 1.0f;
 
@@ -3563,18 +3743,14 @@ namespace Ogre
 
                 // encode as L8
                 // invert the Y to deal with image space
-                long storeX = x - widenedRect.left;
-                long storeY = widenedRect.bottom - y - 1;
+                long storeX = x - rect.left;
+                long storeY = rect.bottom - y - 1;
 
-                uint8* pStore = pData + ((storeY * widenedRect.width()) + storeX);
+                uint8* pStore = pData + ((storeY * rect.width()) + storeX);
                 *pStore = (unsigned char)(litVal * 255.0);
 
             }
         }
-
-        return pixbox;
-
-
     }
     //---------------------------------------------------------------------
     void Terrain::finaliseLightmap(const Rect& rect, PixelBox* lightmapBox)
@@ -66,6 +66,19 @@ namespace Volume {
         /** Overridden from Source.
         */
         virtual Real getValue(const Vector3 &position) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+            Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const;
+
+        /** Overridden from Source.
+        */
+        virtual bool isThreadSafe(void) const;
     };
 
     /** A plane.
@@ -97,6 +110,19 @@ namespace Volume {
         /** Overridden from Source.
         */
         virtual Real getValue(const Vector3 &position) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+            Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const;
+
+        /** Overridden from Source.
+        */
+        virtual bool isThreadSafe(void) const;
     };
 
     /** A not rotated cube.
@@ -161,6 +187,14 @@ namespace Volume {
         /** Overridden from Source.
         */
         virtual Real getValue(const Vector3 &position) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const;
+
+        /** Overridden from Source.
+        */
+        virtual bool isThreadSafe(void) const;
     };
 
     /** Abstract operation volume source holding two sources as operants.
@@ -212,6 +246,12 @@ namespace Volume {
             The second operator source.
         */
         virtual void setSourceB(Source *b);
+
+        /** Overridden from Source.
+        @return
+            Whether both operands are thread safe.
+        */
+        virtual bool isThreadSafe(void) const;
     };
 
     /** Builds the intersection between two sources.
@@ -239,6 +279,15 @@ namespace Volume {
         /** Overridden from Source.
         */
         virtual Real getValue(const Vector3 &position) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+            Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const;
     };
 
     /** Builds the union between two sources.
@@ -266,6 +315,15 @@ namespace Volume {
         /** Overridden from Source.
         */
         virtual Real getValue(const Vector3 &position) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+            Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const;
     };
 
     /** Builds the difference between two sources.
@@ -294,6 +352,15 @@ namespace Volume {
         /** Overridden from Source.
         */
         virtual Real getValue(const Vector3 &position) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+            Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const;
     };
 
     /** Source which does a unary operation to another one.
@@ -329,6 +396,12 @@ namespace Volume {
             The source.
         */
         virtual void setSource(Source *a);
+
+        /** Overridden from Source.
+        @return
+            Whether the operand is thread safe.
+        */
+        virtual bool isThreadSafe(void) const;
     };
 
     /** Negates the given volume.
@@ -354,6 +427,15 @@ namespace Volume {
         /** Overridden from Source.
         */
         virtual Real getValue(const Vector3 &position) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+            Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const;
     };
 
     /** Scales the given volume source.
@@ -381,6 +463,15 @@ namespace Volume {
         /** Overridden from Source.
         */
         virtual Real getValue(const Vector3 &position) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+            Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const;
     };
 
     class _OgreVolumeExport CSGNoiseSource: public CSGUnarySource
@@ -424,6 +515,20 @@ namespace Volume {
             return mSrc->getValue(position) + toAdd;
         }
 
+        /* Gets many density values at once, see Source::getValues.
+        @param count
+            The amount of positions.
+        @param posX
+            The x coordinates of the positions.
+        @param posY
+            The y coordinates of the positions.
+        @param posZ
+            The z coordinates of the positions.
+        @param outValues
+            Receives count values.
+        */
+        void getInternalValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const;
+
     public:
         
         /** Constructor.
@@ -459,6 +564,15 @@ namespace Volume {
         /** Overridden from Source.
         */
         virtual Real getValue(const Vector3 &position) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const;
+
+        /** Overridden from Source.
+        */
+        virtual void getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+            Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const;
         
         /** Gets the initial seed.
         @return
@@ -91,12 +91,16 @@ namespace Volume {
         /// Whether to load the chunks async. if set to false, the call to load waits for the whole chunk. false is the default.
         bool async;
 
+        /// The amount of threads splitting the octree and contouring the dual grid of each chunk. 0 means one per logical core. 1 is the default.
+        /// Ignored if the source isn't thread safe, and when loading async, as the chunks are then already spread over the WorkQueue threads.
+        size_t numThreads;
+
         /** Constructor.
         */
         ChunkParameters(void) :
             sceneManager(0), src(0), baseError((Real)0.0), errorMultiplicator((Real)1.0), createOctreeVisualization(false),
             createDualGridVisualization(false), skirtFactor(0), lodCallback(0), scale((Real)1.0), maxScreenSpaceError(0), createGeometryFromLevel(0),
-            updateFrom(Vector3::ZERO), updateTo(Vector3::ZERO), async(false)
+            updateFrom(Vector3::ZERO), updateTo(Vector3::ZERO), async(false), numThreads(1)
         {
         }
     } ChunkParameters;
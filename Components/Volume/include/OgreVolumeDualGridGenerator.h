@@ -60,10 +60,42 @@ namespace Volume {
     */
     typedef vector<DualCell>::type VecDualCell;
 
+    /** A dual cell waiting to be contoured, with its corner values if they are already known.
+    */
+    typedef struct _OgreVolumeExport PendingDualCell
+    {
+    public:
+        Vector3 mCorners[8];
+        Vector4 mValues[8];
+        bool mHasValues;
+        PendingDualCell(const Vector3 &c0, const Vector3 &c1, const Vector3 &c2, const Vector3 &c3, const Vector3 &c4, const Vector3 &c5, const Vector3 &c6, const Vector3 &c7,
+            const Vector4 *values) :
+            mHasValues(values != 0)
+        {
+            mCorners[0] = c0;
+            mCorners[1] = c1;
+            mCorners[2] = c2;
+            mCorners[3] = c3;
+            mCorners[4] = c4;
+            mCorners[5] = c5;
+            mCorners[6] = c6;
+            mCorners[7] = c7;
+            if (values)
+            {
+                std::copy(values, values + 8, mValues);
+            }
+        }
+    } PendingDualCell;
+
+    /** To hold the dual cells waiting to be contoured.
+    */
+    typedef vector<PendingDualCell>::type VecPendingDualCell;
+
     /** Class for the generation of the DualGrid.
     */
     class _OgreVolumeExport DualGridGenerator : public UtilityAlloc
     {
+        friend class DualCellContourTask;
     protected:
         
         /// To give the debug manual object an unique name.
@@ -78,6 +110,9 @@ namespace Volume {
         /// Holds the generated dual cells of the grid.
         VecDualCell mDualCells;
 
+        /// The dual cells waiting to be contoured, in creation order.
+        VecPendingDualCell mPendingCells;
+
         /// Whether to store the dualcells for later visualization.
         bool mSaveDualCells;
 
@@ -146,44 +181,61 @@ namespace Volume {
                 mDualCells.push_back(DualCell(c0, c1, c2, c3, c4, c5, c6, c7));
             }
 
-            Vector3 corners[8];
-            corners[0] = c0;
-            corners[1] = c1;
-            corners[2] = c2;
-            corners[3] = c3;
-            corners[4] = c4;
-            corners[5] = c5;
-            corners[6] = c6;
-            corners[7] = c7;
-            mIs->addMarchingCubesTriangles(corners, values, mMb);
+            // Contoured later in batches, see contourDualCells. All cells go through the
+            // same list so the triangles keep the order in which the cells were created.
+            mPendingCells.push_back(PendingDualCell(c0, c1, c2, c3, c4, c5, c6, c7, values));
+        }
+
+        /** Triangulates a dualcell via Marching Cubes and adds the skirts if it's at the border.
+         @param corners
+            The eight corners.
+         @param values
+            The values at the corners.
+         @param mb
+            To store the triangles of the contour.
+         */
+        inline void contourDualCell(const Vector3 *corners, const Vector4 *values, MeshBuilder *mb) const
+        {
+            mIs->addMarchingCubesTriangles(corners, values, mb);
             Vector3 from = mRoot->getFrom();
             Vector3 to = mRoot->getTo();
             if (corners[0].z == from.z && corners[0].z != mTotalFrom.z)
             {
-                mIs->addMarchingSquaresTriangles(corners, values, IsoSurface::MS_CORNERS_BACK, mMaxMSDistance, mMb);
+                mIs->addMarchingSquaresTriangles(corners, values, IsoSurface::MS_CORNERS_BACK, mMaxMSDistance, mb);
             }
             if (corners[2].z == to.z && corners[2].z != mTotalTo.z)
             {
-                mIs->addMarchingSquaresTriangles(corners, values, IsoSurface::MS_CORNERS_FRONT, mMaxMSDistance, mMb);
+                mIs->addMarchingSquaresTriangles(corners, values, IsoSurface::MS_CORNERS_FRONT, mMaxMSDistance, mb);
             }
             if (corners[0].x == from.x && corners[0].x != mTotalFrom.x)
             {
-                mIs->addMarchingSquaresTriangles(corners, values, IsoSurface::MS_CORNERS_LEFT, mMaxMSDistance, mMb);
+                mIs->addMarchingSquaresTriangles(corners, values, IsoSurface::MS_CORNERS_LEFT, mMaxMSDistance, mb);
             }
             if (corners[1].x == to.x && corners[1].x != mTotalTo.x)
             {
-                mIs->addMarchingSquaresTriangles(corners, values, IsoSurface::MS_CORNERS_RIGHT, mMaxMSDistance, mMb);
+                mIs->addMarchingSquaresTriangles(corners, values, IsoSurface::MS_CORNERS_RIGHT, mMaxMSDistance, mb);
             }
             if (corners[5].y == to.y && corners[5].y != mTotalTo.y)
             {
-                mIs->addMarchingSquaresTriangles(corners, values, IsoSurface::MS_CORNERS_TOP, mMaxMSDistance, mMb);
+                mIs->addMarchingSquaresTriangles(corners, values, IsoSurface::MS_CORNERS_TOP, mMaxMSDistance, mb);
             }
             if (corners[0].y == from.y && corners[0].y != mTotalFrom.y)
             {
-                mIs->addMarchingSquaresTriangles(corners, values, IsoSurface::MS_CORNERS_BOTTOM, mMaxMSDistance, mMb);
+                mIs->addMarchingSquaresTriangles(corners, values, IsoSurface::MS_CORNERS_BOTTOM, mMaxMSDistance, mb);
             }
         }
 
+        /** Contours a range of the pending dualcells. The missing corner values of
+            several cells are fetched from the source with one batch call.
+         @param begin
+            The first cell of the range.
+         @param end
+            One past the last cell of the range.
+         @param mb
+            To store the triangles of the contour.
+         */
+        void contourDualCells(size_t begin, size_t end, MeshBuilder *mb) const;
+
         /* Startpoint for the creation recursion.
         @param n
             The node to start with.
@@ -314,8 +366,12 @@ namespace Volume {
             The global to.
         @param saveDualCells
             Whether to save the generated dualcells of the generated dual cells.
+        @param numThreads
+            The amount of threads contouring the dualcells, including the calling one. The
+            source of the IsoSurface must be thread safe if this is more than one. The
+            triangles are the same no matter how many threads are used.
         */
-        void generateDualGrid(const OctreeNode *root, IsoSurface *is, MeshBuilder *mb, Real maxMSDistance, const Vector3 &totalFrom, const Vector3 &totalTo, bool saveDualCells);
+        void generateDualGrid(const OctreeNode *root, IsoSurface *is, MeshBuilder *mb, Real maxMSDistance, const Vector3 &totalFrom, const Vector3 &totalTo, bool saveDualCells, size_t numThreads = 1);
 
         /** Gets the lazily created entity of the dualgrid debug visualization.
         @param sceneManager
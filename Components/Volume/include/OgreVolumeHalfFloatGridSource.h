@@ -87,6 +87,10 @@ namespace Volume {
         */
         Real getMaxClampedAbsoluteDensity(void) const;
 
+        /** Overridden from Source. The grid is only read while meshing.
+        */
+        virtual bool isThreadSafe(void) const;
+
         /** Destructor.
         */
         ~HalfFloatGridSource(void);
@@ -75,6 +75,15 @@ namespace Volume {
         static const size_t MS_CORNERS_BOTTOM[4];
 
         virtual ~IsoSurface(void);
+
+        /** Gets the source of the density values.
+        @return
+            The source.
+        */
+        inline const Source* getSource(void) const
+        {
+            return mSrc;
+        }
         
         /** Adds triangles to a MeshBuilder via Marching Cubes.
         @param corners
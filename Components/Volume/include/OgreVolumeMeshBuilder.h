@@ -296,6 +296,13 @@ namespace Volume {
             addVertex(Vertex(v2, n2));
         }
 
+        /** Adds all triangles of another MeshBuilder, in the same order, as if they
+        had been added to this one directly.
+        @param other
+            The MeshBuilder whose triangles are to be added.
+        */
+        void append(const MeshBuilder &other);
+
         /** Generates the vertex- and indexbuffer of this mesh on the given
             RenderOperation.
         @param operation
@@ -75,6 +75,19 @@ namespace Volume {
             The manual object to add the lines to if this is a leaf in the octree.
         */
         void buildOctreeGridLines(ManualObject *manual) const;
+
+        /** Splits this cell one level if the split policy says so, without recursing
+            into the created children.
+        @param splitPolicy
+            Defines the policy deciding whether to split this node or not.
+        @param src
+            The volume source.
+        @param geometricError
+            The accepted geometric error.
+        @return
+            true if the children were created.
+        */
+        bool splitOnce(const OctreeNodeSplitPolicy *splitPolicy, const Source *src, const Real geometricError);
     public:
 
         /// Even in an OCtree, the amount of children should not be hardcoded.
@@ -141,6 +154,19 @@ namespace Volume {
         */
         void split(const OctreeNodeSplitPolicy *splitPolicy, const Source *src, const Real geometricError);
 
+        /** Splits this cell like split, but with the independent subtrees being split
+        on several threads at once. The source must be thread safe.
+        @param splitPolicy
+            Defines the policy deciding whether to split this node or not.
+        @param src
+            The volume source.
+        @param geometricError
+            The accepted geometric error.
+        @param numThreads
+            The amount of threads to use, including the calling one.
+        */
+        void split(const OctreeNodeSplitPolicy *splitPolicy, const Source *src, const Real geometricError, size_t numThreads);
+
         /** Getter for the octree debug visualization of the octree starting with
             this node.
         @param sceneManager
@@ -72,6 +72,9 @@ namespace Volume {
 
         /// The amount of items being written as one chunk during serialization.
         static const size_t SERIALIZATION_CHUNK_SIZE;
+
+        /// The amount of samples the batch functions evaluate at once in their stack buffers.
+        static const size_t BATCH_SIZE = 256;
         
         /** Destructor.
         */
@@ -93,6 +96,52 @@ namespace Volume {
         */
         virtual Real getValue(const Vector3 &position) const = 0;
 
+        /** Gets the density values of many positions at once. The positions are given
+        as structure of arrays so implementations can evaluate several of them per
+        instruction. The default implementation calls getValue for every position.
+        @param count
+            The amount of positions.
+        @param posX
+            The x coordinates of the positions.
+        @param posY
+            The y coordinates of the positions.
+        @param posZ
+            The z coordinates of the positions.
+        @param outValues
+            Receives count densities.
+        */
+        virtual void getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const;
+
+        /** Gets the density values and gradients of many positions at once, see getValues.
+        The default implementation calls getValueAndGradient for every position.
+        @param count
+            The amount of positions.
+        @param posX
+            The x coordinates of the positions.
+        @param posY
+            The y coordinates of the positions.
+        @param posZ
+            The z coordinates of the positions.
+        @param outValues
+            Receives count densities.
+        @param outGradX
+            Receives the x components of the gradients.
+        @param outGradY
+            Receives the y components of the gradients.
+        @param outGradZ
+            Receives the z components of the gradients.
+        */
+        virtual void getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+            Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const;
+
+        /** Whether this source may be queried from several threads at the same time.
+        Chunks fall back to a single thread per chunk if not. Sources which only read
+        immutable data can override this to return true.
+        @return
+            false in the default implementation.
+        */
+        virtual bool isThreadSafe(void) const;
+
         /** Serializes a volume source to a discrete grid file with deflated
         compression. To achieve better compression, all density values are clamped
         within a maximum absolute value of (to - from).length() / 16.0. The values
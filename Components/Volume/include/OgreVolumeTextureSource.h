@@ -74,6 +74,10 @@ namespace Volume {
         */
         explicit TextureSource(const String &volumeTextureName, const Real worldWidth, const Real worldHeight, const Real worldDepth, const bool trilinearValue = true, const bool trilinearGradient = false, const bool sobelGradient = false);
         
+        /** Overridden from Source. The grid is only read while meshing.
+        */
+        virtual bool isThreadSafe(void) const;
+
         /** Destructor.
         */
         ~TextureSource(void);
@@ -25,8 +25,13 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include "OgreVolumeCSGSource.h"
+#include "OgrePlatformInformation.h"
 #include <algorithm>
 
+#if __OGRE_HAVE_SSE && OGRE_DOUBLE_PRECISION == 0
+    #include <emmintrin.h>
+#endif
+
 namespace Ogre {
 namespace Volume {
 
@@ -38,6 +43,69 @@ namespace Volume {
         Vector3::NEGATIVE_UNIT_Y,
         Vector3::NEGATIVE_UNIT_Z
     };
+
+    //-----------------------------------------------------------------------
+
+    /** Evaluates two sources in batches and keeps, per sample, the one with the smaller
+        (or bigger) density. Used by the intersection, union and difference operators.
+    @param negateB
+        Whether the values and gradients of b are to be negated first.
+    */
+    static void combineValues(const Source *a, const Source *b, bool takeSmaller, bool negateB,
+        size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues)
+    {
+        Real valuesB[Source::BATCH_SIZE];
+        const Real signB = negateB ? (Real)-1.0 : (Real)1.0;
+        for (size_t start = 0; start < count; start += Source::BATCH_SIZE)
+        {
+            const size_t num = count - start < Source::BATCH_SIZE ? count - start : Source::BATCH_SIZE;
+            Real *values = outValues + start;
+            a->getValues(num, posX + start, posY + start, posZ + start, values);
+            b->getValues(num, posX + start, posY + start, posZ + start, valuesB);
+            for (size_t i = 0; i < num; ++i)
+            {
+                const Real valueB = signB * valuesB[i];
+                if (takeSmaller ? !(values[i] < valueB) : !(values[i] > valueB))
+                {
+                    values[i] = valueB;
+                }
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    /// Same as combineValues, but with gradients.
+    static void combineValuesAndGradients(const Source *a, const Source *b, bool takeSmaller, bool negateB,
+        size_t count, const Real *posX, const Real *posY, const Real *posZ,
+        Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ)
+    {
+        Real valuesB[Source::BATCH_SIZE];
+        Real gradXB[Source::BATCH_SIZE];
+        Real gradYB[Source::BATCH_SIZE];
+        Real gradZB[Source::BATCH_SIZE];
+        const Real signB = negateB ? (Real)-1.0 : (Real)1.0;
+        for (size_t start = 0; start < count; start += Source::BATCH_SIZE)
+        {
+            const size_t num = count - start < Source::BATCH_SIZE ? count - start : Source::BATCH_SIZE;
+            a->getValuesAndGradients(num, posX + start, posY + start, posZ + start,
+                outValues + start, outGradX + start, outGradY + start, outGradZ + start);
+            b->getValuesAndGradients(num, posX + start, posY + start, posZ + start,
+                valuesB, gradXB, gradYB, gradZB);
+            for (size_t i = 0; i < num; ++i)
+            {
+                const Real valueB = signB * valuesB[i];
+                const Real valueA = outValues[start + i];
+                if (takeSmaller ? !(valueA < valueB) : !(valueA > valueB))
+                {
+                    outValues[start + i] = valueB;
+                    outGradX[start + i] = signB * gradXB[i];
+                    outGradY[start + i] = signB * gradYB[i];
+                    outGradZ[start + i] = signB * gradZB[i];
+                }
+            }
+        }
+    }
     
     //-----------------------------------------------------------------------
 
@@ -69,6 +137,76 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGSphereSource::getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const
+    {
+        size_t i = 0;
+#if __OGRE_HAVE_SSE && OGRE_DOUBLE_PRECISION == 0
+        const __m128 r = _mm_set1_ps(mR);
+        const __m128 centerX = _mm_set1_ps(mCenter.x);
+        const __m128 centerY = _mm_set1_ps(mCenter.y);
+        const __m128 centerZ = _mm_set1_ps(mCenter.z);
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 dX = _mm_sub_ps(_mm_loadu_ps(posX + i), centerX);
+            const __m128 dY = _mm_sub_ps(_mm_loadu_ps(posY + i), centerY);
+            const __m128 dZ = _mm_sub_ps(_mm_loadu_ps(posZ + i), centerZ);
+            const __m128 sqLength = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dX, dX), _mm_mul_ps(dY, dY)), _mm_mul_ps(dZ, dZ));
+            _mm_storeu_ps(outValues + i, _mm_sub_ps(r, _mm_sqrt_ps(sqLength)));
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            outValues[i] = mR - Vector3(posX[i] - mCenter.x, posY[i] - mCenter.y, posZ[i] - mCenter.z).length();
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGSphereSource::getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+        Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const
+    {
+        size_t i = 0;
+#if __OGRE_HAVE_SSE && OGRE_DOUBLE_PRECISION == 0
+        const __m128 r = _mm_set1_ps(mR);
+        const __m128 centerX = _mm_set1_ps(mCenter.x);
+        const __m128 centerY = _mm_set1_ps(mCenter.y);
+        const __m128 centerZ = _mm_set1_ps(mCenter.z);
+        // Same threshold as Vector3::normalise
+        const __m128 minLength = _mm_set1_ps(1e-08f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 dX = _mm_sub_ps(_mm_loadu_ps(posX + i), centerX);
+            const __m128 dY = _mm_sub_ps(_mm_loadu_ps(posY + i), centerY);
+            const __m128 dZ = _mm_sub_ps(_mm_loadu_ps(posZ + i), centerZ);
+            const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dX, dX), _mm_mul_ps(dY, dY)), _mm_mul_ps(dZ, dZ)));
+            const __m128 mask = _mm_cmpgt_ps(length, minLength);
+            const __m128 invLength = _mm_or_ps(_mm_and_ps(mask, _mm_div_ps(one, length)), _mm_andnot_ps(mask, one));
+            _mm_storeu_ps(outGradX + i, _mm_mul_ps(dX, invLength));
+            _mm_storeu_ps(outGradY + i, _mm_mul_ps(dY, invLength));
+            _mm_storeu_ps(outGradZ + i, _mm_mul_ps(dZ, invLength));
+            _mm_storeu_ps(outValues + i, _mm_sub_ps(r, length));
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            Vector3 gradient(posX[i] - mCenter.x, posY[i] - mCenter.y, posZ[i] - mCenter.z);
+            outValues[i] = mR - gradient.normalise();
+            outGradX[i] = gradient.x;
+            outGradY[i] = gradient.y;
+            outGradZ[i] = gradient.z;
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    bool CSGSphereSource::isThreadSafe(void) const
+    {
+        return true;
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGPlaneSource::CSGPlaneSource(const Real d, const Vector3 &normal) : mD(d), mNormal(normal.normalisedCopy())
     {
     }
@@ -96,6 +234,49 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGPlaneSource::getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const
+    {
+        size_t i = 0;
+#if __OGRE_HAVE_SSE && OGRE_DOUBLE_PRECISION == 0
+        const __m128 d = _mm_set1_ps(mD);
+        const __m128 normalX = _mm_set1_ps(mNormal.x);
+        const __m128 normalY = _mm_set1_ps(mNormal.y);
+        const __m128 normalZ = _mm_set1_ps(mNormal.z);
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 dot = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(_mm_loadu_ps(posX + i), normalX),
+                _mm_mul_ps(_mm_loadu_ps(posY + i), normalY)),
+                _mm_mul_ps(_mm_loadu_ps(posZ + i), normalZ));
+            _mm_storeu_ps(outValues + i, _mm_sub_ps(d, dot));
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            outValues[i] = mD - (mNormal.x * posX[i] + mNormal.y * posY[i] + mNormal.z * posZ[i]);
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGPlaneSource::getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+        Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const
+    {
+        getValues(count, posX, posY, posZ, outValues);
+        std::fill(outGradX, outGradX + count, mNormal.x);
+        std::fill(outGradY, outGradY + count, mNormal.y);
+        std::fill(outGradZ, outGradZ + count, mNormal.z);
+    }
+    
+    //-----------------------------------------------------------------------
+
+    bool CSGPlaneSource::isThreadSafe(void) const
+    {
+        return true;
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGCubeSource::CSGCubeSource(const Vector3 &min, const Vector3 &max)
     {
         mBox.setExtents(min, max);
@@ -127,6 +308,23 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGCubeSource::getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            outValues[i] = distanceTo(Vector3(posX[i], posY[i], posZ[i]));
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    bool CSGCubeSource::isThreadSafe(void) const
+    {
+        return true;
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGOperationSource::CSGOperationSource(const Source *a, const Source *b) : mA(a), mB(b)
     {
     }
@@ -164,6 +362,13 @@ namespace Volume {
     {
         mB = b;
     }
+    
+    //-----------------------------------------------------------------------
+
+    bool CSGOperationSource::isThreadSafe(void) const
+    {
+        return (!mA || mA->isThreadSafe()) && (!mB || mB->isThreadSafe());
+    }
 
     //-----------------------------------------------------------------------
 
@@ -205,6 +410,21 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGIntersectionSource::getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const
+    {
+        combineValues(mA, mB, true, false, count, posX, posY, posZ, outValues);
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGIntersectionSource::getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+        Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const
+    {
+        combineValuesAndGradients(mA, mB, true, false, count, posX, posY, posZ, outValues, outGradX, outGradY, outGradZ);
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGUnionSource::CSGUnionSource(const Source *a, const Source *b) : CSGOperationSource(a, b)
     {
     }
@@ -243,6 +463,21 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGUnionSource::getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const
+    {
+        combineValues(mA, mB, false, false, count, posX, posY, posZ, outValues);
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGUnionSource::getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+        Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const
+    {
+        combineValuesAndGradients(mA, mB, false, false, count, posX, posY, posZ, outValues, outGradX, outGradY, outGradZ);
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGDifferenceSource::CSGDifferenceSource(const Source *a, const Source *b) : CSGOperationSource(a, b)
     {
     }
@@ -281,6 +516,21 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGDifferenceSource::getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const
+    {
+        combineValues(mA, mB, true, true, count, posX, posY, posZ, outValues);
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGDifferenceSource::getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+        Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const
+    {
+        combineValuesAndGradients(mA, mB, true, true, count, posX, posY, posZ, outValues, outGradX, outGradY, outGradZ);
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGUnarySource::CSGUnarySource(const Source *src) : mSrc(src)
     {
     }
@@ -307,6 +557,13 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    bool CSGUnarySource::isThreadSafe(void) const
+    {
+        return !mSrc || mSrc->isThreadSafe();
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGNegateSource::CSGNegateSource(const Source *src) : CSGUnarySource(src)
     {
     }
@@ -333,6 +590,32 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGNegateSource::getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const
+    {
+        mSrc->getValues(count, posX, posY, posZ, outValues);
+        for (size_t i = 0; i < count; ++i)
+        {
+            outValues[i] = -outValues[i];
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGNegateSource::getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+        Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const
+    {
+        mSrc->getValuesAndGradients(count, posX, posY, posZ, outValues, outGradX, outGradY, outGradZ);
+        for (size_t i = 0; i < count; ++i)
+        {
+            outValues[i] = -outValues[i];
+            outGradX[i] = -outGradX[i];
+            outGradY[i] = -outGradY[i];
+            outGradZ[i] = -outGradZ[i];
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     CSGScaleSource::CSGScaleSource(const Source *src, const Real scale) : CSGUnarySource(src), mScale(scale)
     {
     }
@@ -353,6 +636,61 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGScaleSource::getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const
+    {
+        Real scaledX[BATCH_SIZE];
+        Real scaledY[BATCH_SIZE];
+        Real scaledZ[BATCH_SIZE];
+        const Real invScale = (Real)1.0 / mScale;
+        for (size_t start = 0; start < count; start += BATCH_SIZE)
+        {
+            const size_t num = count - start < BATCH_SIZE ? count - start : BATCH_SIZE;
+            for (size_t i = 0; i < num; ++i)
+            {
+                scaledX[i] = posX[start + i] * invScale;
+                scaledY[i] = posY[start + i] * invScale;
+                scaledZ[i] = posZ[start + i] * invScale;
+            }
+            mSrc->getValues(num, scaledX, scaledY, scaledZ, outValues + start);
+            for (size_t i = 0; i < num; ++i)
+            {
+                outValues[start + i] *= mScale;
+            }
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGScaleSource::getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+        Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const
+    {
+        Real scaledX[BATCH_SIZE];
+        Real scaledY[BATCH_SIZE];
+        Real scaledZ[BATCH_SIZE];
+        const Real invScale = (Real)1.0 / mScale;
+        for (size_t start = 0; start < count; start += BATCH_SIZE)
+        {
+            const size_t num = count - start < BATCH_SIZE ? count - start : BATCH_SIZE;
+            for (size_t i = 0; i < num; ++i)
+            {
+                scaledX[i] = posX[start + i] * invScale;
+                scaledY[i] = posY[start + i] * invScale;
+                scaledZ[i] = posZ[start + i] * invScale;
+            }
+            mSrc->getValuesAndGradients(num, scaledX, scaledY, scaledZ,
+                outValues + start, outGradX + start, outGradY + start, outGradZ + start);
+            for (size_t i = 0; i < num; ++i)
+            {
+                outValues[start + i] *= mScale;
+                outGradX[start + i] *= mScale;
+                outGradY[start + i] *= mScale;
+                outGradZ[start + i] *= mScale;
+            }
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     void CSGNoiseSource::setData(void)
     {
         mGradientOff = fabs(mFrequencies[0]);
@@ -403,6 +741,71 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void CSGNoiseSource::getInternalValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const
+    {
+        // The wrapped source is evaluated in one batch, the noise itself stays scalar
+        // as its permutation table lookups can't be vectorized without gathers.
+        mSrc->getValues(count, posX, posY, posZ, outValues);
+        for (size_t i = 0; i < count; ++i)
+        {
+            Real toAdd = (Real)0.0;
+            for (size_t j = 0; j < mNumOctaves; ++j)
+            {
+                toAdd += mNoise.noise(posX[i] * mFrequencies[j], posY[i] * mFrequencies[j], posZ[i] * mFrequencies[j]) * mAmplitudes[j];
+            }
+            outValues[i] += toAdd;
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGNoiseSource::getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const
+    {
+        getInternalValues(count, posX, posY, posZ, outValues);
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void CSGNoiseSource::getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+        Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const
+    {
+        getInternalValues(count, posX, posY, posZ, outValues);
+
+        // Central differences along each axis, like getValueAndGradient.
+        Real shifted[BATCH_SIZE];
+        Real valuesPlus[BATCH_SIZE];
+        Real valuesMinus[BATCH_SIZE];
+        for (size_t start = 0; start < count; start += BATCH_SIZE)
+        {
+            const size_t num = count - start < BATCH_SIZE ? count - start : BATCH_SIZE;
+            const Real *pos[3] = {posX + start, posY + start, posZ + start};
+            Real *grad[3] = {outGradX + start, outGradY + start, outGradZ + start};
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                const Real *p[3] = {pos[0], pos[1], pos[2]};
+                p[axis] = shifted;
+
+                for (size_t i = 0; i < num; ++i)
+                {
+                    shifted[i] = pos[axis][i] + mGradientOff;
+                }
+                getInternalValues(num, p[0], p[1], p[2], valuesPlus);
+                for (size_t i = 0; i < num; ++i)
+                {
+                    shifted[i] = pos[axis][i] - mGradientOff;
+                }
+                getInternalValues(num, p[0], p[1], p[2], valuesMinus);
+
+                for (size_t i = 0; i < num; ++i)
+                {
+                    grad[axis][i] = -(valuesPlus[i] - valuesMinus[i]);
+                }
+            }
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     long CSGNoiseSource::getSeed(void) const
     {
         return mSeed;
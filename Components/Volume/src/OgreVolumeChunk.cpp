@@ -38,6 +38,7 @@ THE SOFTWARE.
 #include "OgreSceneNode.h"
 #include "OgreViewport.h"
 #include "OgreRoot.h"
+#include "OgrePlatformInformation.h"
 #include "OgreVolumeChunk.h"
 #include "OgreVolumeMeshBuilder.h"
 #include "OgreVolumeOctreeNode.h"
@@ -193,11 +194,22 @@ namespace Volume {
         OctreeNodeSplitPolicy policy(mShared->parameters->src,
             mShared->parameters->errorMultiplicator * mShared->parameters->baseError);
         mError = (Real)level * mShared->parameters->errorMultiplicator * mShared->parameters->baseError;
-        root->split(&policy, mShared->parameters->src, mError);
+        // This already runs on a WorkQueue thread. Only split the chunk further while the
+        // main thread is blocked waiting for the load, not while loading in the background.
+        size_t numThreads = 1;
+        if (!mShared->parameters->async && mShared->parameters->src->isThreadSafe())
+        {
+            numThreads = mShared->parameters->numThreads;
+            if (numThreads == 0)
+            {
+                numThreads = std::max<size_t>(1, PlatformInformation::getNumLogicalCores());
+            }
+        }
+        root->split(&policy, mShared->parameters->src, mError, numThreads);
         Real maxMSDistance = (Real)level * mShared->parameters->errorMultiplicator * mShared->parameters->baseError * mShared->parameters->skirtFactor;
         IsoSurface *is = OGRE_NEW IsoSurfaceMC(mShared->parameters->src);
         dualGridGenerator->generateDualGrid(root, is, meshBuilder, maxMSDistance, totalFrom, totalTo,
-            mShared->parameters->createDualGridVisualization);
+            mShared->parameters->createDualGridVisualization, numThreads);
         OGRE_DELETE is;
     }
     
@@ -385,6 +397,7 @@ namespace Volume {
         parameters.createDualGridVisualization = StringConverter::parseBool(config.getSetting("createDualGridVisualization"));
         parameters.skirtFactor = StringConverter::parseReal(config.getSetting("skirtFactor"));
         parameters.async = async;
+        parameters.numThreads = StringConverter::parseUnsignedInt(config.getSetting("numThreads"), 1);
     
         load(parent, from, to, level, &parameters);
         
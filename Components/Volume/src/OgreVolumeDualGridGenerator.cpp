@@ -28,6 +28,9 @@ THE SOFTWARE.
 #include "OgreManualObject.h"
 #include "OgreSceneManager.h"
 #include "OgreVolumeMeshBuilder.h"
+#include "OgreVolumeSource.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreUniformScalableTask.h"
 
 namespace Ogre {
 namespace Volume {
@@ -36,6 +39,89 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    /** Contours the pending dualcells of a DualGridGenerator in contiguous ranges,
+        one per thread, each into its own MeshBuilder.
+    */
+    class DualCellContourTask : public UniformScalableTask
+    {
+    public:
+        const DualGridGenerator *mGenerator;
+        MeshBuilder **mMeshBuilders;
+        size_t mNumCells;
+
+        DualCellContourTask(const DualGridGenerator *generator, MeshBuilder **meshBuilders, size_t numCells) :
+            mGenerator(generator), mMeshBuilders(meshBuilders), mNumCells(numCells)
+        {
+        }
+
+        virtual void execute(size_t threadId, size_t numThreads)
+        {
+            const size_t begin = mNumCells * threadId / numThreads;
+            const size_t end = mNumCells * (threadId + 1) / numThreads;
+            mGenerator->contourDualCells(begin, end, mMeshBuilders[threadId]);
+        }
+    };
+    
+    //-----------------------------------------------------------------------
+
+    void DualGridGenerator::contourDualCells(size_t begin, size_t end, MeshBuilder *mb) const
+    {
+        const size_t cellsPerBatch = Source::BATCH_SIZE / 8;
+        Real posX[Source::BATCH_SIZE];
+        Real posY[Source::BATCH_SIZE];
+        Real posZ[Source::BATCH_SIZE];
+        Real values[Source::BATCH_SIZE];
+        Real gradX[Source::BATCH_SIZE];
+        Real gradY[Source::BATCH_SIZE];
+        Real gradZ[Source::BATCH_SIZE];
+        Vector4 cornerValues[8];
+
+        const Source *src = mIs->getSource();
+        for (size_t batchStart = begin; batchStart < end; batchStart += cellsPerBatch)
+        {
+            const size_t numCells = end - batchStart < cellsPerBatch ? end - batchStart : cellsPerBatch;
+            size_t numPositions = 0;
+            for (size_t i = 0; i < numCells; ++i)
+            {
+                const PendingDualCell &cell = mPendingCells[batchStart + i];
+                if (!cell.mHasValues)
+                {
+                    for (size_t j = 0; j < 8; ++j)
+                    {
+                        posX[numPositions] = cell.mCorners[j].x;
+                        posY[numPositions] = cell.mCorners[j].y;
+                        posZ[numPositions] = cell.mCorners[j].z;
+                        ++numPositions;
+                    }
+                }
+            }
+            if (numPositions)
+            {
+                src->getValuesAndGradients(numPositions, posX, posY, posZ, values, gradX, gradY, gradZ);
+            }
+
+            size_t k = 0;
+            for (size_t i = 0; i < numCells; ++i)
+            {
+                const PendingDualCell &cell = mPendingCells[batchStart + i];
+                if (cell.mHasValues)
+                {
+                    contourDualCell(cell.mCorners, cell.mValues, mb);
+                }
+                else
+                {
+                    for (size_t j = 0; j < 8; ++j, ++k)
+                    {
+                        cornerValues[j] = Vector4(gradX[k], gradY[k], gradZ[k], values[k]);
+                    }
+                    contourDualCell(cell.mCorners, cornerValues, mb);
+                }
+            }
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     void DualGridGenerator::nodeProc(const OctreeNode *n)
     {
         if (n->isSubdivided())
@@ -470,7 +556,7 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
-    void DualGridGenerator::generateDualGrid(const OctreeNode *root, IsoSurface *is, MeshBuilder *mb, Real maxMSDistance, const Vector3 &totalFrom, const Vector3 &totalTo, bool saveDualCells)
+    void DualGridGenerator::generateDualGrid(const OctreeNode *root, IsoSurface *is, MeshBuilder *mb, Real maxMSDistance, const Vector3 &totalFrom, const Vector3 &totalTo, bool saveDualCells, size_t numThreads)
     {
         mRoot = root;
         mIs = is;
@@ -503,6 +589,28 @@ namespace Volume {
             addDualCell(root->getCenterLeft(), root->getCenter(), root->getCenterFront(), root->getCenterFrontLeft(),
                 root->getCenterLeftTop(), root->getCenterTop(), root->getCenterFrontTop(), root->getCorner7());
         }
+
+        // Contour the collected cells. Each thread gets a contiguous range and its own
+        // MeshBuilder, the first one directly writing into mb. Appending the others in
+        // order gives exactly the same vertices and indices as a single thread.
+        const size_t numCells = mPendingCells.size();
+        numThreads = std::max<size_t>(1, std::min(numThreads, numCells / 256));
+        vector<MeshBuilder*>::type meshBuilders(numThreads);
+        meshBuilders[0] = mb;
+        for (size_t i = 1; i < numThreads; ++i)
+        {
+            meshBuilders[i] = OGRE_NEW MeshBuilder();
+        }
+
+        DualCellContourTask task(this, &meshBuilders[0], numCells);
+        Threads::ExecuteUniformScalableTask(&task, numThreads);
+
+        for (size_t i = 1; i < numThreads; ++i)
+        {
+            mb->append(*meshBuilders[i]);
+            OGRE_DELETE meshBuilders[i];
+        }
+        mPendingCells.clear();
     }
     
     //-----------------------------------------------------------------------
@@ -129,6 +129,13 @@ namespace Volume {
 
     //-----------------------------------------------------------------------
 
+    bool HalfFloatGridSource::isThreadSafe(void) const
+    {
+        return true;
+    }
+
+    //-----------------------------------------------------------------------
+
     HalfFloatGridSource::~HalfFloatGridSource(void)
     {
         OGRE_FREE(mData, MEMCATEGORY_GENERAL);
@@ -144,7 +144,7 @@ namespace Volume {
         {
             if (volumeValues)
             {
-                values[i] = volumeValues[indices[i]].w;
+                values[i] = volumeValues[indices[i]];
             }
             else
             {
@@ -172,25 +172,25 @@ namespace Volume {
         intersectionPoints[4] = corners[indices[2]];
         intersectionPoints[6] = corners[indices[3]];
 
-        Vector4 innerVal = mSrc->getValueAndGradient(intersectionPoints[0]);
+        Vector4 innerVal = values[0];
         intersectionNormals[0].x = innerVal.x;
         intersectionNormals[0].y = innerVal.y;
         intersectionNormals[0].z = innerVal.z;
         intersectionNormals[0].normalise();
         intersectionNormals[0] *= innerVal.w + (Real)1.0;
-        innerVal = mSrc->getValueAndGradient(intersectionPoints[2]);
+        innerVal = values[1];
         intersectionNormals[2].x = innerVal.x;
         intersectionNormals[2].y = innerVal.y;
         intersectionNormals[2].z = innerVal.z;
         intersectionNormals[2].normalise();
         intersectionNormals[2] *= innerVal.w + (Real)1.0;
-        innerVal = mSrc->getValueAndGradient(intersectionPoints[4]);
+        innerVal = values[2];
         intersectionNormals[4].x = innerVal.x;
         intersectionNormals[4].y = innerVal.y;
         intersectionNormals[4].z = innerVal.z;
         intersectionNormals[4].normalise();
         intersectionNormals[4] *= innerVal.w + (Real)1.0;
-        innerVal = mSrc->getValueAndGradient(intersectionPoints[6]);
+        innerVal = values[3];
         intersectionNormals[6].x = innerVal.x;
         intersectionNormals[6].y = innerVal.y;
         intersectionNormals[6].z = innerVal.z;
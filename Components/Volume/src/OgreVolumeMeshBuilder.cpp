@@ -65,6 +65,16 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
+    void MeshBuilder::append(const MeshBuilder &other)
+    {
+        for (VecIndices::const_iterator it = other.mIndices.begin(); it != other.mIndices.end(); ++it)
+        {
+            addVertex(other.mVertices[*it]);
+        }
+    }
+    
+    //-----------------------------------------------------------------------
+
     size_t MeshBuilder::generateBuffers(RenderOperation &operation)
     {
         // Early out if nothing to do.
@@ -30,6 +30,8 @@ THE SOFTWARE.
 #include "OgreVolumeSource.h"
 #include "OgreVolumeOctreeNodeSplitPolicy.h"
 #include "OgreSceneManager.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreUniformScalableTask.h"
 
 namespace Ogre {
 namespace Volume {
@@ -103,7 +105,7 @@ namespace Volume {
     
     //-----------------------------------------------------------------------
 
-    void OctreeNode::split(const OctreeNodeSplitPolicy *splitPolicy, const Source *src, const Real geometricError)
+    bool OctreeNode::splitOnce(const OctreeNodeSplitPolicy *splitPolicy, const Source *src, const Real geometricError)
     {
         if (splitPolicy->doSplit(this, geometricError))
         {
@@ -119,33 +121,96 @@ namespace Volume {
             */
             mChildren = new OctreeNode*[OCTREE_CHILDREN_COUNT];
             mChildren[0] = createInstance(mFrom, newCenter);
-            mChildren[0]->split(splitPolicy, src, geometricError);
             mChildren[1] = createInstance(mFrom + xWidth, newCenter + xWidth);
-            mChildren[1]->split(splitPolicy, src, geometricError);
             mChildren[2] = createInstance(mFrom + xWidth + zWidth, newCenter + xWidth + zWidth);
-            mChildren[2]->split(splitPolicy, src, geometricError);
             mChildren[3] = createInstance(mFrom + zWidth, newCenter + zWidth);
-            mChildren[3]->split(splitPolicy, src, geometricError);
             mChildren[4] = createInstance(mFrom + yWidth, newCenter + yWidth);
-            mChildren[4]->split(splitPolicy, src, geometricError);
             mChildren[5] = createInstance(mFrom + yWidth + xWidth, newCenter + yWidth + xWidth);
-            mChildren[5]->split(splitPolicy, src, geometricError);
             mChildren[6] = createInstance(mFrom + yWidth + xWidth + zWidth, newCenter + yWidth + xWidth + zWidth);
-            mChildren[6]->split(splitPolicy, src, geometricError);
             mChildren[7] = createInstance(mFrom + yWidth + zWidth, newCenter + yWidth + zWidth);
-            mChildren[7]->split(splitPolicy, src, geometricError);
+            return true;
         }
-        else
+
+        if (mCenterValue.x == (Real)0.0 && mCenterValue.y == (Real)0.0 && mCenterValue.z == (Real)0.0 && mCenterValue.w == (Real)0.0)
         {
-            if (mCenterValue.x == (Real)0.0 && mCenterValue.y == (Real)0.0 && mCenterValue.z == (Real)0.0 && mCenterValue.w == (Real)0.0)
+            setCenterValue(src->getValueAndGradient(getCenter()));
+        }
+        return false;
+    }
+    
+    //-----------------------------------------------------------------------
+
+    void OctreeNode::split(const OctreeNodeSplitPolicy *splitPolicy, const Source *src, const Real geometricError)
+    {
+        if (splitOnce(splitPolicy, src, geometricError))
+        {
+            for (size_t i = 0; i < OCTREE_CHILDREN_COUNT; ++i)
             {
-                setCenterValue(src->getValueAndGradient(getCenter()));
+                mChildren[i]->split(splitPolicy, src, geometricError);
             }
         }
     }
     
     //-----------------------------------------------------------------------
 
+    /// Splits a set of independent nodes, interleaved between the threads.
+    class OctreeNodeSplitTask : public UniformScalableTask
+    {
+    public:
+        const vector<OctreeNode*>::type &mNodes;
+        const OctreeNodeSplitPolicy *mSplitPolicy;
+        const Source *mSrc;
+        Real mGeometricError;
+
+        OctreeNodeSplitTask(const vector<OctreeNode*>::type &nodes, const OctreeNodeSplitPolicy *splitPolicy,
+            const Source *src, Real geometricError) :
+            mNodes(nodes), mSplitPolicy(splitPolicy), mSrc(src), mGeometricError(geometricError)
+        {
+        }
+
+        virtual void execute(size_t threadId, size_t numThreads)
+        {
+            for (size_t i = threadId; i < mNodes.size(); i += numThreads)
+            {
+                mNodes[i]->split(mSplitPolicy, mSrc, mGeometricError);
+            }
+        }
+    };
+    
+    //-----------------------------------------------------------------------
+
+    void OctreeNode::split(const OctreeNodeSplitPolicy *splitPolicy, const Source *src, const Real geometricError, size_t numThreads)
+    {
+        if (numThreads <= 1)
+        {
+            split(splitPolicy, src, geometricError);
+            return;
+        }
+
+        // Go down breadth first until there are enough subtrees to keep all threads busy.
+        // Subtrees get very different sizes depending on where the isosurface is.
+        vector<OctreeNode*>::type nodes;
+        vector<OctreeNode*>::type nextNodes;
+        nodes.push_back(this);
+        while (!nodes.empty() && nodes.size() < numThreads * 4)
+        {
+            nextNodes.clear();
+            for (size_t i = 0; i < nodes.size(); ++i)
+            {
+                if (nodes[i]->splitOnce(splitPolicy, src, geometricError))
+                {
+                    nextNodes.insert(nextNodes.end(), nodes[i]->mChildren, nodes[i]->mChildren + OCTREE_CHILDREN_COUNT);
+                }
+            }
+            nodes.swap(nextNodes);
+        }
+
+        OctreeNodeSplitTask task(nodes, splitPolicy, src, geometricError);
+        Threads::ExecuteUniformScalableTask(&task, std::min(numThreads, nodes.size()));
+    }
+    
+    //-----------------------------------------------------------------------
+
     Entity* OctreeNode::getOctreeGrid(SceneManager *sceneManager)
     {
         if (!mOctreeGrid)
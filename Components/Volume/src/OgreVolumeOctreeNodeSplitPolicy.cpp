@@ -60,14 +60,26 @@ namespace Volume {
         }
 
         // Error metric of http://www.andrew.cmu.edu/user/jessicaz/publication/meshing/
-        Real f000 = mSrc->getValue(from);
-        Real f001 = mSrc->getValue(node->getCorner3());
-        Real f010 = mSrc->getValue(node->getCorner4());
-        Real f011 = mSrc->getValue(node->getCorner7());
-        Real f100 = mSrc->getValue(node->getCorner1());
-        Real f101 = mSrc->getValue(node->getCorner2());
-        Real f110 = mSrc->getValue(node->getCorner5());
-        Real f111 = mSrc->getValue(to);
+        // All samples are fetched with two batch calls.
+        const Vector3 corners[8] = {
+            from,
+            node->getCorner3(),
+            node->getCorner4(),
+            node->getCorner7(),
+            node->getCorner1(),
+            node->getCorner2(),
+            node->getCorner5(),
+            to
+        };
+        Real cornersX[8], cornersY[8], cornersZ[8];
+        for (size_t i = 0; i < 8; ++i)
+        {
+            cornersX[i] = corners[i].x;
+            cornersY[i] = corners[i].y;
+            cornersZ[i] = corners[i].z;
+        }
+        Real f[8];
+        mSrc->getValues(8, cornersX, cornersY, cornersZ, f);
 
         Vector3 positions[19][2] = {
             {node->getCenterBackBottom(), Vector3((Real)0.5, (Real)0.0, (Real)0.0)},
@@ -93,23 +105,30 @@ namespace Volume {
             {node->getCenterFrontTop(), Vector3((Real)0.5, (Real)1.0, (Real)1.0)}
         };
 
+        Real posX[19], posY[19], posZ[19];
+        for (size_t i = 0; i < 19; ++i)
+        {
+            posX[i] = positions[i][0].x;
+            posY[i] = positions[i][0].y;
+            posZ[i] = positions[i][0].z;
+        }
+        Real values[19], gradX[19], gradY[19], gradZ[19];
+        mSrc->getValuesAndGradients(19, posX, posY, posZ, values, gradX, gradY, gradZ);
     
         Real error = (Real)0.0;
-        Vector4 value;
         Vector3 gradient;
         for (size_t i = 0; i < 19; ++i)
         {
-            value = mSrc->getValueAndGradient(positions[i][0]);
-            gradient.x = value.x;
-            gradient.y = value.y;
-            gradient.z = value.z;
-            Real interpolated = interpolate(f000, f001, f010, f011, f100, f101, f110, f111, positions[i][1]);
+            gradient.x = gradX[i];
+            gradient.y = gradY[i];
+            gradient.z = gradZ[i];
+            Real interpolated = interpolate(f[0], f[1], f[2], f[3], f[4], f[5], f[6], f[7], positions[i][1]);
             Real gradientMagnitude = gradient.length();
             if (gradientMagnitude < FLT_EPSILON)
             {
                 gradientMagnitude = (Real)1.0;
             }
-            error += Math::Abs(value.w - interpolated) / gradientMagnitude;
+            error += Math::Abs(values[i] - interpolated) / gradientMagnitude;
             if (error >= geometricError)
             {
                 return true;
@@ -37,6 +37,7 @@ namespace Volume {
     const uint32 Source::VOLUME_CHUNK_ID = StreamSerialiser::makeIdentifier("VOLU");
     const uint16 Source::VOLUME_CHUNK_VERSION = 1;
     const size_t Source::SERIALIZATION_CHUNK_SIZE = 1000;
+    const size_t Source::BATCH_SIZE;
 
     //-----------------------------------------------------------------------
 
@@ -61,6 +62,38 @@ namespace Volume {
 
     //-----------------------------------------------------------------------
 
+    void Source::getValues(size_t count, const Real *posX, const Real *posY, const Real *posZ, Real *outValues) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            outValues[i] = getValue(Vector3(posX[i], posY[i], posZ[i]));
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Source::getValuesAndGradients(size_t count, const Real *posX, const Real *posY, const Real *posZ,
+        Real *outValues, Real *outGradX, Real *outGradY, Real *outGradZ) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Vector4 value = getValueAndGradient(Vector3(posX[i], posY[i], posZ[i]));
+            outGradX[i] = value.x;
+            outGradY[i] = value.y;
+            outGradZ[i] = value.z;
+            outValues[i] = value.w;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool Source::isThreadSafe(void) const
+    {
+        return false;
+    }
+
+    //-----------------------------------------------------------------------
+
     void Source::serialize(const Vector3 &from, const Vector3 &to, float voxelWidth, const String &file)
     {
         Real maxClampedAbsoluteDensity = (from - to).length() / (Real)16.0;
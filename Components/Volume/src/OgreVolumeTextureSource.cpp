@@ -116,6 +116,13 @@ namespace Volume {
         
     //-----------------------------------------------------------------------
 
+    bool TextureSource::isThreadSafe(void) const
+    {
+        return true;
+    }
+
+    //-----------------------------------------------------------------------
+
     TextureSource::~TextureSource(void)
     {
         OGRE_FREE(mData, MEMCATEGORY_GENERAL);
@@ -148,8 +148,17 @@ namespace Ogre
         /// For custom passes.
         CompositorPassProvider  *mCompositorPassProvider;
 
+        bool                    mMultiViewCulling;
+        /// SceneManagers that got their views culled in advance this frame.
+        /// @see setMultiViewCulling
+        vector<SceneManager*>::type mMultiViewCulledSceneManagers;
+
         void addQueuedWorkspaces(void);
 
+        /// Culls the scene passes of all enabled workspaces sharing the same
+        /// SceneManager at once. @see setMultiViewCulling
+        void cullAllViewsBatched(void);
+
     public:
         CompositorManager2( RenderSystem *renderSystem );
         ~CompositorManager2();
@@ -408,6 +417,25 @@ namespace Ogre
 
         void addListener( CompositorWorkspaceListener *listener );
         void removeListener( CompositorWorkspaceListener *listener );
+
+        /** When enabled, the scene passes of all the workspaces sharing the same SceneManager
+            (i.e. the eyes in stereo rendering, or multiple nearly co-located views) are culled
+            together before any workspace is updated. Every object is loaded once and
+            tested against all views, using the worker threads once instead of once per view.
+            @see SceneManager::_cullFrustumsBatched
+        @remarks
+            Passes whose camera, frustum or culling parameters are changed after the
+            workspaces begin updating (i.e. from a listener) are detected and culled
+            again individually.
+        @par
+            Objects must not be moved once the workspaces begin updating (after
+            CompositorWorkspaceListener::allWorkspacesBeginUpdate), since the views
+            may have already been culled.
+        @par
+            Disabled by default.
+        */
+        void setMultiViewCulling( bool multiViewCulling );
+        bool getMultiViewCulling(void) const                        { return mMultiViewCulling; }
     };
 
     /** @} */
@@ -102,6 +102,9 @@ namespace Ogre
         size_t                  mNumConnectedInputs;
         CompositorChannelVec    mInTextures;
         CompositorChannelVec    mLocalTextures;
+        /// Same size as mLocalTextures. True if the entry is aliasing a texture
+        /// owned by another node. @see _aliasLocalTexture
+        vector<bool>::type      mAliasedLocalTextures;
 
         /// Contains pointers that are ither in mInTextures or mLocalTextures
         CompositorChannelVec    mOutTextures;
@@ -305,6 +308,27 @@ namespace Ogre
         void notifyRecreated( const CompositorChannel &oldChannel, const CompositorChannel &newChannel );
         void notifyRecreated( const UavBufferPacked *oldBuffer, UavBufferPacked *newBuffer );
 
+        /** Makes our local texture at the given index use the textures from another
+            node's local texture instead, and destroys ours. Everything referencing our
+            texture (our outputs and the nodes connected to them) is updated.
+        @remarks
+            Internal use, called by CompositorWorkspace when aliasing transient textures.
+            Must be called before the passes are created. We won't destroy nor recreate
+            aliased textures; the node owning them does. Hence once a node has aliased
+            textures, the workspace recreates all nodes instead of calling
+            finalTargetResized.
+        @param localTextureIdx
+            Index to mLocalTextures. Must not be an MRT.
+        @param aliasedChannel
+            The channel to use instead. Must have been created from a definition
+            for which TextureDefinition::isAliasableWith returns true.
+        */
+        void _aliasLocalTexture( size_t localTextureIdx, const CompositorChannel &aliasedChannel );
+
+        /// Returns true if the local texture is owned by another node. @see _aliasLocalTexture
+        bool isLocalTextureAliased( size_t localTextureIdx ) const
+                                                    { return mAliasedLocalTextures[localTextureIdx]; }
+
         /** Call this function when caller has destroyed a RenderTarget in which the callee
             may have a reference to that pointer, so that we can clean it up.
         @param channel
@@ -111,6 +111,24 @@ namespace Ogre
             Real                    minDistance;
             Real                    maxDistance;
             Vector2                 scenePassesViewportSize[Light::NUM_LIGHT_TYPES];
+
+            /// True if a pass not tied to any shadow map (e.g. clearing the whole
+            /// atlas) also writes to our texture. If so, either all shadow maps in
+            /// that texture are reused, or none are.
+            bool                    sharesAtlasPasses;
+            /// True if the contents of the shadow map are still valid from the last
+            /// time it was rendered, hence we don't need to render it. @see setAutomaticCaching
+            bool                    upToDate;
+            /// True if dynamic casters are inside the shadow camera's volume this frame.
+            /// A shadow map rendered with dynamic casters in it is never reused, as those
+            /// casters may have moved (or left the volume) by the next frame.
+            bool                    dynamicCastersInVolume;
+            /// State of the last time the shadow map was rendered. Only valid if cacheValid
+            bool                    cacheValid;
+            Light const             *cachedLight;
+            uint32                  cachedStaticSceneVersion;
+            Matrix4                 cachedViewMatrix;
+            Matrix4                 cachedProjectionMatrix;
         };
 
         typedef vector<ShadowMapCamera>::type ShadowMapCameraVec;
@@ -143,6 +161,41 @@ namespace Ogre
         /// Changes with each call to setShadowMapsToPass
         LightList               mCurrentLightList;
 
+        bool                    mAutomaticCaching;
+        size_t                  mNumCachedShadowMaps;
+        /// Textures (atlases) with sharesAtlasPasses where all shadow maps are up to date
+        IdStringVec             mUpToDateAtlases;
+
+        /// Frustums of all the scene passes that will be executed this frame,
+        /// so they can be culled at once. @see cullShadowMapsBatched
+        BatchedCullFrustumVec   mBatchedCullFrustums;
+
+        /// Decides whether the shadow map can reuse what was rendered into it last time.
+        /// Must be called after its shadow camera has been set up. @see setAutomaticCaching
+        bool isShadowMapUpToDate( const ShadowMapCamera &shadowMapCamera, const Light *light,
+                                  uint32 staticSceneVersion ) const;
+        /// Returns true if there are dynamic casters inside the volume covered by the
+        /// shadow camera (or the light's range, for point lights). Also returns true
+        /// when that volume can't be bounded.
+        bool hasDynamicCastersInVolume( const ShadowMapCamera &shadowMapCamera,
+                                        const Light *light, SceneManager *sceneManager ) const;
+        /// Invalidates the automatic cache of all shadow maps
+        void invalidateShadowMapCache(void);
+        /// Evaluates isShadowMapUpToDate for every shadow map. Must be called
+        /// after the shadow cameras have been set up.
+        void updateShadowMapCacheState( SceneManager *sceneManager );
+
+        /** Gathers the frustums of all the scene passes that are going to be executed
+            and asks the SceneManager to cull them all together in one go (each worker
+            thread tests its share of objects against all shadow cameras), instead of
+            going through the worker threads once per shadow map.
+            Must be called after the shadow cameras have been set up.
+        @remarks
+            Passes using a custom LOD camera or reusing cull data are left out and
+            get culled individually as usual.
+        */
+        void cullShadowMapsBatched( SceneManager *sceneManager, const Camera *lodCamera );
+
         /** Called by update to find out which lights are the ones closest to the given
             camera. Early outs if we've already calculated our stuff for that camera in
             a previous call.
@@ -213,6 +266,11 @@ namespace Ogre
 
         bool _shouldUpdateShadowMapIdx( uint32 shadowMapIdx ) const;
 
+        /// Returns false if the given texture is an atlas whose shadow maps are all
+        /// up to date, thus passes not tied to a shadow map (e.g. clear) can be skipped.
+        /// @see setAutomaticCaching
+        bool _shouldUpdateAtlas( IdString textureName ) const;
+
         /// Do not call this if isShadowMapIdxActive == false or isShadowMapIdxInValidRange == false
         uint8 getShadowMapLightTypeMask( uint32 shadowMapIdx ) const;
 
@@ -334,6 +392,35 @@ namespace Ogre
         /// to call it for every shadow map (otherwise you will trigger a O(N^2) behavior).
         void setStaticShadowMapDirty( size_t shadowMapIdx, bool includeLinked=true );
 
+        /** Enables automatic shadow map caching. When enabled, shadow maps won't be
+            rendered again if nothing that affects them has changed since the last
+            time they were rendered:
+                * The same light is assigned to it.
+                * The shadow camera hasn't changed (i.e. the light didn't move; and for
+                  directional lights, the camera didn't move either).
+                * The static scene hasn't changed (@see SceneManager::getStaticSceneVersion)
+                * There were no dynamic shadow casters inside the shadow camera's volume
+                  when it was last rendered, and there are none now.
+        @remarks
+            Since Ogre doesn't track whether dynamic (SCENE_DYNAMIC) objects moved, any
+            dynamic caster inside a shadow map will cause it to be rendered again every
+            frame. Put the geometry that doesn't move in SCENE_STATIC to benefit from this.
+        @par
+            Shadow maps that share an atlas with passes that aren't tied to a shadow map
+            (e.g. a clear pass for the whole atlas) will always be rendered.
+        @par
+            Shadow maps tied to a light via setLightFixedToShadowMap are not affected;
+            they keep being updated only when setStaticShadowMapDirty gets called.
+        @par
+            LOD levels of the casters are not reevaluated for shadow maps that get reused.
+        */
+        void setAutomaticCaching( bool bEnabled );
+        bool getAutomaticCaching(void) const                { return mAutomaticCaching; }
+
+        /// Number of active shadow maps that weren't rendered in the last update
+        /// because they were still up to date. @see setAutomaticCaching
+        size_t getNumCachedShadowMaps(void) const           { return mNumCachedShadowMaps; }
+
         /// @copydoc CompositorNode::finalTargetResized
         virtual void finalTargetResized( const RenderTarget *finalTarget );
     };
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreVector4.h"
 #include "OgreCamera.h"
 #include "OgreResourceTransition.h"
+#include "OgreFrameStats.h"
 
 namespace Ogre
 {
@@ -46,6 +47,7 @@ namespace Ogre
     */
 
     struct BoundUav;
+    struct BatchedCullFrustum;
     typedef vector<UavBufferPacked*>::type UavBufferPackedVec;
 
     /** A compositor workspace is the main interface to render into an RT, be it a RenderWindow or an
@@ -117,6 +119,47 @@ namespace Ogre
         ResourceLayoutMap       mResourcesLayout;
         ResourceAccessMap       mUavsAccess;
 
+        /// Number of node local textures that are sharing another node's texture
+        size_t                  mNumAliasedTextures;
+        /// Memory used by the local textures of all our nodes, without aliasing. In bytes.
+        size_t                  mLocalTextureMemoryUnaliased;
+        /// Memory actually used by the local textures of all our nodes. In bytes.
+        size_t                  mLocalTextureMemory;
+
+        /** One step of the execution plan. @see buildExecutionPlan
+        @remarks
+            When pass is null, the entry only notifies a render target switch (the
+            pass was excluded by the execution mask, or the node has finished) or,
+            if notifySwitch is also false, the node is enabled but not all of its
+            inputs are connected.
+        */
+        struct ExecutionPlanEntry
+        {
+            CompositorNode  *node;
+            CompositorPass  *pass;
+            /// Target to pass to RenderSystem::_notifyCompositorNodeSwitchedRenderTarget
+            RenderTarget    *switchedFromTarget;
+            /// Whether to notify the switch before executing the pass (if any)
+            bool            notifySwitch;
+            /// Range [start; end) in mExecutionPlanTextures exposed to materials during the pass
+            uint32          exposedTexturesStart;
+            uint32          exposedTexturesEnd;
+        };
+        typedef vector<ExecutionPlanEntry>::type ExecutionPlanEntryVec;
+        typedef std::pair<IdString, const CompositorChannel::TextureVec*> ExposedTexture;
+        typedef vector<ExposedTexture>::type ExposedTextureVec;
+
+        ExecutionPlanEntryVec   mExecutionPlan;
+        ExposedTextureVec       mExecutionPlanTextures;
+        bool                    mExecutionPlanDirty;
+
+        /// CPU time spent in _update, per frame
+        FrameStats              mCpuFrameStats;
+        /// CPU time spent in _update during the current frame, in microseconds
+        unsigned long           mCpuTimeThisFrame;
+        /// Whether _update was called during the current frame
+        bool                    mUpdatedThisFrame;
+
         /// Creates all the node instances from our definition
         void createAllNodes(void);
 
@@ -145,8 +188,32 @@ namespace Ogre
 
         void analyzeHazardsAndPlaceBarriers(void);
 
+        /** Computes the lifetime of the local textures of every node (from the node that
+            declares them up to the last node that receives them in an input channel),
+            then makes transient textures (@see TextureDefinition::transient) whose lifetimes
+            don't overlap and have compatible definitions share the same texture.
+        @remarks
+            Call this function after mNodeSequence has been sorted in execution order and
+            all nodes are connected, but before the passes are created.
+        */
+        void aliasTransientTextures(void);
+
         CompositorNode* getLastEnabledNode(void);
 
+        /** Flattens the passes from all enabled nodes into mExecutionPlan, skipping
+            the ones that don't match our execution mask and resolving the render
+            targets and exposed textures, so that _update doesn't have to walk every
+            node and pass each frame.
+        @remarks
+            Call this function after the barriers have been placed. The plan is
+            rebuilt automatically whenever nodes are (re)connected, enabled/disabled
+            (@see _notifyBarriersDirty) or resized.
+        */
+        void buildExecutionPlan(void);
+
+        /// Executes the plan built by buildExecutionPlan
+        void executePlan(void);
+
     public:
         CompositorWorkspace( IdType id, const CompositorWorkspaceDef *definition,
                              const CompositorChannelVec &externalRenderTargets,
@@ -184,6 +251,41 @@ namespace Ogre
         void setListener( CompositorWorkspaceListener *listener )   { mListener = listener; }
         CompositorWorkspaceListener* getListener(void) const        { return mListener; }
 
+        /** Returns the memory (in bytes) taken by the local textures of all our nodes.
+        @param unaliased
+            When true, returns the memory that would be needed if transient textures
+            weren't aliased (i.e. the peak before aliasing). When false, the memory
+            actually in use.
+        */
+        size_t getLocalTextureMemory( bool unaliased=false ) const
+                { return unaliased ? mLocalTextureMemoryUnaliased : mLocalTextureMemory; }
+
+        /// Returns the number of node local textures sharing another texture's memory.
+        size_t getNumAliasedTextures(void) const            { return mNumAliasedTextures; }
+
+        /** Returns the CPU time spent inside _update (including the workspace listener's
+            workspacePreUpdate) for the last frames. Useful for finding out which
+            workspaces are expensive to update, when having lots of them.
+        @remarks
+            There is one sample per frame in which the workspace was updated; if
+            _update was called several times in a frame, the sample is their sum.
+        */
+        const FrameStats& getCpuFrameStats(void) const      { return mCpuFrameStats; }
+
+        /** Records the CPU time spent in _update during the current frame into
+            getCpuFrameStats, if we were updated at all. Called by CompositorManager2
+            at the end of every frame.
+        */
+        void _recordCpuFrameStats(void);
+
+        /** Appends the frustums of the scene passes this workspace is going to execute
+            (and that can be culled in advance) to outFrustums.
+            @see CompositorManager2::setMultiViewCulling
+        @remarks
+            Does nothing if the execution plan needs to be rebuilt.
+        */
+        void _gatherBatchedCullFrustums( vector<BatchedCullFrustum>::type &outFrustums ) const;
+
         const ResourceLayoutMap& getResourcesLayout(void) const     { return mResourcesLayout; }
         const ResourceAccessMap& getUavsAccess(void) const          { return mUavsAccess; }
 
@@ -315,7 +417,11 @@ namespace Ogre
 
         uint8 getExecutionMask(void) const                  { return mExecutionMask; }
 
-        void _notifyBarriersDirty(void)                     { mBarriersDirty = true; }
+        void _notifyBarriersDirty(void)
+        {
+            mBarriersDirty = true;
+            mExecutionPlanDirty = true;
+        }
 
         /// Gets the compositor manager (non const)
         CompositorManager2* getCompositorManager();
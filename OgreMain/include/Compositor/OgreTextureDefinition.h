@@ -114,6 +114,21 @@ namespace Ogre
             */
             bool    fsaaExplicitResolve;
 
+            /** When true, the contents of this texture don't need to survive outside the
+                range of nodes that use it (i.e. it's always written before being read
+                every frame, and it isn't read in the next frame). Such textures
+                may share their memory (be aliased) with other transient textures
+                of the same format & resolution whose lifetimes don't overlap.
+                Only honoured for node (not global) non-MRT textures.
+            @see CompositorWorkspace::getLocalTextureMemory
+            */
+            bool    transient;
+
+            /** Returns true if this texture and the given one would be created
+                with the exact same parameters, so that one can stand for the other.
+            */
+            bool isAliasableWith( const TextureDefinition &other ) const;
+
             /// Do not call directly. @see TextureDefinition::renameTexture instead.
             void _setName( IdString newName )   { name = newName; }
             IdString getName(void) const        { return name; }
@@ -122,7 +137,7 @@ namespace Ogre
                     width(0), height(0), depth(1), numMipmaps(0), widthFactor(1.0f), heightFactor(1.0f),
                     fsaa(true), uav(false), automipmaps(false), hwGammaWrite(BoolUndefined),
                     depthBufferId(1), preferDepthTexture(false), depthBufferFormat(PF_UNKNOWN),
-                    fsaaExplicitResolve(false) {}
+                    fsaaExplicitResolve(false), transient(false) {}
         };
         typedef vector<TextureDefinition>::type     TextureDefinitionVec;
 
@@ -332,6 +347,11 @@ namespace Ogre
                                                 const String &texName, const RenderTarget *finalTarget,
                                                 RenderSystem *renderSys );
 
+        /** Returns the amount of memory, in bytes, the textures from the given
+            channel take (including mipmaps and MSAA surfaces).
+        */
+        static size_t getMemoryUsage( const CompositorChannel &channel );
+
         /// @See createTextures
         static void destroyTextures( CompositorChannelVec &inOutTexContainer, RenderSystem *renderSys );
 
@@ -95,6 +95,7 @@ namespace Ogre
         Camera* getCamera() const                               { return mCamera; }
         void _setCustomCamera( Camera *camera )                 { mCamera = camera; }
         Camera* getCullCamera() const                           { return mCullCamera; }
+        Camera* getLodCamera() const                            { return mLodCamera; }
         void _setCustomCullCamera( Camera *camera )             { mCullCamera = camera; }
         void _setUpdateShadowNode( bool update )                { mUpdateShadowNode = update; }
 
@@ -102,6 +103,13 @@ namespace Ogre
 
         virtual void notifyCleared(void);
 
+        /** Outputs the world space planes the cull camera will have while this pass
+            executes (i.e. after being reoriented for rendering to a cubemap face).
+        @remarks
+            The cull camera may be temporarily modified, but it is restored before returning.
+        */
+        void _getCullFrustumPlanes( Plane outPlanes[6] ) const;
+
         const CompositorPassSceneDef* getDefinition() const     { return mDefinition; }
     };
 
@@ -135,6 +135,22 @@ namespace Ogre
             virtual void performCleanup( uint16 level, const MemoryPoolVec &basePtrs,
                                          size_t const *elementsMemSizes, size_t startInstance,
                                          size_t diffInstances ) = 0;
+
+            /** Called when @see ArrayMemoryManager::defragment moved the last slot into a hole.
+                Unlike performCleanup, only one slot was moved, but slots don't keep their order.
+                @remarks
+                    The memory (including the owner's ptr) has already been moved; the owner
+                    of the slot needs its pointers updated.
+                    Listeners whose slots must be kept in order should raise an exception.
+                @param level
+                    The hierarchy depth level
+                @param basePtrs
+                    The base ptrs.
+                @param dstInstance
+                    The slot the last slot was moved to.
+            */
+            virtual void performSlotMove( uint16 level, const MemoryPoolVec &basePtrs,
+                                          size_t dstInstance ) = 0;
         };
 
     protected:
@@ -152,6 +168,9 @@ namespace Ogre
         size_t              mCleanupThreshold;
         typedef std::vector<size_t> SlotsVec; //TODO: Modify for Ogre
         SlotsVec            mAvailableSlots;
+        /// The first mNumSortedAvailableSlots entries of mAvailableSlots are sorted in
+        /// ascending order. Slots released after the last defragment are appended unsorted.
+        size_t              mNumSortedAvailableSlots;
         RebaseListener      *mRebaseListener;
 
         /// The hierarchy depth level. This value is not used by the manager,
@@ -159,6 +178,9 @@ namespace Ogre
         /// belongs
         uint16              mLevel;
 
+        /// When true, destroySlot won't perform cleanups. @see setCleanupsDeferred
+        bool                mCleanupsDeferred;
+
     public:
         static const size_t MAX_MEMORY_SLOTS;
 
@@ -235,6 +257,51 @@ namespace Ogre
         /// Gets all memory reserved for this manager
         size_t getAllMemory() const;
 
+        /** Makes sure the next numSlots calls to createNewSlot won't need to grow
+            the memory pool, by growing it (at most once) right now.
+        @remarks
+            Creating many slots one by one may otherwise reallocate and rebase the
+            whole pool several times. Does nothing if there's already enough memory.
+            It's not an error to reserve past the hard limit, it's clamped.
+        */
+        void reserveSlots( size_t numSlots );
+
+        /** While deferred, destroySlot never performs cleanups regardless of how
+            many slots were released. When set back to false, the cleanup that
+            got postponed (if the threshold was exceeded) is done in one go.
+        @remarks
+            Useful when releasing lots of slots at once, which would otherwise trigger
+            a cleanup every time mCleanupThreshold slots get released.
+        */
+        void setCleanupsDeferred( bool bDeferred );
+        bool getCleanupsDeferred(void) const                    { return mCleanupsDeferred; }
+
+        /** Incrementally fills the holes left by released slots by moving the last used
+            slots into them. Meant to be called once per frame with a small budget while
+            cleanups are deferred (@see setCleanupsDeferred), so that the memory gets
+            compacted a few slots at a time instead of all at once.
+        @remarks
+            Unlike the regular cleanup, slots don't keep their relative order.
+            Each moved slot is notified via RebaseListener::performSlotMove.
+        @param maxSlotMoves
+            Maximum number of slots to move. Holes at the end of the used memory are
+            released without moving anything, and don't count.
+        @return
+            Number of slots that were moved.
+        */
+        size_t defragment( size_t maxSlotMoves );
+
+        /** Rearranges the used slots in the given order (e.g. to sort them spatially).
+        @remarks
+            Every slot that isn't a hole is notified via RebaseListener::performSlotMove.
+            Holes keep being holes, at their new position.
+            The memory pools are reallocated once, thus this isn't meant to be done every frame.
+        @param newOrder
+            newOrder[i] is the slot that must end up in slot i. Must be a permutation of
+            [0; getNumUsedSlotsIncludingFragmented())
+        */
+        void permuteSlots( const size_t *newOrder );
+
     protected:
         /** Requests memory for a new slot (could be used for SceneNode, Entities, etc.)
             @remarks
@@ -256,6 +323,12 @@ namespace Ogre
         */
         void destroySlot( const char *ptrToFirstElement, uint8 index );
 
+        /// Reallocates the memory pools to hold newMemory slots, and rebases all pointers.
+        void growMemory( size_t newMemory );
+
+        /// Compacts the memory by removing all slots in mAvailableSlots.
+        void cleanupAvailableSlots(void);
+
         /** Called when mMemoryPools changes, to give a chance derived class to initialize
             new memory to default values
         @remarks
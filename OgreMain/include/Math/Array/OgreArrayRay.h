@@ -46,6 +46,16 @@ namespace Ogre
         /// SLAB method
         /// See https://tavianator.com/fast-branchless-raybounding-box-intersections-part-2-nans/
         ArrayMaskR intersects( const ArrayAabb &aabb ) const
+        {
+            ArrayReal distance;
+            return intersects( aabb, distance );
+        }
+
+        /** Same as intersects( aabb ), but also returns the distance (in units of mDirection)
+            at which the ray enters the box. The distance is 0 if the origin is inside it.
+            Its value is undefined where the returned mask is not set.
+        */
+        ArrayMaskR intersects( const ArrayAabb &aabb, ArrayReal &outDistance ) const
         {
             ArrayVector3 invDir = Mathlib::SetAll( 1.0f ) / mDirection;
             ArrayVector3 intersectAtMinPlane = (aabb.getMinimum() - mOrigin) * invDir;
@@ -78,7 +88,8 @@ namespace Ogre
             tmax = Mathlib::Min( tmax, Mathlib::Max( maxIntersect.mChunkBase[2], tmin ) );
 #endif
             //tmax >= max( tmin, 0 )
-            return Mathlib::CompareGreaterEqual( tmax, Mathlib::Max( tmin, ARRAY_REAL_ZERO ) );
+            outDistance = Mathlib::Max( tmin, ARRAY_REAL_ZERO );
+            return Mathlib::CompareGreaterEqual( tmax, outDistance );
         }
     };
 }
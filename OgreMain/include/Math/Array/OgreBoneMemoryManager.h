@@ -169,6 +169,8 @@ namespace Ogre
         virtual void performCleanup( uint16 level, const MemoryPoolVec &basePtrs,
                                      size_t const *elementsMemSizes,
                                      size_t startInstance, size_t diffInstances );
+        virtual void performSlotMove( uint16 level, const MemoryPoolVec &basePtrs,
+                                      size_t dstInstance );
     };
 
     /** @} */
@@ -68,6 +68,9 @@ namespace Ogre
         SceneMemoryMgrTypes                     mMemoryManagerType;
         NodeMemoryManager                       *mTwinMemoryManager;
 
+        /// @see setCleanupsDeferred
+        bool                                    mCleanupsDeferred;
+
         /** Makes mMemoryManagers big enough to be able to fulfill mMemoryManagers[newDepth]
         @param newDepth
             Hierarchy level depth we wish to grow to.
@@ -87,6 +90,30 @@ namespace Ogre
         NodeMemoryManager* getTwin() const                          { return mTwinMemoryManager; }
         SceneMemoryMgrTypes getMemoryManagerType() const            { return mMemoryManagerType; }
 
+        /** Makes sure the next numNodes nodes created at the given depth won't
+            need to grow the memory pool. @see ArrayMemoryManager::reserveSlots
+        */
+        void reserve( size_t depth, size_t numNodes );
+
+        /** Defers the cleanups of all depth levels (including the ones
+            created while deferred). @see ArrayMemoryManager::setCleanupsDeferred
+        */
+        void setCleanupsDeferred( bool bDeferred );
+        bool getCleanupsDeferred(void) const                        { return mCleanupsDeferred; }
+
+        /** Incrementally compacts the memory of all depth levels, moving at most
+            maxSlotMoves nodes in total. @see ArrayMemoryManager::defragment
+        @return
+            Number of nodes that were moved.
+        */
+        size_t defragment( size_t maxSlotMoves );
+
+        /** Returns the memory (in bytes) wasted by the holes left by destroyed nodes
+            in the given depth level, which are still traversed by the update kernels.
+            Returns 0 if the depth level doesn't exist.
+        */
+        size_t getWastedMemory( size_t depth ) const;
+
         /** Requests memory for the given transform for the first, initializing values.
         @param outTransform
             Transform with filled pointers
@@ -213,6 +240,8 @@ namespace Ogre
         virtual void performCleanup( uint16 level, const MemoryPoolVec &basePtrs,
                                      size_t const *elementsMemSizes,
                                      size_t startInstance, size_t diffInstances );
+        virtual void performSlotMove( uint16 level, const MemoryPoolVec &basePtrs,
+                                      size_t dstInstance );
     };
 
     /** @} */
@@ -74,6 +74,9 @@ namespace Ogre
         SceneMemoryMgrTypes                     mMemoryManagerType;
         ObjectMemoryManager                     *mTwinMemoryManager;
 
+        /// @see setCleanupsDeferred
+        bool                                    mCleanupsDeferred;
+
         /** Makes mMemoryManagers big enough to be able to fulfill mMemoryManagers[newDepth]
         @param newDepth
             Hierarchy level depth we wish to grow to.
@@ -91,6 +94,46 @@ namespace Ogre
         ObjectMemoryManager* getTwin() const                        { return mTwinMemoryManager; }
         SceneMemoryMgrTypes getMemoryManagerType() const            { return mMemoryManagerType; }
 
+        /** Makes sure the next numObjects objects created in the given render
+            queue won't need to grow the memory pool. @see ArrayMemoryManager::reserveSlots
+        */
+        void reserve( size_t renderQueue, size_t numObjects );
+
+        /** Defers the cleanups of all render queues (including the ones
+            created while deferred). @see ArrayMemoryManager::setCleanupsDeferred
+        */
+        void setCleanupsDeferred( bool bDeferred );
+        bool getCleanupsDeferred(void) const                        { return mCleanupsDeferred; }
+
+        /** Incrementally compacts the memory of all render queues, moving at most
+            maxSlotMoves objects in total. @see ArrayMemoryManager::defragment
+        @return
+            Number of objects that were moved.
+        */
+        size_t defragment( size_t maxSlotMoves );
+
+        /** Returns the memory (in bytes) wasted by the holes left by destroyed objects
+            in the given render queue, which are still traversed by the culling kernels.
+            Returns 0 if the render queue doesn't exist.
+        */
+        size_t getWastedMemory( size_t renderQueue ) const;
+
+        /** Sorts the objects of every render queue by the Morton order (Z-order curve)
+            of the centre of their world AABB, so that objects that are close in space are
+            also close in memory.
+        @remarks
+            Culling benefits from it: blocks of ARRAY_PACKED_REALS objects tend to be
+            entirely in or out of the frustum, which allows early outs, and the
+            visible objects are found in fewer, contiguous chunks of memory.
+        @par
+            The world AABBs must be up to date. Holes left by destroyed objects are
+            moved to the end and released. Objects with infinite AABBs go last.
+        @par
+            It's expensive (sorts and reallocates the memory), thus meant for objects
+            that rarely move, like static ones. @see SceneManager::setStaticSpatialSorting
+        */
+        void sortSpatially(void);
+
         /** Requests memory for the given ObjectData, initializing values.
         @param outObjectData
             ObjectData with filled pointers
@@ -184,6 +227,8 @@ namespace Ogre
         virtual void performCleanup( uint16 level, const MemoryPoolVec &basePtrs,
                                      size_t const *elementsMemSizes,
                                      size_t startInstance, size_t diffInstances );
+        virtual void performSlotMove( uint16 level, const MemoryPoolVec &basePtrs,
+                                      size_t dstInstance );
     };
 
     /** @} */
@@ -203,8 +203,19 @@ namespace v1 {
         const String& getType(void) const;
         /// @copydoc ParticleSystemRenderer::_updateRenderQueue
         void _updateRenderQueue(RenderQueue* queue, Camera *camera, const Camera *lodCamera,
-            list<Particle*>::type& currentParticles, bool cullIndividually,
+            vector<Particle*>::type& currentParticles, bool cullIndividually,
             RenderableArray &outRenderables );
+        /// @copydoc ParticleSystemRenderer::_updateRenderQueueDeferred
+        virtual bool _updateRenderQueueDeferred( RenderQueue *queue, Camera *camera,
+                                                 const Camera *lodCamera,
+                                                 vector<Particle*>::type &currentParticles,
+                                                 bool cullIndividually,
+                                                 RenderableArray &outRenderables );
+        /// @copydoc ParticleSystemRenderer::_generateGeometry
+        virtual void _generateGeometry( const Camera *camera,
+                                        const vector<Particle*>::type &currentParticles );
+        /// @copydoc ParticleSystemRenderer::_finishGeometry
+        virtual void _finishGeometry(void);
         /// @copydoc ParticleSystemRenderer::_setDatablock
         virtual void _setDatablock( HlmsDatablock *datablock );
         /// @copydoc ParticleSystemRenderer::_setMaterialName
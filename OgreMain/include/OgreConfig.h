@@ -44,6 +44,7 @@ THE SOFTWARE.
 #define OGRE_PROFILING_INTERNAL         1
 #define OGRE_PROFILING_REMOTERY         2
 #define OGRE_PROFILING_INTERNAL_OFFLINE 3
+#define OGRE_PROFILING_TRACE            4
 
 /** There are three modes for handling asserts in OGRE:
 0 - STANDARD - Standard asserts in debug builds, nothing in release builds
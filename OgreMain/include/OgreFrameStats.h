@@ -87,6 +87,9 @@ namespace Ogre
             return avg / (float)mFramesSampled * 0.001f;
         }
 
+        /// Returns the number of samples (up to OGRE_FRAME_STATS_SAMPLES) being averaged
+        size_t getNumSamples(void) const        { return mFramesSampled; }
+
         /// Adds a new measured time, in *microseconds*
         void addSample( unsigned long timeMs )
         {
@@ -101,6 +104,14 @@ namespace Ogre
             mLastTime = timeMs;
         }
 
+        /** Adds a new measured duration (rather than a timestamp), in *microseconds*.
+            Useful for measuring a portion of the frame.
+        */
+        void addSampleDuration( unsigned long durationUs )
+        {
+            addSample( mLastTime + durationUs );
+        }
+
         void reset( unsigned long timeMs )
         {
             mNextFrame   = 0;
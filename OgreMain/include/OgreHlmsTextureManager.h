@@ -31,6 +31,9 @@ THE SOFTWARE.
 #include "OgreTexture.h"
 #include "OgreIdString.h"
 #include "OgreStringVector.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreWaitableEvent.h"
 #include "OgreHeaderPrefix.h"
 
 namespace Ogre
@@ -150,6 +153,43 @@ namespace Ogre
 
         typedef map<IdString, MetadataCacheEntry>::type MetadataCacheMap;
 
+        struct TextureLocation
+        {
+            TexturePtr  texture;
+            uint16      xIdx;
+            uint16      yIdx;
+            uint16      divisor;
+        };
+
+        /** Listener for textures requested via createOrRetrieveTextureStreamed.
+            All calls happen from the main thread, inside _updateStreaming, once it's done
+            updating its internal state. Listeners may thus create, retrieve or destroy
+            textures (streamed or not) from within these calls.
+        */
+        class _OgreExport StreamingListener
+        {
+        public:
+            virtual ~StreamingListener() {}
+
+            /** Called when a better version of a streamed texture becomes available.
+                Whatever was using the previous location must switch to the new one, as
+                the previous one may be reused by other textures after this call returns.
+            @param aliasName
+                Alias of the texture, as passed to createOrRetrieveTextureStreamed.
+            @param texLocation
+                New location to bind.
+            @param isFinal
+                True when this is the full resolution version. No more calls will follow.
+                False when it's the low resolution preview.
+            */
+            virtual void streamedTextureChanged( IdString aliasName,
+                                                 const TextureLocation &texLocation,
+                                                 bool isFinal ) = 0;
+
+            /// Called when the texture failed to load. The blank texture should keep being used.
+            virtual void streamedTextureFailed( IdString aliasName ) {}
+        };
+
     protected:
         struct TextureArray
         {
@@ -191,6 +231,67 @@ namespace Ogre
             void destroyEntry( uint16 entry );
         };
 
+        /// A texture requested via createOrRetrieveTextureStreamed that is still in flight
+        struct StreamedTexture
+        {
+            typedef vector<StreamingListener*>::type StreamingListenerVec;
+
+            String          aliasName;
+            String          texName;
+            TextureMapType  mapType;
+            uint32          uniqueSpecialId;
+            StreamingListenerVec listeners;
+            /// Number of pixels the texture covers on screen. See setTextureScreenCoverage
+            Real            screenCoverage;
+
+            /// Owned by the worker threads until the texture is decoded
+            DataStreamPtr   stream;
+            Image           *image;
+            bool            hwGammaCorrection;
+            bool            generateMipmaps;
+            bool            failed;
+            String          errorDescription;
+            /// The texture was destroyed while being decoded. Main thread only.
+            bool            cancelled;
+
+            /// Alias of the low resolution version. Empty if there's none.
+            String          previewAliasName;
+            uint32          previewNumPixels;
+
+            /// Where the mips are being uploaded to. Null while decoding, or when
+            /// the texture could not be uploaded incrementally.
+            TexturePtr      texture;
+            uint16          entryIdx;
+            uint8           srcBaseMip;
+            bool            isNormalMap;
+            /// The mips in range [0; nextMip) are yet to be uploaded
+            uint8           nextMip;
+
+            StreamedTexture();
+        };
+
+        typedef vector<StreamedTexture*>::type StreamedTextureVec;
+        typedef deque<StreamedTexture*>::type StreamedTextureDeque;
+        typedef map<IdString, StreamedTexture*>::type StreamedTextureMap;
+
+        /// A listener call postponed until _updateStreaming is done touching its containers
+        struct StreamingNotification
+        {
+            enum Type
+            {
+                Preview,
+                Final,
+                Failed
+            };
+
+            String          aliasName;
+            StreamedTexture::StreamingListenerVec listeners;
+            TextureLocation location;
+            Type            type;
+        };
+
+        typedef vector<StreamingNotification>::type StreamingNotificationVec;
+
         struct TextureEntry
         {
             IdString        name;
@@ -224,6 +325,30 @@ namespace Ogre
 
         TexturePtr mBlankTexture;
 
+        /// All textures being streamed, whatever their stage. Main thread only.
+        StreamedTextureMap  mStreamedTextures;
+        /// Textures waiting to be decoded. Protected by mStreamingMutex.
+        StreamedTextureDeque mStreamingDecodeQueue;
+        /// Textures already decoded, waiting for the main thread. Protected by mStreamingMutex.
+        StreamedTextureVec  mStreamingDecoded;
+        /// Textures whose mips are being uploaded. Main thread only.
+        StreamedTextureVec  mStreamingUploads;
+        LightweightMutex    mStreamingMutex;
+        /// Persistent worker threads. They sleep on mStreamingWorkerEvent while there's
+        /// nothing to decode.
+        ThreadHandleVec     mStreamingThreads;
+        /// Tells the worker threads to exit. Protected by mStreamingMutex.
+        bool                mStopStreamingThreads;
+        WaitableEvent       mStreamingWorkerEvent;
+        /// Woken by the worker threads every time a texture gets decoded.
+        WaitableEvent       mStreamingDecodedEvent;
+        uint32              mNumStreamingThreads;
+        size_t              mStreamingUploadBudget;
+        uint32              mStreamingPreviewResolution;
+
+        /// Uploads a single mip to the given slice of a texture array.
+        static void copyMipToArray( const Image &srcImage, TexturePtr dst, uint16 entryIdx,
+                                    uint8 srcBaseMip, uint8 mip, bool isNormalMap );
         static void copyTextureToArray( const Image &srcImage, TexturePtr dst, uint16 entryIdx,
                                         uint8 srcBaseMip, bool isNormalMap );
         static void copyTextureToAtlas( const Image &srcImage, TexturePtr dst,
@@ -243,6 +368,42 @@ namespace Ogre
         bool getTexturePackParameters( const HlmsTexturePack &pack, uint32 &outWidth, uint32 &outHeight,
                                        uint32 &outDepth, PixelFormat &outPixelFormat ) const;
 
+        /** See createOrRetrieveTexture.
+        @param deferredUpload
+            When not null and the texture goes into a texture array slice, the mips aren't
+            copied; instead deferredUpload is filled so they can be uploaded later.
+        */
+        TextureLocation createOrRetrieveTextureImpl( const String &aliasName,
+                                                     const String &texName,
+                                                     TextureMapType mapType,
+                                                     uint32 uniqueSpecialId,
+                                                     Image *imgSource,
+                                                     StreamedTexture *deferredUpload );
+
+        /// Called once a streamed texture is decoded. Creates its preview and its final
+        /// texture entry. Returns false if it's already fully uploaded (or failed).
+        bool prepareStreamedTextureUpload( StreamedTexture *streamed,
+                                           StreamingNotificationVec &outNotifications );
+        /** Uploads the pending mips of a streamed texture, coarsest first.
+        @param bytesLeft [in/out]
+            Upload budget. Ignored if null, in which case all pending mips are uploaded.
+        @param uploadedAnything [in/out]
+            Whether something was uploaded this frame. The first mip of the frame is
+            uploaded even if it exceeds the budget.
+        */
+        void uploadStreamedMips( StreamedTexture *streamed, size_t *bytesLeft,
+                                 bool &uploadedAnything );
+        /// Queues the listener notification, destroys the preview and frees the
+        /// streamed texture. finalLocation is null when the texture failed to load.
+        void finishStreamedTexture( StreamedTexture *streamed, const TextureLocation *finalLocation,
+                                    StreamingNotificationVec &outNotifications );
+        void fireStreamingNotifications( const StreamingNotificationVec &notifications );
+        static bool orderByScreenCoverage( const StreamedTexture *a, const StreamedTexture *b );
+        void launchStreamingThreads(void);
+        /// Blocks until the worker threads are finished. Textures still waiting to be
+        /// decoded stay in the queue, and are picked up once the threads are launched again.
+        void stopStreamingThreads(void);
+
     public:
         HlmsTextureManager();
         virtual ~HlmsTextureManager();
@@ -275,14 +436,6 @@ namespace Ogre
                                   bool isNormalMap, bool hwGammaCorrection );
         bool hasPoolId( uint32 uniqueSpecialId, TextureMapType mapType ) const;
 
-        struct TextureLocation
-        {
-            TexturePtr  texture;
-            uint16      xIdx;
-            uint16      yIdx;
-            uint16      divisor;
-        };
-
         /** Create a texture based on its name. If a texture with such name has already been
             created, retrieves the existing one.
         @param texName
@@ -328,9 +481,80 @@ namespace Ogre
                                                  uint32 uniqueSpecialId = 0,
                                                  Image *imgSource = 0 );
 
+        /** Same as createOrRetrieveTexture, but the texture is decoded by background threads
+            and its mips are uploaded over several frames. See setStreamingUploadBudget.
+        @remarks
+            If the texture is already loaded, its location is returned and the listener
+            won't be called.
+            Otherwise the blank texture is returned. Once decoded, the listener gets a
+            low resolution preview (see setStreamingPreviewResolution); then the full
+            resolution version once all its mips are uploaded.
+            The mips are uploaded from the coarsest to the finest. Textures covering more
+            pixels on screen are uploaded first; see setTextureScreenCoverage.
+            The slice is only handed out once all its mips are in. Retrieving the texture
+            through createOrRetrieveTexture while its mips are still being uploaded
+            uploads the rest right away.
+        @param listener
+            Listener to notify. Must stay alive until notified with isFinal = true,
+            streamedTextureFailed is called, or the texture is destroyed.
+        */
+        TextureLocation createOrRetrieveTextureStreamed( const String &aliasName,
+                                                         const String &texName,
+                                                         TextureMapType mapType,
+                                                         StreamingListener *listener,
+                                                         uint32 uniqueSpecialId = 0 );
+
+        /** Tells how many pixels a streamed texture covers on screen, e.g. the projected
+            area of the objects using it, in pixels.
+        @remarks
+            Textures with larger coverage are uploaded first. Textures whose coverage
+            is not bigger than their preview stay with the preview (their full resolution
+            mips are not uploaded) until their coverage grows.
+            By default coverage is unknown, which is treated as infinite.
+            Does nothing if the texture is not being streamed.
+        */
+        void setTextureScreenCoverage( IdString aliasName, Real numPixels );
+
+        /// Maximum number of bytes uploaded to GPU per frame by the streaming path.
+        /// At least one mip is uploaded per frame even if it's bigger than the budget.
+        void setStreamingUploadBudget( size_t bytesPerFrame );
+        size_t getStreamingUploadBudget(void) const         { return mStreamingUploadBudget; }
+
+        /// Number of background threads decoding streamed textures. 0 means one per
+        /// logical core. Default is 1. The threads are created the first time a texture
+        /// is streamed and then sleep while there's nothing to decode. Changing the count
+        /// stops them; they get relaunched with the new count when needed.
+        void setNumStreamingThreads( uint32 numThreads );
+        uint32 getNumStreamingThreads(void) const           { return mNumStreamingThreads; }
+
+        /// Maximum width & height of the low resolution preview of a streamed texture.
+        /// 0 disables the previews.
+        void setStreamingPreviewResolution( uint32 resolution );
+        uint32 getStreamingPreviewResolution(void) const    { return mStreamingPreviewResolution; }
+
+        /// Number of textures that are still being decoded or uploaded
+        size_t getNumStreamingTextures(void) const          { return mStreamedTextures.size(); }
+
+        /** Collects the decoded textures and uploads their mips within the budget.
+            Called once per frame by Root. Main thread only.
+        @param ignoreBudget
+            When true, everything that has been decoded is fully uploaded, regardless
+            of budget and screen coverage.
+        */
+        void _updateStreaming( bool ignoreBudget = false );
+
+        /// Decodes queued textures until told to stop. Runs from the worker threads.
+        void _streamingThreadMain(void);
+
+        /// Blocks until all streamed textures have been decoded and fully uploaded.
+        /// Useful for loading screens.
+        void waitForStreamingTextures(void);
+
         /// Destroys a texture. If the array has multiple entries, the entry for this texture is
         /// sent back to a waiting list for a future new entry. Trying to read from this texture
         /// after this call may result in garbage.
+        /// If the texture is being streamed, streaming is cancelled and its listeners won't
+        /// be called anymore.
         void destroyTexture( IdString aliasName );
 
         /// Finds the alias name of a texture given its TextureLocation. Useful for retrieving
@@ -485,10 +485,16 @@ namespace Ogre {
             True if the filter should be applied in linear space.
         @param filter
             The type of filter to use.
+        @param numThreads
+            Number of threads to use, including the calling one. Each mip is split in
+            row bands (cubemap faces are split together). 0 means one per logical core.
+            Small images may use fewer threads than requested. The result is the same
+            regardless of the number of threads.
         @return
             False if failed to generate and mipmaps properties won't be changed. True on success.
         */
-        bool generateMipmaps( bool gammaCorrected, Filter filter = FILTER_BILINEAR );
+        bool generateMipmaps( bool gammaCorrected, Filter filter = FILTER_BILINEAR,
+                              uint32 numThreads = 1u );
         
         /// Static function to calculate size in bytes from the number of mipmaps, faces and the dimensions
         static size_t calculateSize(size_t mipmaps, size_t faces, uint32 width, uint32 height, uint32 depth, PixelFormat format);
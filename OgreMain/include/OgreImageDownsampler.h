@@ -28,6 +28,8 @@ THE SOFTWARE.
 #ifndef _OgreImageDownsampler_H_
 #define _OgreImageDownsampler_H_
 
+#include "OgrePlatformInformation.h"
+
 namespace Ogre
 {
     /** \addtogroup Core
@@ -46,13 +48,19 @@ namespace Ogre
     @param kernelEndX
     @param kernelStartY
     @param kernelEndY
+    @param dstRowStart
+        First destination row to process.
+    @param dstRowEnd
+        Last destination row to process (exclusive). dstPtr & srcPtr always point to the
+        beginning of the image; the row range allows splitting the work across threads.
      */
     typedef void (ImageDownsampler2D)( uint8 *dstPtr, uint8 const *srcPtr,
                                        int32 dstWidth, int32 dstHeight,
                                        int32 srcWidth,
                                        const uint8 kernel[5][5],
                                        const int8 kernelStartX, const int8 kernelEndX,
-                                       const int8 kernelStartY, const int8 kernelEndY );
+                                       const int8 kernelStartY, const int8 kernelEndY,
+                                       int32 dstRowStart, int32 dstRowEnd );
 
     ImageDownsampler2D downscale2x_XXXA8888;
     ImageDownsampler2D downscale2x_XXX888;
@@ -71,7 +79,8 @@ namespace Ogre
                                        const uint8 kernel[5][5],
                                        const int8 kernelStartX, const int8 kernelEndX,
                                        const int8 kernelStartY, const int8 kernelEndY,
-                                       uint8 currentFace );
+                                       uint8 currentFace,
+                                       int32 dstRowStart, int32 dstRowEnd );
 
     ImageDownsamplerCube downscale2x_XXXA8888_cube;
     ImageDownsamplerCube downscale2x_XXX888_cube;
@@ -90,11 +99,20 @@ namespace Ogre
     @param kernel
     @param kernelStart
     @param kernelEnd
+    @param rowStart
+        First row to process.
+    @param rowEnd
+        Last row to process (exclusive).
+    @param horizontalPass
+        When true, blurs horizontally from _srcDstPtr into _tmpPtr. When false, blurs
+        vertically from _tmpPtr back into _srcDstPtr. A full blur is a horizontal pass
+        over all rows followed by a vertical pass over all rows.
      */
     typedef void (ImageBlur2D)( uint8 *_tmpPtr, uint8 *_srcDstPtr,
                                 int32 width, int32 height,
                                 const uint8 kernel[5],
-                                const int8 kernelStart, const int8 kernelEnd );
+                                const int8 kernelStart, const int8 kernelEnd,
+                                int32 rowStart, int32 rowEnd, bool horizontalPass );
 
     ImageBlur2D separableBlur_XXXA8888;
     ImageBlur2D separableBlur_XXX888;
@@ -171,6 +189,34 @@ namespace Ogre
     ImageBlur2D separableBlur_Float32_A;
     ImageBlur2D separableBlur_Float32_XA;
 
+    //-----------------------------------------------------------------------------------
+    //Float16 versions
+    //-----------------------------------------------------------------------------------
+
+
+    ImageDownsampler2D downscale2x_Float16_XXXA;
+    ImageDownsampler2D downscale2x_Float16_XXX;
+    ImageDownsampler2D downscale2x_Float16_XX;
+    ImageDownsampler2D downscale2x_Float16_X;
+
+    //
+    //  CUBEMAP Float16 versions
+    //
+
+    ImageDownsamplerCube downscale2x_Float16_XXXA_cube;
+    ImageDownsamplerCube downscale2x_Float16_XXX_cube;
+    ImageDownsamplerCube downscale2x_Float16_XX_cube;
+    ImageDownsamplerCube downscale2x_Float16_X_cube;
+
+    //
+    //  Blur Float16 versions
+    //
+
+    ImageBlur2D separableBlur_Float16_XXXA;
+    ImageBlur2D separableBlur_Float16_XXX;
+    ImageBlur2D separableBlur_Float16_XX;
+    ImageBlur2D separableBlur_Float16_X;
+
     //-----------------------------------------------------------------------------------
     //sRGB versions
     //-----------------------------------------------------------------------------------
@@ -211,6 +257,19 @@ namespace Ogre
     ImageBlur2D separableBlur_sRGB_XA88;
     ImageBlur2D separableBlur_sRGB_AX88;
 
+#if __OGRE_HAVE_SSE
+    //-----------------------------------------------------------------------------------
+    //SSE2 versions
+    //-----------------------------------------------------------------------------------
+
+    /// Same as the scalar versions and produce bit-identical results, but all channels
+    /// of a pixel are filtered at once.
+    ImageDownsampler2D downscale2x_XXXA8888_SSE2;
+    ImageDownsampler2D downscale2x_Float32_XXXA_SSE2;
+    ImageBlur2D separableBlur_XXXA8888_SSE2;
+    ImageBlur2D separableBlur_Float32_XXXA_SSE2;
+#endif
+
     struct FilterKernel
     {
         uint8   kernel[5][5];
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 #include "OgreAxisAlignedBox.h"
 #include "OgreSphere.h"
+#include "OgrePlane.h"
 #include "OgreAnimable.h"
 #include "OgreSceneNode.h"
 #include "Math/Array/OgreObjectData.h"
@@ -46,6 +47,31 @@ namespace Ogre {
 
     // Forward declaration
     class MovableObjectFactory;
+    class CompositorPass;
+
+    /** One of the frustums culled at once by SceneManager::_cullFrustumsBatched.
+        All variables are read-only for the worker threads.
+    */
+    struct BatchedCullFrustum
+    {
+        /// Pass that will consume the results.
+        CompositorPass const    *pass;
+        /// Camera that will be passed to SceneManager::_cullPhase01
+        Camera const            *camera;
+        /// LOD camera that will be passed to SceneManager::_cullPhase01
+        Camera const            *lodCamera;
+        /// First RenderQueue ID to render (inclusive)
+        uint8                   firstRq;
+        /// Last RenderQueue ID to render (exclusive)
+        uint8                   lastRq;
+        /// Visibility mask of the viewport (as in Viewport::getVisibilityMask)
+        uint32                  visibilityMask;
+        /// World space planes of the frustum (may differ from the camera's current
+        /// ones, i.e. when the pass will reorient it to render to a cubemap face)
+        Plane                   planes[6];
+    };
+
+    typedef vector<BatchedCullFrustum>::type BatchedCullFrustumVec;
 
     /** \addtogroup Core
     *  @{
@@ -304,6 +330,36 @@ namespace Ogre {
         static void calculateCastersBox( const size_t numNodes, ObjectData t,
                                          uint32 sceneVisibilityFlags, AxisAlignedBox *outBox );
 
+        /** @See cullFrustum. Culls the objects against multiple frustums, loading each
+            block of objects only once.
+        @remarks
+            Unlike cullFrustum, it doesn't calculate the distance to the camera, since
+            there is more than one camera.
+        @param numFrustums
+            Number of elements in frustums, sceneVisibilityFlags & outCulledObjects.
+        @param frustums
+            Array of frustums to test against.
+        @param sceneVisibilityFlags
+            Combined scene & viewport visibility flags of each frustum.
+        @param outCulledObjects
+            Visible objects of each frustum are appended to outCulledObjects[i].
+        @param casterPass
+            True if these are shadow caster passes.
+        */
+        static void cullFrustums( const size_t numNodes, ObjectData t, const size_t numFrustums,
+                                  BatchedCullFrustum const * const *frustums,
+                                  const uint32 *sceneVisibilityFlags,
+                                  MovableObjectArray * const *outCulledObjects,
+                                  bool casterPass );
+
+        /** Returns true as soon as one visible shadow caster is found at least partially
+            inside the volume enclosed by the given 6 planes (i.e. a frustum).
+        @remarks
+            We don't pass ObjectData by reference on purpose (avoid implicit aliasing)
+        */
+        static bool hasCastersInVolume( const size_t numNodes, ObjectData t,
+                                        uint32 sceneVisibilityFlags, const Plane planes[6] );
+
         friend void LodStrategy::lodUpdateImpl( const size_t numNodes, ObjectData t,
                                                 const Camera *camera, Real bias ) const;
         friend void LodStrategy::lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS] );
@@ -494,6 +550,9 @@ namespace Ogre {
         /// Returns the distance to camera as calculated in @cullFrustum
         inline Real getCachedDistanceToCameraAsReal(void) const;
 
+        /// Overrides the distance to camera calculated in @cullFrustum
+        inline void _setCachedDistanceToCamera( Real distance );
+
         /** Sets the visibility flags for this object.
         @remarks
             As well as a simple true/false value for visibility (as seen in setVisible), 
@@ -103,6 +103,9 @@ namespace Ogre {
             This is where the affector gets the chance to apply it's effects to the particles of a system.
             The affector is expected to apply it's effect to some or all of the particles in the system
             passed to it, depending on the affector's approach.
+        @par
+            Affectors implementing the batch version below can just forward to it with
+            ParticleSystem::_getActiveParticles.
         @param
             pSystem Pointer to a ParticleSystem to affect.
         @param
@@ -110,6 +113,28 @@ namespace Ogre {
         */
         virtual void _affectParticles(ParticleSystem* pSystem, Real timeElapsed) = 0;
 
+        /** Batch version of _affectParticles, which applies the affector to a contiguous
+            range of particles.
+        @remarks
+            This is the preferred entry point for new affectors: hoist everything that doesn't
+            depend on the particle out of the loop, write the Particle members directly
+            and notify the system once per batch (e.g. ParticleSystem::_notifyParticleResized)
+            instead of once per particle.
+        @par
+            Optional. The default implementation raises an exception, as it can't be
+            expressed in terms of the per system version.
+        @param pSystem
+            ParticleSystem owning the particles.
+        @param particles
+            Array of numParticles particles, usually from ParticleSystem::_getActiveParticles.
+        @param numParticles
+            Number of particles in the array.
+        @param timeElapsed
+            The number of seconds which have elapsed since the last call.
+        */
+        virtual void _affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                                       size_t numParticles, Real timeElapsed );
+
         /** Returns the name of the type of affector. 
         @remarks
             This property is useful for determining the type of affector procedurally so another
@@ -41,17 +41,22 @@ namespace Ogre {
     *  @{
     */
     /** Convenience class to make it easy to step through all particles in a ParticleSystem.
+    @remarks
+        The particles are now stored in a vector<Particle*>::type instead of a
+        list<Particle*>::type; code that only uses end() & getNext() is unaffected.
+        The iterator is invalidated when particles are emitted or expire, and
+        the order of the particles isn't stable across updates.
     */
     class _OgreExport ParticleIterator
     {
         friend class ParticleSystem;
     protected:
-        list<Particle*>::type::iterator mPos;
-        list<Particle*>::type::iterator mStart;
-        list<Particle*>::type::iterator mEnd;
+        vector<Particle*>::type::iterator mPos;
+        vector<Particle*>::type::iterator mStart;
+        vector<Particle*>::type::iterator mEnd;
 
         /// Protected constructor, only available from ParticleSystem::getIterator
-        ParticleIterator(list<Particle*>::type::iterator start, list<Particle*>::type::iterator end);
+        ParticleIterator(vector<Particle*>::type::iterator start, vector<Particle*>::type::iterator end);
 
     public:
         /// Returns true when at the end of the particle list
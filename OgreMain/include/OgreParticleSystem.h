@@ -346,6 +346,48 @@ namespace Ogre {
         */
         void _update(Real timeElapsed);
 
+        /** Queues time to be simulated during the SceneManager's particle update phase.
+        @remarks
+            This is called automatically every frame by OGRE (through the time controller).
+            The system registers itself with its SceneManager the first time it's called
+            in a frame; the actual simulation happens later from a worker thread, once all
+            node transforms are up to date (see SceneManager::updateSceneGraph).
+        @param
+            timeElapsed The amount of time, in seconds, since the last frame.
+        */
+        void _addPendingUpdateTime( Real timeElapsed );
+
+        /** Prepares the system for _updateThreaded. Must be called from the main thread.
+        @remarks
+            Performs the work that can't be done from a worker thread (configuring
+            the renderer, initialising emitted emitters) and decides whether the
+            system needs to be updated at all (see setNonVisibleUpdateTimeout).
+        @return
+            True if _updateThreaded must be called.
+        */
+        bool _prepareThreadedUpdate(void);
+
+        /** Simulates the time queued by _addPendingUpdateTime.
+        @remarks
+            Safe to call from a worker thread, as long as no other thread touches this
+            system and the parent node's derived transform is up to date. Emitters and
+            affectors of different systems may run concurrently, so they must not share
+            mutable state; use _getUnitRandom & co. instead of Math::UnitRandom.
+        @par
+            Each queued time step is simulated on its own, as if _update had been
+            called once per step; so time queued while the SceneManager didn't update
+            (e.g. it wasn't rendered for a few frames) doesn't burst into a single step.
+        */
+        void _updateThreaded(void);
+
+        /** Generates the geometry deferred by ParticleSystemRenderer::_updateRenderQueueDeferred.
+            May be called from a worker thread. @see SceneManager::_addParticleGeometryRequest
+        */
+        void _generateGeometry( const Camera *camera );
+
+        /** Called from the main thread after _generateGeometry. */
+        void _finishGeometry(void);
+
         /** Returns an iterator for stepping through all particles in this system.
         @remarks
             This method is designed to be used by people providing new ParticleAffector subclasses,
@@ -354,6 +396,18 @@ namespace Ogre {
         */
         ParticleIterator _getIterator(void);
 
+        /** Returns the active particles as a contiguous array of getNumParticles() pointers.
+        @remarks
+            Preferred over _getIterator by affectors that process particles in batches
+            (see ParticleAffector::_affectParticles). The array is only valid until
+            particles are emitted, expired or cleared; and its order is not preserved
+            across updates.
+        */
+        Particle * const * _getActiveParticles(void) const
+        {
+            return mActiveParticles.empty() ? 0 : &mActiveParticles[0];
+        }
+
         /** Sets the name of the material to be used for this billboard set.
             @param
                 name The new name of the material to use for this set.
@@ -405,6 +459,33 @@ namespace Ogre {
         */
         Real getSpeedFactor(void) const { return mSpeedFactor; }
 
+        /** Seeds the random number generator used by this system's emitters and affectors.
+        @remarks
+            Every particle system has its own generator so that systems can be updated
+            concurrently. By default it's seeded from Math::UnitRandom on creation.
+        @param seed
+            Any value. Systems seeded with the same value and updated with the same
+            time steps emit the same particles.
+        */
+        void setRandomSeed( uint32 seed );
+
+        /** Returns a random number in the range [0;1]. Meant for emitters and affectors.
+            Unlike Math::UnitRandom, it's safe to call while other systems are being updated.
+        */
+        Real _getUnitRandom(void);
+
+        /// Returns a random number in the range [fLow;fHigh]. @see _getUnitRandom
+        Real _getRangeRandom( Real fLow, Real fHigh )
+        {
+            return (fHigh - fLow) * _getUnitRandom() + fLow;
+        }
+
+        /// Returns a random number in the range [-1;1]. @see _getUnitRandom
+        Real _getSymmetricRandom(void)
+        {
+            return 2.0f * _getUnitRandom() - 1.0f;
+        }
+
         /** Sets a 'iteration interval' on this particle system.
         @remarks
             The default Particle system update interval, based on elapsed frame time,
@@ -661,15 +742,31 @@ namespace Ogre {
         unsigned long mLastVisibleFrame;
         /// Controller for time update
         Controller<Real>* mTimeController;
+        /// Time steps queued by the controller, to be simulated in the SceneManager's update phase
+        vector<Real>::type mPendingUpdateTimes;
+        /// Whether we're registered in the SceneManager's list of systems to update
+        bool mPendingUpdate;
+        /// State of the random number generator. @see _getUnitRandom
+        uint32 mRandomState;
         /// Indication whether the emitted emitter pool (= pool with particle emitters that are emitted) is initialised
         bool mEmittedEmitterPoolInitialised;
         /// Used to control if the particle system should emit particles or not.
         bool mIsEmitting;
 
-        typedef list<Particle*>::type ActiveParticleList;
-        typedef list<Particle*>::type FreeParticleList;
+        typedef vector<Particle*>::type ActiveParticleList;
+        typedef vector<Particle*>::type FreeParticleList;
         typedef vector<Particle*>::type ParticlePool;
 
+        struct ParticleBlock
+        {
+            Particle    *particles;
+            size_t      numParticles;
+
+            ParticleBlock( Particle *_particles, size_t _numParticles ) :
+                particles( _particles ), numParticles( _numParticles ) {}
+        };
+        typedef vector<ParticleBlock>::type ParticleBlockVec;
+
         /** Sort by direction functor */
         struct SortByDirectionFunctor
         {
@@ -694,23 +791,22 @@ namespace Ogre {
 
         /** Active particle list.
             @remarks
-                This is a linked list of pointers to particles in the particle pool.
+                This is a contiguous array of pointers to particles in the particle pool,
+                so that updates walk memory linearly instead of chasing list nodes.
             @par
-                This allows very fast insertions and deletions from anywhere in 
-                the list to activate / deactivate particles as well as reuse of 
-                Particle instances in the pool without construction & destruction 
-                which avoids memory thrashing.
+                Particles are appended when emitted and swap-removed when they expire
+                (the last one takes the place of the expired one), so both operations
+                are O(1) but the order of the particles is not stable.
         */
         ActiveParticleList mActiveParticles;
 
-        /** Free particle queue.
+        /** Free particle stack.
             @remarks
-                This contains a list of the particles free for use as new instances
-                as required by the set. Particle instances are preconstructed up 
-                to the estimated size in the mParticlePool vector and are 
-                referenced on this deque at startup. As they get used this list
-                reduces, as they get released back to to the set they get added
-                back to the list.
+                This contains the particles free for use as new instances as required by
+                the set. Particle instances are preconstructed up to the estimated size in
+                the mParticlePool vector and are pushed here at startup. As they get used
+                this stack shrinks, as they get released back to the set they get pushed
+                back.
         */
         FreeParticleList mFreeParticles;
 
@@ -720,6 +816,9 @@ namespace Ogre {
         */
         ParticlePool mParticlePool;
 
+        /// Particles are constructed in blocks (one per pool growth) to keep them contiguous.
+        ParticleBlockVec mParticleBlocks;
+
         typedef list<ParticleEmitter*>::type FreeEmittedEmitterList;
         typedef list<ParticleEmitter*>::type ActiveEmittedEmitterList;
         typedef vector<ParticleEmitter*>::type EmittedEmitterList;
@@ -775,11 +874,32 @@ namespace Ogre {
         /// Optional origin of this particle system (eg script name)
         String mOrigin;
 
+        /// Emission requests per emitter, used by _triggerEmitters
+        vector<unsigned>::type mEmitterRequests;
+        /// Emission requests per active emitted emitter, used by _triggerEmitters
+        vector<unsigned>::type mEmittedEmitterRequests;
+
         /// Default iteration interval
         static Real msDefaultIterationInterval;
         /// Default nonvisible update timeout
         static Real msDefaultNonvisibleTimeout;
 
+        /** Handles the nonvisible timeout and the speed factor, and performs the
+            main thread only setup.
+        @param timeElapsed [in/out]
+            Time since the last update. On output, scaled by the speed factor.
+        @return
+            False if the system must not be updated.
+        */
+        bool prepareUpdate( Real &timeElapsed );
+
+        /** Simulates the particles. Assumes prepareUpdate returned true and
+            the parent node's derived transform is up to date. */
+        void updateImpl( Real timeElapsed );
+
+        /// @see _updateBounds. Doesn't update the parent node's derived transform.
+        void updateBoundsImpl(void);
+
         /** Internal method used to expire dead particles. */
         void _expire(Real timeElapsed);
 
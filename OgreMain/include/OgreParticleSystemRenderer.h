@@ -63,11 +63,51 @@ namespace Ogre {
         @remarks
             The subclass must update the render queue using whichever Renderable
             instance(s) it wishes.
+        @note
+            currentParticles used to be a list<Particle*>::type. Renderers written
+            against the list must update the signature of their override, and must
+            not rely on the order of the particles, which isn't stable across updates.
         */
         virtual void _updateRenderQueue(RenderQueue* queue, Camera *camera,
-            const Camera *lodCamera, list<Particle*>::type& currentParticles,
+            const Camera *lodCamera, vector<Particle*>::type& currentParticles,
             bool cullIndividually, RenderableArray &outRenderables ) = 0;
 
+        /** Same as _updateRenderQueue, but allows the renderer to defer generating
+            its geometry so that it can be done from a worker thread.
+        @remarks
+            Called from the main thread. Anything that touches the render system
+            (i.e. locking buffers) must be done here; the vertex buffer range the
+            particles will be written to must be reserved (locked) before returning.
+        @par
+            The default implementation just calls _updateRenderQueue and returns false.
+        @return
+            True if the geometry was deferred. The SceneManager will then call
+            _generateGeometry (possibly from a worker thread) and _finishGeometry
+            (from the main thread) before anything gets rendered.
+        */
+        virtual bool _updateRenderQueueDeferred( RenderQueue *queue, Camera *camera,
+                                                 const Camera *lodCamera,
+                                                 vector<Particle*>::type &currentParticles,
+                                                 bool cullIndividually,
+                                                 RenderableArray &outRenderables )
+        {
+            _updateRenderQueue( queue, camera, lodCamera, currentParticles,
+                                cullIndividually, outRenderables );
+            return false;
+        }
+
+        /** Writes the vertices for the given particles into the range reserved by
+            _updateRenderQueueDeferred. May be called from a worker thread, thus it must
+            only touch data owned by this renderer.
+        */
+        virtual void _generateGeometry( const Camera *camera,
+                                        const vector<Particle*>::type &currentParticles ) {}
+
+        /** Called from the main thread after _generateGeometry, to release what was
+            reserved by _updateRenderQueueDeferred (i.e. unlock buffers).
+        */
+        virtual void _finishGeometry(void) {}
+
         /** Sets the HLMS material this renderer must use; called by ParticleSystem. */
         virtual void _setDatablock( HlmsDatablock *datablock ) = 0;
         /** Sets the material this renderer must use; called by ParticleSystem. */
@@ -89,9 +129,9 @@ namespace Ogre {
         /** Optional callback notified when particle expired */
         virtual void _notifyParticleExpired(Particle* particle) {}
         /** Optional callback notified when particles moved */
-        virtual void _notifyParticleMoved(list<Particle*>::type& currentParticles) {}
+        virtual void _notifyParticleMoved(vector<Particle*>::type& currentParticles) {}
         /** Optional callback notified when particles cleared */
-        virtual void _notifyParticleCleared(list<Particle*>::type& currentParticles) {}
+        virtual void _notifyParticleCleared(vector<Particle*>::type& currentParticles) {}
         /** Create a new ParticleVisualData instance for attachment to a particle.
         @remarks
             If this renderer needs additional data in each particle, then this should
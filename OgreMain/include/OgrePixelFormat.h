@@ -655,10 +655,42 @@ namespace Ogre {
             from RGB to luminance takes the R channel. 
             @param  src         PixelBox containing the source pixels, pitches and format
             @param  dst         PixelBox containing the destination pixels, pitches and format
+            @param  numThreads  Number of threads to split the conversion in row bands.
+                                The default (1) converts in the calling thread.
+                                0 picks one per core for large boxes and a single
+                                thread (the calling one) for small ones.
             @remarks The source and destination boxes must have the same
             dimensions. In case the source and destination format match, a plain copy is done.
+            @par
+            The most common pairs (RGBA8 <-> BGRA8, RGB8 -> RGBA8, float32 <-> float16,
+            RG8 -> RG16F) have dedicated SIMD converters.
         */
-        static void bulkPixelConversion(const PixelBox &src, const PixelBox &dst);
+        static void bulkPixelConversion( const PixelBox &src, const PixelBox &dst,
+                                         uint32 numThreads = 1u );
+
+        /** Same as bulkPixelConversion, but the colour channels of the source are decoded
+            from sRGB into linear space. Alpha is left untouched.
+            @remarks
+                sRGB is approximated as gamma 2.0, the same approximation the gamma correct
+                mipmap filters use. PF_A8B8G8R8 & PF_A8R8G8B8 -> PF_FLOAT32_RGBA is the fast path.
+            @param  src         PixelBox containing the source pixels, pitches and format
+            @param  dst         PixelBox containing the destination pixels, pitches and format
+            @param  numThreads  See bulkPixelConversion.
+        */
+        static void convertSRGBToLinear( const PixelBox &src, const PixelBox &dst,
+                                         uint32 numThreads = 1u );
+
+        /** Same as bulkPixelConversion, but the colour channels of the source are encoded
+            from linear into sRGB space. Alpha is left untouched.
+            @remarks
+                PF_FLOAT32_RGBA -> PF_A8B8G8R8 & PF_A8R8G8B8 is the fast path.
+                See convertSRGBToLinear.
+            @param  src         PixelBox containing the source pixels, pitches and format
+            @param  dst         PixelBox containing the destination pixels, pitches and format
+            @param  numThreads  See bulkPixelConversion.
+        */
+        static void convertLinearToSRGB( const PixelBox &src, const PixelBox &dst,
+                                         uint32 numThreads = 1u );
 
         /** Converts the input source to either PF_R8G8_SNORM or PF_BYTE_LA.
             dst must be one of either formats.
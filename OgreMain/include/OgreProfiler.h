@@ -48,6 +48,8 @@ Ogre-dependent is in the visualization/logging routines and the use of the Timer
     #include "Remotery.h"
 #elif OGRE_PROFILING == OGRE_PROFILING_INTERNAL_OFFLINE
     #include "OgreOfflineProfiler.h"
+#elif OGRE_PROFILING == OGRE_PROFILING_TRACE
+    #include "OgreTraceProfiler.h"
 #endif
 #include "OgreHeaderPrefix.h"
 
@@ -163,6 +165,42 @@ namespace Ogre
 #   define OgreProfileGpuBeginDynamic( a )
 #   define OgreProfileGpuBeginDynamicHashed( a, hash )
 #   define OgreProfileGpuEnd( a )
+#elif OGRE_PROFILING == OGRE_PROFILING_TRACE
+#   define OgreProfilerUseStableMarkers         true
+#   define OgreProfileL2( a, g, line )          Ogre::TraceProfile _OgreProfileInstance##line( (a), (g) )
+#   define OgreProfileL( a, g, line )           OgreProfileL2( a, g, line )
+#   define OgreProfile( a )                     OgreProfileL( a, Ogre::OGREPROF_USER_DEFAULT, __LINE__ )
+#   if OGRE_PROFILING_EXHAUSTIVE
+#       define OgreProfileExhaustive( a )       OgreProfile( a )
+#       define OgreProfileExhaustiveAggr( a )   OgreProfile( a )
+#   endif
+#   define OgreProfileBegin( a )                OgreProfileBeginGroup( a, Ogre::OGREPROF_USER_DEFAULT )
+#   define OgreProfileBeginDynamic( a )         OgreProfileBegin( a )
+#   define OgreProfileBeginDynamicHashed( a, hash ) OgreProfileBegin( a )
+#   define OgreProfileEnd( a )                  OgreProfileEndGroup( a, Ogre::OGREPROF_USER_DEFAULT )
+#   define OgreProfileGroup( a, g )             OgreProfileL( a, g, __LINE__ )
+#   define OgreProfileGroupAggregate( a, g )    OgreProfileL( a, g, __LINE__ )
+#   define OgreProfileBeginGroup( a, g )                                            \
+    do                                                                              \
+    {                                                                               \
+        Ogre::TraceProfiler *_ogreTraceProfiler = Ogre::TraceProfiler::getSingletonPtr(); \
+        if( _ogreTraceProfiler )                                                    \
+            _ogreTraceProfiler->beginEvent( (a), (g) );                             \
+    } while( 0 )
+#   define OgreProfileEndGroup( a, g )                                              \
+    do                                                                              \
+    {                                                                               \
+        Ogre::TraceProfiler *_ogreTraceProfiler = Ogre::TraceProfiler::getSingletonPtr(); \
+        if( _ogreTraceProfiler )                                                    \
+            _ogreTraceProfiler->endEvent();                                         \
+    } while( 0 )
+#   define OgreProfileBeginGPUEvent( e )
+#   define OgreProfileEndGPUEvent( e )
+#   define OgreProfileMarkGPUEvent( e )
+#   define OgreProfileGpuBegin( a )
+#   define OgreProfileGpuBeginDynamic( a )
+#   define OgreProfileGpuBeginDynamicHashed( a, hash )
+#   define OgreProfileGpuEnd( a )
 #else
 #   define OgreProfilerUseStableMarkers true
 #   define OgreProfileExhaustive( a )
@@ -190,6 +228,15 @@ namespace Ogre
 #   define OgreProfileExhaustiveAggr( a )
 #endif
 
+/// Same as OgreProfile, but safe to use from any thread (i.e. SceneManager worker threads
+/// or background resource loading). The internal profiler isn't thread safe, thus these
+/// are ignored when OGRE_PROFILING == OGRE_PROFILING_INTERNAL.
+#if OGRE_PROFILING && OGRE_PROFILING != OGRE_PROFILING_INTERNAL
+#   define OgreProfileThreaded( a )             OgreProfile( a )
+#else
+#   define OgreProfileThreaded( a )
+#endif
+
 namespace Ogre {
     /** \addtogroup Core
     *  @{
@@ -502,7 +549,13 @@ namespace Ogre {
 
             /** Set the mask which all profiles must pass to be enabled. 
             */
-            void setProfileGroupMask(uint32 mask) { mProfileMask = mask; }
+            void setProfileGroupMask(uint32 mask)
+            {
+                mProfileMask = mask;
+#if OGRE_PROFILING == OGRE_PROFILING_TRACE
+                mTraceProfiler.setProfileGroupMask( mask );
+#endif
+            }
             /** Get the mask which all profiles must pass to be enabled. 
             */
             uint32 getProfileGroupMask() const { return mProfileMask; }
@@ -595,6 +648,8 @@ namespace Ogre {
 
 #if OGRE_PROFILING == OGRE_PROFILING_INTERNAL_OFFLINE
             OfflineProfiler& getOfflineProfiler(void)       { return mOfflineProfiler; }
+#elif OGRE_PROFILING == OGRE_PROFILING_TRACE
+            TraceProfiler& getTraceProfiler(void)           { return mTraceProfiler; }
 #endif
 
         protected:
@@ -618,6 +673,8 @@ namespace Ogre {
 
 #if OGRE_PROFILING == OGRE_PROFILING_INTERNAL_OFFLINE
             OfflineProfiler mOfflineProfiler;
+#elif OGRE_PROFILING == OGRE_PROFILING_TRACE
+            TraceProfiler mTraceProfiler;
 #endif
 
             // lol. Uses typedef; put's original container type in name.
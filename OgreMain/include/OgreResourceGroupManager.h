@@ -306,6 +306,9 @@ namespace Ogre {
 
         ResourceLoadingListener *mLoadingListener;
 
+        /// See setNumScriptParsingThreads
+        size_t mNumScriptParsingThreads;
+
         /// Resource index entry, resourcename->location 
         typedef map<String, Archive*>::type ResourceLocationIndex;
 
@@ -1069,6 +1072,24 @@ namespace Ogre {
         */      
         const LocationList& getResourceLocationList(const String& groupName);
 
+        /** Sets how many threads are used to parse scripts while initialising a group.
+        @remarks
+            When greater than 1, all the scripts of a group are first read by the main
+            thread, then script loaders which support it (e.g. ScriptCompilerManager)
+            lex and parse them in parallel (see ScriptLoader::_preparseScript). The
+            translation step, which creates the resources, runs afterwards on the main
+            thread in the same order as the single threaded path.
+        @par
+            Listeners are notified in the same order as when parsing serially. Since the
+            scripts are read before ResourceGroupListener::scriptParseStarted is fired,
+            skipped scripts are still read from disk.
+        @param numThreads
+            Number of threads, including the calling one. 0 uses one per logical core.
+            Default is 1, i.e. parse serially.
+        */
+        void setNumScriptParsingThreads( size_t numThreads );
+        size_t getNumScriptParsingThreads(void) const       { return mNumScriptParsingThreads; }
+
         /// Sets a new loading listener
         void setLoadingListener(ResourceLoadingListener *listener);
         /// Returns the current loading listener
@@ -476,6 +476,17 @@ namespace Ogre {
         */
         bool                    mStaticEntitiesDirty;
 
+        /// @see getStaticSceneVersion
+        uint32                  mStaticSceneVersion;
+        /// @see setDefragmentationBudget
+        size_t                  mDefragmentationBudget;
+        /// @see setStaticSpatialSorting
+        bool                    mStaticSpatialSorting;
+        /// mStaticSceneVersion at the time static objects were last sorted spatially
+        uint32                  mStaticSpatialSortVersion;
+        /// Number of objects in mEntityMemoryManager[SCENE_STATIC] when we last checked
+        size_t                  mLastNumStaticEntities;
+
         PrePassMode             mPrePassMode;
         TextureVec const        *mPrePassTextures;
         TextureVec const        *mPrePassDepthTexture;
@@ -530,6 +541,22 @@ namespace Ogre {
         typedef vector<v1::InstanceManager*>::type  InstanceManagerVec;
         InstanceManagerVec  mInstanceManagers;
 
+        typedef vector<ParticleSystem*>::type ParticleSystemVec;
+        /// Particle systems with time pending to be simulated. @see updateAllParticleSystems
+        ParticleSystemVec   mParticleSystemsToUpdate;
+
+        struct ParticleGeometryRequest
+        {
+            ParticleSystem  *particleSystem;
+            Camera const    *camera;
+
+            ParticleGeometryRequest( ParticleSystem *_particleSystem, const Camera *_camera ) :
+                particleSystem( _particleSystem ), camera( _camera ) {}
+        };
+        typedef vector<ParticleGeometryRequest>::type ParticleGeometryRequestVec;
+        /// @see generateAllParticleGeometry
+        ParticleGeometryRequestVec mParticleGeometryRequests;
+
         /** Central list of SceneNodes - for easy memory management.
             @note
                 Note that this list is used only for memory management; the structure of the scene
@@ -840,6 +867,22 @@ namespace Ogre {
         /** Updates all instance managers with dirty instance batches. @see _addDirtyInstanceManager */
         void updateInstanceManagers(void);
 
+        /** Simulates a subset of the particle systems in mParticleSystemsToUpdate.
+            @see updateAllParticleSystems */
+        void updateAllParticleSystemsThread( size_t threadIdx );
+
+        /** Updates all particle systems registered via _addParticleSystemToUpdate.
+            Must be called after the transforms have been updated and before the bounds are.
+        */
+        void updateAllParticleSystems(void);
+
+        /** Generates a subset of the geometry requested via _addParticleGeometryRequest.
+            @see generateAllParticleGeometry */
+        void generateAllParticleGeometryThread( size_t threadIdx );
+
+        /// Generates the geometry requested via _addParticleGeometryRequest.
+        void generateAllParticleGeometry(void);
+
         /** Culls the scene in a high level fashion (i.e. Octree, Portal, etc.) by taking into account all
             registered cameras. Produces a list of culled Entities & SceneNodes that must follow a very
             strict set of rules:
@@ -905,6 +948,7 @@ namespace Ogre {
         enum RequestType
         {
             CULL_FRUSTUM,
+            CULL_FRUSTUM_BATCHED,
             UPDATE_ALL_ANIMATIONS,
             UPDATE_ALL_TRANSFORMS,
             UPDATE_ALL_BONE_TO_TAG_TRANSFORMS,
@@ -912,6 +956,8 @@ namespace Ogre {
             UPDATE_ALL_BOUNDS,
             UPDATE_ALL_LODS,
             UPDATE_INSTANCE_MANAGERS,
+            UPDATE_PARTICLE_SYSTEMS,
+            GENERATE_PARTICLE_GEOMETRY,
             CULL_FRUSTUM_INSTANCEDENTS,
             BUILD_LIGHT_LIST01,
             BUILD_LIGHT_LIST02,
@@ -950,6 +996,28 @@ namespace Ogre {
         */
         VisibleObjectsPerThreadArray mTmpVisibleObjects;
 
+        /** Frustums culled together by _cullFrustumsBatched, and their results.
+            Batches form a stack since they can nest (i.e. a shadow node culling all
+            of its shadow maps while the results of several views are pending).
+        */
+        struct BatchedCull
+        {
+            BatchedCullFrustumVec       frustums;
+            bool                        casterPass;
+            /// For each thread, the visible objects of frustum i in render queue j
+            /// are at [i * 255 + j]
+            VisibleObjectsPerThreadArray visibleObjects;
+
+            BatchedCull() : casterPass( false ) {}
+        };
+
+        typedef vector<BatchedCull>::type BatchedCullVec;
+
+        /// Entries [0; mNumBatchedCulls) are active. The rest are kept around
+        /// to reuse their memory. @see _cullFrustumsBatched
+        BatchedCullVec              mBatchedCulls;
+        size_t                      mNumBatchedCulls;
+
         /// Suppress render state changes?
         bool mSuppressRenderStateChanges;
 
@@ -1060,6 +1128,27 @@ namespace Ogre {
         */
         void cullFrustum( const CullFrustumRequest &request, size_t threadIdx );
 
+        /** Culls all objects against all the frustums of the most recent batch at once.
+            @See MovableObject::cullFrustums
+        @param threadIdx
+            Index to BatchedCull::visibleObjects so we know which array we should start at.
+            Must be unique for each worker thread
+        */
+        void cullFrustumsBatched( size_t threadIdx );
+
+        /** Called by _cullPhase01. If the current compositor pass was culled in advance by
+            _cullFrustumsBatched with the same parameters, fills the render queue (and
+            mVisibleObjects) from those results.
+        @return
+            False if there are no matching batched results. The caller must cull normally.
+        */
+        bool consumeBatchedCullResults( const Camera *camera, const Camera *lodCamera,
+                                        uint8 firstRq, uint8 lastRq );
+
+        /// Clamps [firstRq; lastRq) to the render queues that actually contain objects
+        void getRealRqRange( uint8 firstRq, uint8 lastRq,
+                             uint8 &outFirstRq, uint8 &outLastRq ) const;
+
         /** Builds a list of all lights that are visible by all queued cameras (this should be fed by
             Compositor). Then calls MovableObject::buildLightList with that list so that each
             MovableObject gets it's own sorted list of the closest lights.
@@ -1255,6 +1344,61 @@ namespace Ogre {
         */
         virtual void destroySceneNode(SceneNode* sn);
 
+        /** Creates many SceneNodes at once. Same as calling createSceneNode (or
+            parent->createChildSceneNode) numNodes times, but the memory for all of
+            them is reserved up front, so that the SoA pools grow (and get rebased)
+            at most once instead of repeatedly.
+        @param numNodes
+            Number of SceneNodes to create.
+        @param outSceneNodes
+            [out] The created SceneNodes are appended to it.
+        @param parent
+            When not null, the nodes are created as children of it.
+        @param sceneType
+            @see createSceneNode
+        */
+        void createSceneNodes( size_t numNodes, SceneNodeList &outSceneNodes,
+                               SceneNode *parent=0, SceneMemoryMgrTypes sceneType=SCENE_DYNAMIC );
+
+        /** Destroys many SceneNodes at once. Same as calling destroySceneNode on each
+            of them, but much faster when destroying thousands of nodes:
+                * Cleanups of the memory pools are deferred and done at most once at the end.
+                * Children are destroyed before their parents, so that children also being
+                  destroyed don't get moved to the root depth level first.
+                * Nodes are destroyed in reverse memory order, favouring LIFO releases.
+        @param sceneNodes
+            SceneNodes to destroy. Must not contain duplicates.
+        */
+        void destroySceneNodes( const SceneNodeList &sceneNodes );
+
+        /** When a lot of SceneNodes & MovableObjects get destroyed out of order, their memory
+            pools are left with holes that still get traversed by the update & culling
+            kernels, until the pool is compacted all at once (which causes a spike).
+            Setting a budget instead compacts the pools a little every frame.
+        @param maxSlotMovesPerFrame
+            Maximum number of nodes & objects that can be moved per frame (in total) to
+            fill the holes. 0 (the default) compacts all at once whenever too many holes
+            accumulated.
+        */
+        void setDefragmentationBudget( size_t maxSlotMovesPerFrame );
+        size_t getDefragmentationBudget(void) const         { return mDefragmentationBudget; }
+
+        /** Returns the memory (in bytes) wasted by holes in the pools of SceneNodes
+            and MovableObjects, which are still traversed by the update & culling kernels.
+        @see NodeMemoryManager::getWastedMemory
+        */
+        size_t getWastedMemory(void) const;
+
+        /** When enabled, static entities are sorted in memory by their position every
+            time the static scene changes (@see ObjectMemoryManager::sortSpatially),
+            which makes culling large static scenes faster.
+        @remarks
+            Sorting isn't cheap. Don't enable it if static objects get modified
+            (i.e. notifyStaticDirty) very often.
+        */
+        void setStaticSpatialSorting( bool bEnabled );
+        bool getStaticSpatialSorting(void) const            { return mStaticSpatialSorting; }
+
         /** Gets the SceneNode at the root of the scene hierarchy.
             @remarks
                 The entire scene is held as a hierarchy of nodes, which
@@ -1424,6 +1568,25 @@ namespace Ogre {
         /// Removes & destroys an Item from the SceneManager.
         virtual void destroyItem( Item *item );
 
+        /** Creates many Items of the same mesh at once. Same as calling createItem
+            numItems times, but the factory & object collection are looked up once, and
+            the memory for all of them is reserved up front.
+        @param outItems
+            [out] The created Items are appended to it.
+        */
+        void createItems( const String &meshName, const String &groupName, size_t numItems,
+                          vector<Item*>::type &outItems,
+                          SceneMemoryMgrTypes sceneType = SCENE_DYNAMIC );
+
+        /** Destroys many Items at once. Same as calling destroyItem on each of them, but
+            cleanups of the memory pools are deferred and done at most once at the end.
+        @remarks
+            The whole batch is validated first; if it throws, none of them got destroyed.
+        @param items
+            Items to destroy. Must not contain duplicates.
+        */
+        void destroyItems( const vector<Item*>::type &items );
+
         /// Removes & destroys all Items.
         virtual void destroyAllItems(void);
 
@@ -1652,6 +1815,17 @@ namespace Ogre {
         */
         virtual void destroyAllParticleSystems(void);       
 
+        /** Called by ParticleSystem when it has time pending to be simulated.
+            The system will be updated from worker threads in updateSceneGraph. */
+        void _addParticleSystemToUpdate( ParticleSystem *particleSystem );
+        /// Called by ParticleSystem when it's destroyed with time still pending.
+        void _removeParticleSystemToUpdate( ParticleSystem *particleSystem );
+        /** Called by ParticleSystem when its renderer deferred generating the geometry
+            (see ParticleSystemRenderer::_updateRenderQueueDeferred). The geometry is
+            generated from worker threads once all v1 objects have been queued.
+        */
+        void _addParticleGeometryRequest( ParticleSystem *particleSystem, const Camera *camera );
+
         /** Empties the entire scene, inluding all SceneNodes, Entities, Lights, 
             BillboardSets etc. Cameras are not deleted at this stage since
             they are still referenced by viewports, which are not destroyed during
@@ -1949,6 +2123,9 @@ namespace Ogre {
         */
         void updateAllTransforms();
 
+        /// Moves up to mDefragmentationBudget slots to fill the holes in our memory pools.
+        void defragmentMemoryManagers(void);
+
         /** Updates all TagPoints, both TagPoints that are children of bones, and TagPoints that
             are children of other TagPoints.
         @remarks
@@ -1996,6 +2173,28 @@ namespace Ogre {
         virtual void _cullPhase01(Camera* camera, const Camera *lodCamera,
                                   Viewport* vp, uint8 firstRq, uint8 lastRq );
 
+        /** Culls the objects against multiple frustums in one go (using all worker threads
+            once, rather than once per frustum), so that subsequent _cullPhase01 calls
+            from the given passes don't need to cull again.
+        @remarks
+            Used by CompositorShadowNode to cull all of its shadow maps at once, and by
+            CompositorManager2 to cull multiple views at once.
+            When _cullPhase01 is called while executing one of the given passes, the
+            results are used if the camera, LOD camera, visibility mask, render queue
+            range and frustum planes still match. Otherwise culling is performed as usual.
+        @par
+            Every call must be paired with a call to _popBatchedCullFrustums.
+            Calls can be nested.
+        @param frustums
+            The frustums to cull. The pass pointers must be unique. Frustums that don't
+            agree with the first one on being a shadow caster pass, or that don't
+            have a LOD camera, are left out.
+        */
+        void _cullFrustumsBatched( const BatchedCullFrustumVec &frustums );
+
+        /// Discards the results from the last call to _cullFrustumsBatched
+        void _popBatchedCullFrustums(void);
+
         /** Prompts the class to send its contents to the renderer.
             @remarks
                 This method prompts the scene manager to send the
@@ -3122,6 +3321,25 @@ namespace Ogre {
         AxisAlignedBox _calculateCurrentCastersBox( uint32 viewportVisibilityMask,
                                                     uint8 firstRq, uint8 lastRq ) const;
 
+        /** Returns true if there's at least one dynamic (SCENE_DYNAMIC) shadow caster
+            inside the volume enclosed by the given 6 planes, between the given render
+            queues [firstRq; lastRq).
+        @remarks
+            Used by CompositorShadowNode to find out if a shadow map needs to be rendered
+            again, since we don't track whether dynamic objects have moved.
+        */
+        bool _hasDynamicCastersInVolume( uint32 viewportVisibilityMask, uint8 firstRq,
+                                         uint8 lastRq, const Plane planes[6] ) const;
+
+        /** Returns a number that changes every time the static scene changes, i.e. after
+            notifyStaticDirty or notifyStaticAabbDirty get processed, or static objects get
+            created or destroyed.
+        @remarks
+            Changes to static objects that aren't notified (e.g. toggling their visibility)
+            won't be seen. Use notifyStaticAabbDirty in that case.
+        */
+        uint32 getStaticSceneVersion(void) const                { return mStaticSceneVersion; }
+
         /** @See CompositorShadowNode::getCastersBox
         @remarks
             Returns a null box if no active shadow node.
@@ -3240,16 +3458,70 @@ namespace Ogre {
         inline bool updateWorkerThreadImpl( size_t threadIdx );
     };
 
-    /** Default implementation of IntersectionSceneQuery. */
+    /** Default implementation of IntersectionSceneQuery.
+    @remarks
+        Sweep and prune along the X axis over the world Aabbs stored in the
+        ObjectMemoryManagers. Objects passing the query & visibility masks are sorted
+        by their minimum X; then each one is tested in SIMD against the packs of the
+        objects that follow it, until their minimum X goes past its maximum X.
+    @par
+        The sweep is split across the SceneManager's worker threads, but the listener
+        is always called from the thread that called execute.
+    @par
+        Like the rest of the queries, the Aabbs must be up to date (i.e. call it after
+        SceneManager::updateSceneGraph, and don't move objects in between).
+    */
     class _OgreExport DefaultIntersectionSceneQuery : 
         public IntersectionSceneQuery
     {
+    public:
+        typedef std::pair<uint32, uint32> IndexPair;
+        typedef vector<IndexPair>::type IndexPairVec;
+
+    protected:
+        struct SweepEntry
+        {
+            Real    minX;
+            uint32  index;
+
+            bool operator < ( const SweepEntry &other ) const
+            {
+                return this->minX < other.minX;
+            }
+        };
+
+        typedef vector<SweepEntry>::type SweepEntryVec;
+        typedef vector<IndexPairVec>::type IndexPairVecVec;
+
+        /// Objects that passed the masks, in the order they were found.
+        vector<Aabb>::type              mGatheredAabbs;
+        vector<MovableObject*>::type    mGatheredOwners;
+        SweepEntryVec                   mSweepEntries;
+
+        /// Objects sorted by minimum X. mSortedAabbs holds one pack per
+        /// ARRAY_PACKED_REALS objects so they can be tested in SIMD.
+        ArrayAabb                       *mSortedAabbs;
+        size_t                          mSortedAabbsCapacity;
+        vector<Real>::type              mSortedMinX;
+        vector<Real>::type              mSortedMaxX;
+        vector<MovableObject*>::type    mSortedOwners;
+
+        /// Overlapping pairs (indices into the sorted arrays) found by each thread.
+        IndexPairVecVec                 mPairsPerThread;
+
+        void gatherCandidates( ObjectData objData, size_t numNodes );
+        void sortCandidates(void);
+
     public:
         DefaultIntersectionSceneQuery(SceneManager* creator);
         ~DefaultIntersectionSceneQuery();
 
         /** See IntersectionSceneQuery. */
         void execute(IntersectionSceneQueryListener* listener);
+
+        /// Tests the sorted candidates assigned to the given thread.
+        /// Called from the worker threads.
+        void _sweep( size_t threadIdx, size_t numThreads );
     };
 
     /** Default implementation of RaySceneQuery. */
@@ -3262,6 +3534,12 @@ namespace Ogre {
         /** See RayScenQuery. */
         virtual void execute(RaySceneQueryListener* listener);
         bool execute( ObjectData objData, size_t numNodes, RaySceneQueryListener* listener );
+
+        /** See RaySceneQuery::executeBatch. Rays are transposed into SIMD packs, one ray
+            per lane, and each object is tested against a whole pack at once. The work is
+            spread across the worker threads. Hits and distances are the same as execute's. */
+        virtual void executeBatch( const Ray *rays, size_t numRays,
+                                   const SceneQueryBatchOutput &output );
     };
     /** Default implementation of SphereSceneQuery. */
     class _OgreExport DefaultSphereSceneQuery : public SphereSceneQuery
@@ -3273,6 +3551,10 @@ namespace Ogre {
         /** See SceneQuery. */
         virtual void execute(SceneQueryListener* listener);
         bool execute( ObjectData objData, size_t numNodes, SceneQueryListener* listener );
+
+        /// See SphereSceneQuery::executeBatch.
+        virtual void executeBatch( const Sphere *spheres, size_t numSpheres,
+                                   const SceneQueryBatchOutput &output );
     };
     /** Default implementation of PlaneBoundedVolumeListSceneQuery. */
     class _OgreExport DefaultPlaneBoundedVolumeListSceneQuery : public PlaneBoundedVolumeListSceneQuery
@@ -3306,6 +3588,10 @@ namespace Ogre {
         /** See RayScenQuery. */
         virtual void execute(SceneQueryListener* listener);
         bool execute( ObjectData objData, size_t numNodes, SceneQueryListener* listener );
+
+        /// See AxisAlignedBoxSceneQuery::executeBatch.
+        virtual void executeBatch( const AxisAlignedBox *boxes, size_t numBoxes,
+                                   const SceneQueryBatchOutput &output );
     };
     
 
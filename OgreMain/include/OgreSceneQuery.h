@@ -205,6 +205,38 @@ namespace Ogre {
         SceneQueryResultWorldFragmentList worldFragments;
     };
 
+    /** A single hit written by the batched queries (see RaySceneQuery::executeBatch).
+    @remarks
+        World fragments are not reported by the batched queries.
+    */
+    struct _OgreExport SceneQueryBatchResult
+    {
+        MovableObject   *movable;
+        /// Distance along the ray, in units of the ray's direction. Always 0 for volume queries.
+        Real            distance;
+    };
+
+    /** Preallocated output of a batched query.
+    @remarks
+        Query i writes its hits to results[i * maxResultsPerQuery] onwards, and the amount of
+        hits written to numResults[i]. Hits that don't fit are dropped (when sorting by
+        distance, the farthest ones are the ones dropped).
+        Both arrays are owned by the caller: results must hold at least
+        numQueries * maxResultsPerQuery entries, numResults at least numQueries.
+    */
+    struct _OgreExport SceneQueryBatchOutput
+    {
+        SceneQueryBatchResult   *results;
+        uint32                  *numResults;
+        uint32                  maxResultsPerQuery;
+
+        SceneQueryBatchOutput() : results( 0 ), numResults( 0 ), maxResultsPerQuery( 0 ) {}
+        SceneQueryBatchOutput( SceneQueryBatchResult *_results, uint32 *_numResults,
+                               uint32 _maxResultsPerQuery ) :
+            results( _results ), numResults( _numResults ),
+            maxResultsPerQuery( _maxResultsPerQuery ) {}
+    };
+
     /** Abstract class defining a query which returns single results from a region. 
     @remarks
         This class is simply a generalisation of the subtypes of query that return 
@@ -272,6 +304,24 @@ namespace Ogre {
         /** Gets the box which is being used for this query. */
         const AxisAlignedBox& getBox(void) const;
 
+        /** Evaluates many boxes in one go, writing the results to preallocated memory.
+        @remarks
+            Equivalent to calling setBox & execute for each box, but without listener
+            calls nor per-query allocations. The query mask, render queue range and
+            the box set via setBox are used (or preserved) as usual.
+        @par
+            Implementations may spread the queries across the SceneManager's worker
+            threads, hence this function must not be called from inside a worker thread.
+        @param boxes
+            Array of numBoxes boxes to test.
+        @param numBoxes
+            Number of boxes.
+        @param output
+            Where to store the results. See SceneQueryBatchOutput.
+        */
+        virtual void executeBatch( const AxisAlignedBox *boxes, size_t numBoxes,
+                                   const SceneQueryBatchOutput &output );
+
     };
 
     /** Specialises the SceneQuery class for querying within a sphere. */
@@ -288,6 +338,13 @@ namespace Ogre {
         /** Gets the sphere which is being used for this query. */
         const Sphere& getSphere() const;
 
+        /** Evaluates many spheres in one go, writing the results to preallocated memory.
+        @remarks
+            Same as AxisAlignedBoxSceneQuery::executeBatch, but with spheres.
+        */
+        virtual void executeBatch( const Sphere *spheres, size_t numSpheres,
+                                   const SceneQueryBatchOutput &output );
+
     };
 
     /** Specialises the SceneQuery class for querying within a plane-bounded volume. 
@@ -422,6 +479,29 @@ namespace Ogre {
         */
         virtual void execute(RaySceneQueryListener* listener) = 0;
 
+        /** Casts many rays in one go, writing the results to preallocated memory.
+        @remarks
+            Equivalent to calling setRay & execute for each ray, but without listener
+            calls nor per-query allocations. The query mask, render queue range and the
+            ray set via setRay are used (or preserved) as usual.
+        @par
+            When sorting by distance is enabled, the results of each ray are sorted and
+            only the nearest ones are kept; the limit is the smallest of getMaxResults
+            (unless it's 0) and output.maxResultsPerQuery.
+            Without sorting, the first hits found are kept in no particular order.
+        @par
+            Implementations may spread the rays across the SceneManager's worker
+            threads, hence this function must not be called from inside a worker thread.
+        @param rays
+            Array of numRays rays to cast.
+        @param numRays
+            Number of rays.
+        @param output
+            Where to store the results. See SceneQueryBatchOutput.
+        */
+        virtual void executeBatch( const Ray *rays, size_t numRays,
+                                   const SceneQueryBatchOutput &output );
+
         /** Gets the results of the last query that was run using this object, provided
             the query was executed using the collection-returning version of execute. 
         */
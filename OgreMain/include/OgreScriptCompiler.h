@@ -191,6 +191,26 @@ namespace Ogre
         //typedef map<String,uint32>::type IdMap;
         typedef unordered_map<String,uint32>::type IdMap;
 
+        /// Key of the AST cache, see ScriptCompilerManager::setAstCacheEnabled
+        struct SourceHash
+        {
+            uint64 hashVal[2];
+
+            bool operator < ( const SourceHash &_r ) const
+            {
+                if( hashVal[0] < _r.hashVal[0] ) return true;
+                if( hashVal[0] > _r.hashVal[0] ) return false;
+
+                if( hashVal[1] < _r.hashVal[1] ) return true;
+
+                return false;
+            }
+            bool operator != ( const SourceHash &_r ) const
+            {
+                return hashVal[0] != _r.hashVal[0] || hashVal[1] != _r.hashVal[1];
+            }
+        };
+
         // The container for errors
         struct Error : public ScriptCompilerAlloc
         {
@@ -227,6 +247,8 @@ namespace Ogre
          * @param str The script code
          * @param source The source of the script code (e.g. a script file)
          * @param group The resource group to place the compiled resources into
+         * @remarks If the ScriptCompilerManager's AST cache is enabled and no listener is set,
+         *          the processed AST is looked up in (or added to) that cache
          */
         bool compile(const String &str, const String &source, const String &group);
         /// Compiles resources from the given concrete node list
@@ -268,6 +290,18 @@ namespace Ogre
 		*/
 		uint32 registerCustomWordId(const String &word);
 
+        /** Hashes the script code, its source name and the resource group it's compiled
+            for into the AST cache key. The group matters because imports are looked up
+            in it.
+        */
+        static SourceHash computeSourceHash( const String &str, const String &source,
+                                             const String &group = BLANKSTRING );
+
+        /// Common path for both compile overloads. When astCacheKey isn't null and the
+        /// AST was processed without errors, it is stored in ScriptCompilerManager's cache.
+        bool _compileConcreteNodes( const ConcreteNodeListPtr &nodes, const String &group,
+                                    const SourceHash *astCacheKey );
+
     private: // Tree processing
         AbstractNodeListPtr convertToAST(const ConcreteNodeListPtr &nodes);
         /// This built-in function processes import nodes
@@ -286,6 +320,15 @@ namespace Ogre
         bool isNameExcluded(const String &cls, AbstractNode *parent);
         /// This function sets up the initial values in word id map
         void initWordMap();
+    private: // AST cache serialisation
+        /// Writes the imported files' hashes followed by the processed AST
+        void saveAst( const AbstractNodeList &nodes, vector<uint8>::type &outBuffer );
+        void writeAstNodes( const AbstractNodeList &nodes, vector<uint8>::type &outBuffer );
+        /// Returns a null pointer if any of the imported files changed since it was saved
+        AbstractNodeListPtr loadAst( DataStream &stream );
+        void readAstNodes( DataStream &stream, AbstractNodeList &outNodes, AbstractNode *parent );
+        /// Returns the word id of the given token, 0 if it isn't a keyword
+        uint32 getWordId( const String &word ) const;
     private:
         // Resource group
         String mGroup;
@@ -301,6 +344,8 @@ namespace Ogre
 
         typedef map<String,AbstractNodeListPtr>::type ImportCacheMap;
         ImportCacheMap mImports; // The set of imported scripts to avoid circular dependencies
+        typedef map<String,SourceHash>::type ImportHashMap;
+        ImportHashMap mImportHashes; // Hash of every script read by loadImportPath, for the AST cache
         typedef multimap<String,String>::type ImportRequestMap;
         ImportRequestMap mImportRequests; // This holds the target objects for each script to be imported
 
@@ -418,6 +463,11 @@ namespace Ogre
 
         // A pointer to the specific compiler instance used
         OGRE_THREAD_POINTER(ScriptCompiler, mScriptCompiler);
+
+        typedef map<ScriptCompiler::SourceHash, MemoryDataStreamPtr>::type AstCacheMap;
+        AstCacheMap mAstCache;
+        bool mAstCacheEnabled;
+        bool mAstCacheDirty;
     public:
         ScriptCompilerManager();
         virtual ~ScriptCompilerManager();
@@ -455,9 +505,53 @@ namespace Ogre
         const StringVector& getScriptPatterns(void) const;
         /// @copydoc ScriptLoader::parseScript
         void parseScript(DataStreamPtr& stream, const String& groupName);
+        /// Lexes and parses the script into a ConcreteNode tree. Thread safe.
+        /// @copydoc ScriptLoader::_preparseScript
+        PreparsedScript* _preparseScript( const String &source, const String &scriptName,
+                                          const String &groupName );
+        /// Converts the tree to an AST and runs the translators.
+        /// @copydoc ScriptLoader::_parsePreparsedScript
+        void _parsePreparsedScript( PreparsedScript *preparsed, const String &groupName );
         /// @copydoc ScriptLoader::getLoadingOrder
         Real getLoadingOrder(void) const;
 
+        /** Enables caching the AST of every compiled script, after imports, object
+            inheritance and variables have been processed.
+        @remarks
+            Scripts whose code, name and resource group hash to a cached entry skip lexing,
+            parsing and tree processing entirely, as long as none of the scripts they import
+            changed.
+            Use saveAstCache and loadAstCache to persist it between runs.
+        @par
+            The cache is bypassed while a ScriptCompilerListener is set, as it could alter
+            the trees. It must be cleared if the name exclusions or the registered
+            translators change in a way that alters how scripts are parsed.
+        */
+        void setAstCacheEnabled( bool enabled );
+        bool getAstCacheEnabled(void) const                 { return mAstCacheEnabled; }
+
+        /// Returns true if the AST cache changed since it was loaded or cleared.
+        bool isAstCacheDirty(void) const                    { return mAstCacheDirty; }
+
+        /// Returns the serialised AST for the given script, null if not cached.
+        MemoryDataStreamPtr _getCachedAst( const ScriptCompiler::SourceHash &hash ) const;
+        /// Stores a serialised AST. Not thread safe.
+        void _addAstToCache( const ScriptCompiler::SourceHash &hash, const MemoryDataStreamPtr &ast );
+
+        /** Saves the AST cache.
+        @param stream The destination stream
+        */
+        void saveAstCache( DataStreamPtr stream ) const;
+        /** Loads the AST cache, replacing the current contents.
+        @remarks
+            A cache that is outdated, truncated or corrupt is ignored (logged), leaving
+            the cache empty so that scripts get parsed again.
+        @param stream The source stream
+        */
+        void loadAstCache( DataStreamPtr stream );
+        /// Removes all cached ASTs.
+        void clearAstCache(void);
+
         /** Override standard Singleton retrieval.
         @remarks
         Why do we do this? Well, it's because the Singleton
@@ -842,6 +936,7 @@ namespace Ogre
                 ID_CUBEMAP,
                 ID_MIPMAPS,
                 ID_AUTOMIPMAPS,
+                ID_TRANSIENT,
             ID_TARGET,
         //  ID_PASS,
                 ID_CLEAR,
@@ -77,6 +77,41 @@ namespace Ogre {
         */
         virtual void parseScript(DataStreamPtr& stream, const String& groupName) = 0;
 
+        /// Opaque result of _preparseScript. Owned by whoever called _preparseScript.
+        class PreparsedScript : public ScriptCompilerAlloc
+        {
+        public:
+            virtual ~PreparsedScript() {}
+        };
+
+        /** Optional first half of parseScript, which ResourceGroupManager may run from
+            worker threads (see ResourceGroupManager::setNumScriptParsingThreads).
+        @remarks
+            It may be called concurrently for different scripts, so implementations must not
+            touch any global state (managers, listeners, logs). Only thread-agnostic work
+            such as lexing and parsing belongs here.
+        @param source
+            Contents of the script.
+        @param scriptName
+            Name of the script, for error reporting.
+        @param groupName
+            Resource group the script will be parsed for. See parseScript.
+        @return
+            Data to pass to _parsePreparsedScript from the main thread, or a null pointer if
+            the script must go through parseScript instead (the default, also used on errors
+            so that they get reported on the main thread).
+        */
+        virtual PreparsedScript* _preparseScript( const String &source, const String &scriptName,
+                                                  const String &groupName )         { return 0; }
+
+        /** Second half of parseScript. Always called from the main thread, in loading order.
+        @param preparsed
+            Value returned by _preparseScript. Never null. Caller keeps ownership.
+        @param groupName
+            See parseScript.
+        */
+        virtual void _parsePreparsedScript( PreparsedScript *preparsed, const String &groupName ) {}
+
         /** Gets the relative loading order of scripts of this type.
         @remarks
             There are dependencies between some kinds of scripts, and to enforce
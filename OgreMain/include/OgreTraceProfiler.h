@@ -0,0 +1,208 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+	(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+
+#ifndef _OgreTraceProfiler_H_
+#define _OgreTraceProfiler_H_
+
+#include "OgrePrerequisites.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreThreads.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+#define OGRE_TRACE_PROFILER_NAME_STR_LENGTH 48
+#define OGRE_TRACE_PROFILER_EVENTS_PER_CHUNK 4096
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup General
+    *  @{
+    */
+
+    /**
+    @class TraceProfiler
+        Records begin/end events with nanosecond timestamps from every thread that
+        emits them (main thread, SceneManager worker threads, resource loading threads...)
+        and exports them as Chrome trace JSON, which can be opened with chrome://tracing
+        or https://ui.perfetto.dev
+    @remarks
+        Used when OGRE_PROFILING is OGRE_PROFILING_TRACE. Use the OgreProfile* macros
+        rather than calling it directly, so that it compiles to nothing when disabled.
+    @par
+        Each thread appends to its own list of chunks; recording an event does not take
+        any lock (only the first event of a new thread registers it, under a mutex).
+        As a consequence, dumpChromeTrace and reset must not be called while other
+        threads are recording (e.g. call them from the main thread between frames).
+    @par
+        Because events are collected indefinitely, memory consumption grows over time.
+        Use setEnabled to record only the section you're interested in.
+    */
+    class _OgreExport TraceProfiler
+    {
+        struct Event
+        {
+            uint64  timestampNs;
+            /// Empty for end events
+            char    name[OGRE_TRACE_PROFILER_NAME_STR_LENGTH];
+        };
+
+        struct EventChunk
+        {
+            Event       events[OGRE_TRACE_PROFILER_EVENTS_PER_CHUNK];
+            size_t      numEvents;
+            EventChunk  *next;
+        };
+
+        struct PerThreadData
+        {
+            uint32      threadId;
+            char        threadName[OGRE_TRACE_PROFILER_NAME_STR_LENGTH];
+            EventChunk  *firstChunk;
+            EventChunk  *currentChunk;
+            /// Nesting level of beginEvent calls (recorded or not)
+            uint32      stackDepth;
+            /// Bit i is set if the begin event at nesting level i was recorded, so that
+            /// its end is recorded too even if recording was disabled in the middle.
+            uint64      recordedMask;
+        };
+
+        typedef FastArray<PerThreadData*> PerThreadDataArray;
+
+        static TraceProfiler *msInstance;
+
+        bool                mEnabled;
+        uint32              mProfileGroupMask;
+
+        LightweightMutex    mMutex;     //Protects mThreadData
+        TlsHandle           mTlsHandle;
+        PerThreadDataArray  mThreadData;
+
+        String              mOnShutdownPath;
+
+        PerThreadData* getPerThreadData(void);
+        PerThreadData* allocatePerThreadData(void);
+        inline void addEvent( PerThreadData *perThreadData, const char *name );
+
+        static void destroyChunks( PerThreadData *perThreadData );
+
+    public:
+        TraceProfiler();
+        ~TraceProfiler();
+
+        /// Returns the TraceProfiler created by the Profiler. May be null.
+        static TraceProfiler* getSingletonPtr(void)             { return msInstance; }
+
+        /// Monotonic clock, in nanoseconds.
+        static uint64 getTimestampNs(void);
+
+        /** Starts or stops recording. Begin events recorded while enabled still get their
+            end event recorded if recording is disabled in the middle.
+        @remarks
+            Enabled by default.
+        */
+        void setEnabled( bool bEnabled );
+        bool getEnabled(void) const                             { return mEnabled; }
+
+        /** Events whose group (@see ProfileGroupMask) isn't in this mask aren't recorded.
+            Follows Profiler::setProfileGroupMask.
+        @remarks
+            Like with setEnabled, events begun while they passed the mask still get
+            their end recorded.
+        */
+        void setProfileGroupMask( uint32 mask )                 { mProfileGroupMask = mask; }
+        uint32 getProfileGroupMask(void) const                  { return mProfileGroupMask; }
+
+        /// Sets the name the calling thread will have in the trace. Ignored if too long.
+        void setCurrentThreadName( const char *name );
+
+        /** Records the beginning of an event in the calling thread.
+        @param name
+            Names longer than OGRE_TRACE_PROFILER_NAME_STR_LENGTH - 1 get truncated.
+        @param groupId
+            @see ProfileGroupMask. Not recorded unless it passes the mask.
+        */
+        void beginEvent( const char *name, uint32 groupId );
+        void beginEvent( const String &name, uint32 groupId )   { beginEvent( name.c_str(), groupId ); }
+        /// Records the end of the last event begun in the calling thread.
+        void endEvent(void);
+
+        /** Discards all the recorded events.
+        @remarks
+            Must not be called while other threads are recording.
+        */
+        void reset(void);
+
+        /** Writes all recorded events, from all threads, to a string in
+            Chrome Trace Event format (JSON).
+        @remarks
+            Must not be called while other threads are recording.
+        */
+        void dumpChromeTraceStr( String &outJson ) const;
+
+        /// Same as dumpChromeTraceStr, but writes to the given file
+        void dumpChromeTrace( const String &fullPath ) const;
+
+        /// Ogre will call dumpChromeTrace for you on shutdown if you set this path.
+        void setDumpPathOnShutdown( const String &fullPath );
+    };
+
+    /// Scoped event. @see TraceProfiler
+    class TraceProfile
+    {
+    public:
+        TraceProfile( const char *name, uint32 groupId )
+        {
+            TraceProfiler *traceProfiler = TraceProfiler::getSingletonPtr();
+            if( traceProfiler )
+                traceProfiler->beginEvent( name, groupId );
+        }
+        TraceProfile( const String &name, uint32 groupId )
+        {
+            TraceProfiler *traceProfiler = TraceProfiler::getSingletonPtr();
+            if( traceProfiler )
+                traceProfiler->beginEvent( name, groupId );
+        }
+        ~TraceProfile()
+        {
+            TraceProfiler *traceProfiler = TraceProfiler::getSingletonPtr();
+            if( traceProfiler )
+                traceProfiler->endEvent();
+        }
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
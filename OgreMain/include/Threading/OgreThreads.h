@@ -87,6 +87,8 @@ THE SOFTWARE.
 
 namespace Ogre
 {
+    class UniformScalableTask;
+
     class _OgreExport ThreadHandle
     {
 #if OGRE_PLATFORM == OGRE_PLATFORM_WIN32 || OGRE_PLATFORM == OGRE_PLATFORM_WINRT
@@ -209,6 +211,21 @@ namespace Ogre
 
         static void SetTls( TlsHandle tlsHandle, void *value );
         static void* GetTls( TlsHandle tlsHandle );
+
+        /** Calls UniformScalableTask::execute from numThreads threads at the same time:
+            the calling thread (as threadId 0) plus numThreads - 1 temporary threads.
+            Returns once all of them are done.
+        @remarks
+            Meant for work done outside the frame loop, e.g. while loading resources, as
+            creating threads isn't free. When a SceneManager is available,
+            SceneManager::executeUserScalableTask reuses its worker threads instead.
+        @param task
+            Task to execute.
+        @param numThreads
+            Number of threads, including the calling one. Values below 2 run the task
+            directly on the calling thread.
+        */
+        static void ExecuteUniformScalableTask( UniformScalableTask *task, size_t numThreads );
     };
 }
 
@@ -0,0 +1,72 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __WaitableEvent_H__
+#define __WaitableEvent_H__
+
+#include "OgrePlatform.h"
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32 || OGRE_PLATFORM == OGRE_PLATFORM_WINRT
+    //No need to include the heavy windows.h header for something like this!
+    typedef void* HANDLE;
+#else
+    #include <pthread.h>
+#endif
+
+namespace Ogre
+{
+    /** A WaitableEvent lets a thread sleep until another thread wakes it up.
+        Useful for persistent worker threads that must sleep while there's no work,
+        without spinning and without being created again for every new batch of work.
+    @remarks
+        The event resets automatically: wake() releases a single waiting thread. If no
+        thread is waiting, the next call to wait() returns immediately. Multiple calls
+        to wake() without a wait() in between count as one.
+    */
+    class _OgreExport WaitableEvent
+    {
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32 || OGRE_PLATFORM == OGRE_PLATFORM_WINRT
+        HANDLE                  mEvent;
+#else
+        pthread_mutex_t         mMutex;
+        pthread_cond_t          mCond;
+        bool                    mSignaled;
+#endif
+
+    public:
+        WaitableEvent();
+        ~WaitableEvent();
+
+        /// Releases one thread blocked in wait(), or the next one that calls wait().
+        void wake(void);
+
+        /// Blocks until woken up by wake().
+        void wait(void);
+    };
+}
+
+#endif
@@ -81,7 +81,8 @@ namespace Ogre
         mSharedTriangleFS( 0 ),
         mSharedQuadFS( 0 ),
         mDummyObjectMemoryManager( 0 ),
-        mCompositorPassProvider( 0 )
+        mCompositorPassProvider( 0 ),
+        mMultiViewCulling( false )
     {
         mDummyObjectMemoryManager = new ObjectMemoryManager();
         mSharedTriangleFS   = OGRE_NEW v1::Rectangle2D( false, 0, mDummyObjectMemoryManager, 0 );
@@ -703,6 +704,9 @@ namespace Ogre
             }
         }
 
+        if( mMultiViewCulling )
+            cullAllViewsBatched();
+
         //The actual update
         itor = mWorkspaces.begin();
 
@@ -714,6 +718,21 @@ namespace Ogre
             ++itor;
         }
 
+        {
+            vector<SceneManager*>::type::const_iterator itSceneMgr =
+                    mMultiViewCulledSceneManagers.begin();
+            vector<SceneManager*>::type::const_iterator enSceneMgr =
+                    mMultiViewCulledSceneManagers.end();
+
+            while( itSceneMgr != enSceneMgr )
+            {
+                (*itSceneMgr)->_popBatchedCullFrustums();
+                ++itSceneMgr;
+            }
+
+            mMultiViewCulledSceneManagers.clear();
+        }
+
         itor = mWorkspaces.begin();
 
         while( itor != end )
@@ -724,6 +743,15 @@ namespace Ogre
             ++itor;
         }
 
+        //Workspaces may have been updated manually (i.e. from a listener) even if disabled
+        itor = mWorkspaces.begin();
+
+        while( itor != end )
+        {
+            (*itor)->_recordCpuFrameStats();
+            ++itor;
+        }
+
         SceneManagerEnumerator::SceneManagerIterator sceneManagerItor =
                 sceneManagers.getSceneManagerIterator();
 
@@ -807,6 +835,55 @@ namespace Ogre
         return mCompositorPassProvider;
     }
     //-----------------------------------------------------------------------------------
+    void CompositorManager2::setMultiViewCulling( bool multiViewCulling )
+    {
+        mMultiViewCulling = multiViewCulling;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorManager2::cullAllViewsBatched(void)
+    {
+        BatchedCullFrustumVec frustums;
+
+        WorkspaceVec::const_iterator itor = mWorkspaces.begin();
+        WorkspaceVec::const_iterator end  = mWorkspaces.end();
+
+        while( itor != end )
+        {
+            SceneManager *sceneManager = (*itor)->getSceneManager();
+
+            const bool alreadyCulled = std::find( mMultiViewCulledSceneManagers.begin(),
+                                                  mMultiViewCulledSceneManagers.end(),
+                                                  sceneManager ) !=
+                                       mMultiViewCulledSceneManagers.end();
+
+            if( !alreadyCulled )
+            {
+                //Gather the views from all the workspaces using this SceneManager
+                frustums.clear();
+                WorkspaceVec::const_iterator itWorkspace = itor;
+                while( itWorkspace != end )
+                {
+                    CompositorWorkspace *workspace = *itWorkspace;
+                    if( workspace->getSceneManager() == sceneManager &&
+                        workspace->getEnabled() && workspace->isValid() )
+                    {
+                        workspace->_gatherBatchedCullFrustums( frustums );
+                    }
+                    ++itWorkspace;
+                }
+
+                //Nothing to gain from batching a single view
+                if( frustums.size() > 1u )
+                {
+                    sceneManager->_cullFrustumsBatched( frustums );
+                    mMultiViewCulledSceneManagers.push_back( sceneManager );
+                }
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorManager2::addListener( CompositorWorkspaceListener *listener )
     {
         mListeners.push_back( listener );
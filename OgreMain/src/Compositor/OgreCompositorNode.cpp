@@ -77,6 +77,7 @@ namespace Ogre
         //Create local textures
         TextureDefinitionBase::createTextures( definition->mLocalTextureDefs, mLocalTextures,
                                                 id, finalTarget, mRenderSystem );
+        mAliasedLocalTextures.resize( mLocalTextures.size(), false );
 
         const CompositorNamedBufferVec &globalBuffers = workspace->getGlobalBuffers();
 
@@ -106,7 +107,12 @@ namespace Ogre
         //Destroy our local buffers
         TextureDefinitionBase::destroyBuffers( mDefinition->mLocalBufferDefs, mBuffers, mRenderSystem );
 
-        //Destroy our local textures
+        //Destroy our local textures (the aliased ones belong to someone else)
+        for( size_t i=0; i<mLocalTextures.size(); ++i )
+        {
+            if( mAliasedLocalTextures[i] )
+                mLocalTextures[i] = CompositorChannel();
+        }
         TextureDefinitionBase::destroyTextures( mLocalTextures, mRenderSystem );
     }
     //-----------------------------------------------------------------------------------
@@ -246,6 +252,23 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void CompositorNode::_aliasLocalTexture( size_t localTextureIdx,
+                                             const CompositorChannel &aliasedChannel )
+    {
+        assert( mPasses.empty() && "Textures must be aliased before creating the passes!" );
+        assert( !mLocalTextures[localTextureIdx].isMrt() && !aliasedChannel.isMrt() );
+        assert( !mAliasedLocalTextures[localTextureIdx] );
+
+        CompositorChannelVec oldChannel( 1u, mLocalTextures[localTextureIdx] );
+        mLocalTextures[localTextureIdx] = aliasedChannel;
+        mAliasedLocalTextures[localTextureIdx] = true;
+
+        //Update our outputs and whoever is connected to them
+        notifyRecreated( oldChannel[0], aliasedChannel );
+
+        TextureDefinitionBase::destroyTextures( oldChannel, mRenderSystem );
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorNode::notifyRecreated( const UavBufferPacked *oldBuffer, UavBufferPacked *newBuffer )
     {
         //Clear our inputs
@@ -994,10 +1017,13 @@ namespace Ogre
             const CompositorTargetDef *targetDef = passDef->getParentTargetDef();
 
             if( executionMask & passDef->mExecutionMask &&
-                (!shadowNode || (!shadowNode->isShadowMapIdxInValidRange( passDef->mShadowMapIdx )
-                || (shadowNode->_shouldUpdateShadowMapIdx( passDef->mShadowMapIdx )
-                && (shadowNode->getShadowMapLightTypeMask( passDef->mShadowMapIdx ) &
-                    targetDef->getShadowMapSupportedLightTypes())))) )
+                (!shadowNode ||
+                (!shadowNode->isShadowMapIdxInValidRange( passDef->mShadowMapIdx ) &&
+                 shadowNode->_shouldUpdateAtlas( targetDef->getRenderTargetName() )) ||
+                (shadowNode->isShadowMapIdxInValidRange( passDef->mShadowMapIdx ) &&
+                 shadowNode->_shouldUpdateShadowMapIdx( passDef->mShadowMapIdx ) &&
+                 (shadowNode->getShadowMapLightTypeMask( passDef->mShadowMapIdx ) &
+                  targetDef->getShadowMapSupportedLightTypes()))) )
             {
                 //Make explicitly exposed textures available to materials during this pass.
                 const size_t oldNumTextures = sceneManager->getNumCompositorTextures();
@@ -1028,6 +1054,10 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void CompositorNode::finalTargetResized( const RenderTarget *finalTarget )
     {
+        assert( std::find( mAliasedLocalTextures.begin(), mAliasedLocalTextures.end(), true ) ==
+                mAliasedLocalTextures.end() &&
+                "Nodes with aliased textures must be recreated instead of resized" );
+
         TextureDefinitionBase::recreateResizableTextures( mDefinition->mLocalTextureDefs, mLocalTextures,
                                                             finalTarget, mRenderSystem, mConnectedNodes,
                                                             &mPasses );
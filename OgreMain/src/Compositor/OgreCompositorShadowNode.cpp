@@ -88,7 +88,9 @@ namespace Ogre
             mDefinition( definition ),
             mLastCamera( 0 ),
             mLastFrame( -1 ),
-            mNumActiveShadowMapCastingLights( 0 )
+            mNumActiveShadowMapCastingLights( 0 ),
+            mAutomaticCaching( false ),
+            mNumCachedShadowMaps( 0 )
     {
         mShadowMapCameras.reserve( definition->mShadowMapTexDefinitions.size() );
         mLocalTextures.reserve( mLocalTextures.size() + definition->mShadowMapTexDefinitions.size() );
@@ -121,6 +123,14 @@ namespace Ogre
             shadowMapCamera.maxDistance = 100000.0f;
             for( size_t i=0; i<Light::NUM_LIGHT_TYPES; ++i )
                 shadowMapCamera.scenePassesViewportSize[i] = -Vector2::UNIT_SCALE;
+            shadowMapCamera.sharesAtlasPasses       = false;
+            shadowMapCamera.upToDate                = false;
+            shadowMapCamera.dynamicCastersInVolume  = false;
+            shadowMapCamera.cacheValid              = false;
+            shadowMapCamera.cachedLight             = 0;
+            shadowMapCamera.cachedStaticSceneVersion= 0;
+            shadowMapCamera.cachedViewMatrix        = Matrix4::IDENTITY;
+            shadowMapCamera.cachedProjectionMatrix  = Matrix4::IDENTITY;
 
             {
                 //Find out the index to our texture in both mLocalTextures & mContiguousShadowMapTex
@@ -212,6 +222,28 @@ namespace Ogre
         // as a Node discovers it needs us for the first time, we get created)
         createPasses();
 
+        {
+            //Find the shadow maps whose texture is also written by passes not tied
+            //to a particular shadow map (e.g. a clear for the whole atlas)
+            CompositorPassVec::const_iterator itPass = mPasses.begin();
+            CompositorPassVec::const_iterator enPass = mPasses.end();
+
+            while( itPass != enPass )
+            {
+                const CompositorPassDef *passDef = (*itPass)->getDefinition();
+                if( !isShadowMapIdxInValidRange( passDef->mShadowMapIdx ) )
+                {
+                    const IdString rtName = passDef->getParentTargetDef()->getRenderTargetName();
+                    for( size_t i=0; i<mShadowMapCameras.size(); ++i )
+                    {
+                        if( definition->mShadowMapTexDefinitions[i].getTextureName() == rtName )
+                            mShadowMapCameras[i].sharesAtlasPasses = true;
+                    }
+                }
+                ++itPass;
+            }
+        }
+
         mShadowMapCastingLights.resize( mDefinition->mNumLights );
     }
     //-----------------------------------------------------------------------------------
@@ -609,14 +641,50 @@ namespace Ogre
             ++itor;
         }
 
+        if( mAutomaticCaching )
+            updateShadowMapCacheState( sceneManager );
+
         SceneManager::IlluminationRenderStage previous = sceneManager->_getCurrentRenderStage();
         sceneManager->_setCurrentRenderStage( SceneManager::IRS_RENDER_TO_TEXTURE );
 
+        cullShadowMapsBatched( sceneManager, lodCamera );
+
         //Now render all passes
         CompositorNode::_update( lodCamera, sceneManager );
 
+        if( !mBatchedCullFrustums.empty() )
+            sceneManager->_popBatchedCullFrustums();
+
         sceneManager->_setCurrentRenderStage( previous );
 
+        if( mAutomaticCaching )
+        {
+            //Remember the state of what we've just rendered
+            const uint32 staticSceneVersion = sceneManager->getStaticSceneVersion();
+
+            CompositorShadowNodeDef::ShadowMapTexDefVec::const_iterator itDef =
+                    mDefinition->mShadowMapTexDefinitions.begin();
+            ShadowMapCameraVec::iterator itCam = mShadowMapCameras.begin();
+            ShadowMapCameraVec::iterator enCam = mShadowMapCameras.end();
+
+            while( itCam != enCam )
+            {
+                const LightClosest &lightClosest = mShadowMapCastingLights[itDef->light];
+                if( !itCam->upToDate && !lightClosest.isStatic )
+                {
+                    //Dynamic casters may move or leave the volume without us noticing.
+                    //What we've just rendered can't be reused.
+                    itCam->cacheValid               = !itCam->dynamicCastersInVolume;
+                    itCam->cachedLight              = lightClosest.light;
+                    itCam->cachedStaticSceneVersion = staticSceneVersion;
+                    itCam->cachedViewMatrix         = itCam->camera->getViewMatrix( true );
+                    itCam->cachedProjectionMatrix   = itCam->camera->getProjectionMatrix();
+                }
+                ++itDef;
+                ++itCam;
+            }
+        }
+
         {
             LightClosestArray::iterator it = mShadowMapCastingLights.begin();
             LightClosestArray::iterator en = mShadowMapCastingLights.end();
@@ -629,6 +697,222 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::cullShadowMapsBatched( SceneManager *sceneManager,
+                                                      const Camera *lodCamera )
+    {
+        mBatchedCullFrustums.clear();
+
+        if( !lodCamera )
+            return;
+
+        const uint8 executionMask = mWorkspace->getExecutionMask();
+
+        CompositorPassVec::const_iterator itor = mPasses.begin();
+        CompositorPassVec::const_iterator end  = mPasses.end();
+
+        while( itor != end )
+        {
+            CompositorPass *pass = *itor;
+            const CompositorPassDef *passDef = pass->getDefinition();
+
+            //Same condition CompositorNode::_update uses to execute a pass.
+            if( pass->getType() == PASS_SCENE && (executionMask & passDef->mExecutionMask) &&
+                isShadowMapIdxInValidRange( passDef->mShadowMapIdx ) &&
+                _shouldUpdateShadowMapIdx( passDef->mShadowMapIdx ) &&
+                (getShadowMapLightTypeMask( passDef->mShadowMapIdx ) &
+                 passDef->getParentTargetDef()->getShadowMapSupportedLightTypes()) )
+            {
+                assert( dynamic_cast<CompositorPassScene*>( pass ) );
+                CompositorPassScene *passScene = static_cast<CompositorPassScene*>( pass );
+                const CompositorPassSceneDef *sceneDef =
+                        static_cast<const CompositorPassSceneDef*>( passDef );
+
+                if( !sceneDef->mReuseCullData && sceneDef->mLodCameraName == IdString() )
+                {
+                    BatchedCullFrustum frustum;
+                    frustum.pass            = pass;
+                    frustum.camera          = passScene->getCullCamera();
+                    frustum.lodCamera       = lodCamera;
+                    frustum.firstRq         = sceneDef->mFirstRQ;
+                    frustum.lastRq          = sceneDef->mLastRQ;
+                    frustum.visibilityMask  = sceneDef->mVisibilityMask;
+                    //Point light shadow maps get culled once per cubemap face
+                    passScene->_getCullFrustumPlanes( frustum.planes );
+
+                    mBatchedCullFrustums.push_back( frustum );
+                }
+            }
+
+            ++itor;
+        }
+
+        //Nothing to gain from batching a single frustum
+        if( mBatchedCullFrustums.size() > 1u )
+            sceneManager->_cullFrustumsBatched( mBatchedCullFrustums );
+        else
+            mBatchedCullFrustums.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    bool CompositorShadowNode::isShadowMapUpToDate( const ShadowMapCamera &shadowMapCamera,
+                                                    const Light *light,
+                                                    uint32 staticSceneVersion ) const
+    {
+        if( !shadowMapCamera.cacheValid || shadowMapCamera.cachedLight != light )
+            return false;
+
+        if( !light )
+            return true; //It was left blank and still is
+
+        const Camera *texCamera = shadowMapCamera.camera;
+
+        return shadowMapCamera.cachedStaticSceneVersion == staticSceneVersion &&
+               shadowMapCamera.cachedViewMatrix == texCamera->getViewMatrix( true ) &&
+               shadowMapCamera.cachedProjectionMatrix == texCamera->getProjectionMatrix();
+    }
+    //-----------------------------------------------------------------------------------
+    bool CompositorShadowNode::hasDynamicCastersInVolume( const ShadowMapCamera &shadowMapCamera,
+                                                          const Light *light,
+                                                          SceneManager *sceneManager ) const
+    {
+        const Camera *texCamera = shadowMapCamera.camera;
+
+        Plane planes[6];
+        if( light->getType() != Light::LT_POINT )
+        {
+            const Plane *frustumPlanes = texCamera->getFrustumPlanes();
+            for( size_t i=0; i<6; ++i )
+                planes[i] = frustumPlanes[i];
+        }
+        else
+        {
+            //Point lights render to all 6 faces of a cubemap; reorienting the camera
+            //in each pass. Test against the box enclosing the light's range instead.
+            const Real range = std::max( texCamera->getFarClipDistance(),
+                                         light->getAttenuationRange() );
+            if( range == 0 || range == std::numeric_limits<Real>::infinity() )
+                return true;
+
+            const Vector3 lightPos = light->getParentNode()->_getDerivedPosition();
+            planes[0] = Plane( Vector3::UNIT_X,         -(lightPos.x - range) );
+            planes[1] = Plane( Vector3::NEGATIVE_UNIT_X,  lightPos.x + range );
+            planes[2] = Plane( Vector3::UNIT_Y,         -(lightPos.y - range) );
+            planes[3] = Plane( Vector3::NEGATIVE_UNIT_Y,  lightPos.y + range );
+            planes[4] = Plane( Vector3::UNIT_Z,         -(lightPos.z - range) );
+            planes[5] = Plane( Vector3::NEGATIVE_UNIT_Z,  lightPos.z + range );
+        }
+
+        return sceneManager->_hasDynamicCastersInVolume( 0xffffffff, mDefinition->mMinRq,
+                                                         mDefinition->mMaxRq, planes );
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::updateShadowMapCacheState( SceneManager *sceneManager )
+    {
+        const uint32 staticSceneVersion = sceneManager->getStaticSceneVersion();
+
+        mNumCachedShadowMaps = 0;
+        mUpToDateAtlases.clear();
+
+        CompositorShadowNodeDef::ShadowMapTexDefVec::const_iterator itDef =
+                mDefinition->mShadowMapTexDefinitions.begin();
+        ShadowMapCameraVec::iterator itor = mShadowMapCameras.begin();
+        ShadowMapCameraVec::iterator end  = mShadowMapCameras.end();
+
+        while( itor != end )
+        {
+            const LightClosest &lightClosest = mShadowMapCastingLights[itDef->light];
+            if( lightClosest.isStatic )
+            {
+                //Static shadow maps are handled manually by the user
+                itor->upToDate = !lightClosest.isDirty;
+            }
+            else
+            {
+                //Must be evaluated even if the cache is already invalid, since we need
+                //to know whether what we're about to render can be reused next frame.
+                itor->dynamicCastersInVolume = lightClosest.light &&
+                        hasDynamicCastersInVolume( *itor, lightClosest.light, sceneManager );
+                itor->upToDate = !itor->dynamicCastersInVolume &&
+                        isShadowMapUpToDate( *itor, lightClosest.light, staticSceneVersion );
+            }
+            ++itDef;
+            ++itor;
+        }
+
+        //Passes affecting the whole atlas (e.g. clear) would destroy the contents of the
+        //other shadow maps. Either all the shadow maps in the atlas are up to date, or
+        //we render all of them.
+        itDef = mDefinition->mShadowMapTexDefinitions.begin();
+        itor  = mShadowMapCameras.begin();
+
+        while( itor != end )
+        {
+            if( itor->sharesAtlasPasses )
+            {
+                const IdString texName = itDef->getTextureName();
+                if( std::find( mUpToDateAtlases.begin(), mUpToDateAtlases.end(),
+                               texName ) == mUpToDateAtlases.end() )
+                {
+                    bool allUpToDate = true;
+                    for( size_t i=0; i<mShadowMapCameras.size() && allUpToDate; ++i )
+                    {
+                        if( mDefinition->mShadowMapTexDefinitions[i].getTextureName() == texName )
+                            allUpToDate = mShadowMapCameras[i].upToDate;
+                    }
+
+                    if( allUpToDate )
+                    {
+                        mUpToDateAtlases.push_back( texName );
+                    }
+                    else
+                    {
+                        for( size_t i=0; i<mShadowMapCameras.size(); ++i )
+                        {
+                            if( mDefinition->mShadowMapTexDefinitions[i].getTextureName() == texName )
+                                mShadowMapCameras[i].upToDate = false;
+                        }
+                    }
+                }
+            }
+
+            ++itDef;
+            ++itor;
+        }
+
+        itDef = mDefinition->mShadowMapTexDefinitions.begin();
+        itor  = mShadowMapCameras.begin();
+        while( itor != end )
+        {
+            const LightClosest &lightClosest = mShadowMapCastingLights[itDef->light];
+            if( itor->upToDate && lightClosest.light && !lightClosest.isStatic )
+                ++mNumCachedShadowMaps;
+            ++itDef;
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::invalidateShadowMapCache(void)
+    {
+        mNumCachedShadowMaps = 0;
+        mUpToDateAtlases.clear();
+
+        ShadowMapCameraVec::iterator itor = mShadowMapCameras.begin();
+        ShadowMapCameraVec::iterator end  = mShadowMapCameras.end();
+
+        while( itor != end )
+        {
+            itor->upToDate      = false;
+            itor->cacheValid    = false;
+            itor->cachedLight   = 0;
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::setAutomaticCaching( bool bEnabled )
+    {
+        mAutomaticCaching = bEnabled;
+        invalidateShadowMapCache();
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorShadowNode::postInitializePass( CompositorPass *pass )
     {
         const CompositorPassDef *passDef = pass->getDefinition();
@@ -807,7 +1091,8 @@ namespace Ogre
 
             if( !mShadowMapCastingLights[shadowTexDef.light].light ||
                 (mShadowMapCastingLights[shadowTexDef.light].isStatic &&
-                !mShadowMapCastingLights[shadowTexDef.light].isDirty ) )
+                !mShadowMapCastingLights[shadowTexDef.light].isDirty ) ||
+                (mAutomaticCaching && mShadowMapCameras[shadowMapIdx].upToDate) )
             {
                 retVal = false;
             }
@@ -816,6 +1101,13 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
+    bool CompositorShadowNode::_shouldUpdateAtlas( IdString textureName ) const
+    {
+        return !mAutomaticCaching ||
+                std::find( mUpToDateAtlases.begin(), mUpToDateAtlases.end(),
+                           textureName ) == mUpToDateAtlases.end();
+    }
+    //-----------------------------------------------------------------------------------
     uint8 CompositorShadowNode::getShadowMapLightTypeMask( uint32 shadowMapIdx ) const
     {
         const ShadowTextureDefinition &shadowTexDef =
@@ -1006,6 +1298,9 @@ namespace Ogre
     {
         CompositorNode::finalTargetResized( finalTarget );
 
+        //Textures may have been recreated
+        invalidateShadowMapCache();
+
         mContiguousShadowMapTex.clear();
 
         CompositorShadowNodeDef::ShadowMapTexDefVec::const_iterator itDef =
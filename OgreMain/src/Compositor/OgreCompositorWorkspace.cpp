@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "Compositor/OgreCompositorShadowNode.h"
 
 #include "Compositor/Pass/PassScene/OgreCompositorPassScene.h"
+#include "Compositor/Pass/OgreCompositorPassDef.h"
 
 #include "OgreHardwarePixelBuffer.h"
 #include "OgreRenderTexture.h"
@@ -42,11 +43,35 @@ THE SOFTWARE.
 #include "OgreSceneManager.h"
 #include "OgreRenderTarget.h"
 #include "OgreLogManager.h"
+#include "OgreRoot.h"
+#include "OgreTimer.h"
 
 #include "OgreProfiler.h"
 
 namespace Ogre
 {
+    namespace
+    {
+        /// A node local texture that may share its memory with others.
+        /// @see CompositorWorkspace::aliasTransientTextures
+        struct TransientTexture
+        {
+            CompositorNode  *node;
+            size_t          localTextureIdx;
+            TextureDefinitionBase::TextureDefinition const *definition;
+            /// Index in mNodeSequence of the first & last node using the texture
+            size_t          firstUse;
+            size_t          lastUse;
+
+            TransientTexture( CompositorNode *_node, size_t _localTextureIdx,
+                              const TextureDefinitionBase::TextureDefinition *_definition,
+                              size_t _firstUse, size_t _lastUse ) :
+                node( _node ), localTextureIdx( _localTextureIdx ), definition( _definition ),
+                firstUse( _firstUse ), lastUse( _lastUse ) {}
+        };
+        typedef vector<TransientTexture>::type TransientTextureVec;
+    }
+
     CompositorWorkspace::CompositorWorkspace( IdType id, const CompositorWorkspaceDef *definition,
                                               const CompositorChannelVec &externalRenderTargets,
                                               SceneManager *sceneManager, Camera *defaultCam,
@@ -69,7 +94,13 @@ namespace Ogre
             mExecutionMask( executionMask ),
             mViewportModifierMask( viewportModifierMask ),
             mViewportModifier( vpOffsetScale ),
-            mBarriersDirty( true )
+            mBarriersDirty( true ),
+            mNumAliasedTextures( 0 ),
+            mLocalTextureMemoryUnaliased( 0 ),
+            mLocalTextureMemory( 0 ),
+            mExecutionPlanDirty( true ),
+            mCpuTimeThisFrame( 0 ),
+            mUpdatedThisFrame( false )
     {
         assert( (!defaultCam || (defaultCam->getSceneManager() == sceneManager)) &&
                 "Camera was created with a different SceneManager than supplied" );
@@ -147,6 +178,12 @@ namespace Ogre
     void CompositorWorkspace::destroyAllNodes(void)
     {
         mValid = false;
+        mNumAliasedTextures = 0;
+        mLocalTextureMemoryUnaliased = 0;
+        mLocalTextureMemory = 0;
+        mExecutionPlan.clear();
+        mExecutionPlanTextures.clear();
+        mExecutionPlanDirty = true;
         {
             CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
             CompositorNodeVec::const_iterator end  = mNodeSequence.end();
@@ -325,6 +362,10 @@ namespace Ogre
             mNodeSequence.clear();
             mNodeSequence.insert( mNodeSequence.end(), processedList.begin(), processedList.end() );
 
+            //Must be done before creating the passes, which grab the textures
+            aliasTransientTextures();
+            mExecutionPlanDirty = true;
+
             CompositorNodeVec::iterator itor = mNodeSequence.begin();
             CompositorNodeVec::iterator end  = mNodeSequence.end();
 
@@ -353,6 +394,10 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void CompositorWorkspace::clearAllConnections(void)
     {
+        mExecutionPlan.clear();
+        mExecutionPlanTextures.clear();
+        mExecutionPlanDirty = true;
+
         {
             CompositorNodeVec::iterator itor = mNodeSequence.begin();
             CompositorNodeVec::iterator end  = mNodeSequence.end();
@@ -530,6 +575,248 @@ namespace Ogre
         mBarriersDirty = false;
     }
     //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::aliasTransientTextures(void)
+    {
+        assert( mNumAliasedTextures == 0 && "Textures were already aliased!" );
+
+        mLocalTextureMemoryUnaliased = 0;
+        size_t aliasedMemory = 0;
+
+        //Gather the transient textures and their lifetimes. Since mNodeSequence
+        //is in execution order, they're already sorted by first use.
+        TransientTextureVec transientTextures;
+
+        const size_t numNodes = mNodeSequence.size();
+        for( size_t i=0; i<numNodes; ++i )
+        {
+            CompositorNode *node = mNodeSequence[i];
+            const TextureDefinitionBase::TextureDefinitionVec &textureDefs =
+                    node->getDefinition()->getLocalTextureDefinitions();
+            const CompositorChannelVec &localTextures = node->getLocalTextures();
+
+            for( size_t j=0; j<localTextures.size(); ++j )
+            {
+                const CompositorChannel &channel = localTextures[j];
+                mLocalTextureMemoryUnaliased += TextureDefinitionBase::getMemoryUsage( channel );
+
+                if( textureDefs[j].transient && channel.isValid() && !channel.isMrt() )
+                {
+                    //The texture lives until the last node that gets it as an
+                    //input (directly or passed through by another node)
+                    size_t lastUse = i;
+                    for( size_t k=i+1u; k<numNodes; ++k )
+                    {
+                        const CompositorChannelVec &inputs = mNodeSequence[k]->getInputChannel();
+                        if( std::find( inputs.begin(), inputs.end(), channel ) != inputs.end() )
+                            lastUse = k;
+                    }
+
+                    transientTextures.push_back( TransientTexture( node, j, &textureDefs[j],
+                                                                   i, lastUse ) );
+                }
+            }
+        }
+
+        //Greedy interval assignment: Reuse the first compatible
+        //texture that is no longer in use, or keep our own.
+        TransientTextureVec physicalTextures;
+        physicalTextures.reserve( transientTextures.size() );
+
+        TransientTextureVec::const_iterator itor = transientTextures.begin();
+        TransientTextureVec::const_iterator end  = transientTextures.end();
+
+        while( itor != end )
+        {
+            TransientTextureVec::iterator itPhys = physicalTextures.begin();
+            TransientTextureVec::iterator enPhys = physicalTextures.end();
+
+            while( itPhys != enPhys &&
+                   !(itPhys->lastUse < itor->firstUse &&
+                     itPhys->definition->isAliasableWith( *itor->definition )) )
+            {
+                ++itPhys;
+            }
+
+            if( itPhys != enPhys )
+            {
+                const CompositorChannel &channel =
+                        itor->node->getLocalTextures()[itor->localTextureIdx];
+                aliasedMemory += TextureDefinitionBase::getMemoryUsage( channel );
+
+                itor->node->_aliasLocalTexture(
+                            itor->localTextureIdx,
+                            itPhys->node->getLocalTextures()[itPhys->localTextureIdx] );
+                itPhys->lastUse = itor->lastUse;
+                ++mNumAliasedTextures;
+            }
+            else
+            {
+                physicalTextures.push_back( *itor );
+            }
+
+            ++itor;
+        }
+
+        mLocalTextureMemory = mLocalTextureMemoryUnaliased - aliasedMemory;
+
+        if( mNumAliasedTextures )
+        {
+            const Real toMiB = 1.0f / (1024.0f * 1024.0f);
+            LogManager::getSingleton().logMessage(
+                        "Workspace '" + mDefinition->mNameStr + "': " +
+                        StringConverter::toString( transientTextures.size() ) +
+                        " transient textures aliased onto " +
+                        StringConverter::toString( physicalTextures.size() ) +
+                        ". Node texture memory: " +
+                        StringConverter::toString( mLocalTextureMemoryUnaliased * toMiB ) +
+                        " MiB before, " +
+                        StringConverter::toString( mLocalTextureMemory * toMiB ) + " MiB after." );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::buildExecutionPlan(void)
+    {
+        mExecutionPlan.clear();
+        mExecutionPlanTextures.clear();
+
+        CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
+        CompositorNodeVec::const_iterator end  = mNodeSequence.end();
+
+        while( itor != end )
+        {
+            CompositorNode *node = *itor;
+            if( node->getEnabled() )
+            {
+                if( node->areAllInputsConnected() )
+                {
+                    //Notify target switches exactly like CompositorNode::_update does,
+                    //including those caused by passes excluded by the execution mask.
+                    const CompositorPassVec &passes = node->_getPasses();
+                    RenderTarget *lastTarget = 0;
+
+                    if( !passes.empty() )
+                        lastTarget = passes.front()->getRenderTarget();
+
+                    CompositorPassVec::const_iterator itPass = passes.begin();
+                    CompositorPassVec::const_iterator enPass = passes.end();
+
+                    while( itPass != enPass )
+                    {
+                        CompositorPass *pass = *itPass;
+                        const CompositorPassDef *passDef = pass->getDefinition();
+
+                        ExecutionPlanEntry entry;
+                        entry.node                  = node;
+                        entry.pass                  = 0;
+                        entry.switchedFromTarget    = lastTarget;
+                        entry.notifySwitch          = lastTarget != pass->getRenderTarget();
+                        entry.exposedTexturesStart  = static_cast<uint32>(
+                                    mExecutionPlanTextures.size() );
+
+                        lastTarget = pass->getRenderTarget();
+
+                        if( mExecutionMask & passDef->mExecutionMask )
+                        {
+                            entry.pass = pass;
+
+                            IdStringVec::const_iterator itExposed = passDef->mExposedTextures.begin();
+                            IdStringVec::const_iterator enExposed = passDef->mExposedTextures.end();
+
+                            while( itExposed != enExposed )
+                            {
+                                const CompositorChannel *exposedChannel =
+                                        node->_getDefinedTexture( *itExposed );
+                                mExecutionPlanTextures.push_back(
+                                            ExposedTexture( *itExposed, &exposedChannel->textures ) );
+                                ++itExposed;
+                            }
+                        }
+
+                        entry.exposedTexturesEnd = static_cast<uint32>(
+                                    mExecutionPlanTextures.size() );
+
+                        if( entry.pass || entry.notifySwitch )
+                            mExecutionPlan.push_back( entry );
+
+                        ++itPass;
+                    }
+
+                    if( !passes.empty() )
+                    {
+                        //The node is done
+                        ExecutionPlanEntry entry;
+                        entry.node                  = node;
+                        entry.pass                  = 0;
+                        entry.switchedFromTarget    = lastTarget;
+                        entry.notifySwitch          = true;
+                        entry.exposedTexturesStart  = 0;
+                        entry.exposedTexturesEnd    = 0;
+                        mExecutionPlan.push_back( entry );
+                    }
+                }
+                else
+                {
+                    //Defer the error until execution, as the node may be disabled again before that.
+                    ExecutionPlanEntry entry;
+                    entry.node                  = node;
+                    entry.pass                  = 0;
+                    entry.switchedFromTarget    = 0;
+                    entry.notifySwitch          = false;
+                    entry.exposedTexturesStart  = 0;
+                    entry.exposedTexturesEnd    = 0;
+                    mExecutionPlan.push_back( entry );
+                }
+            }
+            ++itor;
+        }
+
+        mExecutionPlanDirty = false;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::executePlan(void)
+    {
+        ExecutionPlanEntryVec::const_iterator itor = mExecutionPlan.begin();
+        ExecutionPlanEntryVec::const_iterator end  = mExecutionPlan.end();
+
+        while( itor != end )
+        {
+            const ExecutionPlanEntry &entry = *itor;
+
+            if( entry.notifySwitch )
+                mRenderSys->_notifyCompositorNodeSwitchedRenderTarget( entry.switchedFromTarget );
+
+            if( entry.pass )
+            {
+                //Make explicitly exposed textures available to materials during this pass.
+                const size_t oldNumTextures = mSceneManager->getNumCompositorTextures();
+                for( uint32 i=entry.exposedTexturesStart; i<entry.exposedTexturesEnd; ++i )
+                {
+                    mSceneManager->_addCompositorTexture( mExecutionPlanTextures[i].first,
+                                                          mExecutionPlanTextures[i].second );
+                }
+
+                mSceneManager->_setCompositorTarget( entry.pass->getTargetTexture() );
+
+                //Execute pass
+                entry.pass->execute( (Camera*)0 );
+
+                //Remove our textures
+                mSceneManager->_removeCompositorTextures( oldNumTextures );
+            }
+            else if( !entry.notifySwitch )
+            {
+                //If we get here, this means a node didn't have all of its input channels connected,
+                //but we ignored it because the node was disabled. But now it is enabled again.
+                LogManager::getSingleton().logMessage(
+                    "ERROR: Invalid Node '" + entry.node->getName().getFriendlyText() +
+                    "' was re-enabled without calling CompositorWorkspace::clearAllConnections" );
+                mValid = false;
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     CompositorNode* CompositorWorkspace::getLastEnabledNode(void)
     {
         CompositorNode *retVal = 0;
@@ -599,6 +886,13 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void CompositorWorkspace::reconnectAllNodes(void)
     {
+        if( mNumAliasedTextures )
+        {
+            //The lifetimes (and thus the aliasing) may change with the new connections
+            recreateAllNodes();
+            return;
+        }
+
         clearAllConnections();
         connectAllNodes();
     }
@@ -672,6 +966,9 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void CompositorWorkspace::_update(void)
     {
+        Timer *timer = Root::getSingleton().getTimer();
+        const unsigned long startTime = timer->getMicroseconds();
+
         if( mBarriersDirty )
         {
             CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
@@ -701,27 +998,39 @@ namespace Ogre
             mCurrentWidth   = finalTarget->getWidth();
             mCurrentHeight  = finalTarget->getHeight();
 
-            {
-                CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
-                CompositorNodeVec::const_iterator end  = mNodeSequence.end();
+            //Passes may now be pointing to different targets
+            mExecutionPlanDirty = true;
 
-                while( itor != end )
-                {
-                    CompositorNode *node = *itor;
-                    node->finalTargetResized( finalTarget );
-                    ++itor;
-                }
+            if( mNumAliasedTextures )
+            {
+                //Aliased textures are shared between nodes; resizing them node by node
+                //would break the sharing. Recreate everything (also the shadow nodes).
+                recreateAllNodes();
             }
-
+            else
             {
-                CompositorShadowNodeVec::const_iterator itor = mShadowNodes.begin();
-                CompositorShadowNodeVec::const_iterator end  = mShadowNodes.end();
+                {
+                    CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
+                    CompositorNodeVec::const_iterator end  = mNodeSequence.end();
+
+                    while( itor != end )
+                    {
+                        CompositorNode *node = *itor;
+                        node->finalTargetResized( finalTarget );
+                        ++itor;
+                    }
+                }
 
-                while( itor != end )
                 {
-                    CompositorShadowNode *node = *itor;
-                    node->finalTargetResized( finalTarget );
-                    ++itor;
+                    CompositorShadowNodeVec::const_iterator itor = mShadowNodes.begin();
+                    CompositorShadowNodeVec::const_iterator end  = mShadowNodes.end();
+
+                    while( itor != end )
+                    {
+                        CompositorShadowNode *node = *itor;
+                        node->finalTargetResized( finalTarget );
+                        ++itor;
+                    }
                 }
             }
 
@@ -737,28 +1046,96 @@ namespace Ogre
                                                              mRenderSys, allNodes, 0 );
         }
 
-        CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
-        CompositorNodeVec::const_iterator end  = mNodeSequence.end();
-
-        while( itor != end )
+        if( mSceneManager->_getCurrentRenderStage() == SceneManager::IRS_RENDER_TO_TEXTURE )
         {
-            CompositorNode *node = *itor;
-            if( node->getEnabled() )
+            //We're being updated from inside a shadow caster pass (i.e. from a listener).
+            //Nodes need to skip passes based on the current shadow node, which the
+            //execution plan can't know in advance. Take the slow path.
+            CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
+            CompositorNodeVec::const_iterator end  = mNodeSequence.end();
+
+            while( itor != end )
             {
-                if( node->areAllInputsConnected() )
+                CompositorNode *node = *itor;
+                if( node->getEnabled() )
                 {
-                    node->_update( (Camera*)0, mSceneManager );
+                    if( node->areAllInputsConnected() )
+                    {
+                        node->_update( (Camera*)0, mSceneManager );
+                    }
+                    else
+                    {
+                        //If we get here, this means a node didn't have all of its input channels
+                        //connected, but we ignored it because the node was disabled. But now
+                        //it is enabled again.
+                        LogManager::getSingleton().logMessage(
+                            "ERROR: Invalid Node '" + node->getName().getFriendlyText() +
+                            "' was re-enabled without calling CompositorWorkspace::clearAllConnections" );
+                        mValid = false;
+                    }
                 }
-                else
+                ++itor;
+            }
+        }
+        else
+        {
+            if( mExecutionPlanDirty )
+                buildExecutionPlan();
+
+            executePlan();
+        }
+
+        mCpuTimeThisFrame += timer->getMicroseconds() - startTime;
+        mUpdatedThisFrame = true;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::_recordCpuFrameStats(void)
+    {
+        if( mUpdatedThisFrame )
+        {
+            mCpuFrameStats.addSampleDuration( mCpuTimeThisFrame );
+            mCpuTimeThisFrame = 0;
+            mUpdatedThisFrame = false;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::_gatherBatchedCullFrustums( BatchedCullFrustumVec &outFrustums ) const
+    {
+        if( mExecutionPlanDirty || mBarriersDirty || !mValid ||
+            mSceneManager->_getCurrentRenderStage() == SceneManager::IRS_RENDER_TO_TEXTURE )
+        {
+            return;
+        }
+
+        ExecutionPlanEntryVec::const_iterator itor = mExecutionPlan.begin();
+        ExecutionPlanEntryVec::const_iterator end  = mExecutionPlan.end();
+
+        while( itor != end )
+        {
+            CompositorPass *pass = itor->pass;
+
+            if( pass && pass->getType() == PASS_SCENE )
+            {
+                assert( dynamic_cast<CompositorPassScene*>( pass ) );
+                CompositorPassScene *passScene = static_cast<CompositorPassScene*>( pass );
+                const CompositorPassSceneDef *sceneDef = passScene->getDefinition();
+
+                if( !sceneDef->mReuseCullData )
                 {
-                    //If we get here, this means a node didn't have all of its input channels connected,
-                    //but we ignored it because the node was disabled. But now it is enabled again.
-                    LogManager::getSingleton().logMessage(
-                        "ERROR: Invalid Node '" + node->getName().getFriendlyText() +
-                        "' was re-enabled without calling CompositorWorkspace::clearAllConnections" );
-                    mValid = false;
+                    //executePlan doesn't give passes a LOD camera, they use their own.
+                    BatchedCullFrustum frustum;
+                    frustum.pass            = pass;
+                    frustum.camera          = passScene->getCullCamera();
+                    frustum.lodCamera       = passScene->getLodCamera();
+                    frustum.firstRq         = sceneDef->mFirstRQ;
+                    frustum.lastRq          = sceneDef->mLastRQ;
+                    frustum.visibilityMask  = sceneDef->mVisibilityMask;
+                    passScene->_getCullFrustumPlanes( frustum.planes );
+
+                    outFrustums.push_back( frustum );
                 }
             }
+
             ++itor;
         }
     }
@@ -47,6 +47,22 @@ namespace Ogre
                 mDefaultLocalTextureSource == TEXTURE_GLOBAL );
     }
     //-----------------------------------------------------------------------------------
+    bool TextureDefinitionBase::TextureDefinition::isAliasableWith(
+            const TextureDefinition &other ) const
+    {
+        return textureType == other.textureType &&
+                width == other.width && height == other.height && depth == other.depth &&
+                numMipmaps == other.numMipmaps &&
+                (width != 0 || widthFactor == other.widthFactor) &&
+                (height != 0 || heightFactor == other.heightFactor) &&
+                formatList == other.formatList &&
+                fsaa == other.fsaa && uav == other.uav && automipmaps == other.automipmaps &&
+                hwGammaWrite == other.hwGammaWrite && depthBufferId == other.depthBufferId &&
+                preferDepthTexture == other.preferDepthTexture &&
+                depthBufferFormat == other.depthBufferFormat &&
+                fsaaExplicitResolve == other.fsaaExplicitResolve;
+    }
+    //-----------------------------------------------------------------------------------
     size_t TextureDefinitionBase::getNumInputChannels(void) const
     {
         size_t numInputChannels = 0;
@@ -359,6 +375,37 @@ namespace Ogre
         return newChannel;
     }
     //-----------------------------------------------------------------------------------
+    size_t TextureDefinitionBase::getMemoryUsage( const CompositorChannel &channel )
+    {
+        size_t totalBytes = 0;
+
+        CompositorChannel::TextureVec::const_iterator itor = channel.textures.begin();
+        CompositorChannel::TextureVec::const_iterator end  = channel.textures.end();
+
+        while( itor != end )
+        {
+            const Texture *tex = itor->get();
+
+            uint32 depth  = 1u;
+            uint32 slices = 1u;
+            if( tex->getTextureType() == TEX_TYPE_3D )
+                depth = tex->getDepth();
+            else
+                slices = std::max<uint32>( tex->getDepth(), static_cast<uint32>( tex->getNumFaces() ) );
+
+            const uint8 numMipmaps = static_cast<uint8>(
+                        std::min<uint32>( tex->getNumMipmaps() + 1u, 255u ) );
+
+            totalBytes += PixelUtil::calculateSizeBytes( tex->getWidth(), tex->getHeight(),
+                                                         depth, slices, tex->getFormat(),
+                                                         numMipmaps ) *
+                          std::max( 1u, tex->getFSAA() );
+            ++itor;
+        }
+
+        return totalBytes;
+    }
+    //-----------------------------------------------------------------------------------
     void TextureDefinitionBase::destroyTextures( CompositorChannelVec &inOutTexContainer,
                                                  RenderSystem *renderSys )
     {
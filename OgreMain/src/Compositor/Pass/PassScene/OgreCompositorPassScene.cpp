@@ -326,6 +326,26 @@ namespace Ogre
         CompositorPass::_placeBarriersAndEmulateUavExecution( boundUavs, uavsAccess, resourcesLayout );
     }
     //-----------------------------------------------------------------------------------
+    void CompositorPassScene::_getCullFrustumPlanes( Plane outPlanes[6] ) const
+    {
+        //execute() only reorients mCamera, thus mCullCamera is affected when they're the same
+        const bool reorient = mDefinition->mCameraCubemapReorient && mCullCamera == mCamera;
+        const Quaternion oldCameraOrientation( mCullCamera->getOrientation() );
+
+        if( reorient )
+        {
+            uint32 sliceIdx = std::min<uint32>( mDefinition->getRtIndex(), 5 );
+            mCullCamera->setOrientation( oldCameraOrientation * CubemapRotations[sliceIdx] );
+        }
+
+        const Plane *frustumPlanes = mCullCamera->getFrustumPlanes();
+        for( size_t i=0; i<6; ++i )
+            outPlanes[i] = frustumPlanes[i];
+
+        if( reorient )
+            mCullCamera->setOrientation( oldCameraOrientation );
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorPassScene::notifyCleared(void)
     {
         mShadowNode = 0; //Allow changes to our shadow nodes too.
@@ -59,8 +59,10 @@ namespace Ogre
                             mMaxMemory( hintMaxNodes ),
                             mMaxHardLimit( maxHardLimit ),
                             mCleanupThreshold( cleanupThreshold ),
+                            mNumSortedAvailableSlots( 0 ),
                             mRebaseListener( rebaseListener ),
-                            mLevel( depthLevel )
+                            mLevel( depthLevel ),
+                            mCleanupsDeferred( false )
     {
         //If the assert triggers, their values will overflow to 0 when
         //trying to round to nearest multiple of ARRAY_PACKED_REALS
@@ -164,6 +166,7 @@ namespace Ogre
         {
             nextSlot = mAvailableSlots.back();
             mAvailableSlots.pop_back();
+            mNumSortedAvailableSlots = std::min( mNumSortedAvailableSlots, mAvailableSlots.size() );
             --mUsedMemory;
         }
 
@@ -176,48 +179,12 @@ namespace Ogre
                             "ArrayMemoryManager::createNewNode" );
             }
 
-            //Build the diff list for rebase later.
-            PtrdiffVec diffsList;
-            diffsList.reserve( mUsedMemory );
-            mRebaseListener->buildDiffList( mLevel, mMemoryPools, diffsList );
-
             //Reallocate, grow by 50% increments, rounding up to next multiple of ARRAY_PACKED_REALS
             size_t newMemory = std::min( mMaxMemory + (mMaxMemory >> 1), mMaxHardLimit );
             newMemory+= (ARRAY_PACKED_REALS - newMemory % ARRAY_PACKED_REALS) % ARRAY_PACKED_REALS;
             newMemory = std::min( newMemory, mMaxHardLimit );
 
-            size_t i=0;
-            MemoryPoolVec::iterator itor = mMemoryPools.begin();
-            MemoryPoolVec::iterator end  = mMemoryPools.end();
-
-            while( itor != end )
-            {
-                //Reallocate
-                char *tmp = (char*)OGRE_MALLOC_SIMD( newMemory * mElementsMemSizes[i],
-                                                     MEMCATEGORY_SCENE_OBJECTS );
-                memcpy( tmp, *itor, mMaxMemory * mElementsMemSizes[i] );
-                if( mInitRoutines && mInitRoutines[i] )
-                {
-                    mInitRoutines[i]( tmp + mMaxMemory * mElementsMemSizes[i], 0, 0, 0, 0,
-                                      newMemory - mMaxMemory, mElementsMemSizes[i] );
-                }
-                else
-                {
-                    memset( tmp + mMaxMemory * mElementsMemSizes[i], 0,
-                            (newMemory - mMaxMemory) * mElementsMemSizes[i] );
-                }
-                OGRE_FREE_SIMD( *itor, MEMCATEGORY_SCENE_OBJECTS );
-                *itor = tmp;
-                ++i;
-                ++itor;
-            }
-
-            const size_t prevNumSlots = mMaxMemory;
-            mMaxMemory = newMemory;
-            initializeEmptySlots( prevNumSlots );
-
-            //Rebase all ptrs
-            mRebaseListener->applyRebase( mLevel, mMemoryPools, diffsList );
+            growMemory( newMemory );
         }
 
         return nextSlot;
@@ -243,58 +210,243 @@ namespace Ogre
 
             //The pool is getting to big? Do some cleanup (depending
             //on fragmentation, may take a performance hit)
-            if( mAvailableSlots.size() > mCleanupThreshold )
+            if( mAvailableSlots.size() > mCleanupThreshold && !mCleanupsDeferred )
+                cleanupAvailableSlots();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ArrayMemoryManager::growMemory( size_t newMemory )
+    {
+        assert( newMemory > mMaxMemory && newMemory <= mMaxHardLimit );
+
+        //Build the diff list for rebase later.
+        PtrdiffVec diffsList;
+        diffsList.reserve( mUsedMemory );
+        mRebaseListener->buildDiffList( mLevel, mMemoryPools, diffsList );
+
+        size_t i=0;
+        MemoryPoolVec::iterator itor = mMemoryPools.begin();
+        MemoryPoolVec::iterator end  = mMemoryPools.end();
+
+        while( itor != end )
+        {
+            //Reallocate
+            char *tmp = (char*)OGRE_MALLOC_SIMD( newMemory * mElementsMemSizes[i],
+                                                 MEMCATEGORY_SCENE_OBJECTS );
+            memcpy( tmp, *itor, mMaxMemory * mElementsMemSizes[i] );
+            if( mInitRoutines && mInitRoutines[i] )
             {
-                //Sort, last values first. This may improve performance in some
-                //scenarios by reducing the amount of data to be shifted
-                std::sort( mAvailableSlots.begin(), mAvailableSlots.end(), std::greater<size_t>() );
-                SlotsVec::const_iterator itor = mAvailableSlots.begin();
-                SlotsVec::const_iterator end  = mAvailableSlots.end();
+                mInitRoutines[i]( tmp + mMaxMemory * mElementsMemSizes[i], 0, 0, 0, 0,
+                                  newMemory - mMaxMemory, mElementsMemSizes[i] );
+            }
+            else
+            {
+                memset( tmp + mMaxMemory * mElementsMemSizes[i], 0,
+                        (newMemory - mMaxMemory) * mElementsMemSizes[i] );
+            }
+            OGRE_FREE_SIMD( *itor, MEMCATEGORY_SCENE_OBJECTS );
+            *itor = tmp;
+            ++i;
+            ++itor;
+        }
+
+        const size_t prevNumSlots = mMaxMemory;
+        mMaxMemory = newMemory;
+        initializeEmptySlots( prevNumSlots );
+
+        //Rebase all ptrs
+        mRebaseListener->applyRebase( mLevel, mMemoryPools, diffsList );
+    }
+    //-----------------------------------------------------------------------------------
+    void ArrayMemoryManager::cleanupAvailableSlots(void)
+    {
+        //Sort, last values first. This may improve performance in some
+        //scenarios by reducing the amount of data to be shifted
+        std::sort( mAvailableSlots.begin(), mAvailableSlots.end(), std::greater<size_t>() );
+        SlotsVec::const_iterator itor = mAvailableSlots.begin();
+        SlotsVec::const_iterator end  = mAvailableSlots.end();
+
+        while( itor != end )
+        {
+            //First see if we have a continuous range of unused slots
+            size_t lastRange = 1;
+            SlotsVec::const_iterator it = itor + 1;
+            while( it != end && (*itor - lastRange) == *it )
+            {
+                ++lastRange;
+                ++it;
+            }
+
+            size_t i=0;
+            const size_t newEnd = *itor + 1;
+            MemoryPoolVec::iterator itPools = mMemoryPools.begin();
+            MemoryPoolVec::iterator enPools = mMemoryPools.end();
+
+            //Shift everything N slots (N = lastRange)
+            while( itPools != enPools )
+            {
+                char *dstPtr    = *itPools + ( newEnd - lastRange ) * mElementsMemSizes[i];
+                size_t indexDst = ( newEnd - lastRange ) % ARRAY_PACKED_REALS;
+                char *srcPtr    = *itPools + newEnd * mElementsMemSizes[i];
+                size_t indexSrc = newEnd % ARRAY_PACKED_REALS;
+                size_t numSlots = ( mUsedMemory - newEnd );
+                size_t numFreeSlots = lastRange;
+                mCleanupRoutines[i]( dstPtr, indexDst, srcPtr, indexSrc,
+                                     numSlots, numFreeSlots, mElementsMemSizes[i] );
+                ++i;
+                ++itPools;
+            }
+
+            mUsedMemory -= lastRange;
+            initializeEmptySlots( mUsedMemory );
+
+            mRebaseListener->performCleanup( mLevel, mMemoryPools,
+                                             mElementsMemSizes, (newEnd - lastRange),
+                                             lastRange );
 
-                while( itor != end )
+            itor += lastRange;
+        }
+
+        mAvailableSlots.clear();
+        mNumSortedAvailableSlots = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void ArrayMemoryManager::reserveSlots( size_t numSlots )
+    {
+        //createNewSlot reuses released slots first
+        if( numSlots <= mAvailableSlots.size() )
+            return;
+
+        size_t newMemory = mUsedMemory + (numSlots - mAvailableSlots.size()) +
+                           OGRE_PREFETCH_SLOT_DISTANCE;
+        newMemory+= (ARRAY_PACKED_REALS - newMemory % ARRAY_PACKED_REALS) % ARRAY_PACKED_REALS;
+        newMemory = std::min( newMemory, mMaxHardLimit );
+
+        if( newMemory > mMaxMemory )
+            growMemory( newMemory );
+    }
+    //-----------------------------------------------------------------------------------
+    void ArrayMemoryManager::setCleanupsDeferred( bool bDeferred )
+    {
+        mCleanupsDeferred = bDeferred;
+
+        if( !mCleanupsDeferred && mAvailableSlots.size() > mCleanupThreshold )
+            cleanupAvailableSlots();
+    }
+    //-----------------------------------------------------------------------------------
+    size_t ArrayMemoryManager::defragment( size_t maxSlotMoves )
+    {
+        if( mAvailableSlots.empty() )
+            return 0;
+
+        //Lowest holes first. The highest ones (at the back) may be at the end of the used memory.
+        //Only the slots released since the last call need sorting, then they get merged.
+        if( mNumSortedAvailableSlots < mAvailableSlots.size() )
+        {
+            SlotsVec::iterator firstUnsorted = mAvailableSlots.begin() + mNumSortedAvailableSlots;
+            std::sort( firstUnsorted, mAvailableSlots.end() );
+            std::inplace_merge( mAvailableSlots.begin(), firstUnsorted, mAvailableSlots.end() );
+        }
+
+        size_t numSlotMoves = 0;
+        size_t firstHole    = 0;
+        size_t lastHole     = mAvailableSlots.size();
+
+        while( firstHole < lastHole )
+        {
+            if( mAvailableSlots[lastHole - 1u] + 1u == mUsedMemory )
+            {
+                //The last used slot is a hole. Nothing to move.
+                --mUsedMemory;
+                --lastHole;
+            }
+            else if( numSlotMoves < maxSlotMoves )
+            {
+                //Move the last used slot into the lowest hole
+                const size_t dstSlot = mAvailableSlots[firstHole++];
+                const size_t srcSlot = mUsedMemory - 1u;
+
+                for( size_t i=0; i<mMemoryPools.size(); ++i )
                 {
-                    //First see if we have a continuous range of unused slots
-                    size_t lastRange = 1;
-                    SlotsVec::const_iterator it = itor + 1;
-                    while( it != end && (*itor - lastRange) == *it )
-                    {
-                        ++lastRange;
-                        ++it;
-                    }
-
-                    size_t i=0;
-                    const size_t newEnd = *itor + 1;
-                    MemoryPoolVec::iterator itPools = mMemoryPools.begin();
-                    MemoryPoolVec::iterator enPools = mMemoryPools.end();
-
-                    //Shift everything N slots (N = lastRange)
-                    while( itPools != enPools )
-                    {
-                        char *dstPtr    = *itPools + ( newEnd - lastRange ) * mElementsMemSizes[i];
-                        size_t indexDst = ( newEnd - lastRange ) % ARRAY_PACKED_REALS;
-                        char *srcPtr    = *itPools + newEnd * mElementsMemSizes[i];
-                        size_t indexSrc = newEnd % ARRAY_PACKED_REALS;
-                        size_t numSlots = ( mUsedMemory - newEnd );
-                        size_t numFreeSlots = lastRange;
-                        mCleanupRoutines[i]( dstPtr, indexDst, srcPtr, indexSrc,
-                                             numSlots, numFreeSlots, mElementsMemSizes[i] );
-                        ++i;
-                        ++itPools;
-                    }
-
-                    mUsedMemory -= lastRange;
-                    initializeEmptySlots( mUsedMemory );
-
-                    mRebaseListener->performCleanup( mLevel, mMemoryPools,
-                                                     mElementsMemSizes, (newEnd - lastRange),
-                                                     lastRange );
-                    
-                    itor += lastRange;
+                    char *dstPtr = mMemoryPools[i] + dstSlot * mElementsMemSizes[i];
+                    char *srcPtr = mMemoryPools[i] + srcSlot * mElementsMemSizes[i];
+
+                    mCleanupRoutines[i]( dstPtr, dstSlot % ARRAY_PACKED_REALS,
+                                         srcPtr, srcSlot % ARRAY_PACKED_REALS,
+                                         1u, 0u, mElementsMemSizes[i] );
+                    //Default-initialize the slot we left behind
+                    mCleanupRoutines[i]( srcPtr, srcSlot % ARRAY_PACKED_REALS,
+                                         srcPtr, srcSlot % ARRAY_PACKED_REALS,
+                                         0u, 1u, mElementsMemSizes[i] );
                 }
 
-                mAvailableSlots.clear();
+                --mUsedMemory;
+                ++numSlotMoves;
+
+                mRebaseListener->performSlotMove( mLevel, mMemoryPools, dstSlot );
             }
+            else
+            {
+                break;
+            }
+        }
+
+        mAvailableSlots.erase( mAvailableSlots.begin() + lastHole, mAvailableSlots.end() );
+        mAvailableSlots.erase( mAvailableSlots.begin(), mAvailableSlots.begin() + firstHole );
+        mNumSortedAvailableSlots = mAvailableSlots.size();
+
+        initializeEmptySlots( mUsedMemory );
+
+        return numSlotMoves;
+    }
+    //-----------------------------------------------------------------------------------
+    void ArrayMemoryManager::permuteSlots( const size_t *newOrder )
+    {
+        std::vector<bool> isHole( mUsedMemory, false );
+        SlotsVec::const_iterator itor = mAvailableSlots.begin();
+        SlotsVec::const_iterator end  = mAvailableSlots.end();
+
+        while( itor != end )
+            isHole[*itor++] = true;
+
+        size_t i=0;
+        MemoryPoolVec::iterator itPools = mMemoryPools.begin();
+        MemoryPoolVec::iterator enPools = mMemoryPools.end();
+
+        while( itPools != enPools )
+        {
+            char *tmp = (char*)OGRE_MALLOC_SIMD( mMaxMemory * mElementsMemSizes[i],
+                                                 MEMCATEGORY_SCENE_OBJECTS );
+            //Unused slots keep their default values
+            memcpy( tmp, *itPools, mMaxMemory * mElementsMemSizes[i] );
+
+            for( size_t dstSlot=0; dstSlot<mUsedMemory; ++dstSlot )
+            {
+                const size_t srcSlot = newOrder[dstSlot];
+                assert( srcSlot < mUsedMemory );
+                mCleanupRoutines[i]( tmp + dstSlot * mElementsMemSizes[i],
+                                     dstSlot % ARRAY_PACKED_REALS,
+                                     *itPools + srcSlot * mElementsMemSizes[i],
+                                     srcSlot % ARRAY_PACKED_REALS,
+                                     1u, 0u, mElementsMemSizes[i] );
+            }
+
+            OGRE_FREE_SIMD( *itPools, MEMCATEGORY_SCENE_OBJECTS );
+            *itPools = tmp;
+            ++i;
+            ++itPools;
+        }
+
+        //All live slots have moved to new memory (even those that kept their index)
+        mAvailableSlots.clear();
+        for( size_t dstSlot=0; dstSlot<mUsedMemory; ++dstSlot )
+        {
+            if( isHole[newOrder[dstSlot]] )
+                mAvailableSlots.push_back( dstSlot );
+            else
+                mRebaseListener->performSlotMove( mLevel, mMemoryPools, dstSlot );
         }
+        mNumSortedAvailableSlots = mAvailableSlots.size();
     }
     //-----------------------------------------------------------------------------------
     void cleanerFlat( char *dstPtr, size_t indexDst, char *srcPtr, size_t indexSrc,
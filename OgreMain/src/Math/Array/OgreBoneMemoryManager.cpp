@@ -32,6 +32,7 @@ THE SOFTWARE.
 
 #include "Animation/OgreBone.h"
 #include "Animation/OgreSkeletonAnimManager.h"
+#include "OgreException.h"
 
 namespace Ogre
 {
@@ -256,4 +257,13 @@ namespace Ogre
         if( mBoneRebaseListener )
             mBoneRebaseListener->_updateBoneStartTransforms();
     }
+    //---------------------------------------------------------------------
+    void BoneMemoryManager::performSlotMove( uint16, const MemoryPoolVec&, size_t )
+    {
+        //Bones from the same skeleton instance must be contiguous (see
+        //_updateBoneStartTransforms), they can't be reordered.
+        OGRE_EXCEPT( Exception::ERR_INVALID_CALL,
+                     "Bones can't be defragmented incrementally",
+                     "BoneMemoryManager::performSlotMove" );
+    }
 }
@@ -37,7 +37,8 @@ namespace Ogre
     NodeMemoryManager::NodeMemoryManager() :
             mDummyNode( 0 ),
             mMemoryManagerType( SCENE_DYNAMIC ),
-            mTwinMemoryManager( 0 )
+            mTwinMemoryManager( 0 ),
+            mCleanupsDeferred( false )
     {
         //Manually allocate the memory for the dummy scene nodes (since we can't pass ourselves
         //or yet another object) We only allocate what's needed to prevent access violations.
@@ -121,9 +122,54 @@ namespace Ogre
                                                                 ArrayMemoryManager::MAX_MEMORY_SLOTS,
                                                                 this ) );
             mMemoryManagers.back().initialize();
+            mMemoryManagers.back().setCleanupsDeferred( mCleanupsDeferred );
         }
     }
     //-----------------------------------------------------------------------------------
+    void NodeMemoryManager::reserve( size_t depth, size_t numNodes )
+    {
+        growToDepth( depth );
+        mMemoryManagers[depth].reserveSlots( numNodes );
+    }
+    //-----------------------------------------------------------------------------------
+    void NodeMemoryManager::setCleanupsDeferred( bool bDeferred )
+    {
+        mCleanupsDeferred = bDeferred;
+
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end )
+        {
+            itor->setCleanupsDeferred( bDeferred );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    size_t NodeMemoryManager::defragment( size_t maxSlotMoves )
+    {
+        size_t numSlotMoves = 0;
+
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end )
+        {
+            numSlotMoves += itor->defragment( maxSlotMoves - numSlotMoves );
+            ++itor;
+        }
+
+        return numSlotMoves;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t NodeMemoryManager::getWastedMemory( size_t depth ) const
+    {
+        size_t retVal = 0;
+        if( depth < mMemoryManagers.size() )
+            retVal = mMemoryManagers[depth].getWastedMemory();
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
     void NodeMemoryManager::nodeCreated( Transform &outTransform, size_t depth )
     {
         growToDepth( depth );
@@ -306,4 +352,19 @@ namespace Ogre
             transform.advancePack();
         }
     }
+    //---------------------------------------------------------------------
+    void NodeMemoryManager::performSlotMove( uint16 level, const MemoryPoolVec &basePtrs,
+                                             size_t dstInstance )
+    {
+        Transform transform;
+        this->getFirstNode( transform, level );
+
+        transform.advancePack( dstInstance / ARRAY_PACKED_REALS );
+        transform.mIndex = dstInstance % ARRAY_PACKED_REALS;
+
+        Node *owner = transform.mOwner[transform.mIndex];
+        assert( owner && "Moved an empty slot!" );
+        owner->_getTransform() = transform;
+        owner->_callMemoryChangeListeners();
+    }
 }
@@ -34,12 +34,23 @@ THE SOFTWARE.
 
 namespace Ogre
 {
+    /// Spreads the lower 10 bits of v so that there are two zero bits between each of them.
+    static uint32 expandBitsForMorton( uint32 v )
+    {
+        v = (v | (v << 16u)) & 0x030000FF;
+        v = (v | (v <<  8u)) & 0x0300F00F;
+        v = (v | (v <<  4u)) & 0x030C30C3;
+        v = (v | (v <<  2u)) & 0x09249249;
+        return v;
+    }
+    //-----------------------------------------------------------------------------------
     ObjectMemoryManager::ObjectMemoryManager() :
             mTotalObjects( 0 ),
             mDummyNode( 0 ),
             mDummyObject( 0 ),
             mMemoryManagerType( SCENE_DYNAMIC ),
-            mTwinMemoryManager( 0 )
+            mTwinMemoryManager( 0 ),
+            mCleanupsDeferred( false )
     {
         //Manually allocate the memory for the dummy scene nodes (since we can't pass ourselves
         //or yet another object) We only allocate what's needed to prevent access violations.
@@ -124,6 +135,142 @@ namespace Ogre
                                             mDummyNode, mDummyObject, 100,
                                             ArrayMemoryManager::MAX_MEMORY_SLOTS, this ) );
             mMemoryManagers.back().initialize();
+            mMemoryManagers.back().setCleanupsDeferred( mCleanupsDeferred );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectMemoryManager::reserve( size_t renderQueue, size_t numObjects )
+    {
+        growToDepth( renderQueue );
+        mMemoryManagers[renderQueue].reserveSlots( numObjects );
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectMemoryManager::setCleanupsDeferred( bool bDeferred )
+    {
+        mCleanupsDeferred = bDeferred;
+
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end )
+        {
+            itor->setCleanupsDeferred( bDeferred );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    size_t ObjectMemoryManager::defragment( size_t maxSlotMoves )
+    {
+        size_t numSlotMoves = 0;
+
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end )
+        {
+            numSlotMoves += itor->defragment( maxSlotMoves - numSlotMoves );
+            ++itor;
+        }
+
+        return numSlotMoves;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t ObjectMemoryManager::getWastedMemory( size_t renderQueue ) const
+    {
+        size_t retVal = 0;
+        if( renderQueue < mMemoryManagers.size() )
+            retVal = mMemoryManagers[renderQueue].getWastedMemory();
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectMemoryManager::sortSpatially(void)
+    {
+        //Morton codes use 30 bits. Keys for objects that can't be
+        //sorted are above that, so that they end up last.
+        const uint32 c_infiniteKey  = 0x40000000;
+        const uint32 c_holeKey      = 0x80000000;
+
+        vector<uint64>::type keys;
+        vector<size_t>::type newOrder;
+        vector<Vector3>::type centres;
+
+        for( size_t i=0; i<mMemoryManagers.size(); ++i )
+        {
+            ObjectData objData;
+            const size_t numObjs = this->getFirstObjectData( objData, i );
+
+            if( numObjs <= ARRAY_PACKED_REALS )
+                continue;
+
+            centres.resize( numObjs );
+            keys.resize( numObjs );
+
+            const Real c_inf = std::numeric_limits<Real>::infinity();
+            Vector3 boundsMin( c_inf, c_inf, c_inf );
+            Vector3 boundsMax( -c_inf, -c_inf, -c_inf );
+
+            for( size_t j=0; j<numObjs; j += ARRAY_PACKED_REALS )
+            {
+                //The last pack may be partially used
+                const size_t numObjsInPack = std::min<size_t>( ARRAY_PACKED_REALS, numObjs - j );
+                for( size_t k=0; k<numObjsInPack; ++k )
+                {
+                    Aabb aabb;
+                    objData.mWorldAabb->getAsAabb( aabb, k );
+                    centres[j+k] = aabb.mCenter;
+
+                    if( objData.mOwner[k] == mDummyObject )
+                        keys[j+k] = c_holeKey;
+                    else if( aabb.mHalfSize.x == c_inf || aabb.mHalfSize.y == c_inf ||
+                             aabb.mHalfSize.z == c_inf || aabb.mCenter.isNaN() )
+                        keys[j+k] = c_infiniteKey;
+                    else
+                    {
+                        keys[j+k] = 0;
+                        boundsMin.makeFloor( aabb.mCenter );
+                        boundsMax.makeCeil( aabb.mCenter );
+                    }
+                }
+
+                objData.advancePack();
+            }
+
+            //Quantize the centres to 10 bits per axis within the bounds of all of them
+            Vector3 scale = boundsMax - boundsMin;
+            for( size_t j=0; j<3; ++j )
+                scale[j] = scale[j] > Real( 0 ) ? Real( 1023 ) / scale[j] : Real( 0 );
+
+            newOrder.resize( numObjs );
+
+            for( size_t j=0; j<numObjs; ++j )
+            {
+                if( !keys[j] )
+                {
+                    const Vector3 quantized = ( centres[j] - boundsMin ) * scale;
+                    keys[j] = ( expandBitsForMorton( static_cast<uint32>( quantized.x ) ) << 2u ) |
+                              ( expandBitsForMorton( static_cast<uint32>( quantized.y ) ) << 1u ) |
+                                expandBitsForMorton( static_cast<uint32>( quantized.z ) );
+                }
+
+                //Keep the slot in the lower bits, so that sorting is stable
+                keys[j] = ( keys[j] << 32u ) | static_cast<uint64>( j );
+            }
+
+            std::sort( keys.begin(), keys.end() );
+
+            bool alreadySorted = true;
+            for( size_t j=0; j<numObjs; ++j )
+            {
+                newOrder[j] = static_cast<size_t>( keys[j] & 0xFFFFFFFF );
+                alreadySorted &= newOrder[j] == j;
+            }
+
+            if( !alreadySorted )
+            {
+                mMemoryManagers[i].permuteSlots( &newOrder[0] );
+                //Holes are now at the end; release them.
+                mMemoryManagers[i].defragment( 0 );
+            }
         }
     }
     //-----------------------------------------------------------------------------------
@@ -277,4 +424,18 @@ namespace Ogre
             objectData.advancePack();
         }
     }
+    //---------------------------------------------------------------------
+    void ObjectMemoryManager::performSlotMove( uint16 level, const MemoryPoolVec &basePtrs,
+                                               size_t dstInstance )
+    {
+        ObjectData objectData;
+        this->getFirstObjectData( objectData, level );
+
+        objectData.advancePack( dstInstance / ARRAY_PACKED_REALS );
+        objectData.mIndex = dstInstance % ARRAY_PACKED_REALS;
+
+        MovableObject *owner = objectData.mOwner[objectData.mIndex];
+        assert( owner && owner != mDummyObject && "Moved an empty slot!" );
+        owner->_getObjectData() = objectData;
+    }
 }
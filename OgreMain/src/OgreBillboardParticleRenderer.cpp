@@ -131,16 +131,42 @@ namespace v1 {
     }
     //-----------------------------------------------------------------------
     void BillboardParticleRenderer::_updateRenderQueue(RenderQueue* queue, Camera *camera,
-        const Camera *lodCamera, list<Particle*>::type& currentParticles, bool cullIndividually,
+        const Camera *lodCamera, vector<Particle*>::type& currentParticles, bool cullIndividually,
         RenderableArray &outRenderables )
+    {
+        _updateRenderQueueDeferred( queue, camera, lodCamera, currentParticles,
+                                    cullIndividually, outRenderables );
+        _generateGeometry( camera, currentParticles );
+        _finishGeometry();
+    }
+    //-----------------------------------------------------------------------
+    bool BillboardParticleRenderer::_updateRenderQueueDeferred( RenderQueue *queue, Camera *camera,
+                                                                const Camera *lodCamera,
+                                                                vector<Particle*>::type &currentParticles,
+                                                                bool cullIndividually,
+                                                                RenderableArray &outRenderables )
     {
         mBillboardSet->setCullIndividually(cullIndividually);
         mBillboardSet->_notifyCurrentCamera( lodCamera );
 
-        // Update billboard set geometry
+        // Reserve the vertex buffer range; the billboards get written by _generateGeometry
         mBillboardSet->beginBillboards(currentParticles.size());
+
+        // Update the queue
+        mBillboardSet->_updateRenderQueueImpl(queue, camera, lodCamera);
+
+        outRenderables.clear();
+        outRenderables.push_back( mBillboardSet );
+
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    void BillboardParticleRenderer::_generateGeometry( const Camera *camera,
+                                                       const vector<Particle*>::type &currentParticles )
+    {
+        // Update billboard set geometry
         Billboard bb;
-        for (list<Particle*>::type::iterator i = currentParticles.begin();
+        for (vector<Particle*>::type::const_iterator i = currentParticles.begin();
             i != currentParticles.end(); ++i)
         {
             Particle* p = *i;
@@ -163,14 +189,11 @@ namespace v1 {
             mBillboardSet->injectBillboard(bb, camera);
 
         }
-        
+    }
+    //-----------------------------------------------------------------------
+    void BillboardParticleRenderer::_finishGeometry(void)
+    {
         mBillboardSet->endBillboards();
-
-        // Update the queue
-        mBillboardSet->_updateRenderQueueImpl(queue, camera, lodCamera);
-
-        outRenderables.clear();
-        outRenderables.push_back( mBillboardSet );
     }
     //-----------------------------------------------------------------------
     void BillboardParticleRenderer::_setDatablock( HlmsDatablock *datablock )
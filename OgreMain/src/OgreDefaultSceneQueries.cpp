@@ -32,11 +32,381 @@ THE SOFTWARE.
 #include "Math/Array/OgreMathlib.h"
 #include "Math/Array/OgreArraySphere.h"
 #include "Math/Array/OgreBooleanMask.h"
+#include "OgreRawPtr.h"
+#include "Threading/OgreUniformScalableTask.h"
 
 namespace Ogre {
+    namespace
+    {
+        /// Below this many candidates the sweep runs in the calling thread only.
+        const size_t c_minCandidatesForThreadedSweep = 1024u;
+        /// Candidates are handed to threads in interleaved blocks of this size, as the
+        /// cost of each one depends on how many objects overlap it along X.
+        const size_t c_sweepBlockSize = 64u;
+
+        /** The sweep compares centre -/+ half size, while ArrayAabb::intersects compares
+            centre distances. They round differently, so boxes that barely touch could be
+            pruned before being tested. Widening the X range by a few ulps avoids that.
+        */
+        inline Real getSweepSlack( const Aabb &aabb )
+        {
+            return ( Math::Abs( aabb.mCenter.x ) + aabb.mHalfSize.x ) *
+                    ( 4.0f * std::numeric_limits<Real>::epsilon() );
+        }
+
+        class IntersectionSweepTask : public UniformScalableTask
+        {
+        public:
+            DefaultIntersectionSceneQuery *query;
+
+            virtual void execute( size_t threadId, size_t numThreads )
+            {
+                query->_sweep( threadId, numThreads );
+            }
+        };
+
+        /// Below this many queries a batch runs in the calling thread only.
+        const size_t c_minQueriesForThreadedBatch = 64u;
+        /// Queries are tested against all objects in tiles of this size, so that the
+        /// query packs of a tile stay in cache while the objects are streamed.
+        const size_t c_batchQueryTileSize = 128u;
+
+        /// ARRAY_PACKED_REALS rays in SoA form, one ray per lane.
+        struct ArrayRay
+        {
+            ArrayVector3    origin;
+            ArrayVector3    direction;
+        };
+
+        /** Each policy transposes ARRAY_PACKED_REALS queries into SoA form (QueryPack),
+            splats a single object to all lanes (ObjectType), and tests the object against
+            the pack of queries with the exact same math as the query's own execute(),
+            so that the batched results match running the queries one by one.
+        */
+        struct RayBatchPolicy
+        {
+            typedef Ray         SourceType;
+            typedef ArrayRay    QueryPack;
+            typedef ArrayAabb   ObjectType;
+
+            static void loadQuery( const Ray &ray, ArrayRay &outPack, size_t lane )
+            {
+                outPack.origin.setFromVector3( ray.getOrigin(), lane );
+                outPack.direction.setFromVector3( ray.getDirection(), lane );
+            }
+
+            static void loadObject( const ObjectData &objData, size_t lane, ArrayAabb &outObject )
+            {
+                outObject.setAll( objData.mWorldAabb->getAsAabb( lane ) );
+            }
+
+            /// See DefaultRaySceneQuery::execute
+            static ArrayMaskR test( const ArrayRay &rays, const ArrayAabb &aabb,
+                                    ArrayReal &outDistance )
+            {
+                // Check origin inside first
+                ArrayMaskR hitMaskR = aabb.contains( rays.origin );
+
+                ArrayReal distance = Mathlib::CmovRobust( ARRAY_REAL_ZERO, Mathlib::INFINITEA,
+                                                          hitMaskR );
+
+                const ArrayVector3 vMin = aabb.getMinimum();
+                const ArrayVector3 vMax = aabb.getMaximum();
+
+                // Check each face in turn
+                for( size_t i=0; i<2; ++i )
+                {
+                    const ArrayVector3 &vPlane = i == 0 ? vMin : vMax;
+                    for( size_t j=0; j<3; ++j )
+                    {
+                        ArrayReal t = (vPlane.mChunkBase[j] - rays.origin.mChunkBase[j]) /
+                                        rays.direction.mChunkBase[j];
+
+                        //mask = t >= 0; works even if t is nan (t = 0 / 0)
+                        ArrayMaskR mask = Mathlib::CompareGreaterEqual( t, ARRAY_REAL_ZERO );
+                        ArrayVector3 hitPoint = rays.origin + rays.direction * t;
+
+                        hitPoint.mChunkBase[j] = aabb.mCenter.mChunkBase[j];
+
+                        hitMaskR = Mathlib::Or( hitMaskR, Mathlib::And( mask,
+                                                            aabb.contains( hitPoint ) ) );
+                        distance = Mathlib::CmovRobust( Mathlib::Min( distance, t ), distance, mask );
+                    }
+                }
+
+                outDistance = distance;
+                return hitMaskR;
+            }
+        };
+
+        struct SphereBatchPolicy
+        {
+            typedef Sphere      SourceType;
+            typedef ArraySphere QueryPack;
+            typedef ArraySphere ObjectType;
+
+            static void loadQuery( const Sphere &sphere, ArraySphere &outPack, size_t lane )
+            {
+                outPack.setFromSphere( sphere, lane );
+            }
+
+            static void loadObject( const ObjectData &objData, size_t lane, ArraySphere &outObject )
+            {
+                outObject.setAll( Sphere( objData.mWorldAabb->getAsAabb( lane ).mCenter,
+                                          objData.mWorldRadius[lane] ) );
+            }
+
+            /// See DefaultSphereSceneQuery::execute
+            static ArrayMaskR test( const ArraySphere &spheres, const ArraySphere &object,
+                                    ArrayReal &outDistance )
+            {
+                outDistance = ARRAY_REAL_ZERO;
+                return spheres.intersects( object );
+            }
+        };
+
+        struct AabbBatchPolicy
+        {
+            typedef AxisAlignedBox  SourceType;
+            typedef ArrayAabb       QueryPack;
+            typedef ArrayAabb       ObjectType;
+
+            static void loadQuery( const AxisAlignedBox &box, ArrayAabb &outPack, size_t lane )
+            {
+                outPack.setFromAabb( Aabb::newFromExtents( box.getMinimum(), box.getMaximum() ),
+                                     lane );
+            }
+
+            static void loadObject( const ObjectData &objData, size_t lane, ArrayAabb &outObject )
+            {
+                outObject.setAll( objData.mWorldAabb->getAsAabb( lane ) );
+            }
+
+            /// See DefaultAxisAlignedBoxSceneQuery::execute
+            static ArrayMaskR test( const ArrayAabb &boxes, const ArrayAabb &object,
+                                    ArrayReal &outDistance )
+            {
+                outDistance = ARRAY_REAL_ZERO;
+                return boxes.intersects( object );
+            }
+        };
+
+        /** Evaluates a range of batched queries against every object in the scene.
+            Each thread owns a contiguous range of query packs (and their output), so no
+            synchronization is needed and results don't depend on the number of threads.
+        */
+        template <typename T>
+        class BatchedSceneQueryTask : public UniformScalableTask
+        {
+        public:
+            typedef typename T::QueryPack   QueryPack;
+            typedef typename T::ObjectType  ObjectType;
+
+            SceneManager            *sceneManager;
+            QueryPack const         *queryPacks;
+            size_t                  numQueries;
+            uint32                  queryMask;
+            uint8                   firstRq;
+            uint8                   lastRq;
+            /// Max results per query, <= output.maxResultsPerQuery.
+            uint32                  maxResults;
+            bool                    sortByDistance;
+            SceneQueryBatchOutput   output;
+
+            virtual void execute( size_t threadId, size_t numThreads )
+            {
+                const size_t numPacks = (numQueries + ARRAY_PACKED_REALS - 1u) / ARRAY_PACKED_REALS;
+                const size_t packsPerThread = (numPacks + numThreads - 1u) / numThreads;
+                const size_t packStart = std::min( threadId * packsPerThread, numPacks );
+                const size_t packEnd   = std::min( packStart + packsPerThread, numPacks );
+
+                if( packStart == packEnd )
+                    return;
+
+                const size_t qStart = packStart * ARRAY_PACKED_REALS;
+                const size_t qEnd   = std::min( packEnd * ARRAY_PACKED_REALS, numQueries );
+                memset( output.numResults + qStart, 0, (qEnd - qStart) * sizeof(uint32) );
+
+                const size_t packsPerTile = c_batchQueryTileSize / ARRAY_PACKED_REALS;
+
+                for( size_t tileStart=packStart; tileStart<packEnd; tileStart += packsPerTile )
+                {
+                    const size_t tileEnd = std::min( tileStart + packsPerTile, packEnd );
+
+                    for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+                    {
+                        ObjectMemoryManager &memoryManager = sceneManager->_getEntityMemoryManager(
+                                                                static_cast<SceneMemoryMgrTypes>(i) );
+
+                        const size_t numRenderQueues = memoryManager.getNumRenderQueues();
+
+                        size_t firstRqIdx = std::min<size_t>( firstRq, numRenderQueues );
+                        size_t lastRqIdx  = std::min<size_t>( lastRq,  numRenderQueues );
+
+                        for( size_t j=firstRqIdx; j<lastRqIdx; ++j )
+                        {
+                            ObjectData objData;
+                            const size_t totalObjs = memoryManager.getFirstObjectData( objData, j );
+                            execute( objData, totalObjs, tileStart, tileEnd );
+                        }
+                    }
+                }
+            }
+
+            void execute( ObjectData objData, size_t numNodes, size_t packStart, size_t packEnd )
+            {
+                ArrayInt ourQueryMask = Mathlib::SetAll( queryMask );
+
+                for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+                {
+                    ArrayInt * RESTRICT_ALIAS visibilityFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
+                                                                        (objData.mVisibilityFlags);
+                    ArrayInt * RESTRICT_ALIAS queryFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
+                                                                        (objData.mQueryFlags);
+
+                    //passMask = ( (*queryFlags & ourQueryMask) != 0 ) && isVisble;
+                    ArrayMaskI passMask = Mathlib::TestFlags4( *queryFlags, ourQueryMask );
+                    passMask = Mathlib::And( passMask,
+                                             Mathlib::TestFlags4( *visibilityFlags,
+                                                Mathlib::SetAll( VisibilityFlags::LAYER_VISIBILITY ) ) );
+
+                    const uint32 scalarPassMask = BooleanMask4::getScalarMask( passMask );
+
+                    for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+                    {
+                        //There's no need to check objData.mOwner[j] is null because
+                        //we set mVisibilityFlags to 0 on slot removals
+                        if( !IS_BIT_SET( j, scalarPassMask ) )
+                            continue;
+
+#if OGRE_DEBUG_MODE
+                        //Queries must be performed after all bounds have been updated
+                        //(i.e. SceneManager::updateSceneGraph does this for you), and don't
+                        //move the objects between that call and this query.
+                        assert( !objData.mOwner[j]->isCachedAabbOutOfDate() &&
+                                "Perform the queries after MovableObject::updateAllBounds has been called!");
+#endif
+
+                        ObjectType object;
+                        T::loadObject( objData, j, object );
+
+                        for( size_t p=packStart; p<packEnd; ++p )
+                        {
+                            ArrayReal distance;
+                            const uint32 scalarMask = BooleanMask4::getScalarMask(
+                                                            T::test( queryPacks[p], object, distance ) );
+                            if( scalarMask )
+                                addResults( p, objData.mOwner[j], scalarMask, distance );
+                        }
+                    }
+
+                    objData.advancePack();
+                }
+            }
+
+            /// Adds the object to every query of the pack set in scalarMask.
+            void addResults( size_t packIdx, MovableObject *movable,
+                             uint32 scalarMask, ArrayReal distance )
+            {
+                OGRE_ALIGNED_DECL( Real, scalarDistance[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+                CastArrayToReal( scalarDistance, distance );
+
+                const size_t numLanes = std::min<size_t>( ARRAY_PACKED_REALS,
+                                                          numQueries - packIdx * ARRAY_PACKED_REALS );
+
+                for( size_t lane=0; lane<numLanes; ++lane )
+                {
+                    if( !IS_BIT_SET( lane, scalarMask ) )
+                        continue;
+
+                    const size_t queryIdx = packIdx * ARRAY_PACKED_REALS + lane;
+                    SceneQueryBatchResult * RESTRICT_ALIAS results = output.results +
+                                                                     queryIdx * output.maxResultsPerQuery;
+                    uint32 numResults = output.numResults[queryIdx];
+                    const Real hitDistance = scalarDistance[lane];
+
+                    if( !sortByDistance )
+                    {
+                        if( numResults < maxResults )
+                        {
+                            results[numResults].movable  = movable;
+                            results[numResults].distance = hitDistance;
+                            ++numResults;
+                        }
+                    }
+                    else
+                    {
+                        //Keep the nearest maxResults hits, sorted (insertion sort;
+                        //maxResults is expected to be small).
+                        if( numResults == maxResults )
+                        {
+                            if( !maxResults || hitDistance >= results[numResults-1u].distance )
+                                continue;
+                            --numResults;
+                        }
+
+                        uint32 k = numResults;
+                        while( k > 0 && results[k-1u].distance > hitDistance )
+                        {
+                            results[k] = results[k-1u];
+                            --k;
+                        }
+
+                        results[k].movable  = movable;
+                        results[k].distance = hitDistance;
+                        ++numResults;
+                    }
+
+                    output.numResults[queryIdx] = numResults;
+                }
+            }
+        };
+
+        template <typename T>
+        void executeBatchedSceneQuery( SceneManager *sceneManager, const SceneQuery &query,
+                                       const typename T::SourceType *srcQueries, size_t numQueries,
+                                       const SceneQueryBatchOutput &output,
+                                       uint32 maxResults, bool sortByDistance )
+        {
+            assert( query.mFirstRq < query.mLastRq &&
+                    "This query will never hit any result!" );
+
+            if( !numQueries )
+                return;
+
+            //Transpose the queries into SoA packs. The unused lanes of the last pack
+            //repeat the last query; their results are never written.
+            const size_t numPacks = (numQueries + ARRAY_PACKED_REALS - 1u) / ARRAY_PACKED_REALS;
+            RawSimdUniquePtr<typename T::QueryPack, MEMCATEGORY_SCENE_OBJECTS> simdQueries( numPacks );
+            typename T::QueryPack * RESTRICT_ALIAS queryPacks = simdQueries.get();
+            for( size_t i=0; i<numPacks * ARRAY_PACKED_REALS; ++i )
+            {
+                T::loadQuery( srcQueries[std::min( i, numQueries - 1u )],
+                              queryPacks[i / ARRAY_PACKED_REALS], i % ARRAY_PACKED_REALS );
+            }
+
+            BatchedSceneQueryTask<T> task;
+            task.sceneManager   = sceneManager;
+            task.queryPacks     = queryPacks;
+            task.numQueries     = numQueries;
+            task.queryMask      = query.getQueryMask();
+            task.firstRq        = query.mFirstRq;
+            task.lastRq         = query.mLastRq;
+            task.maxResults     = std::min( maxResults, output.maxResultsPerQuery );
+            task.sortByDistance = sortByDistance;
+            task.output         = output;
+
+            if( numQueries >= c_minQueriesForThreadedBatch && sceneManager->getNumWorkerThreads() > 1u )
+                sceneManager->executeUserScalableTask( &task, true );
+            else
+                task.execute( 0, 1u );
+        }
+    }
     //---------------------------------------------------------------------
     DefaultIntersectionSceneQuery::DefaultIntersectionSceneQuery(SceneManager* creator)
-    : IntersectionSceneQuery(creator)
+    : IntersectionSceneQuery(creator),
+      mSortedAabbs( 0 ),
+      mSortedAabbsCapacity( 0 )
     {
         // No world geometry results supported
         mSupportedWorldFragments.insert(SceneQuery::WFT_NONE);
@@ -44,89 +414,209 @@ namespace Ogre {
     //---------------------------------------------------------------------
     DefaultIntersectionSceneQuery::~DefaultIntersectionSceneQuery()
     {
+        if( mSortedAabbs )
+        {
+            OGRE_FREE_SIMD( mSortedAabbs, MEMCATEGORY_SCENE_OBJECTS );
+            mSortedAabbs = 0;
+        }
     }
     //---------------------------------------------------------------------
     void DefaultIntersectionSceneQuery::execute(IntersectionSceneQueryListener* listener)
     {
-        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
-                     "IntersectionSceneQuery not yet ported to Ogre 2.x!",
-                     "DefaultIntersectionSceneQuery::execute");
-#ifdef ENABLE_INCOMPATIBLE_OGRE_2_0
-        // Iterate over all movable types
-        Root::MovableObjectFactoryIterator factIt = 
-            Root::getSingleton().getMovableObjectFactoryIterator();
-        while(factIt.hasMoreElements())
+        assert( mFirstRq < mLastRq && "This query will never hit any result!" );
+
+        mGatheredAabbs.clear();
+        mGatheredOwners.clear();
+
+        for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
         {
-            SceneManager::MovableObjectIterator objItA = 
-                mParentSceneMgr->getMovableObjectIterator(
-                    factIt.getNext()->getType());
-            while (objItA.hasMoreElements())
+            ObjectMemoryManager &memoryManager = mParentSceneMgr->_getEntityMemoryManager(
+                                                        static_cast<SceneMemoryMgrTypes>(i) );
+
+            const size_t numRenderQueues = memoryManager.getNumRenderQueues();
+
+            size_t firstRq = std::min<size_t>( mFirstRq, numRenderQueues );
+            size_t lastRq  = std::min<size_t>( mLastRq,  numRenderQueues );
+
+            for( size_t j=firstRq; j<lastRq; ++j )
             {
-                MovableObject* a = objItA.getNext();
-                // skip entire section if type doesn't match
-                if (!(a->getTypeFlags() & mQueryTypeMask))
-                    break;
-
-                // Skip if a does not pass the mask
-                if (!(a->getQueryFlags() & mQueryMask) ||
-                    !a->isInScene())
-                    continue;
-
-                // Check against later objects in the same group
-                SceneManager::MovableObjectIterator objItB = objItA;
-                while (objItB.hasMoreElements())
-                {
-                    MovableObject* b = objItB.getNext();
+                ObjectData objData;
+                const size_t totalObjs = memoryManager.getFirstObjectData( objData, j );
+                gatherCandidates( objData, totalObjs );
+            }
+        }
 
-                    // Apply mask to b (both must pass)
-                    if ((b->getQueryFlags() & mQueryMask) && 
-                        b->isInScene())
-                    {
-                        const AxisAlignedBox& box1 = a->getWorldBoundingBox();
-                        const AxisAlignedBox& box2 = b->getWorldBoundingBox();
+        if( mGatheredOwners.size() < 2u )
+            return;
 
-                        if (box1.intersects(box2))
-                        {
-                            if (!listener->queryResult(a, b)) return;
-                        }
-                    }
+        sortCandidates();
+
+        const size_t numThreads = mGatheredOwners.size() >= c_minCandidatesForThreadedSweep ?
+                                      mParentSceneMgr->getNumWorkerThreads() : 1u;
+
+        mPairsPerThread.resize( std::max( mPairsPerThread.size(), numThreads ) );
+        for( size_t i=0; i<numThreads; ++i )
+            mPairsPerThread[i].clear();
+
+        if( numThreads > 1u )
+        {
+            IntersectionSweepTask task;
+            task.query = this;
+            mParentSceneMgr->executeUserScalableTask( &task, true );
+        }
+        else
+        {
+            _sweep( 0, 1u );
+        }
+
+        //Report from this thread, so listeners don't need to be thread safe.
+        for( size_t i=0; i<numThreads; ++i )
+        {
+            IndexPairVec::const_iterator itor = mPairsPerThread[i].begin();
+            IndexPairVec::const_iterator end  = mPairsPerThread[i].end();
+
+            while( itor != end )
+            {
+                if( !listener->queryResult( mSortedOwners[itor->first], mSortedOwners[itor->second] ) )
+                    return;
+                ++itor;
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void DefaultIntersectionSceneQuery::gatherCandidates( ObjectData objData, size_t numNodes )
+    {
+        ArrayInt ourQueryMask = Mathlib::SetAll( mQueryMask );
+
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            ArrayInt * RESTRICT_ALIAS visibilityFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
+                                                                        (objData.mVisibilityFlags);
+            ArrayInt * RESTRICT_ALIAS queryFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
+                                                                        (objData.mQueryFlags);
+
+            //passMask = ( (*queryFlags & ourQueryMask) != 0 ) && isVisble;
+            ArrayMaskI passMask = Mathlib::TestFlags4( *queryFlags, ourQueryMask );
+            passMask = Mathlib::And( passMask,
+                                     Mathlib::TestFlags4( *visibilityFlags,
+                                        Mathlib::SetAll( VisibilityFlags::LAYER_VISIBILITY ) ) );
+
+            const uint32 scalarMask = BooleanMask4::getScalarMask( passMask );
+
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            {
+                //There's no need to check objData.mOwner[j] is null because
+                //we set mVisibilityFlags to 0 on slot removals
+                if( IS_BIT_SET( j, scalarMask ) )
+                {
+#if OGRE_DEBUG_MODE
+                    //Queries must be performed after all bounds have been updated
+                    //(i.e. SceneManager::updateSceneGraph does this for you), and don't
+                    //move the objects between that call and this query.
+                    assert( !objData.mOwner[j]->isCachedAabbOutOfDate() &&
+                            "Perform the queries after MovableObject::updateAllBounds has been called!");
+#endif
+                    Aabb aabb;
+                    objData.mWorldAabb->getAsAabb( aabb, j );
+                    mGatheredAabbs.push_back( aabb );
+                    mGatheredOwners.push_back( objData.mOwner[j] );
                 }
-                // Check  against later groups
-                Root::MovableObjectFactoryIterator factItLater = factIt;
-                while (factItLater.hasMoreElements())
+            }
+
+            objData.advancePack();
+        }
+    }
+    //---------------------------------------------------------------------
+    void DefaultIntersectionSceneQuery::sortCandidates(void)
+    {
+        const size_t numCandidates = mGatheredOwners.size();
+
+        mSweepEntries.resize( numCandidates );
+        for( size_t i=0; i<numCandidates; ++i )
+        {
+            const Aabb &aabb = mGatheredAabbs[i];
+            mSweepEntries[i].minX   = aabb.mCenter.x - aabb.mHalfSize.x - getSweepSlack( aabb );
+            mSweepEntries[i].index  = static_cast<uint32>( i );
+        }
+
+        std::sort( mSweepEntries.begin(), mSweepEntries.end() );
+
+        const size_t numPacks = ( numCandidates + ARRAY_PACKED_REALS - 1u ) / ARRAY_PACKED_REALS;
+        if( numPacks > mSortedAabbsCapacity )
+        {
+            if( mSortedAabbs )
+                OGRE_FREE_SIMD( mSortedAabbs, MEMCATEGORY_SCENE_OBJECTS );
+            mSortedAabbs = reinterpret_cast<ArrayAabb*>( OGRE_MALLOC_SIMD( sizeof(ArrayAabb) * numPacks,
+                                                                          MEMCATEGORY_SCENE_OBJECTS ) );
+            mSortedAabbsCapacity = numPacks;
+        }
+
+        mSortedMinX.resize( numCandidates );
+        mSortedMaxX.resize( numCandidates );
+        mSortedOwners.resize( numCandidates );
+
+        for( size_t i=0; i<numCandidates; ++i )
+        {
+            const uint32 idx = mSweepEntries[i].index;
+            const Aabb &aabb = mGatheredAabbs[idx];
+            mSortedAabbs[i / ARRAY_PACKED_REALS].setFromAabb( aabb, i % ARRAY_PACKED_REALS );
+            mSortedMinX[i]      = mSweepEntries[i].minX;
+            mSortedMaxX[i]      = aabb.mCenter.x + aabb.mHalfSize.x + getSweepSlack( aabb );
+            mSortedOwners[i]    = mGatheredOwners[idx];
+        }
+
+        //Fill the remaining slots of the last pack. Their results get masked out anyway.
+        for( size_t i=numCandidates; i<numPacks * ARRAY_PACKED_REALS; ++i )
+            mSortedAabbs[i / ARRAY_PACKED_REALS].setFromAabb( Aabb::BOX_ZERO, i % ARRAY_PACKED_REALS );
+    }
+    //---------------------------------------------------------------------
+    void DefaultIntersectionSceneQuery::_sweep( size_t threadIdx, size_t numThreads )
+    {
+        const size_t numCandidates = mSortedOwners.size();
+        const size_t numPacks = ( numCandidates + ARRAY_PACKED_REALS - 1u ) / ARRAY_PACKED_REALS;
+        //Bits of the valid slots in the last pack
+        const uint32 lastPackMask = (1u << (numCandidates - (numPacks - 1u) * ARRAY_PACKED_REALS)) - 1u;
+
+        IndexPairVec &pairs = mPairsPerThread[threadIdx];
+
+        for( size_t blockStart = threadIdx * c_sweepBlockSize; blockStart < numCandidates;
+             blockStart += numThreads * c_sweepBlockSize )
+        {
+            const size_t blockEnd = std::min( blockStart + c_sweepBlockSize, numCandidates );
+
+            for( size_t i=blockStart; i<blockEnd; ++i )
+            {
+                ArrayAabb aabb( ArrayVector3::ZERO, ArrayVector3::ZERO );
+                aabb.setAll( mGatheredAabbs[mSweepEntries[i].index] );
+                const Real maxX = mSortedMaxX[i];
+
+                //Only test against the objects after us, so each pair is found once
+                size_t packIdx = (i + 1u) / ARRAY_PACKED_REALS;
+                uint32 validMask = ~((1u << ((i + 1u) % ARRAY_PACKED_REALS)) - 1u);
+
+                while( packIdx < numPacks && mSortedMinX[packIdx * ARRAY_PACKED_REALS] <= maxX )
                 {
-                    SceneManager::MovableObjectIterator objItC = 
-                        mParentSceneMgr->getMovableObjectIterator(
-                            factItLater.getNext()->getType());
-                    while (objI7tC.hasMoreElements())
+                    uint32 scalarMask = BooleanMask4::getScalarMask(
+                                            aabb.intersects( mSortedAabbs[packIdx] ) );
+                    scalarMask &= validMask;
+                    if( packIdx == numPacks - 1u )
+                        scalarMask &= lastPackMask;
+
+                    for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
                     {
-                        MovableObject* c = objItC.getNext();
-                        // skip entire section if type doesn't match
-                        if (!(c->getTypeFlags() & mQueryTypeMask))
-                            break;
-
-                        // Apply mask to c (both must pass)
-                        if ((c->getQueryFlags() & mQueryMask) &&
-                            c->isInScene())
+                        if( IS_BIT_SET( j, scalarMask ) )
                         {
-                            const AxisAlignedBox& box1 = a->getWorldBoundingBox();
-                            const AxisAlignedBox& box2 = c->getWorldBoundingBox();
-
-                            if (box1.intersects(box2))
-                            {
-                                if (!listener->queryResult(a, c)) return;
-                            }
+                            pairs.push_back( IndexPair( static_cast<uint32>( i ),
+                                                        static_cast<uint32>( packIdx *
+                                                                             ARRAY_PACKED_REALS + j ) ) );
                         }
                     }
 
+                    validMask = 0xFFFFFFFF;
+                    ++packIdx;
                 }
-
             }
-
-
         }
-#endif
-
     }
     //---------------------------------------------------------------------
     DefaultAxisAlignedBoxSceneQuery::
@@ -219,6 +709,13 @@ namespace Ogre {
         return true;
     }
     //---------------------------------------------------------------------
+    void DefaultAxisAlignedBoxSceneQuery::executeBatch( const AxisAlignedBox *boxes, size_t numBoxes,
+                                                        const SceneQueryBatchOutput &output )
+    {
+        executeBatchedSceneQuery<AabbBatchPolicy>( mParentSceneMgr, *this, boxes, numBoxes, output,
+                                                   output.maxResultsPerQuery, false );
+    }
+    //---------------------------------------------------------------------
     DefaultRaySceneQuery::
     DefaultRaySceneQuery(SceneManager* creator) : RaySceneQuery(creator)
     {
@@ -362,6 +859,15 @@ namespace Ogre {
         return true;
     }
     //---------------------------------------------------------------------
+    void DefaultRaySceneQuery::executeBatch( const Ray *rays, size_t numRays,
+                                             const SceneQueryBatchOutput &output )
+    {
+        const uint32 maxResults = mSortByDistance && mMaxResults ? mMaxResults :
+                                                                   output.maxResultsPerQuery;
+        executeBatchedSceneQuery<RayBatchPolicy>( mParentSceneMgr, *this, rays, numRays, output,
+                                                  maxResults, mSortByDistance );
+    }
+    //---------------------------------------------------------------------
     DefaultSphereSceneQuery::
     DefaultSphereSceneQuery(SceneManager* creator) : SphereSceneQuery(creator)
     {
@@ -455,6 +961,13 @@ namespace Ogre {
         return true;
     }
     //---------------------------------------------------------------------
+    void DefaultSphereSceneQuery::executeBatch( const Sphere *spheres, size_t numSpheres,
+                                                const SceneQueryBatchOutput &output )
+    {
+        executeBatchedSceneQuery<SphereBatchPolicy>( mParentSceneMgr, *this, spheres, numSpheres,
+                                                     output, output.maxResultsPerQuery, false );
+    }
+    //---------------------------------------------------------------------
     DefaultPlaneBoundedVolumeListSceneQuery::
     DefaultPlaneBoundedVolumeListSceneQuery(SceneManager* creator) 
     : PlaneBoundedVolumeListSceneQuery(creator)
@@ -38,6 +38,8 @@ THE SOFTWARE.
 #include "OgreHlmsDatablock.h"
 #include "OgreLwString.h"
 #include "OgreProfiler.h"
+#include "OgreResourceGroupManager.h"
+#include "OgrePlatformInformation.h"
 
 #if !OGRE_NO_JSON
     #include "rapidjson/document.h"
@@ -46,7 +48,39 @@ THE SOFTWARE.
 
 namespace Ogre
 {
-    HlmsTextureManager::HlmsTextureManager() : mRenderSystem( 0 ), mTextureId( 0 )
+    unsigned long streamingTextureThread( ThreadHandle *threadHandle )
+    {
+        HlmsTextureManager *textureManager =
+                reinterpret_cast<HlmsTextureManager*>( threadHandle->getUserParam() );
+        textureManager->_streamingThreadMain();
+        return 0;
+    }
+    THREAD_DECLARE( streamingTextureThread );
+    //-----------------------------------------------------------------------------------
+    HlmsTextureManager::StreamedTexture::StreamedTexture() :
+        mapType( TEXTURE_TYPE_DIFFUSE ),
+        uniqueSpecialId( 0 ),
+        screenCoverage( std::numeric_limits<Real>::max() ),
+        image( 0 ),
+        hwGammaCorrection( false ),
+        generateMipmaps( false ),
+        failed( false ),
+        cancelled( false ),
+        previewNumPixels( 0 ),
+        entryIdx( 0 ),
+        srcBaseMip( 0 ),
+        isNormalMap( false ),
+        nextMip( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    HlmsTextureManager::HlmsTextureManager() :
+        mRenderSystem( 0 ),
+        mTextureId( 0 ),
+        mStopStreamingThreads( false ),
+        mNumStreamingThreads( 1u ),
+        mStreamingUploadBudget( 8u * 1024u * 1024u ),
+        mStreamingPreviewResolution( 64u )
     {
         mDefaultTextureParameters[TEXTURE_TYPE_DIFFUSE].hwGammaCorrection   = true;
         mDefaultTextureParameters[TEXTURE_TYPE_MONOCHROME].pixelFormat      = PF_L8;
@@ -61,6 +95,46 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     HlmsTextureManager::~HlmsTextureManager()
     {
+        stopStreamingThreads();
+
+        StreamedTextureVec::const_iterator itDecoded = mStreamingDecoded.begin();
+        StreamedTextureVec::const_iterator enDecoded = mStreamingDecoded.end();
+
+        while( itDecoded != enDecoded )
+        {
+            //Cancelled textures are no longer in mStreamedTextures
+            if( (*itDecoded)->cancelled )
+            {
+                OGRE_DELETE (*itDecoded)->image;
+                OGRE_DELETE_T( *itDecoded, StreamedTexture, MEMCATEGORY_GENERAL );
+            }
+            ++itDecoded;
+        }
+
+        StreamedTextureDeque::const_iterator itQueued = mStreamingDecodeQueue.begin();
+        StreamedTextureDeque::const_iterator enQueued = mStreamingDecodeQueue.end();
+
+        while( itQueued != enQueued )
+        {
+            if( (*itQueued)->cancelled )
+                OGRE_DELETE_T( *itQueued, StreamedTexture, MEMCATEGORY_GENERAL );
+            ++itQueued;
+        }
+
+        StreamedTextureMap::const_iterator itor = mStreamedTextures.begin();
+        StreamedTextureMap::const_iterator end  = mStreamedTextures.end();
+
+        while( itor != end )
+        {
+            OGRE_DELETE itor->second->image;
+            OGRE_DELETE_T( itor->second, StreamedTexture, MEMCATEGORY_GENERAL );
+            ++itor;
+        }
+
+        mStreamedTextures.clear();
+        mStreamingDecodeQueue.clear();
+        mStreamingDecoded.clear();
+        mStreamingUploads.clear();
     }
     //-----------------------------------------------------------------------------------
     void HlmsTextureManager::_changeRenderSystem( RenderSystem *newRs )
@@ -188,6 +262,22 @@ namespace Ogre
         return itor != end;
     }
     //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::copyMipToArray( const Image &srcImage, TexturePtr dst, uint16 entryIdx,
+                                             uint8 srcBaseMip, uint8 mip, bool isNormalMap )
+    {
+        v1::HardwarePixelBufferSharedPtr pixelBufferBuf = dst->getBuffer(0, mip);
+        const PixelBox &currImage = pixelBufferBuf->lock( Box( 0, 0, entryIdx,
+                                                               pixelBufferBuf->getWidth(),
+                                                               pixelBufferBuf->getHeight(),
+                                                               entryIdx + 1 ),
+                                                          v1::HardwareBuffer::HBL_DISCARD );
+        if( isNormalMap && srcImage.getFormat() != dst->getFormat() )
+            PixelUtil::convertForNormalMapping( srcImage.getPixelBox(0, mip + srcBaseMip), currImage );
+        else
+            PixelUtil::bulkPixelConversion( srcImage.getPixelBox(0, mip + srcBaseMip), currImage );
+        pixelBufferBuf->unlock();
+    }
+    //-----------------------------------------------------------------------------------
     void HlmsTextureManager::copyTextureToArray( const Image &srcImage, TexturePtr dst, uint16 entryIdx,
                                                  uint8 srcBaseMip, bool isNormalMap )
     {
@@ -204,19 +294,7 @@ namespace Ogre
         uint8 minMipmaps = std::min<uint8>( srcImage.getNumMipmaps() - srcBaseMip,
                                             dst->getNumMipmaps() ) + 1;
         for( uint8 j=0; j<minMipmaps; ++j )
-        {
-            v1::HardwarePixelBufferSharedPtr pixelBufferBuf = dst->getBuffer(0, j);
-            const PixelBox &currImage = pixelBufferBuf->lock( Box( 0, 0, entryIdx,
-                                                                   pixelBufferBuf->getWidth(),
-                                                                   pixelBufferBuf->getHeight(),
-                                                                   entryIdx + 1 ),
-                                                              v1::HardwareBuffer::HBL_DISCARD );
-            if( isNormalMap && srcImage.getFormat() != dst->getFormat() )
-                PixelUtil::convertForNormalMapping( srcImage.getPixelBox(0, j + srcBaseMip), currImage );
-            else
-                PixelUtil::bulkPixelConversion( srcImage.getPixelBox(0, j + srcBaseMip), currImage );
-            pixelBufferBuf->unlock();
-        }
+            copyMipToArray( srcImage, dst, entryIdx, srcBaseMip, j, isNormalMap );
     }
     //-----------------------------------------------------------------------------------
     void HlmsTextureManager::copyTextureToAtlas( const Image &srcImage, TexturePtr dst,
@@ -404,6 +482,18 @@ namespace Ogre
                                                                         TextureMapType mapType,
                                                                         uint32 uniqueSpecialId,
                                                                         Image *imgSource )
+    {
+        return createOrRetrieveTextureImpl( aliasName, texName, mapType, uniqueSpecialId,
+                                            imgSource, 0 );
+    }
+    //-----------------------------------------------------------------------------------
+    HlmsTextureManager::TextureLocation HlmsTextureManager::createOrRetrieveTextureImpl(
+                                                                        const String &aliasName,
+                                                                        const String &texName,
+                                                                        TextureMapType mapType,
+                                                                        uint32 uniqueSpecialId,
+                                                                        Image *imgSource,
+                                                                        StreamedTexture *deferredUpload )
     {
         OgreProfileExhaustive( "HlmsTextureManager::createOrRetrieveTexture" );
 
@@ -423,6 +513,18 @@ namespace Ogre
 
         const bool missingFromCache = it == mEntries.end() || it->name != searchName.name;
 
+        if( !missingFromCache && !deferredUpload )
+        {
+            //Don't hand out a slice whose mips are still being streamed in. Finish it
+            //now; _updateStreaming will notify its listeners as usual.
+            StreamedTextureMap::const_iterator itStreamed = mStreamedTextures.find( aliasName );
+            if( itStreamed != mStreamedTextures.end() && !itStreamed->second->texture.isNull() )
+            {
+                bool uploadedAnything = false;
+                uploadStreamedMips( itStreamed->second, 0, uploadedAnything );
+            }
+        }
+
         try
         {
         if( missingFromCache )
@@ -712,8 +814,22 @@ namespace Ogre
                 {
                     if( mDefaultTextureParameters[mapType].packingMethod == TextureArrays )
                     {
-                        copyTextureToArray( *image, dstArrayIt->texture, entryIdx,
-                                            baseMipLevel, dstArrayIt->isNormalMap );
+                        if( deferredUpload )
+                        {
+                            //The caller will upload the mips
+                            deferredUpload->texture     = dstArrayIt->texture;
+                            deferredUpload->entryIdx    = entryIdx;
+                            deferredUpload->srcBaseMip  = baseMipLevel;
+                            deferredUpload->isNormalMap = dstArrayIt->isNormalMap;
+                            deferredUpload->nextMip     = std::min<uint8>(
+                                                              image->getNumMipmaps() - baseMipLevel,
+                                                              dstArrayIt->texture->getNumMipmaps() ) + 1u;
+                        }
+                        else
+                        {
+                            copyTextureToArray( *image, dstArrayIt->texture, entryIdx,
+                                                baseMipLevel, dstArrayIt->isNormalMap );
+                        }
                     }
                     else
                     {
@@ -781,8 +897,539 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
+    HlmsTextureManager::TextureLocation HlmsTextureManager::createOrRetrieveTextureStreamed(
+                                                                    const String &aliasName,
+                                                                    const String &texName,
+                                                                    TextureMapType mapType,
+                                                                    StreamingListener *listener,
+                                                                    uint32 uniqueSpecialId )
+    {
+        assert( !aliasName.empty() && "Alias name can't be left empty!" );
+
+        TextureLocation retVal = getBlankTexture();
+
+        StreamedTextureMap::iterator itStreamed = mStreamedTextures.find( aliasName );
+        if( itStreamed != mStreamedTextures.end() )
+        {
+            //Already in flight. If it has a preview, return that.
+            StreamedTexture *streamed = itStreamed->second;
+            if( !streamed->previewAliasName.empty() )
+                retVal = createOrRetrieveTexture( streamed->previewAliasName, mapType );
+            if( std::find( streamed->listeners.begin(), streamed->listeners.end(),
+                           listener ) == streamed->listeners.end() )
+            {
+                streamed->listeners.push_back( listener );
+            }
+            return retVal;
+        }
+
+        MetadataCacheMap::const_iterator itCache = mMetadataCache.find( aliasName );
+        if( itCache != mMetadataCache.end() )
+        {
+            mapType = itCache->second.mapType;
+            uniqueSpecialId = itCache->second.poolId;
+        }
+
+        TextureEntry searchName( aliasName );
+        TextureEntryVec::iterator it = std::lower_bound( mEntries.begin(), mEntries.end(), searchName );
+        if( it != mEntries.end() && it->name == searchName.name )
+        {
+            //Already loaded
+            return createOrRetrieveTexture( aliasName, texName, mapType, uniqueSpecialId );
+        }
+
+        DataStreamPtr stream;
+        try
+        {
+            stream = ResourceGroupManager::getSingleton().openResource(
+                         texName, ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME );
+        }
+        catch( Exception &e )
+        {
+            LogManager::getSingleton().logMessage( LML_CRITICAL, e.getFullDescription() );
+
+            if( e.getNumber() != Exception::ERR_FILE_NOT_FOUND )
+                throw;
+            return retVal;
+        }
+
+        //Plain files can be read from any thread. Other streams (e.g. zip) may share
+        //state with other streams from the same archive, so read them right away.
+        if( !dynamic_cast<FileStreamDataStream*>( stream.get() ) &&
+            !dynamic_cast<FileHandleDataStream*>( stream.get() ) )
+        {
+            stream = DataStreamPtr( OGRE_NEW MemoryDataStream( stream ) );
+        }
+
+        LogManager::getSingleton().logMessage( "Texture: streaming " + texName + " as " + aliasName );
+
+        StreamedTexture *streamed = OGRE_NEW_T( StreamedTexture, MEMCATEGORY_GENERAL )();
+        streamed->aliasName         = aliasName;
+        streamed->texName           = texName;
+        streamed->mapType           = mapType;
+        streamed->uniqueSpecialId   = uniqueSpecialId;
+        streamed->listeners.push_back( listener );
+        streamed->stream            = stream;
+        streamed->hwGammaCorrection = mDefaultTextureParameters[mapType].hwGammaCorrection;
+        streamed->generateMipmaps   = mDefaultTextureParameters[mapType].mipmaps;
+
+        mStreamedTextures[aliasName] = streamed;
+
+        mStreamingMutex.lock();
+        mStreamingDecodeQueue.push_back( streamed );
+        mStreamingMutex.unlock();
+
+        launchStreamingThreads();
+        mStreamingWorkerEvent.wake();
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::setTextureScreenCoverage( IdString aliasName, Real numPixels )
+    {
+        StreamedTextureMap::const_iterator itor = mStreamedTextures.find( aliasName );
+        if( itor != mStreamedTextures.end() )
+            itor->second->screenCoverage = numPixels;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::setStreamingUploadBudget( size_t bytesPerFrame )
+    {
+        mStreamingUploadBudget = bytesPerFrame;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::setNumStreamingThreads( uint32 numThreads )
+    {
+        if( mNumStreamingThreads != numThreads )
+        {
+            stopStreamingThreads();
+            mNumStreamingThreads = numThreads;
+            launchStreamingThreads();
+            mStreamingWorkerEvent.wake();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::setStreamingPreviewResolution( uint32 resolution )
+    {
+        mStreamingPreviewResolution = resolution;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::launchStreamingThreads(void)
+    {
+        if( !mStreamingThreads.empty() )
+            return;
+
+        mStreamingMutex.lock();
+        const size_t numQueued = mStreamingDecodeQueue.size();
+        mStreamingMutex.unlock();
+
+        if( !numQueued )
+            return;
+
+        size_t numThreads = mNumStreamingThreads;
+        if( !numThreads )
+            numThreads = PlatformInformation::getNumLogicalCores();
+        numThreads = std::max<size_t>( numThreads, 1u );
+
+        mStreamingThreads.reserve( numThreads );
+        for( size_t i=0; i<numThreads; ++i )
+        {
+            mStreamingThreads.push_back( Threads::CreateThread( THREAD_GET( streamingTextureThread ),
+                                                                i, this ) );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::stopStreamingThreads(void)
+    {
+        if( !mStreamingThreads.empty() )
+        {
+            mStreamingMutex.lock();
+            mStopStreamingThreads = true;
+            mStreamingMutex.unlock();
+
+            //Each thread wakes the next one on its way out
+            mStreamingWorkerEvent.wake();
+            Threads::WaitForThreads( mStreamingThreads );
+            mStreamingThreads.clear();
+
+            mStopStreamingThreads = false;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::_streamingThreadMain(void)
+    {
+        bool finished = false;
+        while( !finished )
+        {
+            StreamedTexture *streamed = 0;
+            bool moreWork = false;
+
+            mStreamingMutex.lock();
+            finished = mStopStreamingThreads;
+            if( !finished && !mStreamingDecodeQueue.empty() )
+            {
+                streamed = mStreamingDecodeQueue.front();
+                mStreamingDecodeQueue.pop_front();
+                moreWork = !mStreamingDecodeQueue.empty();
+            }
+            mStreamingMutex.unlock();
+
+            if( finished || moreWork )
+            {
+                //Pass the wake up along. Either to stop the rest of the threads, or so
+                //another thread helps with the remaining work.
+                mStreamingWorkerEvent.wake();
+            }
+
+            if( streamed )
+            {
+                try
+                {
+                    String ext;
+                    const String::size_type pos = streamed->texName.find_last_of( '.' );
+                    if( pos != String::npos && pos < streamed->texName.length() - 1u )
+                        ext = streamed->texName.substr( pos + 1u );
+
+                    streamed->image = OGRE_NEW Image();
+                    streamed->image->load( streamed->stream, ext );
+
+                    //Generate the mipmaps here, rather than in the main thread.
+                    Image *image = streamed->image;
+                    if( streamed->generateMipmaps && image->getNumMipmaps() == 0 &&
+                        image->getDepth() == 1u && !PixelUtil::isCompressed( image->getFormat() ) )
+                    {
+                        image->generateMipmaps( streamed->hwGammaCorrection );
+                    }
+                }
+                catch( Exception &e )
+                {
+                    streamed->failed = true;
+                    streamed->errorDescription = e.getFullDescription();
+                }
+
+                streamed->stream.setNull();
+
+                mStreamingMutex.lock();
+                mStreamingDecoded.push_back( streamed );
+                mStreamingMutex.unlock();
+
+                mStreamingDecodedEvent.wake();
+            }
+            else if( !finished )
+            {
+                mStreamingWorkerEvent.wait();
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool HlmsTextureManager::prepareStreamedTextureUpload( StreamedTexture *streamed,
+                                                            StreamingNotificationVec &outNotifications )
+    {
+        Image *image = streamed->image;
+
+        //Create the low resolution preview out of the coarser mips.
+        if( mStreamingPreviewResolution && image->getNumMipmaps() &&
+            !image->hasFlag( IF_3D_TEXTURE ) && !image->hasFlag( IF_CUBEMAP ) &&
+            !PixelUtil::isCompressed( image->getFormat() ) &&
+            mDefaultTextureParameters[streamed->mapType].packingMethod == TextureArrays )
+        {
+            uint8 previewMip = 0;
+            uint32 width  = image->getWidth();
+            uint32 height = image->getHeight();
+            while( (width > mStreamingPreviewResolution || height > mStreamingPreviewResolution) &&
+                   previewMip < image->getNumMipmaps() )
+            {
+                width  = std::max( width >> 1u, 1u );
+                height = std::max( height >> 1u, 1u );
+                ++previewMip;
+            }
+
+            if( previewMip != 0 )
+            {
+                //In a single face image, all mips from previewMip onwards are contiguous
+                const PixelBox srcBox = image->getPixelBox( 0, previewMip );
+                const uint8 numPreviewMips = image->getNumMipmaps() - previewMip;
+                const size_t bufSize = Image::calculateSize( numPreviewMips, 1u, width, height,
+                                                             1u, image->getFormat() );
+                uchar *previewData = OGRE_ALLOC_T( uchar, bufSize, MEMCATEGORY_GENERAL );
+                memcpy( previewData, srcBox.data, bufSize );
+
+                Image previewImage;
+                previewImage.loadDynamicImage( previewData, width, height, 1u, image->getFormat(),
+                                               true, 1u, numPreviewMips );
+
+                streamed->previewAliasName = streamed->aliasName + "/StreamingPreview";
+                streamed->previewNumPixels = width * height;
+
+                StreamingNotification notification;
+                notification.aliasName  = streamed->aliasName;
+                notification.listeners  = streamed->listeners;
+                notification.location   = createOrRetrieveTexture( streamed->previewAliasName,
+                                                                   streamed->texName,
+                                                                   streamed->mapType, 0,
+                                                                   &previewImage );
+                notification.type       = StreamingNotification::Preview;
+                outNotifications.push_back( notification );
+            }
+        }
+
+        //Reserve the final slice. The mips get uploaded later unless this texture can't
+        //go into a texture array, in which case it's uploaded right away.
+        TextureLocation finalLocation = createOrRetrieveTextureImpl( streamed->aliasName,
+                                                                     streamed->texName,
+                                                                     streamed->mapType,
+                                                                     streamed->uniqueSpecialId,
+                                                                     image, streamed );
+        if( streamed->texture.isNull() )
+        {
+            finishStreamedTexture( streamed, &finalLocation, outNotifications );
+            return false;
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::uploadStreamedMips( StreamedTexture *streamed, size_t *bytesLeft,
+                                                 bool &uploadedAnything )
+    {
+        while( streamed->nextMip && (!bytesLeft || *bytesLeft) )
+        {
+            const uint8 mip = streamed->nextMip - 1u;
+
+            if( bytesLeft )
+            {
+                const size_t mipSize = PixelUtil::getMemorySize(
+                                           std::max<uint32>( streamed->texture->getWidth() >> mip, 1u ),
+                                           std::max<uint32>( streamed->texture->getHeight() >> mip, 1u ),
+                                           1u, streamed->texture->getFormat() );
+
+                //Always upload something, otherwise mips bigger than the budget never would.
+                if( mipSize > *bytesLeft && uploadedAnything )
+                {
+                    *bytesLeft = 0;
+                    break;
+                }
+
+                *bytesLeft -= std::min( mipSize, *bytesLeft );
+            }
+
+            copyMipToArray( *streamed->image, streamed->texture, streamed->entryIdx,
+                            streamed->srcBaseMip, mip, streamed->isNormalMap );
+            uploadedAnything = true;
+            --streamed->nextMip;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::finishStreamedTexture( StreamedTexture *streamed,
+                                                    const TextureLocation *finalLocation,
+                                                    StreamingNotificationVec &outNotifications )
+    {
+        if( !streamed->cancelled )
+        {
+            StreamingNotification notification;
+            notification.aliasName  = streamed->aliasName;
+            notification.listeners  = streamed->listeners;
+            if( finalLocation )
+            {
+                notification.location   = *finalLocation;
+                notification.type       = StreamingNotification::Final;
+            }
+            else
+            {
+                notification.type       = StreamingNotification::Failed;
+            }
+            outNotifications.push_back( notification );
+        }
+
+        if( !streamed->previewAliasName.empty() )
+            destroyTexture( streamed->previewAliasName );
+
+        mStreamedTextures.erase( streamed->aliasName );
+
+        OGRE_DELETE streamed->image;
+        streamed->image = 0;
+        OGRE_DELETE_T( streamed, StreamedTexture, MEMCATEGORY_GENERAL );
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::fireStreamingNotifications( const StreamingNotificationVec &notifications )
+    {
+        StreamingNotificationVec::const_iterator itor = notifications.begin();
+        StreamingNotificationVec::const_iterator end  = notifications.end();
+
+        while( itor != end )
+        {
+            //A listener may have destroyed the texture from within an earlier call
+            bool stillAlive = true;
+            if( itor->type == StreamingNotification::Preview )
+            {
+                stillAlive = mStreamedTextures.find( itor->aliasName ) != mStreamedTextures.end();
+            }
+            else if( itor->type == StreamingNotification::Final )
+            {
+                TextureEntry searchName( itor->aliasName );
+                TextureEntryVec::const_iterator it = std::lower_bound( mEntries.begin(),
+                                                                       mEntries.end(), searchName );
+                stillAlive = it != mEntries.end() && it->name == searchName.name;
+            }
+
+            StreamedTexture::StreamingListenerVec::const_iterator itListener = itor->listeners.begin();
+            StreamedTexture::StreamingListenerVec::const_iterator enListener = itor->listeners.end();
+
+            while( itListener != enListener && stillAlive )
+            {
+                if( itor->type == StreamingNotification::Failed )
+                    (*itListener)->streamedTextureFailed( itor->aliasName );
+                else
+                {
+                    (*itListener)->streamedTextureChanged( itor->aliasName, itor->location,
+                                                           itor->type == StreamingNotification::Final );
+                }
+                ++itListener;
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool HlmsTextureManager::orderByScreenCoverage( const StreamedTexture *a,
+                                                    const StreamedTexture *b )
+    {
+        return a->screenCoverage > b->screenCoverage;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::_updateStreaming( bool ignoreBudget )
+    {
+        //Cancelled textures are no longer in mStreamedTextures,
+        //but the threads may still be decoding them.
+        if( mStreamedTextures.empty() && mStreamingThreads.empty() )
+            return;
+
+        OgreProfileExhaustive( "HlmsTextureManager::_updateStreaming" );
+
+        launchStreamingThreads();
+
+        //Listeners are called at the very end. They may create or destroy textures,
+        //which would invalidate the containers iterated here.
+        StreamingNotificationVec notifications;
+
+        StreamedTextureVec decoded;
+        mStreamingMutex.lock();
+        decoded.swap( mStreamingDecoded );
+        mStreamingMutex.unlock();
+
+        StreamedTextureVec::const_iterator itDecoded = decoded.begin();
+        StreamedTextureVec::const_iterator enDecoded = decoded.end();
+
+        while( itDecoded != enDecoded )
+        {
+            StreamedTexture *streamed = *itDecoded;
+
+            if( streamed->cancelled )
+            {
+                OGRE_DELETE streamed->image;
+                OGRE_DELETE_T( streamed, StreamedTexture, MEMCATEGORY_GENERAL );
+            }
+            else if( streamed->failed )
+            {
+                LogManager::getSingleton().logMessage( LML_CRITICAL, streamed->errorDescription );
+                finishStreamedTexture( streamed, 0, notifications );
+            }
+            else
+            {
+                try
+                {
+                    if( prepareStreamedTextureUpload( streamed, notifications ) )
+                        mStreamingUploads.push_back( streamed );
+                }
+                catch( Exception &e )
+                {
+                    LogManager::getSingleton().logMessage( LML_CRITICAL, e.getFullDescription() );
+                    finishStreamedTexture( streamed, 0, notifications );
+                }
+            }
+
+            ++itDecoded;
+        }
+
+        std::stable_sort( mStreamingUploads.begin(), mStreamingUploads.end(),
+                          orderByScreenCoverage );
+
+        size_t bytesLeft = mStreamingUploadBudget;
+        bool uploadedAnything = false;
+
+        StreamedTextureVec::iterator itor = mStreamingUploads.begin();
+        StreamedTextureVec::iterator end  = mStreamingUploads.end();
+
+        while( itor != end )
+        {
+            StreamedTexture *streamed = *itor;
+
+            //Textures whose upload was completed by createOrRetrieveTexture are always
+            //finished, even after running out of budget. So is everything when ignoring it.
+            //Otherwise, the preview may be good enough for the area it covers on screen.
+            if( streamed->nextMip && !ignoreBudget &&
+                (!bytesLeft || (!streamed->previewAliasName.empty() &&
+                                streamed->screenCoverage <=
+                                static_cast<Real>( streamed->previewNumPixels ))) )
+            {
+                ++itor;
+                continue;
+            }
+
+            uploadStreamedMips( streamed, ignoreBudget ? 0 : &bytesLeft, uploadedAnything );
+
+            if( !streamed->nextMip )
+            {
+                TextureLocation finalLocation = createOrRetrieveTexture( streamed->aliasName,
+                                                                         streamed->mapType );
+                itor = mStreamingUploads.erase( itor );
+                end  = mStreamingUploads.end();
+                finishStreamedTexture( streamed, &finalLocation, notifications );
+            }
+            else
+            {
+                ++itor;
+            }
+        }
+
+        fireStreamingNotifications( notifications );
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::waitForStreamingTextures(void)
+    {
+        _updateStreaming( true );
+
+        while( !mStreamedTextures.empty() )
+        {
+            //What's left is still being decoded
+            mStreamingDecodedEvent.wait();
+            _updateStreaming( true );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void HlmsTextureManager::destroyTexture( IdString aliasName )
     {
+        StreamedTextureMap::iterator itStreamed = mStreamedTextures.find( aliasName );
+        if( itStreamed != mStreamedTextures.end() )
+        {
+            StreamedTexture *streamed = itStreamed->second;
+            StreamedTextureVec::iterator itUpload = std::find( mStreamingUploads.begin(),
+                                                               mStreamingUploads.end(), streamed );
+            if( itUpload != mStreamingUploads.end() )
+            {
+                //Being uploaded. We own it, get rid of it now.
+                mStreamingUploads.erase( itUpload );
+                streamed->cancelled = true;
+                StreamingNotificationVec notifications;
+                finishStreamedTexture( streamed, 0, notifications );
+            }
+            else
+            {
+                //Still being decoded. _updateStreaming will free it.
+                mStreamedTextures.erase( itStreamed );
+                streamed->cancelled = true;
+            }
+        }
+
         TextureEntry searchName( aliasName );
         TextureEntryVec::iterator it = std::lower_bound( mEntries.begin(), mEntries.end(), searchName );
 
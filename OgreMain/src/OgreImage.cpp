@@ -36,11 +36,143 @@ THE SOFTWARE.
 #include "OgreImageDownsampler.h"
 #include "OgreResourceGroupManager.h"
 #include "OgreProfiler.h"
+#include "OgrePlatformInformation.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreBarrier.h"
+#include "Threading/OgreUniformScalableTask.h"
 
 namespace Ogre {
     ImageCodec::~ImageCodec() {
     }
 
+    namespace
+    {
+        /// Splits numRows rows evenly across threads. Range is [rowStart; rowEnd)
+        inline void getRowRange( uint32 numRows, size_t threadId, size_t numThreads,
+                                 uint32 &outRowStart, uint32 &outRowEnd )
+        {
+            outRowStart = static_cast<uint32>( (numRows * threadId) / numThreads );
+            outRowEnd   = static_cast<uint32>( (numRows * (threadId + 1u)) / numThreads );
+        }
+
+        /** Generates all the mips of an Image. Every mip is split in row bands across
+            threads; and threads wait for each other before moving onto the next mip,
+            since it is built from the previous one.
+        */
+        class MipmapGenerationTask : public UniformScalableTask
+        {
+        public:
+            Image                   *image;
+            /// Holds a copy of the previous mip while it gets blurred (FILTER_GAUSSIAN_HIGH)
+            uint8                   *blurBuffer;
+            /// Intermediate results of the blur (FILTER_GAUSSIAN_HIGH)
+            uint8                   *tmpBuffer;
+            ImageDownsampler2D      *downsampler2DFunc;
+            ImageDownsamplerCube    *downsamplerCubeFunc;
+            ImageBlur2D             *separableBlur2DFunc;
+            FilterKernel const      *chosenFilter;
+            bool                    gaussianHigh;
+            Barrier                 *barrier;
+
+            void sync( size_t numThreads )
+            {
+                if( numThreads > 1u )
+                    barrier->sync();
+            }
+
+            virtual void execute( size_t threadId, size_t numThreads )
+            {
+                uint32 dstWidth  = image->getWidth();
+                uint32 dstHeight = image->getHeight();
+
+                const uint8 numMipmaps = image->getNumMipmaps();
+
+                for( uint8 i=1; i<numMipmaps + 1; ++i )
+                {
+                    uint32 srcWidth    = dstWidth;
+                    uint32 srcHeight   = dstHeight;
+                    dstWidth   = std::max<uint32>( 1, dstWidth >> 1 );
+                    dstHeight  = std::max<uint32>( 1, dstHeight >> 1 );
+
+                    uint32 rowStart, rowEnd;
+
+                    if( image->hasFlag( IF_CUBEMAP ) )
+                    {
+                        uint8 const *upFaces[6];
+                        for( size_t j=0; j<6; ++j )
+                            upFaces[j] = reinterpret_cast<uint8*>( image->getPixelBox( j, i - 1 ).data );
+
+                        //Rows of all faces are split together, as if they were a single image
+                        getRowRange( dstHeight * 6u, threadId, numThreads, rowStart, rowEnd );
+
+                        for( uint32 j=rowStart / dstHeight; j<6u && j * dstHeight < rowEnd; ++j )
+                        {
+                            const uint32 faceRowStart = std::max( rowStart, j * dstHeight ) -
+                                                        j * dstHeight;
+                            const uint32 faceRowEnd = std::min( rowEnd, (j + 1u) * dstHeight ) -
+                                                      j * dstHeight;
+
+                            PixelBox downFace = image->getPixelBox( j, i );
+                            (*downsamplerCubeFunc)( reinterpret_cast<uint8*>( downFace.data ), upFaces,
+                                                    dstWidth, dstHeight, srcWidth, srcHeight,
+                                                    chosenFilter->kernel,
+                                                    chosenFilter->kernelStartX, chosenFilter->kernelEndX,
+                                                    chosenFilter->kernelStartY, chosenFilter->kernelEndY,
+                                                    static_cast<uint8>( j ), faceRowStart, faceRowEnd );
+                        }
+                    }
+                    else
+                    {
+                        uint8 const *srcData = reinterpret_cast<uint8*>( image->getPixelBox( 0, i - 1 ).data );
+
+                        if( gaussianHigh )
+                        {
+                            const size_t bytesPerRow = PixelUtil::getMemorySize( srcWidth, 1u, 1u,
+                                                                                 image->getFormat() );
+                            getRowRange( srcHeight, threadId, numThreads, rowStart, rowEnd );
+
+                            //Copy 'image' to blurBuffer.
+                            //The image right now is in both 'image' and blurBuffer. We can't
+                            //touch 'image', So we blur blurBuffer, and use tmpBuffer to store
+                            //intermediate results.
+                            //The horizontal pass only reads the rows it writes to, and those
+                            //rows were copied by this same thread; so no need to sync yet.
+                            memcpy( blurBuffer + rowStart * bytesPerRow, srcData + rowStart * bytesPerRow,
+                                    (rowEnd - rowStart) * bytesPerRow );
+
+                            const FilterSeparableKernel &separableKernel = c_filterSeparableKernels[0];
+
+                            //Filter twice.
+                            for( size_t pass=0; pass<4u; ++pass )
+                            {
+                                (*separableBlur2DFunc)( tmpBuffer, blurBuffer,
+                                                        srcWidth, srcHeight,
+                                                        separableKernel.kernel,
+                                                        separableKernel.kernelStart,
+                                                        separableKernel.kernelEnd,
+                                                        rowStart, rowEnd, (pass & 0x01u) == 0u );
+                                sync( numThreads );
+                            }
+
+                            //Now that blurBuffer is blurred, bilinear downsample its contents.
+                            srcData = blurBuffer;
+                        }
+
+                        getRowRange( dstHeight, threadId, numThreads, rowStart, rowEnd );
+                        (*downsampler2DFunc)( reinterpret_cast<uint8*>( image->getPixelBox( 0, i ).data ),
+                                              srcData, dstWidth, dstHeight, srcWidth,
+                                              chosenFilter->kernel,
+                                              chosenFilter->kernelStartX, chosenFilter->kernelEndX,
+                                              chosenFilter->kernelStartY, chosenFilter->kernelEndY,
+                                              rowStart, rowEnd );
+                    }
+
+                    sync( numThreads );
+                }
+            }
+        };
+    }
+
     //-----------------------------------------------------------------------------
     Image::Image()
         : mWidth(0),
@@ -593,7 +725,7 @@ namespace Ogre {
         Image::scale(temp.getPixelBox(), getPixelBox(), filter);
     }
     //-----------------------------------------------------------------------------
-    bool Image::generateMipmaps( bool gammaCorrected, Filter filter )
+    bool Image::generateMipmaps( bool gammaCorrected, Filter filter, uint32 numThreads )
     {
         OgreProfileExhaustive( "Image::generateMipmaps" );
 
@@ -746,10 +878,44 @@ namespace Ogre {
             downsamplerCubeFunc = downscale2x_Float32_X_cube;
             separableBlur2DFunc = separableBlur_Float32_X;
             break;
+        case PF_FLOAT16_RGBA:
+            downsampler2DFunc   = downscale2x_Float16_XXXA;
+            downsamplerCubeFunc = downscale2x_Float16_XXXA_cube;
+            separableBlur2DFunc = separableBlur_Float16_XXXA;
+            break;
+        case PF_FLOAT16_RGB:
+            downsampler2DFunc   = downscale2x_Float16_XXX;
+            downsamplerCubeFunc = downscale2x_Float16_XXX_cube;
+            separableBlur2DFunc = separableBlur_Float16_XXX;
+            break;
+        case PF_FLOAT16_GR:
+            downsampler2DFunc   = downscale2x_Float16_XX;
+            downsamplerCubeFunc = downscale2x_Float16_XX_cube;
+            separableBlur2DFunc = separableBlur_Float16_XX;
+            break;
+        case PF_FLOAT16_R:
+            downsampler2DFunc   = downscale2x_Float16_X;
+            downsamplerCubeFunc = downscale2x_Float16_X_cube;
+            separableBlur2DFunc = separableBlur_Float16_X;
+            break;
         default: //Keep compiler happy
             break;
         }
 
+#if __OGRE_HAVE_SSE
+        //The SSE2 versions produce the exact same output
+        if( downsampler2DFunc == downscale2x_XXXA8888 )
+        {
+            downsampler2DFunc   = downscale2x_XXXA8888_SSE2;
+            separableBlur2DFunc = separableBlur_XXXA8888_SSE2;
+        }
+        else if( downsampler2DFunc == downscale2x_Float32_XXXA )
+        {
+            downsampler2DFunc   = downscale2x_Float32_XXXA_SSE2;
+            separableBlur2DFunc = separableBlur_Float32_XXXA_SSE2;
+        }
+#endif
+
         if( (mDepth == 1 && getNumFaces() == 1 && !downsampler2DFunc) ||
             (getNumFaces() == 6 && (!downsamplerCubeFunc || filter == FILTER_GAUSSIAN_HIGH)) )
         {
@@ -786,9 +952,6 @@ namespace Ogre {
             tmpBuffer1 = OGRE_ALLOC_T( uint8, bufSize, MEMCATEGORY_GENERAL );
         }
 
-        uint32 dstWidth  = mWidth;
-        uint32 dstHeight = mHeight;
-
         int filterIdx = 1;
 
         switch( filter )
@@ -806,74 +969,27 @@ namespace Ogre {
             break;
         }
 
-        const FilterKernel &chosenFilter = c_filterKernels[filterIdx];
-
-        for( uint8 i=1; i<mNumMipmaps + 1; ++i )
-        {
-            uint32 srcWidth    = dstWidth;
-            uint32 srcHeight   = dstHeight;
-            dstWidth   = std::max<uint32>( 1, dstWidth >> 1 );
-            dstHeight  = std::max<uint32>( 1, dstHeight >> 1 );
-
-            if( hasFlag( IF_CUBEMAP ) )
-            {
-                uint8 const *upFaces[6];
-                for( size_t j=0; j<6; ++j )
-                    upFaces[j] = reinterpret_cast<uint8*>( this->getPixelBox( j, i - 1 ).data );
-
-                for( size_t j=0; j<6; ++j )
-                {
-                    PixelBox downFace = this->getPixelBox( j, i );
-                    (*downsamplerCubeFunc)( reinterpret_cast<uint8*>( downFace.data ), upFaces,
-                                            dstWidth, dstHeight, srcWidth, srcHeight,
-                                            chosenFilter.kernel,
-                                            chosenFilter.kernelStartX, chosenFilter.kernelEndX,
-                                            chosenFilter.kernelStartY, chosenFilter.kernelEndY,
-                                            j );
-                }
-            }
-            else
-            {
-                if( filter != FILTER_GAUSSIAN_HIGH )
-                {
-                    (*downsampler2DFunc)( reinterpret_cast<uint8*>( this->getPixelBox( 0, i ).data ),
-                                          reinterpret_cast<uint8*>( this->getPixelBox( 0, i - 1 ).data ),
-                                          dstWidth, dstHeight, srcWidth,
-                                          chosenFilter.kernel,
-                                          chosenFilter.kernelStartX, chosenFilter.kernelEndX,
-                                          chosenFilter.kernelStartY, chosenFilter.kernelEndY );
-                }
-                else
-                {
-                    //Copy 'this' to temp
-                    memcpy( temp.mBuffer, this->getPixelBox( 0, i - 1 ).data,
-                            this->getPixelBox( 0, i - 1 ).getConsecutiveSize() );
-
-                    //The image right now is in both 'this' and temp. We can't touch 'this',
-                    //So we blur temp, and use tmpBuffer1 to store intermediate results
-                    const FilterSeparableKernel &separableKernel = c_filterSeparableKernels[0];
-                    (*separableBlur2DFunc)( tmpBuffer1,
-                                            reinterpret_cast<uint8*>( temp.mBuffer ),
-                                            srcWidth, srcHeight,
-                                            separableKernel.kernel,
-                                            separableKernel.kernelStart, separableKernel.kernelEnd );
-                    //Filter again...
-                    (*separableBlur2DFunc)( tmpBuffer1,
-                                            reinterpret_cast<uint8*>( temp.mBuffer ),
-                                            srcWidth, srcHeight,
-                                            separableKernel.kernel,
-                                            separableKernel.kernelStart, separableKernel.kernelEnd );
-
-                    //Now that temp is blurred, bilinear downsample its contents into 'this'.
-                    (*downsampler2DFunc)( reinterpret_cast<uint8*>( this->getPixelBox( 0, i ).data ),
-                                          reinterpret_cast<uint8*>( temp.mBuffer ),
-                                          dstWidth, dstHeight, srcWidth,
-                                          chosenFilter.kernel,
-                                          chosenFilter.kernelStartX, chosenFilter.kernelEndX,
-                                          chosenFilter.kernelStartY, chosenFilter.kernelEndY );
-                }
-            }
-        }
+        if( numThreads == 0u )
+            numThreads = PlatformInformation::getNumLogicalCores();
+        //Don't bother spawning threads that would have little to do
+        const size_t numPixels = static_cast<size_t>( mWidth ) * mHeight * getNumFaces();
+        numThreads = static_cast<uint32>( std::min<size_t>( numThreads,
+                                                            std::max<size_t>( 1u, numPixels >> 16u ) ) );
+
+        Barrier barrier( numThreads );
+
+        MipmapGenerationTask task;
+        task.image                  = this;
+        task.blurBuffer             = temp.getData();
+        task.tmpBuffer              = tmpBuffer1;
+        task.downsampler2DFunc      = downsampler2DFunc;
+        task.downsamplerCubeFunc    = downsamplerCubeFunc;
+        task.separableBlur2DFunc    = separableBlur2DFunc;
+        task.chosenFilter           = &c_filterKernels[filterIdx];
+        task.gaussianHigh           = filter == FILTER_GAUSSIAN_HIGH;
+        task.barrier                = &barrier;
+
+        Threads::ExecuteUniformScalableTask( &task, numThreads );
 
         if( tmpBuffer1 )
         {
@@ -32,6 +32,8 @@ THE SOFTWARE.
 
 #include "OgreVector3.h"
 #include "OgreMatrix3.h"
+#include "OgreBitwise.h"
+#include "OgreCommon.h"
 
 #include "OgreImageDownsampler.h"
 
@@ -183,6 +185,9 @@ namespace Ogre
     #define OGRE_LIN_TO_GAM( x ) x
     #define OGRE_UINT8 uint8
     #define OGRE_UINT32 uint32
+    #define OGRE_LOAD( x ) x
+    #define OGRE_STORE( x ) static_cast<OGRE_UINT8>( (x) + 0.5f )
+    #define OGRE_STORE_ALPHA( accum, divisor ) static_cast<OGRE_UINT8>( (accum + divisor - 1u) / divisor )
 
     #define ITERATING
     #define OGRE_DOWNSAMPLE_R 0
@@ -350,6 +355,55 @@ namespace Ogre
     #define BLUR_NAME separableBlur_Float32_XA
     #include "OgreImageDownsampler.cpp"
 
+    //-----------------------------------------------------------------------------------
+    //Float16 versions
+    //-----------------------------------------------------------------------------------
+
+    #undef OGRE_UINT8
+    #undef OGRE_UINT32
+    #define OGRE_UINT8 uint16
+    #define OGRE_UINT32 float
+    #undef OGRE_LOAD
+    #undef OGRE_STORE
+    #undef OGRE_STORE_ALPHA
+    #define OGRE_LOAD( x ) Bitwise::halfToFloat( x )
+    #define OGRE_STORE( x ) Bitwise::floatToHalf( x )
+    #define OGRE_STORE_ALPHA( accum, divisor ) Bitwise::floatToHalf( accum / divisor )
+
+    #define OGRE_DOWNSAMPLE_R 0
+    #define OGRE_DOWNSAMPLE_G 1
+    #define OGRE_DOWNSAMPLE_B 2
+    #define OGRE_DOWNSAMPLE_A 3
+    #define OGRE_TOTAL_SIZE 4
+    #define DOWNSAMPLE_NAME downscale2x_Float16_XXXA
+    #define DOWNSAMPLE_CUBE_NAME downscale2x_Float16_XXXA_cube
+    #define BLUR_NAME separableBlur_Float16_XXXA
+    #include "OgreImageDownsampler.cpp"
+
+    #define OGRE_DOWNSAMPLE_R 0
+    #define OGRE_DOWNSAMPLE_G 1
+    #define OGRE_DOWNSAMPLE_B 2
+    #define OGRE_TOTAL_SIZE 3
+    #define DOWNSAMPLE_NAME downscale2x_Float16_XXX
+    #define DOWNSAMPLE_CUBE_NAME downscale2x_Float16_XXX_cube
+    #define BLUR_NAME separableBlur_Float16_XXX
+    #include "OgreImageDownsampler.cpp"
+
+    #define OGRE_DOWNSAMPLE_R 0
+    #define OGRE_DOWNSAMPLE_G 1
+    #define OGRE_TOTAL_SIZE 2
+    #define DOWNSAMPLE_NAME downscale2x_Float16_XX
+    #define DOWNSAMPLE_CUBE_NAME downscale2x_Float16_XX_cube
+    #define BLUR_NAME separableBlur_Float16_XX
+    #include "OgreImageDownsampler.cpp"
+
+    #define OGRE_DOWNSAMPLE_R 0
+    #define OGRE_TOTAL_SIZE 1
+    #define DOWNSAMPLE_NAME downscale2x_Float16_X
+    #define DOWNSAMPLE_CUBE_NAME downscale2x_Float16_X_cube
+    #define BLUR_NAME separableBlur_Float16_X
+    #include "OgreImageDownsampler.cpp"
+
     //-----------------------------------------------------------------------------------
     //sRGB versions
     //-----------------------------------------------------------------------------------
@@ -363,6 +417,12 @@ namespace Ogre
     #undef OGRE_UINT32
     #define OGRE_UINT8 uint8
     #define OGRE_UINT32 uint32
+    #undef OGRE_LOAD
+    #undef OGRE_STORE
+    #undef OGRE_STORE_ALPHA
+    #define OGRE_LOAD( x ) x
+    #define OGRE_STORE( x ) static_cast<OGRE_UINT8>( (x) + 0.5f )
+    #define OGRE_STORE_ALPHA( accum, divisor ) static_cast<OGRE_UINT8>( (accum + divisor - 1u) / divisor )
 
     #define OGRE_DOWNSAMPLE_R 0
     #define OGRE_DOWNSAMPLE_G 1
@@ -433,6 +493,259 @@ namespace Ogre
 
     #undef OGRE_GAM_TO_LIN
     #undef OGRE_LIN_TO_GAM
+    #undef OGRE_UINT8
+    #undef OGRE_UINT32
+    #undef OGRE_LOAD
+    #undef OGRE_STORE
+    #undef OGRE_STORE_ALPHA
+
+#if __OGRE_HAVE_SSE
+namespace Ogre
+{
+    /// Loads an RGBA8 pixel into 4 floats. All values involved in the 8-bit filters are
+    /// integers below 2^24, which makes the float math exact and thus the results
+    /// bit-identical to the integer math of the scalar versions.
+    static inline __m128 loadPixel_XXXA8888_SSE2( uint8 const *srcPtr )
+    {
+        uint32 val;
+        memcpy( &val, srcPtr, sizeof( uint32 ) );
+        const __m128i zero = _mm_setzero_si128();
+        __m128i pixel = _mm_cvtsi32_si128( static_cast<int>( val ) );
+        pixel = _mm_unpacklo_epi8( pixel, zero );
+        pixel = _mm_unpacklo_epi16( pixel, zero );
+        return _mm_cvtepi32_ps( pixel );
+    }
+    //-----------------------------------------------------------------------------------
+    static inline void storePixel_XXXA8888_SSE2( uint8 *dstPtr, __m128 accum, uint32 divisor )
+    {
+        //RGB is rounded to nearest in float, like OGRE_STORE. Alpha is rounded up in
+        //integer math, like OGRE_STORE_ALPHA. Every lane is in range [0; 256) thus the
+        //rounded alpha fits in the low 16 bits of its 32-bit lane.
+        const float invDivisor = 1.0f / divisor;
+        __m128 rgb = _mm_add_ps( _mm_mul_ps( accum, _mm_set1_ps( invDivisor ) ),
+                                 _mm_set1_ps( 0.5f ) );
+        __m128i result = _mm_cvttps_epi32( rgb );
+
+        const uint32 accumA = static_cast<uint32>(
+                    _mm_cvtss_f32( _mm_shuffle_ps( accum, accum, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) );
+        result = _mm_insert_epi16( result, static_cast<int>( (accumA + divisor - 1u) / divisor ), 6 );
+
+        result = _mm_packs_epi32( result, result );
+        result = _mm_packus_epi16( result, result );
+        const uint32 val = static_cast<uint32>( _mm_cvtsi128_si32( result ) );
+        memcpy( dstPtr, &val, sizeof( uint32 ) );
+    }
+    //-----------------------------------------------------------------------------------
+    static inline void storePixel_Float32_XXXA_SSE2( float *dstPtr, __m128 accum, uint32 divisor )
+    {
+        //Same math as OGRE_STORE & OGRE_STORE_ALPHA in their float instantiation, including
+        //the rounding bias they add, so both paths produce the same bits.
+        const float invDivisor = 1.0f / divisor;
+        _mm_storeu_ps( dstPtr, _mm_add_ps( _mm_mul_ps( accum, _mm_set1_ps( invDivisor ) ),
+                                           _mm_set1_ps( 0.5f ) ) );
+        const float accumA = _mm_cvtss_f32( _mm_shuffle_ps( accum, accum, _MM_SHUFFLE( 3, 3, 3, 3 ) ) );
+        dstPtr[3] = (accumA + divisor - 1u) / divisor;
+    }
+    //-----------------------------------------------------------------------------------
+    void downscale2x_XXXA8888_SSE2( uint8 *dstPtr, uint8 const *srcPtr,
+                                    int32 dstWidth, int32 dstHeight,
+                                    int32 srcWidth,
+                                    const uint8 kernel[5][5],
+                                    const int8 kernelStartX, const int8 kernelEndX,
+                                    const int8 kernelStartY, const int8 kernelEndY,
+                                    int32 dstRowStart, int32 dstRowEnd )
+    {
+        dstPtr += dstRowStart * dstWidth * 4;
+        srcPtr += dstRowStart * srcWidth * 2 * 4;
+
+        for( int32 y=dstRowStart; y<dstRowEnd; ++y )
+        {
+            const int kStartY = std::max<int>( -y, kernelStartY );
+            const int kEndY   = std::min<int>( dstHeight - y - 1, kernelEndY );
+
+            for( int32 x=0; x<dstWidth; ++x )
+            {
+                const int kStartX = std::max<int>( -x, kernelStartX );
+                const int kEndX   = std::min<int>( dstWidth - 1 - x, kernelEndX );
+
+                __m128 accum = _mm_setzero_ps();
+                uint32 divisor = 0;
+
+                for( int k_y=kStartY; k_y<=kEndY; ++k_y )
+                {
+                    for( int k_x=kStartX; k_x<=kEndX; ++k_x )
+                    {
+                        const uint32 kernelVal = kernel[k_y+2][k_x+2];
+                        __m128 pixel = loadPixel_XXXA8888_SSE2( srcPtr + (k_y * srcWidth + k_x) * 4 );
+                        accum = _mm_add_ps( accum, _mm_mul_ps( pixel, _mm_set1_ps( (float)kernelVal ) ) );
+                        divisor += kernelVal;
+                    }
+                }
+
+                storePixel_XXXA8888_SSE2( dstPtr, accum, divisor );
+
+                dstPtr += 4;
+                srcPtr += 4 * 2;
+            }
+
+            srcPtr += (srcWidth - dstWidth * 2) * 4;
+            srcPtr += srcWidth * 4;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void downscale2x_Float32_XXXA_SSE2( uint8 *_dstPtr, uint8 const *_srcPtr,
+                                        int32 dstWidth, int32 dstHeight,
+                                        int32 srcWidth,
+                                        const uint8 kernel[5][5],
+                                        const int8 kernelStartX, const int8 kernelEndX,
+                                        const int8 kernelStartY, const int8 kernelEndY,
+                                        int32 dstRowStart, int32 dstRowEnd )
+    {
+        float *dstPtr = reinterpret_cast<float*>( _dstPtr );
+        float const *srcPtr = reinterpret_cast<float const *>( _srcPtr );
+
+        dstPtr += dstRowStart * dstWidth * 4;
+        srcPtr += dstRowStart * srcWidth * 2 * 4;
+
+        for( int32 y=dstRowStart; y<dstRowEnd; ++y )
+        {
+            const int kStartY = std::max<int>( -y, kernelStartY );
+            const int kEndY   = std::min<int>( dstHeight - y - 1, kernelEndY );
+
+            for( int32 x=0; x<dstWidth; ++x )
+            {
+                const int kStartX = std::max<int>( -x, kernelStartX );
+                const int kEndX   = std::min<int>( dstWidth - 1 - x, kernelEndX );
+
+                __m128 accum = _mm_setzero_ps();
+                uint32 divisor = 0;
+
+                for( int k_y=kStartY; k_y<=kEndY; ++k_y )
+                {
+                    for( int k_x=kStartX; k_x<=kEndX; ++k_x )
+                    {
+                        const uint32 kernelVal = kernel[k_y+2][k_x+2];
+                        __m128 pixel = _mm_loadu_ps( srcPtr + (k_y * srcWidth + k_x) * 4 );
+                        accum = _mm_add_ps( accum, _mm_mul_ps( pixel, _mm_set1_ps( (float)kernelVal ) ) );
+                        divisor += kernelVal;
+                    }
+                }
+
+                storePixel_Float32_XXXA_SSE2( dstPtr, accum, divisor );
+
+                dstPtr += 4;
+                srcPtr += 4 * 2;
+            }
+
+            srcPtr += (srcWidth - dstWidth * 2) * 4;
+            srcPtr += srcWidth * 4;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void separableBlur_XXXA8888_SSE2( uint8 *_tmpPtr, uint8 *_srcDstPtr,
+                                      int32 width, int32 height,
+                                      const uint8 kernel[5],
+                                      const int8 kernelStart, const int8 kernelEnd,
+                                      int32 rowStart, int32 rowEnd, bool horizontalPass )
+    {
+        const size_t bytesPerRow = width * 4;
+
+        uint8 *dstPtr       = horizontalPass ? _tmpPtr : _srcDstPtr;
+        uint8 const *srcPtr = horizontalPass ? _srcDstPtr : _tmpPtr;
+        //Distance between taps
+        const size_t tapStride = horizontalPass ? 4u : bytesPerRow;
+
+        dstPtr += rowStart * bytesPerRow;
+        srcPtr += rowStart * bytesPerRow;
+
+        for( int32 y=rowStart; y<rowEnd; ++y )
+        {
+            for( int32 x=0; x<width; ++x )
+            {
+                int kStart, kEnd;
+                if( horizontalPass )
+                {
+                    kStart  = std::max<int>( -x, kernelStart );
+                    kEnd    = std::min<int>( width - 1 - x, kernelEnd );
+                }
+                else
+                {
+                    kStart  = std::max<int>( -y, kernelStart );
+                    kEnd    = std::min<int>( height - y - 1, kernelEnd );
+                }
+
+                __m128 accum = _mm_setzero_ps();
+                uint32 divisor = 0;
+
+                for( int k=kStart; k<=kEnd; ++k )
+                {
+                    const uint32 kernelVal = kernel[k+2];
+                    __m128 pixel = loadPixel_XXXA8888_SSE2( srcPtr + k * (ptrdiff_t)tapStride );
+                    accum = _mm_add_ps( accum, _mm_mul_ps( pixel, _mm_set1_ps( (float)kernelVal ) ) );
+                    divisor += kernelVal;
+                }
+
+                storePixel_XXXA8888_SSE2( dstPtr, accum, divisor );
+
+                dstPtr += 4;
+                srcPtr += 4;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void separableBlur_Float32_XXXA_SSE2( uint8 *_tmpPtr, uint8 *_srcDstPtr,
+                                          int32 width, int32 height,
+                                          const uint8 kernel[5],
+                                          const int8 kernelStart, const int8 kernelEnd,
+                                          int32 rowStart, int32 rowEnd, bool horizontalPass )
+    {
+        const size_t floatsPerRow = width * 4;
+
+        float *dstPtr       = reinterpret_cast<float*>( horizontalPass ? _tmpPtr : _srcDstPtr );
+        float const *srcPtr = reinterpret_cast<float const *>( horizontalPass ? _srcDstPtr :
+                                                                                _tmpPtr );
+        //Distance between taps
+        const size_t tapStride = horizontalPass ? 4u : floatsPerRow;
+
+        dstPtr += rowStart * floatsPerRow;
+        srcPtr += rowStart * floatsPerRow;
+
+        for( int32 y=rowStart; y<rowEnd; ++y )
+        {
+            for( int32 x=0; x<width; ++x )
+            {
+                int kStart, kEnd;
+                if( horizontalPass )
+                {
+                    kStart  = std::max<int>( -x, kernelStart );
+                    kEnd    = std::min<int>( width - 1 - x, kernelEnd );
+                }
+                else
+                {
+                    kStart  = std::max<int>( -y, kernelStart );
+                    kEnd    = std::min<int>( height - y - 1, kernelEnd );
+                }
+
+                __m128 accum = _mm_setzero_ps();
+                uint32 divisor = 0;
+
+                for( int k=kStart; k<=kEnd; ++k )
+                {
+                    const uint32 kernelVal = kernel[k+2];
+                    __m128 pixel = _mm_loadu_ps( srcPtr + k * (ptrdiff_t)tapStride );
+                    accum = _mm_add_ps( accum, _mm_mul_ps( pixel, _mm_set1_ps( (float)kernelVal ) ) );
+                    divisor += kernelVal;
+                }
+
+                storePixel_Float32_XXXA_SSE2( dstPtr, accum, divisor );
+
+                dstPtr += 4;
+                srcPtr += 4;
+            }
+        }
+    }
+}
+#endif
 #else
 
 namespace Ogre
@@ -442,12 +755,16 @@ namespace Ogre
                           int32 srcWidth,
                           const uint8 kernel[5][5],
                           const int8 kernelStartX, const int8 kernelEndX,
-                          const int8 kernelStartY, const int8 kernelEndY )
+                          const int8 kernelStartY, const int8 kernelEndY,
+                          int32 dstRowStart, int32 dstRowEnd )
     {
         OGRE_UINT8 *dstPtr = reinterpret_cast<OGRE_UINT8*>( _dstPtr );
         OGRE_UINT8 const *srcPtr = reinterpret_cast<OGRE_UINT8 const *>( _srcPtr );
 
-        for( int32 y=0; y<dstHeight; ++y )
+        dstPtr += dstRowStart * dstWidth * OGRE_TOTAL_SIZE;
+        srcPtr += dstRowStart * srcWidth * 2 * OGRE_TOTAL_SIZE;
+
+        for( int32 y=dstRowStart; y<dstRowEnd; ++y )
         {
             for( int32 x=0; x<dstWidth; ++x )
             {
@@ -479,19 +796,19 @@ namespace Ogre
                         uint32 kernelVal = kernel[k_y+2][k_x+2];
 
     #ifdef OGRE_DOWNSAMPLE_R
-                        OGRE_UINT32 r = srcPtr[(k_y * srcWidth + k_x) * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_R];
+                        OGRE_UINT32 r = OGRE_LOAD( srcPtr[(k_y * srcWidth + k_x) * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_R] );
                         accumR += OGRE_GAM_TO_LIN( r ) * kernelVal;
     #endif
     #ifdef OGRE_DOWNSAMPLE_G
-                        OGRE_UINT32 g = srcPtr[(k_y * srcWidth + k_x) * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_G];
+                        OGRE_UINT32 g = OGRE_LOAD( srcPtr[(k_y * srcWidth + k_x) * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_G] );
                         accumG += OGRE_GAM_TO_LIN( g ) * kernelVal;
     #endif
     #ifdef OGRE_DOWNSAMPLE_B
-                        OGRE_UINT32 b = srcPtr[(k_y * srcWidth + k_x) * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_B];
+                        OGRE_UINT32 b = OGRE_LOAD( srcPtr[(k_y * srcWidth + k_x) * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_B] );
                         accumB += OGRE_GAM_TO_LIN( b ) * kernelVal;
     #endif
     #ifdef OGRE_DOWNSAMPLE_A
-                        OGRE_UINT32 a = srcPtr[(k_y * srcWidth + k_x) * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_A];
+                        OGRE_UINT32 a = OGRE_LOAD( srcPtr[(k_y * srcWidth + k_x) * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_A] );
                         accumA += a * kernelVal;
     #endif
 
@@ -504,16 +821,16 @@ namespace Ogre
     #endif
 
     #ifdef OGRE_DOWNSAMPLE_R
-                dstPtr[OGRE_DOWNSAMPLE_R] = static_cast<OGRE_UINT8>( OGRE_LIN_TO_GAM( accumR * invDivisor ) + 0.5f );
+                dstPtr[OGRE_DOWNSAMPLE_R] = OGRE_STORE( OGRE_LIN_TO_GAM( accumR * invDivisor ) );
     #endif
     #ifdef OGRE_DOWNSAMPLE_G
-                dstPtr[OGRE_DOWNSAMPLE_G] = static_cast<OGRE_UINT8>( OGRE_LIN_TO_GAM( accumG * invDivisor ) + 0.5f );
+                dstPtr[OGRE_DOWNSAMPLE_G] = OGRE_STORE( OGRE_LIN_TO_GAM( accumG * invDivisor ) );
     #endif
     #ifdef OGRE_DOWNSAMPLE_B
-                dstPtr[OGRE_DOWNSAMPLE_B] = static_cast<OGRE_UINT8>( OGRE_LIN_TO_GAM( accumB * invDivisor ) + 0.5f );
+                dstPtr[OGRE_DOWNSAMPLE_B] = OGRE_STORE( OGRE_LIN_TO_GAM( accumB * invDivisor ) );
     #endif
     #ifdef OGRE_DOWNSAMPLE_A
-                dstPtr[OGRE_DOWNSAMPLE_A] = static_cast<OGRE_UINT8>( (accumA + divisor - 1u) / divisor );
+                dstPtr[OGRE_DOWNSAMPLE_A] = OGRE_STORE_ALPHA( accumA, divisor );
     #endif
 
                 dstPtr += OGRE_TOTAL_SIZE;
@@ -531,7 +848,8 @@ namespace Ogre
                                const uint8 kernel[5][5],
                                const int8 kernelStartX, const int8 kernelEndX,
                                const int8 kernelStartY, const int8 kernelEndY,
-                               uint8 currentFace )
+                               uint8 currentFace,
+                               int32 dstRowStart, int32 dstRowEnd )
     {
         OGRE_UINT8 *dstPtr = reinterpret_cast<OGRE_UINT8*>( _dstPtr );
         OGRE_UINT8 const **allPtr = reinterpret_cast<OGRE_UINT8 const **>( _allPtr );
@@ -560,7 +878,9 @@ namespace Ogre
 
         OGRE_UINT8 const *srcPtr = 0;
 
-        for( int32 y=0; y<dstHeight; ++y )
+        dstPtr += dstRowStart * dstWidth * OGRE_TOTAL_SIZE;
+
+        for( int32 y=dstRowStart; y<dstRowEnd; ++y )
         {
             for( int32 x=0; x<dstWidth; ++x )
             {
@@ -606,19 +926,19 @@ namespace Ogre
                         srcPtr = allPtr[uvi.face] + (iv * srcWidth + iu) * OGRE_TOTAL_SIZE;
 
     #ifdef OGRE_DOWNSAMPLE_R
-                        OGRE_UINT32 r = srcPtr[OGRE_DOWNSAMPLE_R];
+                        OGRE_UINT32 r = OGRE_LOAD( srcPtr[OGRE_DOWNSAMPLE_R] );
                         accumR += OGRE_GAM_TO_LIN( r ) * kernelVal;
     #endif
     #ifdef OGRE_DOWNSAMPLE_G
-                        OGRE_UINT32 g = srcPtr[OGRE_DOWNSAMPLE_G];
+                        OGRE_UINT32 g = OGRE_LOAD( srcPtr[OGRE_DOWNSAMPLE_G] );
                         accumG += OGRE_GAM_TO_LIN( g ) * kernelVal;
     #endif
     #ifdef OGRE_DOWNSAMPLE_B
-                        OGRE_UINT32 b = srcPtr[OGRE_DOWNSAMPLE_B];
+                        OGRE_UINT32 b = OGRE_LOAD( srcPtr[OGRE_DOWNSAMPLE_B] );
                         accumB += OGRE_GAM_TO_LIN( b ) * kernelVal;
     #endif
     #ifdef OGRE_DOWNSAMPLE_A
-                        OGRE_UINT32 a = srcPtr[OGRE_DOWNSAMPLE_A];
+                        OGRE_UINT32 a = OGRE_LOAD( srcPtr[OGRE_DOWNSAMPLE_A] );
                         accumA += a * kernelVal;
     #endif
 
@@ -631,16 +951,16 @@ namespace Ogre
     #endif
 
     #ifdef OGRE_DOWNSAMPLE_R
-                dstPtr[OGRE_DOWNSAMPLE_R] = static_cast<OGRE_UINT8>( OGRE_LIN_TO_GAM( accumR * invDivisor ) + 0.5f );
+                dstPtr[OGRE_DOWNSAMPLE_R] = OGRE_STORE( OGRE_LIN_TO_GAM( accumR * invDivisor ) );
     #endif
     #ifdef OGRE_DOWNSAMPLE_G
-                dstPtr[OGRE_DOWNSAMPLE_G] = static_cast<OGRE_UINT8>( OGRE_LIN_TO_GAM( accumG * invDivisor ) + 0.5f );
+                dstPtr[OGRE_DOWNSAMPLE_G] = OGRE_STORE( OGRE_LIN_TO_GAM( accumG * invDivisor ) );
     #endif
     #ifdef OGRE_DOWNSAMPLE_B
-                dstPtr[OGRE_DOWNSAMPLE_B] = static_cast<OGRE_UINT8>( OGRE_LIN_TO_GAM( accumB * invDivisor ) + 0.5f );
+                dstPtr[OGRE_DOWNSAMPLE_B] = OGRE_STORE( OGRE_LIN_TO_GAM( accumB * invDivisor ) );
     #endif
     #ifdef OGRE_DOWNSAMPLE_A
-                dstPtr[OGRE_DOWNSAMPLE_A] = static_cast<OGRE_UINT8>( (accumA + divisor - 1u) / divisor );
+                dstPtr[OGRE_DOWNSAMPLE_A] = OGRE_STORE_ALPHA( accumA, divisor );
     #endif
 
                 dstPtr += OGRE_TOTAL_SIZE;
@@ -651,149 +971,161 @@ namespace Ogre
     void BLUR_NAME( uint8 *_tmpPtr, uint8 *_srcDstPtr,
                     int32 width, int32 height,
                     const uint8 kernel[5],
-                    const int8 kernelStart, const int8 kernelEnd )
+                    const int8 kernelStart, const int8 kernelEnd,
+                    int32 rowStart, int32 rowEnd, bool horizontalPass )
     {
-        OGRE_UINT8 *dstPtr = reinterpret_cast<OGRE_UINT8*>( _tmpPtr );
-        OGRE_UINT8 const *srcPtr = reinterpret_cast<OGRE_UINT8 const *>( _srcDstPtr );
-
         const size_t bytesPerRow = width * OGRE_TOTAL_SIZE;
 
-        for( int32 y=0; y<height; ++y )
+        if( horizontalPass )
         {
-            for( int32 x=0; x<width; ++x )
+            OGRE_UINT8 *dstPtr = reinterpret_cast<OGRE_UINT8*>( _tmpPtr );
+            OGRE_UINT8 const *srcPtr = reinterpret_cast<OGRE_UINT8 const *>( _srcDstPtr );
+
+            dstPtr += rowStart * bytesPerRow;
+            srcPtr += rowStart * bytesPerRow;
+
+            for( int32 y=rowStart; y<rowEnd; ++y )
             {
+                for( int32 x=0; x<width; ++x )
+                {
     #ifdef OGRE_DOWNSAMPLE_R
-                OGRE_UINT32 accumR = 0;
+                    OGRE_UINT32 accumR = 0;
     #endif
     #ifdef OGRE_DOWNSAMPLE_G
-                OGRE_UINT32 accumG = 0;
+                    OGRE_UINT32 accumG = 0;
     #endif
     #ifdef OGRE_DOWNSAMPLE_B
-                OGRE_UINT32 accumB = 0;
+                    OGRE_UINT32 accumB = 0;
     #endif
     #ifdef OGRE_DOWNSAMPLE_A
-                OGRE_UINT32 accumA = 0;
+                    OGRE_UINT32 accumA = 0;
     #endif
 
-                uint32 divisor = 0;
+                    uint32 divisor = 0;
 
-                int kStartX = std::max<int>( -x, kernelStart );
-                int kEndX   = std::min<int>( width - 1 - x, kernelEnd );
+                    int kStartX = std::max<int>( -x, kernelStart );
+                    int kEndX   = std::min<int>( width - 1 - x, kernelEnd );
 
-                for( int k_x=kStartX; k_x<=kEndX; ++k_x )
-                {
-                    uint32 kernelVal = kernel[k_x+2];
+                    for( int k_x=kStartX; k_x<=kEndX; ++k_x )
+                    {
+                        uint32 kernelVal = kernel[k_x+2];
 
     #ifdef OGRE_DOWNSAMPLE_R
-                    OGRE_UINT32 r = srcPtr[k_x * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_R];
-                    accumR += OGRE_GAM_TO_LIN( r ) * kernelVal;
+                        OGRE_UINT32 r = OGRE_LOAD( srcPtr[k_x * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_R] );
+                        accumR += OGRE_GAM_TO_LIN( r ) * kernelVal;
     #endif
     #ifdef OGRE_DOWNSAMPLE_G
-                    OGRE_UINT32 g = srcPtr[k_x * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_G];
-                    accumG += OGRE_GAM_TO_LIN( g ) * kernelVal;
+                        OGRE_UINT32 g = OGRE_LOAD( srcPtr[k_x * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_G] );
+                        accumG += OGRE_GAM_TO_LIN( g ) * kernelVal;
     #endif
     #ifdef OGRE_DOWNSAMPLE_B
-                    OGRE_UINT32 b = srcPtr[k_x * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_B];
-                    accumB += OGRE_GAM_TO_LIN( b ) * kernelVal;
+                        OGRE_UINT32 b = OGRE_LOAD( srcPtr[k_x * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_B] );
+                        accumB += OGRE_GAM_TO_LIN( b ) * kernelVal;
     #endif
     #ifdef OGRE_DOWNSAMPLE_A
-                    OGRE_UINT32 a = srcPtr[k_x * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_A];
-                    accumA += a * kernelVal;
+                        OGRE_UINT32 a = OGRE_LOAD( srcPtr[k_x * OGRE_TOTAL_SIZE + OGRE_DOWNSAMPLE_A] );
+                        accumA += a * kernelVal;
     #endif
 
-                    divisor += kernelVal;
-                }
+                        divisor += kernelVal;
+                    }
 
     #if defined( OGRE_DOWNSAMPLE_R ) || defined( OGRE_DOWNSAMPLE_G ) || defined( OGRE_DOWNSAMPLE_B )
-                float invDivisor = 1.0f / divisor;
+                    float invDivisor = 1.0f / divisor;
     #endif
 
     #ifdef OGRE_DOWNSAMPLE_R
-                dstPtr[OGRE_DOWNSAMPLE_R] = static_cast<OGRE_UINT8>( OGRE_LIN_TO_GAM( accumR * invDivisor ) + 0.5f );
+                    dstPtr[OGRE_DOWNSAMPLE_R] = OGRE_STORE( OGRE_LIN_TO_GAM( accumR * invDivisor ) );
     #endif
     #ifdef OGRE_DOWNSAMPLE_G
-                dstPtr[OGRE_DOWNSAMPLE_G] = static_cast<OGRE_UINT8>( OGRE_LIN_TO_GAM( accumG * invDivisor ) + 0.5f );
+                    dstPtr[OGRE_DOWNSAMPLE_G] = OGRE_STORE( OGRE_LIN_TO_GAM( accumG * invDivisor ) );
     #endif
     #ifdef OGRE_DOWNSAMPLE_B
-                dstPtr[OGRE_DOWNSAMPLE_B] = static_cast<OGRE_UINT8>( OGRE_LIN_TO_GAM( accumB * invDivisor ) + 0.5f );
+                    dstPtr[OGRE_DOWNSAMPLE_B] = OGRE_STORE( OGRE_LIN_TO_GAM( accumB * invDivisor ) );
     #endif
     #ifdef OGRE_DOWNSAMPLE_A
-                dstPtr[OGRE_DOWNSAMPLE_A] = static_cast<OGRE_UINT8>( (accumA + divisor - 1u) / divisor );
+                    dstPtr[OGRE_DOWNSAMPLE_A] = OGRE_STORE_ALPHA( accumA, divisor );
     #endif
 
-                dstPtr += OGRE_TOTAL_SIZE;
-                srcPtr += OGRE_TOTAL_SIZE;
+                    dstPtr += OGRE_TOTAL_SIZE;
+                    srcPtr += OGRE_TOTAL_SIZE;
+                }
             }
         }
+        else
+        {
+            OGRE_UINT8 *dstPtr = reinterpret_cast<OGRE_UINT8*>( _srcDstPtr );
+            OGRE_UINT8 const *srcPtr = reinterpret_cast<OGRE_UINT8 const *>( _tmpPtr );
 
-        dstPtr = reinterpret_cast<OGRE_UINT8*>( _srcDstPtr );
-        srcPtr = reinterpret_cast<OGRE_UINT8 const *>( _tmpPtr );
+            dstPtr += rowStart * bytesPerRow;
+            srcPtr += rowStart * bytesPerRow;
 
-        for( int32 y=0; y<height; ++y )
-        {
-            for( int32 x=0; x<width; ++x )
+            for( int32 y=rowStart; y<rowEnd; ++y )
             {
+                for( int32 x=0; x<width; ++x )
+                {
     #ifdef OGRE_DOWNSAMPLE_R
-                OGRE_UINT32 accumR = 0;
+                    OGRE_UINT32 accumR = 0;
     #endif
     #ifdef OGRE_DOWNSAMPLE_G
-                OGRE_UINT32 accumG = 0;
+                    OGRE_UINT32 accumG = 0;
     #endif
     #ifdef OGRE_DOWNSAMPLE_B
-                OGRE_UINT32 accumB = 0;
+                    OGRE_UINT32 accumB = 0;
     #endif
     #ifdef OGRE_DOWNSAMPLE_A
-                OGRE_UINT32 accumA = 0;
+                    OGRE_UINT32 accumA = 0;
     #endif
 
-                uint32 divisor = 0;
+                    uint32 divisor = 0;
 
-                int kStartY = std::max<int>( -y, kernelStart );
-                int kEndY   = std::min<int>( height - y - 1, kernelEnd );
+                    int kStartY = std::max<int>( -y, kernelStart );
+                    int kEndY   = std::min<int>( height - y - 1, kernelEnd );
 
-                for( int k_y=kStartY; k_y<=kEndY; ++k_y )
-                {
-                    uint32 kernelVal = kernel[k_y+2];
+                    for( int k_y=kStartY; k_y<=kEndY; ++k_y )
+                    {
+                        uint32 kernelVal = kernel[k_y+2];
 
     #ifdef OGRE_DOWNSAMPLE_R
-                    OGRE_UINT32 r = srcPtr[k_y * bytesPerRow + OGRE_DOWNSAMPLE_R];
-                    accumR += OGRE_GAM_TO_LIN( r ) * kernelVal;
+                        OGRE_UINT32 r = OGRE_LOAD( srcPtr[k_y * bytesPerRow + OGRE_DOWNSAMPLE_R] );
+                        accumR += OGRE_GAM_TO_LIN( r ) * kernelVal;
     #endif
     #ifdef OGRE_DOWNSAMPLE_G
-                    OGRE_UINT32 g = srcPtr[k_y * bytesPerRow + OGRE_DOWNSAMPLE_G];
-                    accumG += OGRE_GAM_TO_LIN( g ) * kernelVal;
+                        OGRE_UINT32 g = OGRE_LOAD( srcPtr[k_y * bytesPerRow + OGRE_DOWNSAMPLE_G] );
+                        accumG += OGRE_GAM_TO_LIN( g ) * kernelVal;
     #endif
     #ifdef OGRE_DOWNSAMPLE_B
-                    OGRE_UINT32 b = srcPtr[k_y * bytesPerRow + OGRE_DOWNSAMPLE_B];
-                    accumB += OGRE_GAM_TO_LIN( b ) * kernelVal;
+                        OGRE_UINT32 b = OGRE_LOAD( srcPtr[k_y * bytesPerRow + OGRE_DOWNSAMPLE_B] );
+                        accumB += OGRE_GAM_TO_LIN( b ) * kernelVal;
     #endif
     #ifdef OGRE_DOWNSAMPLE_A
-                    OGRE_UINT32 a = srcPtr[k_y * bytesPerRow + OGRE_DOWNSAMPLE_A];
-                    accumA += a * kernelVal;
+                        OGRE_UINT32 a = OGRE_LOAD( srcPtr[k_y * bytesPerRow + OGRE_DOWNSAMPLE_A] );
+                        accumA += a * kernelVal;
     #endif
 
-                    divisor += kernelVal;
-                }
+                        divisor += kernelVal;
+                    }
 
     #if defined( OGRE_DOWNSAMPLE_R ) || defined( OGRE_DOWNSAMPLE_G ) || defined( OGRE_DOWNSAMPLE_B )
-                float invDivisor = 1.0f / divisor;
+                    float invDivisor = 1.0f / divisor;
     #endif
 
     #ifdef OGRE_DOWNSAMPLE_R
-                dstPtr[OGRE_DOWNSAMPLE_R] = static_cast<OGRE_UINT8>( OGRE_LIN_TO_GAM( accumR * invDivisor ) + 0.5f );
+                    dstPtr[OGRE_DOWNSAMPLE_R] = OGRE_STORE( OGRE_LIN_TO_GAM( accumR * invDivisor ) );
     #endif
     #ifdef OGRE_DOWNSAMPLE_G
-                dstPtr[OGRE_DOWNSAMPLE_G] = static_cast<OGRE_UINT8>( OGRE_LIN_TO_GAM( accumG * invDivisor ) + 0.5f );
+                    dstPtr[OGRE_DOWNSAMPLE_G] = OGRE_STORE( OGRE_LIN_TO_GAM( accumG * invDivisor ) );
     #endif
     #ifdef OGRE_DOWNSAMPLE_B
-                dstPtr[OGRE_DOWNSAMPLE_B] = static_cast<OGRE_UINT8>( OGRE_LIN_TO_GAM( accumB * invDivisor ) + 0.5f );
+                    dstPtr[OGRE_DOWNSAMPLE_B] = OGRE_STORE( OGRE_LIN_TO_GAM( accumB * invDivisor ) );
     #endif
     #ifdef OGRE_DOWNSAMPLE_A
-                dstPtr[OGRE_DOWNSAMPLE_A] = static_cast<OGRE_UINT8>( (accumA + divisor - 1u) / divisor );
+                    dstPtr[OGRE_DOWNSAMPLE_A] = OGRE_STORE_ALPHA( accumA, divisor );
     #endif
 
-                dstPtr += OGRE_TOTAL_SIZE;
-                srcPtr += OGRE_TOTAL_SIZE;
+                    dstPtr += OGRE_TOTAL_SIZE;
+                    srcPtr += OGRE_TOTAL_SIZE;
+                }
             }
         }
     }
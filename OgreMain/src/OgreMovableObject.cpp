@@ -489,73 +489,55 @@ namespace Ogre {
             ArrayReal * RESTRICT_ALIAS distanceToCamera = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
                                                                         (objData.mDistanceToCamera);
 
-            //Test all 6 planes and AND the dot product. If one is false, then we're not visible
-            ArrayReal dotResult;
-            ArrayMaskR mask;
-            ArrayVector3 centerPlusFlippedHS;
-            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                 planes[0].signFlip;
-            dotResult = planes[0].planeNormal.dotProduct( centerPlusFlippedHS );
-            mask = Mathlib::CompareGreater( dotResult, planes[0].planeNegD );
-
-            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                 planes[1].signFlip;
-            dotResult = planes[1].planeNormal.dotProduct( centerPlusFlippedHS );
-            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[1].planeNegD ) );
-
-            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                 planes[2].signFlip;
-            dotResult = planes[2].planeNormal.dotProduct( centerPlusFlippedHS );
-            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[2].planeNegD ) );
-
-            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                 planes[3].signFlip;
-            dotResult = planes[3].planeNormal.dotProduct( centerPlusFlippedHS );
-            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[3].planeNegD ) );
-
-            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                 planes[4].signFlip;
-            dotResult = planes[4].planeNormal.dotProduct( centerPlusFlippedHS );
-            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[4].planeNegD ) );
-
-            centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
-                                                                 planes[5].signFlip;
-            dotResult = planes[5].planeNormal.dotProduct( centerPlusFlippedHS );
-            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[5].planeNegD ) );
-
-            //Always pass the test if any of the components were
-            //Infinity (dot product above could've caused nans)
-            ArrayMaskR tmpMask = Mathlib::Or(
-                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[0] ),
-                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[1] ) );
-            mask = Mathlib::Or( Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[2] ),
-                                mask );
-
-            ArrayReal distance = lodCameraPos.distance( objData.mWorldAabb->mCenter );
-            ArrayMaskR isCloseEnough = Mathlib::CompareLessEqual( distance, *worldRadius + *upperDistance );
-            isCloseEnough = Mathlib::Or( ignoreRenderingDistance, isCloseEnough );
-
-            mask = Mathlib::And( Mathlib::Or( mask, tmpMask ), isCloseEnough );
-
             //isVisible = isVisible() && (isCaster || includeNonCasters)
             ArrayMaskI isVisible = Mathlib::And(
                                 Mathlib::TestFlags4( *visibilityFlags,
                                                         Mathlib::SetAll( LAYER_VISIBILITY ) ),
                                 Mathlib::TestFlags4( Mathlib::Or( *visibilityFlags, includeNonCasters ),
                                                         Mathlib::SetAll( LAYER_SHADOW_CASTER ) ) );
+            // isVisible &= (sceneFlags & visibilityFlags) != 0
+            isVisible = Mathlib::And( isVisible, Mathlib::TestFlags4( sceneFlags, *visibilityFlags ) );
 
             //Project the vector to the object into the camera's plane. This allows
             //us to use depth for sorting, rather than euclidean distance
             *distanceToCamera = cameraDir.dotProduct( objData.mWorldAabb->mCenter -
                                                       cameraPos ) - *worldRadius;
 
-            //Fuse result with visibility flag
-            // finalMask = ((visible|infinite_aabb) & sceneFlags & visibilityFlags) != 0 ? 0xffffffff : 0
-            ArrayMaskI finalMask = Mathlib::TestFlags4( CastRealToInt( mask ),
-                                                        Mathlib::And( sceneFlags, *visibilityFlags ) );
-            finalMask               = Mathlib::And( finalMask, isVisible );
+            uint32 scalarMask = BooleanMask4::getScalarMask( isVisible );
+
+            //Whole block is hidden, no need to look at the planes
+            if( scalarMask )
+            {
+                ArrayReal distance = lodCameraPos.distance( objData.mWorldAabb->mCenter );
+                ArrayMaskR isCloseEnough = Mathlib::CompareLessEqual( distance,
+                                                                      *worldRadius + *upperDistance );
+                isCloseEnough = Mathlib::Or( ignoreRenderingDistance, isCloseEnough );
+
+                //Always pass the test if any of the components were
+                //Infinity (dot product below could've caused nans)
+                const ArrayMaskR infMask = Mathlib::Or( Mathlib::Or(
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[0] ),
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[1] ) ),
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[2] ) );
 
-            const uint32 scalarMask = BooleanMask4::getScalarMask( finalMask );
+                //Test the planes and AND the dot products. If one is false, then we're not
+                //visible. Stop as soon as the whole block is out, which is common when the
+                //objects are sorted spatially (see ObjectMemoryManager::sortSpatially)
+                ArrayMaskR mask = Mathlib::And( CastIntToReal( isVisible ), isCloseEnough );
+                scalarMask = BooleanMask4::getScalarMask( mask );
+
+                for( size_t j=0; j<6 && scalarMask; ++j )
+                {
+                    const ArrayVector3 centerPlusFlippedHS =
+                            objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                          planes[j].signFlip;
+                    const ArrayReal dotResult = planes[j].planeNormal.dotProduct( centerPlusFlippedHS );
+                    mask = Mathlib::And( mask, Mathlib::Or( Mathlib::CompareGreater(
+                                                                dotResult, planes[j].planeNegD ),
+                                                            infMask ) );
+                    scalarMask = BooleanMask4::getScalarMask( mask );
+                }
+            }
 
             for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
             {
@@ -574,6 +556,147 @@ namespace Ogre {
         culledObjects.swap( outCulledObjects );
     }
     //-----------------------------------------------------------------------
+    void MovableObject::cullFrustums( const size_t numNodes, ObjectData objData,
+                                      const size_t numFrustums,
+                                      BatchedCullFrustum const * const *frustums,
+                                      const uint32 *sceneVisibilityFlags,
+                                      MovableObjectArray * const *outCulledObjects,
+                                      bool casterPass )
+    {
+        //Same tests as cullFrustum, but every block of objects is loaded once
+        //and then tested against all frustums.
+        struct ArrayPlane
+        {
+            ArrayVector3    planeNormal;
+            ArrayVector3    signFlip;
+            ArrayReal       planeNegD;
+        };
+        struct ArrayFrustum
+        {
+            ArrayPlane      planes[6];
+            ArrayInt        sceneFlags;
+            ArrayVector3    lodCameraPos;
+            ArrayMaskR      ignoreRenderingDistance;
+        };
+
+        ArrayFrustum *arrayFrustums = OGRE_ALLOC_T_SIMD( ArrayFrustum, numFrustums,
+                                                         MEMCATEGORY_SCENE_CONTROL );
+
+        for( size_t i=0; i<numFrustums; ++i )
+        {
+            const Plane *frustumPlanes = frustums[i]->planes;
+            for( size_t j=0; j<6; ++j )
+            {
+                arrayFrustums[i].planes[j].planeNormal.setAll( frustumPlanes[j].normal );
+                arrayFrustums[i].planes[j].signFlip.setAll( frustumPlanes[j].normal );
+                arrayFrustums[i].planes[j].signFlip.setToSign();
+                arrayFrustums[i].planes[j].planeNegD = Mathlib::SetAll( -frustumPlanes[j].d );
+            }
+            arrayFrustums[i].sceneFlags = Mathlib::SetAll( sceneVisibilityFlags[i] &
+                                                           RESERVED_VISIBILITY_FLAGS );
+
+            const Camera *lodCamera = frustums[i]->lodCamera;
+            assert( lodCamera && "Batched frustums must have a LOD camera" );
+            arrayFrustums[i].lodCameraPos.setAll( lodCamera->_getCachedDerivedPosition() );
+            arrayFrustums[i].ignoreRenderingDistance = CastIntToReal(
+                        Mathlib::SetAll( lodCamera->getUseRenderingDistance() ? 0 : 0xffffffff ) );
+        }
+
+        ArrayInt includeNonCasters = Mathlib::SetAll( casterPass ? 0 : LAYER_SHADOW_CASTER );
+
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            ArrayInt * RESTRICT_ALIAS visibilityFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
+                                                                        (objData.mVisibilityFlags);
+            ArrayReal * RESTRICT_ALIAS worldRadius = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                        (objData.mWorldRadius);
+            ArrayReal * RESTRICT_ALIAS upperDistance = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                        (objData.mUpperDistance[casterPass]);
+
+            //Everything that doesn't depend on the frustum
+            ArrayMaskR infMask = Mathlib::Or( Mathlib::Or(
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[0] ),
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[1] ) ),
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[2] ) );
+
+            const ArrayReal maxDistance = *worldRadius + *upperDistance;
+
+            ArrayMaskI isVisible = Mathlib::And(
+                                Mathlib::TestFlags4( *visibilityFlags,
+                                                        Mathlib::SetAll( LAYER_VISIBILITY ) ),
+                                Mathlib::TestFlags4( Mathlib::Or( *visibilityFlags, includeNonCasters ),
+                                                        Mathlib::SetAll( LAYER_SHADOW_CASTER ) ) );
+
+            //Whole block is hidden, no need to look at the frustums
+            if( !BooleanMask4::getScalarMask( isVisible ) )
+            {
+                objData.advanceFrustumPack();
+                continue;
+            }
+
+            //Views are usually close to each other and share the LOD camera
+            //(i.e. all shadow maps), avoid recalculating the distance.
+            ArrayMaskR isCloseEnough = infMask;
+
+            for( size_t j=0; j<numFrustums; ++j )
+            {
+                const ArrayFrustum &frustum = arrayFrustums[j];
+
+                if( j == 0 || frustums[j]->lodCamera != frustums[j-1]->lodCamera )
+                {
+                    ArrayReal distance = frustum.lodCameraPos.distance( objData.mWorldAabb->mCenter );
+                    isCloseEnough = Mathlib::CompareLessEqual( distance, maxDistance );
+                    isCloseEnough = Mathlib::Or( frustum.ignoreRenderingDistance, isCloseEnough );
+                }
+
+                ArrayMaskR mask = infMask;
+                ArrayMaskR planesMask;
+                ArrayVector3 centerPlusFlippedHS;
+                ArrayReal dotResult;
+
+                centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
+                                                                     frustum.planes[0].signFlip;
+                dotResult = frustum.planes[0].planeNormal.dotProduct( centerPlusFlippedHS );
+                planesMask = Mathlib::CompareGreater( dotResult, frustum.planes[0].planeNegD );
+
+                //Stop as soon as the whole block is out
+                for( size_t k=1; k<6 &&
+                     BooleanMask4::getScalarMask( Mathlib::Or( planesMask, mask ) ); ++k )
+                {
+                    centerPlusFlippedHS = objData.mWorldAabb->mCenter +
+                                          objData.mWorldAabb->mHalfSize * frustum.planes[k].signFlip;
+                    dotResult = frustum.planes[k].planeNormal.dotProduct( centerPlusFlippedHS );
+                    planesMask = Mathlib::And( planesMask,
+                                               Mathlib::CompareGreater( dotResult,
+                                                                        frustum.planes[k].planeNegD ) );
+                }
+
+                mask = Mathlib::And( Mathlib::Or( planesMask, mask ), isCloseEnough );
+
+                ArrayMaskI finalMask = Mathlib::TestFlags4( CastRealToInt( mask ),
+                                                            Mathlib::And( frustum.sceneFlags,
+                                                                          *visibilityFlags ) );
+                finalMask = Mathlib::And( finalMask, isVisible );
+
+                const uint32 scalarMask = BooleanMask4::getScalarMask( finalMask );
+
+                if( scalarMask )
+                {
+                    MovableObjectArray &culledObjects = *outCulledObjects[j];
+                    for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+                    {
+                        if( IS_BIT_SET( k, scalarMask ) )
+                            culledObjects.push_back( objData.mOwner[k] );
+                    }
+                }
+            }
+
+            objData.advanceFrustumPack();
+        }
+
+        OGRE_FREE_SIMD( arrayFrustums, MEMCATEGORY_SCENE_CONTROL );
+    }
+    //-----------------------------------------------------------------------
     void MovableObject::cullLights( const size_t numNodes, ObjectData objData,
                                     LightListInfo &outGlobalLightList, const FrustumVec &frustums,
                                     const FrustumVec &cubemapFrustums )
@@ -883,6 +1006,70 @@ namespace Ogre {
             outBox->setExtents( vMin, vMax );
     }
     //-----------------------------------------------------------------------
+    bool MovableObject::hasCastersInVolume( const size_t numNodes, ObjectData objData,
+                                            uint32 sceneVisibilityFlags, const Plane planes[6] )
+    {
+        //Same test as in cullFrustum
+        struct ArrayPlane
+        {
+            ArrayVector3    planeNormal;
+            ArrayVector3    signFlip;
+            ArrayReal       planeNegD;
+        };
+
+        ArrayPlane arrayPlanes[6];
+        for( size_t i=0; i<6; ++i )
+        {
+            arrayPlanes[i].planeNormal.setAll( planes[i].normal );
+            arrayPlanes[i].signFlip.setAll( planes[i].normal );
+            arrayPlanes[i].signFlip.setToSign();
+            arrayPlanes[i].planeNegD = Mathlib::SetAll( -planes[i].d );
+        }
+
+        ArrayInt sceneFlags = Mathlib::SetAll( sceneVisibilityFlags );
+
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            ArrayInt * RESTRICT_ALIAS visibilityFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
+                                                                        (objData.mVisibilityFlags);
+
+            ArrayMaskR mask = CastIntToReal( Mathlib::SetAll( 0xffffffff ) );
+            for( size_t j=0; j<6; ++j )
+            {
+                ArrayVector3 centerPlusFlippedHS = objData.mWorldAabb->mCenter +
+                                                   objData.mWorldAabb->mHalfSize *
+                                                   arrayPlanes[j].signFlip;
+                ArrayReal dotResult = arrayPlanes[j].planeNormal.dotProduct( centerPlusFlippedHS );
+                mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult,
+                                                                    arrayPlanes[j].planeNegD ) );
+            }
+
+            //Always pass the test if any of the components were
+            //Infinity (dot product above could've caused nans)
+            ArrayMaskR infMask = Mathlib::Or( Mathlib::Or(
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[0] ),
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[1] ) ),
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[2] ) );
+            mask = Mathlib::Or( mask, infMask );
+
+            ArrayMaskI isVisible = Mathlib::TestFlags4( *visibilityFlags,
+                                                        Mathlib::SetAll( LAYER_VISIBILITY ) );
+            ArrayMaskI isCaster  = Mathlib::TestFlags4( *visibilityFlags,
+                                                        Mathlib::SetAll( LAYER_SHADOW_CASTER ) );
+
+            ArrayMaskI finalMask = Mathlib::TestFlags4( CastRealToInt( mask ),
+                                                        Mathlib::And( sceneFlags, *visibilityFlags ) );
+            finalMask = Mathlib::And( finalMask, Mathlib::And( isVisible, isCaster ) );
+
+            if( BooleanMask4::getScalarMask( finalMask ) )
+                return true;
+
+            objData.advanceFrustumPack();
+        }
+
+        return false;
+    }
+    //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
     MovableObject* MovableObjectFactory::createInstance( IdType id,
                                 ObjectMemoryManager *objectMemoryManager, SceneManager* manager,
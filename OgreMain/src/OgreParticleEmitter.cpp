@@ -29,6 +29,7 @@ THE SOFTWARE.
 
 #include "OgreParticleEmitter.h"
 #include "OgreParticleEmitterFactory.h"
+#include "OgreParticleSystem.h"
 
 namespace Ogre
 {
@@ -57,6 +58,22 @@ namespace Ogre
     EmitterCommands::CmdName ParticleEmitter::msNameCmd;
     EmitterCommands::CmdEmittedEmitter ParticleEmitter::msEmittedEmitterCmd;
 
+    /// Same as Vector3::randomDeviant, but with the random rotation supplied by the caller
+    static Vector3 randomDeviant( const Vector3 &dir, const Radian &angle,
+                                  const Vector3 &up, Real randomUnit )
+    {
+        Vector3 newUp = up == Vector3::ZERO ? dir.perpendicular() : up;
+
+        // Rotate up vector by random amount around this
+        Quaternion q;
+        q.FromAngleAxis( Radian( randomUnit * Math::TWO_PI ), dir );
+        newUp = q * newUp;
+
+        // Finally rotate this by given angle around randomised up
+        q.FromAngleAxis( angle, newUp );
+        return q * dir;
+    }
+
 
     //-----------------------------------------------------------------------
     ParticleEmitter::ParticleEmitter(ParticleSystem* psys)
@@ -239,10 +256,11 @@ namespace Ogre
             if (mAngle != Radian(0))
             {
                 // Randomise angle
-                Radian angle = Math::UnitRandom() * mAngle;
+                Radian angle = mParent->_getUnitRandom() * mAngle;
 
                 // Randomise direction
-                destVector = particleDir.randomDeviant( angle );
+                destVector = randomDeviant( particleDir, angle, Vector3::ZERO,
+                                            mParent->_getUnitRandom() );
             }
             else
             {
@@ -255,10 +273,10 @@ namespace Ogre
             if (mAngle != Radian(0))
             {
                 // Randomise angle
-                Radian angle = Math::UnitRandom() * mAngle;
+                Radian angle = mParent->_getUnitRandom() * mAngle;
 
                 // Randomise direction
-                destVector = mDirection.randomDeviant(angle, mUp);
+                destVector = randomDeviant( mDirection, angle, mUp, mParent->_getUnitRandom() );
             }
             else
             {
@@ -276,7 +294,7 @@ namespace Ogre
         Real scalar;
         if (mMinSpeed != mMaxSpeed)
         {
-            scalar = mMinSpeed + (Math::UnitRandom() * (mMaxSpeed - mMinSpeed));
+            scalar = mMinSpeed + (mParent->_getUnitRandom() * (mMaxSpeed - mMinSpeed));
         }
         else
         {
@@ -290,7 +308,7 @@ namespace Ogre
     {
         if (mMaxTTL != mMinTTL)
         {
-            return mMinTTL + (Math::UnitRandom() * (mMaxTTL - mMinTTL));
+            return mMinTTL + (mParent->_getUnitRandom() * (mMaxTTL - mMinTTL));
         }
         else
         {
@@ -350,11 +368,10 @@ namespace Ogre
         if (mColourRangeStart != mColourRangeEnd)
         {
             // Randomise
-            //Real t = Math::UnitRandom();
-            destColour.r = mColourRangeStart.r + (Math::UnitRandom() * (mColourRangeEnd.r - mColourRangeStart.r));
-            destColour.g = mColourRangeStart.g + (Math::UnitRandom() * (mColourRangeEnd.g - mColourRangeStart.g));
-            destColour.b = mColourRangeStart.b + (Math::UnitRandom() * (mColourRangeEnd.b - mColourRangeStart.b));
-            destColour.a = mColourRangeStart.a + (Math::UnitRandom() * (mColourRangeEnd.a - mColourRangeStart.a));
+            destColour.r = mColourRangeStart.r + (mParent->_getUnitRandom() * (mColourRangeEnd.r - mColourRangeStart.r));
+            destColour.g = mColourRangeStart.g + (mParent->_getUnitRandom() * (mColourRangeEnd.g - mColourRangeStart.g));
+            destColour.b = mColourRangeStart.b + (mParent->_getUnitRandom() * (mColourRangeEnd.b - mColourRangeStart.b));
+            destColour.a = mColourRangeStart.a + (mParent->_getUnitRandom() * (mColourRangeEnd.a - mColourRangeStart.a));
         }
         else
         {
@@ -598,7 +615,7 @@ namespace Ogre
             }
             else
             {
-                mDurationRemain = Math::RangeRandom(mDurationMin, mDurationMax);
+                mDurationRemain = mParent->_getRangeRandom(mDurationMin, mDurationMax);
             }
         }
         else
@@ -610,7 +627,7 @@ namespace Ogre
             }
             else
             {
-                mRepeatDelayRemain = Math::RangeRandom(mRepeatDelayMax, mRepeatDelayMin);
+                mRepeatDelayRemain = mParent->_getRangeRandom(mRepeatDelayMax, mRepeatDelayMin);
             }
 
         }
@@ -73,7 +73,7 @@ namespace Ogre {
 
         Real getValue(void) const { return 0; } // N/A
 
-        void setValue(Real value) { mTarget->_update(value); }
+        void setValue(Real value) { mTarget->_addPendingUpdateTime(value); }
 
     };
     //-----------------------------------------------------------------------
@@ -95,6 +95,8 @@ namespace Ogre {
         mTimeSinceLastVisible(0),
         mLastVisibleFrame(Root::getSingleton().getNextFrameNumber()),
         mTimeController(0),
+        mPendingUpdate(false),
+        mRandomState(1u),
         mEmittedEmitterPoolInitialised(false),
         mIsEmitting(true),
         mRenderer(0), 
@@ -112,6 +114,9 @@ namespace Ogre {
         // Default to billboard renderer
         setRenderer("billboard");
 
+        setRandomSeed( static_cast<uint32>( Math::UnitRandom() * 4294967295.0 ) ^
+                       static_cast<uint32>( id ) );
+
         //By default most particles don't cast shadows.
         setCastShadows( false );
 
@@ -127,6 +132,12 @@ namespace Ogre {
             mTimeController = 0;
         }
 
+        if( mPendingUpdate )
+        {
+            mManager->_removeParticleSystemToUpdate( this );
+            mPendingUpdate = false;
+        }
+
         // Arrange for the deletion of emitters & affectors
         removeAllEmitters();
         removeAllEmittedEmitters();
@@ -135,11 +146,16 @@ namespace Ogre {
         // Deallocate all particles
         destroyVisualParticles(0, mParticlePool.size());
         // Free pool items
-        ParticlePool::iterator i;
-        for (i = mParticlePool.begin(); i != mParticlePool.end(); ++i)
+        ParticleBlockVec::const_iterator itor = mParticleBlocks.begin();
+        ParticleBlockVec::const_iterator end  = mParticleBlocks.end();
+        while( itor != end )
         {
-            OGRE_DELETE *i;
+            OGRE_DELETE_ARRAY_T( itor->particles, Particle, itor->numParticles,
+                                 MEMCATEGORY_SCENE_OBJECTS );
+            ++itor;
         }
+        mParticleBlocks.clear();
+        mParticlePool.clear();
 
         if (mRenderer)
         {
@@ -339,10 +355,84 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     void ParticleSystem::_update(Real timeElapsed)
+    {
+        if( !prepareUpdate( timeElapsed ) )
+            return;
+
+        // We may be called before the SceneManager updated the transforms
+        mParentNode->_getFullTransformUpdated();
+
+        updateImpl( timeElapsed );
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::_addPendingUpdateTime( Real timeElapsed )
+    {
+        //Keep the steps apart so that they're simulated as if _update had been called
+        //every time. Bound the queue in case the SceneManager isn't updated for a while.
+        if( mPendingUpdateTimes.size() < 256u )
+            mPendingUpdateTimes.push_back( timeElapsed );
+        else
+            mPendingUpdateTimes.back() += timeElapsed;
+
+        if( !mPendingUpdate )
+        {
+            mPendingUpdate = true;
+            mManager->_addParticleSystemToUpdate( this );
+        }
+    }
+    //-----------------------------------------------------------------------
+    bool ParticleSystem::_prepareThreadedUpdate(void)
+    {
+        mPendingUpdate = false;
+
+        Real totalTime = 0;
+        vector<Real>::type::const_iterator itor = mPendingUpdateTimes.begin();
+        vector<Real>::type::const_iterator end  = mPendingUpdateTimes.end();
+        while( itor != end )
+            totalTime += *itor++;
+
+        if( !prepareUpdate( totalTime ) )
+        {
+            mPendingUpdateTimes.clear();
+            return false;
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::_updateThreaded(void)
+    {
+        vector<Real>::type::const_iterator itor = mPendingUpdateTimes.begin();
+        vector<Real>::type::const_iterator end  = mPendingUpdateTimes.end();
+
+        while( itor != end )
+            updateImpl( *itor++ * mSpeedFactor );
+
+        mPendingUpdateTimes.clear();
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::setRandomSeed( uint32 seed )
+    {
+        //Scramble the seed so that close seeds don't produce similar sequences
+        mRandomState = seed * 2654435761u + 0x9E3779B9u;
+        if( !mRandomState )
+            mRandomState = 0x9E3779B9u; //Xorshift can't leave the zero state
+    }
+    //-----------------------------------------------------------------------
+    Real ParticleSystem::_getUnitRandom(void)
+    {
+        //Xorshift32
+        mRandomState ^= mRandomState << 13u;
+        mRandomState ^= mRandomState >> 17u;
+        mRandomState ^= mRandomState << 5u;
+        return static_cast<Real>( mRandomState >> 8u ) * (1.0f / 16777215.0f);
+    }
+    //-----------------------------------------------------------------------
+    bool ParticleSystem::prepareUpdate( Real &timeElapsed )
     {
         // Only update if attached to a node
         if (!mParentNode)
-            return;
+            return false;
 
         Real nonvisibleTimeout = mNonvisibleTimeoutSet ?
             mNonvisibleTimeout : msDefaultNonvisibleTimeout;
@@ -358,7 +448,7 @@ namespace Ogre {
                 if (mTimeSinceLastVisible >= nonvisibleTimeout)
                 {
                     // No update
-                    return;
+                    return false;
                 }
             }
         }
@@ -372,6 +462,11 @@ namespace Ogre {
         // Initialise emitted emitters list if not done already
         initialiseEmittedEmitters();
 
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::updateImpl( Real timeElapsed )
+    {
         Real iterationInterval = mIterationIntervalSet ? 
             mIterationInterval : msDefaultIterationInterval;
         if (iterationInterval > 0)
@@ -410,21 +505,19 @@ namespace Ogre {
 
         if (!mBoundsAutoUpdate && mBoundsUpdateTime > 0.0f)
             mBoundsUpdateTime -= timeElapsed; // count down 
-        _updateBounds();
+        updateBoundsImpl();
 
     }
     //-----------------------------------------------------------------------
     void ParticleSystem::_expire(Real timeElapsed)
     {
-        ActiveParticleList::iterator i, itEnd;
         Particle* pParticle;
         ParticleEmitter* pParticleEmitter;
 
-        itEnd = mActiveParticles.end();
-
-        for (i = mActiveParticles.begin(); i != itEnd; )
+        size_t i = 0;
+        while( i < mActiveParticles.size() )
         {
-            pParticle = static_cast<Particle*>(*i);
+            pParticle = mActiveParticles[i];
             if (pParticle->mTimeToLive < timeElapsed)
             {
                 // Notify renderer
@@ -434,21 +527,23 @@ namespace Ogre {
                 if (pParticle->mParticleType == Particle::Visual)
                 {
                     // Destroy this one
-                    mFreeParticles.splice(mFreeParticles.end(), mActiveParticles, i++);
+                    mFreeParticles.push_back( pParticle );
                 }
                 else
                 {
                     // For now, it can only be an emitted emitter
-                    pParticleEmitter = static_cast<ParticleEmitter*>(*i);
+                    pParticleEmitter = static_cast<ParticleEmitter*>(pParticle);
                     list<ParticleEmitter*>::type* fee = findFreeEmittedEmitter(pParticleEmitter->getName());
                     fee->push_back(pParticleEmitter);
 
                     // Also erase from mActiveEmittedEmitters
                     removeFromActiveEmittedEmitters (pParticleEmitter);
-
-                    // And erase from mActiveParticles
-                    i = mActiveParticles.erase( i );
                 }
+
+                // Swap-remove from mActiveParticles. Don't advance 'i',
+                // the particle moved here hasn't been processed yet.
+                mActiveParticles[i] = mActiveParticles.back();
+                mActiveParticles.pop_back();
             }
             else
             {
@@ -456,15 +551,15 @@ namespace Ogre {
                 pParticle->mTimeToLive -= timeElapsed;
                 ++i;
             }
-
         }
     }
     //-----------------------------------------------------------------------
     void ParticleSystem::_triggerEmitters(Real timeElapsed)
     {
-        // Add up requests for emission
-        static vector<unsigned>::type requested;
-        static vector<unsigned>::type emittedRequested;
+        // Add up requests for emission. These are members (rather than
+        // function statics) so that systems can be updated concurrently
+        vector<unsigned>::type &requested = mEmitterRequests;
+        vector<unsigned>::type &emittedRequested = mEmittedEmitterRequests;
 
         if( requested.size() != mEmitters.size() )
             requested.resize( mEmitters.size() );
@@ -545,9 +640,7 @@ namespace Ogre {
 
         Real timeInc = timeElapsed / requested;
 
-        //TODO: (dark_sylinc) Refactor this. ControllerManager gets executed before us
-        //(because it doesn't know if we'll update a SceneNode)
-        const Quaternion derivedOrientation( mParentNode->_getDerivedOrientationUpdated() );
+        const Quaternion derivedOrientation( mParentNode->_getDerivedOrientation() );
         const Vector3 derivedPosition( mParentNode->_getDerivedPosition() );
         const Vector3 derivedScale( mParentNode->_getDerivedScale() );
 
@@ -646,11 +739,16 @@ namespace Ogre {
         // Increase size
         mParticlePool.reserve(size);
         mParticlePool.resize(size);
+        mActiveParticles.reserve(size);
+        mFreeParticles.reserve(size);
+
+        // Create new particles, contiguous in memory
+        Particle *particles = OGRE_NEW_ARRAY_T( Particle, size - oldSize, MEMCATEGORY_SCENE_OBJECTS );
+        mParticleBlocks.push_back( ParticleBlock( particles, size - oldSize ) );
 
-        // Create new particles
         for( size_t i = oldSize; i < size; i++ )
         {
-            mParticlePool[i] = OGRE_NEW Particle();
+            mParticlePool[i] = &particles[i - oldSize];
         }
 
         if (mIsRendererConfigured)
@@ -669,9 +767,7 @@ namespace Ogre {
     Particle* ParticleSystem::getParticle(size_t index) 
     {
         assert (index < mActiveParticles.size() && "Index out of bounds!");
-        ActiveParticleList::iterator i = mActiveParticles.begin();
-        std::advance(i, index);
-        return *i;
+        return mActiveParticles[index];
     }
     //-----------------------------------------------------------------------
     Particle* ParticleSystem::createParticle(void)
@@ -680,8 +776,9 @@ namespace Ogre {
         if (!mFreeParticles.empty())
         {
             // Fast creation (don't use superclass since emitter will init)
-            p = mFreeParticles.front();
-            mActiveParticles.splice(mActiveParticles.end(), mFreeParticles, mFreeParticles.begin());
+            p = mFreeParticles.back();
+            mFreeParticles.pop_back();
+            mActiveParticles.push_back( p );
 
             p->_notifyOwner(this);
         }
@@ -726,10 +823,23 @@ namespace Ogre {
             if (!mIsRendererConfigured)
                 configureRenderer();
 
-            mRenderer->_updateRenderQueue(queue, camera, lodCamera, mActiveParticles, mCullIndividual,
-                                          mRenderables);
+            if( mRenderer->_updateRenderQueueDeferred( queue, camera, lodCamera, mActiveParticles,
+                                                       mCullIndividual, mRenderables ) )
+            {
+                mManager->_addParticleGeometryRequest( this, camera );
+            }
         }
     }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::_generateGeometry( const Camera *camera )
+    {
+        mRenderer->_generateGeometry( camera, mActiveParticles );
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::_finishGeometry(void)
+    {
+        mRenderer->_finishGeometry();
+    }
     //---------------------------------------------------------------------
     void ParticleSystem::initParameters(void)
     {
@@ -798,6 +908,13 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     void ParticleSystem::_updateBounds()
+    {
+        if( mParentNode )
+            mParentNode->_getFullTransformUpdated();
+        updateBoundsImpl();
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::updateBoundsImpl(void)
     {
         if (mParentNode && (mBoundsAutoUpdate || mBoundsUpdateTime > 0.0f))
         {
@@ -843,8 +960,7 @@ namespace Ogre {
                 // We've already put particles in world space to decouple them from the
                 // node transform, so reverse transform back since we're expected to 
                 // provide a local AABB
-                //TODO: (dark_sylinc) refactor the "Updated" part
-                aabb.transformAffine( mParentNode->_getFullTransformUpdated().inverseAffine() );
+                aabb.transformAffine( mParentNode->_getFullTransform().inverseAffine() );
             }
 
             mObjectData.mLocalAabb->setFromAabb( aabb, mObjectData.mIndex );
@@ -993,8 +1109,16 @@ namespace Ogre {
             mRenderer->_notifyParticleCleared(mActiveParticles);
         }
 
-        // Move actives to free list
-        mFreeParticles.splice(mFreeParticles.end(), mActiveParticles);
+        // Move actives to free list (emitted emitters are handled below)
+        ActiveParticleList::const_iterator itor = mActiveParticles.begin();
+        ActiveParticleList::const_iterator end  = mActiveParticles.end();
+        while( itor != end )
+        {
+            if( (*itor)->mParticleType == Particle::Visual )
+                mFreeParticles.push_back( *itor );
+            ++itor;
+        }
+        mActiveParticles.clear();
 
         // Add active emitted emitters to free list
         addActiveEmittedEmittersToFreeList();
@@ -1032,11 +1156,10 @@ namespace Ogre {
         {
             this->increasePool(size);
 
-            for( size_t i = currSize; i < size; ++i )
-            {
-                // Add new items to the queue
+            // Add new items to the stack, reversed so that
+            // they get used in the same order they are in memory
+            for( size_t i = size; i-- > currSize; )
                 mFreeParticles.push_back( mParticlePool[i] );
-            }
 
             // Tell the renderer, if already configured
             if (mRenderer && mIsRendererConfigured)
@@ -1556,6 +1679,14 @@ namespace Ogre {
     {
     }
     //-----------------------------------------------------------------------
+    void ParticleAffector::_affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                                             size_t numParticles, Real timeElapsed )
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "Affector '" + mType + "' has no batch version",
+                     "ParticleAffector::_affectParticles" );
+    }
+    //-----------------------------------------------------------------------
     ParticleAffectorFactory::~ParticleAffectorFactory() 
     {
         // Destroy all affectors
@@ -430,6 +430,440 @@ inline int doOptimizedConversion(const Ogre::PixelBox &src, const Ogre::PixelBox
     }
 }
 #undef CASECONVERTER
+
+/** Row converters.
+@remarks
+    Unlike the PixelBoxConverter templates above these convert a single row and are
+    picked at runtime, which lets PixelUtil hand row bands to different threads and
+    lets the most common pairs use SSE2. Every converter has a scalar path that
+    produces exactly the same bits as the SIMD one.
+*/
+typedef void (*PixelRowConverter)( const Ogre::uint8 *src, Ogre::uint8 *dst, size_t numPixels );
+
+#if __OGRE_HAVE_SSE
+inline __m128i selectSSE2( __m128i mask, __m128i a, __m128i b )
+{
+    return _mm_or_si128( _mm_and_si128( mask, a ), _mm_andnot_si128( mask, b ) );
+}
+
+/// Converts 4 floats (as raw bits) to halves, one per 32-bit lane.
+/// Bit exact with Bitwise::floatToHalfI, including its truncation.
+inline __m128i floatToHalfSSE2( __m128i bits )
+{
+    const __m128i zero      = _mm_setzero_si128();
+    const __m128i absBits   = _mm_and_si128( bits, _mm_set1_epi32( 0x7fffffff ) );
+    const __m128i exponent  = _mm_srli_epi32( absBits, 23 );
+    const __m128i mantissa  = _mm_and_si128( bits, _mm_set1_epi32( 0x007fffff ) );
+    __m128i sign = _mm_and_si128( _mm_srli_epi32( bits, 16 ), _mm_set1_epi32( 0x8000 ) );
+
+    //Normal range: rebias the exponent & drop the 13 lowest mantissa bits.
+    __m128i result = _mm_sub_epi32( _mm_srli_epi32( absBits, 13 ), _mm_set1_epi32( 0x1c000 ) );
+
+    //Denormals: scaling by 2^24 is exact, and truncating it is the same as the shifts.
+    const __m128i denormal = _mm_cvttps_epi32( _mm_mul_ps( _mm_castsi128_ps( absBits ),
+                                                           _mm_set1_ps( 16777216.0f ) ) );
+    result = selectSSE2( _mm_cmplt_epi32( exponent, _mm_set1_epi32( 113 ) ), denormal, result );
+    result = selectSSE2( _mm_cmpgt_epi32( exponent, _mm_set1_epi32( 142 ) ),
+                         _mm_set1_epi32( 0x7c00 ), result );
+
+    //Inf & NaN. NaNs must keep a non-zero mantissa.
+    __m128i nanMantissa = _mm_srli_epi32( mantissa, 13 );
+    nanMantissa = _mm_or_si128( nanMantissa,
+                                _mm_and_si128( _mm_cmpeq_epi32( nanMantissa, zero ),
+                                               _mm_andnot_si128( _mm_cmpeq_epi32( mantissa, zero ),
+                                                                 _mm_set1_epi32( 1 ) ) ) );
+    result = selectSSE2( _mm_cmpeq_epi32( exponent, _mm_set1_epi32( 255 ) ),
+                         _mm_or_si128( nanMantissa, _mm_set1_epi32( 0x7c00 ) ), result );
+
+    //floatToHalfI flushes anything below 2^-25 to +0, dropping the sign.
+    sign = _mm_and_si128( sign, _mm_cmpgt_epi32( exponent, _mm_set1_epi32( 101 ) ) );
+    return _mm_or_si128( result, sign );
+}
+
+/// Converts 4 halves, one per 32-bit lane, to floats. Bit exact with Bitwise::halfToFloatI.
+inline __m128 halfToFloatSSE2( __m128i halves )
+{
+    const __m128i absBits   = _mm_and_si128( halves, _mm_set1_epi32( 0x7fff ) );
+    const __m128i exponent  = _mm_srli_epi32( absBits, 10 );
+    const __m128i sign      = _mm_slli_epi32( _mm_and_si128( halves, _mm_set1_epi32( 0x8000 ) ), 16 );
+
+    //Rebias the exponent. Inf & NaN (exponent = 31) need to end up at 255.
+    const __m128i bias = _mm_set1_epi32( 112 << 23 );
+    const __m128i infNanBias = _mm_and_si128( _mm_cmpeq_epi32( exponent, _mm_set1_epi32( 31 ) ),
+                                              bias );
+    __m128i result = _mm_add_epi32( _mm_slli_epi32( absBits, 13 ),
+                                    _mm_add_epi32( bias, infNanBias ) );
+
+    //Zero & denormals: mantissa * 2^-24 is exactly representable.
+    const __m128i denormal = _mm_castps_si128( _mm_mul_ps( _mm_cvtepi32_ps( absBits ),
+                                                           _mm_set1_ps( 1.0f / 16777216.0f ) ) );
+    result = selectSSE2( _mm_cmpeq_epi32( exponent, _mm_setzero_si128() ), denormal, result );
+
+    return _mm_castsi128_ps( _mm_or_si128( result, sign ) );
+}
+
+/// Narrows 4 halves stored one per 32-bit lane into the lower 64 bits.
+inline __m128i packHalvesSSE2( __m128i halves )
+{
+    //Sign extend first so _mm_packs_epi32 doesn't saturate.
+    halves = _mm_srai_epi32( _mm_slli_epi32( halves, 16 ), 16 );
+    return _mm_packs_epi32( halves, halves );
+}
+#endif
+
+/** Swaps the red & blue channels of 32-bit pixels.
+    SwapShift = 0 swaps bits [0; 8) with [16; 24), i.e. PF_A8R8G8B8 <-> PF_A8B8G8R8.
+    SwapShift = 8 swaps bits [8; 16) with [24; 32), i.e. PF_B8G8R8A8 <-> PF_R8G8B8A8.
+*/
+template <int SwapShift>
+void swapRedBlue32Row( const Ogre::uint8 *src, Ogre::uint8 *dst, size_t numPixels )
+{
+    const Ogre::uint32 *srcPtr = reinterpret_cast<const Ogre::uint32*>( src );
+    Ogre::uint32 *dstPtr = reinterpret_cast<Ogre::uint32*>( dst );
+    const Ogre::uint32 keepMask = ~( 0x00FF00FFu << SwapShift );
+    const Ogre::uint32 lowMask  = 0xFFu << SwapShift;
+
+    size_t x = 0;
+#if __OGRE_HAVE_SSE
+    const __m128i keepMask4 = _mm_set1_epi32( static_cast<int>( keepMask ) );
+    const __m128i lowMask4  = _mm_set1_epi32( static_cast<int>( lowMask ) );
+    for( ; x + 4u <= numPixels; x += 4u )
+    {
+        const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPtr + x ) );
+        const __m128i lo = _mm_slli_epi32( _mm_and_si128( v, lowMask4 ), 16 );
+        const __m128i hi = _mm_and_si128( _mm_srli_epi32( v, 16 ), lowMask4 );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dstPtr + x ),
+                          _mm_or_si128( _mm_and_si128( v, keepMask4 ), _mm_or_si128( lo, hi ) ) );
+    }
+#endif
+    for( ; x < numPixels; ++x )
+    {
+        const Ogre::uint32 v = srcPtr[x];
+        dstPtr[x] = ( v & keepMask ) | ( ( v & lowMask ) << 16u ) | ( ( v >> 16u ) & lowMask );
+    }
+}
+
+/** Expands 24-bit pixels to 32-bit ones with opaque alpha, optionally swapping red & blue.
+    Works in byte order, so it's only registered on little endian machines, where
+    PF_R8G8B8 -> PF_A8R8G8B8 and PF_B8G8R8 -> PF_A8B8G8R8 keep the bytes in place.
+*/
+template <bool SwapRedBlue>
+void expandRgb8ToRgba8Row( const Ogre::uint8 *src, Ogre::uint8 *dst, size_t numPixels )
+{
+    size_t x = 0;
+#if __OGRE_HAVE_SSE
+    const __m128i alphaMask   = _mm_set1_epi32( static_cast<int>( 0xFF000000 ) );
+    const __m128i keepMask    = _mm_set1_epi32( static_cast<int>( 0xFF00FF00 ) );
+    const __m128i lowMask     = _mm_set1_epi32( 0xFF );
+    for( ; x + 4u <= numPixels; x += 4u )
+    {
+        //Load exactly 12 bytes so we never read past the end of the row.
+        const Ogre::uint8 *srcPtr = src + x * 3u;
+        int tail;
+        memcpy( &tail, srcPtr + 8u, sizeof(tail) );
+        const __m128i v = _mm_unpacklo_epi64(
+                    _mm_loadl_epi64( reinterpret_cast<const __m128i*>( srcPtr ) ),
+                    _mm_cvtsi32_si128( tail ) );
+        const __m128i p01 = _mm_unpacklo_epi32( v, _mm_srli_si128( v, 3 ) );
+        const __m128i p23 = _mm_unpacklo_epi32( _mm_srli_si128( v, 6 ), _mm_srli_si128( v, 9 ) );
+        __m128i rgba = _mm_unpacklo_epi64( p01, p23 );
+        if( SwapRedBlue )
+        {
+            const __m128i lo = _mm_slli_epi32( _mm_and_si128( rgba, lowMask ), 16 );
+            const __m128i hi = _mm_and_si128( _mm_srli_epi32( rgba, 16 ), lowMask );
+            rgba = _mm_or_si128( _mm_and_si128( rgba, keepMask ), _mm_or_si128( lo, hi ) );
+        }
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x * 4u ),
+                          _mm_or_si128( rgba, alphaMask ) );
+    }
+#endif
+    for( ; x < numPixels; ++x )
+    {
+        const Ogre::uint8 *srcPtr = src + x * 3u;
+        Ogre::uint8 *dstPtr = dst + x * 4u;
+        dstPtr[0] = srcPtr[SwapRedBlue ? 2 : 0];
+        dstPtr[1] = srcPtr[1];
+        dstPtr[2] = srcPtr[SwapRedBlue ? 0 : 2];
+        dstPtr[3] = 0xFF;
+    }
+}
+
+/// PF_FLOAT32_* -> PF_FLOAT16_* with the same channel layout.
+template <size_t NumChannels>
+void float32ToFloat16Row( const Ogre::uint8 *src, Ogre::uint8 *dst, size_t numPixels )
+{
+    const Ogre::uint32 *srcPtr = reinterpret_cast<const Ogre::uint32*>( src );
+    Ogre::uint16 *dstPtr = reinterpret_cast<Ogre::uint16*>( dst );
+    const size_t numElements = numPixels * NumChannels;
+
+    size_t i = 0;
+#if __OGRE_HAVE_SSE
+    for( ; i + 4u <= numElements; i += 4u )
+    {
+        const __m128i halves = floatToHalfSSE2(
+                    _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcPtr + i ) ) );
+        _mm_storel_epi64( reinterpret_cast<__m128i*>( dstPtr + i ), packHalvesSSE2( halves ) );
+    }
+#endif
+    for( ; i < numElements; ++i )
+        dstPtr[i] = Ogre::Bitwise::floatToHalfI( srcPtr[i] );
+}
+
+/// PF_FLOAT16_* -> PF_FLOAT32_* with the same channel layout.
+template <size_t NumChannels>
+void float16ToFloat32Row( const Ogre::uint8 *src, Ogre::uint8 *dst, size_t numPixels )
+{
+    const Ogre::uint16 *srcPtr = reinterpret_cast<const Ogre::uint16*>( src );
+    Ogre::uint32 *dstPtr = reinterpret_cast<Ogre::uint32*>( dst );
+    const size_t numElements = numPixels * NumChannels;
+
+    size_t i = 0;
+#if __OGRE_HAVE_SSE
+    for( ; i + 4u <= numElements; i += 4u )
+    {
+        const __m128i halves = _mm_unpacklo_epi16(
+                    _mm_loadl_epi64( reinterpret_cast<const __m128i*>( srcPtr + i ) ),
+                    _mm_setzero_si128() );
+        _mm_storeu_ps( reinterpret_cast<float*>( dstPtr + i ), halfToFloatSSE2( halves ) );
+    }
+#endif
+    for( ; i < numElements; ++i )
+        dstPtr[i] = Ogre::Bitwise::halfToFloatI( srcPtr[i] );
+}
+
+/** PF_RG8 -> PF_FLOAT16_GR.
+@remarks
+    PF_FLOAT16_GR stores green first (see PixelUtil::packColour). Going through
+    unpackColour would treat PF_RG8 as the legacy luminance + alpha layout and drop
+    green, so this converter is also what makes the pair usable.
+*/
+inline void rg8ToFloat16GRRow( const Ogre::uint8 *src, Ogre::uint8 *dst, size_t numPixels )
+{
+    Ogre::uint16 *dstPtr = reinterpret_cast<Ogre::uint16*>( dst );
+
+    size_t x = 0;
+#if __OGRE_HAVE_SSE
+    const __m128i zero      = _mm_setzero_si128();
+    const __m128 maxValue   = _mm_set1_ps( 255.0f );
+    for( ; x + 4u <= numPixels; x += 4u )
+    {
+        const __m128i rg = _mm_unpacklo_epi8(
+                    _mm_loadl_epi64( reinterpret_cast<const __m128i*>( src + x * 2u ) ), zero );
+        //[r0 g0 r1 g1] -> [g0 r0 g1 r1]
+        __m128i v0 = _mm_shuffle_epi32( _mm_unpacklo_epi16( rg, zero ), _MM_SHUFFLE( 2, 3, 0, 1 ) );
+        __m128i v1 = _mm_shuffle_epi32( _mm_unpackhi_epi16( rg, zero ), _MM_SHUFFLE( 2, 3, 0, 1 ) );
+        //Divide (rather than multiply by the reciprocal) to match Bitwise::fixedToFloat
+        v0 = floatToHalfSSE2( _mm_castps_si128( _mm_div_ps( _mm_cvtepi32_ps( v0 ), maxValue ) ) );
+        v1 = floatToHalfSSE2( _mm_castps_si128( _mm_div_ps( _mm_cvtepi32_ps( v1 ), maxValue ) ) );
+        _mm_storel_epi64( reinterpret_cast<__m128i*>( dstPtr + x * 2u ), packHalvesSSE2( v0 ) );
+        _mm_storel_epi64( reinterpret_cast<__m128i*>( dstPtr + x * 2u + 4u ), packHalvesSSE2( v1 ) );
+    }
+#endif
+    for( ; x < numPixels; ++x )
+    {
+        dstPtr[x * 2u + 0u] = Ogre::Bitwise::floatToHalf( Ogre::Bitwise::fixedToFloat( src[x * 2u + 1u], 8 ) );
+        dstPtr[x * 2u + 1u] = Ogre::Bitwise::floatToHalf( Ogre::Bitwise::fixedToFloat( src[x * 2u + 0u], 8 ) );
+    }
+}
+
+/** 8-bit RGBA (or BGRA when SwapRedBlue is true), in byte order, gamma encoded -> PF_FLOAT32_RGBA
+    in linear space. Uses the same x^2 approximation as the gamma correct mipmap filters.
+*/
+template <bool SwapRedBlue>
+void srgb8ToLinearFloat32Row( const Ogre::uint8 *src, Ogre::uint8 *dst, size_t numPixels )
+{
+    float *dstPtr = reinterpret_cast<float*>( dst );
+
+    size_t x = 0;
+#if __OGRE_HAVE_SSE
+    const __m128i zero      = _mm_setzero_si128();
+    const __m128 maxValue   = _mm_set1_ps( 255.0f );
+    const __m128 alphaMask  = _mm_castsi128_ps( _mm_set_epi32( -1, 0, 0, 0 ) );
+    const __m128 one        = _mm_set1_ps( 1.0f );
+    for( ; x < numPixels; ++x )
+    {
+        int packed;
+        memcpy( &packed, src + x * 4u, sizeof(packed) );
+        const __m128i channels = _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128( packed ),
+                                                                        zero ), zero );
+        __m128 v = _mm_div_ps( _mm_cvtepi32_ps( channels ), maxValue );
+        if( SwapRedBlue )
+            v = _mm_shuffle_ps( v, v, _MM_SHUFFLE( 3, 0, 1, 2 ) );
+        //Square rgb, multiply alpha by 1
+        v = _mm_mul_ps( v, _mm_or_ps( _mm_and_ps( alphaMask, one ), _mm_andnot_ps( alphaMask, v ) ) );
+        _mm_storeu_ps( dstPtr + x * 4u, v );
+    }
+#else
+    for( ; x < numPixels; ++x )
+    {
+        const Ogre::uint8 *srcPtr = src + x * 4u;
+        const float r = Ogre::Bitwise::fixedToFloat( srcPtr[SwapRedBlue ? 2 : 0], 8 );
+        const float g = Ogre::Bitwise::fixedToFloat( srcPtr[1], 8 );
+        const float b = Ogre::Bitwise::fixedToFloat( srcPtr[SwapRedBlue ? 0 : 2], 8 );
+        dstPtr[x * 4u + 0u] = r * r;
+        dstPtr[x * 4u + 1u] = g * g;
+        dstPtr[x * 4u + 2u] = b * b;
+        dstPtr[x * 4u + 3u] = Ogre::Bitwise::fixedToFloat( srcPtr[3], 8 );
+    }
+#endif
+}
+
+/// Encodes a linear value into 8-bit gamma space. Matches sqrt + Bitwise::floatToFixed.
+inline Ogre::uint8 linearToSrgb8( float value )
+{
+    //Written so that NaNs also end up as 0
+    if( !( value > 0.0f ) )
+        return 0;
+    return static_cast<Ogre::uint8>( Ogre::Bitwise::floatToFixed( sqrtf( std::min( value, 1.0f ) ), 8 ) );
+}
+
+/// PF_FLOAT32_RGBA in linear space -> 8-bit RGBA (or BGRA), in byte order, gamma encoded.
+template <bool SwapRedBlue>
+void linearFloat32ToSrgb8Row( const Ogre::uint8 *src, Ogre::uint8 *dst, size_t numPixels )
+{
+    const float *srcPtr = reinterpret_cast<const float*>( src );
+
+    size_t x = 0;
+#if __OGRE_HAVE_SSE
+    const __m128 alphaMask  = _mm_castsi128_ps( _mm_set_epi32( -1, 0, 0, 0 ) );
+    const __m128 zero       = _mm_setzero_ps();
+    const __m128 one        = _mm_set1_ps( 1.0f );
+    const __m128 scale      = _mm_set1_ps( 256.0f );
+    for( ; x + 4u <= numPixels; x += 4u )
+    {
+        __m128i result[4];
+        for( size_t i=0; i<4u; ++i )
+        {
+            //_mm_max_ps returns its 2nd argument on NaN
+            __m128 v = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( srcPtr + ( x + i ) * 4u ), zero ), one );
+            if( SwapRedBlue )
+                v = _mm_shuffle_ps( v, v, _MM_SHUFFLE( 3, 0, 1, 2 ) );
+            v = _mm_or_ps( _mm_and_ps( alphaMask, v ), _mm_andnot_ps( alphaMask, _mm_sqrt_ps( v ) ) );
+            //1.0 becomes 256, which the saturating packs below clamp to 255
+            result[i] = _mm_cvttps_epi32( _mm_mul_ps( v, scale ) );
+        }
+        const __m128i packed = _mm_packus_epi16( _mm_packs_epi32( result[0], result[1] ),
+                                                 _mm_packs_epi32( result[2], result[3] ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x * 4u ), packed );
+    }
+#endif
+    for( ; x < numPixels; ++x )
+    {
+        const float *pixel = srcPtr + x * 4u;
+        Ogre::uint8 *dstPtr = dst + x * 4u;
+        dstPtr[SwapRedBlue ? 2 : 0] = linearToSrgb8( pixel[0] );
+        dstPtr[1]                   = linearToSrgb8( pixel[1] );
+        dstPtr[SwapRedBlue ? 0 : 2] = linearToSrgb8( pixel[2] );
+        dstPtr[3] = static_cast<Ogre::uint8>( Ogre::Bitwise::floatToFixed( pixel[3], 8 ) );
+    }
+}
+
+/** Returns the row converter for the given pair, or a null pointer if there is none.
+@param gamma
+    0 for a regular conversion, 1 to decode from gamma to linear, 2 to encode linear
+    into gamma space. Only the pairs registered for that mode are returned.
+*/
+inline PixelRowConverter getPixelRowConverter( Ogre::PixelFormat srcFormat, Ogre::PixelFormat dstFormat,
+                                               int gamma )
+{
+    using namespace Ogre;
+
+    if( gamma == 0 )
+    {
+        switch( FMTCONVERTERID( srcFormat, dstFormat ) )
+        {
+        case FMTCONVERTERID( PF_A8R8G8B8, PF_A8B8G8R8 ):
+        case FMTCONVERTERID( PF_A8B8G8R8, PF_A8R8G8B8 ):
+            return swapRedBlue32Row<0>;
+        case FMTCONVERTERID( PF_B8G8R8A8, PF_R8G8B8A8 ):
+        case FMTCONVERTERID( PF_R8G8B8A8, PF_B8G8R8A8 ):
+            return swapRedBlue32Row<8>;
+#if OGRE_ENDIAN == OGRE_ENDIAN_LITTLE
+        case FMTCONVERTERID( PF_R8G8B8, PF_A8R8G8B8 ):
+        case FMTCONVERTERID( PF_B8G8R8, PF_A8B8G8R8 ):
+            return expandRgb8ToRgba8Row<false>;
+        case FMTCONVERTERID( PF_R8G8B8, PF_A8B8G8R8 ):
+        case FMTCONVERTERID( PF_B8G8R8, PF_A8R8G8B8 ):
+            return expandRgb8ToRgba8Row<true>;
+#endif
+        case FMTCONVERTERID( PF_FLOAT32_R, PF_FLOAT16_R ):
+            return float32ToFloat16Row<1u>;
+        case FMTCONVERTERID( PF_FLOAT32_GR, PF_FLOAT16_GR ):
+            return float32ToFloat16Row<2u>;
+        case FMTCONVERTERID( PF_FLOAT32_RGB, PF_FLOAT16_RGB ):
+            return float32ToFloat16Row<3u>;
+        case FMTCONVERTERID( PF_FLOAT32_RGBA, PF_FLOAT16_RGBA ):
+            return float32ToFloat16Row<4u>;
+        case FMTCONVERTERID( PF_FLOAT16_R, PF_FLOAT32_R ):
+            return float16ToFloat32Row<1u>;
+        case FMTCONVERTERID( PF_FLOAT16_GR, PF_FLOAT32_GR ):
+            return float16ToFloat32Row<2u>;
+        case FMTCONVERTERID( PF_FLOAT16_RGB, PF_FLOAT32_RGB ):
+            return float16ToFloat32Row<3u>;
+        case FMTCONVERTERID( PF_FLOAT16_RGBA, PF_FLOAT32_RGBA ):
+            return float16ToFloat32Row<4u>;
+        case FMTCONVERTERID( PF_RG8, PF_FLOAT16_GR ):
+            return rg8ToFloat16GRRow;
+        default:
+            return 0;
+        }
+    }
+
+#if OGRE_ENDIAN == OGRE_ENDIAN_LITTLE
+    //On little endian PF_A8B8G8R8 is RGBA in byte order, PF_A8R8G8B8 is BGRA.
+    if( gamma == 1 )
+    {
+        switch( FMTCONVERTERID( srcFormat, dstFormat ) )
+        {
+        case FMTCONVERTERID( PF_A8B8G8R8, PF_FLOAT32_RGBA ):
+            return srgb8ToLinearFloat32Row<false>;
+        case FMTCONVERTERID( PF_A8R8G8B8, PF_FLOAT32_RGBA ):
+            return srgb8ToLinearFloat32Row<true>;
+        default:
+            return 0;
+        }
+    }
+
+    switch( FMTCONVERTERID( srcFormat, dstFormat ) )
+    {
+    case FMTCONVERTERID( PF_FLOAT32_RGBA, PF_A8B8G8R8 ):
+        return linearFloat32ToSrgb8Row<false>;
+    case FMTCONVERTERID( PF_FLOAT32_RGBA, PF_A8R8G8B8 ):
+        return linearFloat32ToSrgb8Row<true>;
+    default:
+        return 0;
+    }
+#else
+    return 0;
+#endif
+}
+
+/// Runs a row converter over every row of the box. Returns 0 if there's no converter.
+inline int doRowConversion( const Ogre::PixelBox &src, const Ogre::PixelBox &dst, int gamma )
+{
+    const PixelRowConverter converter = getPixelRowConverter( src.format, dst.format, gamma );
+    if( !converter )
+        return 0;
+
+    const size_t srcPixelSize = Ogre::PixelUtil::getNumElemBytes( src.format );
+    const size_t dstPixelSize = Ogre::PixelUtil::getNumElemBytes( dst.format );
+    const size_t width = src.getWidth();
+    for( size_t z=0; z<src.getDepth(); ++z )
+    {
+        for( size_t y=0; y<src.getHeight(); ++y )
+        {
+            const Ogre::uint8 *srcptr = static_cast<const Ogre::uint8*>( src.data ) +
+                    ( src.left + ( src.top + y ) * src.rowPitch +
+                      ( src.front + z ) * src.slicePitch ) * srcPixelSize;
+            Ogre::uint8 *dstptr = static_cast<Ogre::uint8*>( dst.data ) +
+                    ( dst.left + ( dst.top + y ) * dst.rowPitch +
+                      ( dst.front + z ) * dst.slicePitch ) * dstPixelSize;
+            converter( srcptr, dstptr, width );
+        }
+    }
+
+    return 1;
+}
 /** @} */
 /** @} */
 
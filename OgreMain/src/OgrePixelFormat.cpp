@@ -36,6 +36,9 @@ THE SOFTWARE.
 #include "OgrePixelBox.h"
 
 #include "OgreProfiler.h"
+#include "OgreCommon.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreUniformScalableTask.h"
 
 namespace {
 #include "OgrePixelConversions.h"
@@ -1072,7 +1075,147 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
-    void PixelUtil::bulkPixelConversion(const PixelBox &src, const PixelBox &dst)
+    namespace
+    {
+        /// Below this amount of pixels per thread, creating threads costs more than it saves.
+        const size_t c_minPixelsPerConversionThread = 256u * 256u;
+
+        typedef void (*PixelBoxConversionFunc)( const PixelBox &src, const PixelBox &dst );
+
+        /// Converts a linear value to gamma space, sRGB approximated as gamma 2.0
+        /// (same as the gamma correct mipmap filters).
+        inline float linearToGamma( float value )
+        {
+            //Written so that NaNs also end up as 0
+            return value > 0.0f ? sqrtf( value ) : 0.0f;
+        }
+
+        /** Converts the whole box in the calling thread.
+        @remarks
+            Gamma is 0 for a plain conversion, 1 to decode the source's colour channels
+            from gamma into linear space, 2 to encode them from linear into gamma space.
+        */
+        template <int Gamma>
+        void convertPixelBox( const PixelBox &src, const PixelBox &dst )
+        {
+// NB VC6 can't handle the templates required for optimised conversion, tough
+#if OGRE_COMPILER != OGRE_COMPILER_MSVC || OGRE_COMP_VER >= 1300
+            // Is there a specialized row converter (SIMD)?
+            if( doRowConversion( src, dst, Gamma ) )
+                return;
+
+            // Is there a specialized, inlined, conversion?
+            if( Gamma == 0 && doOptimizedConversion( src, dst ) )
+                return;
+#endif
+
+            const size_t srcPixelSize = PixelUtil::getNumElemBytes(src.format);
+            const size_t dstPixelSize = PixelUtil::getNumElemBytes(dst.format);
+            uint8 *srcptr = static_cast<uint8*>(src.data)
+                + (src.left + src.top * src.rowPitch + src.front * src.slicePitch) * srcPixelSize;
+            uint8 *dstptr = static_cast<uint8*>(dst.data)
+                + (dst.left + dst.top * dst.rowPitch + dst.front * dst.slicePitch) * dstPixelSize;
+
+            // Calculate pitches+skips in bytes
+            const size_t srcRowSkipBytes = src.getRowSkip()*srcPixelSize;
+            const size_t srcSliceSkipBytes = src.getSliceSkip()*srcPixelSize;
+            const size_t dstRowSkipBytes = dst.getRowSkip()*dstPixelSize;
+            const size_t dstSliceSkipBytes = dst.getSliceSkip()*dstPixelSize;
+
+            // The brute force fallback
+            float r = 0, g = 0, b = 0, a = 1;
+            for(size_t z=src.front; z<src.back; z++)
+            {
+                for(size_t y=src.top; y<src.bottom; y++)
+                {
+                    for(size_t x=src.left; x<src.right; x++)
+                    {
+                        PixelUtil::unpackColour(&r, &g, &b, &a, src.format, srcptr);
+                        if( Gamma == 1 )
+                        {
+                            r *= r;
+                            g *= g;
+                            b *= b;
+                        }
+                        else if( Gamma == 2 )
+                        {
+                            r = linearToGamma( r );
+                            g = linearToGamma( g );
+                            b = linearToGamma( b );
+                        }
+                        PixelUtil::packColour(r, g, b, a, dst.format, dstptr);
+                        srcptr += srcPixelSize;
+                        dstptr += dstPixelSize;
+                    }
+                    srcptr += srcRowSkipBytes;
+                    dstptr += dstRowSkipBytes;
+                }
+                srcptr += srcSliceSkipBytes;
+                dstptr += dstSliceSkipBytes;
+            }
+        }
+
+        /// Splits a conversion in row bands. Each thread converts its band of every slice.
+        class PixelBoxConversionTask : public UniformScalableTask
+        {
+        public:
+            PixelBoxConversionFunc  conversionFunc;
+            PixelBox const          *src;
+            PixelBox const          *dst;
+
+            virtual void execute( size_t threadId, size_t numThreads )
+            {
+                const size_t height = src->getHeight();
+                const uint32 rowStart = static_cast<uint32>( (height * threadId) / numThreads );
+                const uint32 rowEnd   = static_cast<uint32>( (height * (threadId + 1u)) / numThreads );
+
+                if( rowStart == rowEnd )
+                    return;
+
+                PixelBox srcBand( *src );
+                PixelBox dstBand( *dst );
+                srcBand.top     = src->top + rowStart;
+                srcBand.bottom  = src->top + rowEnd;
+                dstBand.top     = dst->top + rowStart;
+                dstBand.bottom  = dst->top + rowEnd;
+
+                (*conversionFunc)( srcBand, dstBand );
+            }
+        };
+
+        void dispatchPixelBoxConversion( PixelBoxConversionFunc conversionFunc,
+                                         const PixelBox &src, const PixelBox &dst,
+                                         uint32 numThreads )
+        {
+            size_t numThreadsToUse = numThreads;
+            if( numThreads == 0u )
+            {
+                const size_t numPixels = static_cast<size_t>( src.getWidth() ) *
+                                         src.getHeight() * src.getDepth();
+                numThreadsToUse = numPixels / c_minPixelsPerConversionThread;
+                if( numThreadsToUse > 1u )
+                {
+                    numThreadsToUse = std::min<size_t>( numThreadsToUse,
+                                                        PlatformInformation::getNumLogicalCores() );
+                }
+            }
+            numThreadsToUse = std::min<size_t>( numThreadsToUse, src.getHeight() );
+
+            if( numThreadsToUse <= 1u )
+            {
+                (*conversionFunc)( src, dst );
+                return;
+            }
+
+            PixelBoxConversionTask task;
+            task.conversionFunc = conversionFunc;
+            task.src            = &src;
+            task.dst            = &dst;
+            Threads::ExecuteUniformScalableTask( &task, numThreadsToUse );
+        }
+    }
+    //-----------------------------------------------------------------------
+    void PixelUtil::bulkPixelConversion( const PixelBox &src, const PixelBox &dst, uint32 numThreads )
     {
         assert(src.getWidth() == dst.getWidth() &&
                src.getHeight() == dst.getHeight() &&
@@ -1196,7 +1339,7 @@ namespace Ogre {
             // optimized conversions
             PixelBox tempdst = dst;
             tempdst.format = dst.format==PF_X8R8G8B8?PF_A8R8G8B8:PF_A8B8G8R8;
-            bulkPixelConversion(src, tempdst);
+            bulkPixelConversion(src, tempdst, numThreads);
             return;
         }
         // Converting from PF_X8R8G8B8 is exactly the same as converting from
@@ -1207,55 +1350,43 @@ namespace Ogre {
             // optimized conversions
             PixelBox tempsrc = src;
             tempsrc.format = src.format==PF_X8R8G8B8?PF_A8R8G8B8:PF_A8B8G8R8;
-            bulkPixelConversion(tempsrc, dst);
+            bulkPixelConversion(tempsrc, dst, numThreads);
             return;
         }
 
-// NB VC6 can't handle the templates required for optimised conversion, tough
-#if OGRE_COMPILER != OGRE_COMPILER_MSVC || OGRE_COMP_VER >= 1300
-        // Is there a specialized, inlined, conversion?
-        if(doOptimizedConversion(src, dst))
+        dispatchPixelBoxConversion( convertPixelBox<0>, src, dst, numThreads );
+    }
+    //-----------------------------------------------------------------------
+    void PixelUtil::convertSRGBToLinear( const PixelBox &src, const PixelBox &dst, uint32 numThreads )
+    {
+        assert(src.getWidth() == dst.getWidth() &&
+               src.getHeight() == dst.getHeight() &&
+               src.getDepth() == dst.getDepth());
+
+        if( PixelUtil::isCompressed( src.format ) || PixelUtil::isCompressed( dst.format ) )
         {
-            // If so, good
-            return;
+            OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                         "This method can not be used with compressed formats",
+                         "PixelUtil::convertSRGBToLinear" );
         }
-#endif
-
-        const size_t srcPixelSize = PixelUtil::getNumElemBytes(src.format);
-        const size_t dstPixelSize = PixelUtil::getNumElemBytes(dst.format);
-        uint8 *srcptr = static_cast<uint8*>(src.data)
-            + (src.left + src.top * src.rowPitch + src.front * src.slicePitch) * srcPixelSize;
-        uint8 *dstptr = static_cast<uint8*>(dst.data)
-            + (dst.left + dst.top * dst.rowPitch + dst.front * dst.slicePitch) * dstPixelSize;
-        
-        // Old way, not taking into account box dimensions
-        //uint8 *srcptr = static_cast<uint8*>(src.data), *dstptr = static_cast<uint8*>(dst.data);
 
-        // Calculate pitches+skips in bytes
-        const size_t srcRowSkipBytes = src.getRowSkip()*srcPixelSize;
-        const size_t srcSliceSkipBytes = src.getSliceSkip()*srcPixelSize;
-        const size_t dstRowSkipBytes = dst.getRowSkip()*dstPixelSize;
-        const size_t dstSliceSkipBytes = dst.getSliceSkip()*dstPixelSize;
+        dispatchPixelBoxConversion( convertPixelBox<1>, src, dst, numThreads );
+    }
+    //-----------------------------------------------------------------------
+    void PixelUtil::convertLinearToSRGB( const PixelBox &src, const PixelBox &dst, uint32 numThreads )
+    {
+        assert(src.getWidth() == dst.getWidth() &&
+               src.getHeight() == dst.getHeight() &&
+               src.getDepth() == dst.getDepth());
 
-        // The brute force fallback
-        float r = 0, g = 0, b = 0, a = 1;
-        for(size_t z=src.front; z<src.back; z++)
+        if( PixelUtil::isCompressed( src.format ) || PixelUtil::isCompressed( dst.format ) )
         {
-            for(size_t y=src.top; y<src.bottom; y++)
-            {
-                for(size_t x=src.left; x<src.right; x++)
-                {
-                    unpackColour(&r, &g, &b, &a, src.format, srcptr);
-                    packColour(r, g, b, a, dst.format, dstptr);
-                    srcptr += srcPixelSize;
-                    dstptr += dstPixelSize;
-                }
-                srcptr += srcRowSkipBytes;
-                dstptr += dstRowSkipBytes;
-            }
-            srcptr += srcSliceSkipBytes;
-            dstptr += dstSliceSkipBytes;
+            OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                         "This method can not be used with compressed formats",
+                         "PixelUtil::convertLinearToSRGB" );
         }
+
+        dispatchPixelBoxConversion( convertPixelBox<2>, src, dst, numThreads );
     }
     //-----------------------------------------------------------------------
     void PixelUtil::convertForNormalMapping(const PixelBox &src, const PixelBox &dst)
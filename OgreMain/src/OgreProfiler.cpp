@@ -86,7 +86,8 @@ namespace Ogre {
         , mCurrentFrame(0)
         , mTimer(0)
         , mTotalFrameTime(0)
-        , mEnabled( OGRE_PROFILING == OGRE_PROFILING_INTERNAL_OFFLINE )
+        , mEnabled( OGRE_PROFILING == OGRE_PROFILING_INTERNAL_OFFLINE ||
+                    OGRE_PROFILING == OGRE_PROFILING_TRACE )
         , mUseStableMarkers(false)
         , mNewEnableState(false)
         , mProfileMask(0xFFFFFFFF)
@@ -159,7 +160,10 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void Profiler::setEnabled(bool enabled) 
     {
-#if OGRE_PROFILING != OGRE_PROFILING_INTERNAL_OFFLINE
+#if OGRE_PROFILING == OGRE_PROFILING_TRACE
+        mEnabled = enabled;
+        mTraceProfiler.setEnabled( enabled );
+#elif OGRE_PROFILING != OGRE_PROFILING_INTERNAL_OFFLINE
         if (!mInitialized && enabled) 
         {
             for( TProfileSessionListener::iterator i = mListeners.begin(); i != mListeners.end(); ++i )
@@ -240,6 +244,8 @@ namespace Ogre {
     {
 #if OGRE_PROFILING == OGRE_PROFILING_INTERNAL_OFFLINE
         mOfflineProfiler.profileBegin( profileName.c_str(), flags );
+#elif OGRE_PROFILING == OGRE_PROFILING_TRACE
+        mTraceProfiler.beginEvent( profileName, groupID );
 #else
         // regardless of whether or not we are enabled, we need the application's root profile (ie the first profile started each frame)
         // we need this so bogus profiles don't show up when users enable profiling mid frame
@@ -303,6 +309,8 @@ namespace Ogre {
     {
 #if OGRE_PROFILING == OGRE_PROFILING_INTERNAL_OFFLINE
         mOfflineProfiler.profileEnd();
+#elif OGRE_PROFILING == OGRE_PROFILING_TRACE
+        mTraceProfiler.endEvent();
 #else
         if(!mEnabled) 
         {
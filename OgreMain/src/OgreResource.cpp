@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgreResourceManager.h"
 #include "OgreLogManager.h"
 #include "OgreException.h"
+#include "OgreProfiler.h"
 
 namespace Ogre 
 {
@@ -80,6 +81,9 @@ namespace Ogre
             return;
         }
 
+        // May be called from a background loading thread
+        OgreProfileThreaded( "Resource::load" );
+
         // Scope lock for actual loading
         try
         {
@@ -34,6 +34,8 @@ THE SOFTWARE.
 #include "OgreScriptLoader.h"
 #include "OgreSceneManager.h"
 #include "OgreResourceManager.h"
+#include "OgrePlatformInformation.h"
+#include "Threading/OgreThreads.h"
 
 namespace Ogre {
 
@@ -54,9 +56,58 @@ namespace Ogre {
     // RGM has one (this one) and RM has 2 (by name and by handle)
     size_t ResourceGroupManager::RESOURCE_SYSTEM_NUM_REFERENCE_COUNTS = 3;
     //-----------------------------------------------------------------------
+    /// Script queued by parseResourceGroupScripts when parsing with multiple threads
+    struct PendingScript
+    {
+        ScriptLoader    *loader;
+        String          filename;
+        /// False if the script couldn't be opened
+        bool            opened;
+        String          streamName;
+        String          source;
+        /// Filled by the worker threads. May be null even if the script was read.
+        ScriptLoader::PreparsedScript *preparsed;
+    };
+    typedef vector<PendingScript>::type PendingScriptVec;
+
+    /// Runs ScriptLoader::_preparseScript on every n-th script, starting from threadIdx.
+    static void preparseScripts( PendingScriptVec &pendingScripts, const String &groupName,
+                                 size_t threadIdx, size_t numThreads )
+    {
+        for( size_t i=threadIdx; i<pendingScripts.size(); i += numThreads )
+        {
+            PendingScript &pendingScript = pendingScripts[i];
+            if( pendingScript.opened )
+            {
+                pendingScript.preparsed = pendingScript.loader->_preparseScript(
+                            pendingScript.source, pendingScript.streamName, groupName );
+            }
+        }
+    }
+
+    struct PreparseScriptsThreadParams
+    {
+        PendingScriptVec    &pendingScripts;
+        String              groupName;
+        size_t              numThreads;
+
+        PreparseScriptsThreadParams( PendingScriptVec &_pendingScripts, const String &_groupName,
+                                     size_t _numThreads ) :
+            pendingScripts( _pendingScripts ), groupName( _groupName ), numThreads( _numThreads ) {}
+    };
+    unsigned long preparseScriptsThread( ThreadHandle *threadHandle )
+    {
+        PreparseScriptsThreadParams *params =
+                reinterpret_cast<PreparseScriptsThreadParams*>( threadHandle->getUserParam() );
+        preparseScripts( params->pendingScripts, params->groupName,
+                         threadHandle->getThreadIdx(), params->numThreads );
+        return 0;
+    }
+    THREAD_DECLARE( preparseScriptsThread );
+    //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
     ResourceGroupManager::ResourceGroupManager()
-        : mLoadingListener(0), mCurrentGroup(0)
+        : mLoadingListener(0), mNumScriptParsingThreads(1), mCurrentGroup(0)
     {
         // Create the 'General' group
         createResourceGroup(DEFAULT_RESOURCE_GROUP_NAME);
@@ -1086,6 +1137,120 @@ namespace Ogre {
         // Fire scripting event
         fireResourceGroupScriptingStarted(grp->name, scriptCount);
 
+        size_t numThreads = mNumScriptParsingThreads;
+        if( !numThreads )
+            numThreads = PlatformInformation::getNumLogicalCores();
+        numThreads = std::min( numThreads, scriptCount );
+
+        if( numThreads > 1u )
+        {
+            PendingScriptVec pendingScripts;
+            pendingScripts.reserve( scriptCount );
+
+            // Read every script from the main thread (archives aren't thread safe),
+            // in the original order. Streams are closed right away so that large
+            // groups don't run out of file descriptors.
+            for (ScriptLoaderFileList::iterator slfli = scriptLoaderFileList.begin();
+                slfli != scriptLoaderFileList.end(); ++slfli)
+            {
+                for (FileListList::iterator flli = slfli->second->begin(); flli != slfli->second->end(); ++flli)
+                {
+                    for (FileInfoList::iterator fii = (*flli)->begin(); fii != (*flli)->end(); ++fii)
+                    {
+                        PendingScript pendingScript;
+                        pendingScript.loader    = slfli->first;
+                        pendingScript.filename  = fii->filename;
+                        pendingScript.opened    = false;
+                        pendingScript.preparsed = 0;
+
+                        DataStreamPtr stream = fii->archive->open(fii->filename);
+                        if (!stream.isNull())
+                        {
+                            pendingScript.opened = true;
+                            pendingScript.streamName = stream->getName();
+                            pendingScript.source = stream->getAsString();
+                            stream->close();
+                        }
+
+                        pendingScripts.push_back( pendingScript );
+                    }
+                }
+            }
+
+            // Lex & parse in parallel. This thread takes the first share.
+            ThreadHandleVec threadHandles;
+            threadHandles.reserve( numThreads - 1u );
+            PreparseScriptsThreadParams threadParams( pendingScripts, grp->name, numThreads );
+            for( size_t i=1; i<numThreads; ++i )
+            {
+                threadHandles.push_back( Threads::CreateThread( THREAD_GET( preparseScriptsThread ),
+                                                                i, &threadParams ) );
+            }
+            preparseScripts( pendingScripts, grp->name, 0, numThreads );
+            Threads::WaitForThreads( threadHandles );
+
+            // Translate serially, in the original order, notifying the listeners
+            // exactly like the single threaded path does.
+            PendingScriptVec::iterator itor = pendingScripts.begin();
+            PendingScriptVec::iterator end  = pendingScripts.end();
+
+            try
+            {
+                while( itor != end )
+                {
+                    bool skipScript = false;
+                    fireScriptStarted(itor->filename, skipScript);
+                    if(skipScript)
+                    {
+                        LogManager::getSingleton().logMessage(
+                            "Skipping script " + itor->filename);
+                    }
+                    else
+                    {
+                        LogManager::getSingleton().logMessage(
+                            "Parsing script " + itor->filename);
+                        if( itor->opened )
+                        {
+                            DataStreamPtr stream( OGRE_NEW MemoryDataStream(
+                                                      itor->streamName,
+                                                      const_cast<char*>( itor->source.c_str() ),
+                                                      itor->source.size(),
+                                                      false, true ) );
+                            DataStream *originalStream = stream.get();
+                            if (mLoadingListener)
+                                mLoadingListener->resourceStreamOpened(itor->filename, grp->name, 0, stream);
+
+                            // The listener may have replaced the stream; what was
+                            // preparsed is then out of date.
+                            if( itor->preparsed && stream.get() == originalStream )
+                                itor->loader->_parsePreparsedScript( itor->preparsed, grp->name );
+                            else
+                                itor->loader->parseScript( stream, grp->name );
+                        }
+                    }
+                    OGRE_DELETE itor->preparsed;
+                    itor->preparsed = 0;
+                    fireScriptEnded(itor->filename, skipScript);
+                    ++itor;
+                }
+            }
+            catch( ... )
+            {
+                //Not only Ogre exceptions; i.e. std::bad_alloc must not leak them either.
+                while( itor != end )
+                {
+                    OGRE_DELETE itor->preparsed;
+                    ++itor;
+                }
+                throw;
+            }
+
+            fireResourceGroupScriptingEnded(grp->name);
+            LogManager::getSingleton().logMessage(
+                "Finished parsing scripts for resource group " + grp->name);
+            return;
+        }
+
         // Iterate over scripts and parse
         // Note we respect original ordering
         for (ScriptLoaderFileList::iterator slfli = scriptLoaderFileList.begin();
@@ -1135,6 +1300,11 @@ namespace Ogre {
             "Finished parsing scripts for resource group " + grp->name);
     }
     //-----------------------------------------------------------------------
+    void ResourceGroupManager::setNumScriptParsingThreads( size_t numThreads )
+    {
+        mNumScriptParsingThreads = numThreads;
+    }
+    //-----------------------------------------------------------------------
     void ResourceGroupManager::createDeclaredResources(ResourceGroup* grp)
     {
 
@@ -69,6 +69,7 @@ THE SOFTWARE.
 #include "OgreWireAabb.h"
 #include "OgreNameGenerator.h"
 #include "OgreHlmsManager.h"
+#include "OgreHlmsTextureManager.h"
 #include "OgreHlmsCompute.h"
 #include "OgreHlmsLowLevel.h"
 #include "Animation/OgreSkeletonManager.h"
@@ -319,7 +320,8 @@ namespace Ogre {
             << "Best time: \t"  << mFrameStats->getBestTime() << " ms\n"
             << "Worst time: \t" << mFrameStats->getWorstTime()<< " ms";
 
-#if OGRE_PROFILING && OGRE_PROFILING != OGRE_PROFILING_INTERNAL_OFFLINE
+#if OGRE_PROFILING && OGRE_PROFILING != OGRE_PROFILING_INTERNAL_OFFLINE && \
+    OGRE_PROFILING != OGRE_PROFILING_TRACE
         OGRE_DELETE mProfiler;
 #endif
 
@@ -413,7 +415,7 @@ namespace Ogre {
         mAutoWindow = 0;
         mFirstTimePostWindowInit = false;
 
-#if OGRE_PROFILING == OGRE_PROFILING_INTERNAL_OFFLINE
+#if OGRE_PROFILING == OGRE_PROFILING_INTERNAL_OFFLINE || OGRE_PROFILING == OGRE_PROFILING_TRACE
         OGRE_DELETE mProfiler;
 #endif
 
@@ -920,6 +922,9 @@ namespace Ogre {
                 return false;
         }
 
+        // Upload the textures being streamed in the background
+        mHlmsManager->getTextureManager()->_updateStreaming();
+
         return true;
     }
     //-----------------------------------------------------------------------
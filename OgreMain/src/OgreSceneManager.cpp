@@ -57,6 +57,7 @@ THE SOFTWARE.
 #include "OgreParticleSystemManager.h"
 #include "OgreParticleSystem.h"
 #include "OgreProfiler.h"
+#include "OgreLwString.h"
 #include "OgreInstanceBatch.h"
 #include "OgreInstancedEntity.h"
 #include "OgreRenderTexture.h"
@@ -97,6 +98,11 @@ SceneManager::SceneManager(const String& name, size_t numWorkerThreads,
 mNumDecals( 0 ),
 mStaticMinDepthLevelDirty( 0 ),
 mStaticEntitiesDirty( true ),
+mStaticSceneVersion( 0 ),
+mDefragmentationBudget( 0 ),
+mStaticSpatialSorting( false ),
+mStaticSpatialSortVersion( 0 ),
+mLastNumStaticEntities( 0 ),
 mPrePassMode( PrePassNone ),
 mPrePassTextures( 0 ),
 mSsrTexture( 0 ),
@@ -155,6 +161,7 @@ mInstancingThreadedCullingMethod( threadedCullingMethod ),
 mUserTask( 0 ),
 mRequestType( NUM_REQUESTS ),
 mWorkerThreadsBarrier( 0 ),
+mNumBatchedCulls( 0 ),
 mSuppressRenderStateChanges(false),
 mLastLightHash(0),
 mLastLightLimit(0),
@@ -491,6 +498,131 @@ void SceneManager::destroyItem( Item *i )
     destroyMovableObject( i );
 }
 //-----------------------------------------------------------------------
+void SceneManager::createItems( const String &meshName, const String &groupName, size_t numItems,
+                                vector<Item*>::type &outItems, SceneMemoryMgrTypes sceneType )
+{
+    NameValuePairList params;
+    params["mesh"] = meshName;
+    params["resourceGroup"] = groupName;
+
+    MovableObjectFactory *factory =
+            Root::getSingleton().getMovableObjectFactory( ItemFactory::FACTORY_TYPE_NAME );
+    MovableObjectCollection *objectMap =
+            getMovableObjectCollection( ItemFactory::FACTORY_TYPE_NAME );
+    ObjectMemoryManager *objectMemMgr = &mEntityMemoryManager[sceneType];
+
+    //Items are always created in render queue 0. @see Item::Item
+    objectMemMgr->reserve( 0, numItems );
+    outItems.reserve( outItems.size() + numItems );
+
+    OGRE_LOCK_MUTEX(objectMap->mutex);
+
+    objectMap->movableObjects.reserve( objectMap->movableObjects.size() + numItems );
+
+    for( size_t i=0; i<numItems; ++i )
+    {
+        MovableObject *newObj = factory->createInstance( Id::generateNewId<MovableObject>(),
+                                                         objectMemMgr, this, &params );
+        objectMap->movableObjects.push_back( newObj );
+        newObj->mGlobalIndex = objectMap->movableObjects.size() - 1;
+        outItems.push_back( static_cast<Item*>( newObj ) );
+    }
+}
+//-----------------------------------------------------------------------
+/// The ones at the end of the memory pool first.
+static bool OrderMovableObjectsForDestruction( MovableObject *a, MovableObject *b )
+{
+    const ObjectData &oa = a->_getObjectData();
+    const ObjectData &ob = b->_getObjectData();
+    return std::greater<MovableObject* const*>()( oa.mOwner + oa.mIndex, ob.mOwner + ob.mIndex );
+}
+//-----------------------------------------------------------------------
+void SceneManager::destroyItems( const vector<Item*>::type &items )
+{
+    MovableObjectCollection *objectMap =
+            getMovableObjectCollection( ItemFactory::FACTORY_TYPE_NAME );
+    MovableObjectFactory *factory =
+            Root::getSingleton().getMovableObjectFactory( ItemFactory::FACTORY_TYPE_NAME );
+
+    MovableObjectVec sortedObjs( items.begin(), items.end() );
+    std::sort( sortedObjs.begin(), sortedObjs.end() );
+
+    OGRE_LOCK_MUTEX(objectMap->mutex);
+
+    {
+        //Validate the whole batch before destroying anything
+        MovableObjectVec::const_iterator itor = sortedObjs.begin();
+        MovableObjectVec::const_iterator end  = sortedObjs.end();
+
+        while( itor != end )
+        {
+            checkMovableObjectIntegrity( objectMap->movableObjects, *itor );
+            ++itor;
+        }
+
+        if( std::adjacent_find( sortedObjs.begin(), sortedObjs.end() ) != sortedObjs.end() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "The same Item is present twice",
+                         "SceneManager::destroyItems" );
+        }
+    }
+
+    {
+        //WireAabb::track removes the entry (swapping the last one into its place),
+        //thus don't advance when an entry gets removed.
+        size_t idx = 0;
+        while( idx < mTrackingWireAabbs.size() )
+        {
+            WireAabb *wireAabb = mTrackingWireAabbs[idx];
+            MovableObject *trackedObject = const_cast<MovableObject*>(
+                        wireAabb->getTrackedObject() );
+            if( std::binary_search( sortedObjs.begin(), sortedObjs.end(), trackedObject ) )
+                wireAabb->track( (MovableObject*)0 );
+            else
+                ++idx;
+        }
+    }
+
+    std::sort( sortedObjs.begin(), sortedObjs.end(), OrderMovableObjectsForDestruction );
+
+    bool cleanupsDeferred[NUM_SCENE_MEMORY_MANAGER_TYPES];
+    for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+    {
+        cleanupsDeferred[i] = mEntityMemoryManager[i].getCleanupsDeferred();
+        mEntityMemoryManager[i].setCleanupsDeferred( true );
+    }
+
+    try
+    {
+        MovableObjectVec::const_iterator itor = sortedObjs.begin();
+        MovableObjectVec::const_iterator end  = sortedObjs.end();
+
+        while( itor != end )
+        {
+            MovableObject *m = *itor;
+
+            MovableObjectVec::iterator itObj = objectMap->movableObjects.begin() + m->mGlobalIndex;
+            itObj = efficientVectorRemove( objectMap->movableObjects, itObj );
+            factory->destroyInstance( m );
+
+            //The MovableObject that was at the end got swapped and has now a different index
+            if( itObj != objectMap->movableObjects.end() )
+                (*itObj)->mGlobalIndex = itObj - objectMap->movableObjects.begin();
+
+            ++itor;
+        }
+    }
+    catch( ... )
+    {
+        for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+            mEntityMemoryManager[i].setCleanupsDeferred( cleanupsDeferred[i] );
+        throw;
+    }
+
+    for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+        mEntityMemoryManager[i].setCleanupsDeferred( cleanupsDeferred[i] );
+}
+//-----------------------------------------------------------------------
 void SceneManager::destroyAllItems(void)
 {
     destroyAllMovableObjectsByType(ItemFactory::FACTORY_TYPE_NAME);
@@ -724,6 +856,24 @@ void SceneManager::destroyAllParticleSystems(void)
     destroyAllMovableObjectsByType(ParticleSystemFactory::FACTORY_TYPE_NAME);
 }
 //-----------------------------------------------------------------------
+void SceneManager::_addParticleSystemToUpdate( ParticleSystem *particleSystem )
+{
+    mParticleSystemsToUpdate.push_back( particleSystem );
+}
+//-----------------------------------------------------------------------
+void SceneManager::_removeParticleSystemToUpdate( ParticleSystem *particleSystem )
+{
+    ParticleSystemVec::iterator itor = std::find( mParticleSystemsToUpdate.begin(),
+                                                  mParticleSystemsToUpdate.end(), particleSystem );
+    if( itor != mParticleSystemsToUpdate.end() )
+        efficientVectorRemove( mParticleSystemsToUpdate, itor );
+}
+//-----------------------------------------------------------------------
+void SceneManager::_addParticleGeometryRequest( ParticleSystem *particleSystem, const Camera *camera )
+{
+    mParticleGeometryRequests.push_back( ParticleGeometryRequest( particleSystem, camera ) );
+}
+//-----------------------------------------------------------------------
 void SceneManager::clearScene( bool deleteIndestructibleToo, bool reattachCameras )
 {
     destroyAllStaticGeometry();
@@ -888,6 +1038,190 @@ void SceneManager::destroySceneNode( SceneNode* sn )
         (*itor)->mGlobalIndex = itor - mSceneNodes.begin();
 }
 //-----------------------------------------------------------------------
+void SceneManager::createSceneNodes( size_t numNodes, SceneNodeList &outSceneNodes,
+                                     SceneNode *parent, SceneMemoryMgrTypes sceneType )
+{
+    //Children of a SceneNode end up in mNodeMemoryManager[sceneType] too. @see createChildImpl
+    const size_t depth = parent ? parent->getDepthLevel() + 1u : 0u;
+    mNodeMemoryManager[sceneType].reserve( depth, numNodes );
+
+    mSceneNodes.reserve( mSceneNodes.size() + numNodes );
+    outSceneNodes.reserve( outSceneNodes.size() + numNodes );
+
+    for( size_t i=0; i<numNodes; ++i )
+    {
+        SceneNode *sceneNode = parent ? parent->createChildSceneNode( sceneType ) :
+                                        createSceneNode( sceneType );
+        outSceneNodes.push_back( sceneNode );
+    }
+}
+//-----------------------------------------------------------------------
+/// Deepest nodes first, then the ones at the end of the memory pool first.
+static bool OrderSceneNodesForDestruction( SceneNode *a, SceneNode *b )
+{
+    if( a->getDepthLevel() != b->getDepthLevel() )
+        return a->getDepthLevel() > b->getDepthLevel();
+
+    const Transform &ta = a->_getTransform();
+    const Transform &tb = b->_getTransform();
+    return std::greater<Node* const*>()( ta.mOwner + ta.mIndex, tb.mOwner + tb.mIndex );
+}
+//-----------------------------------------------------------------------
+void SceneManager::destroySceneNodes( const SceneNodeList &sceneNodes )
+{
+    SceneNodeList sortedNodes( sceneNodes );
+    std::sort( sortedNodes.begin(), sortedNodes.end() );
+
+    {
+        SceneNodeList::const_iterator itor = sortedNodes.begin();
+        SceneNodeList::const_iterator end  = sortedNodes.end();
+
+        while( itor != end )
+        {
+            SceneNode *sn = *itor;
+            if( sn->mGlobalIndex >= mSceneNodes.size() ||
+                sn != *(mSceneNodes.begin() + sn->mGlobalIndex) )
+            {
+                OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR, "SceneNode ID: " +
+                    StringConverter::toString( sn->getId() ) + ", named '" + sn->getName() +
+                    "' had it's mGlobalIndex out of date!!! (or the SceneNode wasn't "
+                    "created with this SceneManager)", "SceneManager::destroySceneNodes");
+            }
+            ++itor;
+        }
+
+        if( std::adjacent_find( sortedNodes.begin(), sortedNodes.end() ) != sortedNodes.end() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "The same SceneNode is present twice",
+                         "SceneManager::destroySceneNodes" );
+        }
+    }
+
+    {
+        // For any scene nodes which are tracking these nodes
+        // (or if these nodes are trackers), remove their entries.
+        AutoTrackingSceneNodeVec::iterator itor = mAutoTrackingSceneNodes.begin();
+        AutoTrackingSceneNodeVec::iterator end  = mAutoTrackingSceneNodes.end();
+
+        while( itor != end )
+        {
+            if( std::binary_search( sortedNodes.begin(), sortedNodes.end(), itor->source ) ||
+                std::binary_search( sortedNodes.begin(), sortedNodes.end(), itor->target ) )
+            {
+                itor = efficientVectorRemove( mAutoTrackingSceneNodes, itor );
+                end  = mAutoTrackingSceneNodes.end();
+            }
+            else
+            {
+                ++itor;
+            }
+        }
+    }
+
+    std::sort( sortedNodes.begin(), sortedNodes.end(), OrderSceneNodesForDestruction );
+
+    bool cleanupsDeferred[NUM_SCENE_MEMORY_MANAGER_TYPES];
+    for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+    {
+        cleanupsDeferred[i] = mNodeMemoryManager[i].getCleanupsDeferred();
+        mNodeMemoryManager[i].setCleanupsDeferred( true );
+    }
+    const bool tagPointCleanupsDeferred = mTagPointNodeMemoryManager.getCleanupsDeferred();
+    mTagPointNodeMemoryManager.setCleanupsDeferred( true );
+
+    try
+    {
+        SceneNodeList::const_iterator itor = sortedNodes.begin();
+        SceneNodeList::const_iterator end  = sortedNodes.end();
+
+        while( itor != end )
+        {
+            SceneNode *sn = *itor;
+
+            //Unlike destroySceneNode, we don't detach from the parent first, which would move the
+            //node to depth 0 only to destroy it right after. ~Node detaches from the parent after
+            //releasing its slot. Just notify the listener, as removeChild would have done.
+            if( sn->getParent() && sn->getListener() )
+                sn->getListener()->nodeDetached( sn );
+
+            SceneNodeList::iterator itNode = mSceneNodes.begin() + sn->mGlobalIndex;
+            itNode = efficientVectorRemove( mSceneNodes, itNode );
+            OGRE_DELETE sn;
+
+            //The node that was at the end got swapped and has now a different index
+            if( itNode != mSceneNodes.end() )
+                (*itNode)->mGlobalIndex = itNode - mSceneNodes.begin();
+
+            ++itor;
+        }
+    }
+    catch( ... )
+    {
+        for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+            mNodeMemoryManager[i].setCleanupsDeferred( cleanupsDeferred[i] );
+        mTagPointNodeMemoryManager.setCleanupsDeferred( tagPointCleanupsDeferred );
+        throw;
+    }
+
+    for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+        mNodeMemoryManager[i].setCleanupsDeferred( cleanupsDeferred[i] );
+    mTagPointNodeMemoryManager.setCleanupsDeferred( tagPointCleanupsDeferred );
+}
+//-----------------------------------------------------------------------
+void SceneManager::setDefragmentationBudget( size_t maxSlotMovesPerFrame )
+{
+    mDefragmentationBudget = maxSlotMovesPerFrame;
+
+    //With a budget, holes are filled every frame by defragmentMemoryManagers instead
+    const bool bDeferred = mDefragmentationBudget != 0;
+
+    for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+    {
+        mNodeMemoryManager[i].setCleanupsDeferred( bDeferred );
+        mEntityMemoryManager[i].setCleanupsDeferred( bDeferred );
+        mForwardPlusMemoryManager[i].setCleanupsDeferred( bDeferred );
+    }
+    mLightMemoryManager.setCleanupsDeferred( bDeferred );
+    mTagPointNodeMemoryManager.setCleanupsDeferred( bDeferred );
+}
+//-----------------------------------------------------------------------
+size_t SceneManager::getWastedMemory(void) const
+{
+    size_t retVal = 0;
+
+    for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+    {
+        const size_t numDepths = mNodeMemoryManager[i].getNumDepths();
+        for( size_t j=0; j<numDepths; ++j )
+            retVal += mNodeMemoryManager[i].getWastedMemory( j );
+
+        const size_t numRenderQueues = mEntityMemoryManager[i].getNumRenderQueues();
+        for( size_t j=0; j<numRenderQueues; ++j )
+            retVal += mEntityMemoryManager[i].getWastedMemory( j );
+
+        const size_t numFwdPlusRenderQueues = mForwardPlusMemoryManager[i].getNumRenderQueues();
+        for( size_t j=0; j<numFwdPlusRenderQueues; ++j )
+            retVal += mForwardPlusMemoryManager[i].getWastedMemory( j );
+    }
+
+    const size_t numLightRenderQueues = mLightMemoryManager.getNumRenderQueues();
+    for( size_t j=0; j<numLightRenderQueues; ++j )
+        retVal += mLightMemoryManager.getWastedMemory( j );
+
+    const size_t numTagPointDepths = mTagPointNodeMemoryManager.getNumDepths();
+    for( size_t j=0; j<numTagPointDepths; ++j )
+        retVal += mTagPointNodeMemoryManager.getWastedMemory( j );
+
+    return retVal;
+}
+//-----------------------------------------------------------------------
+void SceneManager::setStaticSpatialSorting( bool bEnabled )
+{
+    mStaticSpatialSorting = bEnabled;
+    //Force a sort in the next update
+    mStaticSpatialSortVersion = mStaticSceneVersion - 1u;
+}
+//-----------------------------------------------------------------------
 SceneNode* SceneManager::getRootSceneNode( SceneMemoryMgrTypes sceneType )
 {
     return mSceneRoot[sceneType];
@@ -1121,33 +1455,326 @@ void SceneManager::_cullPhase01( Camera* camera, const Camera *lodCamera, Viewpo
 
             // Quick way of reducing overhead/stress on VisibleObjectsBoundsInfo
             // calculation (lastRq can be up to 255)
-            uint8 realFirstRq= firstRq;
-            uint8 realLastRq = 0;
+            uint8 realFirstRq, realLastRq;
+            getRealRqRange( firstRq, lastRq, realFirstRq, realLastRq );
+
+            camera->_setRenderedRqs( realFirstRq, realLastRq );
+
+            if( !consumeBatchedCullResults( camera, lodCamera, realFirstRq, realLastRq ) )
             {
-                ObjectMemoryManagerVec::const_iterator itor = mEntitiesMemoryManagerCulledList.begin();
-                ObjectMemoryManagerVec::const_iterator end  = mEntitiesMemoryManagerCulledList.end();
-                while( itor != end )
+                CullFrustumRequest cullRequest( realFirstRq, realLastRq,
+                                                mIlluminationStage == IRS_RENDER_TO_TEXTURE, true,
+                                                false, &mEntitiesMemoryManagerCulledList,
+                                                camera, lodCamera );
+                fireCullFrustumThreads( cullRequest );
+            }
+        }
+    } // end lock on scene graph mutex
+
+    Root::getSingleton()._popCurrentSceneManager(this);
+}
+//-----------------------------------------------------------------------
+void SceneManager::getRealRqRange( uint8 firstRq, uint8 lastRq,
+                                   uint8 &outFirstRq, uint8 &outLastRq ) const
+{
+    uint8 realFirstRq= firstRq;
+    uint8 realLastRq = 0;
+    {
+        ObjectMemoryManagerVec::const_iterator itor = mEntitiesMemoryManagerCulledList.begin();
+        ObjectMemoryManagerVec::const_iterator end  = mEntitiesMemoryManagerCulledList.end();
+        while( itor != end )
+        {
+            realFirstRq = std::min<uint8>( realFirstRq, (*itor)->_getTotalRenderQueues() );
+            realLastRq  = std::max<uint8>( realLastRq, (*itor)->_getTotalRenderQueues() );
+            ++itor;
+        }
+
+        //clamp RQ values to the real RQ range
+        realFirstRq = std::min(realLastRq, std::max(realFirstRq, firstRq));
+        realLastRq = std::min(realLastRq, std::max(realFirstRq, lastRq));
+    }
+
+    outFirstRq = realFirstRq;
+    outLastRq  = realLastRq;
+}
+//-----------------------------------------------------------------------
+void SceneManager::_cullFrustumsBatched( const BatchedCullFrustumVec &frustums )
+{
+    OgreProfileGroup( "Frustum Culling (batched)", OGREPROF_CULLING );
+
+    if( mNumBatchedCulls == mBatchedCulls.size() )
+        mBatchedCulls.push_back( BatchedCull() );
+
+    BatchedCull &batchedCull = mBatchedCulls[mNumBatchedCulls++];
+    batchedCull.frustums.clear();
+
+    if( !mFindVisibleObjects || mEntitiesMemoryManagerCulledList.empty() )
+        return;
+
+    batchedCull.frustums.reserve( frustums.size() );
+
+    //All frustums culled together must agree on whether this is a shadow caster pass
+    //(it affects which objects are visible and their rendering distance)
+    bool casterPass = false;
+
+    BatchedCullFrustumVec::const_iterator itor = frustums.begin();
+    BatchedCullFrustumVec::const_iterator end  = frustums.end();
+
+    while( itor != end )
+    {
+        const bool isCaster = (itor->visibilityMask & VisibilityFlags::LAYER_SHADOW_CASTER) != 0;
+        if( batchedCull.frustums.empty() )
+            casterPass = isCaster;
+
+        //Frustums without a LOD camera can't be culled in the batch; their
+        //passes will find no results and cull normally.
+        if( isCaster == casterPass && itor->lodCamera )
+        {
+            batchedCull.frustums.push_back( *itor );
+            BatchedCullFrustum &batched = batchedCull.frustums.back();
+            getRealRqRange( itor->firstRq, itor->lastRq, batched.firstRq, batched.lastRq );
+
+            //Update the mutable variables now, before the worker threads read them.
+            itor->lodCamera->getFrustumPlanes();
+        }
+
+        ++itor;
+    }
+
+    if( batchedCull.frustums.empty() )
+        return;
+
+    batchedCull.casterPass = casterPass;
+    batchedCull.visibleObjects.resize( mNumWorkerThreads );
+
+    mRequestType = CULL_FRUSTUM_BATCHED;
+    fireWorkerThreadsAndWait();
+}
+//-----------------------------------------------------------------------
+void SceneManager::_popBatchedCullFrustums(void)
+{
+    assert( mNumBatchedCulls > 0 && "_popBatchedCullFrustums called more times than "
+            "_cullFrustumsBatched" );
+    --mNumBatchedCulls;
+    mBatchedCulls[mNumBatchedCulls].frustums.clear();
+}
+//-----------------------------------------------------------------------
+void SceneManager::cullFrustumsBatched( size_t threadIdx )
+{
+    BatchedCull &batchedCull = mBatchedCulls[mNumBatchedCulls - 1u];
+    const BatchedCullFrustumVec &batchedFrustums = batchedCull.frustums;
+    const size_t numFrustums = batchedFrustums.size();
+
+    VisibleObjectsPerRq &visibleObjects = *(batchedCull.visibleObjects.begin() + threadIdx);
+    {
+        visibleObjects.resize( numFrustums * 255u );
+        VisibleObjectsPerRq::iterator itor = visibleObjects.begin();
+        VisibleObjectsPerRq::iterator end  = visibleObjects.end();
+
+        while( itor != end )
+        {
+            itor->clear();
+            ++itor;
+        }
+    }
+
+    uint8 minFirstRq = 255u;
+    uint8 maxLastRq  = 0;
+
+    FastArray<uint32> sceneVisibilityFlags;
+    sceneVisibilityFlags.reserve( numFrustums );
+    for( size_t i=0; i<numFrustums; ++i )
+    {
+        const BatchedCullFrustum &frustum = batchedFrustums[i];
+        sceneVisibilityFlags.push_back( (frustum.visibilityMask & this->getVisibilityMask()) |
+                                        (frustum.visibilityMask &
+                                         ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS) );
+        minFirstRq = std::min( minFirstRq, frustum.firstRq );
+        maxLastRq  = std::max( maxLastRq, frustum.lastRq );
+    }
+
+    //Frustums that want the render queue currently being processed
+    FastArray<BatchedCullFrustum const *> activeFrustums;
+    FastArray<uint32> activeFlags;
+    FastArray<MovableObject::MovableObjectArray*> activeOutputs;
+    activeFrustums.reserve( numFrustums );
+    activeFlags.reserve( numFrustums );
+    activeOutputs.reserve( numFrustums );
+
+    ObjectMemoryManagerVec::const_iterator it = mEntitiesMemoryManagerCulledList.begin();
+    ObjectMemoryManagerVec::const_iterator en = mEntitiesMemoryManagerCulledList.end();
+
+    while( it != en )
+    {
+        ObjectMemoryManager *memoryManager = *it;
+        const size_t numRenderQueues = memoryManager->getNumRenderQueues();
+
+        size_t firstRq = std::min<size_t>( minFirstRq, numRenderQueues );
+        size_t lastRq  = std::min<size_t>( maxLastRq,  numRenderQueues );
+
+        for( size_t i=firstRq; i<lastRq; ++i )
+        {
+            activeFrustums.clear();
+            activeFlags.clear();
+            activeOutputs.clear();
+
+            for( size_t j=0; j<numFrustums; ++j )
+            {
+                const BatchedCullFrustum &frustum = batchedFrustums[j];
+                if( i >= frustum.firstRq && i < frustum.lastRq )
                 {
-                    realFirstRq = std::min<uint8>( realFirstRq, (*itor)->_getTotalRenderQueues() );
-                    realLastRq  = std::max<uint8>( realLastRq, (*itor)->_getTotalRenderQueues() );
-                    ++itor;
+                    activeFrustums.push_back( &frustum );
+                    activeFlags.push_back( sceneVisibilityFlags[j] );
+                    activeOutputs.push_back( &visibleObjects[j * 255u + i] );
                 }
+            }
+
+            if( activeFrustums.empty() )
+                continue;
 
-                //clamp RQ values to the real RQ range
-                realFirstRq = std::min(realLastRq, std::max(realFirstRq, firstRq));
-                realLastRq = std::min(realLastRq, std::max(realFirstRq, lastRq));
+            ObjectData objData;
+            const size_t totalObjs = memoryManager->getFirstObjectData( objData, i );
+
+            //Distribute the work evenly across all threads (not perfect), taking into
+            //account we need to distribute in multiples of ARRAY_PACKED_REALS
+            size_t numObjs  = ( totalObjs + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
+            numObjs         = ( (numObjs + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
+                                ARRAY_PACKED_REALS;
+
+            const size_t toAdvance = std::min( threadIdx * numObjs, totalObjs );
+
+            //Prevent going out of bounds (usually in the last threadIdx, or
+            //when there are less entities than ARRAY_PACKED_REALS
+            numObjs = std::min( numObjs, totalObjs - toAdvance );
+            objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
+
+            MovableObject::cullFrustums( numObjs, objData, activeFrustums.size(),
+                                         activeFrustums.begin(), activeFlags.begin(),
+                                         activeOutputs.begin(), batchedCull.casterPass );
+        }
+
+        ++it;
+    }
+}
+//-----------------------------------------------------------------------
+bool SceneManager::consumeBatchedCullResults( const Camera *camera, const Camera *lodCamera,
+                                              uint8 firstRq, uint8 lastRq )
+{
+    if( !mNumBatchedCulls || !mCurrentPass )
+        return false;
+
+    const bool casterPass = mIlluminationStage == IRS_RENDER_TO_TEXTURE;
+
+    //Look in the most recent batches first
+    BatchedCull const *batchedCull = 0;
+    size_t frustumIdx = 0;
+    for( size_t i=mNumBatchedCulls; i-- && !batchedCull; )
+    {
+        const BatchedCullFrustumVec &frustums = mBatchedCulls[i].frustums;
+        for( size_t j=0; j<frustums.size() && !batchedCull; ++j )
+        {
+            if( frustums[j].pass == mCurrentPass )
+            {
+                batchedCull = &mBatchedCulls[i];
+                frustumIdx = j;
             }
+        }
+    }
 
-            camera->_setRenderedRqs( realFirstRq, realLastRq );
+    if( !batchedCull )
+        return false;
+
+    //A listener (or something else) may have changed the culling
+    //parameters after they were batched. Cull again if so.
+    const BatchedCullFrustum &frustum = batchedCull->frustums[frustumIdx];
+    if( batchedCull->casterPass != casterPass ||
+        frustum.camera != camera || frustum.lodCamera != lodCamera ||
+        frustum.firstRq != firstRq || frustum.lastRq != lastRq ||
+        frustum.visibilityMask != mCurrentViewport->getVisibilityMask() )
+    {
+        return false;
+    }
+
+    const Plane *frustumPlanes = camera->getFrustumPlanes();
+    for( size_t i=0; i<6; ++i )
+    {
+        if( frustumPlanes[i] != frustum.planes[i] )
+            return false;
+    }
+
+    //Do what cullFrustum would've done, but with the results we already have.
+    {
+        VisibleObjectsPerThreadArray::iterator itor = mVisibleObjects.begin();
+        VisibleObjectsPerThreadArray::iterator end  = mVisibleObjects.end();
 
-            CullFrustumRequest cullRequest( realFirstRq, realLastRq,
-                                            mIlluminationStage == IRS_RENDER_TO_TEXTURE, true, false,
-                                            &mEntitiesMemoryManagerCulledList, camera, lodCamera );
-            fireCullFrustumThreads( cullRequest );
+        while( itor != end )
+        {
+            itor->resize( 255 );
+            VisibleObjectsPerRq::iterator itRq = itor->begin();
+            VisibleObjectsPerRq::iterator enRq = itor->end();
+            while( itRq != enRq )
+            {
+                itRq->clear();
+                ++itRq;
+            }
+            ++itor;
         }
-    } // end lock on scene graph mutex
+    }
 
-    Root::getSingleton()._popCurrentSceneManager(this);
+    const Vector3 cameraPos = camera->_getCachedDerivedPosition();
+    const Vector3 cameraDir = -camera->_getCachedDerivedOrientation().zAxis();
+
+    VisibleObjectsPerRq &visibleObjectsPerRq = *mVisibleObjects.begin();
+
+    for( size_t i=firstRq; i<lastRq; ++i )
+    {
+        MovableObject::MovableObjectArray &outVisibleObjects = *(visibleObjectsPerRq.begin() + i);
+        const bool addToRenderQueue = mRenderQueue->getRenderQueueMode( i ) == RenderQueue::FAST;
+
+        VisibleObjectsPerThreadArray::const_iterator itThread = batchedCull->visibleObjects.begin();
+        VisibleObjectsPerThreadArray::const_iterator enThread = batchedCull->visibleObjects.end();
+
+        while( itThread != enThread )
+        {
+            const MovableObject::MovableObjectArray &culledObjects =
+                    (*itThread)[frustumIdx * 255u + i];
+
+            MovableObject::MovableObjectArray::const_iterator itor = culledObjects.begin();
+            MovableObject::MovableObjectArray::const_iterator end  = culledObjects.end();
+
+            while( itor != end )
+            {
+                MovableObject *movableObject = *itor;
+
+                //Project the vector to the object into the camera's plane. See cullFrustum
+                movableObject->_setCachedDistanceToCamera(
+                            cameraDir.dotProduct( movableObject->getWorldAabb().mCenter -
+                                                  cameraPos ) - movableObject->getWorldRadius() );
+
+                if( addToRenderQueue )
+                {
+                    RenderableArray::const_iterator itRend = movableObject->mRenderables.begin();
+                    RenderableArray::const_iterator enRend = movableObject->mRenderables.end();
+
+                    while( itRend != enRend )
+                    {
+                        mRenderQueue->addRenderableV2( 0, i, casterPass, *itRend, movableObject );
+                        ++itRend;
+                    }
+                }
+                else
+                {
+                    outVisibleObjects.push_back( movableObject );
+                }
+
+                ++itor;
+            }
+
+            ++itThread;
+        }
+    }
+
+    return true;
 }
 //-----------------------------------------------------------------------
 void SceneManager::_renderPhase02(Camera* camera, const Camera *lodCamera, Viewport* vp,
@@ -1261,6 +1888,9 @@ void SceneManager::_renderPhase02(Camera* camera, const Camera *lodCamera, Viewp
                 ++it;
             }
 
+            //Particle systems deferred their vertex generation; do it now in parallel
+            generateAllParticleGeometry();
+
             firePostFindVisibleObjects(vp);
         }
         // Queue skies, if viewport seems it
@@ -2107,6 +2737,21 @@ void SceneManager::updateAllAnimations()
     fireWorkerThreadsAndWait();
 }
 //-----------------------------------------------------------------------
+void SceneManager::defragmentMemoryManagers(void)
+{
+    //Dynamic nodes first, they're the most expensive to traverse with holes (every frame).
+    //Each call also releases the holes at the end of the pools, even if out of budget.
+    size_t budget = mDefragmentationBudget;
+    budget -= mNodeMemoryManager[SCENE_DYNAMIC].defragment( budget );
+    budget -= mEntityMemoryManager[SCENE_DYNAMIC].defragment( budget );
+    budget -= mLightMemoryManager.defragment( budget );
+    budget -= mTagPointNodeMemoryManager.defragment( budget );
+    budget -= mForwardPlusMemoryManager[SCENE_DYNAMIC].defragment( budget );
+    budget -= mNodeMemoryManager[SCENE_STATIC].defragment( budget );
+    budget -= mEntityMemoryManager[SCENE_STATIC].defragment( budget );
+    mForwardPlusMemoryManager[SCENE_STATIC].defragment( budget );
+}
+//-----------------------------------------------------------------------
 void SceneManager::updateAllTransformsThread( const UpdateTransformRequest &request, size_t threadIdx )
 {
     Transform t( request.t );
@@ -2772,6 +3417,14 @@ void SceneManager::highLevelCull()
     mSkeletonAnimManagerCulledList.push_back( &mSkeletonAnimationManager );
     mTagPointNodeMemoryManagerUpdateList.push_back( &mTagPointNodeMemoryManager );
 
+    if( mStaticEntitiesDirty ||
+        mStaticMinDepthLevelDirty < mNodeMemoryManager[SCENE_STATIC].getNumDepths() ||
+        mLastNumStaticEntities != mEntityMemoryManager[SCENE_STATIC].getTotalNumObjects() )
+    {
+        mLastNumStaticEntities = mEntityMemoryManager[SCENE_STATIC].getTotalNumObjects();
+        ++mStaticSceneVersion;
+    }
+
     if( mStaticEntitiesDirty )
     {
         //Entities have changed
@@ -2807,6 +3460,9 @@ void SceneManager::updateSceneGraph()
     // Update controllers 
     ControllerManager::getSingleton().updateAllControllers();
 
+    if( mDefragmentationBudget )
+        defragmentMemoryManagers();
+
     highLevelCull();
     _applySceneAnimations();
     updateAllTransforms();
@@ -2816,9 +3472,17 @@ void SceneManager::updateSceneGraph()
     updateInstanceManagerAnimations();
 #endif
     updateInstanceManagers();
+    updateAllParticleSystems();
     updateAllBounds( mEntitiesMemoryManagerUpdateList );
     updateAllBounds( mLightsMemoryManagerCulledList );
 
+    if( mStaticSpatialSorting && mStaticSpatialSortVersion != mStaticSceneVersion )
+    {
+        //The world AABBs of static entities are up to date by now
+        mEntityMemoryManager[SCENE_STATIC].sortSpatially();
+        mStaticSpatialSortVersion = mStaticSceneVersion;
+    }
+
     {
         // Auto-track nodes
         AutoTrackingSceneNodeVec::const_iterator itor = mAutoTrackingSceneNodes.begin();
@@ -4140,6 +4804,46 @@ AxisAlignedBox SceneManager::_calculateCurrentCastersBox( uint32 viewportVisibil
     return retVal;
 }
 //---------------------------------------------------------------------
+bool SceneManager::_hasDynamicCastersInVolume( uint32 viewportVisibilityMask, uint8 _firstRq,
+                                               uint8 _lastRq, const Plane planes[6] ) const
+{
+    const uint32 sceneVisibilityFlags = (viewportVisibilityMask & getVisibilityMask()) |
+                                        (viewportVisibilityMask &
+                                         ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS);
+
+    ObjectMemoryManagerVec::const_iterator it = mEntitiesMemoryManagerCulledList.begin();
+    ObjectMemoryManagerVec::const_iterator en = mEntitiesMemoryManagerCulledList.end();
+
+    while( it != en )
+    {
+        ObjectMemoryManager *objMemoryManager = *it;
+
+        if( objMemoryManager->getMemoryManagerType() == SCENE_DYNAMIC )
+        {
+            const size_t numRenderQueues = objMemoryManager->getNumRenderQueues();
+
+            size_t firstRq = std::min<size_t>( _firstRq, numRenderQueues );
+            size_t lastRq  = std::min<size_t>( _lastRq,  numRenderQueues );
+
+            for( size_t i=firstRq; i<lastRq; ++i )
+            {
+                ObjectData objData;
+                const size_t numObjs = objMemoryManager->getFirstObjectData( objData, i );
+
+                if( MovableObject::hasCastersInVolume( numObjs, objData,
+                                                       sceneVisibilityFlags, planes ) )
+                {
+                    return true;
+                }
+            }
+        }
+
+        ++it;
+    }
+
+    return false;
+}
+//---------------------------------------------------------------------
 void SceneManager::propagateRelativeOrigin( SceneNode *sceneNode, const Vector3 &relativeOrigin )
 {
     if( sceneNode->numAttachedObjects() > 0 )
@@ -4716,6 +5420,96 @@ void SceneManager::updateInstanceManagers(void)
     }
 }
 //---------------------------------------------------------------------
+void SceneManager::updateAllParticleSystemsThread( size_t threadIdx )
+{
+    //Systems vary wildly in cost, interleave them rather than splitting in contiguous ranges
+    const size_t numSystems = mParticleSystemsToUpdate.size();
+    for( size_t i=threadIdx; i<numSystems; i += mNumWorkerThreads )
+        mParticleSystemsToUpdate[i]->_updateThreaded();
+}
+//---------------------------------------------------------------------
+void SceneManager::updateAllParticleSystems(void)
+{
+    OgreProfile( "updateAllParticleSystems" );
+
+    //Do the main thread-only work first, and drop the systems that don't need updating
+    ParticleSystemVec::iterator itor = mParticleSystemsToUpdate.begin();
+    ParticleSystemVec::iterator end  = mParticleSystemsToUpdate.end();
+    ParticleSystemVec::iterator dst  = mParticleSystemsToUpdate.begin();
+
+    while( itor != end )
+    {
+        if( (*itor)->_prepareThreadedUpdate() )
+            *dst++ = *itor;
+        ++itor;
+    }
+
+    mParticleSystemsToUpdate.erase( dst, end );
+
+    if( mParticleSystemsToUpdate.size() == 1u )
+    {
+        //Not worth waking up the threads
+        mParticleSystemsToUpdate[0]->_updateThreaded();
+    }
+    else if( !mParticleSystemsToUpdate.empty() )
+    {
+        mRequestType = UPDATE_PARTICLE_SYSTEMS;
+        fireWorkerThreadsAndWait();
+    }
+
+    mParticleSystemsToUpdate.clear();
+}
+//---------------------------------------------------------------------
+void SceneManager::generateAllParticleGeometryThread( size_t threadIdx )
+{
+    const size_t numRequests = mParticleGeometryRequests.size();
+    for( size_t i=threadIdx; i<numRequests; i += mNumWorkerThreads )
+    {
+        const ParticleGeometryRequest &request = mParticleGeometryRequests[i];
+        request.particleSystem->_generateGeometry( request.camera );
+    }
+}
+//---------------------------------------------------------------------
+void SceneManager::generateAllParticleGeometry(void)
+{
+    if( mParticleGeometryRequests.empty() )
+        return;
+
+    OgreProfile( "generateAllParticleGeometry" );
+
+    if( mParticleGeometryRequests.size() == 1u )
+    {
+        //Not worth waking up the threads
+        generateAllParticleGeometryThread( 0 );
+    }
+    else
+    {
+        //Update the frustum planes now (mutable variables inside const
+        //functions) since the workers will be culling against them.
+        ParticleGeometryRequestVec::const_iterator itor = mParticleGeometryRequests.begin();
+        ParticleGeometryRequestVec::const_iterator end  = mParticleGeometryRequests.end();
+        while( itor != end )
+        {
+            itor->camera->getFrustumPlanes();
+            ++itor;
+        }
+
+        mRequestType = GENERATE_PARTICLE_GEOMETRY;
+        fireWorkerThreadsAndWait();
+    }
+
+    //Release what was reserved (i.e. unlock the buffers) from the main thread
+    ParticleGeometryRequestVec::const_iterator itor = mParticleGeometryRequests.begin();
+    ParticleGeometryRequestVec::const_iterator end  = mParticleGeometryRequests.end();
+    while( itor != end )
+    {
+        itor->particleSystem->_finishGeometry();
+        ++itor;
+    }
+
+    mParticleGeometryRequests.clear();
+}
+//---------------------------------------------------------------------
 AxisAlignedBoxSceneQuery* 
 SceneManager::createAABBQuery(const AxisAlignedBox& box, uint32 mask)
 {
@@ -5320,6 +6114,15 @@ unsigned long SceneManager::_updateWorkerThread( ThreadHandle *threadHandle )
 {
     bool exitThread = false;
     size_t threadIdx = threadHandle->getThreadIdx();
+#if OGRE_PROFILING == OGRE_PROFILING_TRACE
+    if( TraceProfiler::getSingletonPtr() )
+    {
+        char threadName[32];
+        LwString name( LwString::FromEmptyPointer( threadName, sizeof( threadName ) ) );
+        name.a( "SceneManager Worker ", (uint32)threadIdx );
+        TraceProfiler::getSingletonPtr()->setCurrentThreadName( name.c_str() );
+    }
+#endif
     while( !exitThread )
     {
         mWorkerThreadsBarrier->sync();
@@ -5337,37 +6140,88 @@ inline bool SceneManager::updateWorkerThreadImpl( size_t threadIdx )
     switch( mRequestType )
     {
     case CULL_FRUSTUM:
+    {
+        OgreProfileThreaded( "Cull Frustum" );
         cullFrustum( mCurrentCullFrustumRequest, threadIdx );
+    }
+        break;
+    case CULL_FRUSTUM_BATCHED:
+    {
+        OgreProfileThreaded( "Cull Frustums Batched" );
+        cullFrustumsBatched( threadIdx );
+    }
         break;
     case UPDATE_ALL_ANIMATIONS:
+    {
+        OgreProfileThreaded( "Update All Animations" );
         updateAllAnimationsThread( threadIdx );
+    }
         break;
     case UPDATE_ALL_TRANSFORMS:
+    {
+        OgreProfileThreaded( "Update All Transforms" );
         updateAllTransformsThread( mUpdateTransformRequest, threadIdx );
+    }
         break;
     case UPDATE_ALL_BONE_TO_TAG_TRANSFORMS:
+    {
+        OgreProfileThreaded( "Update Bone To Tag Transforms" );
         updateAllTransformsBoneToTagThread( mUpdateTransformRequest, threadIdx );
+    }
         break;
     case UPDATE_ALL_TAG_ON_TAG_TRANSFORMS:
+    {
+        OgreProfileThreaded( "Update Tag On Tag Transforms" );
         updateAllTransformsTagOnTagThread( mUpdateTransformRequest, threadIdx );
+    }
         break;
     case UPDATE_ALL_BOUNDS:
+    {
+        OgreProfileThreaded( "Update All Bounds" );
         updateAllBoundsThread( *mUpdateBoundsRequest, threadIdx );
+    }
         break;
     case UPDATE_ALL_LODS:
+    {
+        OgreProfileThreaded( "Update All Lods" );
         updateAllLodsThread( mUpdateLodRequest, threadIdx );
+    }
         break;
     case UPDATE_INSTANCE_MANAGERS:
+    {
+        OgreProfileThreaded( "Update Instance Managers" );
         updateInstanceManagersThread( threadIdx );
+    }
+        break;
+    case UPDATE_PARTICLE_SYSTEMS:
+    {
+        OgreProfileThreaded( "Update Particle Systems" );
+        updateAllParticleSystemsThread( threadIdx );
+    }
+        break;
+    case GENERATE_PARTICLE_GEOMETRY:
+    {
+        OgreProfileThreaded( "Generate Particle Geometry" );
+        generateAllParticleGeometryThread( threadIdx );
+    }
         break;
     case BUILD_LIGHT_LIST01:
+    {
+        OgreProfileThreaded( "Build Light List 01" );
         buildLightListThread01( mBuildLightListRequestPerThread[threadIdx], threadIdx );
+    }
         break;
     case BUILD_LIGHT_LIST02:
+    {
+        OgreProfileThreaded( "Build Light List 02" );
         buildLightListThread02( threadIdx );
+    }
         break;
     case USER_UNIFORM_SCALABLE_TASK:
+    {
+        OgreProfileThreaded( "User Uniform Scalable Task" );
         mUserTask->execute( threadIdx, mNumWorkerThreads );
+    }
         break;
     case STOP_THREADS:
         exitThread = true;
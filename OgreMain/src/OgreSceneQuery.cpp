@@ -32,6 +32,25 @@ THE SOFTWARE.
 
 namespace Ogre {
 
+    static void copyToBatchOutput( const SceneQueryResult &result, size_t queryIdx,
+                                   const SceneQueryBatchOutput &output )
+    {
+        SceneQueryBatchResult * RESTRICT_ALIAS dst = output.results +
+                                                     queryIdx * output.maxResultsPerQuery;
+        uint32 numResults = 0;
+        SceneQueryResultMovableList::const_iterator itor = result.movables.begin();
+        SceneQueryResultMovableList::const_iterator end  = result.movables.end();
+
+        while( itor != end && numResults < output.maxResultsPerQuery )
+        {
+            dst[numResults].movable  = *itor;
+            dst[numResults].distance = 0;
+            ++numResults;
+            ++itor;
+        }
+
+        output.numResults[queryIdx] = numResults;
+    }
     //-----------------------------------------------------------------------
     SceneQuery::SceneQuery(SceneManager* mgr)
         : mParentSceneMgr(mgr), mQueryMask(SceneManager::QUERY_ENTITY_DEFAULT_MASK),
@@ -140,6 +159,22 @@ namespace Ogre {
         return mAABB;
     }
     //-----------------------------------------------------------------------
+    void AxisAlignedBoxSceneQuery::executeBatch( const AxisAlignedBox *boxes, size_t numBoxes,
+                                                 const SceneQueryBatchOutput &output )
+    {
+        //Generic version: run each query individually.
+        const AxisAlignedBox oldBox = mAABB;
+
+        for( size_t i=0; i<numBoxes; ++i )
+        {
+            mAABB = boxes[i];
+            copyToBatchOutput( execute(), i, output );
+        }
+
+        clearResults();
+        mAABB = oldBox;
+    }
+    //-----------------------------------------------------------------------
     SphereSceneQuery::SphereSceneQuery(SceneManager* mgr)
         : RegionSceneQuery(mgr)
     {
@@ -158,6 +193,22 @@ namespace Ogre {
     {
         return mSphere;
     }
+    //-----------------------------------------------------------------------
+    void SphereSceneQuery::executeBatch( const Sphere *spheres, size_t numSpheres,
+                                         const SceneQueryBatchOutput &output )
+    {
+        //Generic version: run each query individually.
+        const Sphere oldSphere = mSphere;
+
+        for( size_t i=0; i<numSpheres; ++i )
+        {
+            mSphere = spheres[i];
+            copyToBatchOutput( execute(), i, output );
+        }
+
+        clearResults();
+        mSphere = oldSphere;
+    }
 
     //-----------------------------------------------------------------------
     PlaneBoundedVolumeListSceneQuery::PlaneBoundedVolumeListSceneQuery(SceneManager* mgr)
@@ -242,6 +293,41 @@ namespace Ogre {
         return mResult;
     }
     //-----------------------------------------------------------------------
+    void RaySceneQuery::executeBatch( const Ray *rays, size_t numRays,
+                                      const SceneQueryBatchOutput &output )
+    {
+        //Generic version: run each query individually.
+        const Ray oldRay = mRay;
+
+        for( size_t i=0; i<numRays; ++i )
+        {
+            mRay = rays[i];
+            const RaySceneQueryResult &result = execute();
+
+            SceneQueryBatchResult * RESTRICT_ALIAS dst = output.results +
+                                                         i * output.maxResultsPerQuery;
+            uint32 numResults = 0;
+            RaySceneQueryResult::const_iterator itor = result.begin();
+            RaySceneQueryResult::const_iterator end  = result.end();
+
+            while( itor != end && numResults < output.maxResultsPerQuery )
+            {
+                if( itor->movable )
+                {
+                    dst[numResults].movable  = itor->movable;
+                    dst[numResults].distance = itor->distance;
+                    ++numResults;
+                }
+                ++itor;
+            }
+
+            output.numResults[i] = numResults;
+        }
+
+        mResult.clear();
+        mRay = oldRay;
+    }
+    //-----------------------------------------------------------------------
     RaySceneQueryResult& RaySceneQuery::getLastResults(void)
     {
         return mResult;
@@ -33,6 +33,15 @@ THE SOFTWARE.
 #include "OgreResourceGroupManager.h"
 #include "OgreLogManager.h"
 #include "OgreStringConverter.h"
+#include "OgreIdString.h"
+
+#include "Hash/MurmurHash3.h"
+
+#if OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_32
+    #define OGRE_HASH128_FUNC MurmurHash3_x86_128
+#else
+    #define OGRE_HASH128_FUNC MurmurHash3_x64_128
+#endif
 
 namespace Ogre
 {
@@ -283,10 +292,29 @@ namespace Ogre
 
     bool ScriptCompiler::compile(const String &str, const String &source, const String &group)
     {
+        ScriptCompilerManager *compilerManager = ScriptCompilerManager::getSingletonPtr();
+        const bool useAstCache = !mListener && compilerManager &&
+                                 compilerManager->getAstCacheEnabled();
+
+        SourceHash hash;
+        if( useAstCache )
+        {
+            hash = computeSourceHash( str, source, group );
+            MemoryDataStreamPtr cachedAst = compilerManager->_getCachedAst( hash );
+            if( !cachedAst.isNull() )
+            {
+                mGroup = group;
+                MemoryDataStream astStream( cachedAst->getPtr(), cachedAst->size(), false, true );
+                AbstractNodeListPtr ast = loadAst( astStream );
+                if( !ast.isNull() )
+                    return _compile( ast, group, false, false, false );
+            }
+        }
+
         ScriptLexer lexer;
         ScriptParser parser;
         ConcreteNodeListPtr nodes = parser.parse(lexer.tokenize(str, source));
-        return compile(nodes, group);
+        return _compileConcreteNodes( nodes, group, useAstCache ? &hash : 0 );
     }
 
 //  static void logAST(int tabs, const AbstractNodePtr &node)
@@ -342,6 +370,12 @@ namespace Ogre
 //  }
 
     bool ScriptCompiler::compile(const ConcreteNodeListPtr &nodes, const String &group)
+    {
+        return _compileConcreteNodes( nodes, group, 0 );
+    }
+
+    bool ScriptCompiler::_compileConcreteNodes( const ConcreteNodeListPtr &nodes, const String &group,
+                                      const SourceHash *astCacheKey )
     {
         // Set up the compilation context
         mGroup = group;
@@ -351,6 +385,7 @@ namespace Ogre
 
         // Clear the environment
         mEnv.clear();
+        mImportHashes.clear();
 
         if(mListener)
             mListener->preConversion(this, nodes);
@@ -364,6 +399,17 @@ namespace Ogre
         // Process variable expansion
         processVariables(ast.get());
 
+        // Trees with errors aren't cached, so that the errors get reported again
+        if( astCacheKey && mErrors.empty() )
+        {
+            vector<uint8>::type buffer;
+            saveAst( *ast, buffer );
+            MemoryDataStreamPtr astStream( OGRE_NEW MemoryDataStream( buffer.size() ) );
+            if( !buffer.empty() )
+                memcpy( astStream->getPtr(), &buffer[0], buffer.size() );
+            ScriptCompilerManager::getSingleton()._addAstToCache( *astCacheKey, astStream );
+        }
+
         // Allows early bail-out through the listener
         if(mListener && !mListener->postConversion(this, ast))
             return mErrors.empty();
@@ -381,6 +427,7 @@ namespace Ogre
         }
 
         mImports.clear();
+        mImportHashes.clear();
         mImportRequests.clear();
         mImportTable.clear();
 
@@ -595,8 +642,10 @@ namespace Ogre
             DataStreamPtr stream = ResourceGroupManager::getSingleton().openResource(name, mGroup);
             if(!stream.isNull())
             {
+                const String str = stream->getAsString();
+                mImportHashes[name] = computeSourceHash( str, name );
                 ScriptLexer lexer;
-                ScriptTokenListPtr tokens = lexer.tokenize(stream->getAsString(), name);
+                ScriptTokenListPtr tokens = lexer.tokenize(str, name);
                 ScriptParser parser;
                 nodes = parser.parse(tokens);
             }
@@ -984,6 +1033,297 @@ namespace Ogre
         }
     }
 
+    ScriptCompiler::SourceHash ScriptCompiler::computeSourceHash( const String &str,
+                                                                  const String &source,
+                                                                  const String &group )
+    {
+        uint64 hashVal[3][2];
+        OGRE_HASH128_FUNC( str.c_str(), str.size(), IdString::Seed, hashVal[0] );
+        OGRE_HASH128_FUNC( source.c_str(), source.size(), IdString::Seed, hashVal[1] );
+        OGRE_HASH128_FUNC( group.c_str(), group.size(), IdString::Seed, hashVal[2] );
+
+        SourceHash retVal;
+        OGRE_HASH128_FUNC( hashVal, sizeof( hashVal ), IdString::Seed, retVal.hashVal );
+        return retVal;
+    }
+
+    namespace
+    {
+        void writeAstData( vector<uint8>::type &outBuffer, const void *data, size_t size )
+        {
+            const uint8 *bytes = reinterpret_cast<const uint8*>( data );
+            outBuffer.insert( outBuffer.end(), bytes, bytes + size );
+        }
+        void writeAstUint32( vector<uint8>::type &outBuffer, uint32 value )
+        {
+            writeAstData( outBuffer, &value, sizeof(uint32) );
+        }
+        void writeAstString( vector<uint8>::type &outBuffer, const String &value )
+        {
+            writeAstUint32( outBuffer, static_cast<uint32>( value.size() ) );
+            writeAstData( outBuffer, value.c_str(), value.size() );
+        }
+        void throwCorruptAst(void)
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE, "Corrupt AST cache",
+                         "ScriptCompiler::loadAst" );
+        }
+        /// Bytes left to read. Every read is checked against it, so that corrupt or
+        /// truncated data can't make us allocate (or read) more than what's there.
+        size_t getAstBytesLeft( DataStream &stream )
+        {
+            return stream.size() - stream.tell();
+        }
+        void readAstData( DataStream &stream, void *outData, size_t size )
+        {
+            if( stream.read( outData, size ) != size )
+                throwCorruptAst();
+        }
+        uint32 readAstUint32( DataStream &stream )
+        {
+            uint32 value = 0;
+            readAstData( stream, &value, sizeof(uint32) );
+            return value;
+        }
+        /// Reads a count of elements that take at least minElementSize bytes each.
+        uint32 readAstCount( DataStream &stream, size_t minElementSize )
+        {
+            const uint32 count = readAstUint32( stream );
+            if( count > getAstBytesLeft( stream ) / minElementSize )
+                throwCorruptAst();
+            return count;
+        }
+        void readAstString( DataStream &stream, String &outValue )
+        {
+            outValue.resize( readAstCount( stream, 1u ) );
+            if( !outValue.empty() )
+                readAstData( stream, &outValue[0], outValue.size() );
+        }
+    }
+
+    void ScriptCompiler::saveAst( const AbstractNodeList &nodes, vector<uint8>::type &outBuffer )
+    {
+        // Every script read by loadImportPath is a dependency, even the empty ones
+        // (which aren't in mImports).
+        writeAstUint32( outBuffer, static_cast<uint32>( mImportHashes.size() ) );
+        for( ImportHashMap::const_iterator it = mImportHashes.begin(); it != mImportHashes.end(); ++it )
+        {
+            writeAstString( outBuffer, it->first );
+            writeAstData( outBuffer, &it->second, sizeof(SourceHash) );
+        }
+
+        writeAstNodes( nodes, outBuffer );
+    }
+
+    void ScriptCompiler::writeAstNodes( const AbstractNodeList &nodes, vector<uint8>::type &outBuffer )
+    {
+        writeAstUint32( outBuffer, static_cast<uint32>( nodes.size() ) );
+        for( AbstractNodeList::const_iterator i = nodes.begin(); i != nodes.end(); ++i )
+        {
+            const AbstractNode *node = (*i).get();
+            writeAstUint32( outBuffer, static_cast<uint32>( node->type ) );
+            writeAstString( outBuffer, node->file );
+            writeAstUint32( outBuffer, node->line );
+
+            switch( node->type )
+            {
+            case ANT_ATOM:
+                writeAstString( outBuffer, static_cast<const AtomAbstractNode*>( node )->value );
+                break;
+            case ANT_OBJECT:
+                {
+                    const ObjectAbstractNode *obj = static_cast<const ObjectAbstractNode*>( node );
+                    writeAstString( outBuffer, obj->name );
+                    writeAstString( outBuffer, obj->cls );
+                    writeAstUint32( outBuffer, obj->abstract ? 1u : 0u );
+                    writeAstUint32( outBuffer, static_cast<uint32>( obj->bases.size() ) );
+                    for( size_t j=0; j<obj->bases.size(); ++j )
+                        writeAstString( outBuffer, obj->bases[j] );
+                    const map<String,String>::type &variables = obj->getVariables();
+                    writeAstUint32( outBuffer, static_cast<uint32>( variables.size() ) );
+                    for( map<String,String>::type::const_iterator j = variables.begin();
+                         j != variables.end(); ++j )
+                    {
+                        writeAstString( outBuffer, j->first );
+                        writeAstString( outBuffer, j->second );
+                    }
+                    writeAstNodes( obj->children, outBuffer );
+                    writeAstNodes( obj->values, outBuffer );
+                }
+                break;
+            case ANT_PROPERTY:
+                {
+                    const PropertyAbstractNode *prop = static_cast<const PropertyAbstractNode*>( node );
+                    writeAstString( outBuffer, prop->name );
+                    writeAstNodes( prop->values, outBuffer );
+                }
+                break;
+            case ANT_IMPORT:
+                {
+                    const ImportAbstractNode *import = static_cast<const ImportAbstractNode*>( node );
+                    writeAstString( outBuffer, import->target );
+                    writeAstString( outBuffer, import->source );
+                }
+                break;
+            case ANT_VARIABLE_ACCESS:
+                writeAstString( outBuffer,
+                                static_cast<const VariableAccessAbstractNode*>( node )->name );
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    AbstractNodeListPtr ScriptCompiler::loadAst( DataStream &stream )
+    {
+        // MEMCATEGORY_GENERAL is the only category supported for SharedPtr
+        AbstractNodeListPtr retVal( OGRE_NEW_T(AbstractNodeList, MEMCATEGORY_GENERAL)(),
+                                    SPFM_DELETE_T );
+
+        try
+        {
+            ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+
+            const uint32 numImports = readAstCount( stream, sizeof(uint32) + sizeof(SourceHash) );
+            for( uint32 i=0; i<numImports; ++i )
+            {
+                String importName;
+                readAstString( stream, importName );
+                SourceHash savedHash;
+                readAstData( stream, &savedHash, sizeof(SourceHash) );
+
+                if( !resourceGroupManager.resourceExistsInAnyGroup( importName ) )
+                    return AbstractNodeListPtr();
+
+                DataStreamPtr importStream = resourceGroupManager.openResource( importName, mGroup );
+                if( computeSourceHash( importStream->getAsString(), importName ) != savedHash )
+                    return AbstractNodeListPtr();
+            }
+
+            readAstNodes( stream, *retVal, 0 );
+
+            if( getAstBytesLeft( stream ) != 0 )
+                throwCorruptAst();
+        }
+        catch( Exception &e )
+        {
+            // Not fatal, the script just gets parsed again (and the entry overwritten)
+            LogManager::getSingleton().logMessage( "Discarding cached AST: " + e.getDescription() );
+            retVal.setNull();
+        }
+
+        return retVal;
+    }
+
+    void ScriptCompiler::readAstNodes( DataStream &stream, AbstractNodeList &outNodes,
+                                       AbstractNode *parent )
+    {
+        // Real scripts are nowhere near this deep. Prevents corrupt data from
+        // overflowing the stack.
+        const size_t c_maxAstDepth = 256u;
+        size_t depth = 0;
+        for( const AbstractNode *node = parent; node; node = node->parent )
+            ++depth;
+        if( depth > c_maxAstDepth )
+            throwCorruptAst();
+
+        // Every node takes at least its type, file name length and line
+        const uint32 numNodes = readAstCount( stream, 3u * sizeof(uint32) );
+        for( uint32 i=0; i<numNodes; ++i )
+        {
+            const AbstractNodeType type = static_cast<AbstractNodeType>( readAstUint32( stream ) );
+
+            AbstractNode *node = 0;
+            switch( type )
+            {
+            case ANT_ATOM:
+                node = OGRE_NEW AtomAbstractNode( parent );
+                break;
+            case ANT_OBJECT:
+                node = OGRE_NEW ObjectAbstractNode( parent );
+                break;
+            case ANT_PROPERTY:
+                node = OGRE_NEW PropertyAbstractNode( parent );
+                break;
+            case ANT_IMPORT:
+                node = OGRE_NEW ImportAbstractNode();
+                node->parent = parent;
+                break;
+            case ANT_VARIABLE_ACCESS:
+                node = OGRE_NEW VariableAccessAbstractNode( parent );
+                break;
+            default:
+                throwCorruptAst();
+            }
+
+            AbstractNodePtr nodePtr( node );
+            readAstString( stream, node->file );
+            node->line = readAstUint32( stream );
+
+            switch( type )
+            {
+            case ANT_ATOM:
+                {
+                    AtomAbstractNode *atom = static_cast<AtomAbstractNode*>( node );
+                    readAstString( stream, atom->value );
+                    atom->id = getWordId( atom->value );
+                }
+                break;
+            case ANT_OBJECT:
+                {
+                    ObjectAbstractNode *obj = static_cast<ObjectAbstractNode*>( node );
+                    readAstString( stream, obj->name );
+                    readAstString( stream, obj->cls );
+                    obj->id = getWordId( obj->cls );
+                    obj->abstract = readAstUint32( stream ) != 0;
+                    obj->bases.resize( readAstCount( stream, sizeof(uint32) ) );
+                    for( size_t j=0; j<obj->bases.size(); ++j )
+                        readAstString( stream, obj->bases[j] );
+                    const uint32 numVariables = readAstCount( stream, 2u * sizeof(uint32) );
+                    for( uint32 j=0; j<numVariables; ++j )
+                    {
+                        String varName, varValue;
+                        readAstString( stream, varName );
+                        readAstString( stream, varValue );
+                        obj->setVariable( varName, varValue );
+                    }
+                    readAstNodes( stream, obj->children, obj );
+                    readAstNodes( stream, obj->values, obj );
+                }
+                break;
+            case ANT_PROPERTY:
+                {
+                    PropertyAbstractNode *prop = static_cast<PropertyAbstractNode*>( node );
+                    readAstString( stream, prop->name );
+                    prop->id = getWordId( prop->name );
+                    readAstNodes( stream, prop->values, prop );
+                }
+                break;
+            case ANT_IMPORT:
+                {
+                    ImportAbstractNode *import = static_cast<ImportAbstractNode*>( node );
+                    readAstString( stream, import->target );
+                    readAstString( stream, import->source );
+                }
+                break;
+            case ANT_VARIABLE_ACCESS:
+                readAstString( stream, static_cast<VariableAccessAbstractNode*>( node )->name );
+                break;
+            default:
+                break;
+            }
+
+            outNodes.push_back( nodePtr );
+        }
+    }
+
+    uint32 ScriptCompiler::getWordId( const String &word ) const
+    {
+        IdMap::const_iterator itor = mIds.find( word );
+        return itor != mIds.end() ? itor->second : 0;
+    }
+
     void ScriptCompiler::initWordMap()
     {
         mIds["on"] = ID_ON;
@@ -1243,6 +1583,7 @@ namespace Ogre
         mIds["cubemap"]             = ID_CUBEMAP;
         mIds["mipmaps"]             = ID_MIPMAPS;
         mIds["automipmaps"]         = ID_AUTOMIPMAPS;
+        mIds["transient"]           = ID_TRANSIENT;
 
         mIds["target"] = ID_TARGET;
 
@@ -1664,7 +2005,8 @@ namespace Ogre
     }
     //-----------------------------------------------------------------------
     ScriptCompilerManager::ScriptCompilerManager()
-        :mListener(0), OGRE_THREAD_POINTER_INIT(mScriptCompiler)
+        :mListener(0), OGRE_THREAD_POINTER_INIT(mScriptCompiler),
+        mAstCacheEnabled(false), mAstCacheDirty(false)
     {
             OGRE_LOCK_AUTO_MUTEX;
         mScriptPatterns.push_back("*.program");
@@ -1778,6 +2120,192 @@ namespace Ogre
         }
         OGRE_THREAD_POINTER_GET(mScriptCompiler)->compile(stream->getAsString(), stream->getName(), groupName);
     }
+    //-----------------------------------------------------------------------
+    /// Bump whenever the layout written by ScriptCompiler::saveAst changes
+    static const uint32 AstCacheVersion = 2;
+    //-----------------------------------------------------------------------
+    void ScriptCompilerManager::setAstCacheEnabled( bool enabled )
+    {
+        mAstCacheEnabled = enabled;
+    }
+    //-----------------------------------------------------------------------
+    MemoryDataStreamPtr ScriptCompilerManager::_getCachedAst(
+            const ScriptCompiler::SourceHash &hash ) const
+    {
+        MemoryDataStreamPtr retVal;
+        AstCacheMap::const_iterator itor = mAstCache.find( hash );
+        if( itor != mAstCache.end() )
+            retVal = itor->second;
+        return retVal;
+    }
+    //-----------------------------------------------------------------------
+    void ScriptCompilerManager::_addAstToCache( const ScriptCompiler::SourceHash &hash,
+                                                const MemoryDataStreamPtr &ast )
+    {
+        mAstCache[hash] = ast;
+        mAstCacheDirty = true;
+    }
+    //-----------------------------------------------------------------------
+    void ScriptCompilerManager::saveAstCache( DataStreamPtr stream ) const
+    {
+        if( !stream->isWriteable() )
+        {
+            OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE,
+                         "Unable to write to stream " + stream->getName(),
+                         "ScriptCompilerManager::saveAstCache" );
+        }
+
+        const uint32 version = AstCacheVersion;
+        stream->write( &version, sizeof(uint32) );
+
+        uint32 numEntries = static_cast<uint32>( mAstCache.size() );
+        stream->write( &numEntries, sizeof(uint32) );
+
+        AstCacheMap::const_iterator itor = mAstCache.begin();
+        AstCacheMap::const_iterator end  = mAstCache.end();
+        while( itor != end )
+        {
+            stream->write( &itor->first, sizeof(ScriptCompiler::SourceHash) );
+            uint32 astSize = static_cast<uint32>( itor->second->size() );
+            stream->write( &astSize, sizeof(uint32) );
+            stream->write( itor->second->getPtr(), astSize );
+            uint64 checksum[2];
+            OGRE_HASH128_FUNC( itor->second->getPtr(), astSize, IdString::Seed, checksum );
+            stream->write( checksum, sizeof(checksum) );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void ScriptCompilerManager::loadAstCache( DataStreamPtr stream )
+    {
+        mAstCache.clear();
+        mAstCacheDirty = false;
+
+        uint32 version = 0;
+        stream->read( &version, sizeof(uint32) );
+        if( version != AstCacheVersion )
+        {
+            LogManager::getSingleton().logMessage( "AST cache " + stream->getName() +
+                                                   " is outdated. Ignoring it." );
+            return;
+        }
+
+        // Sizes are validated against what's left in the stream so that a truncated
+        // or corrupt file can't trigger huge allocations, and every entry is checksummed
+        // so that it can't produce a garbage AST. Such a cache is discarded.
+        const size_t streamSize = stream->size();
+        bool isValid = true;
+
+        uint32 numEntries = 0;
+        isValid = stream->read( &numEntries, sizeof(uint32) ) == sizeof(uint32);
+
+        for( uint32 i=0; i<numEntries && isValid; ++i )
+        {
+            ScriptCompiler::SourceHash hash;
+            uint32 astSize = 0;
+            isValid = stream->read( &hash, sizeof(ScriptCompiler::SourceHash) ) ==
+                        sizeof(ScriptCompiler::SourceHash) &&
+                      stream->read( &astSize, sizeof(uint32) ) == sizeof(uint32) &&
+                      astSize <= streamSize - stream->tell();
+            if( isValid )
+            {
+                MemoryDataStreamPtr ast( OGRE_NEW MemoryDataStream( astSize ) );
+                uint64 savedChecksum[2], checksum[2];
+                isValid = stream->read( ast->getPtr(), astSize ) == astSize &&
+                          stream->read( savedChecksum, sizeof(savedChecksum) ) ==
+                            sizeof(savedChecksum);
+                OGRE_HASH128_FUNC( ast->getPtr(), astSize, IdString::Seed, checksum );
+                isValid &= savedChecksum[0] == checksum[0] && savedChecksum[1] == checksum[1];
+                mAstCache[hash] = ast;
+            }
+        }
+
+        isValid &= stream->tell() == streamSize;
+
+        if( !isValid )
+        {
+            LogManager::getSingleton().logMessage( "AST cache " + stream->getName() +
+                                                   " is corrupt. Ignoring it." );
+            mAstCache.clear();
+        }
+    }
+    //-----------------------------------------------------------------------
+    void ScriptCompilerManager::clearAstCache(void)
+    {
+        mAstCache.clear();
+        mAstCacheDirty = false;
+    }
+    //-----------------------------------------------------------------------
+    namespace
+    {
+        class PreparsedConcreteNodes : public ScriptLoader::PreparsedScript
+        {
+        public:
+            ConcreteNodeListPtr nodes;
+            ScriptCompiler::SourceHash hash;
+            /// Set instead of nodes when the AST is already cached
+            String source;
+            String scriptName;
+        };
+    }
+    //-----------------------------------------------------------------------
+    ScriptLoader::PreparsedScript* ScriptCompilerManager::_preparseScript( const String &source,
+                                                                          const String &scriptName,
+                                                                          const String &groupName )
+    {
+        const ScriptCompiler::SourceHash hash = ScriptCompiler::computeSourceHash( source, scriptName,
+                                                                                  groupName );
+        if( mAstCacheEnabled && !mListener && mAstCache.find( hash ) != mAstCache.end() )
+        {
+            //Nothing to parse. compile() will pick the AST from the cache.
+            PreparsedConcreteNodes *retVal = OGRE_NEW PreparsedConcreteNodes();
+            retVal->source      = source;
+            retVal->scriptName  = scriptName;
+            return retVal;
+        }
+
+        ConcreteNodeListPtr nodes;
+        try
+        {
+            ScriptLexer lexer;
+            ScriptParser parser;
+            nodes = parser.parse( lexer.tokenize( source, scriptName ) );
+        }
+        catch( Exception& )
+        {
+            //Let parseScript raise it again from the main thread.
+            return 0;
+        }
+
+        PreparsedConcreteNodes *retVal = OGRE_NEW PreparsedConcreteNodes();
+        retVal->nodes = nodes;
+        retVal->hash = hash;
+        return retVal;
+    }
+    //-----------------------------------------------------------------------
+    void ScriptCompilerManager::_parsePreparsedScript( PreparsedScript *preparsed,
+                                                       const String &groupName )
+    {
+        assert( dynamic_cast<PreparsedConcreteNodes*>( preparsed ) );
+        PreparsedConcreteNodes *preparsedNodes = static_cast<PreparsedConcreteNodes*>( preparsed );
+
+        {
+            OGRE_LOCK_AUTO_MUTEX;
+            OGRE_THREAD_POINTER_GET(mScriptCompiler)->setListener(mListener);
+        }
+        if( preparsedNodes->nodes.isNull() )
+        {
+            OGRE_THREAD_POINTER_GET(mScriptCompiler)->compile( preparsedNodes->source,
+                                                               preparsedNodes->scriptName,
+                                                               groupName );
+        }
+        else
+        {
+            const bool useAstCache = mAstCacheEnabled && !mListener;
+            OGRE_THREAD_POINTER_GET(mScriptCompiler)->_compileConcreteNodes(
+                        preparsedNodes->nodes, groupName, useAstCache ? &preparsedNodes->hash : 0 );
+        }
+    }
 
     //-------------------------------------------------------------------------
     String PreApplyTextureAliasesScriptCompilerEvent::eventType = "preApplyTextureAliases";
@@ -6228,6 +6228,7 @@ namespace Ogre{
         bool automipmaps = false;
         bool isUav = false;
         bool preferDepthTexture = false;
+        bool isTransient = false;
         Ogre::PixelFormatList formats;
 
         while (atomIndex < prop->values.size())
@@ -6370,6 +6371,9 @@ namespace Ogre{
             case ID_AUTOMIPMAPS:
                 automipmaps = true;
                 break;
+            case ID_TRANSIENT:
+                isTransient = true;
+                break;
             case ID_2D_ARRAY:   textureType = TEX_TYPE_2D_ARRAY; break;
             case ID_3D:         textureType = TEX_TYPE_3D; break;
             case ID_CUBEMAP:    textureType = TEX_TYPE_CUBE_MAP; break;
@@ -6451,6 +6455,7 @@ namespace Ogre{
         td->depthBufferFormat   = depthBufferFormat;
         td->preferDepthTexture  = preferDepthTexture;
         td->fsaaExplicitResolve = fsaaExplicitResolve;
+        td->transient       = isTransient;
     }
     //-----------------------------------------------------------------------------------
     void CompositorTextureBaseTranslator::translateBufferProperty( TextureDefinitionBase *defBase,
@@ -0,0 +1,417 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+	(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+
+#include "OgreStableHeaders.h"
+
+#include "OgreTraceProfiler.h"
+#include "OgreLwString.h"
+#include "OgreStringConverter.h"
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32 || OGRE_PLATFORM == OGRE_PLATFORM_WINRT
+    #define WIN32_LEAN_AND_MEAN
+    #ifndef NOMINMAX
+        #define NOMINMAX // required to stop windows.h messing up std::min
+    #endif
+    #include <windows.h>
+#elif OGRE_PLATFORM == OGRE_PLATFORM_APPLE || OGRE_PLATFORM == OGRE_PLATFORM_APPLE_IOS
+    #include <mach/mach_time.h>
+#else
+    #include <time.h>
+#endif
+
+#include <fstream>
+
+namespace Ogre
+{
+    TraceProfiler *TraceProfiler::msInstance = 0;
+
+    TraceProfiler::TraceProfiler() :
+        mEnabled( true ),
+        mProfileGroupMask( 0xFFFFFFFF ),
+        mTlsHandle( OGRE_TLS_INVALID_HANDLE )
+    {
+        Threads::CreateTls( &mTlsHandle );
+        msInstance = this;
+    }
+    //-----------------------------------------------------------------------------------
+    TraceProfiler::~TraceProfiler()
+    {
+        if( !mThreadData.empty() && !mOnShutdownPath.empty() )
+            dumpChromeTrace( mOnShutdownPath );
+
+        msInstance = 0;
+
+        mMutex.lock();
+        PerThreadDataArray::const_iterator itor = mThreadData.begin();
+        PerThreadDataArray::const_iterator end  = mThreadData.end();
+
+        while( itor != end )
+        {
+            destroyChunks( *itor );
+            OGRE_FREE( *itor, MEMCATEGORY_GENERAL );
+            ++itor;
+        }
+        mThreadData.clear();
+        mMutex.unlock();
+
+        Threads::DestroyTls( mTlsHandle );
+        mTlsHandle = OGRE_TLS_INVALID_HANDLE;
+    }
+    //-----------------------------------------------------------------------------------
+    uint64 TraceProfiler::getTimestampNs(void)
+    {
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32 || OGRE_PLATFORM == OGRE_PLATFORM_WINRT
+        static LARGE_INTEGER frequency = { 0 };
+        if( !frequency.QuadPart )
+            QueryPerformanceFrequency( &frequency );
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter( &counter );
+        //Split to avoid overflowing
+        const uint64 seconds = static_cast<uint64>( counter.QuadPart / frequency.QuadPart );
+        const uint64 remainder = static_cast<uint64>( counter.QuadPart % frequency.QuadPart );
+        return seconds * 1000000000ull +
+                (remainder * 1000000000ull) / static_cast<uint64>( frequency.QuadPart );
+#elif OGRE_PLATFORM == OGRE_PLATFORM_APPLE || OGRE_PLATFORM == OGRE_PLATFORM_APPLE_IOS
+        static mach_timebase_info_data_t timebase = { 0, 0 };
+        if( !timebase.denom )
+            mach_timebase_info( &timebase );
+        return (mach_absolute_time() * timebase.numer) / timebase.denom;
+#else
+        struct timespec now;
+        clock_gettime( CLOCK_MONOTONIC, &now );
+        return static_cast<uint64>( now.tv_sec ) * 1000000000ull + static_cast<uint64>( now.tv_nsec );
+#endif
+    }
+    //-----------------------------------------------------------------------------------
+    void TraceProfiler::destroyChunks( PerThreadData *perThreadData )
+    {
+        EventChunk *chunk = perThreadData->firstChunk;
+        while( chunk )
+        {
+            EventChunk *next = chunk->next;
+            OGRE_FREE( chunk, MEMCATEGORY_GENERAL );
+            chunk = next;
+        }
+
+        perThreadData->firstChunk   = 0;
+        perThreadData->currentChunk = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    TraceProfiler::PerThreadData* TraceProfiler::allocatePerThreadData(void)
+    {
+        PerThreadData *perThreadData = reinterpret_cast<PerThreadData*>(
+                    OGRE_MALLOC( sizeof( PerThreadData ), MEMCATEGORY_GENERAL ) );
+        memset( perThreadData, 0, sizeof( PerThreadData ) );
+
+        mMutex.lock();
+        perThreadData->threadId = static_cast<uint32>( mThreadData.size() );
+        mThreadData.push_back( perThreadData );
+        mMutex.unlock();
+
+        LwString threadName( LwString::FromEmptyPointer( perThreadData->threadName,
+                                                         sizeof( perThreadData->threadName ) ) );
+        if( !perThreadData->threadId )
+            threadName.a( "Thread 0 (first to record)" );
+        else
+            threadName.a( "Thread ", perThreadData->threadId );
+
+        Threads::SetTls( mTlsHandle, perThreadData );
+
+        return perThreadData;
+    }
+    //-----------------------------------------------------------------------------------
+    TraceProfiler::PerThreadData* TraceProfiler::getPerThreadData(void)
+    {
+        PerThreadData *perThreadData = reinterpret_cast<PerThreadData*>( Threads::GetTls( mTlsHandle ) );
+        if( !perThreadData )
+            perThreadData = allocatePerThreadData();
+        return perThreadData;
+    }
+    //-----------------------------------------------------------------------------------
+    inline void TraceProfiler::addEvent( PerThreadData *perThreadData, const char *name )
+    {
+        //Take the timestamp first for end events, last for begin events,
+        //so the time spent recording falls outside of the measured span.
+        const uint64 timestampNs = name ? 0 : getTimestampNs();
+
+        EventChunk *chunk = perThreadData->currentChunk;
+        if( !chunk || chunk->numEvents == OGRE_TRACE_PROFILER_EVENTS_PER_CHUNK )
+        {
+            EventChunk *newChunk = reinterpret_cast<EventChunk*>(
+                        OGRE_MALLOC( sizeof( EventChunk ), MEMCATEGORY_GENERAL ) );
+            newChunk->numEvents = 0;
+            newChunk->next      = 0;
+
+            if( chunk )
+                chunk->next = newChunk;
+            else
+                perThreadData->firstChunk = newChunk;
+
+            perThreadData->currentChunk = newChunk;
+            chunk = newChunk;
+        }
+
+        Event &event = chunk->events[chunk->numEvents];
+        if( name )
+        {
+            size_t i = 0;
+            for( ; i < OGRE_TRACE_PROFILER_NAME_STR_LENGTH - 1u && name[i]; ++i )
+                event.name[i] = name[i];
+            event.name[i] = '\0';
+            event.timestampNs = getTimestampNs();
+        }
+        else
+        {
+            event.name[0] = '\0';
+            event.timestampNs = timestampNs;
+        }
+
+        ++chunk->numEvents;
+    }
+    //-----------------------------------------------------------------------------------
+    void TraceProfiler::setEnabled( bool bEnabled )
+    {
+        mEnabled = bEnabled;
+    }
+    //-----------------------------------------------------------------------------------
+    void TraceProfiler::setCurrentThreadName( const char *name )
+    {
+        PerThreadData *perThreadData = getPerThreadData();
+
+        const size_t nameLength = strlen( name );
+        if( nameLength < sizeof( perThreadData->threadName ) )
+            memcpy( perThreadData->threadName, name, nameLength + 1u );
+    }
+    //-----------------------------------------------------------------------------------
+    void TraceProfiler::beginEvent( const char *name, uint32 groupId )
+    {
+        PerThreadData *perThreadData = getPerThreadData();
+
+        const bool bRecord = mEnabled && (groupId & mProfileGroupMask);
+        if( bRecord )
+        {
+            addEvent( perThreadData, name[0] ? name : "(unnamed)" );
+            if( perThreadData->stackDepth < 64u )
+                perThreadData->recordedMask |= uint64( 1ul ) << perThreadData->stackDepth;
+        }
+        else if( perThreadData->stackDepth < 64u )
+        {
+            perThreadData->recordedMask &= ~(uint64( 1ul ) << perThreadData->stackDepth);
+        }
+
+        ++perThreadData->stackDepth;
+    }
+    //-----------------------------------------------------------------------------------
+    void TraceProfiler::endEvent(void)
+    {
+        PerThreadData *perThreadData = getPerThreadData();
+
+        OGRE_ASSERT_LOW( perThreadData->stackDepth > 0u &&
+                         "Called TraceProfiler::endEvent more times than beginEvent!" );
+        --perThreadData->stackDepth;
+
+        bool bRecorded = mEnabled;
+        if( perThreadData->stackDepth < 64u )
+            bRecorded = (perThreadData->recordedMask & (uint64( 1ul ) << perThreadData->stackDepth)) != 0;
+
+        if( bRecorded )
+            addEvent( perThreadData, 0 );
+    }
+    //-----------------------------------------------------------------------------------
+    void TraceProfiler::reset(void)
+    {
+        mMutex.lock();
+
+        PerThreadDataArray::const_iterator itor = mThreadData.begin();
+        PerThreadDataArray::const_iterator end  = mThreadData.end();
+
+        while( itor != end )
+        {
+            //Events that are still open will have their end event discarded
+            //by dumpChromeTraceStr (an end with no begin)
+            destroyChunks( *itor );
+            ++itor;
+        }
+
+        mMutex.unlock();
+    }
+    //-----------------------------------------------------------------------------------
+    static void appendJsonString( String &outJson, const char *str )
+    {
+        outJson += '"';
+        for( ; *str; ++str )
+        {
+            const char c = *str;
+            if( c == '"' || c == '\\' )
+            {
+                outJson += '\\';
+                outJson += c;
+            }
+            else if( static_cast<unsigned char>( c ) < 0x20u )
+            {
+                outJson += ' ';
+            }
+            else
+            {
+                outJson += c;
+            }
+        }
+        outJson += '"';
+    }
+    //-----------------------------------------------------------------------------------
+    void TraceProfiler::dumpChromeTraceStr( String &outJson ) const
+    {
+        const_cast<LightweightMutex&>( mMutex ).lock();
+
+        String json;
+        json.reserve( 1024u * 1024u );
+        json += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+        //Chrome timestamps are in microseconds. Make them relative to the
+        //first event so they fit comfortably with 3 decimals.
+        uint64 firstTimestampNs = std::numeric_limits<uint64>::max();
+        {
+            PerThreadDataArray::const_iterator itor = mThreadData.begin();
+            PerThreadDataArray::const_iterator end  = mThreadData.end();
+            while( itor != end )
+            {
+                const EventChunk *chunk = (*itor)->firstChunk;
+                if( chunk && chunk->numEvents )
+                    firstTimestampNs = std::min( firstTimestampNs, chunk->events[0].timestampNs );
+                ++itor;
+            }
+        }
+
+        const uint64 nowNs = getTimestampNs();
+        if( firstTimestampNs == std::numeric_limits<uint64>::max() )
+            firstTimestampNs = nowNs;
+
+        char tmpBuffer[128];
+        LwString tmpStr( LwString::FromEmptyPointer( tmpBuffer, sizeof( tmpBuffer ) ) );
+
+        bool firstEntry = true;
+
+        PerThreadDataArray::const_iterator itor = mThreadData.begin();
+        PerThreadDataArray::const_iterator end  = mThreadData.end();
+
+        while( itor != end )
+        {
+            const PerThreadData *perThreadData = *itor;
+
+            //Thread name metadata
+            if( !firstEntry )
+                json += ",\n";
+            firstEntry = false;
+            tmpStr.clear();
+            tmpStr.a( "{\"ph\":\"M\",\"pid\":0,\"tid\":", perThreadData->threadId,
+                      ",\"name\":\"thread_name\",\"args\":{\"name\":" );
+            json += tmpStr.c_str();
+            appendJsonString( json, perThreadData->threadName );
+            json += "}}";
+
+            uint32 depth = 0;
+
+            const EventChunk *chunk = perThreadData->firstChunk;
+            while( chunk )
+            {
+                for( size_t i=0; i<chunk->numEvents; ++i )
+                {
+                    const Event &event = chunk->events[i];
+                    const bool isBegin = event.name[0] != '\0';
+
+                    //Ends whose begin got discarded by reset()
+                    if( !isBegin && !depth )
+                        continue;
+
+                    depth = isBegin ? (depth + 1u) : (depth - 1u);
+
+                    const uint64 relativeNs = event.timestampNs - firstTimestampNs;
+
+                    json += ",\n";
+                    tmpStr.clear();
+                    tmpStr.a( "{\"ph\":\"", isBegin ? "B" : "E", "\",\"pid\":0,\"tid\":",
+                              perThreadData->threadId, ",\"ts\":" );
+                    tmpStr.a( static_cast<uint64>( relativeNs / 1000u ), "." );
+                    const uint32 fraction = static_cast<uint32>( relativeNs % 1000u );
+                    if( fraction < 100u )
+                        tmpStr.a( "0" );
+                    if( fraction < 10u )
+                        tmpStr.a( "0" );
+                    tmpStr.a( fraction );
+                    json += tmpStr.c_str();
+
+                    if( isBegin )
+                    {
+                        json += ",\"name\":";
+                        appendJsonString( json, event.name );
+                    }
+                    json += "}";
+                }
+
+                chunk = chunk->next;
+            }
+
+            //Close the events that are still open (i.e. we're being
+            //called from inside a profiled scope) so the trace is balanced.
+            while( depth )
+            {
+                const uint64 relativeNs = nowNs - firstTimestampNs;
+                json += ",\n";
+                tmpStr.clear();
+                tmpStr.a( "{\"ph\":\"E\",\"pid\":0,\"tid\":", perThreadData->threadId,
+                          ",\"ts\":", static_cast<uint64>( relativeNs / 1000u ), "}" );
+                json += tmpStr.c_str();
+                --depth;
+            }
+
+            ++itor;
+        }
+
+        json += "\n]}\n";
+
+        const_cast<LightweightMutex&>( mMutex ).unlock();
+
+        outJson.swap( json );
+    }
+    //-----------------------------------------------------------------------------------
+    void TraceProfiler::dumpChromeTrace( const String &fullPath ) const
+    {
+        String json;
+        dumpChromeTraceStr( json );
+
+        std::ofstream outFile( fullPath.c_str(), std::ios::binary | std::ios::out );
+        outFile.write( json.c_str(), static_cast<std::streamsize>( json.size() ) );
+        outFile.close();
+    }
+    //-----------------------------------------------------------------------------------
+    void TraceProfiler::setDumpPathOnShutdown( const String &fullPath )
+    {
+        mOnShutdownPath = fullPath;
+    }
+}
@@ -0,0 +1,75 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreUniformScalableTask.h"
+
+namespace Ogre
+{
+    struct UniformScalableTaskThreadParams
+    {
+        UniformScalableTask *task;
+        size_t              numThreads;
+    };
+    //-----------------------------------------------------------------------------------
+    unsigned long uniformScalableTaskThread( ThreadHandle *threadHandle )
+    {
+        UniformScalableTaskThreadParams *params =
+                reinterpret_cast<UniformScalableTaskThreadParams*>( threadHandle->getUserParam() );
+        params->task->execute( threadHandle->getThreadIdx(), params->numThreads );
+        return 0;
+    }
+    THREAD_DECLARE( uniformScalableTaskThread );
+    //-----------------------------------------------------------------------------------
+    void Threads::ExecuteUniformScalableTask( UniformScalableTask *task, size_t numThreads )
+    {
+        if( numThreads < 2u )
+        {
+            task->execute( 0, 1u );
+            return;
+        }
+
+        UniformScalableTaskThreadParams params;
+        params.task         = task;
+        params.numThreads   = numThreads;
+
+        ThreadHandleVec threadHandles;
+        threadHandles.reserve( numThreads - 1u );
+        for( size_t i=1; i<numThreads; ++i )
+        {
+            threadHandles.push_back( Threads::CreateThread( THREAD_GET( uniformScalableTaskThread ),
+                                                            i, &params ) );
+        }
+
+        task->execute( 0, numThreads );
+
+        Threads::WaitForThreads( threadHandles );
+    }
+}
@@ -82,6 +82,9 @@ namespace Ogre {
 
         /** See ParticleAffector. */
         void _affectParticles(ParticleSystem* pSystem, Real timeElapsed);
+        /** See ParticleAffector. */
+        void _affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                               size_t numParticles, Real timeElapsed );
 
         /** Sets the colour adjustment to be made per second to particles. 
         @param red, green, blue, alpha
@@ -56,6 +56,9 @@ namespace Ogre {
 
         /** See ParticleAffector. */
         void _affectParticles(ParticleSystem* pSystem, Real timeElapsed);
+        /** See ParticleAffector. */
+        void _affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                               size_t numParticles, Real timeElapsed );
 
         void setImageAdjust(String name);
         String getImageAdjust(void) const;
@@ -72,6 +72,9 @@ namespace Ogre {
 
         /** See ParticleAffector. */
         void _affectParticles(ParticleSystem* pSystem, Real timeElapsed);
+        /** See ParticleAffector. */
+        void _affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                               size_t numParticles, Real timeElapsed );
 
         void setColourAdjust(size_t index, ColourValue colour);
         ColourValue getColourAdjust(size_t index) const;
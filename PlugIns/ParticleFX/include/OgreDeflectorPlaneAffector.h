@@ -75,6 +75,9 @@ namespace Ogre {
 
         /** See ParticleAffector. */
         void _affectParticles(ParticleSystem* pSystem, Real timeElapsed);
+        /** See ParticleAffector. */
+        void _affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                               size_t numParticles, Real timeElapsed );
 
         /** Sets the plane point of the deflector plane. */
         void setPlanePoint(const Vector3& pos);
@@ -69,8 +69,13 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void ColourFaderAffector::_affectParticles(ParticleSystem* pSystem, Real timeElapsed)
     {
-        ParticleIterator pi = pSystem->_getIterator();
-        Particle *p;
+        _affectParticles( pSystem, pSystem->_getActiveParticles(), pSystem->getNumParticles(),
+                          timeElapsed );
+    }
+    //-----------------------------------------------------------------------
+    void ColourFaderAffector::_affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                                                size_t numParticles, Real timeElapsed )
+    {
         float dr, dg, db, da;
 
         // Scale adjustments by time
@@ -79,9 +84,9 @@ namespace Ogre {
         db = mBlueAdj * timeElapsed;
         da = mAlphaAdj * timeElapsed;
 
-        while (!pi.end())
+        for( size_t i=0; i<numParticles; ++i )
         {
-            p = pi.getNext();
+            Particle *p = particles[i];
             applyAdjustWithClamp(&p->mColour.r, dr);
             applyAdjustWithClamp(&p->mColour.g, dg);
             applyAdjustWithClamp(&p->mColour.b, db);
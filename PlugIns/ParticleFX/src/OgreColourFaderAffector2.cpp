@@ -100,8 +100,13 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void ColourFaderAffector2::_affectParticles(ParticleSystem* pSystem, Real timeElapsed)
     {
-        ParticleIterator pi = pSystem->_getIterator();
-        Particle *p;
+        _affectParticles( pSystem, pSystem->_getActiveParticles(), pSystem->getNumParticles(),
+                          timeElapsed );
+    }
+    //-----------------------------------------------------------------------
+    void ColourFaderAffector2::_affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                                                 size_t numParticles, Real timeElapsed )
+    {
         float dr1, dg1, db1, da1;
         float dr2, dg2, db2, da2;
 
@@ -117,9 +122,9 @@ namespace Ogre {
         db2 = mBlueAdj2  * timeElapsed;
         da2 = mAlphaAdj2 * timeElapsed;
 
-        while (!pi.end())
+        for( size_t i=0; i<numParticles; ++i )
         {
-            p = pi.getNext();
+            Particle *p = particles[i];
 
             if( p->mTimeToLive > StateChangeVal )
             {
@@ -65,19 +65,26 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void ColourImageAffector::_affectParticles(ParticleSystem* pSystem, Real timeElapsed)
     {
-        Particle*           p;
-        ParticleIterator    pi              = pSystem->_getIterator();
-
+        _affectParticles( pSystem, pSystem->_getActiveParticles(), pSystem->getNumParticles(),
+                          timeElapsed );
+    }
+    //-----------------------------------------------------------------------
+    void ColourImageAffector::_affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                                                size_t numParticles, Real timeElapsed )
+    {
         if (!mColourImageLoaded)
         {
             _loadImage();
         }
 
         int                width            = (int)mColourImage.getWidth()  - 1;
-        
-        while (!pi.end())
+
+        const ColourValue firstColour = mColourImage.getColourAt(0, 0, 0);
+        const ColourValue lastColour  = mColourImage.getColourAt(width, 0, 0);
+
+        for( size_t i=0; i<numParticles; ++i )
         {
-            p = pi.getNext();
+            Particle *p = particles[i];
             const Real      life_time       = p->mTotalTimeToLive;
             Real            particle_time   = 1.0f - (p->mTimeToLive / life_time);
 
@@ -91,11 +98,11 @@ namespace Ogre {
 
             if(index < 0)
             {
-                p->mColour = mColourImage.getColourAt(0, 0, 0);
+                p->mColour = firstColour;
             }
             else if(index >= width) 
             {
-                p->mColour = mColourImage.getColourAt(width, 0, 0);
+                p->mColour = lastColour;
             }
             else
             {
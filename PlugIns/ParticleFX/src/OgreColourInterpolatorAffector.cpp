@@ -76,13 +76,16 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void ColourInterpolatorAffector::_affectParticles(ParticleSystem* pSystem, Real timeElapsed)
     {
-        Particle*           p;
-        ParticleIterator    pi              = pSystem->_getIterator();
-
-
-        while (!pi.end())
+        _affectParticles( pSystem, pSystem->_getActiveParticles(), pSystem->getNumParticles(),
+                          timeElapsed );
+    }
+    //-----------------------------------------------------------------------
+    void ColourInterpolatorAffector::_affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                                                       size_t numParticles, Real timeElapsed )
+    {
+        for( size_t j=0; j<numParticles; ++j )
         {
-            p = pi.getNext();
+            Particle *p = particles[j];
             const Real      life_time       = p->mTotalTimeToLive;
             Real            particle_time   = 1.0f - (p->mTimeToLive / life_time);
 
@@ -63,16 +63,21 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     void DeflectorPlaneAffector::_affectParticles(ParticleSystem* pSystem, Real timeElapsed)
+    {
+        _affectParticles( pSystem, pSystem->_getActiveParticles(), pSystem->getNumParticles(),
+                          timeElapsed );
+    }
+    //-----------------------------------------------------------------------
+    void DeflectorPlaneAffector::_affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                                                   size_t numParticles, Real timeElapsed )
     {
         // precalculate distance of plane from origin
         Real planeDistance = - mPlaneNormal.dotProduct(mPlanePoint) / Math::Sqrt(mPlaneNormal.dotProduct(mPlaneNormal));
         Vector3 directionPart;
 
-        ParticleIterator pi = pSystem->_getIterator();
-
-        while (!pi.end())
+        for( size_t i=0; i<numParticles; ++i )
         {
-            Particle *p = pi.getNext();
+            Particle *p = particles[i];
 
             Vector3 direction(p->mDirection * timeElapsed);
             if (mPlaneNormal.dotProduct(p->mPosition + direction) + planeDistance <= 0.0)
@@ -69,14 +69,19 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void DirectionRandomiserAffector::_affectParticles(ParticleSystem* pSystem, Real timeElapsed)
     {
-        ParticleIterator pi = pSystem->_getIterator();
-        Particle *p;
+        _affectParticles( pSystem, pSystem->_getActiveParticles(), pSystem->getNumParticles(),
+                          timeElapsed );
+    }
+    //-----------------------------------------------------------------------
+    void DirectionRandomiserAffector::_affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                                                        size_t numParticles, Real timeElapsed )
+    {
         Real length = 0;
 
-        while (!pi.end())
+        for( size_t i=0; i<numParticles; ++i )
         {
-            p = pi.getNext();
-            if (mScope > Math::UnitRandom())
+            Particle *p = particles[i];
+            if (mScope > mParent->_getUnitRandom())
             {
                 if (!p->mDirection.isZeroLength())
                 {
@@ -85,9 +90,9 @@ namespace Ogre {
                         length = p->mDirection.length();
                     }
 
-                    p->mDirection += Vector3(Math::RangeRandom(-mRandomness, mRandomness) * timeElapsed,
-                        Math::RangeRandom(-mRandomness, mRandomness) * timeElapsed,
-                        Math::RangeRandom(-mRandomness, mRandomness) * timeElapsed);
+                    p->mDirection += Vector3(mParent->_getRangeRandom(-mRandomness, mRandomness) * timeElapsed,
+                        mParent->_getRangeRandom(-mRandomness, mRandomness) * timeElapsed,
+                        mParent->_getRangeRandom(-mRandomness, mRandomness) * timeElapsed);
 
                     if (mKeepVelocity)
                     {
@@ -68,31 +68,28 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void LinearForceAffector::_affectParticles(ParticleSystem* pSystem, Real timeElapsed)
     {
-        ParticleIterator pi = pSystem->_getIterator();
-        Particle *p;
-
-        Vector3 scaledVector = Vector3::ZERO;
-
-        // Precalc scaled force for optimisation
+        _affectParticles( pSystem, pSystem->_getActiveParticles(), pSystem->getNumParticles(),
+                          timeElapsed );
+    }
+    //-----------------------------------------------------------------------
+    void LinearForceAffector::_affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                                                size_t numParticles, Real timeElapsed )
+    {
         if (mForceApplication == FA_ADD)
         {
-            // Scale force by time
-            scaledVector = mForceVector * timeElapsed;
-        }
+            // Precalc scaled force for optimisation
+            const Vector3 scaledVector = mForceVector * timeElapsed;
 
-        while (!pi.end())
+            for( size_t i=0; i<numParticles; ++i )
+                particles[i]->mDirection += scaledVector;
+        }
+        else // FA_AVERAGE
         {
-            p = pi.getNext();
-            if (mForceApplication == FA_ADD)
-            {
-                p->mDirection += scaledVector;
-            }
-            else // FA_AVERAGE
-            {
-                p->mDirection = (p->mDirection + mForceVector) / 2;
-            }
+            const Vector3 halfForce = mForceVector * 0.5f;
+
+            for( size_t i=0; i<numParticles; ++i )
+                particles[i]->mDirection = particles[i]->mDirection * 0.5f + halfForce;
         }
-        
     }
     //-----------------------------------------------------------------------
     void LinearForceAffector::setForceVector(const Vector3& force)
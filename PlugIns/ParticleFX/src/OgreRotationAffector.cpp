@@ -77,34 +77,37 @@ namespace Ogre {
     {
         pParticle->setRotation(
             mRotationRangeStart + 
-            (Math::UnitRandom() * 
+            (mParent->_getUnitRandom() * 
                 (mRotationRangeEnd - mRotationRangeStart)));
         pParticle->mRotationSpeed =
             mRotationSpeedRangeStart + 
-            (Math::UnitRandom() * 
+            (mParent->_getUnitRandom() * 
                 (mRotationSpeedRangeEnd - mRotationSpeedRangeStart));
         
     }
     //-----------------------------------------------------------------------
     void RotationAffector::_affectParticles(ParticleSystem* pSystem, Real timeElapsed)
     {
-        ParticleIterator pi = pSystem->_getIterator();
-        Particle *p;
-        Real ds;
-
-        // Rotation adjustments by time
-        ds = timeElapsed;
-
-        Radian NewRotation;
+        _affectParticles( pSystem, pSystem->_getActiveParticles(), pSystem->getNumParticles(),
+                          timeElapsed );
+    }
+    //-----------------------------------------------------------------------
+    void RotationAffector::_affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                                             size_t numParticles, Real timeElapsed )
+    {
+        bool anyRotated = false;
 
-        while (!pi.end())
+        for( size_t i=0; i<numParticles; ++i )
         {
-            p = pi.getNext();
+            Particle *p = particles[i];
 
-            NewRotation = p->mRotation + (ds * p->mRotationSpeed);
-            p->setRotation( NewRotation );
+            p->mRotation += timeElapsed * p->mRotationSpeed;
+            anyRotated |= p->mRotation != Radian( 0 );
         }
 
+        // Same as Particle::setRotation, but notified once for the whole batch
+        if( anyRotated )
+            pSystem->_notifyParticleRotated();
     }
     //-----------------------------------------------------------------------
     const Radian& RotationAffector::getRotationSpeedRangeStart(void) const
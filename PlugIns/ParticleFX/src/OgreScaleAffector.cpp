@@ -56,33 +56,44 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void ScaleAffector::_affectParticles(ParticleSystem* pSystem, Real timeElapsed)
     {
-        ParticleIterator pi = pSystem->_getIterator();
-        Particle *p;
-        Real ds;
+        _affectParticles( pSystem, pSystem->_getActiveParticles(), pSystem->getNumParticles(),
+                          timeElapsed );
+    }
+    //-----------------------------------------------------------------------
+    void ScaleAffector::_affectParticles( ParticleSystem *pSystem, Particle * const *particles,
+                                          size_t numParticles, Real timeElapsed )
+    {
+        if( !numParticles )
+            return;
 
         // Scale adjustments by time
-        ds = mScaleAdj * timeElapsed;
+        const Real ds = mScaleAdj * timeElapsed;
 
-        Real NewWide, NewHigh;
+        const Real defaultWidth  = pSystem->getDefaultWidth() + ds;
+        const Real defaultHeight = pSystem->getDefaultHeight() + ds;
 
-        while (!pi.end())
+        for( size_t i=0; i<numParticles; ++i )
         {
-            p = pi.getNext();
+            Particle *p = particles[i];
 
             if( p->hasOwnDimensions() == false )
             {
-                NewWide = pSystem->getDefaultWidth() + ds;
-                NewHigh = pSystem->getDefaultHeight() + ds;
-
+                p->mWidth  = defaultWidth;
+                p->mHeight = defaultHeight;
             }
             else
             {
-                NewWide = p->getOwnWidth()  + ds;
-                NewHigh = p->getOwnHeight() + ds;
+                p->mWidth  += ds;
+                p->mHeight += ds;
             }
-            p->setDimensions( NewWide, NewHigh ); 
+            p->mOwnDimensions = true;
+
+            assert( p->mWidth >= 0 && p->mHeight >= 0 &&
+                    "Particle dimensions can not be negative" );
         }
 
+        // Same as Particle::setDimensions, but notified once for the whole batch
+        pSystem->_notifyParticleResized();
     }
     //-----------------------------------------------------------------------
     void ScaleAffector::setAdjust( Real rate )
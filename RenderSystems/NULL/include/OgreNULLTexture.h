@@ -41,8 +41,11 @@ namespace Ogre
     class NULLTexture : public Texture
     {
     protected:
-        virtual void createInternalResourcesImpl(void) {}
-        virtual void freeInternalResourcesImpl(void) {}
+        /// What we would've allocated. @see NULLTextureManager::getAllocatedBytes
+        size_t mAllocatedBytes;
+
+        virtual void createInternalResourcesImpl(void);
+        virtual void freeInternalResourcesImpl(void);
 
         /// Resource overloads
         virtual void loadImpl() {}
@@ -50,8 +53,14 @@ namespace Ogre
     public:
         NULLTexture( ResourceManager* creator, const String& name, ResourceHandle handle,
                      const String& group, bool isManual, ManualResourceLoader* loader ) :
-            Texture(creator, name, handle, group, isManual, loader)
+            Texture(creator, name, handle, group, isManual, loader),
+            mAllocatedBytes( 0 )
+        {
+        }
+
+        virtual ~NULLTexture()
         {
+            freeInternalResources();
         }
 
         virtual v1::HardwarePixelBufferSharedPtr getBuffer(size_t face, size_t mipmap)
@@ -36,6 +36,9 @@ namespace Ogre
     class NULLTextureManager : public TextureManager
     {
     protected:
+        size_t mAllocatedBytes;
+        size_t mPeakAllocatedBytes;
+
         /// @copydoc ResourceManager::createImpl
         virtual Resource* createImpl(const String& name, ResourceHandle handle,
             const String& group, bool isManual, ManualResourceLoader* loader,
@@ -52,6 +55,22 @@ namespace Ogre
         virtual bool isHardwareFilteringSupported( TextureType ttype, PixelFormat format,
                                                    int usage,
                                                    bool preciseFormatOnly = false );
+
+        /** Returns the amount of memory, in bytes, the textures currently alive would
+            be taking in a real RenderSystem (including mipmaps and MSAA surfaces).
+            Nothing is actually allocated; this is useful for testing memory usage
+            (i.e. of compositor workspaces) headless.
+        */
+        size_t getAllocatedBytes(void) const                { return mAllocatedBytes; }
+
+        /// Returns the highest value getAllocatedBytes has reached. @see resetPeakAllocatedBytes
+        size_t getPeakAllocatedBytes(void) const            { return mPeakAllocatedBytes; }
+
+        /// Sets the peak to the current value of getAllocatedBytes.
+        void resetPeakAllocatedBytes(void)                  { mPeakAllocatedBytes = mAllocatedBytes; }
+
+        void _notifyTextureAllocated( size_t bytes );
+        void _notifyTextureFreed( size_t bytes );
     };
 }
 
@@ -32,7 +32,9 @@ Copyright (c) 2000-2014 Torus Knot Software Ltd
 namespace Ogre 
 {
     NULLTextureManager::NULLTextureManager() :
-        TextureManager()
+        TextureManager(),
+        mAllocatedBytes( 0 ),
+        mPeakAllocatedBytes( 0 )
     {
         ResourceGroupManager::getSingleton()._registerResourceManager(mResourceType, this);
     }
@@ -60,4 +62,41 @@ namespace Ogre
     {
         return true;
     }
+
+    void NULLTextureManager::_notifyTextureAllocated( size_t bytes )
+    {
+        mAllocatedBytes += bytes;
+        mPeakAllocatedBytes = std::max( mPeakAllocatedBytes, mAllocatedBytes );
+    }
+
+    void NULLTextureManager::_notifyTextureFreed( size_t bytes )
+    {
+        assert( mAllocatedBytes >= bytes );
+        mAllocatedBytes -= bytes;
+    }
+
+    void NULLTexture::createInternalResourcesImpl(void)
+    {
+        uint32 depth  = 1u;
+        uint32 slices = 1u;
+        if( mTextureType == TEX_TYPE_3D )
+            depth = mDepth;
+        else
+            slices = std::max<uint32>( mDepth, static_cast<uint32>( getNumFaces() ) );
+
+        const uint8 numMipmaps = static_cast<uint8>(
+                    std::min<uint32>( mNumMipmaps + 1u, 255u ) );
+
+        mAllocatedBytes = PixelUtil::calculateSizeBytes( mWidth, mHeight, depth, slices,
+                                                         mFormat, numMipmaps ) *
+                          std::max( 1u, mFSAA );
+
+        static_cast<NULLTextureManager*>( mCreator )->_notifyTextureAllocated( mAllocatedBytes );
+    }
+
+    void NULLTexture::freeInternalResourcesImpl(void)
+    {
+        static_cast<NULLTextureManager*>( mCreator )->_notifyTextureFreed( mAllocatedBytes );
+        mAllocatedBytes = 0;
+    }
 }
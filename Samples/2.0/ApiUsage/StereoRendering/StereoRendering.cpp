@@ -98,6 +98,10 @@ namespace Demo
                                                                  vpOffsetScale,
                                                                  vpModifierMask,
                                                                  executionMask);
+
+            //Both eyes see almost the same objects. Cull them together.
+            compositorManager->setMultiViewCulling( true );
+
             return mEyeWorkspaces[0];
         }
 
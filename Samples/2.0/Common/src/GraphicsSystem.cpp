@@ -291,6 +291,10 @@ namespace Demo
                     mWriteAccessFolder + "ProfilePerFrame",
                     mWriteAccessFolder + "ProfileAccum" );
     #endif
+    #if OGRE_PROFILING == OGRE_PROFILING_TRACE
+        Ogre::Profiler::getSingleton().getTraceProfiler().setDumpPathOnShutdown(
+                    mWriteAccessFolder + "ProfileTrace.json" );
+    #endif
 #endif
     }
     //-----------------------------------------------------------------------------------
@@ -7,6 +7,7 @@
 #include "OgreShaderParams.h"
 
 #include "Terra/TerrainCell.h"
+#include "Terra/TerraPageCache.h"
 
 namespace Ogre
 {
@@ -57,18 +58,55 @@ namespace Ogre
         CompositorManager2      *m_compositorManager;
         Camera                  *m_camera;
 
+        /// Paged mode only (see loadPaged). Null otherwise.
+        TerraPageCache      *m_pageCache;
+        String              m_pageFilename;
+        /// Window of the whole world that is currently loaded in the GPU, in texels.
+        GridPoint           m_windowOrigin;
+        GridPoint           m_windowSize;
+        /// Window we want to switch to once all of its pages are resident.
+        GridPoint           m_nextWindowOrigin;
+        /// Origin & dimensions of the whole paged world.
+        Vector3             m_worldOrigin;
+        Vector2             m_worldXZDimensions;
+
         void destroyHeightmapTexture(void);
 
         /// Creates the Ogre texture based on the image data.
         /// Called by @see createHeightmap
-        void createHeightmapTexture( const Ogre::Image &image, const String &imageName );
+        /// Returns true if the existing texture had the same size & format and was reused.
+        bool createHeightmapTexture( const Ogre::Image &image, const String &imageName );
 
         /// Calls createHeightmapTexture, loads image data to our CPU-side buffers
         void createHeightmap( Image &image, const String &imageName );
+        /// Second half of createHeightmap. Uploads the image & updates everything that
+        /// depends on it. m_heightMap must already contain the image's heights.
+        void setHeightmap( Image &image, const String &imageName );
 
         void createNormalTexture(void);
         void destroyNormalTexture(void);
 
+        /// Initializes the TerrainCells needed to cover the current heightmap.
+        void createTerrainCells(void);
+
+        /// Returns the page-aligned window origin (in world texels) centered around
+        /// the given position, clamped to the world bounds.
+        GridPoint calculateWindowOrigin( const Vector3 &vPos ) const;
+        /// Requests the pages covering the given window plus one page of margin,
+        /// closest to the camera first.
+        void requestWindowPages( const GridPoint &windowOrigin, const Vector3 &camPos );
+        bool isWindowResident( const GridPoint &windowOrigin ) const;
+        /// Asks the page cache to assemble the window in its background thread.
+        /// The result is applied in a later updatePaging.
+        void requestWindow( const GridPoint &windowOrigin );
+        /// Switches to a window assembled by the page cache. Only uploads it to
+        /// the GPU; the heavy lifting was done in the background.
+        void applyWindow( TerraPageCache::Window &window );
+        /// Decides whether the window needs to move & streams the pages in.
+        void updatePaging( const Vector3 &camPos );
+        /// getHeightAt for positions outside the current window, in paged mode.
+        bool getPagedHeightAt( Vector3 &vPos ) const;
+
         ///	Automatically calculates the optimum skirt size (no gaps with
         /// lowest overdraw possible).
         ///	This is done by taking the heighest delta between two adjacent
@@ -113,8 +151,34 @@ namespace Ogre
         void load( const String &texName, const Vector3 center, const Vector3 &dimensions );
         void load( Image &image, const Vector3 center, const Vector3 &dimensions, const String &imageName = BLANKSTRING );
 
+        /** Loads a terrain that is too big to be kept in memory (see TerraPageCache).
+            Only a window of windowSize x windowSize texels around the camera is
+            rendered; it follows the camera as it moves, and the pages it needs are
+            streamed from disk in the background.
+        @remarks
+            The window only moves once all of its pages have been loaded; until then
+            the previous window keeps being rendered. Terrain outside the window
+            isn't rendered.
+        @param pageFilename
+            Page file created with TerraPageCache::createPageFile.
+        @param center
+            Center of the whole world.
+        @param dimensions
+            Dimensions of the whole world.
+        @param windowSize
+            Size of the rendered window, in texels. Should be a multiple of the page size.
+        @param memoryBudget
+            Maximum amount of memory, in bytes, for cached pages. Pages in use by the
+            current window are never evicted, so it should be at least big enough to
+            hold the window plus one page of margin around it.
+        */
+        void loadPaged( const String &pageFilename, const Vector3 center,
+                        const Vector3 &dimensions, uint32 windowSize, size_t memoryBudget );
+
         /** Gets the interpolated height at the given location.
             If outside the bounds, it leaves the height untouched.
+            In paged mode, positions outside the current window are looked up in
+            the page cache; and the height is left untouched if the page isn't resident.
         @param vPos
             [in] XZ position, Y for default height.
             [out] Y height, or default Y (from input) if outside terrain bounds.
@@ -123,6 +187,9 @@ namespace Ogre
         */
         bool getHeightAt( Vector3 &vPos ) const;
 
+        /// Null unless loaded via loadPaged.
+        TerraPageCache* getPageCache(void) const        { return m_pageCache; }
+
         /// load must already have been called.
         void setDatablock( HlmsDatablock *datablock );
 
@@ -0,0 +1,255 @@
+
+#ifndef _OgreTerraPageCache_H_
+#define _OgreTerraPageCache_H_
+
+#include "OgrePrerequisites.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreWaitableEvent.h"
+
+#include <algorithm>
+#include <deque>
+#include <iosfwd>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace Ogre
+{
+    /** Heightmap split in square pages of pageSize x pageSize texels, stored in a
+        page file (see createPageFile), which are streamed from disk by a background
+        thread as they are requested, and kept in memory in a LRU cache.
+    @remarks
+        All functions must be called from the main thread. Only the file reads
+        and the assembly of windows (see requestWindow) happen in the background.
+        The background thread is created on first use and sleeps while there's
+        no work, until the cache is destroyed.
+    @par
+        The page file is little endian regardless of the platform: a header of
+        five uint32 (magic, version, width, depth, pageSize) followed by the
+        pages, row by row, each one with pageSize * pageSize uint16 heights.
+    @par
+        Pages requested in the current frame are never evicted. Pages that weren't
+        requested in a while are evicted (least recently used first) once the
+        memory budget is exceeded.
+    */
+    class TerraPageCache
+    {
+    public:
+        struct PageFileHeader
+        {
+            uint32  magic;
+            uint32  version;
+            uint32  width;
+            uint32  depth;
+            uint32  pageSize;
+        };
+
+        /// Rectangle of the world assembled from the resident pages. See requestWindow.
+        struct Window
+        {
+            uint32  originX;
+            uint32  originZ;
+            uint32  width;
+            uint32  depth;
+            /// Normalized heights in range [0; 65535]. width * depth texels.
+            std::vector<uint16> data;
+            /// Same as data, in range [0; 1] multiplied by the heightScale
+            /// that was passed to requestWindow.
+            std::vector<float>  heights;
+
+            Window() : originX( 0 ), originZ( 0 ), width( 0 ), depth( 0 ) {}
+
+            /// Swaps without copying the heights.
+            void swap( Window &other )
+            {
+                std::swap( originX, other.originX );
+                std::swap( originZ, other.originZ );
+                std::swap( width, other.width );
+                std::swap( depth, other.depth );
+                data.swap( other.data );
+                heights.swap( other.heights );
+            }
+        };
+
+    private:
+        struct Page
+        {
+            /// Normalized heights in range [0; 65535]. pageSize * pageSize texels.
+            uint16  *data;
+            uint32  lastUsedFrame;
+        };
+
+        typedef std::map<uint32, Page> PageMap;
+
+        /// Page that has been loaded by the background thread.
+        struct LoadedPage
+        {
+            uint32  pageKey;
+            uint16  *data;
+        };
+
+        /// Window for the background thread to assemble.
+        struct WindowRequest
+        {
+            Window  window;
+            float   heightScale;
+            /// Pages covering the window, starting at page (firstPageX, firstPageZ).
+            uint32  firstPageX;
+            uint32  firstPageZ;
+            uint32  numPagesX;
+            std::vector<const uint16*> pages;
+
+            WindowRequest() : heightScale( 1.0f ), firstPageX( 0 ), firstPageZ( 0 ), numPagesX( 0 ) {}
+
+            void swap( WindowRequest &other )
+            {
+                window.swap( other.window );
+                std::swap( heightScale, other.heightScale );
+                std::swap( firstPageX, other.firstPageX );
+                std::swap( firstPageZ, other.firstPageZ );
+                std::swap( numPagesX, other.numPagesX );
+                pages.swap( other.pages );
+            }
+        };
+
+        String                  m_filename;
+        PageFileHeader          m_header;
+        uint32                  m_numPagesX;
+        uint32                  m_numPagesZ;
+
+        size_t                  m_memoryBudget;
+        size_t                  m_memoryUsed;
+        uint32                  m_frameCount;
+
+        /// Main thread only
+        PageMap                 m_residentPages;
+        /// Pages that were sent to the loader and haven't come back yet. Main thread only.
+        std::set<uint32>        m_pagesInFlight;
+        /// Pages being read by the background thread to assemble a window.
+        /// They can't be evicted. Main thread only.
+        std::set<uint32>        m_pinnedPages;
+        /// True from requestWindow until the window is collected. Main thread only.
+        bool                    m_windowInFlight;
+
+        /// Protects m_loadQueue, m_loadedPages, the windows & m_stopLoader
+        LightweightMutex        m_mutex;
+        std::deque<uint32>      m_loadQueue;
+        std::vector<LoadedPage> m_loadedPages;
+        bool                    m_windowPending;
+        WindowRequest           m_pendingWindow;
+        bool                    m_windowBuilt;
+        Window                  m_builtWindow;
+        bool                    m_stopLoader;
+        ThreadHandlePtr         m_loaderThread;
+        /// The background thread sleeps on it while there's no work.
+        WaitableEvent           m_workEvent;
+        /// Woken up every time a page or window is ready.
+        WaitableEvent           m_loadedEvent;
+
+        size_t getPageSizeBytes(void) const;
+
+        /// Creates the background thread if it doesn't exist yet, and wakes it up.
+        void wakeLoaderThread(void);
+        void stopLoaderThread(void);
+        /// Reads a page from the file. Called from the background thread.
+        void loadPage( std::istream &file, uint32 pageKey, uint16 *outData ) const;
+        /// Copies the pages into the window. Called from the background thread.
+        static void assembleWindow( WindowRequest &request, uint32 pageSize );
+        /// Moves the pages loaded by the background thread to m_residentPages.
+        void collectLoadedPages(void);
+        void evictPages(void);
+
+    public:
+        static const uint32 c_pageFileMagic;
+        static const uint32 c_pageFileVersion;
+
+        /**
+        @param filename
+            Path to the page file. Opened directly from disk (not through the
+            ResourceGroupManager) since it's read from a background thread.
+        @param memoryBudget
+            Maximum amount of memory, in bytes, for resident pages.
+        */
+        TerraPageCache( const String &filename, size_t memoryBudget );
+        ~TerraPageCache();
+
+        /** Splits a grayscale heightmap into pages and writes them to a page file.
+            Meant to be done offline, e.g. by a tool.
+        @param image
+            8 bpp, 16 bpp or 32-bit float heightmap. Float values must be in range [0; 1].
+        @param filename
+            Path to the file to write.
+        @param pageSize
+            Width and depth of each page, in texels.
+        */
+        static void createPageFile( const Image &image, const String &filename, uint32 pageSize );
+
+        /** Replaces the pending page requests with the given ones. Pages already
+            resident or being loaded are skipped, and pages no longer requested are
+            dropped from the queue. Marks all of them as used in this frame.
+        @param pageKeys
+            Pages to request, in order of priority. See getPageKey.
+        */
+        void requestPages( const std::vector<uint32> &pageKeys );
+
+        /// Must be called once per frame. Collects the pages that finished
+        /// loading & evicts pages over budget.
+        void update(void);
+
+        uint32 getPageKey( uint32 pageX, uint32 pageZ ) const   { return pageZ * m_numPagesX + pageX; }
+
+        /// Blocks until all requested pages have been loaded.
+        void waitForRequestedPages(void);
+
+        /** Assembles the given rectangle of the world from the resident pages in the
+            background thread, so that it's ready to be uploaded. Only one window can
+            be in flight at a time. Its pages won't be evicted until it's collected.
+        @remarks
+            All the pages covering the window must be resident. See isPageResident.
+        @param heightScale
+            Multiplies the heights in Window::heights.
+        @return
+            False if another window is still in flight, in which case nothing is done.
+        */
+        bool requestWindow( uint32 originX, uint32 originZ, uint32 width, uint32 depth,
+                            float heightScale );
+
+        /** Retrieves the window requested via requestWindow once it's been assembled.
+        @param outWindow
+            Receives the window. Its previous contents are lost.
+        @param bWait
+            When true, blocks until the window is ready.
+        @return
+            False if there's no window in flight, or it isn't ready and bWait is false.
+        */
+        bool collectWindow( Window &outWindow, bool bWait );
+
+        bool isWindowInFlight(void) const               { return m_windowInFlight; }
+
+        /// Returns the normalized heights of the page, or null if not resident.
+        const uint16* getPage( uint32 pageX, uint32 pageZ ) const;
+        bool isPageResident( uint32 pageKey ) const;
+
+        /** Returns the normalized height at the given texel.
+        @return
+            False if the page containing the texel isn't resident, or it's out of bounds.
+        */
+        bool getHeight( uint32 x, uint32 z, float &outHeight ) const;
+
+        void setMemoryBudget( size_t memoryBudget )     { m_memoryBudget = memoryBudget; }
+        size_t getMemoryBudget(void) const              { return m_memoryBudget; }
+        size_t getMemoryUsed(void) const                { return m_memoryUsed; }
+
+        uint32 getWidth(void) const                     { return m_header.width; }
+        uint32 getDepth(void) const                     { return m_header.depth; }
+        uint32 getPageSize(void) const                  { return m_header.pageSize; }
+        uint32 getNumPagesX(void) const                 { return m_numPagesX; }
+        uint32 getNumPagesZ(void) const                 { return m_numPagesZ; }
+
+        /// Internal use
+        void _loaderThreadMain(void);
+    };
+}
+
+#endif
@@ -37,8 +37,16 @@ namespace Ogre
         m_prevLightDir( Vector3::ZERO ),
         m_shadowMapper( 0 ),
         m_compositorManager( compositorManager ),
-        m_camera( camera )
+        m_camera( camera ),
+        m_pageCache( 0 ),
+        m_worldOrigin( Vector3::ZERO ),
+        m_worldXZDimensions( Vector2::UNIT_SCALE )
     {
+        m_windowOrigin.x = 0;
+        m_windowOrigin.z = 0;
+        m_windowSize.x = 0;
+        m_windowSize.z = 0;
+        m_nextWindowOrigin = m_windowOrigin;
     }
     //-----------------------------------------------------------------------------------
     Terra::~Terra()
@@ -52,6 +60,9 @@ namespace Ogre
         destroyNormalTexture();
         destroyHeightmapTexture();
         m_terrainCells.clear();
+
+        delete m_pageCache;
+        m_pageCache = 0;
     }
     //-----------------------------------------------------------------------------------
     void Terra::destroyHeightmapTexture(void)
@@ -64,10 +75,8 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
-    void Terra::createHeightmapTexture( const Ogre::Image &image, const String &imageName )
+    bool Terra::createHeightmapTexture( const Ogre::Image &image, const String &imageName )
     {
-        destroyHeightmapTexture();
-
         if( image.getBPP() != 8 && image.getBPP() != 16 && image.getFormat() != PF_FLOAT32_R )
         {
             OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
@@ -78,11 +87,24 @@ namespace Ogre
         //const uint8 numMipmaps = image.getNumMipmaps();
         const uint8 numMipmaps = 0u;
 
-        m_heightMapTex = TextureManager::getSingleton().createManual(
-                    "HeightMapTex" + StringConverter::toString( getId() ),
-                    Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
-                    TEX_TYPE_2D, (uint)image.getWidth(), (uint)image.getHeight(),
-                    numMipmaps, image.getFormat(), TU_STATIC_WRITE_ONLY );
+        //When paging, the window gets rebuilt with the same size over and over again.
+        //Reuse the texture so that everything referencing it (i.e. the shadow mapper,
+        //the compositor) remains valid.
+        const bool reuseTexture = !m_heightMapTex.isNull() &&
+                                  m_heightMapTex->getWidth() == image.getWidth() &&
+                                  m_heightMapTex->getHeight() == image.getHeight() &&
+                                  m_heightMapTex->getDesiredFormat() == image.getFormat();
+
+        if( !reuseTexture )
+        {
+            destroyHeightmapTexture();
+
+            m_heightMapTex = TextureManager::getSingleton().createManual(
+                        "HeightMapTex" + StringConverter::toString( getId() ),
+                        Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                        TEX_TYPE_2D, (uint)image.getWidth(), (uint)image.getHeight(),
+                        numMipmaps, image.getFormat(), TU_STATIC_WRITE_ONLY );
+        }
 
         for( uint8 mip=0; mip<=numMipmaps; ++mip )
         {
@@ -94,15 +116,14 @@ namespace Ogre
             PixelUtil::bulkPixelConversion( image.getPixelBox(0, mip), currImage );
             pixelBufferBuf->unlock();
         }
+
+        return reuseTexture;
     }
     //-----------------------------------------------------------------------------------
     void Terra::createHeightmap( Image &image, const String &imageName )
     {
         m_width = image.getWidth();
         m_depth = image.getHeight();
-        m_depthWidthRatio = m_depth / (float)(m_width);
-        m_invWidth = 1.0f / m_width;
-        m_invDepth = 1.0f / m_depth;
 
         if( PixelUtil::getComponentCount( image.getFormat() ) != 1 )
         {
@@ -113,8 +134,6 @@ namespace Ogre
 
         //image.generateMipmaps( false, Image::FILTER_NEAREST );
 
-        createHeightmapTexture( image, imageName );
-
         m_heightMap.resize( m_width * m_depth );
 
         const float maxValue = powf( 2.0f, (float)image.getBPP() ) - 1.0f;
@@ -149,31 +168,55 @@ namespace Ogre
             }
         }
 
+        setHeightmap( image, imageName );
+    }
+    //-----------------------------------------------------------------------------------
+    void Terra::setHeightmap( Image &image, const String &imageName )
+    {
+        m_width = image.getWidth();
+        m_depth = image.getHeight();
+        m_depthWidthRatio = m_depth / (float)(m_width);
+        m_invWidth = 1.0f / m_width;
+        m_invDepth = 1.0f / m_depth;
+
+        assert( m_heightMap.size() == m_width * m_depth );
+
+        const bool textureReused = createHeightmapTexture( image, imageName );
+
         m_xzRelativeSize = m_xzDimensions / Vector2( static_cast<Real>(m_width),
                                                      static_cast<Real>(m_depth) );
 
         createNormalTexture();
 
+        //Forces the shadow map to be updated in the next update
         m_prevLightDir = Vector3::ZERO;
 
-        delete m_shadowMapper;
-        m_shadowMapper = new ShadowMapper( mManager, m_compositorManager );
-        m_shadowMapper->createShadowMap( getId(), m_heightMapTex );
+        if( !textureReused || !m_shadowMapper )
+        {
+            delete m_shadowMapper;
+            m_shadowMapper = new ShadowMapper( mManager, m_compositorManager );
+            m_shadowMapper->createShadowMap( getId(), m_heightMapTex );
+        }
 
         calculateOptimumSkirtSize();
     }
     //-----------------------------------------------------------------------------------
     void Terra::createNormalTexture(void)
     {
-        destroyNormalTexture();
-
-        m_normalMapTex = TextureManager::getSingleton().createManual(
-                    "NormalMapTex_" + StringConverter::toString( getId() ),
-                    Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
-                    TEX_TYPE_2D, m_heightMapTex->getWidth(), m_heightMapTex->getHeight(),
-                    PixelUtil::getMaxMipmapCount( m_heightMapTex->getWidth(),
-                                                  m_heightMapTex->getHeight() ),
-                    PF_A2B10G10R10, TU_RENDERTARGET|TU_AUTOMIPMAP );
+        if( m_normalMapTex.isNull() ||
+            m_normalMapTex->getWidth() != m_heightMapTex->getWidth() ||
+            m_normalMapTex->getHeight() != m_heightMapTex->getHeight() )
+        {
+            destroyNormalTexture();
+
+            m_normalMapTex = TextureManager::getSingleton().createManual(
+                        "NormalMapTex_" + StringConverter::toString( getId() ),
+                        Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                        TEX_TYPE_2D, m_heightMapTex->getWidth(), m_heightMapTex->getHeight(),
+                        PixelUtil::getMaxMipmapCount( m_heightMapTex->getWidth(),
+                                                      m_heightMapTex->getHeight() ),
+                        PF_A2B10G10R10, TU_RENDERTARGET|TU_AUTOMIPMAP );
+        }
 
         MaterialPtr normalMapperMat = MaterialManager::getSingleton().load(
                     "Terra/GpuNormalMapper",
@@ -378,6 +421,9 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void Terra::update( const Vector3 &lightDir, float lightEpsilon )
     {
+        if( m_pageCache )
+            updatePaging( m_camera->getDerivedPosition() );
+
         const float lightCosAngleChange = Math::Clamp(
                     (float)m_prevLightDir.dotProduct( lightDir.normalisedCopy() ), -1.0f, 1.0f );
         if( lightCosAngleChange <= (1.0f - lightEpsilon) )
@@ -512,13 +558,20 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void Terra::load( Image &image, const Vector3 center, const Vector3 &dimensions, const String &imageName )
     {
+        delete m_pageCache;
+        m_pageCache = 0;
+
         m_terrainOrigin = center - dimensions * 0.5f;
         m_xzDimensions = Vector2( dimensions.x, dimensions.z );
         m_xzInvDimensions = 1.0f / m_xzDimensions;
         m_height = dimensions.y;
         m_basePixelDimension = 64u;
         createHeightmap( image, imageName );
-
+        createTerrainCells();
+    }
+    //-----------------------------------------------------------------------------------
+    void Terra::createTerrainCells(void)
+    {
         {
             //Find out how many TerrainCells we need. I think this might be
             //solved analitically with a power series. But my math is rusty.
@@ -602,10 +655,254 @@ namespace Ogre
             vPos.y = a * dx + b * dz + c + m_terrainOrigin.y;
             retVal = true;
         }
+        else if( m_pageCache )
+        {
+            retVal = getPagedHeightAt( vPos );
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    bool Terra::getPagedHeightAt( Vector3 &vPos ) const
+    {
+        const float fX = (vPos.x - m_worldOrigin.x) *
+                         (m_pageCache->getWidth() / m_worldXZDimensions.x);
+        const float fZ = (vPos.z - m_worldOrigin.z) *
+                         (m_pageCache->getDepth() / m_worldXZDimensions.y);
+
+        if( fX < 0.0f || fZ < 0.0f )
+            return false;
+
+        const uint32 x = static_cast<uint32>( fX );
+        const uint32 z = static_cast<uint32>( fZ );
+        const float dx = fX - static_cast<float>( x );
+        const float dz = fZ - static_cast<float>( z );
+
+        float h00, h11;
+        if( !m_pageCache->getHeight( x, z, h00 ) || !m_pageCache->getHeight( x + 1u, z + 1u, h11 ) )
+            return false;
+
+        //Same interpolation as getHeightAt. See there.
+        float a, b, c;
+        c = h00;
+        if( dx < dz )
+        {
+            float h01;
+            if( !m_pageCache->getHeight( x, z + 1u, h01 ) )
+                return false;
+
+            b = h01 - c;
+            a = h11 - b - c;
+        }
+        else
+        {
+            float h10;
+            if( !m_pageCache->getHeight( x + 1u, z, h10 ) )
+                return false;
+
+            a = h10 - c;
+            b = h11 - a - c;
+        }
+
+        vPos.y = (a * dx + b * dz + c) * m_height + m_worldOrigin.y;
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void Terra::loadPaged( const String &pageFilename, const Vector3 center,
+                           const Vector3 &dimensions, uint32 windowSize, size_t memoryBudget )
+    {
+        delete m_pageCache;
+        m_pageCache = 0;
+        m_pageCache = new TerraPageCache( pageFilename, memoryBudget );
+        m_pageFilename = pageFilename;
+
+        m_worldOrigin = center - dimensions * 0.5f;
+        m_worldXZDimensions = Vector2( dimensions.x, dimensions.z );
+        m_height = dimensions.y;
+        m_basePixelDimension = 64u;
+
+        m_windowSize.x = static_cast<int32>( std::min( windowSize, m_pageCache->getWidth() ) );
+        m_windowSize.z = static_cast<int32>( std::min( windowSize, m_pageCache->getDepth() ) );
+
+        const Vector2 texelSize = m_worldXZDimensions /
+                                  Vector2( static_cast<Real>( m_pageCache->getWidth() ),
+                                           static_cast<Real>( m_pageCache->getDepth() ) );
+        m_xzDimensions = Vector2( m_windowSize.x * texelSize.x, m_windowSize.z * texelSize.y );
+        m_xzInvDimensions = 1.0f / m_xzDimensions;
+        m_terrainOrigin = m_worldOrigin;
+
+        //The first window is loaded synchronously (i.e. while at the loading screen)
+        const Vector3 camPos = m_camera->getDerivedPosition();
+        const GridPoint windowOrigin = calculateWindowOrigin( camPos );
+        requestWindowPages( windowOrigin, camPos );
+        m_pageCache->waitForRequestedPages();
+
+        m_nextWindowOrigin = windowOrigin;
+        requestWindow( windowOrigin );
+
+        TerraPageCache::Window window;
+        m_pageCache->collectWindow( window, true );
+        applyWindow( window );
+        createTerrainCells();
+    }
+    //-----------------------------------------------------------------------------------
+    GridPoint Terra::calculateWindowOrigin( const Vector3 &vPos ) const
+    {
+        const int32 pageSize = static_cast<int32>( m_pageCache->getPageSize() );
+        const int32 worldWidth = static_cast<int32>( m_pageCache->getWidth() );
+        const int32 worldDepth = static_cast<int32>( m_pageCache->getDepth() );
+
+        const float fX = floorf( (vPos.x - m_worldOrigin.x) * (worldWidth / m_worldXZDimensions.x) );
+        const float fZ = floorf( (vPos.z - m_worldOrigin.z) * (worldDepth / m_worldXZDimensions.y) );
+
+        //Center around the camera, snapped to the page grid
+        const float fOriginX = (fX - m_windowSize.x / 2) / static_cast<float>( pageSize );
+        const float fOriginZ = (fZ - m_windowSize.z / 2) / static_cast<float>( pageSize );
+
+        GridPoint retVal;
+        retVal.x = static_cast<int32>( floorf( fOriginX + 0.5f ) ) * pageSize;
+        retVal.z = static_cast<int32>( floorf( fOriginZ + 0.5f ) ) * pageSize;
+        retVal.x = Math::Clamp( retVal.x, 0, worldWidth - m_windowSize.x );
+        retVal.z = Math::Clamp( retVal.z, 0, worldDepth - m_windowSize.z );
 
         return retVal;
     }
     //-----------------------------------------------------------------------------------
+    void Terra::requestWindowPages( const GridPoint &windowOrigin, const Vector3 &camPos )
+    {
+        const int32 pageSize = static_cast<int32>( m_pageCache->getPageSize() );
+        const int32 numPagesX = static_cast<int32>( m_pageCache->getNumPagesX() );
+        const int32 numPagesZ = static_cast<int32>( m_pageCache->getNumPagesZ() );
+
+        //Window plus one page of margin, so we're ready when the window moves
+        const int32 minX = std::max( windowOrigin.x / pageSize - 1, 0 );
+        const int32 minZ = std::max( windowOrigin.z / pageSize - 1, 0 );
+        const int32 maxX = std::min( (windowOrigin.x + m_windowSize.x - 1) / pageSize + 1,
+                                     numPagesX - 1 );
+        const int32 maxZ = std::min( (windowOrigin.z + m_windowSize.z - 1) / pageSize + 1,
+                                     numPagesZ - 1 );
+
+        const float camPageX = (camPos.x - m_worldOrigin.x) *
+                               (m_pageCache->getWidth() / m_worldXZDimensions.x) / pageSize;
+        const float camPageZ = (camPos.z - m_worldOrigin.z) *
+                               (m_pageCache->getDepth() / m_worldXZDimensions.y) / pageSize;
+
+        typedef std::vector< std::pair<float, uint32> > PageDistanceVec;
+        PageDistanceVec pagesByDistance;
+        pagesByDistance.reserve( (maxX - minX + 1) * (maxZ - minZ + 1) );
+
+        for( int32 z=minZ; z<=maxZ; ++z )
+        {
+            for( int32 x=minX; x<=maxX; ++x )
+            {
+                const float distX = (x + 0.5f) - camPageX;
+                const float distZ = (z + 0.5f) - camPageZ;
+                pagesByDistance.push_back( std::pair<float, uint32>(
+                                               distX * distX + distZ * distZ,
+                                               m_pageCache->getPageKey( x, z ) ) );
+            }
+        }
+
+        //Closest to the camera first
+        std::sort( pagesByDistance.begin(), pagesByDistance.end() );
+
+        std::vector<uint32> pageKeys;
+        pageKeys.reserve( pagesByDistance.size() );
+        PageDistanceVec::const_iterator itor = pagesByDistance.begin();
+        PageDistanceVec::const_iterator end  = pagesByDistance.end();
+        while( itor != end )
+        {
+            pageKeys.push_back( itor->second );
+            ++itor;
+        }
+
+        m_pageCache->requestPages( pageKeys );
+    }
+    //-----------------------------------------------------------------------------------
+    bool Terra::isWindowResident( const GridPoint &windowOrigin ) const
+    {
+        const int32 pageSize = static_cast<int32>( m_pageCache->getPageSize() );
+
+        const int32 minX = windowOrigin.x / pageSize;
+        const int32 minZ = windowOrigin.z / pageSize;
+        const int32 maxX = (windowOrigin.x + m_windowSize.x - 1) / pageSize;
+        const int32 maxZ = (windowOrigin.z + m_windowSize.z - 1) / pageSize;
+
+        for( int32 z=minZ; z<=maxZ; ++z )
+        {
+            for( int32 x=minX; x<=maxX; ++x )
+            {
+                if( !m_pageCache->isPageResident( m_pageCache->getPageKey( x, z ) ) )
+                    return false;
+            }
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void Terra::requestWindow( const GridPoint &windowOrigin )
+    {
+        m_pageCache->requestWindow( static_cast<uint32>( windowOrigin.x ),
+                                    static_cast<uint32>( windowOrigin.z ),
+                                    static_cast<uint32>( m_windowSize.x ),
+                                    static_cast<uint32>( m_windowSize.z ), m_height );
+    }
+    //-----------------------------------------------------------------------------------
+    void Terra::applyWindow( TerraPageCache::Window &window )
+    {
+        m_windowOrigin.x = static_cast<int32>( window.originX );
+        m_windowOrigin.z = static_cast<int32>( window.originZ );
+
+        const Vector2 texelSize = m_worldXZDimensions /
+                                  Vector2( static_cast<Real>( m_pageCache->getWidth() ),
+                                           static_cast<Real>( m_pageCache->getDepth() ) );
+        m_terrainOrigin.x = m_worldOrigin.x + window.originX * texelSize.x;
+        m_terrainOrigin.y = m_worldOrigin.y;
+        m_terrainOrigin.z = m_worldOrigin.z + window.originZ * texelSize.y;
+
+        //The heights were already converted in the background thread
+        m_heightMap.swap( window.heights );
+
+        Image image;
+        image.loadDynamicImage( reinterpret_cast<uchar*>( &window.data[0] ),
+                                window.width, window.depth, 1u, PF_L16, false );
+        setHeightmap( image, m_pageFilename );
+    }
+    //-----------------------------------------------------------------------------------
+    void Terra::updatePaging( const Vector3 &camPos )
+    {
+        const int32 pageSize = static_cast<int32>( m_pageCache->getPageSize() );
+
+        const int32 camX = static_cast<int32>( floorf( (camPos.x - m_worldOrigin.x) *
+                                                       (m_pageCache->getWidth() /
+                                                        m_worldXZDimensions.x) ) );
+        const int32 camZ = static_cast<int32>( floorf( (camPos.z - m_worldOrigin.z) *
+                                                       (m_pageCache->getDepth() /
+                                                        m_worldXZDimensions.y) ) );
+
+        //Hysteresis: Don't move the window until the camera is more than
+        //a page away from its center, to avoid rebuilding it back and forth.
+        const int32 distX = camX - (m_nextWindowOrigin.x + m_windowSize.x / 2);
+        const int32 distZ = camZ - (m_nextWindowOrigin.z + m_windowSize.z / 2);
+        if( std::abs( distX ) > pageSize || std::abs( distZ ) > pageSize )
+            m_nextWindowOrigin = calculateWindowOrigin( camPos );
+
+        requestWindowPages( m_nextWindowOrigin, camPos );
+        m_pageCache->update();
+
+        TerraPageCache::Window window;
+        if( m_pageCache->collectWindow( window, false ) )
+            applyWindow( window );
+
+        //Keep rendering the old window until the new one is fully loaded & assembled.
+        if( !m_pageCache->isWindowInFlight() &&
+            (m_nextWindowOrigin.x != m_windowOrigin.x || m_nextWindowOrigin.z != m_windowOrigin.z) &&
+            isWindowResident( m_nextWindowOrigin ) )
+        {
+            requestWindow( m_nextWindowOrigin );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void Terra::setDatablock( HlmsDatablock *datablock )
     {
         std::vector<TerrainCell>::iterator itor = m_terrainCells.begin();
@@ -0,0 +1,591 @@
+
+#include "Terra/TerraPageCache.h"
+
+#include "OgreImage.h"
+#include "OgreException.h"
+#include "OgreStringConverter.h"
+#include "OgreBitwise.h"
+
+#include <fstream>
+
+namespace Ogre
+{
+    const uint32 TerraPageCache::c_pageFileMagic    = 0x47505254; //'TRPG'
+    const uint32 TerraPageCache::c_pageFileVersion  = 2u;
+
+    /// Size of the header in the file. Not sizeof(PageFileHeader), which may be padded.
+    static const size_t c_pageFileHeaderSize = 5u * sizeof(uint32);
+
+    static void writeUint32LE( uint8 *dst, uint32 value )
+    {
+        dst[0] = static_cast<uint8>( value );
+        dst[1] = static_cast<uint8>( value >> 8u );
+        dst[2] = static_cast<uint8>( value >> 16u );
+        dst[3] = static_cast<uint8>( value >> 24u );
+    }
+
+    static uint32 readUint32LE( const uint8 *src )
+    {
+        return static_cast<uint32>( src[0] ) | (static_cast<uint32>( src[1] ) << 8u) |
+               (static_cast<uint32>( src[2] ) << 16u) | (static_cast<uint32>( src[3] ) << 24u);
+    }
+
+    unsigned long terraPageLoaderThread( ThreadHandle *threadHandle )
+    {
+        TerraPageCache *pageCache = reinterpret_cast<TerraPageCache*>( threadHandle->getUserParam() );
+        pageCache->_loaderThreadMain();
+        return 0;
+    }
+    THREAD_DECLARE( terraPageLoaderThread );
+    //-----------------------------------------------------------------------------------
+    TerraPageCache::TerraPageCache( const String &filename, size_t memoryBudget ) :
+        m_filename( filename ),
+        m_numPagesX( 0u ),
+        m_numPagesZ( 0u ),
+        m_memoryBudget( memoryBudget ),
+        m_memoryUsed( 0u ),
+        m_frameCount( 0u ),
+        m_windowInFlight( false ),
+        m_windowPending( false ),
+        m_windowBuilt( false ),
+        m_stopLoader( false )
+    {
+        memset( &m_header, 0, sizeof( m_header ) );
+
+        std::ifstream file( filename.c_str(), std::ios::in | std::ios::binary );
+        if( !file.is_open() )
+        {
+            OGRE_EXCEPT( Exception::ERR_FILE_NOT_FOUND,
+                         "Could not open Terra page file " + filename,
+                         "TerraPageCache::TerraPageCache" );
+        }
+
+        uint8 rawHeader[c_pageFileHeaderSize];
+        file.read( reinterpret_cast<char*>( rawHeader ), c_pageFileHeaderSize );
+
+        m_header.magic      = readUint32LE( rawHeader );
+        m_header.version    = readUint32LE( rawHeader + 4u );
+        m_header.width      = readUint32LE( rawHeader + 8u );
+        m_header.depth      = readUint32LE( rawHeader + 12u );
+        m_header.pageSize   = readUint32LE( rawHeader + 16u );
+
+        if( !file || m_header.magic != c_pageFileMagic || m_header.version != c_pageFileVersion ||
+            !m_header.pageSize || !m_header.width || !m_header.depth )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Invalid or unsupported Terra page file " + filename,
+                         "TerraPageCache::TerraPageCache" );
+        }
+
+        m_numPagesX = (m_header.width + m_header.pageSize - 1u) / m_header.pageSize;
+        m_numPagesZ = (m_header.depth + m_header.pageSize - 1u) / m_header.pageSize;
+    }
+    //-----------------------------------------------------------------------------------
+    TerraPageCache::~TerraPageCache()
+    {
+        stopLoaderThread();
+
+        std::vector<LoadedPage>::const_iterator itLoaded = m_loadedPages.begin();
+        std::vector<LoadedPage>::const_iterator enLoaded = m_loadedPages.end();
+        while( itLoaded != enLoaded )
+        {
+            OGRE_FREE( itLoaded->data, MEMCATEGORY_GENERAL );
+            ++itLoaded;
+        }
+        m_loadedPages.clear();
+
+        PageMap::const_iterator itor = m_residentPages.begin();
+        PageMap::const_iterator end  = m_residentPages.end();
+        while( itor != end )
+        {
+            OGRE_FREE( itor->second.data, MEMCATEGORY_GENERAL );
+            ++itor;
+        }
+        m_residentPages.clear();
+        m_memoryUsed = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t TerraPageCache::getPageSizeBytes(void) const
+    {
+        return m_header.pageSize * m_header.pageSize * sizeof(uint16);
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPageCache::createPageFile( const Image &image, const String &filename,
+                                         uint32 pageSize )
+    {
+        if( PixelUtil::getComponentCount( image.getFormat() ) != 1 ||
+            (image.getBPP() != 8 && image.getBPP() != 16 && image.getFormat() != PF_FLOAT32_R) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Heightmap must be grayscale 8 bpp, 16 bpp, or 32-bit Float",
+                         "TerraPageCache::createPageFile" );
+        }
+
+        if( !pageSize )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "pageSize can't be 0",
+                         "TerraPageCache::createPageFile" );
+        }
+
+        std::ofstream file( filename.c_str(), std::ios::out | std::ios::binary );
+        if( !file.is_open() )
+        {
+            OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE,
+                         "Could not open " + filename + " for writing",
+                         "TerraPageCache::createPageFile" );
+        }
+
+        PageFileHeader header;
+        header.magic    = c_pageFileMagic;
+        header.version  = c_pageFileVersion;
+        header.width    = static_cast<uint32>( image.getWidth() );
+        header.depth    = static_cast<uint32>( image.getHeight() );
+        header.pageSize = pageSize;
+
+        uint8 rawHeader[c_pageFileHeaderSize];
+        writeUint32LE( rawHeader, header.magic );
+        writeUint32LE( rawHeader + 4u, header.version );
+        writeUint32LE( rawHeader + 8u, header.width );
+        writeUint32LE( rawHeader + 12u, header.depth );
+        writeUint32LE( rawHeader + 16u, header.pageSize );
+        file.write( reinterpret_cast<const char*>( rawHeader ), c_pageFileHeaderSize );
+
+        const uint32 numPagesX = (header.width + pageSize - 1u) / pageSize;
+        const uint32 numPagesZ = (header.depth + pageSize - 1u) / pageSize;
+
+        const uint8 *imageData = image.getData();
+        const size_t bytesPerPixel = image.getBPP() >> 3u;
+
+        //Heights are stored little endian
+        std::vector<uint8> pageData( pageSize * pageSize * sizeof(uint16) );
+
+        for( uint32 pz=0; pz<numPagesZ; ++pz )
+        {
+            for( uint32 px=0; px<numPagesX; ++px )
+            {
+                //Pages at the edges are padded by replicating the last row / column.
+                for( uint32 z=0; z<pageSize; ++z )
+                {
+                    const uint32 srcZ = std::min( pz * pageSize + z, header.depth - 1u );
+                    for( uint32 x=0; x<pageSize; ++x )
+                    {
+                        const uint32 srcX = std::min( px * pageSize + x, header.width - 1u );
+                        const uint8 *src = imageData + (srcZ * header.width + srcX) * bytesPerPixel;
+
+                        uint16 value;
+                        if( image.getBPP() == 8 )
+                            value = static_cast<uint16>( *src * 257u );
+                        else if( image.getBPP() == 16 )
+                            value = *reinterpret_cast<const uint16*>( src );
+                        else
+                        {
+                            const float fValue = Math::saturate( *reinterpret_cast<const float*>( src ) );
+                            value = static_cast<uint16>( fValue * 65535.0f + 0.5f );
+                        }
+
+                        pageData[(z * pageSize + x) * 2u + 0u] = static_cast<uint8>( value );
+                        pageData[(z * pageSize + x) * 2u + 1u] = static_cast<uint8>( value >> 8u );
+                    }
+                }
+
+                file.write( reinterpret_cast<const char*>( &pageData[0] ),
+                            static_cast<std::streamsize>( pageData.size() ) );
+            }
+        }
+
+        if( !file )
+        {
+            OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE,
+                         "Error writing to " + filename,
+                         "TerraPageCache::createPageFile" );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPageCache::wakeLoaderThread(void)
+    {
+        if( m_loaderThread.isNull() )
+            m_loaderThread = Threads::CreateThread( THREAD_GET( terraPageLoaderThread ), 0, this );
+
+        m_workEvent.wake();
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPageCache::stopLoaderThread(void)
+    {
+        if( !m_loaderThread.isNull() )
+        {
+            m_mutex.lock();
+            m_stopLoader = true;
+            m_mutex.unlock();
+
+            m_workEvent.wake();
+            Threads::WaitForThreads( 1u, &m_loaderThread );
+            m_loaderThread.setNull();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPageCache::loadPage( std::istream &file, uint32 pageKey, uint16 *outData ) const
+    {
+        const size_t pageSizeBytes = getPageSizeBytes();
+
+        file.seekg( static_cast<std::streamoff>( c_pageFileHeaderSize +
+                                                 pageKey * pageSizeBytes ) );
+        file.read( reinterpret_cast<char*>( outData ),
+                   static_cast<std::streamsize>( pageSizeBytes ) );
+
+        if( !file )
+        {
+            //Truncated or unreadable file. Flatten the page rather
+            //than requesting it again forever.
+            memset( outData, 0, pageSizeBytes );
+            file.clear();
+        }
+#if OGRE_ENDIAN == OGRE_ENDIAN_BIG
+        else
+        {
+            Bitwise::bswapChunks( outData, sizeof(uint16), pageSizeBytes / sizeof(uint16) );
+        }
+#endif
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPageCache::assembleWindow( WindowRequest &request, uint32 pageSize )
+    {
+        Window &window = request.window;
+        window.data.resize( window.width * window.depth );
+        window.heights.resize( window.width * window.depth );
+
+        //Same conversion as Terra::createHeightmap does for 16 bpp images
+        const float invMaxValue = 1.0f / 65535.0f;
+
+        for( uint32 z=0; z<window.depth; ++z )
+        {
+            const uint32 worldZ = window.originZ + z;
+            const uint32 pageZ = worldZ / pageSize - request.firstPageZ;
+            const uint32 rowInPage = worldZ % pageSize;
+
+            uint32 x = 0;
+            while( x < window.width )
+            {
+                //Copy the whole span of this row that falls inside the page
+                const uint32 worldX = window.originX + x;
+                const uint32 colInPage = worldX % pageSize;
+                const uint32 count = std::min( pageSize - colInPage, window.width - x );
+
+                const uint16 *pageData = request.pages[pageZ * request.numPagesX +
+                                                       worldX / pageSize - request.firstPageX];
+
+                memcpy( &window.data[z * window.width + x],
+                        pageData + rowInPage * pageSize + colInPage, count * sizeof(uint16) );
+                x += count;
+            }
+
+            for( x=0; x<window.width; ++x )
+            {
+                const size_t idx = z * window.width + x;
+                window.heights[idx] = (window.data[idx] * invMaxValue) * request.heightScale;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPageCache::_loaderThreadMain(void)
+    {
+        std::ifstream file( m_filename.c_str(), std::ios::in | std::ios::binary );
+
+        const size_t pageSizeBytes = getPageSizeBytes();
+
+        WindowRequest windowRequest;
+
+        bool finished = false;
+        while( !finished )
+        {
+            bool hasWindow = false;
+            bool hasPage = false;
+            uint32 pageKey = 0;
+
+            m_mutex.lock();
+            finished = m_stopLoader;
+            if( !finished )
+            {
+                //Windows first. Their pages are already resident, so they're quick
+                //and they're what the main thread is waiting for.
+                if( m_windowPending )
+                {
+                    windowRequest.swap( m_pendingWindow );
+                    m_windowPending = false;
+                    hasWindow = true;
+                }
+                else if( !m_loadQueue.empty() )
+                {
+                    pageKey = m_loadQueue.front();
+                    m_loadQueue.pop_front();
+                    hasPage = true;
+                }
+            }
+            m_mutex.unlock();
+
+            if( hasWindow )
+            {
+                assembleWindow( windowRequest, m_header.pageSize );
+
+                m_mutex.lock();
+                m_builtWindow.swap( windowRequest.window );
+                m_windowBuilt = true;
+                m_mutex.unlock();
+
+                m_loadedEvent.wake();
+            }
+            else if( hasPage )
+            {
+                LoadedPage loadedPage;
+                loadedPage.pageKey  = pageKey;
+                loadedPage.data     = reinterpret_cast<uint16*>(
+                                          OGRE_MALLOC( pageSizeBytes, MEMCATEGORY_GENERAL ) );
+                loadPage( file, pageKey, loadedPage.data );
+
+                m_mutex.lock();
+                m_loadedPages.push_back( loadedPage );
+                m_mutex.unlock();
+
+                m_loadedEvent.wake();
+            }
+            else if( !finished )
+            {
+                m_workEvent.wait();
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPageCache::collectLoadedPages(void)
+    {
+        std::vector<LoadedPage> loadedPages;
+
+        m_mutex.lock();
+        loadedPages.swap( m_loadedPages );
+        m_mutex.unlock();
+
+        const size_t pageSizeBytes = getPageSizeBytes();
+
+        std::vector<LoadedPage>::const_iterator itor = loadedPages.begin();
+        std::vector<LoadedPage>::const_iterator end  = loadedPages.end();
+
+        while( itor != end )
+        {
+            m_pagesInFlight.erase( itor->pageKey );
+
+            Page page;
+            page.data           = itor->data;
+            page.lastUsedFrame  = m_frameCount;
+            m_residentPages[itor->pageKey] = page;
+            m_memoryUsed += pageSizeBytes;
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPageCache::evictPages(void)
+    {
+        if( m_memoryUsed <= m_memoryBudget )
+            return;
+
+        typedef std::vector< std::pair<uint32, uint32> > LastUsedVec;
+        LastUsedVec candidates;
+        candidates.reserve( m_residentPages.size() );
+
+        PageMap::const_iterator itor = m_residentPages.begin();
+        PageMap::const_iterator end  = m_residentPages.end();
+        while( itor != end )
+        {
+            //Pages used in the current frame, or being copied to a window, are never evicted.
+            if( itor->second.lastUsedFrame != m_frameCount &&
+                m_pinnedPages.find( itor->first ) == m_pinnedPages.end() )
+                candidates.push_back( std::pair<uint32, uint32>( itor->second.lastUsedFrame, itor->first ) );
+            ++itor;
+        }
+
+        //Least recently used first
+        std::sort( candidates.begin(), candidates.end() );
+
+        const size_t pageSizeBytes = getPageSizeBytes();
+
+        LastUsedVec::const_iterator itCandidate = candidates.begin();
+        LastUsedVec::const_iterator enCandidate = candidates.end();
+        while( m_memoryUsed > m_memoryBudget && itCandidate != enCandidate )
+        {
+            PageMap::iterator itPage = m_residentPages.find( itCandidate->second );
+            OGRE_FREE( itPage->second.data, MEMCATEGORY_GENERAL );
+            m_residentPages.erase( itPage );
+            m_memoryUsed -= pageSizeBytes;
+            ++itCandidate;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPageCache::requestPages( const std::vector<uint32> &pageKeys )
+    {
+        m_mutex.lock();
+
+        //Pages the loader hasn't picked up yet are no longer in flight.
+        std::deque<uint32>::const_iterator itQueue = m_loadQueue.begin();
+        std::deque<uint32>::const_iterator enQueue = m_loadQueue.end();
+        while( itQueue != enQueue )
+            m_pagesInFlight.erase( *itQueue++ );
+        m_loadQueue.clear();
+
+        std::vector<uint32>::const_iterator itor = pageKeys.begin();
+        std::vector<uint32>::const_iterator end  = pageKeys.end();
+
+        while( itor != end )
+        {
+            const uint32 pageKey = *itor;
+            assert( pageKey < m_numPagesX * m_numPagesZ );
+
+            PageMap::iterator itPage = m_residentPages.find( pageKey );
+            if( itPage != m_residentPages.end() )
+            {
+                itPage->second.lastUsedFrame = m_frameCount;
+            }
+            else if( m_pagesInFlight.find( pageKey ) == m_pagesInFlight.end() )
+            {
+                m_pagesInFlight.insert( pageKey );
+                m_loadQueue.push_back( pageKey );
+            }
+
+            ++itor;
+        }
+
+        const bool hasWork = !m_loadQueue.empty();
+
+        m_mutex.unlock();
+
+        if( hasWork )
+            wakeLoaderThread();
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPageCache::update(void)
+    {
+        collectLoadedPages();
+        evictPages();
+
+        ++m_frameCount;
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPageCache::waitForRequestedPages(void)
+    {
+        collectLoadedPages();
+
+        while( !m_pagesInFlight.empty() )
+        {
+            m_loadedEvent.wait();
+            collectLoadedPages();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool TerraPageCache::requestWindow( uint32 originX, uint32 originZ, uint32 width, uint32 depth,
+                                        float heightScale )
+    {
+        if( m_windowInFlight )
+            return false;
+
+        assert( width && depth && originX + width <= m_header.width &&
+                originZ + depth <= m_header.depth );
+
+        const uint32 pageSize = m_header.pageSize;
+
+        WindowRequest request;
+        request.window.originX  = originX;
+        request.window.originZ  = originZ;
+        request.window.width    = width;
+        request.window.depth    = depth;
+        request.heightScale     = heightScale;
+        request.firstPageX      = originX / pageSize;
+        request.firstPageZ      = originZ / pageSize;
+        request.numPagesX       = (originX + width - 1u) / pageSize - request.firstPageX + 1u;
+
+        const uint32 lastPageZ = (originZ + depth - 1u) / pageSize;
+        request.pages.reserve( request.numPagesX * (lastPageZ - request.firstPageZ + 1u) );
+
+        for( uint32 z=request.firstPageZ; z<=lastPageZ; ++z )
+        {
+            for( uint32 x=request.firstPageX; x<request.firstPageX + request.numPagesX; ++x )
+            {
+                const uint32 pageKey = getPageKey( x, z );
+                PageMap::const_iterator itor = m_residentPages.find( pageKey );
+                assert( itor != m_residentPages.end() && "Window must be resident!" );
+                request.pages.push_back( itor->second.data );
+                m_pinnedPages.insert( pageKey );
+            }
+        }
+
+        m_mutex.lock();
+        m_pendingWindow.swap( request );
+        m_windowPending = true;
+        m_mutex.unlock();
+
+        m_windowInFlight = true;
+        wakeLoaderThread();
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    bool TerraPageCache::collectWindow( Window &outWindow, bool bWait )
+    {
+        if( !m_windowInFlight )
+            return false;
+
+        bool windowBuilt = false;
+        do
+        {
+            m_mutex.lock();
+            windowBuilt = m_windowBuilt;
+            if( windowBuilt )
+            {
+                outWindow.swap( m_builtWindow );
+                m_windowBuilt = false;
+            }
+            m_mutex.unlock();
+
+            if( !windowBuilt && bWait )
+                m_loadedEvent.wait();
+        }
+        while( !windowBuilt && bWait );
+
+        if( windowBuilt )
+        {
+            m_pinnedPages.clear();
+            m_windowInFlight = false;
+        }
+
+        return windowBuilt;
+    }
+    //-----------------------------------------------------------------------------------
+    const uint16* TerraPageCache::getPage( uint32 pageX, uint32 pageZ ) const
+    {
+        const uint16 *retVal = 0;
+
+        if( pageX < m_numPagesX && pageZ < m_numPagesZ )
+        {
+            PageMap::const_iterator itor = m_residentPages.find( getPageKey( pageX, pageZ ) );
+            if( itor != m_residentPages.end() )
+                retVal = itor->second.data;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    bool TerraPageCache::isPageResident( uint32 pageKey ) const
+    {
+        return m_residentPages.find( pageKey ) != m_residentPages.end();
+    }
+    //-----------------------------------------------------------------------------------
+    bool TerraPageCache::getHeight( uint32 x, uint32 z, float &outHeight ) const
+    {
+        const uint32 pageSize = m_header.pageSize;
+        const uint16 *pageData = getPage( x / pageSize, z / pageSize );
+
+        if( pageData && x < m_header.width && z < m_header.depth )
+        {
+            outHeight = pageData[(z % pageSize) * pageSize + (x % pageSize)] * (1.0f / 65535.0f);
+            return true;
+        }
+
+        return false;
+    }
+}
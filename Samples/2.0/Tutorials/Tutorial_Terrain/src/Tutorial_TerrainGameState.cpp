@@ -132,6 +132,12 @@ namespace Demo
         mTerra->load( "Heightmap.png", Ogre::Vector3( 64.0f, 4096.0f * 0.5f, 64.0f ), Ogre::Vector3( 4096.0f, 4096.0f, 4096.0f ) );
         //mTerra->load( "Heightmap.png", Ogre::Vector3( 64.0f, 4096.0f * 0.5f, 64.0f ), Ogre::Vector3( 14096.0f, 14096.0f, 14096.0f ) );
 
+        //Paged terrain: Create the page file once (offline), then stream a 1024x1024
+        //window around the camera, keeping at most 64MB of pages in memory:
+        //Ogre::TerraPageCache::createPageFile( hugeHeightmapImage, "Heightmap.terrapages", 256u );
+        //mTerra->loadPaged( "Heightmap.terrapages", Ogre::Vector3( 64.0f, 4096.0f * 0.5f, 64.0f ),
+        //                   Ogre::Vector3( 16384.0f, 4096.0f, 16384.0f ), 1024u, 64u * 1024u * 1024u );
+
         Ogre::SceneNode *rootNode = sceneManager->getRootSceneNode( Ogre::SCENE_STATIC );
         Ogre::SceneNode *sceneNode = rootNode->createChildSceneNode( Ogre::SCENE_STATIC );
         sceneNode->attachObject( mTerra );
@@ -0,0 +1,64 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __InstantRadiosityTests_H__
+#define __InstantRadiosityTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+
+using namespace Ogre; 
+
+class InstantRadiosityTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(InstantRadiosityTests);
+    CPPUNIT_TEST(testRaycastHitsNearestLayer);
+    CPPUNIT_TEST(testUpdateLightMatchesBuild);
+    CPPUNIT_TEST_SUITE_END();
+
+    Root            *mRoot;
+    RenderSystem    *mRenderSystem;
+
+    /// Creates a SceneManager with the given number of worker threads, and
+    /// two stacked grids facing up.
+    SceneManager* createScene( size_t numThreads );
+    /// Creates a white spot light pointing down.
+    Light* createSpotLight( SceneManager *sceneManager, const Vector3 &position );
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testRaycastHitsNearestLayer();
+    void testUpdateLightMatchesBuild();
+};
+
+#endif
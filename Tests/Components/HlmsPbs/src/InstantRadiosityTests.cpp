@@ -0,0 +1,344 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "InstantRadiosityTests.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreItem.h"
+#include "OgreLight.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlmsPbs.h"
+#include "OgreNULLRenderSystem.h"
+#include "Vao/OgreVaoManager.h"
+#include "InstantRadiosity/OgreInstantRadiosity.h"
+
+#include "UnitTestSuite.h"
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(InstantRadiosityTests);
+
+namespace
+{
+    /// Cells per side of each layer of the grid mesh
+    const uint16 c_gridCells = 16u;
+    /// Height of the layer that's farther from the light
+    const Real c_lowerLayerHeight = -2.0f;
+
+    struct VplInfo
+    {
+        Vector3     position;
+        ColourValue diffuse;
+
+        bool operator < ( const VplInfo &other ) const
+        {
+            if( position.x != other.position.x )
+                return position.x < other.position.x;
+            if( position.y != other.position.y )
+                return position.y < other.position.y;
+            return position.z < other.position.z;
+        }
+    };
+    typedef vector<VplInfo>::type VplInfoVec;
+
+    /// Returns the VPL lights created by InstantRadiosity, sorted by position.
+    void getVpls( SceneManager *sceneManager, VplInfoVec &outVpls )
+    {
+        outVpls.clear();
+
+        SceneManager::MovableObjectIterator itor =
+                sceneManager->getMovableObjectIterator( LightFactory::FACTORY_TYPE_NAME );
+        while( itor.hasMoreElements() )
+        {
+            Light *light = static_cast<Light*>( itor.getNext() );
+            if( light->getType() == Light::LT_VPL )
+            {
+                VplInfo vpl;
+                vpl.position    = light->getParentSceneNode()->getPosition();
+                vpl.diffuse     = light->getDiffuseColour();
+                outVpls.push_back( vpl );
+            }
+        }
+
+        std::sort( outVpls.begin(), outVpls.end() );
+    }
+
+    void configure( InstantRadiosity &instantRadiosity )
+    {
+        instantRadiosity.mNumRays = 512u;
+        instantRadiosity.mNumRayBounces = 0;
+        //Keep the VPLs exactly where the rays hit, instead of at the cell centres
+        //or pulled back towards the light.
+        instantRadiosity.mBias = 1.0f;
+        instantRadiosity.mNumSpreadIterations = 0;
+        instantRadiosity.mVplThreshold = 0;
+        instantRadiosity.setUseTextures( false );
+    }
+
+    /// Creates a mesh made of two horizontal grids (at y = 0 and y = c_lowerLayerHeight)
+    /// facing up. The lower grid goes first in the index buffer.
+    MeshPtr createTwoLayerMesh( VaoManager *vaoManager )
+    {
+        const uint16 numVertsPerSide    = c_gridCells + 1u;
+        const uint16 numVertsPerLayer   = numVertsPerSide * numVertsPerSide;
+        const size_t numVertices        = numVertsPerLayer * 2u;
+        const size_t numIndices         = c_gridCells * c_gridCells * 6u * 2u;
+        const Real halfSize             = c_gridCells * 0.5f;
+
+        float *vertices = reinterpret_cast<float*>(
+                    OGRE_MALLOC_SIMD( numVertices * 6u * sizeof(float), MEMCATEGORY_GEOMETRY ) );
+        uint16 *indices = reinterpret_cast<uint16*>(
+                    OGRE_MALLOC_SIMD( numIndices * sizeof(uint16), MEMCATEGORY_GEOMETRY ) );
+
+        float *vertex = vertices;
+        uint16 *index = indices;
+        for( uint16 layer=0; layer<2u; ++layer )
+        {
+            const float height = layer == 0 ? c_lowerLayerHeight : 0.0f;
+
+            for( uint16 z=0; z<numVertsPerSide; ++z )
+            {
+                for( uint16 x=0; x<numVertsPerSide; ++x )
+                {
+                    *vertex++ = x - halfSize;
+                    *vertex++ = height;
+                    *vertex++ = z - halfSize;
+                    *vertex++ = 0.0f;
+                    *vertex++ = 1.0f;
+                    *vertex++ = 0.0f;
+                }
+            }
+
+            const uint16 layerStart = layer * numVertsPerLayer;
+            for( uint16 z=0; z<c_gridCells; ++z )
+            {
+                for( uint16 x=0; x<c_gridCells; ++x )
+                {
+                    const uint16 v00 = layerStart + z * numVertsPerSide + x;
+                    const uint16 v10 = v00 + 1u;
+                    const uint16 v01 = v00 + numVertsPerSide;
+                    const uint16 v11 = v01 + 1u;
+
+                    //Counter clockwise when seen from above
+                    *index++ = v00;
+                    *index++ = v01;
+                    *index++ = v10;
+                    *index++ = v10;
+                    *index++ = v01;
+                    *index++ = v11;
+                }
+            }
+        }
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+
+        VertexBufferPacked *vertexBuffer = vaoManager->createVertexBuffer(
+                    vertexElements, numVertices, BT_IMMUTABLE, vertices, false );
+        IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+                    IndexBufferPacked::IT_16BIT, numIndices, BT_IMMUTABLE, indices, false );
+        OGRE_FREE_SIMD( vertices, MEMCATEGORY_GEOMETRY );
+        OGRE_FREE_SIMD( indices, MEMCATEGORY_GEOMETRY );
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( vertexBuffer );
+        VertexArrayObject *vao = vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                                      OT_TRIANGLE_LIST );
+
+        MeshPtr mesh = MeshManager::getSingleton().createManual(
+                    "InstantRadiosityTwoLayers", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+        SubMesh *subMesh = mesh->createSubMesh();
+        subMesh->mVao[VpNormal].push_back( vao );
+        subMesh->mVao[VpShadow].push_back( vao );
+
+        const Aabb bounds = Aabb::newFromExtents(
+                    Vector3( -halfSize, c_lowerLayerHeight, -halfSize ),
+                    Vector3( halfSize, 0, halfSize ) );
+        mesh->_setBounds( bounds, false );
+        mesh->_setBoundingSphereRadius( bounds.getRadius() );
+
+        return mesh;
+    }
+}
+
+//--------------------------------------------------------------------------
+void InstantRadiosityTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root( BLANKSTRING, BLANKSTRING );
+    mRenderSystem = OGRE_NEW NULLRenderSystem();
+    mRoot->addRenderSystem( mRenderSystem );
+    mRoot->setRenderSystem( mRenderSystem );
+    mRoot->initialise( true );
+
+    HlmsPbs *hlmsPbs = OGRE_NEW HlmsPbs( 0, 0 );
+    mRoot->getHlmsManager()->registerHlms( hlmsPbs );
+    hlmsPbs->createDatablock( "InstantRadiosityTests", "InstantRadiosityTests",
+                              HlmsMacroblock(), HlmsBlendblock(), HlmsParamVec() );
+
+    createTwoLayerMesh( mRenderSystem->getVaoManager() );
+}
+//--------------------------------------------------------------------------
+void InstantRadiosityTests::tearDown()
+{
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+    OGRE_DELETE mRenderSystem;
+    mRenderSystem = 0;
+}
+//--------------------------------------------------------------------------
+SceneManager* InstantRadiosityTests::createScene( size_t numThreads )
+{
+    SceneManager *sceneManager = mRoot->createSceneManager( ST_GENERIC, numThreads,
+                                                            INSTANCING_CULLING_SINGLETHREAD );
+
+    Item *item = sceneManager->createItem( "InstantRadiosityTwoLayers",
+                                           ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                                           SCENE_DYNAMIC );
+    item->setDatablock( "InstantRadiosityTests" );
+    sceneManager->getRootSceneNode()->createChildSceneNode()->attachObject( item );
+
+    return sceneManager;
+}
+//--------------------------------------------------------------------------
+Light* InstantRadiosityTests::createSpotLight( SceneManager *sceneManager,
+                                               const Vector3 &position )
+{
+    Light *light = sceneManager->createLight();
+    SceneNode *lightNode = sceneManager->getRootSceneNode()->createChildSceneNode();
+    lightNode->attachObject( light );
+    lightNode->setPosition( position );
+    light->setType( Light::LT_SPOTLIGHT );
+    light->setDirection( Vector3::NEGATIVE_UNIT_Y );
+    light->setDiffuseColour( ColourValue::White );
+    light->setSpotlightOuterAngle( Degree( 60.0f ) );
+
+    return light;
+}
+//--------------------------------------------------------------------------
+void InstantRadiosityTests::testRaycastHitsNearestLayer()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    //The RNG uses a fixed seed and each ray is only written by one thread,
+    //thus splitting the work must not change the output at all.
+    VplInfoVec vplsPerThreadCount[2];
+    const size_t c_numThreads[2] = { 1u, 4u };
+
+    for( size_t i=0; i<2u; ++i )
+    {
+        SceneManager *sceneManager = createScene( c_numThreads[i] );
+        createSpotLight( sceneManager, Vector3( 0.5f, 10.0f, -0.25f ) );
+
+        InstantRadiosity instantRadiosity( sceneManager, mRoot->getHlmsManager() );
+        configure( instantRadiosity );
+        instantRadiosity.build();
+        getVpls( sceneManager, vplsPerThreadCount[i] );
+        instantRadiosity.clear();
+        instantRadiosity.freeMemory();
+
+        mRoot->destroySceneManager( sceneManager );
+    }
+
+    //Every ray goes through both layers. If the BVH traversal skipped the nearest hit
+    //(or a tie), some VPLs would end up on the lower layer.
+    const VplInfoVec &vpls = vplsPerThreadCount[0];
+    CPPUNIT_ASSERT( !vpls.empty() );
+    for( size_t i=0; i<vpls.size(); ++i )
+    {
+        CPPUNIT_ASSERT( Math::Abs( vpls[i].position.y ) < 1e-3f );
+        CPPUNIT_ASSERT( Math::Abs( vpls[i].position.x ) <= c_gridCells * 0.5f );
+        CPPUNIT_ASSERT( Math::Abs( vpls[i].position.z ) <= c_gridCells * 0.5f );
+    }
+
+    const VplInfoVec &vplsThreaded = vplsPerThreadCount[1];
+    CPPUNIT_ASSERT_EQUAL( vpls.size(), vplsThreaded.size() );
+    for( size_t i=0; i<vpls.size(); ++i )
+    {
+        CPPUNIT_ASSERT( vpls[i].position == vplsThreaded[i].position );
+        CPPUNIT_ASSERT( vpls[i].diffuse == vplsThreaded[i].diffuse );
+    }
+}
+//--------------------------------------------------------------------------
+void InstantRadiosityTests::testUpdateLightMatchesBuild()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    SceneManager *sceneManager = createScene( 1u );
+    Light *lightA = createSpotLight( sceneManager, Vector3( -3.5f, 10.0f, 0.25f ) );
+    Light *lightB = createSpotLight( sceneManager, Vector3( 3.5f, 8.0f, -0.25f ) );
+
+    InstantRadiosity instantRadiosity( sceneManager, mRoot->getHlmsManager() );
+    configure( instantRadiosity );
+    instantRadiosity.build();
+
+    //Move one light and only regenerate its VPLs. The other light's VPLs are reused,
+    //and they're clustered in the same order as build() does; thus the results must match.
+    lightA->getParentSceneNode()->setPosition( -2.25f, 9.0f, 1.5f );
+    instantRadiosity.updateLight( lightA );
+    VplInfoVec updatedVpls;
+    getVpls( sceneManager, updatedVpls );
+
+    instantRadiosity.build();
+    VplInfoVec builtVpls;
+    getVpls( sceneManager, builtVpls );
+
+    CPPUNIT_ASSERT( !builtVpls.empty() );
+    CPPUNIT_ASSERT_EQUAL( builtVpls.size(), updatedVpls.size() );
+    for( size_t i=0; i<builtVpls.size(); ++i )
+    {
+        CPPUNIT_ASSERT( builtVpls[i].position == updatedVpls[i].position );
+        CPPUNIT_ASSERT( builtVpls[i].diffuse == updatedVpls[i].diffuse );
+    }
+
+    //Removing a light must leave the same VPLs as building without it
+    instantRadiosity.removeLight( lightB );
+    getVpls( sceneManager, updatedVpls );
+
+    lightB->setVisible( false );
+    instantRadiosity.build();
+    getVpls( sceneManager, builtVpls );
+
+    CPPUNIT_ASSERT( !builtVpls.empty() );
+    CPPUNIT_ASSERT_EQUAL( builtVpls.size(), updatedVpls.size() );
+    for( size_t i=0; i<builtVpls.size(); ++i )
+    {
+        CPPUNIT_ASSERT( builtVpls[i].position == updatedVpls[i].position );
+        CPPUNIT_ASSERT( builtVpls[i].diffuse == updatedVpls[i].diffuse );
+    }
+
+    instantRadiosity.clear();
+    instantRadiosity.freeMemory();
+    mRoot->destroySceneManager( sceneManager );
+}
+//--------------------------------------------------------------------------
@@ -0,0 +1,303 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "IrradianceVolumeTests.h"
+#include "OgreIrradianceVolume.h"
+#include "OgreRoot.h"
+#include "OgreNULLRenderSystem.h"
+#include "OgrePixelFormat.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+#include "OgreTimer.h"
+
+#include "UnitTestSuite.h"
+
+#include <cstdlib>
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(IrradianceVolumeTests);
+
+static const float c_kernel[9] =
+{
+    0.028532f, 0.067234f, 0.124009f, 0.179044f,
+    0.20236f,
+    0.179044f, 0.124009f, 0.067234f, 0.028532f
+};
+
+//--------------------------------------------------------------------------
+/// Straightforward per texel, per channel implementation of a single pass.
+/// axis = 0, 1, 2 for X, Y, Z
+static void naiveGaussFilter( float *dstData, const float *srcData,
+                              size_t texWidth, size_t texHeight, size_t texDepth, int axis )
+{
+    const size_t rowPitch = texWidth * 3u;
+    const size_t slicePitch = rowPitch * texHeight;
+
+    for( size_t z=0; z<texDepth; ++z )
+    {
+        for( size_t y=0; y<texHeight; ++y )
+        {
+            for( size_t x=0; x<texWidth; ++x )
+            {
+                int kStart, kEnd;
+                ptrdiff_t stride;
+                if( axis == 0 )
+                {
+                    kStart  = std::max<int>( -(int)x, -4 );
+                    kEnd    = std::min<int>( texWidth - 1u - x, 4 );
+                    stride  = 3;
+                }
+                else if( axis == 1 )
+                {
+                    const size_t blockY = y / 6u;
+                    kStart  = std::max<int>( -(int)blockY, -4 );
+                    kEnd    = std::min<int>( texHeight / 6u - 1u - blockY, 4 );
+                    stride  = rowPitch * 6u;
+                }
+                else
+                {
+                    kStart  = std::max<int>( -(int)z, -4 );
+                    kEnd    = std::min<int>( texDepth - 1u - z, 4 );
+                    stride  = slicePitch;
+                }
+
+                for( size_t c=0; c<3u; ++c )
+                {
+                    const size_t idx = z * slicePitch + y * rowPitch + x * 3u + c;
+
+                    float accum = 0;
+                    float divisor = 0;
+                    for( int k=kStart; k<=kEnd; ++k )
+                    {
+                        accum += srcData[idx + k * stride] * c_kernel[k+4];
+                        divisor += c_kernel[k+4];
+                    }
+
+                    dstData[idx] = accum * (1.0f / divisor);
+                }
+            }
+        }
+    }
+}
+//--------------------------------------------------------------------------
+/// Filters along X, then Y, then Z
+static void naiveGaussFilter( float *dstData, float *tmpData, const float *srcData,
+                              size_t texWidth, size_t texHeight, size_t texDepth )
+{
+    naiveGaussFilter( dstData, srcData, texWidth, texHeight, texDepth, 0 );
+    naiveGaussFilter( tmpData, dstData, texWidth, texHeight, texDepth, 1 );
+    naiveGaussFilter( dstData, tmpData, texWidth, texHeight, texDepth, 2 );
+}
+//--------------------------------------------------------------------------
+/// Returns true if both floats are at most maxUlps representable values apart.
+static bool almostEqualUlps( float a, float b, int32 maxUlps )
+{
+    if( a == b )
+        return true;
+
+    int32 aInt, bInt;
+    memcpy( &aInt, &a, sizeof(aInt) );
+    memcpy( &bInt, &b, sizeof(bInt) );
+
+    if( (aInt < 0) != (bInt < 0) )
+        return false;
+
+    return std::abs( aInt - bInt ) <= maxUlps;
+}
+//--------------------------------------------------------------------------
+/// Fills the volume (and srcData, with the same layout) with random values
+static void fillRandomVolume( IrradianceVolume &volume, vector<float>::type &srcData )
+{
+    const uint32 numBlocksX = volume.getNumBlocksX();
+    const uint32 numBlocksY = volume.getNumBlocksY();
+    const uint32 numBlocksZ = volume.getNumBlocksZ();
+    const size_t rowPitch   = numBlocksX * 3u;
+    const size_t slicePitch = rowPitch * numBlocksY * 6u;
+
+    srcData.resize( slicePitch * numBlocksZ );
+    volume.clearVolumeData();
+
+    for( uint32 z=0; z<numBlocksZ; ++z )
+    {
+        for( uint32 y=0; y<numBlocksY; ++y )
+        {
+            for( uint32 dir=0; dir<6u; ++dir )
+            {
+                for( uint32 x=0; x<numBlocksX; ++x )
+                {
+                    Vector3 value;
+                    for( size_t c=0; c<3u; ++c )
+                        value[c] = rand() / (float)RAND_MAX;
+
+                    const size_t idx = z * slicePitch + (y * 6u + dir) * rowPitch + x * 3u;
+                    srcData[idx + 0] = value.x;
+                    srcData[idx + 1] = value.y;
+                    srcData[idx + 2] = value.z;
+                    volume.changeVolumeData( x, y, z, dir, value );
+                }
+            }
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void IrradianceVolumeTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root( BLANKSTRING, BLANKSTRING );
+    mRenderSystem = OGRE_NEW NULLRenderSystem();
+    mRoot->addRenderSystem( mRenderSystem );
+    mRoot->setRenderSystem( mRenderSystem );
+    mRoot->initialise( true );
+
+    srand( 101 );
+}
+//--------------------------------------------------------------------------
+void IrradianceVolumeTests::tearDown()
+{
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+    OGRE_DELETE mRenderSystem;
+    mRenderSystem = 0;
+}
+//--------------------------------------------------------------------------
+void IrradianceVolumeTests::testGaussFilter()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Odd sizes, and sizes smaller than the kernel, to exercise the borders.
+    // The last one is big enough to be split in several threads.
+    const uint32 c_sizes[][3] =
+    {
+        { 1, 1, 1 },
+        { 3, 2, 5 },
+        { 13, 5, 11 },
+        { 32, 16, 24 },
+        { 41, 23, 37 }
+    };
+
+    for( size_t i=0; i<sizeof(c_sizes) / sizeof(c_sizes[0]); ++i )
+    {
+        IrradianceVolume volume( mRoot->getHlmsManager() );
+        volume.createIrradianceVolumeTexture( c_sizes[i][0], c_sizes[i][1], c_sizes[i][2] );
+
+        vector<float>::type srcData;
+        fillRandomVolume( volume, srcData );
+
+        const size_t texWidth   = c_sizes[i][0];
+        const size_t texHeight  = c_sizes[i][1] * 6u;
+        const size_t texDepth   = c_sizes[i][2];
+        const size_t numFloats  = srcData.size();
+
+        vector<float>::type naiveData( numFloats );
+        vector<float>::type tmpData( numFloats );
+        naiveGaussFilter( &naiveData[0], &tmpData[0], &srcData[0],
+                          texWidth, texHeight, texDepth );
+
+        volume.updateIrradianceVolumeTexture( 1u );
+        const vector<float>::type blurredData( volume.getBlurredVolumeData(),
+                                               volume.getBlurredVolumeData() + numFloats );
+
+        // Same operations in the same order, but the compiler may still
+        // contract or reorder the scalar ones differently.
+        for( size_t j=0; j<numFloats; ++j )
+            CPPUNIT_ASSERT( almostEqualUlps( naiveData[j], blurredData[j], 4 ) );
+
+        // Filtering again must give the same result, thus the unfiltered data must have
+        // been preserved. Splitting the work in threads must not change the results at all.
+        volume.updateIrradianceVolumeTexture( 4u );
+        CPPUNIT_ASSERT( memcmp( &blurredData[0], volume.getBlurredVolumeData(),
+                                numFloats * sizeof(float) ) == 0 );
+    }
+}
+//--------------------------------------------------------------------------
+void IrradianceVolumeTests::testGaussFilterBenchmark()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    LogManager::getSingleton().logMessage(
+        "IrradianceVolume::updateIrradianceVolumeTexture benchmark. "
+        "Naive / single thread / threaded, in ms" );
+
+    // 128^3 is the typical size. Timings depend on the machine, they're only logged.
+    const uint32 c_sizes[] = { 16, 32, 64, 128 };
+
+    Timer timer;
+    for( size_t i=0; i<sizeof(c_sizes) / sizeof(c_sizes[0]); ++i )
+    {
+        IrradianceVolume volume( mRoot->getHlmsManager() );
+        volume.createIrradianceVolumeTexture( c_sizes[i], c_sizes[i], c_sizes[i] );
+
+        vector<float>::type srcData;
+        fillRandomVolume( volume, srcData );
+
+        const size_t texWidth   = c_sizes[i];
+        const size_t texHeight  = c_sizes[i] * 6u;
+        const size_t texDepth   = c_sizes[i];
+        const size_t numFloats  = srcData.size();
+        const size_t numTexels  = numFloats / 3u;
+
+        unsigned long naiveTime;
+        {
+            vector<float>::type dstData( numFloats );
+            vector<float>::type tmpData( numFloats );
+            vector<uint32>::type packedData( numTexels );
+            timer.reset();
+            naiveGaussFilter( &dstData[0], &tmpData[0], &srcData[0],
+                              texWidth, texHeight, texDepth );
+            for( size_t j=0; j<numTexels; ++j )
+            {
+                PixelUtil::packColour( dstData[j * 3u + 0], dstData[j * 3u + 1],
+                                       dstData[j * 3u + 2], 1.0f,
+                                       PF_A2R10G10B10, &packedData[j] );
+            }
+            naiveTime = timer.getMicroseconds();
+        }
+
+        timer.reset();
+        volume.updateIrradianceVolumeTexture( 1u );
+        const unsigned long singleThreadTime = timer.getMicroseconds();
+        const vector<float>::type blurredData( volume.getBlurredVolumeData(),
+                                               volume.getBlurredVolumeData() + numFloats );
+
+        timer.reset();
+        volume.updateIrradianceVolumeTexture( 0u );
+        const unsigned long threadedTime = timer.getMicroseconds();
+
+        LogManager::getSingleton().logMessage(
+            StringConverter::toString( c_sizes[i] ) + "^3 cells: " +
+            StringConverter::toString( naiveTime / 1000.0f ) + " / " +
+            StringConverter::toString( singleThreadTime / 1000.0f ) + " / " +
+            StringConverter::toString( threadedTime / 1000.0f ) );
+
+        // Splitting in threads must not change the results
+        CPPUNIT_ASSERT( memcmp( &blurredData[0], volume.getBlurredVolumeData(),
+                                numFloats * sizeof(float) ) == 0 );
+    }
+}
+//--------------------------------------------------------------------------
@@ -0,0 +1,283 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "SceneFormatTests.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreItem.h"
+#include "OgreSubItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlmsPbs.h"
+#include "OgreNULLRenderSystem.h"
+#include "Vao/OgreVaoManager.h"
+#include "OgreSceneFormatExporter.h"
+#include "OgreSceneFormatImporter.h"
+#include <cstdlib>
+
+#include "UnitTestSuite.h"
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(SceneFormatTests);
+
+namespace
+{
+    typedef map<String, SceneNode*>::type SceneNodeMap;
+    typedef map<String, Item*>::type ItemMap;
+
+    Real randomReal( Real minValue, Real maxValue )
+    {
+        return minValue + (maxValue - minValue) * (rand() / (Real)RAND_MAX);
+    }
+
+    /// Collects node and all of its descendants by name.
+    void collectSceneNodes( SceneNode *node, SceneNodeMap &outSceneNodes )
+    {
+        outSceneNodes[node->getName()] = node;
+        for( size_t i=0; i<node->numChildren(); ++i )
+            collectSceneNodes( static_cast<SceneNode*>( node->getChild( i ) ), outSceneNodes );
+    }
+
+    void collectItems( SceneManager *sceneManager, ItemMap &outItems )
+    {
+        SceneManager::MovableObjectIterator itor =
+                sceneManager->getMovableObjectIterator( ItemFactory::FACTORY_TYPE_NAME );
+        while( itor.hasMoreElements() )
+        {
+            Item *item = static_cast<Item*>( itor.getNext() );
+            outItems[item->getName()] = item;
+        }
+    }
+
+    /// Creates a unit quad facing up.
+    void createQuadMesh( VaoManager *vaoManager )
+    {
+        const float c_vertices[4 * 6] =
+        {
+            -0.5f, 0.0f, -0.5f, 0.0f, 1.0f, 0.0f,
+            -0.5f, 0.0f,  0.5f, 0.0f, 1.0f, 0.0f,
+             0.5f, 0.0f, -0.5f, 0.0f, 1.0f, 0.0f,
+             0.5f, 0.0f,  0.5f, 0.0f, 1.0f, 0.0f
+        };
+        const uint16 c_indices[6] = { 0, 1, 2, 2, 1, 3 };
+
+        float *vertices = reinterpret_cast<float*>(
+                    OGRE_MALLOC_SIMD( sizeof(c_vertices), MEMCATEGORY_GEOMETRY ) );
+        uint16 *indices = reinterpret_cast<uint16*>(
+                    OGRE_MALLOC_SIMD( sizeof(c_indices), MEMCATEGORY_GEOMETRY ) );
+        memcpy( vertices, c_vertices, sizeof(c_vertices) );
+        memcpy( indices, c_indices, sizeof(c_indices) );
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+
+        VertexBufferPacked *vertexBuffer = vaoManager->createVertexBuffer(
+                    vertexElements, 4u, BT_IMMUTABLE, vertices, true );
+        IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+                    IndexBufferPacked::IT_16BIT, 6u, BT_IMMUTABLE, indices, true );
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( vertexBuffer );
+        VertexArrayObject *vao = vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                                      OT_TRIANGLE_LIST );
+
+        MeshPtr mesh = MeshManager::getSingleton().createManual(
+                    "SceneFormatTestsQuad", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+        SubMesh *subMesh = mesh->createSubMesh();
+        subMesh->mVao[VpNormal].push_back( vao );
+        subMesh->mVao[VpShadow].push_back( vao );
+
+        const Aabb bounds( Vector3::ZERO, Vector3( 0.5f, 0.0f, 0.5f ) );
+        mesh->_setBounds( bounds, false );
+        mesh->_setBoundingSphereRadius( bounds.getRadius() );
+    }
+}
+
+//--------------------------------------------------------------------------
+void SceneFormatTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root( BLANKSTRING, BLANKSTRING );
+    mRenderSystem = OGRE_NEW NULLRenderSystem();
+    mRoot->addRenderSystem( mRenderSystem );
+    mRoot->setRenderSystem( mRenderSystem );
+    mRoot->initialise( true );
+
+    HlmsPbs *hlmsPbs = OGRE_NEW HlmsPbs( 0, 0 );
+    mRoot->getHlmsManager()->registerHlms( hlmsPbs );
+    hlmsPbs->createDatablock( "SceneFormatTests", "SceneFormatTests",
+                              HlmsMacroblock(), HlmsBlendblock(), HlmsParamVec() );
+
+    //Where the importer looks for meshes
+    ResourceGroupManager::getSingleton().createResourceGroup( "SceneFormatImporter" );
+
+    createQuadMesh( mRenderSystem->getVaoManager() );
+
+    srand( 0 );
+}
+//--------------------------------------------------------------------------
+void SceneFormatTests::tearDown()
+{
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+    OGRE_DELETE mRenderSystem;
+    mRenderSystem = 0;
+}
+//--------------------------------------------------------------------------
+SceneManager* SceneFormatTests::createScene( size_t numNodes )
+{
+    SceneManager *sceneManager = mRoot->createSceneManager( ST_GENERIC, 4u,
+                                                            INSTANCING_CULLING_SINGLETHREAD );
+
+    vector<SceneNode*>::type sceneNodes;
+    sceneNodes.push_back( sceneManager->getRootSceneNode() );
+
+    for( size_t i=0; i<numNodes; ++i )
+    {
+        SceneNode *parent = sceneNodes[rand() % sceneNodes.size()];
+        SceneNode *sceneNode = parent->createChildSceneNode();
+        sceneNode->setName( "Node " + StringConverter::toString( i ) );
+        sceneNode->setPosition( randomReal( -100.0f, 100.0f ), randomReal( -100.0f, 100.0f ),
+                                randomReal( -100.0f, 100.0f ) );
+        Quaternion orientation( randomReal( -1.0f, 1.0f ), randomReal( -1.0f, 1.0f ),
+                                randomReal( -1.0f, 1.0f ), randomReal( -1.0f, 1.0f ) );
+        orientation.normalise();
+        sceneNode->setOrientation( orientation );
+        sceneNode->setScale( randomReal( 0.5f, 2.0f ), randomReal( 0.5f, 2.0f ),
+                             randomReal( 0.5f, 2.0f ) );
+        sceneNode->setInheritOrientation( i % 5u != 0 );
+        sceneNode->setInheritScale( i % 7u != 0 );
+        sceneNodes.push_back( sceneNode );
+
+        if( i % 3u == 0 )
+        {
+            Item *item = sceneManager->createItem( "SceneFormatTestsQuad",
+                                                   ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+            item->setName( "Item " + StringConverter::toString( i ) );
+            item->setDatablock( "SceneFormatTests" );
+            item->setRenderQueueGroup( static_cast<uint8>( 10u + i % 4u ) );
+            item->setVisibilityFlags( 0x1000u | static_cast<uint32>( i ) );
+            sceneNode->attachObject( item );
+        }
+    }
+
+    return sceneManager;
+}
+//--------------------------------------------------------------------------
+void SceneFormatTests::testBinarySceneRoundTrip()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    //Enough nodes for the transforms to be applied from the worker threads
+    SceneManager *srcSceneManager = createScene( 3000u );
+
+    const uint32 flags = SceneFlags::SceneNodes | SceneFlags::ForceAllSceneNodes |
+                         SceneFlags::Items;
+
+    String jsonString;
+    vector<uint8>::type binaryScene;
+    {
+        SceneFormatExporter exporter( mRoot, srcSceneManager, 0 );
+        exporter.exportScene( jsonString, flags, &binaryScene );
+    }
+    CPPUNIT_ASSERT( !binaryScene.empty() );
+    CPPUNIT_ASSERT( jsonString.find( "\"binary_scene\"" ) != String::npos );
+    CPPUNIT_ASSERT( jsonString.find( "\"scene_nodes\"" ) == String::npos );
+    CPPUNIT_ASSERT( jsonString.find( "\"items\"" ) == String::npos );
+
+    SceneManager *dstSceneManager = mRoot->createSceneManager( ST_GENERIC, 4u,
+                                                               INSTANCING_CULLING_SINGLETHREAD );
+    {
+        SceneFormatImporter importer( mRoot, dstSceneManager, BLANKSTRING );
+        importer.importScene( "SceneFormatTests", jsonString.c_str(), flags, &binaryScene );
+    }
+
+    SceneNodeMap srcNodes, dstNodes;
+    collectSceneNodes( srcSceneManager->getRootSceneNode(), srcNodes );
+    collectSceneNodes( dstSceneManager->getRootSceneNode(), dstNodes );
+    CPPUNIT_ASSERT_EQUAL( srcNodes.size(), dstNodes.size() );
+
+    SceneNodeMap::const_iterator itor = srcNodes.begin();
+    SceneNodeMap::const_iterator end  = srcNodes.end();
+    while( itor != end )
+    {
+        const SceneNode *srcNode = itor->second;
+        SceneNodeMap::const_iterator itDst = dstNodes.find( itor->first );
+        CPPUNIT_ASSERT( itDst != dstNodes.end() );
+        const SceneNode *dstNode = itDst->second;
+
+        if( srcNode->getParentSceneNode() )
+        {
+            CPPUNIT_ASSERT( dstNode->getParentSceneNode() );
+            CPPUNIT_ASSERT_EQUAL( srcNode->getParentSceneNode()->getName(),
+                                  dstNode->getParentSceneNode()->getName() );
+        }
+
+        //Floats are stored as is, so they must come back bit exact
+        CPPUNIT_ASSERT( srcNode->getPosition() == dstNode->getPosition() );
+        CPPUNIT_ASSERT( srcNode->getOrientation() == dstNode->getOrientation() );
+        CPPUNIT_ASSERT( srcNode->getScale() == dstNode->getScale() );
+        CPPUNIT_ASSERT_EQUAL( srcNode->getInheritOrientation(), dstNode->getInheritOrientation() );
+        CPPUNIT_ASSERT_EQUAL( srcNode->getInheritScale(), dstNode->getInheritScale() );
+        ++itor;
+    }
+
+    ItemMap srcItems, dstItems;
+    collectItems( srcSceneManager, srcItems );
+    collectItems( dstSceneManager, dstItems );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1000u, srcItems.size() );
+    CPPUNIT_ASSERT_EQUAL( srcItems.size(), dstItems.size() );
+
+    ItemMap::const_iterator itItem = srcItems.begin();
+    ItemMap::const_iterator enItem = srcItems.end();
+    while( itItem != enItem )
+    {
+        const Item *srcItem = itItem->second;
+        ItemMap::const_iterator itDst = dstItems.find( itItem->first );
+        CPPUNIT_ASSERT( itDst != dstItems.end() );
+        const Item *dstItem = itDst->second;
+
+        CPPUNIT_ASSERT( dstItem->getParentSceneNode() );
+        CPPUNIT_ASSERT_EQUAL( srcItem->getParentSceneNode()->getName(),
+                              dstItem->getParentSceneNode()->getName() );
+        CPPUNIT_ASSERT( srcItem->getMesh() == dstItem->getMesh() );
+        CPPUNIT_ASSERT_EQUAL( srcItem->getRenderQueueGroup(), dstItem->getRenderQueueGroup() );
+        CPPUNIT_ASSERT_EQUAL( srcItem->getVisibilityFlags(), dstItem->getVisibilityFlags() );
+        CPPUNIT_ASSERT_EQUAL( dstItem->getNumSubItems(), (size_t)1u );
+        CPPUNIT_ASSERT( srcItem->getSubItem( 0 )->getDatablock() ==
+                        dstItem->getSubItem( 0 )->getDatablock() );
+        ++itItem;
+    }
+
+    mRoot->destroySceneManager( dstSceneManager );
+    mRoot->destroySceneManager( srcSceneManager );
+}
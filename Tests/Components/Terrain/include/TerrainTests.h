@@ -49,6 +49,7 @@ class TerrainTests : public CppUnit::TestFixture
     // CppUnit macros for setting up the test suite
     CPPUNIT_TEST_SUITE(TerrainTests);
     CPPUNIT_TEST(testCreate);
+    CPPUNIT_TEST(testDerivedDataThreading);
     CPPUNIT_TEST_SUITE_END();
 
 #ifdef OGRE_STATIC_LIB
@@ -65,6 +66,8 @@ public:
     void tearDown();
 
     void testCreate();
+    /// Normals & lightmap calculated with several threads must match the serial ones.
+    void testDerivedDataThreading();
 };
 
 #endif
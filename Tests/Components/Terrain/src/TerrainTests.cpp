@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "OgreConfigFile.h"
 #include "OgreResourceGroupManager.h"
 #include "OgreLogManager.h"
+#include "OgrePixelBox.h"
 
 #include "UnitTestSuite.h"
 
@@ -129,3 +130,89 @@ void TerrainTests::testCreate()
     OGRE_DELETE t;
 }
 //--------------------------------------------------------------------------
+void TerrainTests::testDerivedDataThreading()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const uint16 terrainSize = 129;
+
+    Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+
+    // Bumpy terrain, so that there are shadows & varied normals.
+    float* heights = OGRE_ALLOC_T(float, terrainSize * terrainSize, MEMCATEGORY_GEOMETRY);
+    for (uint16 y = 0; y < terrainSize; ++y)
+    {
+        for (uint16 x = 0; x < terrainSize; ++x)
+        {
+            heights[y * terrainSize + x] = 40.0f * Math::Sin(x * 0.21f) * Math::Cos(y * 0.13f) +
+                                           15.0f * Math::Sin((x + y) * 0.57f);
+        }
+    }
+
+    Terrain::ImportData imp;
+    imp.inputFloat = heights;
+    imp.deleteInputData = true;
+    imp.terrainSize = terrainSize;
+    imp.worldSize = 1000;
+    imp.minBatchSize = 33;
+    imp.maxBatchSize = 65;
+
+    mTerrainOpts->setLightMapSize(256);
+    mTerrainOpts->setLightMapDirection(Vector3(0.55f, -0.3f, 0.75f).normalisedCopy());
+    t->prepare(imp);
+
+    const Rect fullRect(0, 0, terrainSize, terrainSize);
+
+    // The default of 1 thread is the serial reference.
+    CPPUNIT_ASSERT_EQUAL((uint32)1u, mTerrainOpts->getNumDerivedDataThreads());
+
+    Rect normalsRect, lightmapRect;
+    PixelBox* normals = t->calculateNormals(fullRect, normalsRect);
+    PixelBox* lightmap = t->calculateLightmap(fullRect, Rect(), lightmapRect);
+
+    const size_t normalsBytes = normals->getConsecutiveSize();
+    const size_t lightmapBytes = lightmap->getConsecutiveSize();
+
+    bool anyShadowed = false;
+    const uint8* lightmapData = static_cast<const uint8*>(lightmap->data);
+    for (size_t i = 0; i < lightmapBytes; ++i)
+        anyShadowed |= lightmapData[i] != 255u;
+    CPPUNIT_ASSERT(anyShadowed);
+
+    // 0 means one thread per core
+    const uint32 threadCounts[] = { 2, 3, 4, 7, 0 };
+    for (size_t i = 0; i < sizeof(threadCounts) / sizeof(threadCounts[0]); ++i)
+    {
+        mTerrainOpts->setNumDerivedDataThreads(threadCounts[i]);
+
+        Rect threadedNormalsRect, threadedLightmapRect;
+        PixelBox* threadedNormals = t->calculateNormals(fullRect, threadedNormalsRect);
+        PixelBox* threadedLightmap = t->calculateLightmap(fullRect, Rect(), threadedLightmapRect);
+
+        CPPUNIT_ASSERT_EQUAL(normalsRect.left, threadedNormalsRect.left);
+        CPPUNIT_ASSERT_EQUAL(normalsRect.top, threadedNormalsRect.top);
+        CPPUNIT_ASSERT_EQUAL(normalsRect.right, threadedNormalsRect.right);
+        CPPUNIT_ASSERT_EQUAL(normalsRect.bottom, threadedNormalsRect.bottom);
+        CPPUNIT_ASSERT_EQUAL(lightmapRect.left, threadedLightmapRect.left);
+        CPPUNIT_ASSERT_EQUAL(lightmapRect.top, threadedLightmapRect.top);
+        CPPUNIT_ASSERT_EQUAL(lightmapRect.right, threadedLightmapRect.right);
+        CPPUNIT_ASSERT_EQUAL(lightmapRect.bottom, threadedLightmapRect.bottom);
+        CPPUNIT_ASSERT_EQUAL(normalsBytes, threadedNormals->getConsecutiveSize());
+        CPPUNIT_ASSERT_EQUAL(lightmapBytes, threadedLightmap->getConsecutiveSize());
+        CPPUNIT_ASSERT(!memcmp(normals->data, threadedNormals->data, normalsBytes));
+        CPPUNIT_ASSERT(!memcmp(lightmap->data, threadedLightmap->data, lightmapBytes));
+
+        OGRE_FREE(threadedNormals->data, MEMCATEGORY_GENERAL);
+        OGRE_DELETE threadedNormals;
+        OGRE_FREE(threadedLightmap->data, MEMCATEGORY_GENERAL);
+        OGRE_DELETE threadedLightmap;
+    }
+
+    OGRE_FREE(normals->data, MEMCATEGORY_GENERAL);
+    OGRE_DELETE normals;
+    OGRE_FREE(lightmap->data, MEMCATEGORY_GENERAL);
+    OGRE_DELETE lightmap;
+
+    OGRE_DELETE t;
+}
+//--------------------------------------------------------------------------
@@ -0,0 +1,170 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "VolumeTests.h"
+#include "OgreVolumeCSGSource.h"
+#include "OgreVolumeCacheSource.h"
+#include "OgreVolumeOctreeNode.h"
+#include "OgreVolumeOctreeNodeSplitPolicy.h"
+#include "OgreVolumeDualGridGenerator.h"
+#include "OgreVolumeIsoSurfaceMC.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre::Volume;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(VolumeTests);
+
+//--------------------------------------------------------------------------
+/// Keeps a copy of the triangles handed out by a MeshBuilder.
+class TriangleCollector : public MeshBuilderCallback
+{
+public:
+    VecVertex mVertices;
+    VecIndices mIndices;
+
+    virtual void ready(const SimpleRenderable *simpleRenderable, const VecVertex &vertices, const VecIndices &indices, size_t level, int inProcess)
+    {
+        mVertices = vertices;
+        mIndices = indices;
+    }
+};
+//--------------------------------------------------------------------------
+/// Meshes the lower half of src, so that border cells are generated as well.
+static void buildMesh(const Source *src, size_t numThreads, TriangleCollector &collector)
+{
+    const Vector3 totalFrom(0, 0, 0), totalTo(16, 16, 16);
+    const Real baseError = 0.2f;
+    OctreeNode root(Vector3(0, 0, 0), Vector3(16, 8, 16));
+    OctreeNodeSplitPolicy policy(src, baseError);
+    root.split(&policy, src, baseError, numThreads);
+
+    IsoSurfaceMC is(src);
+    MeshBuilder mb;
+    DualGridGenerator dualGridGenerator;
+    dualGridGenerator.generateDualGrid(&root, &is, &mb, 1.0f, totalFrom, totalTo, false, numThreads);
+    mb.executeCallback(&collector, 0, 0, 0);
+}
+//--------------------------------------------------------------------------
+void VolumeTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+}
+//--------------------------------------------------------------------------
+void VolumeTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void VolumeTests::testThreadSafeSources()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    CSGSphereSource sphere(5.0f, Vector3(8.0f, 8.0f, 8.0f));
+    CSGCubeSource cube(Vector3(2.0f, 1.0f, 3.0f), Vector3(9.0f, 6.0f, 8.0f));
+    CSGUnionSource csgUnion(&sphere, &cube);
+    CPPUNIT_ASSERT(sphere.isThreadSafe());
+    CPPUNIT_ASSERT(csgUnion.isThreadSafe());
+
+    // The cache is filled while meshing, so it and anything built on it must
+    // stay single threaded.
+    CacheSource cache(&sphere);
+    CSGDifferenceSource difference(&cache, &cube);
+    CSGNegateSource negate(&cache);
+    CPPUNIT_ASSERT(!cache.isThreadSafe());
+    CPPUNIT_ASSERT(!difference.isThreadSafe());
+    CPPUNIT_ASSERT(!negate.isThreadSafe());
+}
+//--------------------------------------------------------------------------
+void VolumeTests::testBatchedValues()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    CSGSphereSource sphere1(5.3f, Vector3(8.1f, 8.2f, 7.9f));
+    CSGSphereSource sphere2(3.7f, Vector3(11.0f, 10.0f, 9.3f));
+    CSGCubeSource cube(Vector3(2.2f, 1.1f, 3.3f), Vector3(9.7f, 6.2f, 8.8f));
+    CSGUnionSource csgUnion(&sphere1, &sphere2);
+    CSGDifferenceSource src(&csgUnion, &cube);
+
+    // Not a multiple of the batch width on purpose.
+    const size_t count = 37;
+    Real posX[count], posY[count], posZ[count];
+    Real values[count], batchedValues[count];
+    Real gradX[count], gradY[count], gradZ[count];
+    for (size_t i = 0; i < count; ++i)
+    {
+        posX[i] = 0.5f * i;
+        posY[i] = 16.0f - 0.25f * i;
+        posZ[i] = 3.0f + 0.3f * i;
+    }
+
+    src.getValues(count, posX, posY, posZ, batchedValues);
+    src.getValuesAndGradients(count, posX, posY, posZ, values, gradX, gradY, gradZ);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Vector3 position(posX[i], posY[i], posZ[i]);
+        const Vector4 expected = src.getValueAndGradient(position);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(src.getValue(position), batchedValues[i], 1e-5f);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.w, values[i], 1e-5f);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.x, gradX[i], 1e-5f);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.y, gradY[i], 1e-5f);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.z, gradZ[i], 1e-5f);
+    }
+}
+//--------------------------------------------------------------------------
+void VolumeTests::testThreadedMeshMatchesSerial()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    CSGSphereSource sphere1(5.3f, Vector3(8.1f, 8.2f, 7.9f));
+    CSGSphereSource sphere2(3.7f, Vector3(11.0f, 10.0f, 9.3f));
+    CSGCubeSource cube(Vector3(2.2f, 1.1f, 3.3f), Vector3(9.7f, 6.2f, 8.8f));
+    CSGUnionSource csgUnion(&sphere1, &sphere2);
+    CSGDifferenceSource src(&csgUnion, &cube);
+
+    TriangleCollector serial;
+    buildMesh(&src, 1, serial);
+    CPPUNIT_ASSERT(!serial.mIndices.empty());
+
+    // Same triangles in the same order, no matter how the work was split.
+    const size_t threadCounts[] = { 2, 4, 7 };
+    for (size_t i = 0; i < sizeof(threadCounts) / sizeof(threadCounts[0]); ++i)
+    {
+        TriangleCollector threaded;
+        buildMesh(&src, threadCounts[i], threaded);
+
+        CPPUNIT_ASSERT_EQUAL(serial.mVertices.size(), threaded.mVertices.size());
+        CPPUNIT_ASSERT(serial.mIndices == threaded.mIndices);
+        for (size_t j = 0; j < serial.mVertices.size(); ++j)
+        {
+            const Vertex &a = serial.mVertices[j];
+            const Vertex &b = threaded.mVertices[j];
+            CPPUNIT_ASSERT(a.x == b.x && a.y == b.y && a.z == b.z);
+            CPPUNIT_ASSERT(a.nX == b.nX && a.nY == b.nY && a.nZ == b.nZ);
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __CompositorTests_H__
+#define __CompositorTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+
+class CompositorTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(CompositorTests);
+    CPPUNIT_TEST(testTransientTexturesAliased);
+    CPPUNIT_TEST(testPassedThroughTextureNotAliased);
+    CPPUNIT_TEST(testExecutionPlanNotifiesLikeNodes);
+    CPPUNIT_TEST(testCpuFrameStatsPerFrame);
+    CPPUNIT_TEST(testShadowMapCacheCasterLeavesVolume);
+    CPPUNIT_TEST_SUITE_END();
+
+    Ogre::Root              *mRoot;
+    Ogre::RenderSystem      *mRenderSystem;
+    Ogre::RenderWindow      *mWindow;
+    Ogre::SceneManager      *mSceneMgr;
+    Ogre::Camera            *mCamera;
+
+    /** Defines a chain of four nodes (A -> B -> C -> D). Each declares a transient
+        texture (tA, tB, tC, tD) with the same definition; D also declares a
+        non-transient one (tE) and a transient one with another format (tF).
+    @param passThrough
+        When true, B also passes tA on to C, extending its lifetime.
+    */
+    void createAliasingWorkspaceDef( const Ogre::String &workspaceName, bool passThrough );
+
+    /** Defines two nodes. A clears rt0, rt1 and rt0 again, with the rt1 pass
+        only in execution mask 0x02. B only has a pass in execution mask 0x02.
+    */
+    void createPlanWorkspaceDef( const Ogre::String &workspaceName );
+
+    /** Defines a shadow node with a single shadow map for the closest spot light,
+        and a node rendering the scene to the window using that shadow node.
+    */
+    void createShadowWorkspaceDef( const Ogre::String &workspaceName );
+
+public:
+    void setUp();
+    void tearDown();
+
+    /// Textures whose lifetimes don't overlap must share memory, others must not.
+    void testTransientTexturesAliased();
+    /// A texture passed through to a later node lives until that node.
+    void testPassedThroughTextureNotAliased();
+    /// The cached execution plan must notify the same target switches as
+    /// CompositorNode::_update, even for passes excluded by the execution mask.
+    void testExecutionPlanNotifiesLikeNodes();
+    /// The CPU stats get one sample per frame, no matter how often _update is called.
+    void testCpuFrameStatsPerFrame();
+    /// A shadow map rendered with dynamic casters in it must not be reused once
+    /// those casters left the volume; it still holds their shadows.
+    void testShadowMapCacheCasterLeavesVolume();
+};
+
+#endif
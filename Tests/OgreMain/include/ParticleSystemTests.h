@@ -0,0 +1,67 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __ParticleSystemTests_H__
+#define __ParticleSystemTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+
+class ParticleSystemTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(ParticleSystemTests);
+    CPPUNIT_TEST(testThreadedUpdateMatchesSerial);
+    CPPUNIT_TEST(testPendingStepsNotMerged);
+    CPPUNIT_TEST_SUITE_END();
+
+    Ogre::Root                      *mRoot;
+    Ogre::RenderSystem              *mRenderSystem;
+    Ogre::SceneManager              *mSceneMgr;
+    Ogre::ParticleEmitterFactory    *mEmitterFactory;
+
+    typedef Ogre::vector<Ogre::ParticleSystem*>::type ParticleSystemVec;
+    ParticleSystemVec               mSystems;
+
+    /// Creates a system with a randomised emitter, attached to its own node.
+    Ogre::ParticleSystem* createSystem( Ogre::uint32 seed, const Ogre::Vector3 &position );
+    void destroySystems(void);
+
+public:
+    void setUp();
+    void tearDown();
+
+    /// Systems updated by the SceneManager's worker threads must emit exactly the same
+    /// particles as identically seeded systems updated one at a time via _update.
+    void testThreadedUpdateMatchesSerial();
+    /// Time queued over several frames must be simulated one step at a time.
+    void testPendingStepsNotMerged();
+};
+
+#endif
@@ -43,6 +43,11 @@ class PixelFormatTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testIntegerPackUnpack);
     CPPUNIT_TEST(testFloatPackUnpack);
     CPPUNIT_TEST(testBulkConversion);
+    CPPUNIT_TEST(testBulkConversionRows);
+    CPPUNIT_TEST(testRG8ToFloat16GR);
+    CPPUNIT_TEST(testSRGBConversion);
+    CPPUNIT_TEST(testBulkConversionThreaded);
+    CPPUNIT_TEST(testBulkConversionBenchmark);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -52,10 +57,22 @@ public:
     void testIntegerPackUnpack();
     void testFloatPackUnpack();
     void testBulkConversion();
+    /// SIMD row converters on boxes with odd widths, row padding and several threads.
+    void testBulkConversionRows();
+    void testRG8ToFloat16GR();
+    void testSRGBConversion();
+    /// Splitting a conversion in threads must not change its result, for every pair.
+    void testBulkConversionThreaded();
+    /// Logs single threaded and threaded timings for every supported pair.
+    void testBulkConversionBenchmark();
 
     // Utils
     void setupBoxes(PixelFormat srcFormat, PixelFormat dstFormat);
     void testCase(PixelFormat srcFormat, PixelFormat dstFormat);
+    /// Converts a padded 2D box with 1 and 4 threads, and compares against the naive
+    /// conversion. Gamma is 0 for bulkPixelConversion, 1 for convertSRGBToLinear and
+    /// 2 for convertLinearToSRGB.
+    void testCase2D(PixelFormat srcFormat, PixelFormat dstFormat, int gamma);
 
 private:
     int mSize;
@@ -0,0 +1,90 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __SceneCullingTests_H__
+#define __SceneCullingTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreCommon.h"
+
+class CullTestSceneManager;
+class CullTestSceneManagerFactory;
+
+class SceneCullingTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(SceneCullingTests);
+    CPPUNIT_TEST(testBatchedShadowCulling);
+    CPPUNIT_TEST(testBatchedMultiViewCulling);
+    CPPUNIT_TEST_SUITE_END();
+
+    Ogre::Root                  *mRoot;
+    Ogre::RenderSystem          *mRenderSystem;
+    Ogre::RenderWindow          *mWindow;
+    Ogre::Viewport              *mViewport;
+    CullTestSceneManagerFactory *mSceneMgrFactory;
+    CullTestSceneManager        *mSceneMgr;
+
+    typedef Ogre::vector<Ogre::MovableObject*>::type MovableObjectVec;
+    typedef Ogre::vector<Ogre::Camera*>::type CameraVec;
+    MovableObjectVec            mObjects;
+    CameraVec                   mCameras;
+
+    /** Creates objects with random world Aabbs, attached to the root node, spread
+        across render queues 0 & 1. Every 7th object is hidden and every 5th one
+        doesn't cast shadows.
+    */
+    void createObjects( size_t numObjects, Ogre::Real range );
+    void destroyObjects(void);
+
+    /// Creates cameras at random positions, looking at random points.
+    void createCameras( size_t numCameras, Ogre::Real range );
+
+    /** Culls every camera in mCameras on its own, then all of them in one
+        batch, and checks both produce the same visible objects.
+    @param visibilityMask
+        Visibility mask of the viewport. Whether it includes LAYER_SHADOW_CASTER
+        decides if these are shadow caster passes.
+    */
+    void checkBatchedCulling( Ogre::uint32 visibilityMask );
+
+public:
+    void setUp();
+    void tearDown();
+
+    /// _cullFrustumsBatched must produce the same results as culling each shadow
+    /// camera on its own, and _cullPhase01 must take them from the batch.
+    void testBatchedShadowCulling();
+    /// Same for regular views, as culled by CompositorManager2 with multi-view
+    /// culling. Non-casters must be visible in those.
+    void testBatchedMultiViewCulling();
+};
+
+#endif
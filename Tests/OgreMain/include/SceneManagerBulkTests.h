@@ -0,0 +1,70 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __SceneManagerBulkTests_H__
+#define __SceneManagerBulkTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+
+class SceneManagerBulkTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(SceneManagerBulkTests);
+    CPPUNIT_TEST(testCreateSceneNodes);
+    CPPUNIT_TEST(testDestroySceneNodes);
+    CPPUNIT_TEST(testDestroySceneNodesValidatesBatch);
+    CPPUNIT_TEST(testDestroySceneNodesListenerThrows);
+    CPPUNIT_TEST(testCreateDestroyItems);
+    CPPUNIT_TEST(testDestroyItemsValidatesBatch);
+    CPPUNIT_TEST_SUITE_END();
+
+    Ogre::Root          *mRoot;
+    Ogre::RenderSystem  *mRenderSystem;
+    Ogre::SceneManager  *mSceneMgr;
+
+    /// Returns the number of Items mSceneMgr knows about.
+    size_t countItems(void);
+    /// Checks every Item still points to its own slot.
+    void checkItems( const Ogre::vector<Ogre::Item*>::type &items );
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testCreateSceneNodes();
+    void testDestroySceneNodes();
+    void testDestroySceneNodesValidatesBatch();
+    /// The cleanups deferral must be restored when a listener throws mid-batch.
+    void testDestroySceneNodesListenerThrows();
+    void testCreateDestroyItems();
+    void testDestroyItemsValidatesBatch();
+};
+
+#endif
@@ -0,0 +1,76 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __SceneQueryTests_H__
+#define __SceneQueryTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreCommon.h"
+
+class SceneQueryTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(SceneQueryTests);
+    CPPUNIT_TEST(testIntersectionQuery);
+    CPPUNIT_TEST(testIntersectionQueryThreaded);
+    CPPUNIT_TEST(testBatchedRayQuery);
+    CPPUNIT_TEST(testBatchedSphereQuery);
+    CPPUNIT_TEST(testBatchedAabbQuery);
+    CPPUNIT_TEST_SUITE_END();
+
+    Ogre::Root              *mRoot;
+    Ogre::RenderSystem      *mRenderSystem;
+    Ogre::SceneManager      *mSceneMgr;
+
+    typedef Ogre::vector<Ogre::MovableObject*>::type MovableObjectVec;
+    MovableObjectVec        mObjects;
+
+    /// Creates objects with random world Aabbs, attached to the root node. Every
+    /// 7th object is hidden and every 5th one fails the default query mask.
+    void createObjects( size_t numObjects, Ogre::Real range );
+    void destroyObjects(void);
+
+    /// Compares DefaultIntersectionSceneQuery against testing every pair.
+    void checkIntersectionQuery(void);
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testIntersectionQuery();
+    /// Enough objects for the sweep to be split across the worker threads.
+    void testIntersectionQueryThreaded();
+    /// executeBatch must report the same hits and distances as execute, sorted or not.
+    void testBatchedRayQuery();
+    void testBatchedSphereQuery();
+    void testBatchedAabbQuery();
+};
+
+#endif
@@ -0,0 +1,69 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __ScriptCompilerTests_H__
+#define __ScriptCompilerTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+
+class DumpTranslatorManager;
+
+class ScriptCompilerTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(ScriptCompilerTests);
+    CPPUNIT_TEST(testAstCacheRoundTrip);
+    CPPUNIT_TEST(testAstCacheFile);
+    CPPUNIT_TEST(testAstCacheCorrupt);
+    CPPUNIT_TEST(testAstCacheStaleImports);
+    CPPUNIT_TEST_SUITE_END();
+
+    Ogre::String            mTestPath;
+    DumpTranslatorManager   *mTranslatorManager;
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testAstCacheRoundTrip();
+    void testAstCacheFile();
+    void testAstCacheCorrupt();
+    void testAstCacheStaleImports();
+
+    // Utils
+    void writeFile( const Ogre::String &filename, const Ogre::String &contents );
+    /// Compiles the test script for the given group. Returns the translated objects.
+    Ogre::String compile( const Ogre::String &groupName );
+    /// Returns the AST cache, serialised.
+    Ogre::String saveAstCache(void);
+    void loadAstCache( const Ogre::String &data );
+};
+
+#endif
@@ -0,0 +1,67 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __TraceProfilerTests_H__
+#define __TraceProfilerTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+
+namespace Ogre
+{
+    class TraceProfiler;
+}
+
+class TraceProfilerTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(TraceProfilerTests);
+    CPPUNIT_TEST(testChromeTraceExport);
+    CPPUNIT_TEST(testGroupMask);
+    CPPUNIT_TEST(testRecordingOverhead);
+    CPPUNIT_TEST_SUITE_END();
+
+    Ogre::TraceProfiler *mTraceProfiler;
+
+public:
+    void setUp();
+    void tearDown();
+
+    /// Events from several threads, nested and with names that need escaping,
+    /// must come out as balanced Chrome trace JSON.
+    void testChromeTraceExport();
+    /// Masked out groups aren't recorded; events begun before changing the
+    /// mask (or disabling) still get their end.
+    void testGroupMask();
+    /// Logs the cost of recording a begin/end pair, enabled and disabled.
+    /// Timings depend on the machine, so nothing is asserted.
+    void testRecordingOverhead();
+};
+
+#endif
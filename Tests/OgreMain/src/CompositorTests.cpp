@@ -0,0 +1,423 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "CompositorTests.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreCamera.h"
+#include "OgreLight.h"
+#include "OgreSceneNode.h"
+#include "OgreMovableObject.h"
+#include "OgreId.h"
+#include "OgreRenderWindow.h"
+#include "OgreTexture.h"
+#include "Compositor/OgreCompositorManager2.h"
+#include "Compositor/OgreCompositorNodeDef.h"
+#include "Compositor/OgreCompositorNode.h"
+#include "Compositor/OgreCompositorShadowNode.h"
+#include "Compositor/OgreCompositorShadowNodeDef.h"
+#include "Compositor/OgreCompositorWorkspaceDef.h"
+#include "Compositor/OgreCompositorWorkspace.h"
+#include "Compositor/Pass/OgreCompositorPassDef.h"
+#include "Compositor/Pass/PassScene/OgreCompositorPassSceneDef.h"
+#include "OgreNULLRenderSystem.h"
+#include "OgreNULLTextureManager.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(CompositorTests);
+
+namespace
+{
+    /// Records the render target switches the compositor notifies.
+    class SwitchRecordingRenderSystem : public NULLRenderSystem
+    {
+    public:
+        vector<RenderTarget*>::type mSwitchedFromTargets;
+
+        virtual void _notifyCompositorNodeSwitchedRenderTarget( RenderTarget *previousTarget )
+        {
+            mSwitchedFromTargets.push_back( previousTarget );
+        }
+    };
+
+    /// Bare dynamic object; casts shadows but has nothing to render.
+    class CasterTestObject : public MovableObject
+    {
+        static const String msMovableType;
+
+    public:
+        CasterTestObject( SceneManager *sceneManager ) :
+            MovableObject( Id::generateNewId<MovableObject>(),
+                           &sceneManager->_getEntityMemoryManager( SCENE_DYNAMIC ),
+                           sceneManager, 0 )
+        {
+            setLocalAabb( Aabb( Vector3::ZERO, Vector3::UNIT_SCALE ) );
+        }
+
+        virtual const String& getMovableType(void) const    { return msMovableType; }
+    };
+
+    const String CasterTestObject::msMovableType = "CasterTestObject";
+
+    const uint32 c_aliasingTexSize = 64u;
+    const size_t c_aliasingTexBytes = c_aliasingTexSize * c_aliasingTexSize * 4u;
+
+    TextureDefinitionBase::TextureDefinition* addTexture( CompositorNodeDef *nodeDef,
+                                                          const String &name, PixelFormat format,
+                                                          bool transient )
+    {
+        TextureDefinitionBase::TextureDefinition *texDef = nodeDef->addTextureDefinition( name );
+        texDef->width       = c_aliasingTexSize;
+        texDef->height      = c_aliasingTexSize;
+        texDef->fsaa        = false;
+        texDef->transient   = transient;
+        texDef->formatList.push_back( format );
+        return texDef;
+    }
+
+    Texture* getLocalTexture( const CompositorWorkspace *workspace,
+                              const char *nodeName, size_t localTextureIdx )
+    {
+        const CompositorNode *node = workspace->findNode( nodeName );
+        return node->getLocalTextures()[localTextureIdx].textures[0].get();
+    }
+
+    bool isAliased( const CompositorWorkspace *workspace,
+                    const char *nodeName, size_t localTextureIdx )
+    {
+        return workspace->findNode( nodeName )->isLocalTextureAliased( localTextureIdx );
+    }
+}
+
+//--------------------------------------------------------------------------
+void CompositorTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root( BLANKSTRING, BLANKSTRING );
+    mRenderSystem = OGRE_NEW SwitchRecordingRenderSystem();
+    mRoot->addRenderSystem( mRenderSystem );
+    mRoot->setRenderSystem( mRenderSystem );
+    mWindow = mRoot->initialise( true );
+
+    mSceneMgr = mRoot->createSceneManager( ST_GENERIC, 1u, INSTANCING_CULLING_SINGLETHREAD );
+    mCamera = mSceneMgr->createCamera( "CompositorTestsCamera" );
+}
+//--------------------------------------------------------------------------
+void CompositorTests::tearDown()
+{
+    mRoot->getCompositorManager2()->removeAllWorkspaces();
+
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+    mWindow = 0;
+    mSceneMgr = 0;
+    mCamera = 0;
+    OGRE_DELETE mRenderSystem;
+    mRenderSystem = 0;
+}
+//--------------------------------------------------------------------------
+void CompositorTests::createAliasingWorkspaceDef( const String &workspaceName, bool passThrough )
+{
+    CompositorManager2 *compositorManager = mRoot->getCompositorManager2();
+
+    CompositorNodeDef *nodeDef = compositorManager->addNodeDefinition( "AliasingA" );
+    addTexture( nodeDef, "tA", PF_R8G8B8A8, true );
+    nodeDef->mapOutputChannel( 0, "tA" );
+
+    nodeDef = compositorManager->addNodeDefinition( "AliasingB" );
+    nodeDef->addTextureSourceName( "in0", 0, TextureDefinitionBase::TEXTURE_INPUT );
+    addTexture( nodeDef, "tB", PF_R8G8B8A8, true );
+    nodeDef->mapOutputChannel( 0, "tB" );
+    if( passThrough )
+        nodeDef->mapOutputChannel( 1, "in0" );
+
+    nodeDef = compositorManager->addNodeDefinition( "AliasingC" );
+    nodeDef->addTextureSourceName( "in0", 0, TextureDefinitionBase::TEXTURE_INPUT );
+    if( passThrough )
+        nodeDef->addTextureSourceName( "in1", 1, TextureDefinitionBase::TEXTURE_INPUT );
+    addTexture( nodeDef, "tC", PF_R8G8B8A8, true );
+    nodeDef->mapOutputChannel( 0, "tC" );
+
+    nodeDef = compositorManager->addNodeDefinition( "AliasingD" );
+    nodeDef->addTextureSourceName( "in0", 0, TextureDefinitionBase::TEXTURE_INPUT );
+    addTexture( nodeDef, "tD", PF_R8G8B8A8, true );
+    addTexture( nodeDef, "tE", PF_R8G8B8A8, false );
+    addTexture( nodeDef, "tF", PF_FLOAT32_R, true );
+
+    CompositorWorkspaceDef *workspaceDef = compositorManager->addWorkspaceDefinition( workspaceName );
+    workspaceDef->connect( "AliasingA", 0, "AliasingB", 0 );
+    workspaceDef->connect( "AliasingB", 0, "AliasingC", 0 );
+    if( passThrough )
+        workspaceDef->connect( "AliasingB", 1, "AliasingC", 1 );
+    workspaceDef->connect( "AliasingC", 0, "AliasingD", 0 );
+}
+//--------------------------------------------------------------------------
+void CompositorTests::createPlanWorkspaceDef( const String &workspaceName )
+{
+    CompositorManager2 *compositorManager = mRoot->getCompositorManager2();
+
+    CompositorNodeDef *nodeDef = compositorManager->addNodeDefinition( "PlanA" );
+    addTexture( nodeDef, "rt0", PF_R8G8B8A8, false );
+    addTexture( nodeDef, "rt1", PF_R8G8B8A8, false );
+    nodeDef->setNumTargetPass( 3 );
+    const char *targetNames[3] = { "rt0", "rt1", "rt0" };
+    const uint8 executionMasks[3] = { 0x01, 0x02, 0x01 };
+    for( size_t i=0; i<3; ++i )
+    {
+        CompositorTargetDef *targetDef = nodeDef->addTargetPass( targetNames[i] );
+        targetDef->setNumPasses( 1 );
+        targetDef->addPass( PASS_CLEAR )->mExecutionMask = executionMasks[i];
+    }
+    nodeDef->mapOutputChannel( 0, "rt0" );
+
+    nodeDef = compositorManager->addNodeDefinition( "PlanB" );
+    nodeDef->addTextureSourceName( "in0", 0, TextureDefinitionBase::TEXTURE_INPUT );
+    addTexture( nodeDef, "rt2", PF_R8G8B8A8, false );
+    nodeDef->setNumTargetPass( 1 );
+    {
+        CompositorTargetDef *targetDef = nodeDef->addTargetPass( "rt2" );
+        targetDef->setNumPasses( 1 );
+        targetDef->addPass( PASS_CLEAR )->mExecutionMask = 0x02;
+    }
+
+    CompositorWorkspaceDef *workspaceDef = compositorManager->addWorkspaceDefinition( workspaceName );
+    workspaceDef->connect( "PlanA", 0, "PlanB", 0 );
+}
+//--------------------------------------------------------------------------
+void CompositorTests::createShadowWorkspaceDef( const String &workspaceName )
+{
+    CompositorManager2 *compositorManager = mRoot->getCompositorManager2();
+
+    CompositorShadowNodeDef *shadowNodeDef =
+            compositorManager->addShadowNodeDefinition( "CacheShadowNode" );
+    {
+        TextureDefinitionBase::TextureDefinition *texDef =
+                shadowNodeDef->addTextureDefinition( "shadowMap" );
+        texDef->width   = 256u;
+        texDef->height  = 256u;
+        texDef->fsaa    = false;
+        texDef->formatList.push_back( PF_D32_FLOAT );
+
+        shadowNodeDef->setNumShadowTextureDefinitions( 1 );
+        shadowNodeDef->addShadowTextureDefinition( 0, 0, "shadowMap", 0, Vector2::ZERO,
+                                                   Vector2::UNIT_SCALE, 0 );
+
+        shadowNodeDef->setNumTargetPass( 1 );
+        CompositorTargetDef *targetDef = shadowNodeDef->addTargetPass( "shadowMap" );
+        targetDef->setShadowMapSupportedLightTypes( 1u << Light::LT_SPOTLIGHT );
+        targetDef->setNumPasses( 2 );
+        targetDef->addPass( PASS_CLEAR )->mShadowMapIdx = 0;
+        targetDef->addPass( PASS_SCENE )->mShadowMapIdx = 0;
+    }
+
+    CompositorNodeDef *nodeDef = compositorManager->addNodeDefinition( "CacheMain" );
+    nodeDef->addTextureSourceName( "rt_window", 0, TextureDefinitionBase::TEXTURE_INPUT );
+    nodeDef->setNumTargetPass( 1 );
+    {
+        CompositorTargetDef *targetDef = nodeDef->addTargetPass( "rt_window" );
+        targetDef->setNumPasses( 1 );
+        CompositorPassSceneDef *passScene =
+                static_cast<CompositorPassSceneDef*>( targetDef->addPass( PASS_SCENE ) );
+        passScene->mShadowNode = "CacheShadowNode";
+    }
+
+    CompositorWorkspaceDef *workspaceDef = compositorManager->addWorkspaceDefinition( workspaceName );
+    workspaceDef->connectExternal( 0, "CacheMain", 0 );
+}
+//--------------------------------------------------------------------------
+void CompositorTests::testTransientTexturesAliased()
+{
+    createAliasingWorkspaceDef( "AliasingWorkspace", false );
+
+    NULLTextureManager *textureManager =
+            static_cast<NULLTextureManager*>( TextureManager::getSingletonPtr() );
+    const size_t bytesBefore = textureManager->getAllocatedBytes();
+
+    CompositorWorkspace *workspace = mRoot->getCompositorManager2()->addWorkspace(
+                mSceneMgr, mWindow, mCamera, "AliasingWorkspace", true );
+    CPPUNIT_ASSERT( workspace->isValid() );
+
+    //Lifetimes: tA [A;B], tB [B;C], tC [C;D], tD [D;D], tF [D;D]
+    //tC reuses tA, which then lives until D, so tD reuses tB.
+    CPPUNIT_ASSERT_EQUAL( size_t( 2u ), workspace->getNumAliasedTextures() );
+    CPPUNIT_ASSERT( !isAliased( workspace, "AliasingA", 0 ) );
+    CPPUNIT_ASSERT( !isAliased( workspace, "AliasingB", 0 ) );
+    CPPUNIT_ASSERT( isAliased( workspace, "AliasingC", 0 ) );
+    CPPUNIT_ASSERT( isAliased( workspace, "AliasingD", 0 ) );
+    CPPUNIT_ASSERT( !isAliased( workspace, "AliasingD", 1 ) );
+    CPPUNIT_ASSERT( !isAliased( workspace, "AliasingD", 2 ) );
+
+    Texture *tA = getLocalTexture( workspace, "AliasingA", 0 );
+    Texture *tB = getLocalTexture( workspace, "AliasingB", 0 );
+    CPPUNIT_ASSERT( tA != tB );
+    CPPUNIT_ASSERT( getLocalTexture( workspace, "AliasingC", 0 ) == tA );
+    CPPUNIT_ASSERT( getLocalTexture( workspace, "AliasingD", 0 ) == tB );
+
+    //Non-transient textures and different formats are never shared
+    Texture *tE = getLocalTexture( workspace, "AliasingD", 1 );
+    Texture *tF = getLocalTexture( workspace, "AliasingD", 2 );
+    CPPUNIT_ASSERT( tE != tA && tE != tB && tE != tF );
+    CPPUNIT_ASSERT( tF != tA && tF != tB );
+
+    //The textures C & D would've created aren't alive anymore
+    CPPUNIT_ASSERT_EQUAL( 6u * c_aliasingTexBytes, workspace->getLocalTextureMemory( true ) );
+    CPPUNIT_ASSERT_EQUAL( 4u * c_aliasingTexBytes, workspace->getLocalTextureMemory() );
+    CPPUNIT_ASSERT_EQUAL( workspace->getLocalTextureMemory(),
+                          textureManager->getAllocatedBytes() - bytesBefore );
+}
+//--------------------------------------------------------------------------
+void CompositorTests::testPassedThroughTextureNotAliased()
+{
+    createAliasingWorkspaceDef( "AliasingWorkspace", true );
+
+    CompositorWorkspace *workspace = mRoot->getCompositorManager2()->addWorkspace(
+                mSceneMgr, mWindow, mCamera, "AliasingWorkspace", true );
+    CPPUNIT_ASSERT( workspace->isValid() );
+
+    //Lifetimes: tA [A;C] (B passes it on to C), tB [B;C], tC [C;D], tD [D;D], tF [D;D]
+    //Nothing fits before D, where tD reuses tA.
+    CPPUNIT_ASSERT_EQUAL( size_t( 1u ), workspace->getNumAliasedTextures() );
+    CPPUNIT_ASSERT( !isAliased( workspace, "AliasingC", 0 ) );
+    CPPUNIT_ASSERT( isAliased( workspace, "AliasingD", 0 ) );
+
+    Texture *tA = getLocalTexture( workspace, "AliasingA", 0 );
+    CPPUNIT_ASSERT( getLocalTexture( workspace, "AliasingC", 0 ) != tA );
+    CPPUNIT_ASSERT( getLocalTexture( workspace, "AliasingD", 0 ) == tA );
+    CPPUNIT_ASSERT_EQUAL( 5u * c_aliasingTexBytes, workspace->getLocalTextureMemory() );
+}
+//--------------------------------------------------------------------------
+void CompositorTests::testExecutionPlanNotifiesLikeNodes()
+{
+    createPlanWorkspaceDef( "PlanWorkspace" );
+
+    CompositorWorkspace *workspace = mRoot->getCompositorManager2()->addWorkspace(
+                mSceneMgr, mWindow, mCamera, "PlanWorkspace", true, -1, 0, 0, 0,
+                Vector4::ZERO, 0x00, 0x01 );
+    CPPUNIT_ASSERT( workspace->isValid() );
+
+    SwitchRecordingRenderSystem *renderSystem =
+            static_cast<SwitchRecordingRenderSystem*>( mRenderSystem );
+
+    //Executes the cached plan
+    renderSystem->mSwitchedFromTargets.clear();
+    workspace->_update();
+    const vector<RenderTarget*>::type planSwitches = renderSystem->mSwitchedFromTargets;
+
+    //Executes every node on its own
+    renderSystem->mSwitchedFromTargets.clear();
+    const CompositorNodeVec &nodes = workspace->getNodeSequence();
+    for( size_t i=0; i<nodes.size(); ++i )
+        nodes[i]->_update( (Camera*)0, mSceneMgr );
+
+    //A: rt0 -> rt1 (masked out) -> rt0 -> done. B: done (all masked out).
+    CPPUNIT_ASSERT_EQUAL( size_t( 4u ), renderSystem->mSwitchedFromTargets.size() );
+    CPPUNIT_ASSERT( planSwitches == renderSystem->mSwitchedFromTargets );
+}
+//--------------------------------------------------------------------------
+void CompositorTests::testCpuFrameStatsPerFrame()
+{
+    createPlanWorkspaceDef( "PlanWorkspace" );
+
+    CompositorWorkspace *workspace = mRoot->getCompositorManager2()->addWorkspace(
+                mSceneMgr, mWindow, mCamera, "PlanWorkspace", true );
+    const FrameStats &cpuStats = workspace->getCpuFrameStats();
+
+    workspace->_update();
+    workspace->_update();
+    workspace->_update();
+    CPPUNIT_ASSERT_EQUAL( size_t( 0u ), cpuStats.getNumSamples() );
+    workspace->_recordCpuFrameStats();
+    CPPUNIT_ASSERT_EQUAL( size_t( 1u ), cpuStats.getNumSamples() );
+
+    //Frames in which the workspace isn't updated don't count
+    workspace->_recordCpuFrameStats();
+    CPPUNIT_ASSERT_EQUAL( size_t( 1u ), cpuStats.getNumSamples() );
+
+    workspace->_update();
+    workspace->_recordCpuFrameStats();
+    CPPUNIT_ASSERT_EQUAL( size_t( 2u ), cpuStats.getNumSamples() );
+}
+//--------------------------------------------------------------------------
+void CompositorTests::testShadowMapCacheCasterLeavesVolume()
+{
+    createShadowWorkspaceDef( "ShadowCacheWorkspace" );
+
+    mCamera->setNearClipDistance( 0.1f );
+    mCamera->setFarClipDistance( 1000.0f );
+
+    SceneNode *rootNode = mSceneMgr->getRootSceneNode();
+
+    //Spot light at the origin looking towards -Z. Its shadow camera only depends
+    //on the light, so it stays the same as long as the light doesn't move.
+    Light *light = mSceneMgr->createLight();
+    SceneNode *lightNode = rootNode->createChildSceneNode();
+    lightNode->attachObject( light );
+    light->setType( Light::LT_SPOTLIGHT );
+    light->setDirection( Vector3::NEGATIVE_UNIT_Z );
+    light->setAttenuation( 100.0f, 1.0f, 0.0f, 0.0f );
+
+    CasterTestObject *caster = OGRE_NEW CasterTestObject( mSceneMgr );
+    SceneNode *casterNode = rootNode->createChildSceneNode( SCENE_DYNAMIC,
+                                                            Vector3( 0, 0, -10.0f ) );
+    casterNode->attachObject( caster );
+
+    CompositorWorkspace *workspace = mRoot->getCompositorManager2()->addWorkspace(
+                mSceneMgr, mWindow, mCamera, "ShadowCacheWorkspace", true );
+    CPPUNIT_ASSERT( workspace->isValid() );
+    CompositorShadowNode *shadowNode = workspace->findShadowNode( "CacheShadowNode" );
+    CPPUNIT_ASSERT( shadowNode );
+    shadowNode->setAutomaticCaching( true );
+
+    //The caster is inside the shadow map's volume
+    mRoot->renderOneFrame();
+    CPPUNIT_ASSERT_EQUAL( size_t( 0u ), shadowNode->getNumCachedShadowMaps() );
+    mRoot->renderOneFrame();
+    CPPUNIT_ASSERT_EQUAL( size_t( 0u ), shadowNode->getNumCachedShadowMaps() );
+
+    //Behind the light. The shadow map still contains the caster and must be
+    //rendered once more. Only then it can be reused.
+    casterNode->setPosition( 0, 0, 10.0f );
+    mRoot->renderOneFrame();
+    CPPUNIT_ASSERT_EQUAL( size_t( 0u ), shadowNode->getNumCachedShadowMaps() );
+    mRoot->renderOneFrame();
+    CPPUNIT_ASSERT_EQUAL( size_t( 1u ), shadowNode->getNumCachedShadowMaps() );
+
+    //Coming back in must be noticed as well
+    casterNode->setPosition( 0, 0, -10.0f );
+    mRoot->renderOneFrame();
+    CPPUNIT_ASSERT_EQUAL( size_t( 0u ), shadowNode->getNumCachedShadowMaps() );
+
+    casterNode->detachAllObjects();
+    OGRE_DELETE caster;
+}
+//--------------------------------------------------------------------------
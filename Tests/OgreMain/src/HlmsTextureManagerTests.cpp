@@ -0,0 +1,268 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "HlmsTextureManagerTests.h"
+#include "OgreRoot.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlmsTextureManager.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreFileSystemLayer.h"
+#include "OgreImage.h"
+#include "OgreStringConverter.h"
+#include "OgreNULLRenderSystem.h"
+#include "Threading/OgreThreads.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(HlmsTextureManagerTests);
+
+static const char *c_testGroupName = "HlmsTextureManagerTests";
+
+namespace
+{
+    /// Records every notification, in the order it happens.
+    class RecordingStreamingListener : public HlmsTextureManager::StreamingListener
+    {
+    public:
+        struct Event
+        {
+            String                              aliasName;
+            HlmsTextureManager::TextureLocation location;
+            bool                                isFinal;
+            bool                                failed;
+        };
+
+        typedef vector<Event>::type EventVec;
+        EventVec    mEvents;
+
+        /// When the final version of mTriggerAlias arrives, destroys mDestroyAlias and
+        /// starts streaming mStreamAlias.
+        String      mTriggerAlias;
+        String      mDestroyAlias;
+        String      mStreamAlias;
+
+        virtual void streamedTextureChanged( IdString aliasName,
+                                             const HlmsTextureManager::TextureLocation &texLocation,
+                                             bool isFinal )
+        {
+            Event evt;
+            evt.aliasName   = aliasName.getFriendlyText();
+            evt.location    = texLocation;
+            evt.isFinal     = isFinal;
+            evt.failed      = false;
+            mEvents.push_back( evt );
+
+            if( isFinal && aliasName == IdString( mTriggerAlias ) )
+            {
+                HlmsTextureManager *textureManager = Root::getSingleton().getHlmsManager()->
+                        getTextureManager();
+                textureManager->destroyTexture( mDestroyAlias );
+                textureManager->createOrRetrieveTextureStreamed( mStreamAlias, mStreamAlias + ".dds",
+                                                                 HlmsTextureManager::TEXTURE_TYPE_DIFFUSE,
+                                                                 this );
+            }
+        }
+
+        virtual void streamedTextureFailed( IdString aliasName )
+        {
+            Event evt;
+            evt.aliasName   = aliasName.getFriendlyText();
+            evt.isFinal     = false;
+            evt.failed      = true;
+            mEvents.push_back( evt );
+        }
+
+        size_t countEvents( const String &aliasName, bool isFinal ) const
+        {
+            size_t retVal = 0;
+            for( size_t i=0; i<mEvents.size(); ++i )
+            {
+                if( mEvents[i].aliasName == aliasName && mEvents[i].isFinal == isFinal &&
+                    !mEvents[i].failed )
+                {
+                    ++retVal;
+                }
+            }
+            return retVal;
+        }
+    };
+
+    /// Runs frames until the listener gets numEvents notifications in total.
+    void updateUntil( HlmsTextureManager *textureManager,
+                      const RecordingStreamingListener &listener, size_t numEvents )
+    {
+        size_t numIterations = 0;
+        while( listener.mEvents.size() < numEvents )
+        {
+            //Don't hang forever if something's broken
+            CPPUNIT_ASSERT( numIterations < 10000u );
+            textureManager->_updateStreaming();
+            Threads::Sleep( 1 );
+            ++numIterations;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+void HlmsTextureManagerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root( BLANKSTRING, BLANKSTRING );
+    mRenderSystem = OGRE_NEW NULLRenderSystem();
+    mRoot->addRenderSystem( mRenderSystem );
+    mRoot->setRenderSystem( mRenderSystem );
+    mRoot->initialise( true );
+
+    mTestPath = "./HlmsTextureManagerTests";
+    FileSystemLayer::createDirectory( mTestPath );
+
+    const char *textureNames[] = { "StreamA", "StreamB", "StreamC" };
+    for( size_t i=0; i<sizeof(textureNames) / sizeof(textureNames[0]); ++i )
+    {
+        //No mipmaps in the file; the worker threads generate them.
+        const uint32 resolution = 256u;
+        const size_t bufSize = PixelUtil::getMemorySize( resolution, resolution, 1u, PF_A8R8G8B8 );
+        uchar *data = OGRE_ALLOC_T( uchar, bufSize, MEMCATEGORY_GENERAL );
+        for( size_t j=0; j<bufSize; ++j )
+            data[j] = static_cast<uchar>( j * (i + 1u) );
+
+        Image image;
+        image.loadDynamicImage( data, resolution, resolution, 1u, PF_A8R8G8B8, true );
+
+        const String filename = String( textureNames[i] ) + ".dds";
+        image.save( mTestPath + "/" + filename );
+        mTextureFiles.push_back( filename );
+    }
+
+    ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+    resourceGroupManager.createResourceGroup( c_testGroupName );
+    resourceGroupManager.addResourceLocation( mTestPath, "FileSystem", c_testGroupName );
+    resourceGroupManager.initialiseResourceGroup( c_testGroupName, true );
+}
+//--------------------------------------------------------------------------
+void HlmsTextureManagerTests::tearDown()
+{
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+    OGRE_DELETE mRenderSystem;
+    mRenderSystem = 0;
+
+    for( size_t i=0; i<mTextureFiles.size(); ++i )
+        FileSystemLayer::removeFile( mTestPath + "/" + mTextureFiles[i] );
+    FileSystemLayer::removeDirectory( mTestPath );
+    mTextureFiles.clear();
+}
+//--------------------------------------------------------------------------
+void HlmsTextureManagerTests::testStreamedSliceHandedOutWhenComplete()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    HlmsTextureManager *textureManager = mRoot->getHlmsManager()->getTextureManager();
+
+    //A single mip per frame. The 256x256 texture needs several frames to get its
+    //full resolution slice uploaded.
+    textureManager->setStreamingUploadBudget( 1u );
+
+    RecordingStreamingListener listener;
+    HlmsTextureManager::TextureLocation location =
+            textureManager->createOrRetrieveTextureStreamed( "StreamA", "StreamA.dds",
+                                                             HlmsTextureManager::TEXTURE_TYPE_DIFFUSE,
+                                                             &listener );
+    CPPUNIT_ASSERT( location.texture == textureManager->getBlankTexture().texture );
+
+    //Wait for the preview
+    updateUntil( textureManager, listener, 1u );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, listener.countEvents( "StreamA", false ) );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, textureManager->getNumStreamingTextures() );
+
+    //Retrieving it now must finish the upload, without calling the listener from here.
+    location = textureManager->createOrRetrieveTexture( "StreamA",
+                                                        HlmsTextureManager::TEXTURE_TYPE_DIFFUSE );
+    CPPUNIT_ASSERT( location.texture != textureManager->getBlankTexture().texture );
+    CPPUNIT_ASSERT( location.texture != listener.mEvents[0].location.texture );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, listener.mEvents.size() );
+
+    //The very next frame notifies the final version, regardless of the budget.
+    textureManager->_updateStreaming();
+    CPPUNIT_ASSERT_EQUAL( (size_t)2u, listener.mEvents.size() );
+    CPPUNIT_ASSERT( listener.mEvents[1].isFinal );
+    CPPUNIT_ASSERT( listener.mEvents[1].location.texture == location.texture );
+    CPPUNIT_ASSERT_EQUAL( location.xIdx, listener.mEvents[1].location.xIdx );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, textureManager->getNumStreamingTextures() );
+}
+//--------------------------------------------------------------------------
+void HlmsTextureManagerTests::testListenersMayModifyTextures()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    HlmsTextureManager *textureManager = mRoot->getHlmsManager()->getTextureManager();
+    textureManager->setNumStreamingThreads( 2u );
+
+    //Decode & create the previews, but don't upload anything yet.
+    textureManager->setStreamingUploadBudget( 0u );
+
+    RecordingStreamingListener listener;
+    listener.mTriggerAlias  = "StreamA";
+    listener.mDestroyAlias  = "StreamB";
+    listener.mStreamAlias   = "StreamC";
+
+    textureManager->createOrRetrieveTextureStreamed( "StreamA", "StreamA.dds",
+                                                     HlmsTextureManager::TEXTURE_TYPE_DIFFUSE,
+                                                     &listener );
+    textureManager->createOrRetrieveTextureStreamed( "StreamB", "StreamB.dds",
+                                                     HlmsTextureManager::TEXTURE_TYPE_DIFFUSE,
+                                                     &listener );
+    //StreamA goes first. StreamB still needs its full resolution, so it's still
+    //being uploaded when StreamA finishes.
+    textureManager->setTextureScreenCoverage( "StreamA", 1000000.0f );
+    textureManager->setTextureScreenCoverage( "StreamB", 100000.0f );
+
+    updateUntil( textureManager, listener, 2u );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, listener.countEvents( "StreamA", false ) );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, listener.countEvents( "StreamB", false ) );
+
+    textureManager->setStreamingUploadBudget( 1u );
+    updateUntil( textureManager, listener, 3u );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, listener.countEvents( "StreamA", true ) );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, listener.countEvents( "StreamB", true ) );
+
+    //StreamB got destroyed by the listener, and StreamC is now being streamed.
+    textureManager->waitForStreamingTextures();
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, textureManager->getNumStreamingTextures() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, listener.countEvents( "StreamB", true ) );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, listener.countEvents( "StreamC", true ) );
+    for( size_t i=0; i<listener.mEvents.size(); ++i )
+        CPPUNIT_ASSERT( !listener.mEvents[i].failed );
+
+    CPPUNIT_ASSERT( !textureManager->findResourceNameFromAlias( "StreamB" ) );
+    CPPUNIT_ASSERT( textureManager->findResourceNameFromAlias( "StreamA" ) );
+    CPPUNIT_ASSERT( textureManager->findResourceNameFromAlias( "StreamC" ) );
+}
@@ -0,0 +1,348 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ImageTests.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+#include <cstdlib>
+
+#include "UnitTestSuite.h"
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(ImageTests);
+
+namespace
+{
+    // Copy of the filters & scalar kernels generateMipmaps used before it was threaded
+    // and vectorized. They're kept here verbatim (including their quirks) as reference.
+    const uint8 c_refKernels[3][5][5] =
+    {
+        {
+            //Point
+            { 0, 0, 0, 0, 0 },
+            { 0, 0, 0, 0, 0 },
+            { 0, 0, 1, 0, 0 },
+            { 0, 0, 0, 0, 0 },
+            { 0, 0, 0, 0, 0 }
+        },
+        {
+            //Linear
+            { 0, 0, 0, 0, 0 },
+            { 0, 0, 0, 0, 0 },
+            { 0, 0, 1, 1, 0 },
+            { 0, 0, 1, 1, 0 },
+            { 0, 0, 0, 0, 0 }
+        },
+        {
+            //Gaussian
+            { 1,  4,  7,  4, 1 },
+            { 4, 16, 26, 16, 4 },
+            { 7, 26, 41, 26, 7 },
+            { 4, 16, 26, 16, 4 },
+            { 1,  4,  7,  4, 1 }
+        }
+    };
+    const int c_refKernelStart[3]   = { 0, 0, -2 };
+    const int c_refKernelEnd[3]     = { 0, 1, 2 };
+    const uint8 c_refSeparableKernel[5] = { 40, 161, 255, 161, 40 };
+
+    template <typename T, typename TAccum>
+    void storeRef( T *dstPtr, const TAccum *accum, uint32 divisor,
+                   size_t numChannels, size_t alphaIdx )
+    {
+        const float invDivisor = 1.0f / divisor;
+        for( size_t ch=0; ch<numChannels; ++ch )
+        {
+            if( ch == alphaIdx )
+                dstPtr[ch] = static_cast<T>( (accum[ch] + divisor - 1u) / divisor );
+            else
+                dstPtr[ch] = static_cast<T>( accum[ch] * invDivisor + 0.5f );
+        }
+    }
+
+    template <typename T, typename TAccum>
+    void downscale2xRef( T *dstPtr, const T *srcPtr, int dstWidth, int dstHeight, int srcWidth,
+                         int filterIdx, size_t numChannels, size_t alphaIdx )
+    {
+        const uint8 (&kernel)[5][5] = c_refKernels[filterIdx];
+        const int kernelStart = c_refKernelStart[filterIdx];
+        const int kernelEnd   = c_refKernelEnd[filterIdx];
+
+        for( int y=0; y<dstHeight; ++y )
+        {
+            for( int x=0; x<dstWidth; ++x )
+            {
+                const int kStartY = std::max<int>( -y, kernelStart );
+                const int kEndY   = std::min<int>( dstHeight - y - 1, kernelEnd );
+
+                TAccum accum[4] = { 0, 0, 0, 0 };
+                uint32 divisor = 0;
+
+                for( int k_y=kStartY; k_y<=kEndY; ++k_y )
+                {
+                    const int kStartX = std::max<int>( -x, kernelStart );
+                    const int kEndX   = std::min<int>( dstWidth - 1 - x, kernelEnd );
+
+                    for( int k_x=kStartX; k_x<=kEndX; ++k_x )
+                    {
+                        const uint32 kernelVal = kernel[k_y+2][k_x+2];
+                        for( size_t ch=0; ch<numChannels; ++ch )
+                        {
+                            TAccum val = srcPtr[(k_y * srcWidth + k_x) * numChannels + ch];
+                            accum[ch] += val * kernelVal;
+                        }
+                        divisor += kernelVal;
+                    }
+                }
+
+                storeRef( dstPtr, accum, divisor, numChannels, alphaIdx );
+
+                dstPtr += numChannels;
+                srcPtr += numChannels * 2;
+            }
+
+            srcPtr += (srcWidth - dstWidth * 2) * numChannels;
+            srcPtr += srcWidth * numChannels;
+        }
+    }
+
+    template <typename T, typename TAccum>
+    void separableBlurRef( T *tmpPtr, T *srcDstPtr, int width, int height,
+                           size_t numChannels, size_t alphaIdx )
+    {
+        //Horizontal pass, from srcDstPtr into tmpPtr
+        T *dstPtr = tmpPtr;
+        const T *srcPtr = srcDstPtr;
+        for( int y=0; y<height; ++y )
+        {
+            for( int x=0; x<width; ++x )
+            {
+                TAccum accum[4] = { 0, 0, 0, 0 };
+                uint32 divisor = 0;
+
+                const int kStartX = std::max<int>( -x, -2 );
+                const int kEndX   = std::min<int>( width - 1 - x, 2 );
+                for( int k_x=kStartX; k_x<=kEndX; ++k_x )
+                {
+                    const uint32 kernelVal = c_refSeparableKernel[k_x+2];
+                    for( size_t ch=0; ch<numChannels; ++ch )
+                    {
+                        TAccum val = srcPtr[k_x * static_cast<int>( numChannels ) + ch];
+                        accum[ch] += val * kernelVal;
+                    }
+                    divisor += kernelVal;
+                }
+
+                storeRef( dstPtr, accum, divisor, numChannels, alphaIdx );
+
+                dstPtr += numChannels;
+                srcPtr += numChannels;
+            }
+        }
+
+        //Vertical pass, from tmpPtr back into srcDstPtr
+        const int bytesPerRow = width * static_cast<int>( numChannels );
+        dstPtr = srcDstPtr;
+        srcPtr = tmpPtr;
+        for( int y=0; y<height; ++y )
+        {
+            for( int x=0; x<width; ++x )
+            {
+                TAccum accum[4] = { 0, 0, 0, 0 };
+                uint32 divisor = 0;
+
+                const int kStartY = std::max<int>( -y, -2 );
+                const int kEndY   = std::min<int>( height - y - 1, 2 );
+                for( int k_y=kStartY; k_y<=kEndY; ++k_y )
+                {
+                    const uint32 kernelVal = c_refSeparableKernel[k_y+2];
+                    for( size_t ch=0; ch<numChannels; ++ch )
+                    {
+                        TAccum val = srcPtr[k_y * bytesPerRow + ch];
+                        accum[ch] += val * kernelVal;
+                    }
+                    divisor += kernelVal;
+                }
+
+                storeRef( dstPtr, accum, divisor, numChannels, alphaIdx );
+
+                dstPtr += numChannels;
+                srcPtr += numChannels;
+            }
+        }
+    }
+
+    /// Generates all the mips of a 2D image into mipData; which must already
+    /// contain mip 0. Follows what generateMipmaps used to do, step by step.
+    template <typename T, typename TAccum>
+    void generateMipmapsRef( T *mipData, uint32 width, uint32 height, uint8 numMipmaps,
+                             Image::Filter filter, size_t numChannels, size_t alphaIdx )
+    {
+        int filterIdx = 1;
+        if( filter == Image::FILTER_NEAREST )
+            filterIdx = 0;
+        else if( filter == Image::FILTER_GAUSSIAN )
+            filterIdx = 2;
+
+        typename vector<T>::type blurred( width * height * numChannels );
+        typename vector<T>::type tmp( width * height * numChannels );
+
+        uint32 dstWidth  = width;
+        uint32 dstHeight = height;
+
+        for( uint8 i=1; i<numMipmaps + 1; ++i )
+        {
+            const uint32 srcWidth  = dstWidth;
+            const uint32 srcHeight = dstHeight;
+            dstWidth   = std::max<uint32>( 1, dstWidth >> 1 );
+            dstHeight  = std::max<uint32>( 1, dstHeight >> 1 );
+
+            T *srcPtr = mipData;
+            T *dstPtr = mipData + srcWidth * srcHeight * numChannels;
+
+            if( filter == Image::FILTER_GAUSSIAN_HIGH )
+            {
+                std::copy( srcPtr, srcPtr + srcWidth * srcHeight * numChannels, blurred.begin() );
+                separableBlurRef<T, TAccum>( &tmp[0], &blurred[0], srcWidth, srcHeight,
+                                             numChannels, alphaIdx );
+                separableBlurRef<T, TAccum>( &tmp[0], &blurred[0], srcWidth, srcHeight,
+                                             numChannels, alphaIdx );
+                srcPtr = &blurred[0];
+            }
+
+            downscale2xRef<T, TAccum>( dstPtr, srcPtr, dstWidth, dstHeight, srcWidth,
+                                       filterIdx, numChannels, alphaIdx );
+
+            mipData += srcWidth * srcHeight * numChannels;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+void ImageTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+}
+//--------------------------------------------------------------------------
+void ImageTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void ImageTests::testFormat( PixelFormat format, Image::Filter filter, uint32 numThreads )
+{
+    //Odd sizes exercise the borders & the rounding down of mip sizes. The image is big
+    //enough for generateMipmaps to actually use numThreads = 4.
+    const uint32 width  = 613u;
+    const uint32 height = 431u;
+
+    const size_t numChannels = PixelUtil::getComponentCount( format );
+    const size_t alphaIdx = PixelUtil::hasAlpha( format ) ? numChannels - 1u : size_t( -1 );
+    const bool isFloat = PixelUtil::isFloatingPoint( format );
+
+    uint8 numMipmaps = 0;
+    {
+        uint32 res = std::max( width, height );
+        while( res > 1u )
+        {
+            res >>= 1u;
+            ++numMipmaps;
+        }
+    }
+
+    const size_t baseSize = PixelUtil::getMemorySize( width, height, 1u, format );
+    const size_t fullSize = Image::calculateSize( numMipmaps, 1u, width, height, 1u, format );
+
+    uchar *data = OGRE_ALLOC_T( uchar, baseSize, MEMCATEGORY_GENERAL );
+    vector<uint8>::type expected( fullSize );
+
+    srand( 0 );
+    if( isFloat )
+    {
+        float *floatData = reinterpret_cast<float*>( data );
+        for( size_t i=0; i<baseSize / sizeof(float); ++i )
+            floatData[i] = static_cast<float>( rand() ) / static_cast<float>( RAND_MAX );
+    }
+    else
+    {
+        for( size_t i=0; i<baseSize; ++i )
+            data[i] = static_cast<uint8>( rand() );
+    }
+    memcpy( &expected[0], data, baseSize );
+
+    if( isFloat )
+    {
+        generateMipmapsRef<float, float>( reinterpret_cast<float*>( &expected[0] ),
+                                          width, height, numMipmaps, filter,
+                                          numChannels, alphaIdx );
+    }
+    else
+    {
+        generateMipmapsRef<uint8, uint32>( &expected[0], width, height, numMipmaps, filter,
+                                           numChannels, alphaIdx );
+    }
+
+    Image image;
+    image.loadDynamicImage( data, width, height, 1u, format, true );
+    CPPUNIT_ASSERT( image.generateMipmaps( false, filter, numThreads ) );
+    CPPUNIT_ASSERT_EQUAL( numMipmaps, image.getNumMipmaps() );
+    CPPUNIT_ASSERT_EQUAL( fullSize, image.getSize() );
+
+    const bool isEqual = memcmp( image.getData(), &expected[0], fullSize ) == 0;
+    if( !isEqual )
+    {
+        LogManager::getSingleton().logMessage(
+                    "generateMipmaps mismatch. Format: " + PixelUtil::getFormatName( format ) +
+                    " Filter: " + StringConverter::toString( static_cast<uint32>( filter ) ) +
+                    " Threads: " + StringConverter::toString( numThreads ) );
+    }
+    CPPUNIT_ASSERT( isEqual );
+}
+//--------------------------------------------------------------------------
+void ImageTests::testMipmapsMatchReference()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const PixelFormat formats[] =
+    {
+        PF_R8G8B8A8, PF_R8G8B8, PF_BYTE_LA, PF_L8, PF_FLOAT32_RGBA, PF_FLOAT32_R
+    };
+    const Image::Filter filters[] =
+    {
+        Image::FILTER_NEAREST, Image::FILTER_BILINEAR,
+        Image::FILTER_GAUSSIAN, Image::FILTER_GAUSSIAN_HIGH
+    };
+    const uint32 threadCounts[] = { 1u, 4u };
+
+    for( size_t i=0; i<sizeof(formats) / sizeof(formats[0]); ++i )
+    {
+        for( size_t j=0; j<sizeof(filters) / sizeof(filters[0]); ++j )
+        {
+            for( size_t k=0; k<sizeof(threadCounts) / sizeof(threadCounts[0]); ++k )
+                testFormat( formats[i], filters[j], threadCounts[k] );
+        }
+    }
+}
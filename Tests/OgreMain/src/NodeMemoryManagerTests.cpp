@@ -0,0 +1,254 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "NodeMemoryManagerTests.h"
+#include "OgreSceneNode.h"
+#include "OgreId.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+#include "OgreTimer.h"
+#include "Math/Array/OgreNodeMemoryManager.h"
+#include <cstdlib>
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(NodeMemoryManagerTests);
+
+//--------------------------------------------------------------------------
+void NodeMemoryManagerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+    srand(0);
+}
+//--------------------------------------------------------------------------
+void NodeMemoryManagerTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void NodeMemoryManagerTests::createNodes( vector<SceneNode*>::type &outNodes,
+                                          NodeMemoryManager &nodeMemoryManager, size_t numNodes )
+{
+    outNodes.reserve( outNodes.size() + numNodes );
+    for( size_t i=0; i<numNodes; ++i )
+    {
+        SceneNode *sceneNode = OGRE_NEW SceneNode( Id::generateNewId<Node>(), 0,
+                                                   &nodeMemoryManager, 0 );
+        sceneNode->setPosition( Vector3( Real( i ) ) );
+        sceneNode->setName( StringConverter::toString( i ) );
+        outNodes.push_back( sceneNode );
+    }
+}
+//--------------------------------------------------------------------------
+void NodeMemoryManagerTests::checkNodes( const vector<SceneNode*>::type &nodes )
+{
+    vector<SceneNode*>::type::const_iterator itor = nodes.begin();
+    vector<SceneNode*>::type::const_iterator end  = nodes.end();
+
+    while( itor != end )
+    {
+        SceneNode *sceneNode = *itor;
+        const Transform &t = sceneNode->_getTransform();
+        CPPUNIT_ASSERT( t.mOwner[t.mIndex] == sceneNode );
+        const Real expectedValue = StringConverter::parseReal( sceneNode->getName() );
+        CPPUNIT_ASSERT( sceneNode->getPosition() == Vector3( expectedValue ) );
+        ++itor;
+    }
+}
+//--------------------------------------------------------------------------
+unsigned long NodeMemoryManagerTests::destroyNodes( vector<SceneNode*>::type &nodes,
+                                                    NodeMemoryManager &nodeMemoryManager,
+                                                    size_t numNodesToDestroy, bool deferCleanups )
+{
+    for( size_t i=0; i<numNodesToDestroy; ++i )
+        std::swap( nodes[i], nodes[i + rand() % (nodes.size() - i)] );
+
+    const bool prevCleanupsDeferred = nodeMemoryManager.getCleanupsDeferred();
+
+    Timer timer;
+    nodeMemoryManager.setCleanupsDeferred( deferCleanups );
+    for( size_t i=0; i<numNodesToDestroy; ++i )
+        OGRE_DELETE nodes[i];
+    nodeMemoryManager.setCleanupsDeferred( prevCleanupsDeferred );
+    const unsigned long elapsed = timer.getMicroseconds();
+
+    nodes.erase( nodes.begin(), nodes.begin() + numNodesToDestroy );
+    return elapsed;
+}
+//--------------------------------------------------------------------------
+void NodeMemoryManagerTests::testDeferredCleanups()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t numNodes = 1000;
+
+    NodeMemoryManager nodeMemoryManager;
+    nodeMemoryManager.reserve( 0, numNodes );
+
+    vector<SceneNode*>::type nodes;
+    createNodes( nodes, nodeMemoryManager, numNodes );
+
+    // Destroy way more than the cleanup threshold while deferring;
+    // survivors must keep their data after the memory gets compacted.
+    destroyNodes( nodes, nodeMemoryManager, numNodes / 2u, true );
+
+    Transform transform;
+    const size_t numSlots = nodeMemoryManager.getFirstNode( transform, 0 );
+    CPPUNIT_ASSERT( numSlots < numNodes );
+
+    checkNodes( nodes );
+
+    destroyNodes( nodes, nodeMemoryManager, nodes.size(), false );
+}
+//--------------------------------------------------------------------------
+void NodeMemoryManagerTests::testIncrementalDefragmentation()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t numNodes = 10000;
+    const size_t maxSlotMoves = 64;
+
+    NodeMemoryManager nodeMemoryManager;
+    vector<SceneNode*>::type nodes;
+    createNodes( nodes, nodeMemoryManager, numNodes );
+
+    // Keep the holes around, as if a budget was set in the SceneManager
+    nodeMemoryManager.setCleanupsDeferred( true );
+    destroyNodes( nodes, nodeMemoryManager, numNodes / 2u, true );
+    CPPUNIT_ASSERT( nodeMemoryManager.getWastedMemory( 0 ) > 0 );
+    CPPUNIT_ASSERT( nodeMemoryManager.getWastedMemory( 1 ) == 0 );
+
+    Timer timer;
+    unsigned long worstStepTime = 0;
+    size_t numSteps = 0;
+    size_t wastedMemory = nodeMemoryManager.getWastedMemory( 0 );
+    while( wastedMemory )
+    {
+        timer.reset();
+        const size_t numSlotMoves = nodeMemoryManager.defragment( maxSlotMoves );
+        worstStepTime = std::max( worstStepTime, timer.getMicroseconds() );
+
+        CPPUNIT_ASSERT( numSlotMoves <= maxSlotMoves );
+        // Must always make progress
+        const size_t newWastedMemory = nodeMemoryManager.getWastedMemory( 0 );
+        CPPUNIT_ASSERT( newWastedMemory < wastedMemory );
+        wastedMemory = newWastedMemory;
+        ++numSteps;
+
+        checkNodes( nodes );
+    }
+
+    // No holes left, the used slots must be exactly the live nodes
+    Transform transform;
+    CPPUNIT_ASSERT( nodeMemoryManager.getFirstNode( transform, 0 ) == nodes.size() );
+
+    // Every move fills a hole, so only the last step may fall short of the budget
+    CPPUNIT_ASSERT( numSteps <= (numNodes / 2u + maxSlotMoves - 1u) / maxSlotMoves );
+
+    // Keep releasing nodes between steps, so each step has to merge new holes
+    // with the ones left over by the previous one.
+    const size_t numNodesPerStep = 100;
+    while( nodes.size() > numNodesPerStep )
+    {
+        destroyNodes( nodes, nodeMemoryManager, numNodesPerStep, true );
+        CPPUNIT_ASSERT( nodeMemoryManager.defragment( maxSlotMoves ) <= maxSlotMoves );
+        checkNodes( nodes );
+    }
+
+    while( nodeMemoryManager.getWastedMemory( 0 ) )
+        nodeMemoryManager.defragment( maxSlotMoves );
+    checkNodes( nodes );
+    CPPUNIT_ASSERT( nodeMemoryManager.getFirstNode( transform, 0 ) == nodes.size() );
+
+    LogManager::getSingleton().logMessage(
+        "Incremental defragmentation of " + StringConverter::toString( numNodes / 2u ) +
+        " holes: " + StringConverter::toString( numSteps ) + " steps of up to " +
+        StringConverter::toString( maxSlotMoves ) + " slot moves. Worst step: " +
+        StringConverter::toString( worstStepTime / 1000.0f ) + " ms" );
+
+    nodeMemoryManager.setCleanupsDeferred( false );
+    destroyNodes( nodes, nodeMemoryManager, nodes.size(), false );
+}
+//--------------------------------------------------------------------------
+void NodeMemoryManagerTests::testBulkBenchmark()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t numNodes = 100000;
+
+    LogManager::getSingleton().logMessage(
+        "NodeMemoryManager benchmark, " + StringConverter::toString( numNodes ) +
+        " nodes. Times in ms" );
+
+    for( int reserve=0; reserve<2; ++reserve )
+    {
+        NodeMemoryManager nodeMemoryManager;
+
+        vector<SceneNode*>::type nodes;
+        nodes.reserve( numNodes );
+
+        Timer timer;
+        if( reserve )
+            nodeMemoryManager.reserve( 0, numNodes );
+        for( size_t i=0; i<numNodes; ++i )
+        {
+            nodes.push_back( OGRE_NEW SceneNode( Id::generateNewId<Node>(), 0,
+                                                 &nodeMemoryManager, 0 ) );
+        }
+        const unsigned long creationTime = timer.getMicroseconds();
+
+        // Every node got its own slot, in creation order
+        const Transform &firstTransform = nodes.front()->_getTransform();
+        for( size_t i=0; i<numNodes; ++i )
+        {
+            const Transform &t = nodes[i]->_getTransform();
+            CPPUNIT_ASSERT( t.mOwner[t.mIndex] == nodes[i] );
+            CPPUNIT_ASSERT( (t.mOwner + t.mIndex) - (firstTransform.mOwner + firstTransform.mIndex) ==
+                            static_cast<ptrdiff_t>( i ) );
+        }
+
+        Transform transform;
+        CPPUNIT_ASSERT( nodeMemoryManager.getFirstNode( transform, 0 ) == numNodes );
+
+        const unsigned long destructionTime = destroyNodes( nodes, nodeMemoryManager,
+                                                            numNodes, reserve != 0 );
+
+        // The deferred cleanup must have released everything at once
+        if( reserve )
+            CPPUNIT_ASSERT( nodeMemoryManager.getFirstNode( transform, 0 ) == 0 );
+
+        LogManager::getSingleton().logMessage(
+            String( reserve ? "Reserved creation: " : "Incremental creation: " ) +
+            StringConverter::toString( creationTime / 1000.0f ) +
+            String( reserve ? ". Deferred cleanups destruction: " :
+                              ". Immediate cleanups destruction: " ) +
+            StringConverter::toString( destructionTime / 1000.0f ) );
+    }
+}
+//--------------------------------------------------------------------------
@@ -0,0 +1,282 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ObjectMemoryManagerTests.h"
+#include "OgreMovableObject.h"
+#include "OgreCamera.h"
+#include "OgreSceneNode.h"
+#include "OgreId.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+#include "OgreTimer.h"
+#include "Math/Array/OgreObjectMemoryManager.h"
+#include "Math/Array/OgreNodeMemoryManager.h"
+#include <algorithm>
+#include <cstdlib>
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(ObjectMemoryManagerTests);
+
+/// Bare object; only its ObjectData slot is of interest.
+class SpatialTestObject : public MovableObject
+{
+    static const String msMovableType;
+
+public:
+    Vector3 mExpectedCenter;
+
+    SpatialTestObject( ObjectMemoryManager *objectMemoryManager ) :
+        MovableObject( Id::generateNewId<MovableObject>(), objectMemoryManager, 0, 0 ) {}
+
+    virtual const String& getMovableType(void) const    { return msMovableType; }
+};
+
+const String SpatialTestObject::msMovableType = "SpatialTestObject";
+
+//--------------------------------------------------------------------------
+void ObjectMemoryManagerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+    srand(0);
+}
+//--------------------------------------------------------------------------
+void ObjectMemoryManagerTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void ObjectMemoryManagerTests::createObjects( vector<MovableObject*>::type &outObjects,
+                                              ObjectMemoryManager &objectMemoryManager,
+                                              size_t numObjects, Real range )
+{
+    outObjects.reserve( outObjects.size() + numObjects );
+    for( size_t i=0; i<numObjects; ++i )
+    {
+        SpatialTestObject *object = OGRE_NEW SpatialTestObject( &objectMemoryManager );
+
+        // setVisible asserts on unattached objects; these are never attached.
+        ObjectData &objData = object->_getObjectData();
+        objData.mVisibilityFlags[objData.mIndex] |= VisibilityFlags::LAYER_VISIBILITY;
+
+        for( size_t j=0; j<3; ++j )
+            object->mExpectedCenter[j] = (rand() / Real( RAND_MAX ) * 2.0f - 1.0f) * range;
+
+        objData.mWorldAabb->setFromAabb( Aabb( object->mExpectedCenter, Vector3( 0.5f ) ),
+                                         objData.mIndex );
+        objData.mWorldRadius[objData.mIndex] = Vector3( 0.5f ).length();
+
+        outObjects.push_back( object );
+    }
+}
+//--------------------------------------------------------------------------
+void ObjectMemoryManagerTests::checkObjects( const vector<MovableObject*>::type &objects )
+{
+    vector<MovableObject*>::type::const_iterator itor = objects.begin();
+    vector<MovableObject*>::type::const_iterator end  = objects.end();
+
+    while( itor != end )
+    {
+        SpatialTestObject *object = static_cast<SpatialTestObject*>( *itor );
+        const ObjectData &objData = object->_getObjectData();
+        CPPUNIT_ASSERT( objData.mOwner[objData.mIndex] == object );
+        CPPUNIT_ASSERT( object->getWorldAabb().mCenter == object->mExpectedCenter );
+        CPPUNIT_ASSERT( object->getVisible() );
+        ++itor;
+    }
+}
+//--------------------------------------------------------------------------
+void ObjectMemoryManagerTests::destroyObjects( vector<MovableObject*>::type &objects )
+{
+    vector<MovableObject*>::type::const_iterator itor = objects.begin();
+    vector<MovableObject*>::type::const_iterator end  = objects.end();
+
+    while( itor != end )
+        OGRE_DELETE *itor++;
+
+    objects.clear();
+}
+//--------------------------------------------------------------------------
+void ObjectMemoryManagerTests::testSpatialSorting()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t numObjects = 1000;
+
+    ObjectMemoryManager objectMemoryManager;
+    objectMemoryManager.setCleanupsDeferred( true );
+
+    vector<MovableObject*>::type objects;
+    createObjects( objects, objectMemoryManager, numObjects, 100.0f );
+
+    // Leave some holes behind; sorting must get rid of them
+    for( size_t i=0; i<numObjects / 4u; ++i )
+    {
+        const size_t idx = rand() % objects.size();
+        OGRE_DELETE objects[idx];
+        objects[idx] = objects.back();
+        objects.pop_back();
+    }
+
+    CPPUNIT_ASSERT( objectMemoryManager.getWastedMemory( 0 ) > 0 );
+
+    objectMemoryManager.sortSpatially();
+
+    checkObjects( objects );
+    CPPUNIT_ASSERT( objectMemoryManager.getWastedMemory( 0 ) == 0 );
+
+    ObjectData objData;
+    CPPUNIT_ASSERT( objectMemoryManager.getFirstObjectData( objData, 0 ) == objects.size() );
+
+    // Sorting again must not change anything
+    vector<MovableObject*>::type ownersBefore( objData.mOwner, objData.mOwner + objects.size() );
+    objectMemoryManager.sortSpatially();
+    objectMemoryManager.getFirstObjectData( objData, 0 );
+    CPPUNIT_ASSERT( std::equal( ownersBefore.begin(), ownersBefore.end(), objData.mOwner ) );
+
+    checkObjects( objects );
+
+    objectMemoryManager.setCleanupsDeferred( false );
+    destroyObjects( objects );
+}
+//--------------------------------------------------------------------------
+void ObjectMemoryManagerTests::testSpatialSortingUnalignedCount()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // None of them are multiples of ARRAY_PACKED_REALS, so the last pack is partially used
+    const size_t numObjectsList[] = { 5, 6, 7, 1001 };
+
+    for( size_t i=0; i<sizeof( numObjectsList ) / sizeof( numObjectsList[0] ); ++i )
+    {
+        ObjectMemoryManager objectMemoryManager;
+
+        vector<MovableObject*>::type objects;
+        createObjects( objects, objectMemoryManager, numObjectsList[i], 100.0f );
+
+        objectMemoryManager.sortSpatially();
+
+        checkObjects( objects );
+        ObjectData objData;
+        CPPUNIT_ASSERT( objectMemoryManager.getFirstObjectData( objData, 0 ) == objects.size() );
+
+        destroyObjects( objects );
+    }
+}
+//--------------------------------------------------------------------------
+void ObjectMemoryManagerTests::testSpatialSortingCullBenchmark()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t numObjects = 200000;
+    const size_t numRuns = 20;
+
+    ObjectMemoryManager objectMemoryManager;
+    vector<MovableObject*>::type objects;
+    createObjects( objects, objectMemoryManager, numObjects, 1000.0f );
+
+    NodeMemoryManager nodeMemoryManager;
+    ObjectMemoryManager cameraMemoryManager;
+    SceneNode *cameraNode = OGRE_NEW SceneNode( Id::generateNewId<Node>(), 0,
+                                                &nodeMemoryManager, 0 );
+    Camera *camera = OGRE_NEW Camera( Id::generateNewId<MovableObject>(),
+                                      &cameraMemoryManager, 0 );
+    cameraNode->attachObject( camera );
+    cameraNode->setPosition( Vector3( 0, 0, 1000.0f ) );
+    camera->setNearClipDistance( 0.1f );
+    cameraNode->_getDerivedPositionUpdated();
+    // Updates the cached derived position and frustum planes cullFrustum relies on
+    camera->getDerivedPosition();
+    camera->getFrustumPlanes();
+
+    MovableObject::MovableObjectArray culledObjects;
+    vector<MovableObject*>::type visibleObjects[2];
+    unsigned long cullTime[2];
+    size_t numPacksWithVisibleObjs[2];
+
+    for( int sorted=0; sorted<2; ++sorted )
+    {
+        if( sorted )
+            objectMemoryManager.sortSpatially();
+
+        ObjectData objData;
+        const size_t numSlots = objectMemoryManager.getFirstObjectData( objData, 0 );
+
+        Timer timer;
+        for( size_t i=0; i<numRuns; ++i )
+        {
+            culledObjects.clear();
+            MovableObject::cullFrustum( numSlots, objData, camera,
+                                        VisibilityFlags::RESERVED_VISIBILITY_FLAGS,
+                                        culledObjects, camera );
+        }
+        cullTime[sorted] = timer.getMicroseconds();
+
+        visibleObjects[sorted].assign( culledObjects.begin(), culledObjects.end() );
+        std::sort( visibleObjects[sorted].begin(), visibleObjects[sorted].end() );
+
+        // Culling works on whole packs; count how many contain at least one visible object
+        numPacksWithVisibleObjs[sorted] = 0;
+        for( size_t i=0; i<numSlots; i += ARRAY_PACKED_REALS )
+        {
+            bool anyVisible = false;
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            {
+                anyVisible |= std::binary_search( visibleObjects[sorted].begin(),
+                                                  visibleObjects[sorted].end(),
+                                                  objData.mOwner[j] );
+            }
+            if( anyVisible )
+                ++numPacksWithVisibleObjs[sorted];
+            objData.advancePack();
+        }
+    }
+
+    checkObjects( objects );
+
+    // Sorting must only change the order in which the visible objects are found
+    CPPUNIT_ASSERT( !visibleObjects[0].empty() && visibleObjects[0].size() < numObjects );
+    CPPUNIT_ASSERT( visibleObjects[0] == visibleObjects[1] );
+    // Nearby objects share packs once sorted, so fewer packs hold the same visible objects
+    CPPUNIT_ASSERT( numPacksWithVisibleObjs[1] < numPacksWithVisibleObjs[0] );
+
+    LogManager::getSingleton().logMessage(
+        "Culling " + StringConverter::toString( numObjects ) + " objects (" +
+        StringConverter::toString( visibleObjects[0].size() ) + " visible). Unsorted: " +
+        StringConverter::toString( cullTime[0] / (numRuns * 1000.0f) ) +
+        " ms. Spatially sorted: " +
+        StringConverter::toString( cullTime[1] / (numRuns * 1000.0f) ) + " ms. Packs with visible"
+        " objects: " + StringConverter::toString( numPacksWithVisibleObjs[0] ) + " -> " +
+        StringConverter::toString( numPacksWithVisibleObjs[1] ) );
+
+    OGRE_DELETE camera;
+    OGRE_DELETE cameraNode;
+    destroyObjects( objects );
+}
+//--------------------------------------------------------------------------
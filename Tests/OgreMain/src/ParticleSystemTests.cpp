@@ -0,0 +1,292 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "ParticleSystemTests.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreParticleSystem.h"
+#include "OgreParticleSystemManager.h"
+#include "OgreParticleEmitter.h"
+#include "OgreParticleEmitterFactory.h"
+#include "OgreParticle.h"
+#include "OgreNULLRenderSystem.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(ParticleSystemTests);
+
+namespace
+{
+    /// Point emitter that draws every attribute from the system's random generator.
+    class RandomisedTestEmitter : public ParticleEmitter
+    {
+    public:
+        RandomisedTestEmitter( ParticleSystem *psys ) : ParticleEmitter( psys )
+        {
+            mType = "RandomisedTest";
+            setAngle( Degree( 30 ) );
+            setParticleVelocity( 1.0f, 5.0f );
+            setTimeToLive( 0.1f, 0.5f );
+            setColourRangeStart( ColourValue::Black );
+            setColourRangeEnd( ColourValue::White );
+            setEmissionRate( 400.0f );
+        }
+
+        virtual void _initParticle( Particle *pParticle )
+        {
+            ParticleEmitter::_initParticle( pParticle );
+
+            pParticle->mPosition = mPosition + Vector3( mParent->_getSymmetricRandom(),
+                                                        mParent->_getSymmetricRandom(),
+                                                        mParent->_getSymmetricRandom() );
+            genEmissionColour( pParticle->mColour );
+            genEmissionDirection( pParticle->mPosition, pParticle->mDirection );
+            genEmissionVelocity( pParticle->mDirection );
+            pParticle->mTimeToLive = pParticle->mTotalTimeToLive = genEmissionTTL();
+        }
+
+        virtual unsigned short _getEmissionCount( Real timeElapsed )
+        {
+            return genConstantEmissionCount( timeElapsed );
+        }
+    };
+
+    class RandomisedTestEmitterFactory : public ParticleEmitterFactory
+    {
+    public:
+        virtual String getName() const { return "RandomisedTest"; }
+
+        virtual ParticleEmitter* createEmitter( ParticleSystem *psys )
+        {
+            ParticleEmitter *emitter = OGRE_NEW RandomisedTestEmitter( psys );
+            mEmitters.push_back( emitter );
+            return emitter;
+        }
+    };
+
+    struct ParticleState
+    {
+        Vector3     position;
+        Vector3     direction;
+        ColourValue colour;
+        Real        timeToLive;
+
+        bool operator == ( const ParticleState &other ) const
+        {
+            return position == other.position && direction == other.direction &&
+                   colour == other.colour && timeToLive == other.timeToLive;
+        }
+    };
+
+    typedef vector<ParticleState>::type ParticleStateVec;
+
+    ParticleStateVec getParticleStates( const ParticleSystem *system )
+    {
+        ParticleStateVec retVal;
+        Particle * const *particles = system->_getActiveParticles();
+        for( size_t i=0; i<system->getNumParticles(); ++i )
+        {
+            ParticleState state;
+            state.position      = particles[i]->mPosition;
+            state.direction     = particles[i]->mDirection;
+            state.colour        = particles[i]->mColour;
+            state.timeToLive    = particles[i]->mTimeToLive;
+            retVal.push_back( state );
+        }
+        return retVal;
+    }
+
+    /// Time steps queued each frame. Several steps in one frame mimic
+    /// frames in which the SceneManager wasn't updated.
+    const Real c_frameSteps[][3] =
+    {
+        { 0.016f, 0.0f, 0.0f },
+        { 0.05f, 0.1f, 0.003f },
+        { 0.3f, 0.0f, 0.0f },
+        { 0.02f, 0.02f, 0.0f },
+    };
+    const size_t c_numFrames = sizeof( c_frameSteps ) / sizeof( c_frameSteps[0] );
+    const size_t c_maxStepsPerFrame = sizeof( c_frameSteps[0] ) / sizeof( c_frameSteps[0][0] );
+}
+
+//--------------------------------------------------------------------------
+void ParticleSystemTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root( BLANKSTRING, BLANKSTRING );
+    mRenderSystem = OGRE_NEW NULLRenderSystem();
+    mRoot->addRenderSystem( mRenderSystem );
+    mRoot->setRenderSystem( mRenderSystem );
+    mRoot->initialise( true );
+
+    mEmitterFactory = OGRE_NEW RandomisedTestEmitterFactory();
+    ParticleSystemManager::getSingleton().addEmitterFactory( mEmitterFactory );
+
+    mSceneMgr = mRoot->createSceneManager( ST_GENERIC, 4u, INSTANCING_CULLING_SINGLETHREAD );
+}
+//--------------------------------------------------------------------------
+void ParticleSystemTests::tearDown()
+{
+    destroySystems();
+
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+    mSceneMgr = 0;
+    OGRE_DELETE mEmitterFactory;
+    mEmitterFactory = 0;
+    OGRE_DELETE mRenderSystem;
+    mRenderSystem = 0;
+}
+//--------------------------------------------------------------------------
+ParticleSystem* ParticleSystemTests::createSystem( uint32 seed, const Vector3 &position )
+{
+    ParticleSystem *system = mSceneMgr->createParticleSystem( 200 );
+    system->addEmitter( "RandomisedTest" );
+    system->setRandomSeed( seed );
+
+    SceneNode *sceneNode = mSceneMgr->getRootSceneNode()->createChildSceneNode();
+    sceneNode->setPosition( position );
+    sceneNode->setOrientation( Quaternion( Radian( position.x * 0.1f ), Vector3::UNIT_Y ) );
+    sceneNode->attachObject( system );
+
+    mSystems.push_back( system );
+    return system;
+}
+//--------------------------------------------------------------------------
+void ParticleSystemTests::destroySystems(void)
+{
+    ParticleSystemVec::const_iterator itor = mSystems.begin();
+    ParticleSystemVec::const_iterator end  = mSystems.end();
+    while( itor != end )
+    {
+        SceneNode *sceneNode = (*itor)->getParentSceneNode();
+        sceneNode->detachObject( *itor );
+        mSceneMgr->destroySceneNode( sceneNode );
+        mSceneMgr->destroyParticleSystem( *itor );
+        ++itor;
+    }
+    mSystems.clear();
+}
+//--------------------------------------------------------------------------
+void ParticleSystemTests::testThreadedUpdateMatchesSerial()
+{
+    const uint32 numSystems = 13u;
+
+    //Reference: one system at a time, one step at a time
+    vector<ParticleStateVec>::type expectedStates;
+    for( uint32 i=0; i<numSystems; ++i )
+        createSystem( i, Vector3( Real( i ) * 10.0f, 0.0f, 0.0f ) );
+
+    for( size_t frame=0; frame<c_numFrames; ++frame )
+    {
+        for( uint32 i=0; i<numSystems; ++i )
+        {
+            for( size_t step=0; step<c_maxStepsPerFrame; ++step )
+            {
+                if( c_frameSteps[frame][step] > 0 )
+                    mSystems[i]->_update( c_frameSteps[frame][step] );
+            }
+
+            expectedStates.push_back( getParticleStates( mSystems[i] ) );
+        }
+    }
+
+    destroySystems();
+
+    //Same seeds, updated by the SceneManager. The frame time controller queues
+    //zero-length steps on top of ours (no frame gets rendered), which are no-ops.
+    for( uint32 i=0; i<numSystems; ++i )
+        createSystem( i, Vector3( Real( i ) * 10.0f, 0.0f, 0.0f ) );
+
+    size_t totalParticles = 0;
+    for( size_t frame=0; frame<c_numFrames; ++frame )
+    {
+        for( uint32 i=0; i<numSystems; ++i )
+        {
+            for( size_t step=0; step<c_maxStepsPerFrame; ++step )
+            {
+                if( c_frameSteps[frame][step] > 0 )
+                    mSystems[i]->_addPendingUpdateTime( c_frameSteps[frame][step] );
+            }
+        }
+
+        mSceneMgr->updateSceneGraph();
+
+        for( uint32 i=0; i<numSystems; ++i )
+        {
+            const ParticleStateVec states = getParticleStates( mSystems[i] );
+            CPPUNIT_ASSERT( states == expectedStates[frame * numSystems + i] );
+            totalParticles += states.size();
+        }
+    }
+
+    //Make sure the test is meaningful
+    CPPUNIT_ASSERT( totalParticles > numSystems * c_numFrames );
+}
+//--------------------------------------------------------------------------
+void ParticleSystemTests::testPendingStepsNotMerged()
+{
+    const Real steps[] = { 0.3f, 0.01f, 0.2f, 0.05f };
+    const size_t numSteps = sizeof( steps ) / sizeof( steps[0] );
+
+    ParticleSystem *separate    = createSystem( 7u, Vector3::ZERO );
+    ParticleSystem *merged      = createSystem( 7u, Vector3::ZERO );
+    ParticleSystem *otherSeed   = createSystem( 8u, Vector3::ZERO );
+
+    Real totalTime = 0;
+    for( size_t i=0; i<numSteps; ++i )
+    {
+        separate->_update( steps[i] );
+        otherSeed->_update( steps[i] );
+        totalTime += steps[i];
+    }
+    merged->_update( totalTime );
+
+    const ParticleStateVec separateStates   = getParticleStates( separate );
+    const ParticleStateVec mergedStates     = getParticleStates( merged );
+
+    //Make sure the test is meaningful
+    CPPUNIT_ASSERT( !separateStates.empty() );
+    CPPUNIT_ASSERT( separateStates != mergedStates );
+    CPPUNIT_ASSERT( separateStates != getParticleStates( otherSeed ) );
+
+    //Queue the same steps, as if the SceneManager hadn't been updated for a few frames
+    ParticleSystem *queued = createSystem( 7u, Vector3::ZERO );
+    for( size_t i=0; i<numSteps; ++i )
+        queued->_addPendingUpdateTime( steps[i] );
+
+    mSceneMgr->updateSceneGraph();
+
+    CPPUNIT_ASSERT( getParticleStates( queued ) == separateStates );
+}
+//--------------------------------------------------------------------------
@@ -26,6 +26,11 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include "PixelFormatTests.h"
+#include "OgreException.h"
+#include "OgreBitwise.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+#include "OgreTimer.h"
 #include <cstdlib>
 #include <iomanip>
 
@@ -232,6 +237,316 @@ void PixelFormatTests::testBulkConversion()
     testCase(PF_X8B8G8R8, PF_A8B8G8R8);
     testCase(PF_X8B8G8R8, PF_B8G8R8A8);
     testCase(PF_X8B8G8R8, PF_R8G8B8A8);
+
+    // SIMD row converters
+    testCase(PF_FLOAT32_R, PF_FLOAT16_R);
+    testCase(PF_FLOAT32_GR, PF_FLOAT16_GR);
+    testCase(PF_FLOAT32_RGB, PF_FLOAT16_RGB);
+    testCase(PF_FLOAT32_RGBA, PF_FLOAT16_RGBA);
+    testCase(PF_FLOAT16_R, PF_FLOAT32_R);
+    testCase(PF_FLOAT16_GR, PF_FLOAT32_GR);
+    testCase(PF_FLOAT16_RGB, PF_FLOAT32_RGB);
+    testCase(PF_FLOAT16_RGBA, PF_FLOAT32_RGBA);
+}
+//--------------------------------------------------------------------------
+// Same as naiveBulkPixelConversion, with the gamma 2.0 approximation of
+// PixelUtil::convertSRGBToLinear (gamma = 1) and convertLinearToSRGB (gamma = 2)
+void naiveGammaConversion(const PixelBox &src, const PixelBox &dst, int gamma)
+{
+    size_t srcPixelSize = PixelUtil::getNumElemBytes(src.format);
+    size_t dstPixelSize = PixelUtil::getNumElemBytes(dst.format);
+
+    float r,g,b,a;
+    for(size_t y=0; y<src.getHeight(); y++)
+    {
+        const uint8 *srcptr = static_cast<const uint8*>(src.data) + y * src.rowPitch * srcPixelSize;
+        uint8 *dstptr = static_cast<uint8*>(dst.data) + y * dst.rowPitch * dstPixelSize;
+        for(size_t x=0; x<src.getWidth(); x++)
+        {
+            PixelUtil::unpackColour(&r, &g, &b, &a, src.format, srcptr);
+            if(gamma == 1)
+            {
+                r *= r;
+                g *= g;
+                b *= b;
+            }
+            else if(gamma == 2)
+            {
+                r = r > 0.0f ? sqrtf(r) : 0.0f;
+                g = g > 0.0f ? sqrtf(g) : 0.0f;
+                b = b > 0.0f ? sqrtf(b) : 0.0f;
+            }
+            PixelUtil::packColour(r, g, b, a, dst.format, dstptr);
+            srcptr += srcPixelSize;
+            dstptr += dstPixelSize;
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void PixelFormatTests::testCase2D(PixelFormat srcFormat, PixelFormat dstFormat, int gamma)
+{
+    // Odd width so the SIMD loops have a tail, plus padding at the end of every row
+    const uint32 width = 37;
+    const uint32 height = 13;
+    const uint32 rowPitch = width + 3;
+    const size_t srcPixelSize = PixelUtil::getNumElemBytes(srcFormat);
+    const size_t dstPixelSize = PixelUtil::getNumElemBytes(dstFormat);
+    const size_t srcBytes = rowPitch * height * srcPixelSize;
+    const size_t dstBytes = rowPitch * height * dstPixelSize;
+
+    uint8 *srcData = new uint8[srcBytes];
+    uint8 *dstRef = new uint8[dstBytes];
+    uint8 *dstData = new uint8[dstBytes];
+
+    if(PixelUtil::isFloatingPoint(srcFormat) && srcFormat != PF_FLOAT16_R &&
+       srcFormat != PF_FLOAT16_GR && srcFormat != PF_FLOAT16_RGB && srcFormat != PF_FLOAT16_RGBA)
+    {
+        // Random bits make for mostly huge or tiny floats; use values around [0; 1]
+        float *srcFloats = reinterpret_cast<float*>(srcData);
+        for(size_t i=0; i<srcBytes / sizeof(float); i++)
+            srcFloats[i] = (mRandomData[i % mSize] - 32) / 191.0f;
+    }
+    else
+    {
+        for(size_t i=0; i<srcBytes; i++)
+            srcData[i] = mRandomData[(i * 7) % mSize];
+    }
+
+    PixelBox src(width, height, 1, srcFormat, srcData);
+    src.rowPitch = rowPitch;
+    src.slicePitch = rowPitch * height;
+    PixelBox dst(width, height, 1, dstFormat, dstData);
+    dst.rowPitch = rowPitch;
+    dst.slicePitch = rowPitch * height;
+    PixelBox ref(dst);
+    ref.data = dstRef;
+
+    memset(dstRef, 0x5A, dstBytes);
+    if(gamma == 0)
+        naiveBulkPixelConversion(src, ref);
+    else
+        naiveGammaConversion(src, ref, gamma);
+
+    for(uint32 numThreads=1; numThreads<=4; numThreads+=3)
+    {
+        // The padding must be left untouched, thus it must still match
+        memset(dstData, 0x5A, dstBytes);
+        if(gamma == 0)
+            PixelUtil::bulkPixelConversion(src, dst, numThreads);
+        else if(gamma == 1)
+            PixelUtil::convertSRGBToLinear(src, dst, numThreads);
+        else
+            PixelUtil::convertLinearToSRGB(src, dst, numThreads);
+
+        StringStream msg;
+        msg << "Conversion mismatch [" << PixelUtil::getFormatName(srcFormat) <<
+            "->" << PixelUtil::getFormatName(dstFormat) << "] gamma " << gamma <<
+            " threads " << numThreads;
+        CPPUNIT_ASSERT_MESSAGE(msg.str().c_str(), memcmp(dstData, dstRef, dstBytes) == 0);
+    }
+
+    delete [] srcData;
+    delete [] dstRef;
+    delete [] dstData;
+}
+//--------------------------------------------------------------------------
+void PixelFormatTests::testBulkConversionRows()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    testCase2D(PF_A8R8G8B8, PF_A8B8G8R8, 0);
+    testCase2D(PF_A8B8G8R8, PF_A8R8G8B8, 0);
+    testCase2D(PF_B8G8R8A8, PF_R8G8B8A8, 0);
+    testCase2D(PF_R8G8B8A8, PF_B8G8R8A8, 0);
+    testCase2D(PF_R8G8B8, PF_A8R8G8B8, 0);
+    testCase2D(PF_B8G8R8, PF_A8B8G8R8, 0);
+    testCase2D(PF_R8G8B8, PF_A8B8G8R8, 0);
+    testCase2D(PF_B8G8R8, PF_A8R8G8B8, 0);
+    testCase2D(PF_X8R8G8B8, PF_A8B8G8R8, 0);
+
+    testCase2D(PF_FLOAT32_R, PF_FLOAT16_R, 0);
+    testCase2D(PF_FLOAT32_GR, PF_FLOAT16_GR, 0);
+    testCase2D(PF_FLOAT32_RGB, PF_FLOAT16_RGB, 0);
+    testCase2D(PF_FLOAT32_RGBA, PF_FLOAT16_RGBA, 0);
+    testCase2D(PF_FLOAT16_R, PF_FLOAT32_R, 0);
+    testCase2D(PF_FLOAT16_GR, PF_FLOAT32_GR, 0);
+    testCase2D(PF_FLOAT16_RGB, PF_FLOAT32_RGB, 0);
+    testCase2D(PF_FLOAT16_RGBA, PF_FLOAT32_RGBA, 0);
+
+    // Pairs without a row converter still go through the other paths
+    testCase2D(PF_A8R8G8B8, PF_FLOAT32_RGBA, 0);
+    testCase2D(PF_FLOAT32_RGBA, PF_A8B8G8R8, 0);
+    testCase2D(PF_L8, PF_A8R8G8B8, 0);
+    testCase2D(PF_A8R8G8B8, PF_R8G8B8, 0);
+}
+//--------------------------------------------------------------------------
+void PixelFormatTests::testRG8ToFloat16GR()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // The generic route drops green for PF_RG8, so the reference is written by hand.
+    // PF_FLOAT16_GR stores green first.
+    const uint32 width = 37;
+    uint16 *dstData = new uint16[width * 2u + 2u];
+    dstData[width * 2u + 0u] = 0x5623;
+    dstData[width * 2u + 1u] = 0x5623;
+
+    PixelUtil::bulkPixelConversion(PixelBox(width, 1, 1, PF_RG8, mRandomData),
+                                   PixelBox(width, 1, 1, PF_FLOAT16_GR, dstData));
+
+    for(uint32 x=0; x<width; x++)
+    {
+        CPPUNIT_ASSERT_EQUAL(Bitwise::floatToHalf(mRandomData[x * 2u + 1u] / 255.0f),
+                             dstData[x * 2u + 0u]);
+        CPPUNIT_ASSERT_EQUAL(Bitwise::floatToHalf(mRandomData[x * 2u + 0u] / 255.0f),
+                             dstData[x * 2u + 1u]);
+    }
+    CPPUNIT_ASSERT_EQUAL((uint16)0x5623, dstData[width * 2u + 0u]);
+    CPPUNIT_ASSERT_EQUAL((uint16)0x5623, dstData[width * 2u + 1u]);
+
+    delete [] dstData;
+}
+//--------------------------------------------------------------------------
+void PixelFormatTests::testSRGBConversion()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Fast paths
+    testCase2D(PF_A8B8G8R8, PF_FLOAT32_RGBA, 1);
+    testCase2D(PF_A8R8G8B8, PF_FLOAT32_RGBA, 1);
+    testCase2D(PF_FLOAT32_RGBA, PF_A8B8G8R8, 2);
+    testCase2D(PF_FLOAT32_RGBA, PF_A8R8G8B8, 2);
+
+    // Generic route
+    testCase2D(PF_R8G8B8, PF_FLOAT32_RGB, 1);
+    testCase2D(PF_A8R8G8B8, PF_FLOAT16_RGBA, 1);
+    testCase2D(PF_FLOAT32_RGB, PF_B8G8R8, 2);
+}
+//--------------------------------------------------------------------------
+void PixelFormatTests::testBulkConversionThreaded()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const uint32 width = 67;
+    const uint32 height = 29;
+    const size_t bufferSize = width * height * 16u;
+
+    uint8 *srcData = new uint8[bufferSize];
+    uint8 *dstData = new uint8[bufferSize];
+    uint8 *dstDataThreaded = new uint8[bufferSize];
+    for(size_t x=0; x<bufferSize; x++)
+        srcData[x] = mRandomData[x % mSize];
+
+    for(int i=PF_UNKNOWN + 1; i<PF_COUNT; i++)
+    {
+        const PixelFormat srcFormat = static_cast<PixelFormat>( i );
+        if( PixelUtil::isCompressed( srcFormat ) || PixelUtil::getNumElemBytes( srcFormat ) == 0 )
+            continue;
+
+        for(int j=PF_UNKNOWN + 1; j<PF_COUNT; j++)
+        {
+            const PixelFormat dstFormat = static_cast<PixelFormat>( j );
+            if( PixelUtil::isCompressed( dstFormat ) || PixelUtil::getNumElemBytes( dstFormat ) == 0 )
+                continue;
+
+            PixelBox src( width, height, 1, srcFormat, srcData );
+            PixelBox dst( width, height, 1, dstFormat, dstData );
+            PixelBox dstThreaded( width, height, 1, dstFormat, dstDataThreaded );
+
+            // A pair is supported if a single pixel can be converted
+            try
+            {
+                PixelUtil::bulkPixelConversion( PixelBox( 1, 1, 1, srcFormat, srcData ),
+                                                PixelBox( 1, 1, 1, dstFormat, dstData ) );
+            }
+            catch( Exception& )
+            {
+                continue;
+            }
+
+            const size_t dstBytes = PixelUtil::getMemorySize( width, height, 1, dstFormat );
+            memset( dstData, 0, dstBytes );
+            memset( dstDataThreaded, 0, dstBytes );
+
+            PixelUtil::bulkPixelConversion( src, dst, 1u );
+            PixelUtil::bulkPixelConversion( src, dstThreaded, 4u );
+
+            StringStream msg;
+            msg << "Threaded conversion mismatch [" << PixelUtil::getFormatName(srcFormat) <<
+                "->" << PixelUtil::getFormatName(dstFormat) << "]";
+            CPPUNIT_ASSERT_MESSAGE(msg.str().c_str(),
+                memcmp(dstData, dstDataThreaded, dstBytes) == 0);
+        }
+    }
+
+    delete [] srcData;
+    delete [] dstData;
+    delete [] dstDataThreaded;
+}
+//--------------------------------------------------------------------------
+void PixelFormatTests::testBulkConversionBenchmark()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Timings depend on the machine, they're only logged. Results are checked by
+    // testBulkConversionThreaded.
+    const uint32 width = 512;
+    const uint32 height = 512;
+    const size_t bufferSize = width * height * 16u;
+
+    uint8 *srcData = new uint8[bufferSize];
+    uint8 *dstData = new uint8[bufferSize];
+    for(size_t x=0; x<bufferSize; x++)
+        srcData[x] = mRandomData[x % mSize];
+
+    LogManager::getSingleton().logMessage(
+        "Bulk conversion benchmark, " + StringConverter::toString( width ) + "x" +
+        StringConverter::toString( height ) + " pixels. Single thread / threaded, in ms" );
+
+    Timer timer;
+    for(int i=PF_UNKNOWN + 1; i<PF_COUNT; i++)
+    {
+        const PixelFormat srcFormat = static_cast<PixelFormat>( i );
+        if( PixelUtil::isCompressed( srcFormat ) || PixelUtil::getNumElemBytes( srcFormat ) == 0 )
+            continue;
+
+        for(int j=PF_UNKNOWN + 1; j<PF_COUNT; j++)
+        {
+            const PixelFormat dstFormat = static_cast<PixelFormat>( j );
+            if( PixelUtil::isCompressed( dstFormat ) || PixelUtil::getNumElemBytes( dstFormat ) == 0 )
+                continue;
+
+            // A pair is supported if a single pixel can be converted
+            try
+            {
+                PixelUtil::bulkPixelConversion( PixelBox( 1, 1, 1, srcFormat, srcData ),
+                                                PixelBox( 1, 1, 1, dstFormat, dstData ) );
+            }
+            catch( Exception& )
+            {
+                continue;
+            }
+
+            PixelBox src( width, height, 1, srcFormat, srcData );
+            PixelBox dst( width, height, 1, dstFormat, dstData );
+
+            timer.reset();
+            PixelUtil::bulkPixelConversion( src, dst, 1u );
+            const unsigned long singleThreadTime = timer.getMicroseconds();
+
+            timer.reset();
+            PixelUtil::bulkPixelConversion( src, dst, 0u );
+            const unsigned long threadedTime = timer.getMicroseconds();
+
+            LogManager::getSingleton().logMessage(
+                PixelUtil::getFormatName( srcFormat ) + " -> " + PixelUtil::getFormatName( dstFormat ) +
+                ": " + StringConverter::toString( singleThreadTime / 1000.0f ) +
+                " / " + StringConverter::toString( threadedTime / 1000.0f ) );
+        }
+    }
+
+    delete [] srcData;
+    delete [] dstData;
 }
 //--------------------------------------------------------------------------
 
@@ -0,0 +1,207 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ResourceGroupManagerTests.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreArchiveManager.h"
+#include "OgreFileSystem.h"
+#include "OgreFileSystemLayer.h"
+#include "OgreScriptLoader.h"
+#include "OgreStringConverter.h"
+#include <fstream>
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(ResourceGroupManagerTests);
+
+static const char *c_testGroupName = "ResourceGroupManagerTests";
+
+/// Records every event, in the order it happens.
+class RecordingScriptLoader : public ScriptLoader,
+                              public ResourceGroupListener,
+                              public ResourceLoadingListener
+{
+    class TestPreparsedScript : public ScriptLoader::PreparsedScript
+    {
+    public:
+        String mSource;
+        TestPreparsedScript( const String &source ) : mSource( source ) {}
+    };
+
+    StringVector    mScriptPatterns;
+
+public:
+    StringVector    mEvents;
+    size_t          mNumPreparsed;
+
+    RecordingScriptLoader() : mNumPreparsed( 0 )
+    {
+        mScriptPatterns.push_back( "*.rgmtest" );
+    }
+
+    // ScriptLoader
+    virtual const StringVector& getScriptPatterns(void) const   { return mScriptPatterns; }
+    virtual Real getLoadingOrder(void) const                    { return 100.0f; }
+    virtual void parseScript( DataStreamPtr &stream, const String &groupName )
+    {
+        mEvents.push_back( "parse: " + stream->getAsString() );
+    }
+    virtual PreparsedScript* _preparseScript( const String &source, const String &scriptName,
+                                              const String &groupName )
+    {
+        // Scripts flagged as broken must go through parseScript
+        if( source.find( "broken" ) != String::npos )
+            return 0;
+        return OGRE_NEW TestPreparsedScript( source );
+    }
+    virtual void _parsePreparsedScript( PreparsedScript *preparsed, const String &groupName )
+    {
+        ++mNumPreparsed;
+        mEvents.push_back( "parse: " + static_cast<TestPreparsedScript*>( preparsed )->mSource );
+    }
+
+    // ResourceGroupListener
+    virtual void resourceGroupScriptingStarted( const String &groupName, size_t scriptCount )
+    {
+        mEvents.push_back( "scripting started: " + StringConverter::toString( scriptCount ) );
+    }
+    virtual void scriptParseStarted( const String &scriptName, bool &skipThisScript )
+    {
+        skipThisScript = scriptName == "script05.rgmtest";
+        mEvents.push_back( "started: " + scriptName );
+    }
+    virtual void scriptParseEnded( const String &scriptName, bool skipped )
+    {
+        mEvents.push_back( "ended: " + scriptName + (skipped ? " (skipped)" : "") );
+    }
+    virtual void resourceGroupScriptingEnded( const String &groupName )
+    {
+        mEvents.push_back( "scripting ended" );
+    }
+    virtual void resourceGroupLoadStarted( const String &groupName, size_t resourceCount ) {}
+    virtual void resourceLoadStarted( const ResourcePtr &resource ) {}
+    virtual void resourceLoadEnded(void) {}
+    virtual void worldGeometryStageStarted( const String &description ) {}
+    virtual void worldGeometryStageEnded(void) {}
+    virtual void resourceGroupLoadEnded( const String &groupName ) {}
+
+    // ResourceLoadingListener
+    virtual DataStreamPtr resourceLoading( const String &name, const String &group,
+                                           Resource *resource )
+    {
+        return DataStreamPtr();
+    }
+    virtual void resourceStreamOpened( const String &name, const String &group,
+                                       Resource *resource, DataStreamPtr &dataStream )
+    {
+        mEvents.push_back( "opened: " + name );
+    }
+    virtual bool resourceCollision( Resource *resource, ResourceManager *resourceManager )
+    {
+        return true;
+    }
+};
+
+//--------------------------------------------------------------------------
+void ResourceGroupManagerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    OGRE_NEW ResourceGroupManager();
+    ArchiveManager *archiveManager = OGRE_NEW ArchiveManager();
+    archiveManager->addArchiveFactory( OGRE_NEW FileSystemArchiveFactory() );
+
+    mTestPath = "./ResourceGroupManagerTests";
+    FileSystemLayer::createDirectory( mTestPath );
+
+    const size_t numScripts = 64;
+    for( size_t i=0; i<numScripts; ++i )
+    {
+        const String filename = "script" + StringConverter::toString( i, 2, '0' ) + ".rgmtest";
+        std::ofstream file( (mTestPath + "/" + filename).c_str() );
+        file << "contents of " << filename;
+        if( i % 7u == 3u )
+            file << " (broken)";
+        mScriptFiles.push_back( filename );
+    }
+}
+//--------------------------------------------------------------------------
+void ResourceGroupManagerTests::tearDown()
+{
+    for( size_t i=0; i<mScriptFiles.size(); ++i )
+        FileSystemLayer::removeFile( mTestPath + "/" + mScriptFiles[i] );
+    FileSystemLayer::removeDirectory( mTestPath );
+    mScriptFiles.clear();
+
+    OGRE_DELETE ResourceGroupManager::getSingletonPtr();
+    OGRE_DELETE ArchiveManager::getSingletonPtr();
+}
+//--------------------------------------------------------------------------
+StringVector ResourceGroupManagerTests::parseScripts( size_t numThreads )
+{
+    ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+
+    RecordingScriptLoader scriptLoader;
+    resourceGroupManager._registerScriptLoader( &scriptLoader );
+    resourceGroupManager.addResourceGroupListener( &scriptLoader );
+    resourceGroupManager.setLoadingListener( &scriptLoader );
+    resourceGroupManager.setNumScriptParsingThreads( numThreads );
+
+    resourceGroupManager.createResourceGroup( c_testGroupName );
+    resourceGroupManager.addResourceLocation( mTestPath, "FileSystem", c_testGroupName );
+    resourceGroupManager.initialiseResourceGroup( c_testGroupName, true );
+    resourceGroupManager.destroyResourceGroup( c_testGroupName );
+
+    resourceGroupManager.setNumScriptParsingThreads( 1u );
+    resourceGroupManager.setLoadingListener( 0 );
+    resourceGroupManager.removeResourceGroupListener( &scriptLoader );
+    resourceGroupManager._unregisterScriptLoader( &scriptLoader );
+
+    if( numThreads == 1u )
+        CPPUNIT_ASSERT_EQUAL( (size_t)0, scriptLoader.mNumPreparsed );
+    else
+        CPPUNIT_ASSERT( scriptLoader.mNumPreparsed > 0 );
+
+    return scriptLoader.mEvents;
+}
+//--------------------------------------------------------------------------
+void ResourceGroupManagerTests::testParallelScriptParsing()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const StringVector serialEvents = parseScripts( 1u );
+    CPPUNIT_ASSERT( !serialEvents.empty() );
+
+    // Listeners must be notified in the same order, and scripts translated in the
+    // same order, no matter how many threads parsed them.
+    CPPUNIT_ASSERT( parseScripts( 4u ) == serialEvents );
+    CPPUNIT_ASSERT( parseScripts( 64u ) == serialEvents );
+}
+//--------------------------------------------------------------------------
@@ -0,0 +1,326 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "SceneCullingTests.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneManagerEnumerator.h"
+#include "OgreSceneNode.h"
+#include "OgreMovableObject.h"
+#include "OgreCamera.h"
+#include "OgreRenderWindow.h"
+#include "OgreViewport.h"
+#include "OgreId.h"
+#include "OgreNULLRenderSystem.h"
+#include <algorithm>
+#include <cstdlib>
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(SceneCullingTests);
+
+/// Gives access to the results of culling.
+class CullTestSceneManager : public DefaultSceneManager
+{
+public:
+    CullTestSceneManager( const String &name, size_t numWorkerThreads,
+                          InstancingThreadedCullingMethod threadedCullingMethod ) :
+        DefaultSceneManager( name, numWorkerThreads, threadedCullingMethod )
+    {
+    }
+
+    /// Returns the objects the last _cullPhase01 found visible in [firstRq; lastRq),
+    /// from all threads, sorted by address.
+    vector<MovableObject*>::type getVisibleObjects( uint8 firstRq, uint8 lastRq ) const
+    {
+        vector<MovableObject*>::type retVal;
+
+        VisibleObjectsPerThreadArray::const_iterator itor = mVisibleObjects.begin();
+        VisibleObjectsPerThreadArray::const_iterator end  = mVisibleObjects.end();
+
+        while( itor != end )
+        {
+            for( size_t i=firstRq; i<lastRq && i<itor->size(); ++i )
+            {
+                const MovableObject::MovableObjectArray &objs = (*itor)[i];
+                retVal.insert( retVal.end(), objs.begin(), objs.end() );
+            }
+            ++itor;
+        }
+
+        std::sort( retVal.begin(), retVal.end() );
+        return retVal;
+    }
+};
+
+class CullTestSceneManagerFactory : public SceneManagerFactory
+{
+protected:
+    void initMetaData(void) const
+    {
+        mMetaData.typeName = "CullTestSceneManager";
+        mMetaData.description = "SceneManager exposing culling results";
+        mMetaData.sceneTypeMask = ST_GENERIC;
+        mMetaData.worldGeometrySupported = false;
+    }
+public:
+    SceneManager* createInstance( const String &instanceName, size_t numWorkerThreads,
+                                  InstancingThreadedCullingMethod threadedCullingMethod )
+    {
+        return OGRE_NEW CullTestSceneManager( instanceName, numWorkerThreads,
+                                              threadedCullingMethod );
+    }
+    void destroyInstance( SceneManager *instance )
+    {
+        OGRE_DELETE instance;
+    }
+};
+
+namespace
+{
+    /// Bare object; only its ObjectData slot is of interest.
+    class CullTestObject : public MovableObject
+    {
+        static const String msMovableType;
+
+    public:
+        CullTestObject( SceneManager *sceneManager ) :
+            MovableObject( Id::generateNewId<MovableObject>(),
+                           &sceneManager->_getEntityMemoryManager( SCENE_DYNAMIC ),
+                           sceneManager, 0 )
+        {
+        }
+
+        virtual const String& getMovableType(void) const    { return msMovableType; }
+    };
+
+    const String CullTestObject::msMovableType = "CullTestObject";
+
+    Vector3 randomVector( Real range )
+    {
+        Vector3 retVal;
+        for( size_t i=0; i<3; ++i )
+            retVal[i] = (rand() / Real( RAND_MAX ) * 2.0f - 1.0f) * range;
+        return retVal;
+    }
+
+    typedef vector<MovableObject*>::type MovableObjectVec;
+}
+
+//--------------------------------------------------------------------------
+void SceneCullingTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root( BLANKSTRING, BLANKSTRING );
+    mRenderSystem = OGRE_NEW NULLRenderSystem();
+    mRoot->addRenderSystem( mRenderSystem );
+    mRoot->setRenderSystem( mRenderSystem );
+    mWindow = mRoot->initialise( true );
+    mViewport = mWindow->addViewport();
+
+    mSceneMgrFactory = OGRE_NEW CullTestSceneManagerFactory();
+    mRoot->addSceneManagerFactory( mSceneMgrFactory );
+    mSceneMgr = static_cast<CullTestSceneManager*>(
+                mRoot->createSceneManager( "CullTestSceneManager", 4u,
+                                           INSTANCING_CULLING_SINGLETHREAD ) );
+
+    srand( 0 );
+}
+//--------------------------------------------------------------------------
+void SceneCullingTests::tearDown()
+{
+    destroyObjects();
+    mCameras.clear();
+
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+    mWindow = 0;
+    mViewport = 0;
+    mSceneMgr = 0;
+    OGRE_DELETE mSceneMgrFactory;
+    mSceneMgrFactory = 0;
+    OGRE_DELETE mRenderSystem;
+    mRenderSystem = 0;
+}
+//--------------------------------------------------------------------------
+void SceneCullingTests::createObjects( size_t numObjects, Real range )
+{
+    SceneNode *rootNode = mSceneMgr->getRootSceneNode();
+
+    mObjects.reserve( mObjects.size() + numObjects );
+    for( size_t i=0; i<numObjects; ++i )
+    {
+        CullTestObject *object = OGRE_NEW CullTestObject( mSceneMgr );
+        SceneNode *sceneNode = rootNode->createChildSceneNode( SCENE_DYNAMIC,
+                                                               randomVector( range ) );
+        sceneNode->attachObject( object );
+
+        Vector3 halfSize;
+        for( size_t j=0; j<3; ++j )
+            halfSize[j] = rand() / Real( RAND_MAX ) * 2.0f + 0.01f;
+        object->setLocalAabb( Aabb( Vector3::ZERO, halfSize ) );
+
+        object->setRenderQueueGroup( static_cast<uint8>( i & 0x01 ) );
+        if( i % 7u == 6u )
+            object->setVisible( false );
+        if( i % 5u == 4u )
+            object->setCastShadows( false );
+
+        mObjects.push_back( object );
+    }
+}
+//--------------------------------------------------------------------------
+void SceneCullingTests::destroyObjects(void)
+{
+    MovableObjectVec::const_iterator itor = mObjects.begin();
+    MovableObjectVec::const_iterator end  = mObjects.end();
+
+    while( itor != end )
+    {
+        (*itor)->detachFromParent();
+        OGRE_DELETE *itor;
+        ++itor;
+    }
+
+    mObjects.clear();
+}
+//--------------------------------------------------------------------------
+void SceneCullingTests::createCameras( size_t numCameras, Real range )
+{
+    for( size_t i=0; i<numCameras; ++i )
+    {
+        Camera *camera = mSceneMgr->createCamera( "CullTestCamera " +
+                                                  StringConverter::toString( mCameras.size() ) );
+        camera->setNearClipDistance( 0.5f );
+        camera->setFarClipDistance( range );
+        camera->setPosition( randomVector( range ) );
+        camera->lookAt( randomVector( range * 0.25f ) );
+        mCameras.push_back( camera );
+    }
+}
+//--------------------------------------------------------------------------
+void SceneCullingTests::checkBatchedCulling( uint32 visibilityMask )
+{
+    const bool casterPass = (visibilityMask & VisibilityFlags::LAYER_SHADOW_CASTER) != 0;
+
+    mSceneMgr->updateSceneGraph();
+    mSceneMgr->_setCurrentRenderStage( casterPass ? SceneManager::IRS_RENDER_TO_TEXTURE :
+                                                    SceneManager::IRS_NONE );
+    mViewport->_setVisibilityMask( visibilityMask, mViewport->getLightVisibilityMask() );
+
+    //Each camera on its own
+    vector<MovableObjectVec>::type expected;
+    expected.reserve( mCameras.size() );
+    size_t totalVisible = 0;
+
+    for( size_t i=0; i<mCameras.size(); ++i )
+    {
+        mSceneMgr->_cullPhase01( mCameras[i], mCameras[i], mViewport, 0, 255 );
+        expected.push_back( mSceneMgr->getVisibleObjects( 0, 255 ) );
+        totalVisible += expected.back().size();
+    }
+
+    //Make sure the test is meaningful
+    CPPUNIT_ASSERT( totalVisible > mCameras.size() );
+
+    //Objects that don't cast shadows only show up in regular passes
+    size_t numNonCasters = 0;
+    for( size_t i=0; i<expected.size(); ++i )
+    {
+        for( size_t j=0; j<expected[i].size(); ++j )
+            numNonCasters += expected[i][j]->getCastShadows() ? 0u : 1u;
+    }
+    if( casterPass )
+        CPPUNIT_ASSERT_EQUAL( size_t( 0u ), numNonCasters );
+    else
+        CPPUNIT_ASSERT( numNonCasters > 0u );
+
+    //All cameras at once. The batched results are tied to the compositor pass that
+    //will consume them; only the pointer is compared, so any unique address will do.
+    vector<size_t>::type passIds( mCameras.size() );
+    BatchedCullFrustumVec frustums;
+    frustums.reserve( mCameras.size() );
+
+    for( size_t i=0; i<mCameras.size(); ++i )
+    {
+        BatchedCullFrustum frustum;
+        frustum.pass            = reinterpret_cast<CompositorPass*>( &passIds[i] );
+        frustum.camera          = mCameras[i];
+        frustum.lodCamera       = mCameras[i];
+        frustum.firstRq         = 0;
+        frustum.lastRq          = 255;
+        frustum.visibilityMask  = visibilityMask;
+        const Plane *planes = mCameras[i]->getFrustumPlanes();
+        for( size_t j=0; j<6; ++j )
+            frustum.planes[j] = planes[j];
+        frustums.push_back( frustum );
+    }
+
+    mSceneMgr->_cullFrustumsBatched( frustums );
+
+    //Hide everything. Culling again would find nothing; the results must come from the batch.
+    for( size_t i=0; i<mObjects.size(); ++i )
+        mObjects[i]->setVisible( false );
+
+    for( size_t i=0; i<mCameras.size(); ++i )
+    {
+        mSceneMgr->_setCurrentCompositorPass( reinterpret_cast<CompositorPass*>( &passIds[i] ) );
+        mSceneMgr->_cullPhase01( mCameras[i], mCameras[i], mViewport, 0, 255 );
+        CPPUNIT_ASSERT( expected[i] == mSceneMgr->getVisibleObjects( 0, 255 ) );
+    }
+
+    mSceneMgr->_setCurrentCompositorPass( 0 );
+    mSceneMgr->_popBatchedCullFrustums();
+    mSceneMgr->_setCurrentRenderStage( SceneManager::IRS_NONE );
+
+    for( size_t i=0; i<mObjects.size(); ++i )
+        mObjects[i]->setVisible( i % 7u != 6u );
+}
+//--------------------------------------------------------------------------
+void SceneCullingTests::testBatchedShadowCulling()
+{
+    //Not a multiple of ARRAY_PACKED_REALS, nor of the number of threads
+    createObjects( 1003, 100.0f );
+    createCameras( 6, 100.0f );
+
+    checkBatchedCulling( VisibilityFlags::RESERVED_VISIBILITY_FLAGS |
+                         VisibilityFlags::LAYER_SHADOW_CASTER );
+}
+//--------------------------------------------------------------------------
+void SceneCullingTests::testBatchedMultiViewCulling()
+{
+    createObjects( 1003, 100.0f );
+    createCameras( 6, 100.0f );
+
+    checkBatchedCulling( VisibilityFlags::RESERVED_VISIBILITY_FLAGS );
+}
+//--------------------------------------------------------------------------
@@ -0,0 +1,380 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "SceneManagerBulkTests.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreNULLRenderSystem.h"
+#include "Vao/OgreVaoManager.h"
+#include <cstdlib>
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(SceneManagerBulkTests);
+
+namespace
+{
+    const char *c_meshName = "SceneManagerBulkTestsQuad";
+
+    /// Creates a unit quad facing up.
+    void createQuadMesh( VaoManager *vaoManager )
+    {
+        const float c_vertices[4 * 3] =
+        {
+            -0.5f, 0.0f, -0.5f,
+            -0.5f, 0.0f,  0.5f,
+             0.5f, 0.0f, -0.5f,
+             0.5f, 0.0f,  0.5f
+        };
+        const uint16 c_indices[6] = { 0, 1, 2, 2, 1, 3 };
+
+        float *vertices = reinterpret_cast<float*>(
+                    OGRE_MALLOC_SIMD( sizeof(c_vertices), MEMCATEGORY_GEOMETRY ) );
+        uint16 *indices = reinterpret_cast<uint16*>(
+                    OGRE_MALLOC_SIMD( sizeof(c_indices), MEMCATEGORY_GEOMETRY ) );
+        memcpy( vertices, c_vertices, sizeof(c_vertices) );
+        memcpy( indices, c_indices, sizeof(c_indices) );
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+
+        VertexBufferPacked *vertexBuffer = vaoManager->createVertexBuffer(
+                    vertexElements, 4u, BT_IMMUTABLE, vertices, true );
+        IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+                    IndexBufferPacked::IT_16BIT, 6u, BT_IMMUTABLE, indices, true );
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( vertexBuffer );
+        VertexArrayObject *vao = vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                                      OT_TRIANGLE_LIST );
+
+        MeshPtr mesh = MeshManager::getSingleton().createManual(
+                    c_meshName, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+        SubMesh *subMesh = mesh->createSubMesh();
+        subMesh->mVao[VpNormal].push_back( vao );
+        subMesh->mVao[VpShadow].push_back( vao );
+
+        const Aabb bounds( Vector3::ZERO, Vector3( 0.5f, 0.0f, 0.5f ) );
+        mesh->_setBounds( bounds, false );
+        mesh->_setBoundingSphereRadius( bounds.getRadius() );
+    }
+
+    /// Checks every node still points to its own slot, and is still at position (id, 0, 0).
+    void checkSceneNodes( SceneManager *sceneManager, const vector<SceneNode*>::type &nodes )
+    {
+        vector<SceneNode*>::type::const_iterator itor = nodes.begin();
+        vector<SceneNode*>::type::const_iterator end  = nodes.end();
+
+        while( itor != end )
+        {
+            SceneNode *sceneNode = *itor;
+            const Transform &t = sceneNode->_getTransform();
+            CPPUNIT_ASSERT( t.mOwner[t.mIndex] == sceneNode );
+            CPPUNIT_ASSERT( sceneManager->getSceneNode( sceneNode->getId() ) == sceneNode );
+            CPPUNIT_ASSERT( sceneNode->getPosition() == Vector3( Real( sceneNode->getId() ), 0, 0 ) );
+            ++itor;
+        }
+    }
+
+    /// Fails every detachment it's told about.
+    class ThrowingNodeListener : public Node::Listener
+    {
+    public:
+        virtual void nodeDetached( const Node* )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_CALL, "Detachment refused",
+                         "ThrowingNodeListener::nodeDetached" );
+        }
+    };
+}
+
+//--------------------------------------------------------------------------
+void SceneManagerBulkTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root( BLANKSTRING, BLANKSTRING );
+    mRenderSystem = OGRE_NEW NULLRenderSystem();
+    mRoot->addRenderSystem( mRenderSystem );
+    mRoot->setRenderSystem( mRenderSystem );
+    mRoot->initialise( true );
+
+    createQuadMesh( mRenderSystem->getVaoManager() );
+
+    mSceneMgr = mRoot->createSceneManager( ST_GENERIC, 1u, INSTANCING_CULLING_SINGLETHREAD );
+
+    srand( 0 );
+}
+//--------------------------------------------------------------------------
+void SceneManagerBulkTests::tearDown()
+{
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+    mSceneMgr = 0;
+    OGRE_DELETE mRenderSystem;
+    mRenderSystem = 0;
+}
+//--------------------------------------------------------------------------
+size_t SceneManagerBulkTests::countItems(void)
+{
+    size_t numItems = 0;
+    SceneManager::MovableObjectIterator itor =
+            mSceneMgr->getMovableObjectIterator( ItemFactory::FACTORY_TYPE_NAME );
+    while( itor.hasMoreElements() )
+    {
+        itor.getNext();
+        ++numItems;
+    }
+    return numItems;
+}
+//--------------------------------------------------------------------------
+void SceneManagerBulkTests::checkItems( const vector<Item*>::type &items )
+{
+    vector<Item*>::type::const_iterator itor = items.begin();
+    vector<Item*>::type::const_iterator end  = items.end();
+
+    while( itor != end )
+    {
+        Item *item = *itor;
+        const ObjectData &objData = item->_getObjectData();
+        CPPUNIT_ASSERT( objData.mOwner[objData.mIndex] == item );
+        CPPUNIT_ASSERT( item->getMesh()->getName() == c_meshName );
+        ++itor;
+    }
+}
+//--------------------------------------------------------------------------
+void SceneManagerBulkTests::testCreateSceneNodes()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    vector<SceneNode*>::type nodes;
+    mSceneMgr->createSceneNodes( 100u, nodes );
+    CPPUNIT_ASSERT_EQUAL( (size_t)100u, nodes.size() );
+
+    SceneNode *parent = nodes[0];
+    vector<SceneNode*>::type children;
+    mSceneMgr->createSceneNodes( 50u, children, parent );
+    CPPUNIT_ASSERT_EQUAL( (size_t)50u, children.size() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)50u, parent->numChildren() );
+
+    for( size_t i=0; i<children.size(); ++i )
+    {
+        CPPUNIT_ASSERT( children[i]->getParent() == parent );
+        CPPUNIT_ASSERT_EQUAL( parent->getDepthLevel() + 1u, children[i]->getDepthLevel() );
+    }
+
+    nodes.insert( nodes.end(), children.begin(), children.end() );
+    for( size_t i=0; i<nodes.size(); ++i )
+        nodes[i]->setPosition( Real( nodes[i]->getId() ), 0, 0 );
+    checkSceneNodes( mSceneMgr, nodes );
+}
+//--------------------------------------------------------------------------
+void SceneManagerBulkTests::testDestroySceneNodes()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t numParents = 200;
+    const size_t numChildren = 400;
+
+    vector<SceneNode*>::type nodes;
+    mSceneMgr->createSceneNodes( numParents, nodes, mSceneMgr->getRootSceneNode() );
+    for( size_t i=0; i<numChildren; ++i )
+        nodes.push_back( nodes[rand() % numParents]->createChildSceneNode() );
+
+    for( size_t i=0; i<nodes.size(); ++i )
+        nodes[i]->setPosition( Real( nodes[i]->getId() ), 0, 0 );
+
+    //Destroy a random half, which mixes parents that go along with
+    //their children with parents whose children survive them.
+    for( size_t i=0; i<nodes.size() / 2u; ++i )
+        std::swap( nodes[i], nodes[i + rand() % (nodes.size() - i)] );
+
+    vector<SceneNode*>::type toDestroy( nodes.begin(), nodes.begin() + nodes.size() / 2u );
+    vector<SceneNode*>::type survivors( nodes.begin() + nodes.size() / 2u, nodes.end() );
+
+    vector<IdType>::type destroyedIds;
+    for( size_t i=0; i<toDestroy.size(); ++i )
+        destroyedIds.push_back( toDestroy[i]->getId() );
+    set<Node*>::type destroyedNodes( toDestroy.begin(), toDestroy.end() );
+
+    const bool wasDeferred = mSceneMgr->_getNodeMemoryManager( SCENE_DYNAMIC ).getCleanupsDeferred();
+    mSceneMgr->destroySceneNodes( toDestroy );
+    CPPUNIT_ASSERT_EQUAL( wasDeferred,
+                          mSceneMgr->_getNodeMemoryManager( SCENE_DYNAMIC ).getCleanupsDeferred() );
+
+    for( size_t i=0; i<destroyedIds.size(); ++i )
+        CPPUNIT_ASSERT( !mSceneMgr->getSceneNode( destroyedIds[i] ) );
+
+    checkSceneNodes( mSceneMgr, survivors );
+
+    //Nodes whose parent got destroyed must have been detached from it
+    for( size_t i=0; i<survivors.size(); ++i )
+        CPPUNIT_ASSERT( destroyedNodes.find( survivors[i]->getParent() ) == destroyedNodes.end() );
+
+    mSceneMgr->destroySceneNodes( survivors );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, mSceneMgr->getRootSceneNode()->numChildren() );
+}
+//--------------------------------------------------------------------------
+void SceneManagerBulkTests::testDestroySceneNodesValidatesBatch()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    vector<SceneNode*>::type nodes;
+    mSceneMgr->createSceneNodes( 10u, nodes );
+    for( size_t i=0; i<nodes.size(); ++i )
+        nodes[i]->setPosition( Real( nodes[i]->getId() ), 0, 0 );
+
+    //A duplicate must be rejected before anything gets destroyed
+    vector<SceneNode*>::type batch( nodes );
+    batch.push_back( nodes[3] );
+    CPPUNIT_ASSERT_THROW( mSceneMgr->destroySceneNodes( batch ), Exception );
+    checkSceneNodes( mSceneMgr, nodes );
+
+    //Same with a node that belongs to another SceneManager
+    SceneManager *otherSceneMgr = mRoot->createSceneManager( ST_GENERIC, 1u,
+                                                             INSTANCING_CULLING_SINGLETHREAD );
+    batch = nodes;
+    batch.push_back( otherSceneMgr->createSceneNode() );
+    CPPUNIT_ASSERT_THROW( mSceneMgr->destroySceneNodes( batch ), Exception );
+    checkSceneNodes( mSceneMgr, nodes );
+    mRoot->destroySceneManager( otherSceneMgr );
+
+    mSceneMgr->destroySceneNodes( nodes );
+}
+//--------------------------------------------------------------------------
+void SceneManagerBulkTests::testDestroySceneNodesListenerThrows()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    NodeMemoryManager &nodeMemoryManager = mSceneMgr->_getNodeMemoryManager( SCENE_DYNAMIC );
+    const bool prevCleanupsDeferred = nodeMemoryManager.getCleanupsDeferred();
+
+    SceneNode *parent = mSceneMgr->getRootSceneNode()->createChildSceneNode();
+    vector<SceneNode*>::type nodes;
+    for( size_t i=0; i<10u; ++i )
+    {
+        nodes.push_back( parent->createChildSceneNode() );
+        nodes.back()->setPosition( Real( nodes.back()->getId() ), 0, 0 );
+    }
+
+    //Every node refuses, so the first one aborts the batch before anything is destroyed
+    ThrowingNodeListener listener;
+    for( size_t i=0; i<nodes.size(); ++i )
+        nodes[i]->setListener( &listener );
+
+    CPPUNIT_ASSERT_THROW( mSceneMgr->destroySceneNodes( nodes ), Exception );
+    CPPUNIT_ASSERT( nodeMemoryManager.getCleanupsDeferred() == prevCleanupsDeferred );
+    checkSceneNodes( mSceneMgr, nodes );
+
+    for( size_t i=0; i<nodes.size(); ++i )
+        nodes[i]->setListener( 0 );
+    mSceneMgr->destroySceneNodes( nodes );
+    mSceneMgr->destroySceneNode( parent );
+}
+//--------------------------------------------------------------------------
+void SceneManagerBulkTests::testCreateDestroyItems()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t numItems = 300;
+
+    vector<Item*>::type items;
+    mSceneMgr->createItems( c_meshName, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                            numItems, items );
+    CPPUNIT_ASSERT_EQUAL( numItems, items.size() );
+    CPPUNIT_ASSERT_EQUAL( numItems, countItems() );
+    checkItems( items );
+
+    SceneNode *sceneNode = mSceneMgr->getRootSceneNode()->createChildSceneNode();
+    for( size_t i=0; i<numItems; i += 2u )
+        sceneNode->attachObject( items[i] );
+
+    for( size_t i=0; i<numItems / 2u; ++i )
+        std::swap( items[i], items[i + rand() % (numItems - i)] );
+
+    vector<Item*>::type toDestroy( items.begin(), items.begin() + numItems / 2u );
+    vector<Item*>::type survivors( items.begin() + numItems / 2u, items.end() );
+
+    mSceneMgr->destroyItems( toDestroy );
+    CPPUNIT_ASSERT( !mSceneMgr->_getEntityMemoryManager( SCENE_DYNAMIC ).getCleanupsDeferred() );
+    CPPUNIT_ASSERT_EQUAL( survivors.size(), countItems() );
+    checkItems( survivors );
+
+    size_t numAttached = 0;
+    for( size_t i=0; i<survivors.size(); ++i )
+    {
+        if( survivors[i]->isAttached() )
+        {
+            CPPUNIT_ASSERT( survivors[i]->getParentSceneNode() == sceneNode );
+            ++numAttached;
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL( numAttached, sceneNode->numAttachedObjects() );
+
+    mSceneMgr->destroyItems( survivors );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, countItems() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, sceneNode->numAttachedObjects() );
+}
+//--------------------------------------------------------------------------
+void SceneManagerBulkTests::testDestroyItemsValidatesBatch()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    vector<Item*>::type items;
+    mSceneMgr->createItems( c_meshName, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                            10u, items );
+
+    //A duplicate must be rejected before anything gets destroyed
+    vector<Item*>::type batch( items );
+    batch.push_back( items[3] );
+    CPPUNIT_ASSERT_THROW( mSceneMgr->destroyItems( batch ), Exception );
+    CPPUNIT_ASSERT( !mSceneMgr->_getEntityMemoryManager( SCENE_DYNAMIC ).getCleanupsDeferred() );
+    CPPUNIT_ASSERT_EQUAL( items.size(), countItems() );
+    checkItems( items );
+
+    //Same with an Item that belongs to another SceneManager
+    SceneManager *otherSceneMgr = mRoot->createSceneManager( ST_GENERIC, 1u,
+                                                             INSTANCING_CULLING_SINGLETHREAD );
+    batch = items;
+    batch.push_back( otherSceneMgr->createItem( c_meshName ) );
+    CPPUNIT_ASSERT_THROW( mSceneMgr->destroyItems( batch ), Exception );
+    CPPUNIT_ASSERT( !mSceneMgr->_getEntityMemoryManager( SCENE_DYNAMIC ).getCleanupsDeferred() );
+    CPPUNIT_ASSERT_EQUAL( items.size(), countItems() );
+    checkItems( items );
+    mRoot->destroySceneManager( otherSceneMgr );
+
+    mSceneMgr->destroyItems( items );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, countItems() );
+}
@@ -0,0 +1,394 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "SceneQueryTests.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreMovableObject.h"
+#include "OgreSceneQuery.h"
+#include "OgreId.h"
+#include "OgreNULLRenderSystem.h"
+#include <algorithm>
+#include <cstdlib>
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(SceneQueryTests);
+
+namespace
+{
+    /// Bare object; only its ObjectData slot is of interest.
+    class QueryTestObject : public MovableObject
+    {
+        static const String msMovableType;
+
+    public:
+        QueryTestObject( SceneManager *sceneManager ) :
+            MovableObject( Id::generateNewId<MovableObject>(),
+                           &sceneManager->_getEntityMemoryManager( SCENE_DYNAMIC ),
+                           sceneManager, 0 )
+        {
+        }
+
+        virtual const String& getMovableType(void) const    { return msMovableType; }
+
+        /// Sets the local Aabb and updates the world bounds (the parent node is the root).
+        void setBounds( const Aabb &aabb )
+        {
+            setLocalAabb( aabb );
+            updateSingleWorldAabb();
+            updateSingleWorldRadius();
+        }
+    };
+
+    const String QueryTestObject::msMovableType = "QueryTestObject";
+
+    typedef std::pair<MovableObject*, MovableObject*> MovablePair;
+    typedef vector<MovablePair>::type MovablePairVec;
+
+    MovablePair makeSortedPair( MovableObject *a, MovableObject *b )
+    {
+        return a < b ? MovablePair( a, b ) : MovablePair( b, a );
+    }
+
+    typedef std::pair<MovableObject*, Real> MovableDistance;
+    typedef vector<MovableDistance>::type MovableDistanceVec;
+
+    /// Returns the hits of query queryIdx in the batch output, sorted by object.
+    MovableDistanceVec getBatchedHits( const vector<SceneQueryBatchResult>::type &results,
+                                       const vector<uint32>::type &numResults,
+                                       uint32 maxResultsPerQuery, size_t queryIdx )
+    {
+        MovableDistanceVec retVal;
+        for( uint32 i=0; i<numResults[queryIdx]; ++i )
+        {
+            const SceneQueryBatchResult &result = results[queryIdx * maxResultsPerQuery + i];
+            retVal.push_back( MovableDistance( result.movable, result.distance ) );
+        }
+        std::sort( retVal.begin(), retVal.end() );
+        return retVal;
+    }
+
+    /// Compares RegionSceneQuery::executeBatch against execute, one query at a time.
+    template <typename TQuery, typename TVolume>
+    void checkBatchedRegionQuery( TQuery *query, const typename vector<TVolume>::type &volumes,
+                                  uint32 maxResultsPerQuery,
+                                  void (TQuery::*setVolume)( const TVolume& ) )
+    {
+        vector<SceneQueryBatchResult>::type results( volumes.size() * maxResultsPerQuery );
+        vector<uint32>::type numResults( volumes.size(), ~0u );
+        query->executeBatch( &volumes[0], volumes.size(),
+                             SceneQueryBatchOutput( &results[0], &numResults[0],
+                                                    maxResultsPerQuery ) );
+
+        size_t totalHits = 0;
+        for( size_t i=0; i<volumes.size(); ++i )
+        {
+            (query->*setVolume)( volumes[i] );
+            const SceneQueryResult &result = query->execute();
+
+            MovableDistanceVec expectedHits;
+            SceneQueryResultMovableList::const_iterator itor = result.movables.begin();
+            SceneQueryResultMovableList::const_iterator end  = result.movables.end();
+            while( itor != end )
+                expectedHits.push_back( MovableDistance( *itor++, Real( 0 ) ) );
+            std::sort( expectedHits.begin(), expectedHits.end() );
+
+            CPPUNIT_ASSERT( expectedHits == getBatchedHits( results, numResults,
+                                                             maxResultsPerQuery, i ) );
+            totalHits += expectedHits.size();
+        }
+
+        //Make sure the test is meaningful
+        CPPUNIT_ASSERT( totalHits > volumes.size() );
+    }
+
+    class IntersectionRecorder : public IntersectionSceneQueryListener
+    {
+    public:
+        MovablePairVec mPairs;
+
+        virtual bool queryResult( MovableObject *first, MovableObject *second )
+        {
+            mPairs.push_back( makeSortedPair( first, second ) );
+            return true;
+        }
+
+        virtual bool queryResult( MovableObject *movable, SceneQuery::WorldFragment *fragment )
+        {
+            return true;
+        }
+    };
+}
+
+//--------------------------------------------------------------------------
+void SceneQueryTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mRoot = OGRE_NEW Root( BLANKSTRING, BLANKSTRING );
+    mRenderSystem = OGRE_NEW NULLRenderSystem();
+    mRoot->addRenderSystem( mRenderSystem );
+    mRoot->setRenderSystem( mRenderSystem );
+    mRoot->initialise( false );
+
+    mSceneMgr = mRoot->createSceneManager( ST_GENERIC, 4u, INSTANCING_CULLING_SINGLETHREAD );
+
+    srand( 0 );
+}
+//--------------------------------------------------------------------------
+void SceneQueryTests::tearDown()
+{
+    destroyObjects();
+
+    OGRE_DELETE mRoot;
+    mRoot = 0;
+    mSceneMgr = 0;
+    OGRE_DELETE mRenderSystem;
+    mRenderSystem = 0;
+}
+//--------------------------------------------------------------------------
+void SceneQueryTests::createObjects( size_t numObjects, Real range )
+{
+    SceneNode *rootNode = mSceneMgr->getRootSceneNode();
+
+    mObjects.reserve( mObjects.size() + numObjects );
+    for( size_t i=0; i<numObjects; ++i )
+    {
+        QueryTestObject *object = OGRE_NEW QueryTestObject( mSceneMgr );
+        rootNode->attachObject( object );
+
+        if( i % 7u == 6u )
+            object->setVisible( false );
+        if( i % 5u == 4u )
+            object->setQueryFlags( ~SceneManager::QUERY_ENTITY_DEFAULT_MASK );
+
+        Vector3 center, halfSize;
+        for( size_t j=0; j<3; ++j )
+        {
+            center[j]   = (rand() / Real( RAND_MAX ) * 2.0f - 1.0f) * range;
+            halfSize[j] = rand() / Real( RAND_MAX ) * 2.0f + 0.01f;
+        }
+
+        object->setBounds( Aabb( center, halfSize ) );
+
+        mObjects.push_back( object );
+    }
+}
+//--------------------------------------------------------------------------
+void SceneQueryTests::destroyObjects(void)
+{
+    MovableObjectVec::const_iterator itor = mObjects.begin();
+    MovableObjectVec::const_iterator end  = mObjects.end();
+
+    while( itor != end )
+    {
+        (*itor)->detachFromParent();
+        OGRE_DELETE *itor;
+        ++itor;
+    }
+
+    mObjects.clear();
+}
+//--------------------------------------------------------------------------
+void SceneQueryTests::checkIntersectionQuery(void)
+{
+    MovablePairVec expectedPairs;
+    for( size_t i=0; i<mObjects.size(); ++i )
+    {
+        MovableObject *a = mObjects[i];
+        if( !a->getVisible() || !(a->getQueryFlags() & SceneManager::QUERY_ENTITY_DEFAULT_MASK) )
+            continue;
+
+        for( size_t j=i+1; j<mObjects.size(); ++j )
+        {
+            MovableObject *b = mObjects[j];
+            if( !b->getVisible() ||
+                !(b->getQueryFlags() & SceneManager::QUERY_ENTITY_DEFAULT_MASK) )
+            {
+                continue;
+            }
+
+            if( a->getWorldAabb().intersects( b->getWorldAabb() ) )
+                expectedPairs.push_back( makeSortedPair( a, b ) );
+        }
+    }
+
+    IntersectionSceneQuery *query = mSceneMgr->createIntersectionQuery();
+    IntersectionRecorder recorder;
+    query->execute( &recorder );
+    mSceneMgr->destroyQuery( query );
+
+    std::sort( expectedPairs.begin(), expectedPairs.end() );
+    std::sort( recorder.mPairs.begin(), recorder.mPairs.end() );
+
+    //Make sure the test is meaningful
+    CPPUNIT_ASSERT( !expectedPairs.empty() );
+    CPPUNIT_ASSERT_EQUAL( expectedPairs.size(), recorder.mPairs.size() );
+    CPPUNIT_ASSERT( expectedPairs == recorder.mPairs );
+}
+//--------------------------------------------------------------------------
+void SceneQueryTests::testIntersectionQuery()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    //Not a multiple of ARRAY_PACKED_REALS on purpose
+    createObjects( 203, 10.0f );
+    checkIntersectionQuery();
+}
+//--------------------------------------------------------------------------
+void SceneQueryTests::testIntersectionQueryThreaded()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createObjects( 5003, 60.0f );
+    checkIntersectionQuery();
+}
+//--------------------------------------------------------------------------
+void SceneQueryTests::testBatchedRayQuery()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createObjects( 203, 10.0f );
+
+    //Enough rays to use the worker threads, and not a multiple of ARRAY_PACKED_REALS.
+    //Every 5th ray is axis aligned, to go through the 0 / 0 paths.
+    const size_t numRays = 103;
+    vector<Ray>::type rays;
+    rays.reserve( numRays );
+    for( size_t i=0; i<numRays; ++i )
+    {
+        Vector3 origin, direction;
+        for( size_t j=0; j<3; ++j )
+        {
+            origin[j]       = (rand() / Real( RAND_MAX ) * 2.0f - 1.0f) * 15.0f;
+            direction[j]    = rand() / Real( RAND_MAX ) * 2.0f - 1.0f;
+        }
+        if( i % 5u == 4u )
+            direction = Vector3::ZERO;
+        direction[i % 3u] += 0.1f;
+        rays.push_back( Ray( origin, direction.normalisedCopy() ) );
+    }
+
+    RaySceneQuery *query = mSceneMgr->createRayQuery( Ray() );
+
+    const uint32 maxResultsPerQuery = static_cast<uint32>( mObjects.size() );
+    vector<SceneQueryBatchResult>::type results( numRays * maxResultsPerQuery );
+    vector<uint32>::type numResults( numRays, ~0u );
+
+    //Unsorted, every hit fits
+    query->executeBatch( &rays[0], numRays, SceneQueryBatchOutput( &results[0], &numResults[0],
+                                                                   maxResultsPerQuery ) );
+    size_t totalHits = 0;
+    for( size_t i=0; i<numRays; ++i )
+    {
+        query->setRay( rays[i] );
+        const RaySceneQueryResult &result = query->execute();
+
+        MovableDistanceVec expectedHits;
+        for( size_t j=0; j<result.size(); ++j )
+            expectedHits.push_back( MovableDistance( result[j].movable, result[j].distance ) );
+        std::sort( expectedHits.begin(), expectedHits.end() );
+
+        CPPUNIT_ASSERT( expectedHits == getBatchedHits( results, numResults,
+                                                         maxResultsPerQuery, i ) );
+        totalHits += expectedHits.size();
+    }
+    CPPUNIT_ASSERT( totalHits > numRays );
+
+    //Sorted by distance, only the nearest 3
+    query->setSortByDistance( true, 3u );
+    query->executeBatch( &rays[0], numRays, SceneQueryBatchOutput( &results[0], &numResults[0],
+                                                                   maxResultsPerQuery ) );
+    for( size_t i=0; i<numRays; ++i )
+    {
+        query->setRay( rays[i] );
+        const RaySceneQueryResult &result = query->execute();
+
+        CPPUNIT_ASSERT_EQUAL( result.size(), (size_t)numResults[i] );
+        for( size_t j=0; j<result.size(); ++j )
+        {
+            //Ties may be ordered differently; the distances may not.
+            CPPUNIT_ASSERT_EQUAL( result[j].distance,
+                                  results[i * maxResultsPerQuery + j].distance );
+        }
+    }
+
+    mSceneMgr->destroyQuery( query );
+}
+//--------------------------------------------------------------------------
+void SceneQueryTests::testBatchedSphereQuery()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createObjects( 203, 10.0f );
+
+    vector<Sphere>::type spheres;
+    for( size_t i=0; i<103; ++i )
+    {
+        Vector3 center;
+        for( size_t j=0; j<3; ++j )
+            center[j] = (rand() / Real( RAND_MAX ) * 2.0f - 1.0f) * 12.0f;
+        spheres.push_back( Sphere( center, rand() / Real( RAND_MAX ) * 4.0f ) );
+    }
+
+    SphereSceneQuery *query = mSceneMgr->createSphereQuery( Sphere() );
+    checkBatchedRegionQuery<SphereSceneQuery, Sphere>( query, spheres,
+                                                       static_cast<uint32>( mObjects.size() ),
+                                                       &SphereSceneQuery::setSphere );
+    mSceneMgr->destroyQuery( query );
+}
+//--------------------------------------------------------------------------
+void SceneQueryTests::testBatchedAabbQuery()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createObjects( 203, 10.0f );
+
+    vector<AxisAlignedBox>::type boxes;
+    for( size_t i=0; i<103; ++i )
+    {
+        Vector3 center, halfSize;
+        for( size_t j=0; j<3; ++j )
+        {
+            center[j]   = (rand() / Real( RAND_MAX ) * 2.0f - 1.0f) * 12.0f;
+            halfSize[j] = rand() / Real( RAND_MAX ) * 4.0f;
+        }
+        boxes.push_back( AxisAlignedBox( center - halfSize, center + halfSize ) );
+    }
+
+    AxisAlignedBoxSceneQuery *query = mSceneMgr->createAABBQuery( AxisAlignedBox() );
+    checkBatchedRegionQuery<AxisAlignedBoxSceneQuery, AxisAlignedBox>(
+                query, boxes, static_cast<uint32>( mObjects.size() ),
+                &AxisAlignedBoxSceneQuery::setBox );
+    mSceneMgr->destroyQuery( query );
+}
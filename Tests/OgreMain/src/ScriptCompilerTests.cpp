@@ -0,0 +1,323 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ScriptCompilerTests.h"
+#include "OgreScriptCompiler.h"
+#include "OgreScriptTranslator.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreArchiveManager.h"
+#include "OgreFileSystem.h"
+#include "OgreFileSystemLayer.h"
+#include "OgreDataStream.h"
+#include <fstream>
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(ScriptCompilerTests);
+
+static const char *c_mainScript =
+        "import Base from \"imported.testscript\"\n"
+        "set $colour red\n"
+        "test_object Derived : Base\n"
+        "{\n"
+        "    colour $colour\n"
+        "    child_object Child\n"
+        "    {\n"
+        "        size 1 2 3\n"
+        "    }\n"
+        "}\n";
+
+static const char *c_importedScriptA =
+        "abstract test_object Base\n"
+        "{\n"
+        "    shared from_group_a\n"
+        "}\n";
+
+static const char *c_importedScriptB =
+        "abstract test_object Base\n"
+        "{\n"
+        "    shared from_group_b\n"
+        "}\n";
+
+/// Writes the objects it's given in a human readable form.
+class DumpTranslator : public ScriptTranslator
+{
+    void dump( const AbstractNode *node, size_t indent )
+    {
+        mDump += String( indent * 4u, ' ' );
+        switch( node->type )
+        {
+        case ANT_OBJECT:
+            {
+                const ObjectAbstractNode *obj = static_cast<const ObjectAbstractNode*>( node );
+                mDump += obj->cls + " " + obj->name + "\n";
+                AbstractNodeList::const_iterator itor = obj->children.begin();
+                AbstractNodeList::const_iterator end  = obj->children.end();
+                while( itor != end )
+                    dump( (itor++)->get(), indent + 1u );
+            }
+            break;
+        case ANT_PROPERTY:
+            {
+                const PropertyAbstractNode *prop = static_cast<const PropertyAbstractNode*>( node );
+                mDump += prop->name;
+                AbstractNodeList::const_iterator itor = prop->values.begin();
+                AbstractNodeList::const_iterator end  = prop->values.end();
+                while( itor != end )
+                    mDump += " " + (*itor++)->getValue();
+                mDump += "\n";
+            }
+            break;
+        default:
+            mDump += node->getValue() + "\n";
+            break;
+        }
+    }
+
+public:
+    String mDump;
+
+    virtual void translate( ScriptCompiler *compiler, const AbstractNodePtr &node )
+    {
+        dump( node.get(), 0 );
+    }
+};
+
+class DumpTranslatorManager : public ScriptTranslatorManager
+{
+public:
+    DumpTranslator mTranslator;
+
+    virtual size_t getNumTranslators() const    { return 1u; }
+    virtual ScriptTranslator *getTranslator( const AbstractNodePtr &node )
+    {
+        if( node->type == ANT_OBJECT &&
+            static_cast<ObjectAbstractNode*>( node.get() )->cls == "test_object" )
+        {
+            return &mTranslator;
+        }
+        return 0;
+    }
+};
+
+//--------------------------------------------------------------------------
+void ScriptCompilerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    OGRE_NEW ResourceGroupManager();
+    ArchiveManager *archiveManager = OGRE_NEW ArchiveManager();
+    archiveManager->addArchiveFactory( OGRE_NEW FileSystemArchiveFactory() );
+    OGRE_NEW ScriptCompilerManager();
+
+    mTranslatorManager = new DumpTranslatorManager();
+    ScriptCompilerManager::getSingleton().addTranslatorManager( mTranslatorManager );
+
+    // Each group sees a different version of the imported script
+    mTestPath = "./ScriptCompilerTests";
+    FileSystemLayer::createDirectory( mTestPath );
+    FileSystemLayer::createDirectory( mTestPath + "/A" );
+    FileSystemLayer::createDirectory( mTestPath + "/B" );
+    writeFile( "A/imported.testscript", c_importedScriptA );
+    writeFile( "B/imported.testscript", c_importedScriptB );
+
+    ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+    resourceGroupManager.createResourceGroup( "GroupA" );
+    resourceGroupManager.createResourceGroup( "GroupB" );
+    resourceGroupManager.addResourceLocation( mTestPath + "/A", "FileSystem", "GroupA" );
+    resourceGroupManager.addResourceLocation( mTestPath + "/B", "FileSystem", "GroupB" );
+}
+//--------------------------------------------------------------------------
+void ScriptCompilerTests::tearDown()
+{
+    ScriptCompilerManager::getSingleton().removeTranslatorManager( mTranslatorManager );
+    delete mTranslatorManager;
+    mTranslatorManager = 0;
+
+    OGRE_DELETE ScriptCompilerManager::getSingletonPtr();
+    OGRE_DELETE ResourceGroupManager::getSingletonPtr();
+    OGRE_DELETE ArchiveManager::getSingletonPtr();
+
+    FileSystemLayer::removeFile( mTestPath + "/A/imported.testscript" );
+    FileSystemLayer::removeFile( mTestPath + "/B/imported.testscript" );
+    FileSystemLayer::removeDirectory( mTestPath + "/A" );
+    FileSystemLayer::removeDirectory( mTestPath + "/B" );
+    FileSystemLayer::removeDirectory( mTestPath );
+}
+//--------------------------------------------------------------------------
+void ScriptCompilerTests::writeFile( const String &filename, const String &contents )
+{
+    std::ofstream file( (mTestPath + "/" + filename).c_str(), std::ios::binary | std::ios::trunc );
+    file << contents;
+}
+//--------------------------------------------------------------------------
+String ScriptCompilerTests::compile( const String &groupName )
+{
+    mTranslatorManager->mTranslator.mDump.clear();
+    ScriptCompiler compiler;
+    CPPUNIT_ASSERT( compiler.compile( c_mainScript, "main.testscript", groupName ) );
+    return mTranslatorManager->mTranslator.mDump;
+}
+//--------------------------------------------------------------------------
+String ScriptCompilerTests::saveAstCache(void)
+{
+    // Big enough for the few entries in these tests
+    DataStreamPtr stream( OGRE_NEW MemoryDataStream( 64u * 1024u ) );
+    ScriptCompilerManager::getSingleton().saveAstCache( stream );
+    const size_t size = stream->tell();
+    stream->seek( 0 );
+    String retVal( size, '\0' );
+    stream->read( &retVal[0], size );
+    return retVal;
+}
+//--------------------------------------------------------------------------
+void ScriptCompilerTests::loadAstCache( const String &data )
+{
+    DataStreamPtr stream( OGRE_NEW MemoryDataStream( const_cast<char*>( data.c_str() ),
+                                                     data.size(), false, true ) );
+    ScriptCompilerManager::getSingleton().loadAstCache( stream );
+}
+//--------------------------------------------------------------------------
+void ScriptCompilerTests::testAstCacheRoundTrip()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    ScriptCompilerManager &compilerManager = ScriptCompilerManager::getSingleton();
+
+    const String reference = compile( "GroupA" );
+    CPPUNIT_ASSERT( reference.find( "shared from_group_a" ) != String::npos );
+    CPPUNIT_ASSERT( reference.find( "colour red" ) != String::npos );
+    CPPUNIT_ASSERT( reference.find( "size 1 2 3" ) != String::npos );
+
+    compilerManager.setAstCacheEnabled( true );
+
+    // Miss: the AST gets cached
+    CPPUNIT_ASSERT( compile( "GroupA" ) == reference );
+    CPPUNIT_ASSERT( compilerManager.isAstCacheDirty() );
+
+    // Hit, from a cache loaded back from its serialised form
+    const String cacheData = saveAstCache();
+    compilerManager.clearAstCache();
+    loadAstCache( cacheData );
+    CPPUNIT_ASSERT( !compilerManager.isAstCacheDirty() );
+    CPPUNIT_ASSERT( compile( "GroupA" ) == reference );
+    CPPUNIT_ASSERT( !compilerManager.isAstCacheDirty() );
+
+    compilerManager.setAstCacheEnabled( false );
+}
+//--------------------------------------------------------------------------
+void ScriptCompilerTests::testAstCacheFile()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    ScriptCompilerManager &compilerManager = ScriptCompilerManager::getSingleton();
+
+    compilerManager.setAstCacheEnabled( true );
+    const String reference = compile( "GroupA" );
+
+    // File streams don't report eof after a read that ends at the last byte,
+    // unlike MemoryDataStream. The cache must still be accepted.
+    const String cachePath = mTestPath + "/ast.cache";
+    {
+        std::fstream *fs = OGRE_NEW_T( std::fstream, MEMCATEGORY_GENERAL )();
+        fs->open( cachePath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+        DataStreamPtr stream( OGRE_NEW FileStreamDataStream( cachePath, fs ) );
+        compilerManager.saveAstCache( stream );
+    }
+
+    compilerManager.clearAstCache();
+    {
+        std::ifstream *ifs = OGRE_NEW_T( std::ifstream, MEMCATEGORY_GENERAL )();
+        ifs->open( cachePath.c_str(), std::ios::in | std::ios::binary );
+        CPPUNIT_ASSERT( ifs->is_open() );
+        DataStreamPtr stream( OGRE_NEW FileStreamDataStream( cachePath, ifs ) );
+        compilerManager.loadAstCache( stream );
+    }
+
+    // A hit doesn't dirty the cache; a rejected cache would have caused a miss
+    CPPUNIT_ASSERT( !compilerManager.isAstCacheDirty() );
+    CPPUNIT_ASSERT( compile( "GroupA" ) == reference );
+    CPPUNIT_ASSERT( !compilerManager.isAstCacheDirty() );
+
+    FileSystemLayer::removeFile( cachePath );
+    compilerManager.setAstCacheEnabled( false );
+}
+//--------------------------------------------------------------------------
+void ScriptCompilerTests::testAstCacheCorrupt()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    ScriptCompilerManager &compilerManager = ScriptCompilerManager::getSingleton();
+
+    compilerManager.setAstCacheEnabled( true );
+    const String reference = compile( "GroupA" );
+    const String cacheData = saveAstCache();
+
+    // Truncated caches must be ignored
+    for( size_t i=0; i<cacheData.size(); ++i )
+    {
+        loadAstCache( cacheData.substr( 0, i ) );
+        CPPUNIT_ASSERT( compile( "GroupA" ) == reference );
+    }
+
+    // So must corrupt ones. Whatever is hit, it must never produce a different tree.
+    for( size_t i=0; i<cacheData.size(); ++i )
+    {
+        String corruptData = cacheData;
+        corruptData[i] = static_cast<char>( corruptData[i] ^ 0xFF );
+        loadAstCache( corruptData );
+        CPPUNIT_ASSERT( compile( "GroupA" ) == reference );
+    }
+
+    compilerManager.setAstCacheEnabled( false );
+}
+//--------------------------------------------------------------------------
+void ScriptCompilerTests::testAstCacheStaleImports()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    ScriptCompilerManager &compilerManager = ScriptCompilerManager::getSingleton();
+    compilerManager.setAstCacheEnabled( true );
+
+    // Same script, different groups: imports resolve to different files
+    const String resultA = compile( "GroupA" );
+    const String resultB = compile( "GroupB" );
+    CPPUNIT_ASSERT( resultA.find( "shared from_group_a" ) != String::npos );
+    CPPUNIT_ASSERT( resultB.find( "shared from_group_b" ) != String::npos );
+    CPPUNIT_ASSERT( compile( "GroupA" ) == resultA );
+    CPPUNIT_ASSERT( compile( "GroupB" ) == resultB );
+
+    // Changing an imported script must invalidate the entries that depend on it
+    writeFile( "A/imported.testscript", c_importedScriptB );
+    CPPUNIT_ASSERT( compile( "GroupA" ) == resultB );
+
+    compilerManager.setAstCacheEnabled( false );
+}
+//--------------------------------------------------------------------------
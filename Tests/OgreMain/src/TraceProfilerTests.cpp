@@ -0,0 +1,194 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "TraceProfilerTests.h"
+#include "OgreTraceProfiler.h"
+#include "OgreProfiler.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(TraceProfilerTests);
+
+namespace
+{
+    size_t countOccurrences( const String &str, const String &pattern )
+    {
+        size_t retVal = 0;
+        size_t pos = str.find( pattern );
+        while( pos != String::npos )
+        {
+            ++retVal;
+            pos = str.find( pattern, pos + pattern.size() );
+        }
+        return retVal;
+    }
+
+    unsigned long recordFromWorkerThread( ThreadHandle *threadHandle )
+    {
+        TraceProfiler *traceProfiler = reinterpret_cast<TraceProfiler*>(
+                    threadHandle->getUserParam() );
+        traceProfiler->setCurrentThreadName( "Worker" );
+        traceProfiler->beginEvent( "WorkerEvent", OGREPROF_GENERAL );
+        traceProfiler->endEvent();
+        return 0;
+    }
+    THREAD_DECLARE( recordFromWorkerThread );
+}
+
+//--------------------------------------------------------------------------
+void TraceProfilerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    //Builds with the trace provider create one along with Root
+    CPPUNIT_ASSERT( !TraceProfiler::getSingletonPtr() );
+    mTraceProfiler = OGRE_NEW TraceProfiler();
+}
+//--------------------------------------------------------------------------
+void TraceProfilerTests::tearDown()
+{
+    OGRE_DELETE mTraceProfiler;
+    mTraceProfiler = 0;
+}
+//--------------------------------------------------------------------------
+void TraceProfilerTests::testChromeTraceExport()
+{
+    mTraceProfiler->setCurrentThreadName( "Main" );
+    mTraceProfiler->beginEvent( "Outer", OGREPROF_GENERAL );
+    mTraceProfiler->beginEvent( "In\"ner\\", OGREPROF_GENERAL );
+    mTraceProfiler->endEvent();
+
+    ThreadHandlePtr workerThread = Threads::CreateThread( THREAD_GET( recordFromWorkerThread ),
+                                                          0, mTraceProfiler );
+    Threads::WaitForThreads( 1, &workerThread );
+
+    mTraceProfiler->endEvent();
+
+    //Still open while dumping; gets closed in the output
+    mTraceProfiler->beginEvent( "Open", OGREPROF_GENERAL );
+
+    String json;
+    mTraceProfiler->dumpChromeTraceStr( json );
+    mTraceProfiler->endEvent();
+
+    CPPUNIT_ASSERT_EQUAL( size_t( 0u ), json.find( "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" ) );
+    CPPUNIT_ASSERT_EQUAL( json.size() - 4u, json.rfind( "\n]}\n" ) );
+
+    //Thread metadata
+    CPPUNIT_ASSERT_EQUAL( size_t( 2u ), countOccurrences( json, "\"ph\":\"M\"" ) );
+    CPPUNIT_ASSERT( json.find( "\"args\":{\"name\":\"Main\"}" ) != String::npos );
+    CPPUNIT_ASSERT( json.find( "\"args\":{\"name\":\"Worker\"}" ) != String::npos );
+
+    //Balanced
+    CPPUNIT_ASSERT_EQUAL( size_t( 4u ), countOccurrences( json, "\"ph\":\"B\"" ) );
+    CPPUNIT_ASSERT_EQUAL( size_t( 4u ), countOccurrences( json, "\"ph\":\"E\"" ) );
+
+    //Nesting order and escaping
+    const size_t outerPos = json.find( "\"name\":\"Outer\"" );
+    const size_t innerPos = json.find( "\"name\":\"In\\\"ner\\\\\"" );
+    CPPUNIT_ASSERT( outerPos != String::npos );
+    CPPUNIT_ASSERT( innerPos != String::npos );
+    CPPUNIT_ASSERT( outerPos < innerPos );
+    CPPUNIT_ASSERT( json.find( "\"name\":\"WorkerEvent\"" ) != String::npos );
+
+    //The worker's events are on their own tid
+    CPPUNIT_ASSERT_EQUAL( size_t( 1u ), countOccurrences( json, "\"ph\":\"B\",\"pid\":0,\"tid\":1," ) );
+
+    mTraceProfiler->reset();
+    mTraceProfiler->dumpChromeTraceStr( json );
+    CPPUNIT_ASSERT_EQUAL( size_t( 0u ), countOccurrences( json, "\"ph\":\"B\"" ) );
+}
+//--------------------------------------------------------------------------
+void TraceProfilerTests::testGroupMask()
+{
+    mTraceProfiler->setProfileGroupMask( OGREPROF_CULLING );
+
+    mTraceProfiler->beginEvent( "Culling", OGREPROF_CULLING );
+    mTraceProfiler->beginEvent( "General", OGREPROF_GENERAL );
+    //Begun while it passed the mask; its end must still be recorded
+    mTraceProfiler->setProfileGroupMask( OGREPROF_GENERAL );
+    mTraceProfiler->endEvent();
+    mTraceProfiler->endEvent();
+
+    mTraceProfiler->beginEvent( "Unmasked", OGREPROF_GENERAL );
+    mTraceProfiler->endEvent();
+
+    mTraceProfiler->beginEvent( "Enabled", OGREPROF_GENERAL );
+    mTraceProfiler->setEnabled( false );
+    mTraceProfiler->endEvent();
+
+    String json;
+    mTraceProfiler->dumpChromeTraceStr( json );
+
+    CPPUNIT_ASSERT( json.find( "\"name\":\"Culling\"" ) != String::npos );
+    CPPUNIT_ASSERT( json.find( "\"name\":\"General\"" ) == String::npos );
+    CPPUNIT_ASSERT( json.find( "\"name\":\"Unmasked\"" ) != String::npos );
+    CPPUNIT_ASSERT( json.find( "\"name\":\"Enabled\"" ) != String::npos );
+    CPPUNIT_ASSERT_EQUAL( size_t( 3u ), countOccurrences( json, "\"ph\":\"B\"" ) );
+    CPPUNIT_ASSERT_EQUAL( size_t( 3u ), countOccurrences( json, "\"ph\":\"E\"" ) );
+}
+//--------------------------------------------------------------------------
+void TraceProfilerTests::testRecordingOverhead()
+{
+    const size_t numEvents = 200000u;
+
+    //First event registers the thread; keep it out of the measurement
+    mTraceProfiler->beginEvent( "Warmup", OGREPROF_GENERAL );
+    mTraceProfiler->endEvent();
+
+    uint64 startNs = TraceProfiler::getTimestampNs();
+    for( size_t i=0; i<numEvents; ++i )
+    {
+        mTraceProfiler->beginEvent( "Event", OGREPROF_GENERAL );
+        mTraceProfiler->endEvent();
+    }
+    const uint64 enabledNs = TraceProfiler::getTimestampNs() - startNs;
+
+    mTraceProfiler->setEnabled( false );
+    startNs = TraceProfiler::getTimestampNs();
+    for( size_t i=0; i<numEvents; ++i )
+    {
+        mTraceProfiler->beginEvent( "Event", OGREPROF_GENERAL );
+        mTraceProfiler->endEvent();
+    }
+    const uint64 disabledNs = TraceProfiler::getTimestampNs() - startNs;
+
+    const double enabledNsPerPair   = double( enabledNs ) / double( numEvents );
+    const double disabledNsPerPair  = double( disabledNs ) / double( numEvents );
+
+    LogManager::getSingleton().logMessage(
+                "TraceProfiler begin/end pair: " +
+                StringConverter::toString( Real( enabledNsPerPair ) ) + " ns recording, " +
+                StringConverter::toString( Real( disabledNsPerPair ) ) + " ns disabled" );
+}
+//--------------------------------------------------------------------------